@@ -300,7 +300,8 @@ typedef void (*sr_log_cb)(sr_log_level_t level, const char *message);
 
 /**
  * @brief Sets callback that will be called when a log entry would be populated.
- * Callback will be called for each message with any log level.
+ * Callback will be called for each message with any log level, including the messages
+ * suppressed in stderr and syslog by the per-call-site rate limit.
  *
  * @param[in] log_callback Callback to be called when a log entry would populated.
  */
@@ -1081,6 +1082,11 @@ typedef enum sr_subscr_flag_e {
     SR_SUBSCR_EV_ENABLED = 8, /**< The subscriber wants ::SR_EV_ENABLED notifications to be sent to them. */
     SR_SUBSCR_NO_ABORT_FOR_REFUSED_CFG = 16, /**< The subscriber will not receive ::SR_EV_ABORT if he returns an error in verify phase
                                               * (if the commit is refused by other verifier ::SR_EV_ABORT will be delivered). */
+    SR_SUBSCR_PUSH_CHANGES = 32, /**< The changes are delivered to the subscriber together with the notification (if their serialized
+                                      size does not exceed the internal limit). ::sr_get_changes_iter called from the callback
+                                      with the subscribed xpath (or "/module-name:*" for module change subscriptions) is then
+                                      served without any requests to sysrepo. Applicable to ::sr_module_change_subscribe and
+                                      ::sr_subtree_change_subscribe only. */
 } sr_subscr_flag_t;
 
 /**
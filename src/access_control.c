@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <assert.h>
@@ -34,6 +35,10 @@
 #include <sys/fsuid.h>
 #endif
 
+#ifdef HAVE_INOTIFY
+#include <sys/inotify.h>
+#endif
+
 /**
  * @brief Access Control module context.
  */
@@ -43,6 +48,11 @@ typedef struct ac_ctx_s {
     uid_t proc_euid;              /**< Effective uid of the process at the time of initialization. */
     gid_t proc_egid;              /**< Effective gid of the process at the time of initialization. */
     pthread_mutex_t lock;         /**< Context lock. Used for mutual exclusion if we are changing process-wide settings. */
+    sr_omap_t *decision_cache;    /**< Access control decisions shared by all sessions (ac_decision_t), NULL if disabled. */
+    int inotify_fd;               /**< Inotify instance watching the data files for permission changes. */
+    pthread_mutex_t cache_lock;   /**< Lock for the decision cache and its counters. */
+    uint64_t cache_hits;          /**< Number of decisions served from the decision cache. */
+    uint64_t cache_probes;        /**< Number of decisions that required a filesystem probe. */
 } ac_ctx_t;
 
 /**
@@ -51,7 +61,7 @@ typedef struct ac_ctx_s {
 typedef struct ac_session_s {
     ac_ctx_t *ac_ctx;                    /**< Access Control module context. */
     const ac_ucred_t *user_credentials;  /**< Credentials of the user. */
-    sr_btree_t *module_info_btree;       /**< User access control information tied to individual modules. */
+    sr_omap_t *module_info_btree;        /**< User access control information tied to individual modules. */
 } ac_session_t;
 
 /**
@@ -67,12 +77,37 @@ typedef enum ac_permission_e {
  * @brief Access control information tied to individual YANG modules.
  */
 typedef struct ac_module_info_s {
-    const char *module_name;                /**< Name of the module. */
+    const char *module_name;                /**< Name of the module (interned). */
     const char *xpath;                      /**< XPath used only for fast lookup. */
     ac_permission_t read_permission;        /**< Read permission is granted. */
     ac_permission_t read_write_permission;  /**< Read & write permissions are granted. */
 } ac_module_info_t;
 
+/**
+ * @brief Kind of an access control decision cached for a module.
+ */
+typedef enum ac_decision_kind_e {
+    AC_DECISION_READ,            /**< Read access to the data of the module. */
+    AC_DECISION_READ_WRITE,      /**< Read & write access to the data of the module. */
+    AC_DECISION_LOCK_STARTUP,    /**< Lock of the module in the startup datastore. */
+    AC_DECISION_LOCK_RUNNING,    /**< Lock of the module in the running datastore. */
+    AC_DECISION_LOCK_CANDIDATE,  /**< Lock of the module in the candidate datastore. */
+    AC_DECISION_KIND_COUNT,      /**< Number of the decision kinds. */
+} ac_decision_kind_t;
+
+/**
+ * @brief Access control decision shared by all sessions with the same credentials.
+ */
+typedef struct ac_decision_s {
+    const char *module_name;                /**< Name of the module (interned). */
+    uid_t r_uid;                            /**< Real user ID. */
+    gid_t r_gid;                            /**< Real group ID. */
+    bool effective;                         /**< TRUE if effective user has been provided. */
+    uid_t e_uid;                            /**< Effective user ID (if provided). */
+    gid_t e_gid;                            /**< Effective group ID (if provided). */
+    ac_permission_t permissions[AC_DECISION_KIND_COUNT];  /**< Decisions of individual kinds. */
+} ac_decision_t;
+
 /**
  * @brief Compares two ac_module_info_t structures stored in the binary tree.
  */
@@ -89,6 +124,8 @@ ac_module_info_cmp_cb(const void *a, const void *b)
         res = sr_cmp_first_ns(info_a->xpath, info_b->module_name);
     } else if (NULL != info_b->xpath) {
         res = sr_cmp_first_ns(info_b->xpath, info_a->module_name);
+    } else if (info_a->module_name == info_b->module_name) {
+        res = 0;
     } else {
         res = strcmp(info_a->module_name, info_b->module_name);
     }
@@ -109,11 +146,201 @@ ac_module_info_free_cb(void *item)
 {
     ac_module_info_t *info = (ac_module_info_t *) item;
     if (NULL != info) {
-        free((void*)info->module_name);
+        sr_str_release(info->module_name);
     }
     free(info);
 }
 
+/**
+ * @brief Compares two ac_decision_t structures stored in the binary tree.
+ */
+static int
+ac_decision_cmp_cb(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    ac_decision_t *dec_a = (ac_decision_t *) a;
+    ac_decision_t *dec_b = (ac_decision_t *) b;
+    int res = 0;
+
+    if (dec_a->r_uid != dec_b->r_uid) {
+        return (dec_a->r_uid < dec_b->r_uid) ? -1 : 1;
+    }
+    if (dec_a->r_gid != dec_b->r_gid) {
+        return (dec_a->r_gid < dec_b->r_gid) ? -1 : 1;
+    }
+    if (dec_a->effective != dec_b->effective) {
+        return dec_a->effective ? 1 : -1;
+    }
+    if (dec_a->effective && dec_a->e_uid != dec_b->e_uid) {
+        return (dec_a->e_uid < dec_b->e_uid) ? -1 : 1;
+    }
+    if (dec_a->effective && dec_a->e_gid != dec_b->e_gid) {
+        return (dec_a->e_gid < dec_b->e_gid) ? -1 : 1;
+    }
+
+    /* module names of the cached decisions and of the lookups are interned */
+    res = (dec_a->module_name == dec_b->module_name) ? 0 : strcmp(dec_a->module_name, dec_b->module_name);
+    if (res == 0) {
+        return 0;
+    } else if (res < 0) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Hashes ac_decision_t stored in the decision cache.
+ */
+static uint32_t
+ac_decision_hash_cb(const void *item)
+{
+    assert(item);
+    ac_decision_t *dec = (ac_decision_t *) item;
+
+    return sr_str_hash(dec->module_name) ^ ((uint32_t) dec->r_uid * 2654435761u);
+}
+
+/**
+ * @brief Frees ac_decision_t stored in the binary tree.
+ */
+static void
+ac_decision_free_cb(void *item)
+{
+    ac_decision_t *decision = (ac_decision_t *) item;
+    if (NULL != decision) {
+        sr_str_release(decision->module_name);
+    }
+    free(decision);
+}
+
+/**
+ * @brief Fills the lookup key of the decision cache from user credentials.
+ */
+static void
+ac_decision_key_fill(const ac_ucred_t *user_credentials, const char *module_name, ac_decision_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->module_name = module_name;
+    key->r_uid = user_credentials->r_uid;
+    key->r_gid = user_credentials->r_gid;
+    if (NULL != user_credentials->e_username) {
+        key->effective = true;
+        key->e_uid = user_credentials->e_uid;
+        key->e_gid = user_credentials->e_gid;
+    }
+}
+
+/**
+ * @brief Drops all entries of the decision cache. Cache lock is expected to be held.
+ */
+static void
+ac_decision_cache_clear(ac_ctx_t *ac_ctx)
+{
+    ac_decision_t *decision = NULL;
+
+    while (NULL != (decision = sr_omap_get_at(ac_ctx->decision_cache, 0))) {
+        sr_omap_delete(ac_ctx->decision_cache, decision);
+    }
+}
+
+/**
+ * @brief Drops the decision cache if the data files have been changed since the last call.
+ * Cache lock is expected to be held.
+ */
+static void
+ac_decision_cache_refresh(ac_ctx_t *ac_ctx)
+{
+#ifdef HAVE_INOTIFY
+    char buff[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+
+    /* the inotify descriptor is non-blocking, just drain pending events */
+    while (read(ac_ctx->inotify_fd, buff, sizeof(buff)) > 0) {
+        changed = true;
+    }
+    if (changed) {
+        SR_LOG_DBG_MSG("Data files have been changed, dropping access control decision cache.");
+        ac_decision_cache_clear(ac_ctx);
+    }
+#endif
+}
+
+/**
+ * @brief Looks up the decision of given kind for given credentials and module in the decision cache.
+ */
+static ac_permission_t
+ac_decision_cache_lookup(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials, const char *module_name,
+        const ac_decision_kind_t kind)
+{
+    ac_decision_t key = { 0, }, *decision = NULL;
+    ac_permission_t permission = AC_PERMISSION_UNKNOWN;
+
+    pthread_mutex_lock(&ac_ctx->cache_lock);
+
+    if (NULL != ac_ctx->decision_cache) {
+        ac_decision_cache_refresh(ac_ctx);
+        ac_decision_key_fill(user_credentials, module_name, &key);
+        decision = sr_omap_search(ac_ctx->decision_cache, &key);
+        if (NULL != decision) {
+            permission = decision->permissions[kind];
+        }
+    }
+
+    if (AC_PERMISSION_UNKNOWN != permission) {
+        ac_ctx->cache_hits++;
+    } else {
+        ac_ctx->cache_probes++;
+    }
+
+    pthread_mutex_unlock(&ac_ctx->cache_lock);
+
+    return permission;
+}
+
+/**
+ * @brief Stores the decision of given kind for given credentials and module into the decision cache.
+ */
+static void
+ac_decision_cache_store(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials, const char *module_name,
+        const ac_decision_kind_t kind, ac_permission_t permission)
+{
+    ac_decision_t key = { 0, }, *decision = NULL;
+    int rc = SR_ERR_OK;
+
+    pthread_mutex_lock(&ac_ctx->cache_lock);
+
+    if (NULL == ac_ctx->decision_cache) {
+        goto unlock;
+    }
+
+    ac_decision_key_fill(user_credentials, module_name, &key);
+    decision = sr_omap_search(ac_ctx->decision_cache, &key);
+    if (NULL == decision) {
+        decision = calloc(1, sizeof(*decision));
+        if (NULL == decision) {
+            goto unlock;
+        }
+        *decision = key;
+        rc = sr_str_intern(module_name, &decision->module_name);
+        if (SR_ERR_OK != rc) {
+            free(decision);
+            goto unlock;
+        }
+        rc = sr_omap_insert(ac_ctx->decision_cache, decision);
+        if (SR_ERR_OK != rc) {
+            ac_decision_free_cb(decision);
+            goto unlock;
+        }
+    }
+
+    decision->permissions[kind] = permission;
+
+unlock:
+    pthread_mutex_unlock(&ac_ctx->cache_lock);
+}
+
 /**
  * @brief Checks if the current user is able to access provided file for specified operation.
  */
@@ -214,17 +441,18 @@ ac_check_module_node_permissions(ac_session_t *session, const char *module_name,
 {
     ac_module_info_t lookup_info = { 0, };
     ac_module_info_t *module_info = NULL;
+    ac_permission_t permission = AC_PERMISSION_UNKNOWN;
     char *file_name = NULL;
     int rc = SR_ERR_OK;
 
-    CHECK_NULL_ARG2(session, session->ac_ctx);
+    CHECK_NULL_ARG3(session, session->ac_ctx, session->user_credentials);
 
     if (NULL != module_name) {
         lookup_info.module_name = module_name;
     } else {
         lookup_info.xpath = node_xpath;
     }
-    module_info = sr_btree_search(session->module_info_btree, &lookup_info);
+    module_info = sr_omap_search(session->module_info_btree, &lookup_info);
     if (NULL != module_info) {
         /* found match in cache, try to check from cache */
         if (AC_OPER_READ == operation && AC_PERMISSION_UNKNOWN != module_info->read_permission) {
@@ -249,28 +477,35 @@ ac_check_module_node_permissions(ac_session_t *session, const char *module_name,
             return SR_ERR_NOMEM;
         }
         if (NULL != module_name) {
-            module_info->module_name = strdup(module_name);
-            if (NULL ==  module_info->module_name) {
-                SR_LOG_ERR_MSG("Cannot duplicate module name.");
-                free(module_info);
-                return rc;
-            }
+            rc = sr_str_intern(module_name, &module_info->module_name);
         } else {
-            rc = sr_copy_first_ns(node_xpath, (char **) &module_info->module_name);
-            if (SR_ERR_OK != rc) {
-                SR_LOG_ERR_MSG("Cannot duplicate module name.");
-                free(module_info);
-                return rc;
-            }
+            rc = sr_intern_first_ns(node_xpath, &module_info->module_name);
         }
-        rc = sr_btree_insert(session->module_info_btree, module_info);
         if (SR_ERR_OK != rc) {
-            SR_LOG_ERR_MSG("Cannot insert new entry into binary tree for module access control info.");
+            SR_LOG_ERR_MSG("Cannot intern module name.");
             free(module_info);
+            return rc;
+        }
+        rc = sr_omap_insert(session->module_info_btree, module_info);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_ERR_MSG("Cannot insert new entry into binary tree for module access control info.");
+            ac_module_info_free_cb(module_info);
             return SR_ERR_INTERNAL;
         }
     }
 
+    /* try the decision cache shared by all sessions */
+    permission = ac_decision_cache_lookup(session->ac_ctx, session->user_credentials, module_info->module_name,
+            (AC_OPER_READ == operation) ? AC_DECISION_READ : AC_DECISION_READ_WRITE);
+    if (AC_PERMISSION_UNKNOWN != permission) {
+        if (AC_OPER_READ == operation) {
+            module_info->read_permission = permission;
+        } else {
+            module_info->read_write_permission = permission;
+        }
+        return (AC_PERMISSION_ALLOWED == permission) ? SR_ERR_OK : SR_ERR_UNAUTHORIZED;
+    }
+
     /* do the check */
     rc = sr_get_data_file_name(session->ac_ctx->data_search_dir, module_info->module_name, SR_DS_STARTUP, &file_name);
     if (SR_ERR_OK != rc) {
@@ -288,11 +523,14 @@ ac_check_module_node_permissions(ac_session_t *session, const char *module_name,
 
     /* save correct results in the cache */
     if (SR_ERR_OK == rc || SR_ERR_UNAUTHORIZED == rc) {
+        permission = (SR_ERR_OK == rc) ? AC_PERMISSION_ALLOWED : AC_PERMISSION_DENIED;
         if (AC_OPER_READ == operation) {
-            module_info->read_permission = (SR_ERR_OK == rc) ? AC_PERMISSION_ALLOWED : AC_PERMISSION_DENIED;
+            module_info->read_permission = permission;
         } else {
-            module_info->read_write_permission = (SR_ERR_OK == rc) ? AC_PERMISSION_ALLOWED : AC_PERMISSION_DENIED;
+            module_info->read_write_permission = permission;
         }
+        ac_decision_cache_store(session->ac_ctx, session->user_credentials, module_info->module_name,
+                (AC_OPER_READ == operation) ? AC_DECISION_READ : AC_DECISION_READ_WRITE, permission);
     }
 
     return rc;
@@ -311,10 +549,29 @@ ac_init(const char *data_search_dir, ac_ctx_t **ac_ctx)
     CHECK_NULL_NOMEM_RETURN(ctx);
 
     pthread_mutex_init(&ctx->lock, NULL);
+    pthread_mutex_init(&ctx->cache_lock, NULL);
+    ctx->inotify_fd = -1;
 
     ctx->data_search_dir = strdup(data_search_dir);
     CHECK_NULL_NOMEM_GOTO(ctx->data_search_dir, rc, cleanup);
 
+#ifdef HAVE_INOTIFY
+    /* decision cache can be shared only if the permission changes of the data files can be detected */
+    ctx->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (-1 != ctx->inotify_fd && -1 == inotify_add_watch(ctx->inotify_fd, data_search_dir,
+            IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)) {
+        close(ctx->inotify_fd);
+        ctx->inotify_fd = -1;
+    }
+    if (-1 != ctx->inotify_fd) {
+        rc = sr_omap_init(ac_decision_cmp_cb, ac_decision_hash_cb, ac_decision_free_cb, &ctx->decision_cache);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate binary tree for access control decision cache.");
+    } else {
+        SR_LOG_WRN("Unable to watch '%s' for permission changes, access control decision cache disabled: %s",
+                data_search_dir, sr_strerror_safe(errno));
+    }
+#endif
+
     /* save current euid and egid */
     ctx->proc_euid = geteuid();
     ctx->proc_egid = getegid();
@@ -339,11 +596,41 @@ ac_cleanup(ac_ctx_t *ac_ctx)
 {
     if (NULL != ac_ctx) {
         free((void*)ac_ctx->data_search_dir);
+        sr_omap_cleanup(ac_ctx->decision_cache);
+        if (-1 != ac_ctx->inotify_fd) {
+            close(ac_ctx->inotify_fd);
+        }
+        pthread_mutex_destroy(&ac_ctx->cache_lock);
         pthread_mutex_destroy(&ac_ctx->lock);
         free(ac_ctx);
     }
 }
 
+void
+ac_invalidate_cache(ac_ctx_t *ac_ctx)
+{
+    if (NULL != ac_ctx) {
+        pthread_mutex_lock(&ac_ctx->cache_lock);
+        if (NULL != ac_ctx->decision_cache) {
+            ac_decision_cache_clear(ac_ctx);
+        }
+        pthread_mutex_unlock(&ac_ctx->cache_lock);
+    }
+}
+
+int
+ac_get_cache_stats(ac_ctx_t *ac_ctx, uint64_t *hits, uint64_t *probes)
+{
+    CHECK_NULL_ARG3(ac_ctx, hits, probes);
+
+    pthread_mutex_lock(&ac_ctx->cache_lock);
+    *hits = ac_ctx->cache_hits;
+    *probes = ac_ctx->cache_probes;
+    pthread_mutex_unlock(&ac_ctx->cache_lock);
+
+    return SR_ERR_OK;
+}
+
 int
 ac_session_init(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials, ac_session_t **session_p)
 {
@@ -362,7 +649,7 @@ ac_session_init(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials, ac_session
     session->user_credentials = user_credentials;
 
     /* initialize binary tree for fast module info lookup */
-    rc = sr_btree_init(ac_module_info_cmp_cb, ac_module_info_free_cb, &session->module_info_btree);
+    rc = sr_omap_init(ac_module_info_cmp_cb, NULL, ac_module_info_free_cb, &session->module_info_btree);
     if (SR_ERR_OK != rc) {
         SR_LOG_ERR_MSG("Cannot allocate binary tree for module access control info.");
         free(session);
@@ -377,7 +664,7 @@ void
 ac_session_cleanup(ac_session_t *session)
 {
     if (NULL != session) {
-        sr_btree_cleanup(session->module_info_btree);
+        sr_omap_cleanup(session->module_info_btree);
         free(session);
     }
 }
@@ -457,6 +744,59 @@ ac_check_file_permissions(ac_session_t *session, const char *file_name, const ac
     return rc;
 }
 
+int
+ac_check_lock_permissions(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials, const char *module_name,
+        const sr_datastore_t datastore, const char *lock_file)
+{
+    ac_permission_t permission = AC_PERMISSION_UNKNOWN;
+    ac_decision_kind_t kind = AC_DECISION_LOCK_STARTUP + datastore;
+    const char *module_name_interned = NULL;
+    int rc = SR_ERR_OK, fd = -1;
+
+    CHECK_NULL_ARG3(ac_ctx, module_name, lock_file);
+
+    if (AC_DECISION_LOCK_CANDIDATE < kind) {
+        SR_LOG_ERR("Unknown datastore %d of the module %s lock.", datastore, module_name);
+        return SR_ERR_INVAL_ARG;
+    }
+
+    if (NULL != user_credentials) {
+        rc = sr_str_intern(module_name, &module_name_interned);
+        CHECK_RC_MSG_RETURN(rc, "Cannot intern module name.");
+        permission = ac_decision_cache_lookup(ac_ctx, user_credentials, module_name_interned, kind);
+        if (AC_PERMISSION_UNKNOWN != permission) {
+            sr_str_release(module_name_interned);
+            return (AC_PERMISSION_ALLOWED == permission) ? SR_ERR_OK : SR_ERR_UNAUTHORIZED;
+        }
+    }
+
+    /* the lock file is opened for writing (and created if it does not exist yet) with the user identity */
+    ac_set_user_identity(ac_ctx, user_credentials);
+    fd = open(lock_file, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+    if (-1 == fd) {
+        if (EACCES == errno) {
+            SR_LOG_ERR("Insufficient permissions to lock the file '%s'", lock_file);
+            rc = SR_ERR_UNAUTHORIZED;
+        } else {
+            SR_LOG_ERR("Error by opening the file '%s': %s", lock_file, sr_strerror_safe(errno));
+            rc = SR_ERR_INTERNAL;
+        }
+    } else {
+        close(fd);
+    }
+    ac_unset_user_identity(ac_ctx);
+
+    if (NULL != module_name_interned) {
+        if (SR_ERR_OK == rc || SR_ERR_UNAUTHORIZED == rc) {
+            permission = (SR_ERR_OK == rc) ? AC_PERMISSION_ALLOWED : AC_PERMISSION_DENIED;
+            ac_decision_cache_store(ac_ctx, user_credentials, module_name_interned, kind, permission);
+        }
+        sr_str_release(module_name_interned);
+    }
+
+    return rc;
+}
+
 int
 ac_set_user_identity(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials)
 {
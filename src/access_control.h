@@ -87,6 +87,28 @@ int ac_init(const char *data_search_dir, ac_ctx_t **ac_ctx);
  */
 void ac_cleanup(ac_ctx_t *ac_ctx);
 
+/**
+ * @brief Drops all access control decisions shared by the sessions.
+ *
+ * Changes of the data file permissions are detected automatically where inotify
+ * is available, this call is needed after operations that change the permissions
+ * in some other way (e.g. module (un)installation).
+ *
+ * @param[in] ac_ctx Access Control module context acquired by ::ac_init call.
+ */
+void ac_invalidate_cache(ac_ctx_t *ac_ctx);
+
+/**
+ * @brief Returns statistics of the access control decision cache.
+ *
+ * @param[in] ac_ctx Access Control module context acquired by ::ac_init call.
+ * @param[out] hits Number of module permission checks served from the decision cache.
+ * @param[out] probes Number of module permission checks that required checking the data file.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int ac_get_cache_stats(ac_ctx_t *ac_ctx, uint64_t *hits, uint64_t *probes);
+
 /**
  * @brief Starts a new session in Access Control module.
  *
@@ -144,6 +166,27 @@ int ac_check_node_permissions(ac_session_t *session, const char *node_xpath, con
  */
 int ac_check_file_permissions(ac_session_t *session, const char *file_name, const ac_operation_t operation);
 
+/**
+ * @brief Check if the user is allowed to lock specified module in specified datastore,
+ * which requires the lock file of the module to be writable by the user (the file is created
+ * if it does not exist yet).
+ *
+ * The decision is shared by all users with the same credentials in the same way as
+ * the module permissions, so repeated locks do not touch the lock file.
+ *
+ * @param[in] ac_ctx Access Control module context acquired by ::ac_init call.
+ * @param[in] user_credentials Credentials of the user, NULL to check with the process identity
+ * (the decision is not cached in that case).
+ * @param[in] module_name Name of the module.
+ * @param[in] datastore Datastore where the module is being locked.
+ * @param[in] lock_file Path to the lock file of the module in the datastore.
+ *
+ * @return Error code (SR_ERR_OK on success), SR_ERR_UNAUTHORIZED if the module can not be locked
+ * by the user.
+ */
+int ac_check_lock_permissions(ac_ctx_t *ac_ctx, const ac_ucred_t *user_credentials, const char *module_name,
+        const sr_datastore_t datastore, const char *lock_file);
+
 /**
  * @brief Switches the filesystem / effective uid and gid according to provided
  * user credentials, so that this thread / process will act as the specified user,
@@ -68,6 +68,8 @@ typedef struct sr_session_ctx_s {
     size_t error_cnt;             /**< Number of errors that occurred within last API call. */
     bool notif_session;           /**< Distinguishes internal notification session from other ones. */
     uint32_t commit_id;           /**< ID of the commit in case that this is a notification session (0 otherwise). */
+    Sr__ChangeSet *pushed_changes;    /**< Changes pushed within the notification being processed (NULL if none). */
+    sr_mem_ctx_t *pushed_changes_mem; /**< Sysrepo memory context of the notification message holding pushed changes. */
 } sr_session_ctx_t;
 
 /**
@@ -63,15 +63,15 @@ typedef struct cl_sm_ctx_s {
     /** Lock for the server contexts linked-list. */
     pthread_mutex_t server_ctx_lock;
 
-    /** Binary tree used for fast subscriber connection lookup by file descriptor. */
-    sr_btree_t *fd_btree;
+    /** Map used for fast subscriber connection lookup by file descriptor. */
+    sr_omap_t *fd_btree;
 
-    /** Binary tree of data connections to sysrepo, organized by destination socket address. */
-    sr_btree_t *data_connection_btree;
+    /** Map of data connections to sysrepo, organized by destination socket address. */
+    sr_omap_t *data_connection_btree;
 
-    /** Binary tree used for fast subscription lookup by id. */
-    sr_btree_t *subscriptions_btree;
-    /** Lock for the subscriptions binary tree. */
+    /** Map used for fast subscription lookup by id. */
+    sr_omap_t *subscriptions_btree;
+    /** Lock for the subscriptions map. */
     pthread_mutex_t subscriptions_lock;
 
     /** Determines whether application-local file descriptor watcher is in place or not. */
@@ -170,7 +170,7 @@ cl_sm_get_fd_change_set(cl_sm_ctx_t *sm_ctx, sr_fd_change_t **fd_change_set, siz
 
 /**
  * @brief Compares two subscriptions by their id
- * (used by lookups in the binary tree).
+ * (used by lookups in the map).
  */
 static int
 cl_sm_subscription_cmp_id(const void *a, const void *b)
@@ -192,7 +192,7 @@ cl_sm_subscription_cmp_id(const void *a, const void *b)
 /**
  * @brief Cleans up a subscription entry.
  * Releases all resources held Subscription Manager.
- * @note Called automatically when a node from the binary tree is removed
+ * @note Called automatically when an item is removed from the map
  * (which is also when the tree itself is being destroyed).
  */
 static void
@@ -209,7 +209,7 @@ cl_sm_subscription_cleanup_internal(void *subscription_p)
 
 /**
  * @brief Compares two data connections by associated destination addresses
- * (used by lookups in data connection binary tree).
+ * (used by lookups in data connection map).
  */
 static int
 cl_sm_data_connection_cmp_dst(const void *a, const void *b)
@@ -236,7 +236,7 @@ cl_sm_data_connection_cmp_dst(const void *a, const void *b)
 
 /**
  * @brief Cleans up a data connection entry.
- * @note Called automatically when a node from the binary tree is removed
+ * @note Called automatically when an item is removed from the map
  * (which is also when the tree itself is being destroyed).
  */
 static void
@@ -247,7 +247,7 @@ cl_sm_data_connection_cleanup(void *connection)
 
 /**
  * @brief Compares two connections by file descriptors
- * (used by lookups in fd binary tree).
+ * (used by lookups in fd map).
  */
 static int
 cl_sm_connection_cmp_fd(const void *a, const void *b)
@@ -269,7 +269,7 @@ cl_sm_connection_cmp_fd(const void *a, const void *b)
 /**
  * @brief Cleans up a connection entry. Releases all resources held in connection
  * context by Subscription Manager.
- * @note Called automatically when a node from fd binary tree is removed
+ * @note Called automatically when an item is removed from fd map
  * (which is also when the tree itself is being destroyed).
  */
 static void
@@ -320,8 +320,8 @@ cl_sm_connection_add(cl_sm_ctx_t *sm_ctx, int fd, cl_sm_conn_ctx_t **conn_p)
     conn->sm_ctx = sm_ctx;
     conn->fd = fd;
 
-    rc = sr_btree_insert(sm_ctx->fd_btree, conn);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot insert new entry into fd binary tree (duplicate fd?).");
+    rc = sr_omap_insert(sm_ctx->fd_btree, conn);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot insert new entry into fd map (duplicate fd?).");
 
     *conn_p = conn;
     return rc;
@@ -340,7 +340,7 @@ cl_sm_conn_close(cl_sm_ctx_t *sm_ctx, cl_sm_conn_ctx_t *conn)
 
     CHECK_NULL_ARG2(sm_ctx, conn);
 
-    sr_btree_delete(sm_ctx->fd_btree, conn); /* sm_connection_cleanup auto-invoked */
+    sr_omap_delete(sm_ctx->fd_btree, conn); /* sm_connection_cleanup auto-invoked */
 
     return SR_ERR_OK;
 }
@@ -447,12 +447,12 @@ cl_sm_get_data_session(cl_sm_ctx_t *sm_ctx, cl_sm_subscription_ctx_t *subscripti
 
     /* find a connection matching with provided address */
     connection_lookup.dst_address = source_address;
-    connection = sr_btree_search(sm_ctx->data_connection_btree, &connection_lookup);
+    connection = sr_omap_search(sm_ctx->data_connection_btree, &connection_lookup);
 
     if (NULL != connection && connection->dst_pid != source_pid) {
         /* new PID on the destination address - reconnect */
         SR_LOG_DBG("New PID on the destination address '%s' - reconnect.", source_address);
-        sr_btree_delete(sm_ctx->data_connection_btree, connection);
+        sr_omap_delete(sm_ctx->data_connection_btree, connection);
         connection = NULL;
     }
 
@@ -469,7 +469,7 @@ cl_sm_get_data_session(cl_sm_ctx_t *sm_ctx, cl_sm_subscription_ctx_t *subscripti
             rc = cl_socket_connect(connection, connection->dst_address);
         }
         if (SR_ERR_OK == rc) {
-            rc = sr_btree_insert(sm_ctx->data_connection_btree, connection);
+            rc = sr_omap_insert(sm_ctx->data_connection_btree, connection);
         }
         if (SR_ERR_OK != rc) {
             SR_LOG_ERR("Unable to connect to the notification originator at '%s'.", source_address);
@@ -547,7 +547,7 @@ cl_sm_close_data_session(cl_sm_ctx_t *sm_ctx, cl_sm_subscription_ctx_t *subscrip
 
     /* find a connection matching with provided address */
     connection_lookup.dst_address = source_address;
-    connection = sr_btree_search(sm_ctx->data_connection_btree, &connection_lookup);
+    connection = sr_omap_search(sm_ctx->data_connection_btree, &connection_lookup);
 
     if (NULL == connection || NULL == connection->session_list) {
         /* no connection / sessions for this source address */
@@ -641,7 +641,7 @@ cl_sm_notif_process(cl_sm_ctx_t *sm_ctx, cl_sm_conn_ctx_t *conn, Sr__Msg *msg)
 
     /* find the subscription according to id */
     subscription_lookup.id = msg->notification->subscription_id;
-    subscription = sr_btree_search(sm_ctx->subscriptions_btree, &subscription_lookup);
+    subscription = sr_omap_search(sm_ctx->subscriptions_btree, &subscription_lookup);
     if (NULL == subscription) {
         pthread_mutex_unlock(&sm_ctx->subscriptions_lock);
         SR_LOG_ERR("No matching subscription for subscription id=%"PRIu32".", msg->notification->subscription_id);
@@ -690,19 +690,27 @@ cl_sm_notif_process(cl_sm_ctx_t *sm_ctx, cl_sm_conn_ctx_t *conn, Sr__Msg *msg)
             break;
         case SR__SUBSCRIPTION_TYPE__MODULE_CHANGE_SUBS:
             SR_LOG_DBG("Calling module-change callback for subscription id=%"PRIu32".", subscription->id);
+            data_session->pushed_changes = msg->notification->changes;
+            data_session->pushed_changes_mem = (sr_mem_ctx_t *)msg->_sysrepo_mem_ctx;
             rc = subscription->callback.module_change_cb(
                     data_session,
                     msg->notification->module_change_notif->module_name,
                     sr_notification_event_gpb_to_sr(msg->notification->module_change_notif->event),
                     subscription->private_ctx);
+            data_session->pushed_changes = NULL;
+            data_session->pushed_changes_mem = NULL;
             break;
         case SR__SUBSCRIPTION_TYPE__SUBTREE_CHANGE_SUBS:
             SR_LOG_DBG("Calling subtree-change callback for subscription id=%"PRIu32".", subscription->id);
+            data_session->pushed_changes = msg->notification->changes;
+            data_session->pushed_changes_mem = (sr_mem_ctx_t *)msg->_sysrepo_mem_ctx;
             rc = subscription->callback.subtree_change_cb(
                     data_session,
                     msg->notification->subtree_change_notif->xpath,
                     sr_notification_event_gpb_to_sr(msg->notification->subtree_change_notif->event),
                     subscription->private_ctx);
+            data_session->pushed_changes = NULL;
+            data_session->pushed_changes_mem = NULL;
             break;
         case SR__SUBSCRIPTION_TYPE__HELLO_SUBS:
             SR_LOG_DBG("HELLO notification received on subscription id=%"PRIu32".", subscription->id);
@@ -788,7 +796,7 @@ cl_sm_dp_request_process(cl_sm_ctx_t *sm_ctx, cl_sm_conn_ctx_t *conn, Sr__Msg *m
 
     /* find the subscription according to id */
     subscription_lookup.id = msg->request->data_provide_req->subscription_id;
-    subscription = sr_btree_search(sm_ctx->subscriptions_btree, &subscription_lookup);
+    subscription = sr_omap_search(sm_ctx->subscriptions_btree, &subscription_lookup);
     if (NULL == subscription) {
         pthread_mutex_unlock(&sm_ctx->subscriptions_lock);
         SR_LOG_ERR("No matching subscription for subscription id=%"PRIu32".", msg->request->data_provide_req->subscription_id);
@@ -873,7 +881,7 @@ cl_sm_rpc_process(cl_sm_ctx_t *sm_ctx, cl_sm_conn_ctx_t *conn, Sr__Msg *msg)
 
     /* find the subscription according to id */
     subscription_lookup.id = msg->request->rpc_req->subscription_id;
-    subscription = sr_btree_search(sm_ctx->subscriptions_btree, &subscription_lookup);
+    subscription = sr_omap_search(sm_ctx->subscriptions_btree, &subscription_lookup);
     if (NULL == subscription) {
         pthread_mutex_unlock(&sm_ctx->subscriptions_lock);
         SR_LOG_ERR("No matching subscription for subscription id=%"PRIu32".", msg->request->rpc_req->subscription_id);
@@ -970,7 +978,7 @@ cl_sm_event_notif_process(cl_sm_ctx_t *sm_ctx, cl_sm_conn_ctx_t *conn, Sr__Msg *
 
     /* find the subscription according to id */
     subscription_lookup.id = msg->request->event_notif_req->subscription_id;
-    subscription = sr_btree_search(sm_ctx->subscriptions_btree, &subscription_lookup);
+    subscription = sr_omap_search(sm_ctx->subscriptions_btree, &subscription_lookup);
     if (NULL == subscription) {
         pthread_mutex_unlock(&sm_ctx->subscriptions_lock);
         SR_LOG_ERR("No matching subscription for subscription id=%"PRIu32".",
@@ -1125,7 +1133,7 @@ cl_sm_fd_read_data(cl_sm_ctx_t *sm_ctx, int fd)
 
     /* find matching connection context */
     tmp_conn.fd = fd;
-    conn = sr_btree_search(sm_ctx->fd_btree, &tmp_conn);
+    conn = sr_omap_search(sm_ctx->fd_btree, &tmp_conn);
     if (NULL == conn) {
         SR_LOG_ERR("Invalid file descriptor fd=%d, matching subscriber connection not found.", fd);
         return SR_ERR_INVAL_ARG;
@@ -1637,18 +1645,18 @@ cl_sm_init(bool local_fd_watcher, int notify_pipe[2], cl_sm_ctx_t **sm_ctx_p)
     rc = sr_llist_init(&ctx->server_ctx_list);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot initialize linked-list for server contexts.");
 
-    /* create binary tree for fast connection lookup by fd,
+    /* create map for fast connection lookup by fd,
      * with automatic cleanup when the session is removed from tree */
-    rc = sr_btree_init(cl_sm_connection_cmp_fd, cl_sm_connection_cleanup, &ctx->fd_btree);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate binary tree for FDd.");
+    rc = sr_omap_init(cl_sm_connection_cmp_fd, NULL, cl_sm_connection_cleanup, &ctx->fd_btree);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate map for FDd.");
 
-    /* create binary tree for fast subscription lookup by id */
-    rc = sr_btree_init(cl_sm_subscription_cmp_id, cl_sm_subscription_cleanup_internal, &ctx->subscriptions_btree);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate binary tree for subscription IDs.");
+    /* create map for fast subscription lookup by id */
+    rc = sr_omap_init(cl_sm_subscription_cmp_id, NULL, cl_sm_subscription_cleanup_internal, &ctx->subscriptions_btree);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate map for subscription IDs.");
 
-    /* create binary tree for fast data connection lookup by destination (socket) string */
-    rc = sr_btree_init(cl_sm_data_connection_cmp_dst, cl_sm_data_connection_cleanup, &ctx->data_connection_btree);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate binary tree for data connections.");
+    /* create map for fast data connection lookup by destination (socket) string */
+    rc = sr_omap_init(cl_sm_data_connection_cmp_dst, NULL, cl_sm_data_connection_cleanup, &ctx->data_connection_btree);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate map for data connections.");
 
     /* initialize the mutexes */
     ret = pthread_mutex_init(&ctx->server_ctx_lock, NULL);
@@ -1708,9 +1716,9 @@ cl_sm_cleanup(cl_sm_ctx_t *sm_ctx, bool join)
         }
         cl_sm_servers_cleanup(sm_ctx);
 
-        sr_btree_cleanup(sm_ctx->data_connection_btree);
-        sr_btree_cleanup(sm_ctx->subscriptions_btree);
-        sr_btree_cleanup(sm_ctx->fd_btree);
+        sr_omap_cleanup(sm_ctx->data_connection_btree);
+        sr_omap_cleanup(sm_ctx->subscriptions_btree);
+        sr_omap_cleanup(sm_ctx->fd_btree);
         sr_llist_cleanup(sm_ctx->server_ctx_list);
 
         pthread_mutex_destroy(&sm_ctx->server_ctx_lock);
@@ -1793,7 +1801,7 @@ cl_sm_subscription_init(cl_sm_ctx_t *sm_ctx, cl_sm_server_ctx_t *server_ctx, cl_
     size_t attempts = 0;
     do {
         subscription->id = rand();
-        if (NULL != sr_btree_search(sm_ctx->subscriptions_btree, subscription)) {
+        if (NULL != sr_omap_search(sm_ctx->subscriptions_btree, subscription)) {
             subscription->id = CL_SM_SUBSCRIPTION_ID_INVALID;
         }
         if (++attempts > CL_SM_SUBSCRIPTION_ID_MAX_ATTEMPTS) {
@@ -1804,12 +1812,12 @@ cl_sm_subscription_init(cl_sm_ctx_t *sm_ctx, cl_sm_server_ctx_t *server_ctx, cl_
         }
     } while (CL_SM_SUBSCRIPTION_ID_INVALID == subscription->id);
 
-    /* insert the subscription into the binary tree */
-    rc = sr_btree_insert(sm_ctx->subscriptions_btree, subscription);
+    /* insert the subscription into the map */
+    rc = sr_omap_insert(sm_ctx->subscriptions_btree, subscription);
 
     pthread_mutex_unlock(&sm_ctx->subscriptions_lock);
 
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot insert new entry into subscription binary tree (duplicate id?).");
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot insert new entry into subscription map (duplicate id?).");
 
     subscription->delivery_address = server_ctx->socket_path;
     *subscription_p = subscription;
@@ -1832,7 +1840,7 @@ cl_sm_subscription_cleanup(cl_sm_subscription_ctx_t *subscription)
     pthread_mutex_lock(&sm_ctx->subscriptions_lock);
 
     /* cl_sm_subscription_cleanup_internal will be auto-invoked */
-    sr_btree_delete(sm_ctx->subscriptions_btree, subscription);
+    sr_omap_delete(sm_ctx->subscriptions_btree, subscription);
 
     pthread_mutex_unlock(&sm_ctx->subscriptions_lock);
 }
@@ -1875,7 +1883,7 @@ cl_sm_fd_event_process(cl_sm_ctx_t *sm_ctx, int fd, sr_fd_event_t event,
         } else {
             /* the file descriptor is writeable */
             tmp_conn.fd = fd;
-            conn = sr_btree_search(sm_ctx->fd_btree, &tmp_conn);
+            conn = sr_omap_search(sm_ctx->fd_btree, &tmp_conn);
             rc = cl_sm_write_conn(sm_ctx, conn);
         }
     }
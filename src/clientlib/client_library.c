@@ -79,6 +79,8 @@ typedef struct sr_val_iter_s {
     sr_val_t **buff_values;         /**< Buffered values. */
     size_t index;                   /**< Index into buff_values pointing to the value to be returned by next call. */
     size_t count;                   /**< Number of elements currently buffered. */
+    Sr__Msg *block_msg;             /**< Response with the buffered values in a value block, they are decoded on demand (NULL if the values are in buff_values). */
+    sr_value_block_reader_t reader; /**< Reader of the value block of block_msg. */
 } sr_val_iter_t;
 
 /**
@@ -93,6 +95,7 @@ typedef struct sr_change_iter_s {
     sr_val_t **old_values;          /**< Buffered old values. */
     size_t index;                   /**< Index into buff_values pointing to the value to be returned by next call. */
     size_t count;                   /**< Number of elements currently buffered. */
+    bool complete;                  /**< TRUE if all changes are buffered, no more changes are fetched. */
 } sr_change_iter_t;
 
 static int connections_cnt = 0;               /**< Number of active connections to the Sysrepo Engine. */
@@ -150,6 +153,8 @@ cl_send_get_items_iter(sr_session_ctx_t *session, const char *xpath, size_t offs
     msg_req->request->get_items_req->offset = offset;
     msg_req->request->get_items_req->has_limit = true;
     msg_req->request->get_items_req->has_offset = true;
+    msg_req->request->get_items_req->compact = true;
+    msg_req->request->get_items_req->has_compact = true;
 
     /* send the request and receive the response */
     rc = cl_request_process(session, msg_req, msg_resp, NULL, SR__OPERATION__GET_ITEMS);
@@ -167,6 +172,71 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Buffers values received in a get_items response in the iterator, releasing the previously
+ * buffered ones. Values received in a value block are kept encoded in the response and decoded
+ * one by one in ::sr_get_item_next. Takes ownership of the response.
+ */
+static int
+cl_val_iter_load(sr_val_iter_t *iter, Sr__Msg *msg_resp)
+{
+    Sr__GetItemsResp *get_items_resp = NULL;
+    sr_val_t **tmp = NULL;
+    size_t count = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG(iter);
+
+    if (NULL != iter->block_msg) {
+        sr_value_block_reader_cleanup(&iter->reader);
+        sr_msg_free(iter->block_msg);
+        iter->block_msg = NULL;
+    }
+    iter->index = 0;
+    iter->count = 0;
+
+    if (NULL == msg_resp || NULL == msg_resp->response || NULL == msg_resp->response->get_items_resp) {
+        goto cleanup;
+    }
+    get_items_resp = msg_resp->response->get_items_resp;
+
+    if (NULL != get_items_resp->value_block) {
+        sr_value_block_reader_init(get_items_resp->value_block, &iter->reader);
+        iter->block_msg = msg_resp;
+        iter->count = get_items_resp->value_block->n_types;
+        return SR_ERR_OK;
+    }
+
+    count = get_items_resp->n_values;
+    if (0 < count) {
+        /* realloc the array for buffered values pointers */
+        tmp = realloc(iter->buff_values, count * sizeof(*iter->buff_values));
+        CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
+        iter->buff_values = tmp;
+    }
+
+    /* copy the content of gpb to sr_val_t */
+    for (size_t i = 0; i < count; i++) {
+        rc = sr_dup_gpb_to_val_t((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx, get_items_resp->values[i],
+                &iter->buff_values[i]);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_ERR_MSG("Copying from gpb to sr_val_t failed");
+            for (size_t j = 0; j < i; j++) {
+                sr_free_val(iter->buff_values[j]);
+            }
+            rc = SR_ERR_INTERNAL;
+            goto cleanup;
+        }
+    }
+    iter->count = count;
+
+cleanup:
+    if (NULL != msg_resp) {
+        sr_msg_free(msg_resp);
+    }
+    return rc;
+}
+
 /**
  * @brief Creates get_changes request and sends it
  */
@@ -876,14 +946,21 @@ sr_get_items(sr_session_ctx_t *session, const char *xpath, sr_val_t **values, si
     /* fill in the path */
     sr_mem_edit_string(sr_mem, &msg_req->request->get_items_req->xpath, xpath);
     CHECK_NULL_NOMEM_GOTO(msg_req->request->get_items_req->xpath, rc, cleanup);
+    msg_req->request->get_items_req->compact = true;
+    msg_req->request->get_items_req->has_compact = true;
 
     /* send the request and receive the response */
     rc = cl_request_process(session, msg_req, &msg_resp, NULL, SR__OPERATION__GET_ITEMS);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Error by processing of the request.");
 
     /* copy the content of gpb values to sr_val_t */
-    rc = sr_values_gpb_to_sr((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx, msg_resp->response->get_items_resp->values,
-                             msg_resp->response->get_items_resp->n_values, values, value_cnt);
+    if (NULL != msg_resp->response->get_items_resp->value_block) {
+        rc = sr_values_gpb_block_to_sr((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx,
+                msg_resp->response->get_items_resp->value_block, values, value_cnt);
+    } else {
+        rc = sr_values_gpb_to_sr((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx, msg_resp->response->get_items_resp->values,
+                msg_resp->response->get_items_resp->n_values, values, value_cnt);
+    }
     CHECK_RC_MSG_GOTO(rc, cleanup, "Error by copying the values from GPB.");
 
 cleanup:
@@ -921,42 +998,23 @@ sr_get_items_iter(sr_session_ctx_t *session, const char *xpath, sr_val_iter_t **
     it = calloc(1, sizeof(*it));
     CHECK_NULL_NOMEM_GOTO(it, rc, cleanup);
 
-    it->index = 0;
-    it->count = msg_resp->response->get_items_resp->n_values;
-    it->offset = it->count;
-
     it->xpath = strdup(xpath);
     CHECK_NULL_NOMEM_GOTO(it->xpath, rc, cleanup);
 
-    it->buff_values = calloc(it->count, sizeof(*it->buff_values));
-    CHECK_NULL_NOMEM_GOTO(it->buff_values, rc, cleanup);
-
-    /* copy the content of gpb to sr_val_t */
-    for (size_t i = 0; i < it->count; i++) {
-        rc = sr_dup_gpb_to_val_t((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx,
-                                 msg_resp->response->get_items_resp->values[i], &it->buff_values[i]);
-        if (SR_ERR_OK != rc) {
-            SR_LOG_ERR_MSG("Copying from gpb to sr_val_t failed");
-            sr_free_values_arr(it->buff_values, i);
-            rc = SR_ERR_INTERNAL;
-            goto cleanup;
-        }
-    }
+    rc = cl_val_iter_load(it, msg_resp);
+    msg_resp = NULL;
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Copying from gpb to sr_val_t failed");
+    it->offset = it->count;
 
     *iter = it;
 
-    sr_msg_free(msg_resp);
-
     return cl_session_return(session, SR_ERR_OK);
 
 cleanup:
     if (NULL != msg_resp) {
         sr_msg_free(msg_resp);
     }
-    if (NULL != it){
-        free(it->xpath);
-        free(it);
-    }
+    sr_free_val_iter(it);
     return cl_session_return(session, rc);
 }
 
@@ -974,10 +1032,7 @@ sr_get_item_next(sr_session_ctx_t *session, sr_val_iter_t *iter, sr_val_t **valu
         /* No more data to be read */
         *value = NULL;
         return SR_ERR_NOT_FOUND;
-    } else if (iter->index < iter->count) {
-        /* There are buffered data */
-        *value = iter->buff_values[iter->index++];
-    } else {
+    } else if (iter->index >= iter->count) {
         /* Fetch more items */
         rc = cl_send_get_items_iter(session, iter->xpath, iter->offset,
                 CL_GET_ITEMS_FETCH_LIMIT, &msg_resp);
@@ -988,38 +1043,25 @@ sr_get_item_next(sr_session_ctx_t *session, sr_val_iter_t *iter, sr_val_t **valu
             CHECK_RC_LOG_GOTO(rc, cleanup, "Fetching more items failed '%s'", iter->xpath);
         }
 
-        size_t received_cnt = msg_resp->response->get_items_resp->n_values;
-        if (0 == received_cnt) {
+        rc = cl_val_iter_load(iter, msg_resp);
+        msg_resp = NULL;
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Copying from gpb to sr_val_t failed");
+        if (0 == iter->count) {
             /* There is no more data to be read */
             *value = NULL;
             rc = SR_ERR_NOT_FOUND;
             goto cleanup;
         }
-        if (iter->count < received_cnt) {
-            /* realloc the array for buffered values pointers */
-            sr_val_t **tmp = NULL;
-            tmp = realloc(iter->buff_values, received_cnt * sizeof(*iter->buff_values));
-            CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
-            iter->buff_values = tmp;
-        }
-        iter->index = 0;
-        iter->count = received_cnt;
+        iter->offset += iter->count;
+    }
 
-        /* copy the content of gpb to sr_val_t*/
-        for (size_t i = 0; i < iter->count; i++){
-            rc = sr_dup_gpb_to_val_t((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx,
-                    msg_resp->response->get_items_resp->values[i], &iter->buff_values[i]);
-            if (SR_ERR_OK != rc) {
-                SR_LOG_ERR_MSG("Copying from gpb to sr_val_t failed");
-                sr_free_values_arr(iter->buff_values, i);
-                iter->count = 0;
-                rc = SR_ERR_INTERNAL;
-                goto cleanup;
-            }
-        }
+    /* return buffered data */
+    if (NULL != iter->block_msg) {
+        rc = sr_value_block_dup_next(&iter->reader, (sr_mem_ctx_t *)iter->block_msg->_sysrepo_mem_ctx, value);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Copying from gpb value block to sr_val_t failed");
+        iter->index++;
+    } else {
         *value = iter->buff_values[iter->index++];
-        iter->offset+=received_cnt;
-        sr_msg_free(msg_resp);
     }
     return cl_session_return(session, SR_ERR_OK);
 
@@ -1037,7 +1079,14 @@ sr_free_val_iter(sr_val_iter_t *iter){
     }
     free(iter->xpath);
     iter->xpath = NULL;
-    if (NULL != iter->buff_values) {
+    if (NULL != iter->block_msg) {
+        /* values that has not been passed to user are still encoded in the block */
+        sr_value_block_reader_cleanup(&iter->reader);
+        sr_msg_free(iter->block_msg);
+        iter->block_msg = NULL;
+        free(iter->buff_values);
+        iter->buff_values = NULL;
+    } else if (NULL != iter->buff_values) {
         /* free items that has not been passed to user already*/
         sr_free_values_arr_range(iter->buff_values, iter->index, iter->count);
         iter->buff_values = NULL;
@@ -2364,6 +2413,8 @@ sr_module_change_subscribe(sr_session_ctx_t *session, const char *module_name, s
     msg_req->request->subscribe_req->enable_running = !(opts & SR_SUBSCR_PASSIVE);
     msg_req->request->subscribe_req->has_enable_event = true;
     msg_req->request->subscribe_req->enable_event = (opts & SR_SUBSCR_EV_ENABLED);
+    msg_req->request->subscribe_req->has_push_changes = true;
+    msg_req->request->subscribe_req->push_changes = (opts & SR_SUBSCR_PUSH_CHANGES);
 
     /* send the request and receive the response */
     rc = cl_request_process(session, msg_req, &msg_resp, NULL, SR__OPERATION__SUBSCRIBE);
@@ -2441,6 +2492,8 @@ sr_subtree_change_subscribe(sr_session_ctx_t *session, const char *xpath, sr_sub
     msg_req->request->subscribe_req->enable_running = !(opts & SR_SUBSCR_PASSIVE);
     msg_req->request->subscribe_req->has_enable_event = true;
     msg_req->request->subscribe_req->enable_event = (opts & SR_SUBSCR_EV_ENABLED);
+    msg_req->request->subscribe_req->has_push_changes = true;
+    msg_req->request->subscribe_req->push_changes = (opts & SR_SUBSCR_PUSH_CHANGES);
 
     /* send the request and receive the response */
     rc = cl_request_process(session, msg_req, &msg_resp, NULL, SR__OPERATION__SUBSCRIBE);
@@ -2469,6 +2522,45 @@ cleanup:
     return cl_session_return(session, rc);
 }
 
+/**
+ * @brief Fills the change iterator with the changes received from sysrepo.
+ */
+static int
+cl_change_iter_fill(sr_change_iter_t *it, sr_mem_ctx_t *sr_mem, Sr__Change **changes, size_t change_cnt)
+{
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG(it);
+
+    it->operations = calloc(change_cnt, sizeof(*it->operations));
+    CHECK_NULL_NOMEM_RETURN(it->operations);
+
+    it->old_values = calloc(change_cnt, sizeof(*it->old_values));
+    CHECK_NULL_NOMEM_RETURN(it->old_values);
+
+    it->new_values = calloc(change_cnt, sizeof(*it->new_values));
+    CHECK_NULL_NOMEM_RETURN(it->new_values);
+
+    it->index = 0;
+    it->count = change_cnt;
+    it->offset = it->count;
+
+    /* copy the content of gpb to sr_val_t */
+    for (size_t i = 0; i < it->count; i++) {
+        if (NULL != changes[i]->new_value) {
+            rc = sr_dup_gpb_to_val_t(sr_mem, changes[i]->new_value, &it->new_values[i]);
+            CHECK_RC_MSG_RETURN(rc, "Copying from gpb to sr_val_t failed");
+        }
+        if (NULL != changes[i]->old_value) {
+            rc = sr_dup_gpb_to_val_t(sr_mem, changes[i]->old_value, &it->old_values[i]);
+            CHECK_RC_MSG_RETURN(rc, "Copying from gpb to sr_val_t failed");
+        }
+        it->operations[i] = sr_change_op_gpb_to_sr(changes[i]->changeoperation);
+    }
+
+    return SR_ERR_OK;
+}
+
 int
 sr_get_changes_iter(sr_session_ctx_t *session, const char *xpath, sr_change_iter_t **iter)
 {
@@ -2480,52 +2572,41 @@ sr_get_changes_iter(sr_session_ctx_t *session, const char *xpath, sr_change_iter
 
     cl_session_clear_errors(session);
 
-    rc = cl_send_get_changes(session, xpath, 0, CL_GET_ITEMS_FETCH_LIMIT, &msg_resp);
-    if (SR_ERR_NOT_FOUND == rc) {
-        SR_LOG_DBG("No items found for xpath '%s'", xpath);
-        /* SR_ERR_NOT_FOUND will be returned on get_change_next call */
-        rc = SR_ERR_OK;
-    } else {
-        CHECK_RC_LOG_GOTO(rc, cleanup, "Sending get_changes request failed '%s'", xpath);
-    }
-
     it = calloc(1, sizeof(*it));
     CHECK_NULL_NOMEM_GOTO(it, rc, cleanup);
 
-    it->index = 0;
-    it->count = msg_resp->response->get_changes_resp->n_changes;
-    it->offset = it->count;
-
     it->xpath = strdup(xpath);
     CHECK_NULL_NOMEM_GOTO(it->xpath, rc, cleanup);
 
-    it->operations = calloc(it->count, sizeof(*it->operations));
-    CHECK_NULL_NOMEM_GOTO(it->operations, rc, cleanup);
-
-    it->old_values = calloc(it->count, sizeof(*it->old_values));
-    CHECK_NULL_NOMEM_GOTO(it->old_values, rc, cleanup);
-
-    it->new_values = calloc(it->count, sizeof(*it->new_values));
-    CHECK_NULL_NOMEM_GOTO(it->new_values, rc, cleanup);
-
-    /* copy the content of gpb to sr_val_t */
-    for (size_t i = 0; i < it->count; i++) {
-        if (NULL != msg_resp->response->get_changes_resp->changes[i]->new_value) {
-            rc = sr_dup_gpb_to_val_t((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx,
-                                     msg_resp->response->get_changes_resp->changes[i]->new_value, &it->new_values[i]);
-            CHECK_RC_MSG_GOTO(rc, cleanup, "Copying from gpb to sr_val_t failed");
+    if (NULL != session->pushed_changes && 0 == strcmp(xpath, session->pushed_changes->xpath)) {
+        /* all changes have been delivered with the notification */
+        SR_LOG_DBG("Using changes pushed with the notification for xpath '%s'", xpath);
+        rc = cl_change_iter_fill(it, session->pushed_changes_mem, session->pushed_changes->changes,
+                session->pushed_changes->n_changes);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Filling of the change iterator failed");
+        it->complete = true;
+    } else {
+        rc = cl_send_get_changes(session, xpath, 0, CL_GET_ITEMS_FETCH_LIMIT, &msg_resp);
+        if (SR_ERR_NOT_FOUND == rc) {
+            SR_LOG_DBG("No items found for xpath '%s'", xpath);
+            /* SR_ERR_NOT_FOUND will be returned on get_change_next call */
+            rc = SR_ERR_OK;
+        } else {
+            CHECK_RC_LOG_GOTO(rc, cleanup, "Sending get_changes request failed '%s'", xpath);
         }
-        if (NULL != msg_resp->response->get_changes_resp->changes[i]->old_value) {
-            rc = sr_dup_gpb_to_val_t((sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx,
-                                     msg_resp->response->get_changes_resp->changes[i]->old_value, &it->old_values[i]);
-            CHECK_RC_MSG_GOTO(rc, cleanup, "Copying from gpb to sr_val_t failed");
+
+        if (NULL != msg_resp) {
+            rc = cl_change_iter_fill(it, (sr_mem_ctx_t *)msg_resp->_sysrepo_mem_ctx,
+                    msg_resp->response->get_changes_resp->changes, msg_resp->response->get_changes_resp->n_changes);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "Filling of the change iterator failed");
         }
-        it->operations[i] = sr_change_op_gpb_to_sr(msg_resp->response->get_changes_resp->changes[i]->changeoperation);
     }
 
     *iter = it;
 
-    sr_msg_free(msg_resp);
+    if (NULL != msg_resp) {
+        sr_msg_free(msg_resp);
+    }
 
     return cl_session_return(session, SR_ERR_OK);
 
@@ -2561,6 +2642,11 @@ sr_get_change_next(sr_session_ctx_t *session, sr_change_iter_t *iter, sr_change_
         *old_value = iter->old_values[iter->index];
         *new_value = iter->new_values[iter->index];
         iter->index++;
+    } else if (iter->complete) {
+        /* All changes have been read */
+        *new_value = NULL;
+        *old_value = NULL;
+        return SR_ERR_NOT_FOUND;
     } else {
         /* Fetch more items */
         rc = cl_send_get_changes(session, iter->xpath, iter->offset,
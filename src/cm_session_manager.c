@@ -43,14 +43,14 @@
 typedef struct sm_ctx_s {
     sm_cleanup_cb session_cleanup_cb;     /**< Callback called by session cleanup. */
     sm_cleanup_cb connection_cleanup_cb;  /**< Callback called by connection cleanup. */
-    sr_btree_t *session_id_btree;         /**< Binary tree for fast session lookup by id. */
-    sr_btree_t *connection_fd_btree;      /**< Binary tree for fast connection lookup by file descriptor. */
-    sr_btree_t *connection_dst_btree;     /**< Binary tree for fast connection lookup by destination address. */
+    sr_omap_t *session_id_btree;          /**< Map for fast session lookup by id. */
+    sr_omap_t *connection_fd_btree;       /**< Map for fast connection lookup by file descriptor. */
+    sr_omap_t *connection_dst_btree;      /**< Map for fast connection lookup by destination address. */
 } sm_ctx_t;
 
 /**
  * @brief Compares two sessions by session ID
- * (used by lookups in session binary tree).
+ * (used by lookups in session map).
  */
 static int
 sm_session_cmp_id(const void *a, const void *b)
@@ -71,7 +71,7 @@ sm_session_cmp_id(const void *a, const void *b)
 
 /**
  * @brief Compares two connections by associated file descriptors
- * (used by lookups in fd binary tree).
+ * (used by lookups in fd map).
  */
 static int
 sm_connection_cmp_fd(const void *a, const void *b)
@@ -92,7 +92,7 @@ sm_connection_cmp_fd(const void *a, const void *b)
 
 /**
  * @brief Compares two connections by associated destination addresses
- * (used by lookups in fd binary tree).
+ * (used by lookups in fd map).
  */
 static int
 sm_connection_cmp_dst(const void *a, const void *b)
@@ -120,7 +120,7 @@ sm_connection_cmp_dst(const void *a, const void *b)
 /**
  * @brief Cleans up the session. Releases all resources held in session context
  * by Session Manager and Connection Manager (via provided callback).
- * @note Called automatically when a node from session_id binary tree is removed
+ * @note Called automatically when an item is removed from session_id map
  * (which is also when the tree itself is being destroyed).
  */
 static void
@@ -141,7 +141,7 @@ sm_session_cleanup(void *session)
 /**
  * @brief Cleans up connection list entry. Releases all resources held in connection
  * context by Session Manager and Connection Manager (via provided callback).
- * @note Called automatically when a node from fd binary tree is removed
+ * @note Called automatically when an item is removed from fd map
  * (which is also when the tree itself is being destroyed).
  */
 static void
@@ -163,9 +163,9 @@ sm_connection_cleanup(void *connection_p)
             if (NULL != connection->sm_ctx->connection_cleanup_cb) {
                 connection->sm_ctx->connection_cleanup_cb(connection);
             }
-            /* if dst address is present, delete also from dst address tree */
+            /* if dst address is present, delete also from dst address map */
             if (NULL != connection->dst_address) {
-                sr_btree_delete(connection->sm_ctx->connection_dst_btree, connection);
+                sr_omap_delete(connection->sm_ctx->connection_dst_btree, connection);
                 free((void*)connection->dst_address);
             }
         }
@@ -258,27 +258,26 @@ sm_init(sm_cleanup_cb session_cleanup_cb, sm_cleanup_cb connection_cleanup_cb, s
     ctx->session_cleanup_cb = session_cleanup_cb;
     ctx->connection_cleanup_cb = connection_cleanup_cb;
 
-    /* create binary tree for fast session lookup by id,
-     * with automatic cleanup when the session is removed from tree */
-    rc = sr_btree_init(sm_session_cmp_id, sm_session_cleanup, &ctx->session_id_btree);
+    /* create map for fast session lookup by id,
+     * with automatic cleanup when the session is removed from map */
+    rc = sr_omap_init(sm_session_cmp_id, NULL, sm_session_cleanup, &ctx->session_id_btree);
     if (SR_ERR_OK != rc) {
-        SR_LOG_ERR_MSG("Cannot allocate binary tree for session IDs.");
+        SR_LOG_ERR_MSG("Cannot allocate map for session IDs.");
         goto cleanup;
     }
 
-    /* create binary tree for fast connection lookup by fd,
-     * with automatic cleanup when the connection is removed from tree */
-    rc = sr_btree_init(sm_connection_cmp_fd, sm_connection_cleanup, &ctx->connection_fd_btree);
+    /* create map for fast connection lookup by fd,
+     * with automatic cleanup when the connection is removed from map */
+    rc = sr_omap_init(sm_connection_cmp_fd, NULL, sm_connection_cleanup, &ctx->connection_fd_btree);
     if (SR_ERR_OK != rc) {
-        SR_LOG_ERR_MSG("Cannot allocate binary tree for connection FDs.");
+        SR_LOG_ERR_MSG("Cannot allocate map for connection FDs.");
         goto cleanup;
     }
 
-    /* create binary tree for fast connection lookup by fd,
-     * with automatic cleanup when the connection is removed from tree */
-    rc = sr_btree_init(sm_connection_cmp_dst, NULL, &ctx->connection_dst_btree);
+    /* create map for fast connection lookup by destination address */
+    rc = sr_omap_init(sm_connection_cmp_dst, NULL, NULL, &ctx->connection_dst_btree);
     if (SR_ERR_OK != rc) {
-        SR_LOG_ERR_MSG("Cannot allocate binary tree for connection destinations.");
+        SR_LOG_ERR_MSG("Cannot allocate map for connection destinations.");
         goto cleanup;
     }
 
@@ -301,13 +300,13 @@ sm_cleanup(sm_ctx_t *sm_ctx)
 
     if (NULL != sm_ctx) {
         if (NULL != sm_ctx->session_id_btree) {
-            sr_btree_cleanup(sm_ctx->session_id_btree);
+            sr_omap_cleanup(sm_ctx->session_id_btree);
         }
         if (NULL != sm_ctx->connection_fd_btree) {
-            sr_btree_cleanup(sm_ctx->connection_fd_btree);
+            sr_omap_cleanup(sm_ctx->connection_fd_btree);
         }
         if (NULL != sm_ctx->connection_dst_btree) {
-            sr_btree_cleanup(sm_ctx->connection_dst_btree);
+            sr_omap_cleanup(sm_ctx->connection_dst_btree);
         }
         free(sm_ctx);
     }
@@ -342,10 +341,10 @@ sm_connection_start(const sm_ctx_t *sm_ctx, const sm_connection_type_t type, con
         }
     }
 
-    /* insert connection into binary tree for fast lookup by fd */
-    rc = sr_btree_insert(sm_ctx->connection_fd_btree, connection);
+    /* insert connection into map for fast lookup by fd */
+    rc = sr_omap_insert(sm_ctx->connection_fd_btree, connection);
     if (SR_ERR_OK != rc) {
-        SR_LOG_ERR_MSG("Cannot insert new entry into fd binary tree (duplicate fd?).");
+        SR_LOG_ERR_MSG("Cannot insert new entry into fd map (duplicate fd?).");
         free(connection);
         return SR_ERR_INTERNAL;
     }
@@ -374,7 +373,7 @@ sm_connection_stop(const sm_ctx_t *sm_ctx, sm_connection_t *connection)
         tmp = tmp->next;
     }
 
-    sr_btree_delete(sm_ctx->connection_fd_btree, connection); /* sm_connection_cleanup auto-invoked */
+    sr_omap_delete(sm_ctx->connection_fd_btree, connection); /* sm_connection_cleanup auto-invoked */
 
     return SR_ERR_OK;
 }
@@ -437,7 +436,7 @@ sm_session_create(const sm_ctx_t *sm_ctx, sm_connection_t *connection,
     size_t attempts = 0;
     do {
         session->id = rand();
-        if (NULL != sr_btree_search(sm_ctx->session_id_btree, session)) {
+        if (NULL != sr_omap_search(sm_ctx->session_id_btree, session)) {
             session->id = SM_SESSION_ID_INVALID;
         }
         if (++attempts > SM_SESSION_ID_MAX_ATTEMPTS) {
@@ -447,10 +446,10 @@ sm_session_create(const sm_ctx_t *sm_ctx, sm_connection_t *connection,
         }
     } while (SM_SESSION_ID_INVALID == session->id);
 
-    /* insert into binary tree for fast lookup by id */
-    rc = sr_btree_insert(sm_ctx->session_id_btree, session);
+    /* insert into map for fast lookup by id */
+    rc = sr_omap_insert(sm_ctx->session_id_btree, session);
         if (SR_ERR_OK != rc) {
-        SR_LOG_ERR_MSG("Cannot insert new entry into session binary tree (duplicate id?).");
+        SR_LOG_ERR_MSG("Cannot insert new entry into session map (duplicate id?).");
         rc = SR_ERR_INTERNAL;
         goto cleanup;
     }
@@ -488,7 +487,7 @@ sm_session_drop(const sm_ctx_t *sm_ctx, sm_session_t *session)
         SR_LOG_WRN("Cannot remove the session from connection (id=%"PRIu32").", session->id);
     }
 
-    sr_btree_delete(sm_ctx->session_id_btree, session); /* sm_session_cleanup auto-invoked */
+    sr_omap_delete(sm_ctx->session_id_btree, session); /* sm_session_cleanup auto-invoked */
 
     return SR_ERR_OK;
 }
@@ -506,7 +505,7 @@ sm_session_find_id(const sm_ctx_t *sm_ctx, uint32_t session_id, sm_session_t **s
     }
 
     tmp.id = session_id;
-    *session = sr_btree_search(sm_ctx->session_id_btree, &tmp);
+    *session = sr_omap_search(sm_ctx->session_id_btree, &tmp);
 
     if (NULL == *session) {
         SR_LOG_DBG("Cannot find the session with id=%"PRIu32".", session_id);
@@ -528,7 +527,7 @@ sm_connection_find_fd(const sm_ctx_t *sm_ctx, const int fd, sm_connection_t **co
     }
 
     tmp_conn.fd = fd;
-    *connection = sr_btree_search(sm_ctx->connection_fd_btree, &tmp_conn);
+    *connection = sr_omap_search(sm_ctx->connection_fd_btree, &tmp_conn);
 
     if (NULL == *connection) {
         SR_LOG_WRN("Cannot find the connection with fd=%d.", fd);
@@ -550,10 +549,10 @@ sm_connection_assign_dst(const sm_ctx_t *sm_ctx, sm_connection_t *connection, co
         return SR_ERR_NOMEM;
     }
 
-    /* insert connection into binary tree for fast lookup by destination address */
-    rc = sr_btree_insert(sm_ctx->connection_dst_btree, connection);
+    /* insert connection into map for fast lookup by destination address */
+    rc = sr_omap_insert(sm_ctx->connection_dst_btree, connection);
     if (SR_ERR_OK != rc) {
-        SR_LOG_ERR_MSG("Cannot insert new entry into fd binary tree (duplicate destination address?).");
+        SR_LOG_ERR_MSG("Cannot insert new entry into fd map (duplicate destination address?).");
     }
 
     return rc;
@@ -567,7 +566,7 @@ sm_connection_find_dst(const sm_ctx_t *sm_ctx, const char *dst_address, sm_conne
     CHECK_NULL_ARG3(sm_ctx, dst_address, connection);
 
     tmp_conn.dst_address = dst_address;
-    *connection = sr_btree_search(sm_ctx->connection_dst_btree, &tmp_conn);
+    *connection = sr_omap_search(sm_ctx->connection_dst_btree, &tmp_conn);
 
     if (NULL == *connection) {
         SR_LOG_DBG("Cannot find the connection with dst_address address='%s'.", dst_address);
@@ -581,7 +580,7 @@ sm_session_get_index(const sm_ctx_t *sm_ctx, uint32_t index, sm_session_t **sess
 {
     CHECK_NULL_ARG2(sm_ctx, session);
 
-    *session = sr_btree_get_at(sm_ctx->session_id_btree, index);
+    *session = sr_omap_get_at(sm_ctx->session_id_btree, index);
 
     if (NULL == *session) {
         return SR_ERR_NOT_FOUND;
@@ -47,6 +47,7 @@
 #include "sr_logger.h"
 #include "sr_protobuf.h"
 #include "sr_mem_mgmt.h"
+#include "sr_lockstat.h"
 
 /**@} common */
 
@@ -22,9 +22,17 @@
 #include "sr_common.h"
 #include "sr_data_structs.h"
 #include <fcntl.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <signal.h>
+#include <time.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 
 #ifdef USE_AVL_LIB
@@ -34,6 +42,11 @@
 #endif
 
 #define SR_LIST_INIT_SIZE 4  /**< Initial size of the sysrepo list (in number of elements). */
+#define SR_OMAP_INIT_SIZE 8  /**< Initial size of the ordered map (in number of items). */
+#define SR_RING_CACHE_LINE 64    /**< Size of the cache line, used to keep producer and consumer indexes apart. */
+#define SR_RING_OVERFLOW_SIZE 8  /**< Initial size of the overflow buffer of the ring queue (in number of elements). */
+#define SR_INTERN_SHARD_CNT 16   /**< Number of independently locked shards of the string table (power of 2). */
+#define SR_INTERN_INIT_SIZE 64   /**< Initial number of buckets of a string table shard (power of 2). */
 
 int
 sr_llist_init(sr_llist_t **llist_p)
@@ -380,6 +393,344 @@ sr_btree_get_at(sr_btree_t *tree, size_t index)
     return NULL;
 }
 
+/**
+ * @brief Ordered map context.
+ */
+typedef struct sr_omap_s {
+    void **items;                            /**< Items sorted according to the compare callback. */
+    size_t count;                            /**< Number of stored items. */
+    size_t size;                             /**< Allocated size of the items array. */
+    void **hash_slots;                       /**< Hash index of the items (open addressing, linear probing). */
+    size_t hash_size;                        /**< Number of slots of the hash index (power of 2). */
+    sr_btree_compare_item_cb compare_item_cb;
+    sr_omap_hash_item_cb hash_item_cb;
+    sr_btree_free_item_cb free_item_cb;
+} sr_omap_t;
+
+int
+sr_omap_init(sr_btree_compare_item_cb compare_item_cb, sr_omap_hash_item_cb hash_item_cb,
+        sr_btree_free_item_cb free_item_cb, sr_omap_t **map_p)
+{
+    sr_omap_t *map = NULL;
+
+    CHECK_NULL_ARG2(compare_item_cb, map_p);
+
+    map = calloc(1, sizeof(*map));
+    CHECK_NULL_NOMEM_RETURN(map);
+
+    map->compare_item_cb = compare_item_cb;
+    map->hash_item_cb = hash_item_cb;
+    map->free_item_cb = free_item_cb;
+
+    *map_p = map;
+    return SR_ERR_OK;
+}
+
+void
+sr_omap_cleanup(sr_omap_t *map)
+{
+    if (NULL != map) {
+        if (NULL != map->free_item_cb) {
+            for (size_t i = 0; i < map->count; i++) {
+                map->free_item_cb(map->items[i]);
+            }
+        }
+        free(map->items);
+        free(map->hash_slots);
+        free(map);
+    }
+}
+
+/**
+ * @brief Binary search of an item in the sorted array of the map.
+ *
+ * @param[in] map Ordered map.
+ * @param[in] item Item to be searched for.
+ * @param[out] pos Position of the matching item, or the position where the item would be inserted.
+ *
+ * @return TRUE if the matching item has been found.
+ */
+static bool
+sr_omap_find_pos(const sr_omap_t *map, const void *item, size_t *pos)
+{
+    size_t lo = 0, hi = map->count, mid = 0;
+    int cmp = 0;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        cmp = map->compare_item_cb(map->items[mid], item);
+        if (0 == cmp) {
+            *pos = mid;
+            return true;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *pos = lo;
+    return false;
+}
+
+/**
+ * @brief Adds an item into the hash index, which must have a free slot.
+ */
+static void
+sr_omap_hash_add(void **slots, size_t hash_size, sr_omap_hash_item_cb hash_item_cb, void *item)
+{
+    size_t i = hash_item_cb(item) & (hash_size - 1);
+
+    while (NULL != slots[i]) {
+        i = (i + 1) & (hash_size - 1);
+    }
+    slots[i] = item;
+}
+
+/**
+ * @brief Rebuilds the hash index of the map with a new number of slots.
+ */
+static int
+sr_omap_hash_rebuild(sr_omap_t *map, size_t hash_size)
+{
+    void **slots = NULL;
+
+    slots = calloc(hash_size, sizeof(*slots));
+    CHECK_NULL_NOMEM_RETURN(slots);
+
+    for (size_t i = 0; i < map->count; i++) {
+        sr_omap_hash_add(slots, hash_size, map->hash_item_cb, map->items[i]);
+    }
+
+    free(map->hash_slots);
+    map->hash_slots = slots;
+    map->hash_size = hash_size;
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Removes a stored item from the hash index (backward shift deletion).
+ */
+static void
+sr_omap_hash_remove(sr_omap_t *map, const void *item)
+{
+    size_t mask = map->hash_size - 1;
+    size_t i = map->hash_item_cb(item) & mask, j = 0, home = 0;
+
+    while (NULL != map->hash_slots[i] && item != map->hash_slots[i]) {
+        i = (i + 1) & mask;
+    }
+    if (NULL == map->hash_slots[i]) {
+        return;
+    }
+    map->hash_slots[i] = NULL;
+
+    /* move following items of the cluster that would not be reachable anymore */
+    j = i;
+    for (j = (j + 1) & mask; NULL != map->hash_slots[j]; j = (j + 1) & mask) {
+        home = map->hash_item_cb(map->hash_slots[j]) & mask;
+        if ((i < j) ? (home <= i || home > j) : (home <= i && home > j)) {
+            map->hash_slots[i] = map->hash_slots[j];
+            map->hash_slots[j] = NULL;
+            i = j;
+        }
+    }
+}
+
+/**
+ * @brief Makes sure that the map can store provided number of items.
+ */
+static int
+sr_omap_reserve(sr_omap_t *map, size_t count)
+{
+    void **items = NULL;
+    size_t size = 0;
+    int rc = SR_ERR_OK;
+
+    if (count > map->size) {
+        size = (0 == map->size) ? SR_OMAP_INIT_SIZE : map->size;
+        while (size < count) {
+            size *= 2;
+        }
+        items = realloc(map->items, size * sizeof(*items));
+        CHECK_NULL_NOMEM_RETURN(items);
+        map->items = items;
+        map->size = size;
+    }
+
+    if (NULL != map->hash_item_cb && count * 2 > map->hash_size) {
+        size = (0 == map->hash_size) ? SR_OMAP_INIT_SIZE * 2 : map->hash_size;
+        while (size < count * 2) {
+            size *= 2;
+        }
+        rc = sr_omap_hash_rebuild(map, size);
+    }
+
+    return rc;
+}
+
+int
+sr_omap_insert(sr_omap_t *map, void *item)
+{
+    size_t pos = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(map, item);
+
+    if (sr_omap_find_pos(map, item, &pos)) {
+        return SR_ERR_DATA_EXISTS;
+    }
+
+    rc = sr_omap_reserve(map, map->count + 1);
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    memmove(map->items + pos + 1, map->items + pos, (map->count - pos) * sizeof(*map->items));
+    map->items[pos] = item;
+    map->count++;
+
+    if (NULL != map->hash_item_cb) {
+        sr_omap_hash_add(map->hash_slots, map->hash_size, map->hash_item_cb, item);
+    }
+
+    return SR_ERR_OK;
+}
+
+int
+sr_omap_build(sr_omap_t *map, void **items, size_t count)
+{
+    void **tmp = NULL, **src = NULL, **dst = NULL, **swap = NULL;
+    size_t width = 0, lo = 0, mid = 0, hi = 0, i = 0, j = 0, k = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG(map);
+
+    if (0 != map->count) {
+        SR_LOG_ERR_MSG("Ordered map can be built only when empty.");
+        return SR_ERR_INVAL_ARG;
+    }
+    if (0 == count) {
+        return SR_ERR_OK;
+    }
+    CHECK_NULL_ARG(items);
+
+    tmp = calloc(count, sizeof(*tmp));
+    CHECK_NULL_NOMEM_RETURN(tmp);
+    rc = sr_omap_reserve(map, count);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to allocate ordered map.");
+
+    /* bottom-up merge sort */
+    memcpy(map->items, items, count * sizeof(*items));
+    src = map->items;
+    dst = tmp;
+    for (width = 1; width < count; width *= 2) {
+        for (lo = 0; lo < count; lo += 2 * width) {
+            mid = (lo + width < count) ? lo + width : count;
+            hi = (lo + 2 * width < count) ? lo + 2 * width : count;
+            for (i = lo, j = mid, k = lo; k < hi; k++) {
+                if (i < mid && (j >= hi || map->compare_item_cb(src[i], src[j]) <= 0)) {
+                    dst[k] = src[i++];
+                } else {
+                    dst[k] = src[j++];
+                }
+            }
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != map->items) {
+        memcpy(map->items, src, count * sizeof(*items));
+    }
+
+    /* check for duplicates */
+    for (i = 1; i < count; i++) {
+        if (0 == map->compare_item_cb(map->items[i - 1], map->items[i])) {
+            rc = SR_ERR_DATA_EXISTS;
+            goto cleanup;
+        }
+    }
+
+    map->count = count;
+    if (NULL != map->hash_item_cb) {
+        for (i = 0; i < count; i++) {
+            sr_omap_hash_add(map->hash_slots, map->hash_size, map->hash_item_cb, map->items[i]);
+        }
+    }
+
+cleanup:
+    free(tmp);
+    return rc;
+}
+
+void
+sr_omap_delete(sr_omap_t *map, void *item)
+{
+    size_t pos = 0;
+    void *stored = NULL;
+
+    CHECK_NULL_ARG_VOID2(map, item);
+
+    if (!sr_omap_find_pos(map, item, &pos)) {
+        return;
+    }
+
+    stored = map->items[pos];
+    if (NULL != map->hash_item_cb) {
+        sr_omap_hash_remove(map, stored);
+    }
+    memmove(map->items + pos, map->items + pos + 1, (map->count - pos - 1) * sizeof(*map->items));
+    map->count--;
+
+    if (NULL != map->free_item_cb) {
+        map->free_item_cb(stored);
+    }
+}
+
+void *
+sr_omap_search(const sr_omap_t *map, const void *item)
+{
+    size_t pos = 0, i = 0;
+
+    if (NULL == map || NULL == item || 0 == map->count) {
+        return NULL;
+    }
+
+    if (NULL != map->hash_item_cb) {
+        for (i = map->hash_item_cb(item) & (map->hash_size - 1); NULL != map->hash_slots[i];
+                i = (i + 1) & (map->hash_size - 1)) {
+            if (0 == map->compare_item_cb(map->hash_slots[i], item)) {
+                return map->hash_slots[i];
+            }
+        }
+        return NULL;
+    }
+
+    if (sr_omap_find_pos(map, item, &pos)) {
+        return map->items[pos];
+    }
+
+    return NULL;
+}
+
+void *
+sr_omap_get_at(const sr_omap_t *map, size_t index)
+{
+    if (NULL == map || index >= map->count) {
+        return NULL;
+    }
+
+    return map->items[index];
+}
+
+size_t
+sr_omap_count(const sr_omap_t *map)
+{
+    return NULL != map ? map->count : 0;
+}
+
 /**
  * @brief FIFO circular buffer queue context.
  */
@@ -490,330 +841,2036 @@ sr_cbuff_items_in_queue(sr_cbuff_t *buffer)
 }
 
 /**
- * @brief Holds binary tree with filename -> fd maping. This structure
- * is used to check file locks inside of the process and to avoid
- * the loss of the lock by file closing. File name  is first looked
- * up in this structure to detect if the file is currently opened by the process.
- * File can be closed and unlocked by fd.
+ * @brief Lock-free FIFO ring queue context.
+ *
+ * MPMC ring uses a sequence number in each slot (D. Vyukov's bounded MPMC queue),
+ * SPSC ring only publishes the head and tail indexes.
  */
-typedef struct sr_locking_set_s {
-    sr_btree_t *lock_files;       /**< Binary tree of lock files for fast look up by file name */
-    sr_btree_t *fd_index;         /**< Binary tree for fast lookup by fd, only index to the items stored in lock_files binary tree */
-    pthread_mutex_t mutex;        /**< Mutex for exclusive access to binary tree */
-    pthread_cond_t cond;          /**< Condition variable used for blocking lock */
-} sr_locking_set_t;
+typedef struct sr_ring_s {
+    size_t tail;                             /**< Position of the next enqueued element. */
+    char tail_pad[SR_RING_CACHE_LINE - sizeof(size_t)];
+    size_t head;                             /**< Position of the next dequeued element. */
+    char head_pad[SR_RING_CACHE_LINE - sizeof(size_t)];
+    size_t overflow_cnt;                     /**< Number of elements in the overflow buffer. */
+    uint32_t wait_seq;                       /**< Wake-up sequence number (futex word). */
+    uint32_t waiters;                        /**< Number of consumers blocked in ::sr_ring_dequeue_wait. */
+    char wait_pad[SR_RING_CACHE_LINE - sizeof(size_t) - 2 * sizeof(uint32_t)];
+    sr_ring_type_t type;                     /**< Type of the ring. */
+    size_t mask;                             /**< Capacity of the ring - 1. */
+    size_t elem_size;                        /**< Size of an element. */
+    size_t slot_size;                        /**< Size of a slot (sequence number + element, aligned). */
+    uint8_t *slots;                          /**< Slots of the ring. */
+    sr_cbuff_t *overflow;                    /**< Buffer for elements that do not fit into the ring. */
+    pthread_mutex_t overflow_lock;           /**< Lock guarding the overflow buffer. */
+#ifndef __linux__
+    pthread_mutex_t wait_lock;               /**< Lock used to wait for elements where futex is not available. */
+    pthread_cond_t wait_cv;                  /**< Condition variable used to wait for elements. */
+#endif
+} sr_ring_t;
 
 /**
- * @brief The item of the lock_files binary tree in dm_lock_ctx_t
+ * @brief Returns sequence number of a ring slot.
  */
-typedef struct sr_lock_item_s {
-    char *filename;               /**< File name of the lockfile */
-    int fd;                       /**< File descriptor of the file */
-    bool locked;                  /**< Flag signalizing that file is locked */
-} sr_lock_item_t;
+#define SR_RING_SLOT_SEQ(RING, POS) ((size_t *) ((RING)->slots + ((POS) & (RING)->mask) * (RING)->slot_size))
 
 /**
- * @brief Compare two lock items by filename
+ * @brief Returns data of a ring slot.
  */
-static int
-sr_compare_lock_item(const void *a, const void *b)
-{
-    assert(a);
-    assert(b);
-    sr_lock_item_t *item_a = (sr_lock_item_t *) a;
-    sr_lock_item_t *item_b = (sr_lock_item_t *) b;
-
-    int res = strcmp(item_a->filename, item_b->filename);
-    if (res == 0) {
-        return 0;
-    } else if (res < 0) {
-        return -1;
-    } else {
-        return 1;
-    }
-
-}
+#define SR_RING_SLOT_DATA(RING, POS) ((RING)->slots + ((POS) & (RING)->mask) * (RING)->slot_size + sizeof(size_t))
 
-/**
- * @brief Compare two lock items by fd
- */
-static int
-sr_compare_lock_item_fd(const void *a, const void *b)
+int
+sr_ring_init(size_t capacity, size_t elem_size, sr_ring_type_t type, sr_ring_t **ring_p)
 {
-    assert(a);
-    assert(b);
-    sr_lock_item_t *item_a = (sr_lock_item_t *) a;
-    sr_lock_item_t *item_b = (sr_lock_item_t *) b;
+    sr_ring_t *ring = NULL;
+    size_t size = 2;
+    int rc = SR_ERR_OK;
 
+    CHECK_NULL_ARG(ring_p);
 
-    if (item_a->fd == item_b->fd) {
-        return 0;
-    } else if (item_a->fd < item_b->fd) {
-        return -1;
-    } else {
-        return 1;
+    if (0 == elem_size) {
+        SR_LOG_ERR_MSG("Ring queue element size must not be zero.");
+        return SR_ERR_INVAL_ARG;
     }
 
-}
-
-static void
-sr_free_lock_item(void *lock_item)
-{
-    CHECK_NULL_ARG_VOID(lock_item);
-    sr_lock_item_t *li = (sr_lock_item_t *) lock_item;
-    free(li->filename);
-    if (-1 != li->fd) {
-        SR_LOG_DBG("Closing fd = %d", li->fd);
-        close(li->fd);
+    while (size < capacity) {
+        size *= 2;
     }
-    free(li);
-}
 
-int
-sr_locking_set_init(sr_locking_set_t **lset_p){
-    CHECK_NULL_ARG(lset_p);
-    int rc = SR_ERR_OK;
-    sr_locking_set_t *lset = NULL;
+    ring = calloc(1, sizeof(*ring));
+    CHECK_NULL_NOMEM_RETURN(ring);
 
-    lset = calloc(1, sizeof(*lset));
-    CHECK_NULL_NOMEM_RETURN(lset);
+    ring->type = type;
+    ring->mask = size - 1;
+    ring->elem_size = elem_size;
+    ring->slot_size = (sizeof(size_t) + elem_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
 
-    pthread_mutex_init(&lset->mutex, NULL);
-    pthread_cond_init(&lset->cond, NULL);
-    rc = sr_btree_init(sr_compare_lock_item, sr_free_lock_item, &lset->lock_files);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Creating of lock files binary tree failed");
+    ring->slots = calloc(size, ring->slot_size);
+    CHECK_NULL_NOMEM_GOTO(ring->slots, rc, cleanup);
+    for (size_t i = 0; i < size; i++) {
+        *SR_RING_SLOT_SEQ(ring, i) = i;
+    }
 
-    rc = sr_btree_init(sr_compare_lock_item_fd, NULL, &lset->fd_index);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Creating of lock files binary tree failed");
+    rc = sr_cbuff_init(SR_RING_OVERFLOW_SIZE, elem_size, &ring->overflow);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to initialize ring overflow buffer.");
 
-    *lset_p = lset;
-    return rc;
+    pthread_mutex_init(&ring->overflow_lock, NULL);
+#ifndef __linux__
+    pthread_mutex_init(&ring->wait_lock, NULL);
+    pthread_cond_init(&ring->wait_cv, NULL);
+#endif
+
+    *ring_p = ring;
+    return SR_ERR_OK;
 
 cleanup:
-    sr_locking_set_cleanup(lset);
+    free(ring->slots);
+    free(ring);
     return rc;
 }
 
 void
-sr_locking_set_cleanup(sr_locking_set_t *lset)
+sr_ring_cleanup(sr_ring_t *ring)
 {
-    if (NULL != lset) {
-        sr_btree_cleanup(lset->fd_index);
-        sr_btree_cleanup(lset->lock_files);
-        pthread_mutex_destroy(&lset->mutex);
+    if (NULL != ring) {
+        sr_cbuff_cleanup(ring->overflow);
+        pthread_mutex_destroy(&ring->overflow_lock);
+#ifndef __linux__
+        pthread_mutex_destroy(&ring->wait_lock);
+        pthread_cond_destroy(&ring->wait_cv);
+#endif
+        free(ring->slots);
+        free(ring);
+    }
+}
+
+/**
+ * @brief Tries to enqueue an element into the lock-free ring.
+ *
+ * @return FALSE if the ring is full.
+ */
+static bool
+sr_ring_push(sr_ring_t *ring, const void *item)
+{
+    size_t pos = 0, seq = 0;
+    intptr_t diff = 0;
+
+    if (SR_RING_SPSC == ring->type) {
+        pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        if (pos - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) > ring->mask) {
+            return false;
+        }
+        memcpy(SR_RING_SLOT_DATA(ring, pos), item, ring->elem_size);
+        __atomic_store_n(&ring->tail, pos + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        seq = __atomic_load_n(SR_RING_SLOT_SEQ(ring, pos), __ATOMIC_ACQUIRE);
+        diff = (intptr_t) seq - (intptr_t) pos;
+        if (0 == diff) {
+            /* the slot is free, try to claim it */
+            if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* the slot has not been consumed yet, the ring is full */
+            return false;
+        } else {
+            /* another producer claimed the slot */
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(SR_RING_SLOT_DATA(ring, pos), item, ring->elem_size);
+    __atomic_store_n(SR_RING_SLOT_SEQ(ring, pos), pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Tries to dequeue an element from the lock-free ring.
+ *
+ * @return FALSE if the ring is empty.
+ */
+static bool
+sr_ring_pop(sr_ring_t *ring, void *item)
+{
+    size_t pos = 0, seq = 0;
+    intptr_t diff = 0;
+
+    if (SR_RING_SPSC == ring->type) {
+        pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        if (pos == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        memcpy(item, SR_RING_SLOT_DATA(ring, pos), ring->elem_size);
+        __atomic_store_n(&ring->head, pos + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    for (;;) {
+        seq = __atomic_load_n(SR_RING_SLOT_SEQ(ring, pos), __ATOMIC_ACQUIRE);
+        diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (0 == diff) {
+            /* the slot is filled, try to claim it */
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* the slot has not been filled yet, the ring is empty */
+            return false;
+        } else {
+            /* another consumer claimed the slot */
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(item, SR_RING_SLOT_DATA(ring, pos), ring->elem_size);
+    __atomic_store_n(SR_RING_SLOT_SEQ(ring, pos), pos + ring->mask + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+int
+sr_ring_enqueue(sr_ring_t *ring, const void *item)
+{
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(ring, item);
+
+    /* once some elements spilled into the overflow buffer, keep using it until
+     * it has been drained to preserve the order of the elements */
+    if (0 == __atomic_load_n(&ring->overflow_cnt, __ATOMIC_ACQUIRE) && sr_ring_push(ring, item)) {
+        return SR_ERR_OK;
+    }
+
+    pthread_mutex_lock(&ring->overflow_lock);
+    rc = sr_cbuff_enqueue(ring->overflow, (void *) item);
+    if (SR_ERR_OK == rc) {
+        __atomic_add_fetch(&ring->overflow_cnt, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&ring->overflow_lock);
+
+    return rc;
+}
+
+bool
+sr_ring_dequeue(sr_ring_t *ring, void *item)
+{
+    sr_cbuff_t *overflow = NULL;
+    size_t moved = 0;
+    bool dequeued = false;
+
+    if (NULL == ring || NULL == item) {
+        return false;
+    }
+
+    if (sr_ring_pop(ring, item)) {
+        return true;
+    }
+
+    if (0 != __atomic_load_n(&ring->overflow_cnt, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&ring->overflow_lock);
+        /* the ring may have been refilled meanwhile by producers that did not see the overflow yet */
+        dequeued = sr_ring_pop(ring, item);
+        if (!dequeued) {
+            overflow = ring->overflow;
+            dequeued = sr_cbuff_dequeue(overflow, item);
+            if (dequeued) {
+                /* the ring has been drained, move the oldest spilled elements back into it
+                 * (producers keep spilling until the overflow buffer is empty, so the order is kept) */
+                for (moved = 1; overflow->count > 0; moved++) {
+                    if (!sr_ring_push(ring, (uint8_t *) overflow->data + (overflow->head * overflow->elem_size))) {
+                        break;
+                    }
+                    overflow->head = (overflow->head + 1) % overflow->capacity;
+                    overflow->count--;
+                }
+                __atomic_sub_fetch(&ring->overflow_cnt, moved, __ATOMIC_RELEASE);
+            }
+        }
+        pthread_mutex_unlock(&ring->overflow_lock);
+    }
+
+    return dequeued;
+}
+
+void
+sr_ring_dequeue_wait(sr_ring_t *ring, void *item)
+{
+    uint32_t seq = 0;
+
+    CHECK_NULL_ARG_VOID2(ring, item);
+
+    while (!sr_ring_dequeue(ring, item)) {
+        seq = __atomic_load_n(&ring->wait_seq, __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+        /* re-check after announcing the waiter, a producer that enqueued before
+         * could have seen no waiters and skipped the wake-up */
+        if (sr_ring_dequeue(ring, item)) {
+            __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+            return;
+        }
+#ifdef __linux__
+        syscall(SYS_futex, &ring->wait_seq, FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+        pthread_mutex_lock(&ring->wait_lock);
+        while (seq == ring->wait_seq) {
+            pthread_cond_wait(&ring->wait_cv, &ring->wait_lock);
+        }
+        pthread_mutex_unlock(&ring->wait_lock);
+#endif
+        __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void
+sr_ring_wake(sr_ring_t *ring, size_t count)
+{
+    CHECK_NULL_ARG_VOID(ring);
+
+    /* order the preceding enqueue before reading the number of waiters */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 == count || 0 == __atomic_load_n(&ring->waiters, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+
+#ifdef __linux__
+    __atomic_add_fetch(&ring->wait_seq, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &ring->wait_seq, FUTEX_WAKE_PRIVATE, count > INT32_MAX ? INT32_MAX : (int) count, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&ring->wait_lock);
+    __atomic_add_fetch(&ring->wait_seq, 1, __ATOMIC_SEQ_CST);
+    if (1 == count) {
+        pthread_cond_signal(&ring->wait_cv);
+    } else {
+        pthread_cond_broadcast(&ring->wait_cv);
+    }
+    pthread_mutex_unlock(&ring->wait_lock);
+#endif
+}
+
+size_t
+sr_ring_count(sr_ring_t *ring)
+{
+    size_t head = 0, tail = 0;
+
+    if (NULL == ring) {
+        return 0;
+    }
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    return ((tail > head) ? tail - head : 0) + __atomic_load_n(&ring->overflow_cnt, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief String stored in the string table.
+ */
+typedef struct sr_interned_str_s {
+    struct sr_interned_str_s *next;  /**< Next string in the same bucket. */
+    uint32_t hash;                   /**< Hash of the string. */
+    uint32_t ref_cnt;                /**< Number of references (accessed atomically). */
+    size_t len;                      /**< Length of the string. */
+    char str[];                      /**< The string itself. */
+} sr_interned_str_t;
+
+/**
+ * @brief Shard of the string table with its own lock.
+ */
+typedef struct sr_intern_shard_s {
+    pthread_mutex_t lock;            /**< Mutex guarding the shard. */
+    sr_interned_str_t **buckets;     /**< Hash buckets (chained). */
+    size_t size;                     /**< Number of the buckets. */
+    size_t count;                    /**< Number of strings stored in the shard. */
+    size_t bytes;                    /**< Size of the strings stored in the shard. */
+} sr_intern_shard_t;
+
+/**
+ * @brief Process-wide string table.
+ */
+static sr_intern_shard_t sr_intern_table[SR_INTERN_SHARD_CNT] = {
+    [0 ... SR_INTERN_SHARD_CNT - 1] = { .lock = PTHREAD_MUTEX_INITIALIZER }
+};
+
+/**
+ * @brief Returns the interned string structure from the pointer to the string.
+ */
+#define SR_INTERNED_STR(STR) ((sr_interned_str_t *) ((char *) (STR) - offsetof(sr_interned_str_t, str)))
+
+/**
+ * @brief FNV-1a hash of first len characters of a string (consistent with ::sr_str_hash).
+ */
+static uint32_t
+sr_str_hash_len(const char *str, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (uint8_t) str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Doubles the number of buckets of a string table shard. Called with the shard locked.
+ */
+static int
+sr_intern_shard_grow(sr_intern_shard_t *shard)
+{
+    sr_interned_str_t **buckets = NULL, *entry = NULL, *next = NULL;
+    size_t size = shard->size ? (shard->size << 1) : SR_INTERN_INIT_SIZE;
+
+    buckets = calloc(size, sizeof *buckets);
+    CHECK_NULL_NOMEM_RETURN(buckets);
+
+    for (size_t i = 0; i < shard->size; ++i) {
+        for (entry = shard->buckets[i]; NULL != entry; entry = next) {
+            next = entry->next;
+            entry->next = buckets[entry->hash & (size - 1)];
+            buckets[entry->hash & (size - 1)] = entry;
+        }
+    }
+
+    free(shard->buckets);
+    shard->bytes += (size - shard->size) * sizeof *buckets;
+    shard->buckets = buckets;
+    shard->size = size;
+
+    return SR_ERR_OK;
+}
+
+int
+sr_str_intern_len(const char *str, size_t len, const char **interned)
+{
+    sr_intern_shard_t *shard = NULL;
+    sr_interned_str_t *entry = NULL;
+    uint32_t hash = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(str, interned);
+
+    hash = sr_str_hash_len(str, len);
+    /* the top bits select the shard, the bottom bits the bucket */
+    shard = &sr_intern_table[hash >> 28 & (SR_INTERN_SHARD_CNT - 1)];
+
+    pthread_mutex_lock(&shard->lock);
+
+    if (0 < shard->size) {
+        for (entry = shard->buckets[hash & (shard->size - 1)]; NULL != entry; entry = entry->next) {
+            if (entry->hash == hash && entry->len == len && 0 == memcmp(entry->str, str, len)) {
+                __atomic_add_fetch(&entry->ref_cnt, 1, __ATOMIC_RELAXED);
+                *interned = entry->str;
+                goto cleanup;
+            }
+        }
+    }
+
+    if (shard->count >= shard->size) {
+        rc = sr_intern_shard_grow(shard);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to grow the string table.");
+    }
+
+    entry = malloc(sizeof *entry + len + 1);
+    CHECK_NULL_NOMEM_GOTO(entry, rc, cleanup);
+    entry->hash = hash;
+    entry->ref_cnt = 1;
+    entry->len = len;
+    memcpy(entry->str, str, len);
+    entry->str[len] = '\0';
+
+    entry->next = shard->buckets[hash & (shard->size - 1)];
+    shard->buckets[hash & (shard->size - 1)] = entry;
+    shard->count += 1;
+    shard->bytes += sizeof *entry + len + 1;
+    *interned = entry->str;
+
+cleanup:
+    pthread_mutex_unlock(&shard->lock);
+    return rc;
+}
+
+int
+sr_str_intern(const char *str, const char **interned)
+{
+    CHECK_NULL_ARG2(str, interned);
+
+    return sr_str_intern_len(str, strlen(str), interned);
+}
+
+const char *
+sr_str_intern_ref(const char *interned)
+{
+    if (NULL != interned) {
+        /* the caller holds a reference, the string cannot be removed concurrently */
+        __atomic_add_fetch(&SR_INTERNED_STR(interned)->ref_cnt, 1, __ATOMIC_RELAXED);
+    }
+    return interned;
+}
+
+void
+sr_str_release(const char *interned)
+{
+    sr_interned_str_t *entry = NULL, **link = NULL;
+    sr_intern_shard_t *shard = NULL;
+    uint32_t ref_cnt = 0;
+
+    if (NULL == interned) {
+        return;
+    }
+    entry = SR_INTERNED_STR(interned);
+
+    /* fast path: not the last reference, no need to lock */
+    ref_cnt = __atomic_load_n(&entry->ref_cnt, __ATOMIC_RELAXED);
+    while (1 < ref_cnt) {
+        if (__atomic_compare_exchange_n(&entry->ref_cnt, &ref_cnt, ref_cnt - 1, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    /* possibly the last reference, the string may be interned again concurrently */
+    shard = &sr_intern_table[entry->hash >> 28 & (SR_INTERN_SHARD_CNT - 1)];
+    pthread_mutex_lock(&shard->lock);
+    if (0 == __atomic_sub_fetch(&entry->ref_cnt, 1, __ATOMIC_ACQ_REL)) {
+        for (link = &shard->buckets[entry->hash & (shard->size - 1)]; *link != entry; link = &(*link)->next);
+        *link = entry->next;
+        shard->count -= 1;
+        shard->bytes -= sizeof *entry + entry->len + 1;
+        free(entry);
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+void
+sr_str_intern_stats(size_t *count, size_t *bytes)
+{
+    size_t total_count = 0, total_bytes = 0;
+
+    for (size_t i = 0; i < SR_INTERN_SHARD_CNT; ++i) {
+        pthread_mutex_lock(&sr_intern_table[i].lock);
+        total_count += sr_intern_table[i].count;
+        total_bytes += sr_intern_table[i].bytes;
+        pthread_mutex_unlock(&sr_intern_table[i].lock);
+    }
+
+    if (NULL != count) {
+        *count = total_count;
+    }
+    if (NULL != bytes) {
+        *bytes = total_bytes;
+    }
+}
+
+/**
+ * @brief Holds binary tree with filename -> fd maping. This structure
+ * is used to check file locks inside of the process and to avoid
+ * the loss of the lock by file closing. File name  is first looked
+ * up in this structure to detect if the file is currently opened by the process.
+ * File can be closed and unlocked by fd.
+ */
+typedef struct sr_locking_set_s {
+    sr_btree_t *lock_files;       /**< Binary tree of lock files for fast look up by file name */
+    sr_btree_t *fd_index;         /**< Binary tree for fast lookup by fd, only index to the items stored in lock_files binary tree */
+    pthread_mutex_t mutex;        /**< Mutex for exclusive access to binary tree */
+    pthread_cond_t cond;          /**< Condition variable used for blocking lock */
+} sr_locking_set_t;
+
+/**
+ * @brief The item of the lock_files binary tree in dm_lock_ctx_t
+ */
+typedef struct sr_lock_item_s {
+    char *filename;               /**< File name of the lockfile */
+    int fd;                       /**< File descriptor of the file */
+    bool locked;                  /**< Flag signalizing that file is locked */
+} sr_lock_item_t;
+
+/**
+ * @brief Compare two lock items by filename
+ */
+static int
+sr_compare_lock_item(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    sr_lock_item_t *item_a = (sr_lock_item_t *) a;
+    sr_lock_item_t *item_b = (sr_lock_item_t *) b;
+
+    int res = strcmp(item_a->filename, item_b->filename);
+    if (res == 0) {
+        return 0;
+    } else if (res < 0) {
+        return -1;
+    } else {
+        return 1;
+    }
+
+}
+
+/**
+ * @brief Compare two lock items by fd
+ */
+static int
+sr_compare_lock_item_fd(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    sr_lock_item_t *item_a = (sr_lock_item_t *) a;
+    sr_lock_item_t *item_b = (sr_lock_item_t *) b;
+
+
+    if (item_a->fd == item_b->fd) {
+        return 0;
+    } else if (item_a->fd < item_b->fd) {
+        return -1;
+    } else {
+        return 1;
+    }
+
+}
+
+static void
+sr_free_lock_item(void *lock_item)
+{
+    CHECK_NULL_ARG_VOID(lock_item);
+    sr_lock_item_t *li = (sr_lock_item_t *) lock_item;
+    free(li->filename);
+    if (-1 != li->fd) {
+        SR_LOG_DBG("Closing fd = %d", li->fd);
+        close(li->fd);
+    }
+    free(li);
+}
+
+int
+sr_locking_set_init(sr_locking_set_t **lset_p){
+    CHECK_NULL_ARG(lset_p);
+    int rc = SR_ERR_OK;
+    sr_locking_set_t *lset = NULL;
+
+    lset = calloc(1, sizeof(*lset));
+    CHECK_NULL_NOMEM_RETURN(lset);
+
+    pthread_mutex_init(&lset->mutex, NULL);
+    pthread_cond_init(&lset->cond, NULL);
+    rc = sr_btree_init(sr_compare_lock_item, sr_free_lock_item, &lset->lock_files);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Creating of lock files binary tree failed");
+
+    rc = sr_btree_init(sr_compare_lock_item_fd, NULL, &lset->fd_index);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Creating of lock files binary tree failed");
+
+    *lset_p = lset;
+    return rc;
+
+cleanup:
+    sr_locking_set_cleanup(lset);
+    return rc;
+}
+
+void
+sr_locking_set_cleanup(sr_locking_set_t *lset)
+{
+    if (NULL != lset) {
+        sr_btree_cleanup(lset->fd_index);
+        sr_btree_cleanup(lset->lock_files);
+        pthread_mutex_destroy(&lset->mutex);
         pthread_cond_destroy(&lset->cond);
         free(lset);
     }
 }
 
-int
-sr_locking_set_lock_file_open(sr_locking_set_t *lock_ctx, char *filename, bool write, bool blocking, int *fd)
+int
+sr_locking_set_lock_file_open(sr_locking_set_t *lock_ctx, char *filename, bool write, bool blocking, int *fd)
+{
+    CHECK_NULL_ARG2(lock_ctx, filename);
+    int rc = SR_ERR_OK;
+    sr_lock_item_t lookup_item = {0,};
+    sr_lock_item_t *found_item = NULL;
+    lookup_item.filename = filename;
+
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+
+    found_item = sr_btree_search(lock_ctx->lock_files, &lookup_item);
+    if (NULL == found_item) {
+        found_item = calloc(1, sizeof(*found_item));
+        CHECK_NULL_NOMEM_GOTO(found_item, rc, cleanup);
+
+        found_item->fd = -1;
+        found_item->filename = strdup(filename);
+        found_item->locked = false;
+        if (NULL == found_item->filename) {
+            SR_LOG_ERR_MSG("Filename duplication failed");
+            free(found_item);
+            rc = SR_ERR_INTERNAL;
+            goto cleanup;
+        }
+
+        rc = sr_btree_insert(lock_ctx->lock_files, found_item);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_ERR_MSG("Adding to binary tree failed");
+            sr_free_lock_item(found_item);
+            goto cleanup;
+        }
+
+    }
+
+    if (!blocking && found_item->locked) {
+        rc = SR_ERR_LOCKED;
+        SR_LOG_INF("File %s locked by other process", filename);
+        goto cleanup;
+    }
+
+    while (found_item->locked) {
+        pthread_cond_wait(&lock_ctx->cond, &lock_ctx->mutex);
+    }
+
+    if (-1 == found_item->fd) {
+        found_item->fd = open(filename, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+        if (-1 == found_item->fd) {
+            if (EACCES == errno) {
+                SR_LOG_ERR("Insufficient permissions to lock the file '%s'", filename);
+                rc = SR_ERR_UNAUTHORIZED;
+            } else {
+                SR_LOG_ERR("Error by opening the file '%s': %s", filename, sr_strerror_safe(errno));
+                rc = SR_ERR_INTERNAL;
+            }
+            goto cleanup;
+        }
+    }
+
+    rc = sr_lock_fd(found_item->fd, write, blocking);
+    if (SR_ERR_OK == rc) {
+        SR_LOG_DBG("File %s has been locked", filename);
+        found_item->locked = true;
+        rc = sr_btree_insert(lock_ctx->fd_index, found_item);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Insert into fd index failed file %s (fd = %d)", found_item->filename, found_item->fd);
+    } else {
+        SR_LOG_WRN("File %s can not be locked", filename);
+        close(found_item->fd);
+        found_item->fd = -1;
+    }
+
+    if (NULL != fd) {
+        *fd = found_item->fd;
+    }
+
+cleanup:
+    pthread_mutex_unlock(&lock_ctx->mutex);
+    return rc;
+}
+
+int
+sr_locking_set_lock_fd(sr_locking_set_t *lock_ctx, int fd, char *filename, bool write, bool blocking)
+{
+    CHECK_NULL_ARG2(lock_ctx, filename);
+    int rc = SR_ERR_OK;
+    sr_lock_item_t lookup_item = {0,};
+    sr_lock_item_t *found_item = NULL;
+    lookup_item.filename = filename;
+
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+
+    found_item = sr_btree_search(lock_ctx->lock_files, &lookup_item);
+    if (NULL == found_item) {
+        found_item = calloc(1, sizeof(*found_item));
+        CHECK_NULL_NOMEM_GOTO(found_item, rc, cleanup);
+
+        found_item->fd = -1;
+        found_item->filename = strdup(filename);
+        if (NULL == found_item->filename) {
+            SR_LOG_ERR_MSG("Filename duplication failed");
+            free(found_item);
+            rc = SR_ERR_INTERNAL;
+            goto cleanup;
+        }
+
+        rc = sr_btree_insert(lock_ctx->lock_files, found_item);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_ERR_MSG("Adding to binary tree failed");
+            sr_free_lock_item(found_item);
+            goto cleanup;
+        }
+    }
+
+    if (!blocking && found_item->locked) {
+        rc = SR_ERR_LOCKED;
+        SR_LOG_INF("File %s can not be locked", filename);
+        goto cleanup;
+    }
+
+    while (found_item->locked) {
+        pthread_cond_wait(&lock_ctx->cond, &lock_ctx->mutex);
+    }
+
+    rc = sr_lock_fd(fd, write, blocking);
+    if (SR_ERR_OK == rc) {
+        SR_LOG_DBG("File %s has been locked", filename);
+        found_item->fd = fd;
+        found_item->locked = true;
+
+        rc = sr_btree_insert(lock_ctx->fd_index, found_item);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Insert into fd index failed");
+    } else {
+        SR_LOG_WRN("File %s can not be locked", filename);
+        found_item->fd = -1;
+    }
+
+
+cleanup:
+    pthread_mutex_unlock(&lock_ctx->mutex);
+    return rc;
+}
+
+int
+sr_locking_set_unlock_close_file(sr_locking_set_t* lock_ctx, char* filename)
+{
+    CHECK_NULL_ARG2(lock_ctx, filename);
+    int rc = SR_ERR_OK;
+    sr_lock_item_t lookup_item = {0,};
+    sr_lock_item_t *found_item = NULL;
+    lookup_item.filename = filename;
+
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+
+    found_item = sr_btree_search(lock_ctx->lock_files, &lookup_item);
+    if (NULL == found_item || -1 == found_item->fd) {
+        SR_LOG_ERR("File %s has not been locked in this context", filename);
+        rc = SR_ERR_INVAL_ARG;
+        goto cleanup;
+    }
+    sr_btree_delete(lock_ctx->fd_index, found_item);
+    sr_unlock_fd(found_item->fd);
+
+    rc = close(found_item->fd);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_WRN("Close failed %s", sr_strerror_safe(errno));
+    }
+    found_item->locked = false;
+    found_item->fd = -1;
+    SR_LOG_DBG("File %s has been unlocked", filename);
+
+cleanup:
+    pthread_cond_broadcast(&lock_ctx->cond);
+    pthread_mutex_unlock(&lock_ctx->mutex);
+    return rc;
+}
+
+int
+sr_locking_set_unlock_close_fd(sr_locking_set_t* lock_ctx, int fd)
+{
+    CHECK_NULL_ARG(lock_ctx);
+    int rc = SR_ERR_OK;
+    sr_lock_item_t lookup_item = {0,};
+    sr_lock_item_t *found_item = NULL;
+    lookup_item.fd = fd;
+
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+
+    found_item = sr_btree_search(lock_ctx->fd_index, &lookup_item);
+    if (NULL == found_item || -1 == found_item->fd) {
+        SR_LOG_ERR("File %s has not been locked in this context fd (%d)", NULL != found_item ? found_item->filename : "", fd);
+        rc = SR_ERR_INVAL_ARG;
+        goto cleanup;
+    }
+    sr_unlock_fd(found_item->fd);
+    SR_LOG_DBG("File %s (fd = %d) has been unlocked", found_item->filename, fd);
+
+    rc = close(found_item->fd);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_WRN("Close failed %s", sr_strerror_safe(errno));
+    }
+
+    /* remove from index tree */
+    sr_btree_delete(lock_ctx->fd_index, found_item);
+    found_item->locked = false;
+    found_item->fd = -1;
+
+cleanup:
+    pthread_cond_broadcast(&lock_ctx->cond);
+    pthread_mutex_unlock(&lock_ctx->mutex);
+    return rc;
+}
+
+#define SR_LOCK_SHM_MAGIC 0x53524c54      /**< Magic number identifying initialized inter-process lock region ("SRLT"). */
+#define SR_LOCK_SHM_SLOT_COUNT 1024       /**< Maximum number of locks held in the inter-process lock region. */
+#define SR_LOCK_SHM_PROC_COUNT 256        /**< Maximum number of processes attached to the inter-process lock region. */
+#define SR_LOCK_SHM_POLL_INTERVAL 1       /**< Interval of polling a lock held by another process (in milliseconds). */
+
+#define SR_LOCK_GLOBAL_EXCL 0x01          /**< Exclusive lock is held with other processes. */
+#define SR_LOCK_GLOBAL_INTENT 0x02        /**< Intention exclusive lock is held with other processes. */
+
+/** Permissions of the file backing the inter-process locks (the same as of the lock files of the repository). */
+#define SR_LOCK_FILE_MODE (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)
+#define SR_LOCK_FILE_INIT_OFFSET 0               /**< Byte of the lock file serializing initialization of the region. */
+#define SR_LOCK_FILE_PROC_OFFSET (1 << 20)       /**< First byte of the lock file locked by the attached processes. */
+#define SR_LOCK_FILE_NAME_OFFSET (1 << 30)       /**< First byte of the lock file locked on behalf of the named locks. */
+#define SR_LOCK_FILE_NAME_RANGE (1 << 30)        /**< Number of bytes of the lock file used by the named locks. */
+
+/**
+ * @brief Lock table attached to the inter-process lock region within this process.
+ */
+typedef struct sr_lock_file_proc_s {
+    pid_t pid;                    /**< PID of the process that attached the table (differs in a forked child). */
+    uint64_t token;               /**< Token of the attachment. */
+} sr_lock_file_proc_t;
+
+/**
+ * @brief Byte of the lock file locked by this process on behalf of the named locks. The byte
+ * may be held by locks of several lock tables of the process (or by distinct names sharing the byte),
+ * the fcntl lock of the process is downgraded or released only when its last holder goes away.
+ */
+typedef struct sr_lock_file_byte_s {
+    off_t offset;                 /**< Offset of the byte. */
+    size_t readers;               /**< Number of locks holding the byte as a read lock. */
+    size_t writers;               /**< Number of locks holding the byte as a write lock. */
+} sr_lock_file_byte_t;
+
+/**
+ * @brief File backing the inter-process locks. fcntl locks belong to the process and closing any
+ * descriptor of the file releases all of them, so the file is opened only once per process and
+ * shared by all lock tables of the process.
+ */
+static struct {
+    pthread_mutex_t mutex;        /**< Mutex guarding the structure. */
+    pthread_mutex_t init_mutex;   /**< Serializes the initialization of the region within the process. */
+    char *path;                   /**< Path to the file, NULL if not opened. */
+    int fd;                       /**< File descriptor of the file. */
+    size_t refs;                  /**< Number of lock tables using the file. */
+    sr_omap_t *bytes;             /**< Bytes locked on behalf of the named locks (sr_lock_file_byte_t). */
+    pid_t bytes_pid;              /**< PID of the process holding the bytes (a forked child holds none of them). */
+    sr_lock_file_proc_t procs[SR_LOCK_SHM_PROC_COUNT];  /**< Lock tables of this process attached to the region. */
+} sr_lock_file = { .mutex = PTHREAD_MUTEX_INITIALIZER, .init_mutex = PTHREAD_MUTEX_INITIALIZER,
+        .path = NULL, .fd = -1, .refs = 0, .bytes = NULL, .bytes_pid = 0, };
+
+#ifdef HAVE_ROBUST_MUTEX
+/**
+ * @brief Lock slot of the inter-process lock region. Each process holding a lock has its own slot.
+ */
+typedef struct sr_lock_shm_slot_s {
+    uint64_t hash;                /**< Hash of the lock name, 0 if the slot has never been used. */
+    pid_t pid;                    /**< PID of the process holding the lock, 0 if the slot is free. */
+    uint32_t modes;               /**< Modes of the lock held by the process (SR_LOCK_GLOBAL_* flags). */
+    uint64_t token;               /**< Token of the attachment of the process holding the lock. */
+} sr_lock_shm_slot_t;
+
+/**
+ * @brief Process attached to the inter-process lock region.
+ */
+typedef struct sr_lock_shm_proc_s {
+    pid_t pid;                    /**< PID of the process, 0 if the entry is free. */
+    uint64_t token;               /**< Token unique for each attachment (distinguishes reused PIDs). */
+} sr_lock_shm_proc_t;
+
+/**
+ * @brief Inter-process lock region mapped into shared memory.
+ */
+typedef struct sr_lock_shm_s {
+    uint32_t magic;               /**< SR_LOCK_SHM_MAGIC once the region is initialized. */
+    uint32_t size;                /**< Size of the region (detects regions created by incompatible builds). */
+    pthread_mutex_t mutex;        /**< Robust process-shared mutex protecting the region. */
+    sr_lock_shm_proc_t procs[SR_LOCK_SHM_PROC_COUNT];  /**< Attached processes. */
+    sr_lock_shm_slot_t slots[SR_LOCK_SHM_SLOT_COUNT];  /**< Lock slots (open addressing by the hash of the name). */
+} sr_lock_shm_t;
+#endif
+
+/**
+ * @brief Owner waiting for a lock from the lock table.
+ */
+typedef struct sr_lock_waiter_s {
+    const void *owner;            /**< Owner waiting for the lock. */
+    sr_lock_mode_t mode;          /**< Requested mode of the lock. */
+    bool granted;                 /**< Set when the lock has been handed over to the owner. */
+} sr_lock_waiter_t;
+
+/**
+ * @brief Intention exclusive lock held by an owner.
+ */
+typedef struct sr_lock_intent_s {
+    const void *owner;            /**< Owner holding the lock. */
+    size_t count;                 /**< Number of times the owner acquired the lock. */
+} sr_lock_intent_t;
+
+/**
+ * @brief Lock of the lock table.
+ */
+typedef struct sr_lock_entry_s {
+    char *name;                   /**< Name of the lock. */
+    const void *owner;            /**< Owner holding the lock in exclusive mode, NULL if none. */
+    sr_list_t *intents;           /**< Owners holding the lock in intention exclusive mode (sr_lock_intent_t). */
+    sr_llist_t *waiters;          /**< Owners waiting for the lock (FIFO of sr_lock_waiter_t). */
+    uint8_t global;               /**< Modes of the lock held with other processes (SR_LOCK_GLOBAL_* flags). */
+    sr_lock_stats_t stats;        /**< Contention statistics of the lock. */
+} sr_lock_entry_t;
+
+/**
+ * @brief Lock table context.
+ */
+typedef struct sr_lock_table_s {
+    sr_omap_t *locks;             /**< Map of locks (sr_lock_entry_t) for fast look up by name. */
+    pthread_mutex_t mutex;        /**< Mutex for exclusive access to the locks. */
+    pthread_cond_t cond;          /**< Condition variable signaled when a lock is handed over. */
+#ifdef HAVE_ROBUST_MUTEX
+    sr_lock_shm_t *shm;           /**< Inter-process lock region, NULL if not in use. */
+    pid_t pid;                    /**< PID of the process. */
+    uint64_t token;               /**< Token of the attachment to the inter-process lock region. */
+    size_t proc_index;            /**< Index of the process entry in the inter-process lock region. */
+#endif
+    bool shared;                  /**< Locks are shared with other processes. */
+    int fd;                       /**< Descriptor of the file backing the inter-process locks, -1 if it can not be used. */
+} sr_lock_table_t;
+
+/**
+ * @brief Compare two locks by name.
+ */
+static int
+sr_lock_entry_cmp(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    sr_lock_entry_t *entry_a = (sr_lock_entry_t *) a;
+    sr_lock_entry_t *entry_b = (sr_lock_entry_t *) b;
+
+    int res = strcmp(entry_a->name, entry_b->name);
+    if (res == 0) {
+        return 0;
+    } else if (res < 0) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Computes hash of a lock from the name.
+ */
+static uint32_t
+sr_lock_entry_hash(const void *item)
+{
+    assert(item);
+    return sr_str_hash(((sr_lock_entry_t *) item)->name);
+}
+
+static void
+sr_lock_entry_free(void *item)
+{
+    sr_lock_entry_t *entry = (sr_lock_entry_t *) item;
+    if (NULL != entry) {
+        free(entry->name);
+        if (NULL != entry->intents) {
+            for (size_t i = 0; i < entry->intents->count; i++) {
+                free(entry->intents->data[i]);
+            }
+            sr_list_cleanup(entry->intents);
+        }
+        sr_llist_cleanup(entry->waiters);
+        free(entry);
+    }
+}
+
+/**
+ * @brief Computes the absolute deadline (CLOCK_REALTIME) of a wait with the given timeout (in milliseconds).
+ */
+static void
+sr_lock_table_deadline(int timeout, struct timespec *deadline)
+{
+    sr_clock_get_time(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout / 1000;
+    deadline->tv_nsec += (timeout % 1000) * 1000000L;
+    deadline->tv_sec += deadline->tv_nsec / 1000000000L;
+    deadline->tv_nsec %= 1000000000L;
+}
+
+/**
+ * @brief Returns TRUE if the deadline has passed.
+ */
+static bool
+sr_lock_table_expired(const struct timespec *deadline)
+{
+    struct timespec now = {0,};
+
+    sr_clock_get_time(CLOCK_REALTIME, &now);
+    return (now.tv_sec > deadline->tv_sec) || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/**
+ * @brief Returns time elapsed since the start (CLOCK_MONOTONIC) in microseconds.
+ */
+static uint64_t
+sr_lock_table_elapsed(const struct timespec *start)
+{
+    struct timespec now = {0,};
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000ULL + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/**
+ * @brief Computes the hash (FNV-1a) of a lock name, never returns 0.
+ */
+static uint64_t
+sr_lock_shm_hash(const char *name)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (const char *c = name; '\0' != *c; c++) {
+        hash ^= (unsigned char) *c;
+        hash *= 1099511628211ULL;
+    }
+    return (0 == hash) ? 1 : hash;
+}
+
+/**
+ * @brief Sets an fcntl lock of the given type (F_RDLCK, F_WRLCK or F_UNLCK) on one byte of the lock file.
+ *
+ * @return Error code (SR_ERR_OK on success), SR_ERR_LOCKED if the byte is locked by another process.
+ */
+static int
+sr_lock_file_set(int fd, short type, off_t offset, bool wait)
+{
+    struct flock fl = { 0, };
+
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = offset;
+    fl.l_len = 1;
+
+    if (-1 == fcntl(fd, wait ? F_SETLKW : F_SETLK, &fl)) {
+        if (!wait && (EAGAIN == errno || EACCES == errno)) {
+            return SR_ERR_LOCKED;
+        }
+        SR_LOG_ERR("Unable to lock the inter-process lock file: %s", sr_strerror_safe(errno));
+        return SR_ERR_INTERNAL;
+    }
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Compares two bytes of the lock file by offset.
+ */
+static int
+sr_lock_file_byte_cmp(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    sr_lock_file_byte_t *byte_a = (sr_lock_file_byte_t *) a;
+    sr_lock_file_byte_t *byte_b = (sr_lock_file_byte_t *) b;
+
+    if (byte_a->offset == byte_b->offset) {
+        return 0;
+    }
+    return (byte_a->offset < byte_b->offset) ? -1 : 1;
+}
+
+/**
+ * @brief Hashes a byte of the lock file.
+ */
+static uint32_t
+sr_lock_file_byte_hash(const void *item)
+{
+    assert(item);
+    uint64_t offset = (uint64_t) ((sr_lock_file_byte_t *) item)->offset;
+
+    return (uint32_t) (offset ^ (offset >> 32));
+}
+
+/**
+ * @brief Returns the fcntl lock type of the process on a byte with given numbers of holders.
+ */
+static short
+sr_lock_file_byte_type(size_t readers, size_t writers)
+{
+    if (writers > 0) {
+        return F_WRLCK;
+    }
+    return (readers > 0) ? F_RDLCK : F_UNLCK;
+}
+
+/**
+ * @brief Changes the lock of one byte of the lock file held by a named lock of this process from
+ * prev_type to type (F_RDLCK, F_WRLCK or F_UNLCK). The fcntl lock of the process is set only if
+ * the change is not covered by the other holders of the byte within the process.
+ *
+ * @return Error code (SR_ERR_OK on success), SR_ERR_LOCKED if the byte is locked by another process.
+ */
+static int
+sr_lock_file_hold(int fd, off_t offset, short prev_type, short type)
+{
+    int rc = SR_ERR_OK;
+    sr_lock_file_byte_t lookup = { 0, }, *byte = NULL;
+    size_t readers = 0, writers = 0;
+
+    if (prev_type == type) {
+        return SR_ERR_OK;
+    }
+
+    pthread_mutex_lock(&sr_lock_file.mutex);
+    if (NULL == sr_lock_file.bytes) {
+        rc = SR_ERR_INTERNAL;
+        goto cleanup;
+    }
+    if (getpid() != sr_lock_file.bytes_pid) {
+        /* fcntl locks are not inherited by a forked child */
+        while (NULL != (byte = sr_omap_get_at(sr_lock_file.bytes, 0))) {
+            sr_omap_delete(sr_lock_file.bytes, byte);
+        }
+        sr_lock_file.bytes_pid = getpid();
+    }
+
+    lookup.offset = offset;
+    byte = sr_omap_search(sr_lock_file.bytes, &lookup);
+    if (NULL == byte) {
+        byte = calloc(1, sizeof(*byte));
+        CHECK_NULL_NOMEM_GOTO(byte, rc, cleanup);
+        byte->offset = offset;
+        rc = sr_omap_insert(sr_lock_file.bytes, byte);
+        if (SR_ERR_OK != rc) {
+            free(byte);
+            goto cleanup;
+        }
+    }
+
+    readers = byte->readers - ((F_RDLCK == prev_type && byte->readers > 0) ? 1 : 0) + ((F_RDLCK == type) ? 1 : 0);
+    writers = byte->writers - ((F_WRLCK == prev_type && byte->writers > 0) ? 1 : 0) + ((F_WRLCK == type) ? 1 : 0);
+    if (sr_lock_file_byte_type(readers, writers) != sr_lock_file_byte_type(byte->readers, byte->writers)) {
+        /* a read lock is converted to a write lock atomically, it is kept if the conversion fails */
+        rc = sr_lock_file_set(fd, sr_lock_file_byte_type(readers, writers), offset, false);
+    }
+    if (SR_ERR_OK == rc) {
+        byte->readers = readers;
+        byte->writers = writers;
+    }
+    if (0 == byte->readers && 0 == byte->writers) {
+        sr_omap_delete(sr_lock_file.bytes, byte);
+    }
+
+cleanup:
+    pthread_mutex_unlock(&sr_lock_file.mutex);
+    return rc;
+}
+
+/**
+ * @brief Returns the byte of the lock file locked on behalf of the named lock. Distinct names may
+ * share a byte, which at worst reports a lock held by another process as a conflict.
+ */
+static off_t
+sr_lock_file_name_offset(const char *name)
+{
+    return SR_LOCK_FILE_NAME_OFFSET + (off_t) (sr_lock_shm_hash(name) % SR_LOCK_FILE_NAME_RANGE);
+}
+
+/**
+ * @brief Opens the file backing the inter-process locks (once per process), creating it accessible
+ * to all users of the repository regardless of the umask of the creating process.
+ */
+static int
+sr_lock_file_open(const char *path, int *fd_p)
+{
+    int rc = SR_ERR_OK, fd = -1;
+    struct stat st = {0,};
+
+    pthread_mutex_lock(&sr_lock_file.mutex);
+    if (NULL != sr_lock_file.path) {
+        if (0 != strcmp(path, sr_lock_file.path)) {
+            SR_LOG_ERR("Inter-process lock file '%s' is already in use, '%s' can not be used.", sr_lock_file.path, path);
+            rc = SR_ERR_INVAL_ARG;
+        } else {
+            sr_lock_file.refs++;
+            *fd_p = sr_lock_file.fd;
+        }
+        goto cleanup;
+    }
+
+    rc = sr_omap_init(sr_lock_file_byte_cmp, sr_lock_file_byte_hash, free, &sr_lock_file.bytes);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Creating of the locked bytes map failed");
+
+    fd = open(path, O_CREAT | O_RDWR, SR_LOCK_FILE_MODE);
+    if (-1 == fd) {
+        SR_LOG_ERR("Unable to open the inter-process lock file '%s': %s", path, sr_strerror_safe(errno));
+        rc = (EACCES == errno) ? SR_ERR_UNAUTHORIZED : SR_ERR_IO;
+        goto cleanup;
+    }
+    if (0 == fstat(fd, &st) && st.st_uid == geteuid() && SR_LOCK_FILE_MODE != (st.st_mode & 0777)) {
+        if (-1 == fchmod(fd, SR_LOCK_FILE_MODE)) {
+            SR_LOG_WRN("Unable to set permissions of '%s': %s", path, sr_strerror_safe(errno));
+        }
+    }
+
+    sr_lock_file.path = strdup(path);
+    if (NULL == sr_lock_file.path) {
+        close(fd);
+        rc = SR_ERR_NOMEM;
+        goto cleanup;
+    }
+    sr_lock_file.fd = fd;
+    sr_lock_file.refs = 1;
+    *fd_p = fd;
+
+cleanup:
+    if (SR_ERR_OK != rc && NULL == sr_lock_file.path) {
+        sr_omap_cleanup(sr_lock_file.bytes);
+        sr_lock_file.bytes = NULL;
+    }
+    pthread_mutex_unlock(&sr_lock_file.mutex);
+    return rc;
+}
+
+/**
+ * @brief Releases a reference to the file backing the inter-process locks, closes it with the last one.
+ */
+static void
+sr_lock_file_close(int fd)
+{
+    pthread_mutex_lock(&sr_lock_file.mutex);
+    if (fd == sr_lock_file.fd && 0 == --sr_lock_file.refs) {
+        close(sr_lock_file.fd);
+        free(sr_lock_file.path);
+        sr_omap_cleanup(sr_lock_file.bytes);
+        sr_lock_file.path = NULL;
+        sr_lock_file.fd = -1;
+        sr_lock_file.bytes = NULL;
+    }
+    pthread_mutex_unlock(&sr_lock_file.mutex);
+}
+
+#ifdef HAVE_ROBUST_MUTEX
+/**
+ * @brief Locks the mutex of the inter-process lock region. If the previous holder of the mutex
+ * died, the mutex is made consistent again (the region is updated by single slot writes only).
+ */
+static int
+sr_lock_shm_mutex_lock(sr_lock_shm_t *shm)
+{
+    int ret = pthread_mutex_lock(&shm->mutex);
+
+    if (EOWNERDEAD == ret) {
+        SR_LOG_WRN_MSG("Owner of the inter-process lock region mutex died, recovering.");
+        ret = pthread_mutex_consistent(&shm->mutex);
+    }
+    if (0 != ret) {
+        SR_LOG_ERR("Unable to lock the inter-process lock region: %s", sr_strerror_safe(ret));
+        return SR_ERR_INTERNAL;
+    }
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Returns TRUE if the process entry of the region belongs to a living attachment. Each attached
+ * process holds an fcntl lock on the byte of its entry, which the kernel releases when the process
+ * dies. Unlike signalling the PID, this works across PID namespaces and is not fooled by reused PIDs.
+ * fcntl does not report the locks of the calling process, its own attachments are looked up locally.
+ */
+static bool
+sr_lock_shm_proc_entry_alive(int fd, size_t index, uint64_t token)
+{
+    struct flock fl = { 0, };
+    pid_t pid = getpid();
+    bool own = false;
+
+    pthread_mutex_lock(&sr_lock_file.mutex);
+    for (size_t i = 0; !own && i < SR_LOCK_SHM_PROC_COUNT; i++) {
+        own = (pid == sr_lock_file.procs[i].pid && token == sr_lock_file.procs[i].token);
+    }
+    pthread_mutex_unlock(&sr_lock_file.mutex);
+    if (own) {
+        return true;
+    }
+
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = SR_LOCK_FILE_PROC_OFFSET + index;
+    fl.l_len = 1;
+    if (-1 == fcntl(fd, F_GETLK, &fl)) {
+        /* can not tell, do not reclaim */
+        return true;
+    }
+    return F_UNLCK != fl.l_type;
+}
+
+/**
+ * @brief Returns TRUE if the process with given PID and token is still attached to the region.
+ */
+static bool
+sr_lock_shm_proc_alive(sr_lock_table_t *table, pid_t pid, uint64_t token)
+{
+    sr_lock_shm_t *shm = table->shm;
+
+    for (size_t i = 0; i < SR_LOCK_SHM_PROC_COUNT; i++) {
+        if (pid == shm->procs[i].pid && token == shm->procs[i].token) {
+            return sr_lock_shm_proc_entry_alive(table->fd, i, token);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Maps the inter-process lock region from the lock file and attaches the process to it.
+ */
+static int
+sr_lock_shm_attach(sr_lock_table_t *table, const char *shm_file)
+{
+    int rc = SR_ERR_OK, ret = 0;
+    struct stat st = {0,};
+    struct timespec ts = {0,};
+    pthread_mutexattr_t attr;
+    sr_lock_shm_t *shm = NULL;
+    sr_lock_shm_proc_t *proc = NULL;
+    size_t index = 0;
+    bool init_locked = false;
+
+    /* the region is initialized by the first process, serialize it by a file lock (and by a mutex
+     * within the process, the file lock does not exclude the threads of the process holding it) */
+    pthread_mutex_lock(&sr_lock_file.init_mutex);
+    rc = sr_lock_file_set(table->fd, F_WRLCK, SR_LOCK_FILE_INIT_OFFSET, true);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to lock the inter-process lock region '%s'", shm_file);
+    init_locked = true;
+
+    ret = fstat(table->fd, &st);
+    CHECK_NOT_MINUS1_LOG_GOTO(ret, rc, SR_ERR_IO, cleanup, "Stat of '%s' failed: %s", shm_file, sr_strerror_safe(errno));
+    if (st.st_size < (off_t) sizeof(*shm)) {
+        ret = ftruncate(table->fd, sizeof(*shm));
+        CHECK_NOT_MINUS1_LOG_GOTO(ret, rc, SR_ERR_IO, cleanup, "Truncate of '%s' failed: %s", shm_file, sr_strerror_safe(errno));
+    }
+
+    shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, table->fd, 0);
+    if (MAP_FAILED == shm) {
+        SR_LOG_WRN("Unable to map the inter-process lock region '%s': %s", shm_file, sr_strerror_safe(errno));
+        shm = NULL;
+        rc = SR_ERR_IO;
+        goto cleanup;
+    }
+
+    if (SR_LOCK_SHM_MAGIC != shm->magic) {
+        memset(shm, 0, sizeof(*shm));
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        ret = pthread_mutex_init(&shm->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        CHECK_ZERO_MSG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "Inter-process lock region mutex initialization failed");
+        shm->size = sizeof(*shm);
+        shm->magic = SR_LOCK_SHM_MAGIC;
+    } else if (sizeof(*shm) != shm->size) {
+        SR_LOG_WRN("Inter-process lock region '%s' has been created by an incompatible version.", shm_file);
+        rc = SR_ERR_UNSUPPORTED;
+        goto cleanup;
+    }
+
+    /* attach the process, replacing the entries of the attachments that no longer exist */
+    table->pid = getpid();
+    sr_clock_get_time(CLOCK_REALTIME, &ts);
+    table->token = ((uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec) ^ ((uint64_t) table->pid << 32) ^ (uintptr_t) table;
+
+    rc = sr_lock_shm_mutex_lock(shm);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to attach to the inter-process lock region");
+    for (index = 0; index < SR_LOCK_SHM_PROC_COUNT; index++) {
+        if (0 == shm->procs[index].pid || !sr_lock_shm_proc_entry_alive(table->fd, index, shm->procs[index].token)) {
+            /* the entry is taken over by holding the lock of its byte */
+            if (SR_ERR_OK == sr_lock_file_set(table->fd, F_WRLCK, SR_LOCK_FILE_PROC_OFFSET + index, false)) {
+                proc = &shm->procs[index];
+                proc->pid = table->pid;
+                proc->token = table->token;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&shm->mutex);
+    if (NULL == proc) {
+        SR_LOG_WRN("Too many processes attached to the inter-process lock region '%s'.", shm_file);
+        rc = SR_ERR_INTERNAL;
+        goto cleanup;
+    }
+    table->proc_index = index;
+
+    /* remember the attachment, fcntl does not report the locks of the own process */
+    pthread_mutex_lock(&sr_lock_file.mutex);
+    for (size_t i = 0; i < SR_LOCK_SHM_PROC_COUNT; i++) {
+        if (0 == sr_lock_file.procs[i].token || getpid() != sr_lock_file.procs[i].pid) {
+            sr_lock_file.procs[i].pid = table->pid;
+            sr_lock_file.procs[i].token = table->token;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sr_lock_file.mutex);
+
+    table->shm = shm;
+    SR_LOG_DBG("Attached to the inter-process lock region '%s'.", shm_file);
+
+cleanup:
+    if (SR_ERR_OK != rc && NULL != shm) {
+        munmap(shm, sizeof(*shm));
+    }
+    if (init_locked) {
+        sr_lock_file_set(table->fd, F_UNLCK, SR_LOCK_FILE_INIT_OFFSET, false);
+    }
+    pthread_mutex_unlock(&sr_lock_file.init_mutex);
+    return rc;
+}
+
+/**
+ * @brief Releases all locks of the process and detaches it from the inter-process lock region.
+ */
+static void
+sr_lock_shm_detach(sr_lock_table_t *table)
+{
+    sr_lock_shm_t *shm = table->shm;
+
+    if (NULL == shm) {
+        return;
+    }
+    if (SR_ERR_OK == sr_lock_shm_mutex_lock(shm)) {
+        for (size_t i = 0; i < SR_LOCK_SHM_SLOT_COUNT; i++) {
+            if (table->pid == shm->slots[i].pid && table->token == shm->slots[i].token) {
+                shm->slots[i].pid = 0;
+                shm->slots[i].modes = 0;
+                shm->slots[i].token = 0;
+            }
+        }
+        if (table->pid == shm->procs[table->proc_index].pid && table->token == shm->procs[table->proc_index].token) {
+            shm->procs[table->proc_index].pid = 0;
+            shm->procs[table->proc_index].token = 0;
+        }
+        pthread_mutex_unlock(&shm->mutex);
+    }
+    sr_lock_file_set(table->fd, F_UNLCK, SR_LOCK_FILE_PROC_OFFSET + table->proc_index, false);
+
+    pthread_mutex_lock(&sr_lock_file.mutex);
+    for (size_t i = 0; i < SR_LOCK_SHM_PROC_COUNT; i++) {
+        if (table->pid == sr_lock_file.procs[i].pid && table->token == sr_lock_file.procs[i].token) {
+            sr_lock_file.procs[i].pid = 0;
+            sr_lock_file.procs[i].token = 0;
+        }
+    }
+    pthread_mutex_unlock(&sr_lock_file.mutex);
+
+    munmap(shm, sizeof(*shm));
+    table->shm = NULL;
+}
+
+/**
+ * @brief Tries to acquire the lock of the given name in given mode (SR_LOCK_GLOBAL_* flag) in the
+ * inter-process lock region. Conflicting locks held by processes that no longer exist are reclaimed.
+ */
+static int
+sr_lock_shm_try_lock(sr_lock_table_t *table, const char *name, uint8_t mode)
+{
+    int rc = SR_ERR_OK;
+    sr_lock_shm_t *shm = table->shm;
+    sr_lock_shm_slot_t *slot = NULL, *own_slot = NULL, *free_slot = NULL;
+    uint64_t hash = sr_lock_shm_hash(name);
+    size_t index = hash % SR_LOCK_SHM_SLOT_COUNT;
+
+    rc = sr_lock_shm_mutex_lock(shm);
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    /* all processes holding the lock have a slot in the probe sequence (terminated by a never used slot) */
+    for (size_t i = 0; i < SR_LOCK_SHM_SLOT_COUNT; i++) {
+        slot = &shm->slots[(index + i) % SR_LOCK_SHM_SLOT_COUNT];
+        if (0 == slot->hash) {
+            if (NULL == free_slot) {
+                free_slot = slot;
+            }
+            break;
+        }
+        if (hash == slot->hash && 0 != slot->pid) {
+            if (table->pid == slot->pid && table->token == slot->token) {
+                own_slot = slot;
+                continue;
+            }
+            if (!(SR_LOCK_GLOBAL_EXCL & (mode | slot->modes))) {
+                /* intention locks are compatible */
+                continue;
+            }
+            if (sr_lock_shm_proc_alive(table, slot->pid, slot->token)) {
+                rc = SR_ERR_LOCKED;
+                goto cleanup;
+            }
+            SR_LOG_WRN("Reclaiming lock '%s' held by terminated process %d.", name, (int) slot->pid);
+            slot->pid = 0;
+            slot->modes = 0;
+            slot->token = 0;
+        }
+        if (NULL == free_slot && 0 == slot->pid) {
+            free_slot = slot;
+        }
+    }
+
+    if (NULL == own_slot) {
+        if (NULL == free_slot) {
+            SR_LOG_ERR("No free slot in the inter-process lock region for lock '%s'.", name);
+            rc = SR_ERR_INTERNAL;
+            goto cleanup;
+        }
+        own_slot = free_slot;
+        own_slot->hash = hash;
+        own_slot->pid = table->pid;
+        own_slot->token = table->token;
+        own_slot->modes = 0;
+    }
+    own_slot->modes |= mode;
+
+cleanup:
+    pthread_mutex_unlock(&shm->mutex);
+    return rc;
+}
+
+/**
+ * @brief Releases given mode (SR_LOCK_GLOBAL_* flag) of the lock of the given name in the inter-process lock region.
+ */
+static void
+sr_lock_shm_unlock(sr_lock_table_t *table, const char *name, uint8_t mode)
+{
+    sr_lock_shm_t *shm = table->shm;
+    sr_lock_shm_slot_t *slot = NULL;
+    uint64_t hash = sr_lock_shm_hash(name);
+    size_t index = hash % SR_LOCK_SHM_SLOT_COUNT;
+
+    if (SR_ERR_OK != sr_lock_shm_mutex_lock(shm)) {
+        return;
+    }
+    for (size_t i = 0; i < SR_LOCK_SHM_SLOT_COUNT; i++) {
+        slot = &shm->slots[(index + i) % SR_LOCK_SHM_SLOT_COUNT];
+        if (0 == slot->hash) {
+            break;
+        }
+        if (hash == slot->hash && table->pid == slot->pid && table->token == slot->token) {
+            slot->modes &= ~mode;
+            if (0 == slot->modes) {
+                /* keep the hash, the slot may be part of the probe sequence of another lock */
+                slot->pid = 0;
+                slot->token = 0;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shm->mutex);
+}
+#endif
+
+/**
+ * @brief Returns the type of the fcntl lock representing the global modes of the entry: exclusive
+ * locks are write locks, intention exclusive locks are read locks, which are compatible with each other.
+ */
+static short
+sr_lock_table_file_type(uint8_t global)
 {
-    CHECK_NULL_ARG2(lock_ctx, filename);
-    int rc = SR_ERR_OK;
-    sr_lock_item_t lookup_item = {0,};
-    sr_lock_item_t *found_item = NULL;
-    lookup_item.filename = filename;
+    if (SR_LOCK_GLOBAL_EXCL & global) {
+        return F_WRLCK;
+    }
+    return (SR_LOCK_GLOBAL_INTENT & global) ? F_RDLCK : F_UNLCK;
+}
 
-    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+/**
+ * @brief Tries to acquire the lock in given mode with other processes (if the locks are shared).
+ * The lock is always taken as an fcntl lock of the lock file, so that all processes exclude each
+ * other even if some of them can not use the shared memory region. The region additionally excludes
+ * lock tables within one process, which fcntl locks do not distinguish. The fcntl lock is counted
+ * per process, so it is set only by the first holder of the byte within the process.
+ * Expects the table mutex to be locked.
+ */
+static int
+sr_lock_table_try_global(sr_lock_table_t *table, sr_lock_entry_t *entry, sr_lock_mode_t mode)
+{
+    int rc = SR_ERR_OK;
+    uint8_t flag = (SR_LOCK_EXCL == mode) ? SR_LOCK_GLOBAL_EXCL : SR_LOCK_GLOBAL_INTENT;
+    short type = F_UNLCK, prev_type = F_UNLCK;
+    off_t offset = 0;
 
-    found_item = sr_btree_search(lock_ctx->lock_files, &lookup_item);
-    if (NULL == found_item) {
-        found_item = calloc(1, sizeof(*found_item));
-        CHECK_NULL_NOMEM_GOTO(found_item, rc, cleanup);
+    if (!table->shared || (flag & entry->global)) {
+        return SR_ERR_OK;
+    }
+    if (-1 == table->fd) {
+        SR_LOG_ERR("Lock %s can not be shared with other processes, the inter-process lock file is not accessible.",
+                entry->name);
+        return SR_ERR_UNAUTHORIZED;
+    }
 
-        found_item->fd = -1;
-        found_item->filename = strdup(filename);
-        found_item->locked = false;
-        if (NULL == found_item->filename) {
-            SR_LOG_ERR_MSG("Filename duplication failed");
-            free(found_item);
-            rc = SR_ERR_INTERNAL;
-            goto cleanup;
+    offset = sr_lock_file_name_offset(entry->name);
+    prev_type = sr_lock_table_file_type(entry->global);
+    type = sr_lock_table_file_type(entry->global | flag);
+    rc = sr_lock_file_hold(table->fd, offset, prev_type, type);
+#ifdef HAVE_ROBUST_MUTEX
+    if (SR_ERR_OK == rc && NULL != table->shm) {
+        rc = sr_lock_shm_try_lock(table, entry->name, flag);
+        if (SR_ERR_OK != rc) {
+            /* the byte is released only if no other lock of the process holds it */
+            sr_lock_file_hold(table->fd, offset, type, prev_type);
         }
+    }
+#endif
+    if (SR_ERR_OK == rc) {
+        entry->global |= flag;
+    }
+    return rc;
+}
 
-        rc = sr_btree_insert(lock_ctx->lock_files, found_item);
-        if (SR_ERR_OK != rc) {
-            SR_LOG_ERR_MSG("Adding to binary tree failed");
-            sr_free_lock_item(found_item);
-            goto cleanup;
+/**
+ * @brief Releases the lock in given mode with other processes (if it is held). Releasing an exclusive
+ * lock while an intention exclusive lock is held downgrades the fcntl lock to a read lock, unless
+ * another lock of the process holds the byte.
+ * Expects the table mutex to be locked.
+ */
+static void
+sr_lock_table_release_global(sr_lock_table_t *table, sr_lock_entry_t *entry, sr_lock_mode_t mode)
+{
+    uint8_t flag = (SR_LOCK_EXCL == mode) ? SR_LOCK_GLOBAL_EXCL : SR_LOCK_GLOBAL_INTENT;
+
+    if (!(flag & entry->global)) {
+        return;
+    }
+#ifdef HAVE_ROBUST_MUTEX
+    if (NULL != table->shm) {
+        sr_lock_shm_unlock(table, entry->name, flag);
+    }
+#endif
+    sr_lock_file_hold(table->fd, sr_lock_file_name_offset(entry->name), sr_lock_table_file_type(entry->global),
+            sr_lock_table_file_type(entry->global & ~flag));
+    entry->global &= ~flag;
+}
+
+/**
+ * @brief Returns the intention lock held by the owner, NULL if the owner holds none.
+ */
+static sr_lock_intent_t *
+sr_lock_entry_get_intent(sr_lock_entry_t *entry, const void *owner)
+{
+    for (size_t i = 0; i < entry->intents->count; i++) {
+        if (owner == ((sr_lock_intent_t *) entry->intents->data[i])->owner) {
+            return entry->intents->data[i];
         }
+    }
+    return NULL;
+}
 
+/**
+ * @brief Returns TRUE if the owner can be granted the lock in given mode with respect to the locks
+ * held by other owners. Constant time - an exclusive lock conflicts with any intention lock of
+ * another owner, so it is enough to know the number of the intention lock holders.
+ */
+static bool
+sr_lock_entry_compatible(sr_lock_entry_t *entry, const void *owner, sr_lock_mode_t mode)
+{
+    if (NULL != entry->owner && owner != entry->owner) {
+        return false;
     }
+    if (SR_LOCK_EXCL == mode) {
+        return (0 == entry->intents->count) ||
+                (1 == entry->intents->count && owner == ((sr_lock_intent_t *) entry->intents->data[0])->owner);
+    }
+    return true;
+}
 
-    if (!blocking && found_item->locked) {
-        rc = SR_ERR_LOCKED;
-        SR_LOG_INF("File %s locked by other process", filename);
-        goto cleanup;
+/**
+ * @brief Grants the lock in given mode to the owner within the process.
+ */
+static int
+sr_lock_entry_grant(sr_lock_entry_t *entry, const void *owner, sr_lock_mode_t mode)
+{
+    int rc = SR_ERR_OK;
+    sr_lock_intent_t *intent = NULL;
+
+    if (SR_LOCK_EXCL == mode) {
+        entry->owner = owner;
+        return SR_ERR_OK;
     }
 
-    while (found_item->locked) {
-        pthread_cond_wait(&lock_ctx->cond, &lock_ctx->mutex);
+    intent = sr_lock_entry_get_intent(entry, owner);
+    if (NULL == intent) {
+        intent = calloc(1, sizeof(*intent));
+        CHECK_NULL_NOMEM_RETURN(intent);
+        intent->owner = owner;
+        rc = sr_list_add(entry->intents, intent);
+        if (SR_ERR_OK != rc) {
+            free(intent);
+            return rc;
+        }
     }
+    intent->count++;
+    return SR_ERR_OK;
+}
 
-    if (-1 == found_item->fd) {
-        found_item->fd = open(filename, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-        if (-1 == found_item->fd) {
-            if (EACCES == errno) {
-                SR_LOG_ERR("Insufficient permissions to lock the file '%s'", filename);
-                rc = SR_ERR_UNAUTHORIZED;
-            } else {
-                SR_LOG_ERR("Error by opening the file '%s': %s", filename, sr_strerror_safe(errno));
-                rc = SR_ERR_INTERNAL;
-            }
-            goto cleanup;
+/**
+ * @brief Grants the lock to the waiting owners in FIFO order while their requests are compatible.
+ * Expects the table mutex to be locked.
+ */
+static void
+sr_lock_table_dispatch(sr_lock_table_t *table, sr_lock_entry_t *entry)
+{
+    sr_lock_waiter_t *waiter = NULL;
+    bool granted = false;
+
+    while (NULL != entry->waiters->first) {
+        waiter = (sr_lock_waiter_t *) entry->waiters->first->data;
+        if (!sr_lock_entry_compatible(entry, waiter->owner, waiter->mode) ||
+                SR_ERR_OK != sr_lock_entry_grant(entry, waiter->owner, waiter->mode)) {
+            break;
         }
+        waiter->granted = true;
+        granted = true;
+        sr_llist_rm(entry->waiters, entry->waiters->first);
+    }
+    if (granted) {
+        pthread_cond_broadcast(&table->cond);
     }
+}
 
-    rc = sr_lock_fd(found_item->fd, write, blocking);
-    if (SR_ERR_OK == rc) {
-        SR_LOG_DBG("File %s has been locked", filename);
-        found_item->locked = true;
-        rc = sr_btree_insert(lock_ctx->fd_index, found_item);
-        CHECK_RC_LOG_GOTO(rc, cleanup, "Insert into fd index failed file %s (fd = %d)", found_item->filename, found_item->fd);
+/**
+ * @brief Releases the lock held by the owner in given mode and hands it over to the waiting owners.
+ * Expects the table mutex to be locked.
+ */
+static void
+sr_lock_table_release(sr_lock_table_t *table, sr_lock_entry_t *entry, const void *owner, sr_lock_mode_t mode)
+{
+    sr_lock_intent_t *intent = NULL;
+
+    if (SR_LOCK_EXCL == mode) {
+        entry->owner = NULL;
+        sr_lock_table_release_global(table, entry, mode);
     } else {
-        SR_LOG_WRN("File %s can not be locked", filename);
-        close(found_item->fd);
-        found_item->fd = -1;
+        intent = sr_lock_entry_get_intent(entry, owner);
+        if (NULL != intent && 0 == --intent->count) {
+            sr_list_rm(entry->intents, intent);
+            free(intent);
+        }
+        if (0 == entry->intents->count) {
+            sr_lock_table_release_global(table, entry, mode);
+        }
     }
+    sr_lock_table_dispatch(table, entry);
+}
 
-    if (NULL != fd) {
-        *fd = found_item->fd;
+int
+sr_lock_table_init(const char *shm_file, sr_lock_table_t **table_p)
+{
+    CHECK_NULL_ARG(table_p);
+    int rc = SR_ERR_OK;
+    sr_lock_table_t *table = NULL;
+
+    table = calloc(1, sizeof(*table));
+    CHECK_NULL_NOMEM_RETURN(table);
+    table->fd = -1;
+
+    pthread_mutex_init(&table->mutex, NULL);
+    pthread_cond_init(&table->cond, NULL);
+    rc = sr_omap_init(sr_lock_entry_cmp, sr_lock_entry_hash, sr_lock_entry_free, &table->locks);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Creating of locks binary tree failed");
+
+    if (NULL != shm_file) {
+        /* the locks must be shared, if the file is not accessible they fail instead of being process-local */
+        table->shared = true;
+        if (SR_ERR_OK != sr_lock_file_open(shm_file, &table->fd)) {
+            SR_LOG_ERR("Inter-process lock file '%s' can not be used, locking will fail.", shm_file);
+            table->fd = -1;
+        }
+#ifdef HAVE_ROBUST_MUTEX
+        if (-1 != table->fd && SR_ERR_OK != sr_lock_shm_attach(table, shm_file)) {
+            SR_LOG_WRN("Inter-process lock region '%s' can not be used, only file locks are shared.", shm_file);
+        }
+#endif
     }
 
+    *table_p = table;
+    return rc;
+
 cleanup:
-    pthread_mutex_unlock(&lock_ctx->mutex);
+    sr_lock_table_cleanup(table);
     return rc;
 }
 
+void
+sr_lock_table_cleanup(sr_lock_table_t *table)
+{
+    if (NULL != table) {
+        if (-1 != table->fd) {
+            /* the file is shared with other tables of the process, release the file locks of this one */
+            sr_lock_entry_t *entry = NULL;
+            for (size_t i = 0; NULL != (entry = sr_omap_get_at(table->locks, i)); i++) {
+                if (0 != entry->global) {
+                    sr_lock_file_hold(table->fd, sr_lock_file_name_offset(entry->name),
+                            sr_lock_table_file_type(entry->global), F_UNLCK);
+                    entry->global = 0;
+                }
+            }
+        }
+#ifdef HAVE_ROBUST_MUTEX
+        sr_lock_shm_detach(table);
+#endif
+        sr_omap_cleanup(table->locks);
+        if (-1 != table->fd) {
+            /* released together with the file when the last table of the process is cleaned up */
+            sr_lock_file_close(table->fd);
+        }
+        pthread_mutex_destroy(&table->mutex);
+        pthread_cond_destroy(&table->cond);
+        free(table);
+    }
+}
+
 int
-sr_locking_set_lock_fd(sr_locking_set_t *lock_ctx, int fd, char *filename, bool write, bool blocking)
+sr_lock_table_lock(sr_lock_table_t *table, const char *name, const void *owner, sr_lock_mode_t mode, int timeout)
 {
-    CHECK_NULL_ARG2(lock_ctx, filename);
-    int rc = SR_ERR_OK;
-    sr_lock_item_t lookup_item = {0,};
-    sr_lock_item_t *found_item = NULL;
-    lookup_item.filename = filename;
+    CHECK_NULL_ARG3(table, name, owner);
+    int rc = SR_ERR_OK, ret = 0;
+    sr_lock_entry_t lookup = {0,}, *entry = NULL;
+    sr_lock_intent_t *intent = NULL;
+    sr_lock_waiter_t waiter = {0,};
+    sr_llist_node_t *node = NULL;
+    struct timespec deadline = {0,}, start = {0,};
+    struct timespec interval = {0, SR_LOCK_SHM_POLL_INTERVAL * 1000000L};
+    bool contended = false;
 
-    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+    lookup.name = (char *) name;
+    if (timeout > 0) {
+        sr_lock_table_deadline(timeout, &deadline);
+    }
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
 
-    found_item = sr_btree_search(lock_ctx->lock_files, &lookup_item);
-    if (NULL == found_item) {
-        found_item = calloc(1, sizeof(*found_item));
-        CHECK_NULL_NOMEM_GOTO(found_item, rc, cleanup);
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&table->mutex);
 
-        found_item->fd = -1;
-        found_item->filename = strdup(filename);
-        if (NULL == found_item->filename) {
-            SR_LOG_ERR_MSG("Filename duplication failed");
-            free(found_item);
-            rc = SR_ERR_INTERNAL;
-            goto cleanup;
+    entry = sr_omap_search(table->locks, &lookup);
+    if (NULL == entry) {
+        entry = calloc(1, sizeof(*entry));
+        CHECK_NULL_NOMEM_GOTO(entry, rc, unlock);
+        entry->name = strdup(name);
+        if (NULL != entry->name) {
+            rc = sr_list_init(&entry->intents);
         }
-
-        rc = sr_btree_insert(lock_ctx->lock_files, found_item);
+        if (NULL != entry->name && SR_ERR_OK == rc) {
+            rc = sr_llist_init(&entry->waiters);
+        }
+        if (NULL == entry->name || SR_ERR_OK != rc) {
+            SR_LOG_ERR_MSG("Lock allocation failed");
+            sr_lock_entry_free(entry);
+            rc = SR_ERR_NOMEM;
+            goto unlock;
+        }
+        rc = sr_omap_insert(table->locks, entry);
         if (SR_ERR_OK != rc) {
             SR_LOG_ERR_MSG("Adding to binary tree failed");
-            sr_free_lock_item(found_item);
-            goto cleanup;
+            sr_lock_entry_free(entry);
+            goto unlock;
         }
     }
 
-    if (!blocking && found_item->locked) {
-        rc = SR_ERR_LOCKED;
-        SR_LOG_INF("File %s can not be locked", filename);
-        goto cleanup;
+    if (SR_LOCK_EXCL == mode && owner == entry->owner) {
+        /* exclusive lock already held by the owner */
+        goto unlock;
     }
-
-    while (found_item->locked) {
-        pthread_cond_wait(&lock_ctx->cond, &lock_ctx->mutex);
+    if (SR_LOCK_INTENT_EXCL == mode && NULL != (intent = sr_lock_entry_get_intent(entry, owner))) {
+        /* intention locks are counted */
+        intent->count++;
+        goto unlock;
     }
 
-    rc = sr_lock_fd(fd, write, blocking);
-    if (SR_ERR_OK == rc) {
-        SR_LOG_DBG("File %s has been locked", filename);
-        found_item->fd = fd;
-        found_item->locked = true;
-
-        rc = sr_btree_insert(lock_ctx->fd_index, found_item);
-        CHECK_RC_MSG_GOTO(rc, cleanup, "Insert into fd index failed");
+    if (NULL != entry->waiters->first || !sr_lock_entry_compatible(entry, owner, mode)) {
+        /* the lock is held (or already awaited) by another owner in this process */
+        contended = true;
+        if (0 == timeout) {
+            rc = SR_ERR_LOCKED;
+            goto stats;
+        }
+        waiter.owner = owner;
+        waiter.mode = mode;
+        rc = sr_llist_add_new(entry->waiters, &waiter);
+        CHECK_RC_MSG_GOTO(rc, unlock, "Adding to waiters list failed");
+        node = entry->waiters->last;
+
+        while (!waiter.granted && ETIMEDOUT != ret) {
+            if (timeout < 0) {
+                ret = pthread_cond_wait(&table->cond, &table->mutex);
+            } else {
+                ret = pthread_cond_timedwait(&table->cond, &table->mutex, &deadline);
+            }
+        }
+        if (!waiter.granted) {
+            sr_llist_rm(entry->waiters, node);
+            /* the waiter may have blocked compatible requests queued behind it */
+            sr_lock_table_dispatch(table, entry);
+            rc = SR_ERR_LOCKED;
+            goto stats;
+        }
     } else {
-        SR_LOG_WRN("File %s can not be locked", filename);
-        found_item->fd = -1;
+        rc = sr_lock_entry_grant(entry, owner, mode);
+        CHECK_RC_MSG_GOTO(rc, unlock, "Lock grant failed");
     }
 
+    /* the lock is held within the process, acquire it with other processes */
+    while (SR_ERR_LOCKED == (rc = sr_lock_table_try_global(table, entry, mode))) {
+        /* there is no way to be notified about the release by another process, poll */
+        contended = true;
+        if (0 == timeout || (timeout > 0 && sr_lock_table_expired(&deadline))) {
+            break;
+        }
+        pthread_mutex_unlock(&table->mutex);
+        nanosleep(&interval, NULL);
+        MUTEX_LOCK_TIMED_CHECK_RETURN(&table->mutex);
+    }
+    if (SR_ERR_OK != rc) {
+        sr_lock_table_release(table, entry, owner, mode);
+    }
 
-cleanup:
-    pthread_mutex_unlock(&lock_ctx->mutex);
+stats:
+    if (SR_ERR_OK == rc) {
+        entry->stats.acquired++;
+    } else if (SR_ERR_LOCKED == rc) {
+        SR_LOG_INF("Lock %s is held by another owner", name);
+        entry->stats.timeouts++;
+    }
+    if (contended) {
+        entry->stats.contended++;
+        entry->stats.wait_time += sr_lock_table_elapsed(&start);
+    }
+
+unlock:
+    pthread_mutex_unlock(&table->mutex);
     return rc;
 }
 
 int
-sr_locking_set_unlock_close_file(sr_locking_set_t* lock_ctx, char* filename)
+sr_lock_table_unlock(sr_lock_table_t *table, const char *name, const void *owner, sr_lock_mode_t mode)
 {
-    CHECK_NULL_ARG2(lock_ctx, filename);
+    CHECK_NULL_ARG3(table, name, owner);
     int rc = SR_ERR_OK;
-    sr_lock_item_t lookup_item = {0,};
-    sr_lock_item_t *found_item = NULL;
-    lookup_item.filename = filename;
+    sr_lock_entry_t lookup = {0,}, *entry = NULL;
 
-    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+    lookup.name = (char *) name;
 
-    found_item = sr_btree_search(lock_ctx->lock_files, &lookup_item);
-    if (NULL == found_item || -1 == found_item->fd) {
-        SR_LOG_ERR("File %s has not been locked in this context", filename);
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&table->mutex);
+    entry = sr_omap_search(table->locks, &lookup);
+    if (NULL == entry || (SR_LOCK_EXCL == mode && owner != entry->owner) ||
+            (SR_LOCK_INTENT_EXCL == mode && NULL == sr_lock_entry_get_intent(entry, owner))) {
+        SR_LOG_ERR("Lock %s is not held by the owner", name);
         rc = SR_ERR_INVAL_ARG;
         goto cleanup;
     }
-    sr_btree_delete(lock_ctx->fd_index, found_item);
-    sr_unlock_fd(found_item->fd);
 
-    rc = close(found_item->fd);
-    if (SR_ERR_OK != rc) {
-        SR_LOG_WRN("Close failed %s", sr_strerror_safe(errno));
-    }
-    found_item->locked = false;
-    found_item->fd = -1;
-    SR_LOG_DBG("File %s has been unlocked", filename);
+    sr_lock_table_release(table, entry, owner, mode);
 
 cleanup:
-    pthread_cond_broadcast(&lock_ctx->cond);
-    pthread_mutex_unlock(&lock_ctx->mutex);
+    pthread_mutex_unlock(&table->mutex);
     return rc;
 }
 
 int
-sr_locking_set_unlock_close_fd(sr_locking_set_t* lock_ctx, int fd)
+sr_lock_table_get_stats(sr_lock_table_t *table, const char *name, sr_lock_stats_t *stats)
 {
-    CHECK_NULL_ARG(lock_ctx);
+    CHECK_NULL_ARG3(table, name, stats);
     int rc = SR_ERR_OK;
-    sr_lock_item_t lookup_item = {0,};
-    sr_lock_item_t *found_item = NULL;
-    lookup_item.fd = fd;
-
-    MUTEX_LOCK_TIMED_CHECK_RETURN(&lock_ctx->mutex);
+    sr_lock_entry_t lookup = {0,}, *entry = NULL;
 
-    found_item = sr_btree_search(lock_ctx->fd_index, &lookup_item);
-    if (NULL == found_item || -1 == found_item->fd) {
-        SR_LOG_ERR("File %s has not been locked in this context fd (%d)", NULL != found_item ? found_item->filename : "", fd);
-        rc = SR_ERR_INVAL_ARG;
-        goto cleanup;
-    }
-    sr_unlock_fd(found_item->fd);
-    SR_LOG_DBG("File %s (fd = %d) has been unlocked", found_item->filename, fd);
+    lookup.name = (char *) name;
 
-    rc = close(found_item->fd);
-    if (SR_ERR_OK != rc) {
-        SR_LOG_WRN("Close failed %s", sr_strerror_safe(errno));
+    MUTEX_LOCK_TIMED_CHECK_RETURN(&table->mutex);
+    entry = sr_omap_search(table->locks, &lookup);
+    if (NULL == entry) {
+        rc = SR_ERR_NOT_FOUND;
+    } else {
+        *stats = entry->stats;
     }
+    pthread_mutex_unlock(&table->mutex);
 
-    /* remove from index tree */
-    sr_btree_delete(lock_ctx->fd_index, found_item);
-    found_item->locked = false;
-    found_item->fd = -1;
-
-cleanup:
-    pthread_cond_broadcast(&lock_ctx->cond);
-    pthread_mutex_unlock(&lock_ctx->mutex);
     return rc;
 }
@@ -27,7 +27,8 @@
  * @ingroup common
  * @{
  *
- * @brief Data structures used in sysrepo (list, linked-list, self-balanced binary tree, circular buffer).
+ * @brief Data structures used in sysrepo (list, linked-list, self-balanced binary tree, circular buffer,
+ * file locking set, lock table).
  */
 
 /**
@@ -244,6 +245,125 @@ void *sr_btree_search(const sr_btree_t *tree, const void *item);
  */
 void *sr_btree_get_at(sr_btree_t *tree, size_t index);
 
+/**
+ * @brief Ordered map context: items kept sorted in a flat array, optionally indexed
+ * by a hash table for constant-time lookups.
+ *
+ * Compared to ::sr_btree_t, the ordered map stores no per-item nodes (only pointers to items in one
+ * contiguous array), iteration by index is O(1) and stateless (concurrent readers can iterate
+ * the same map) and the map can be built from an unsorted array of items at once.
+ * Insertion and deletion are O(n) (a memmove of item pointers), which is cheap for the sizes
+ * of the engine's maps (modules, sessions, subscriptions).
+ */
+typedef struct sr_omap_s sr_omap_t;
+
+/**
+ * @brief Callback to be called to compute hash of an item stored in the ordered map.
+ * Items equal according to the compare callback must have equal hashes.
+ */
+typedef uint32_t (*sr_omap_hash_item_cb)(const void *);
+
+/**
+ * @brief Allocates and initializes a new ordered map where items will be ordered
+ * by provided compare function and released by provided cleanup function.
+ *
+ * @param[in] compare_item_cb Callback function to compare two items.
+ * @param[in] hash_item_cb Callback function to compute hash of an item (optional). If provided,
+ * searches in the map use a hash index instead of binary search.
+ * @param[in] free_item_cb Callback function to release an item (optional).
+ * @param[out] map Ordered map context that can be used for subsequent map manipulation calls.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_omap_init(sr_btree_compare_item_cb compare_item_cb, sr_omap_hash_item_cb hash_item_cb,
+        sr_btree_free_item_cb free_item_cb, sr_omap_t **map);
+
+/**
+ * @brief Destroys and cleans up the ordered map, including all items stored within it
+ * (cleanup callback on each item stored within the map is automatically called).
+ *
+ * @param[in] map Ordered map context acquired with ::sr_omap_init.
+ */
+void sr_omap_cleanup(sr_omap_t *map);
+
+/**
+ * @brief Inserts a new item into the map.
+ *
+ * A matching item to the inserted one (according to the compare function) must
+ * not already exist in the map, otherwise SR_ERR_DATA_EXISTS error is returned.
+ *
+ * @note O(n), O(log n) comparisons.
+ *
+ * @param[in] map Ordered map context acquired with ::sr_omap_init.
+ * @param[in] item Item to be inserted.
+ *
+ * @return Error code (SR_ERR_OK on success, SR_ERR_DATA_EXISTS if the item already
+ * exists in the map, SR_ERR_NOMEM by memory allocation error).
+ */
+int sr_omap_insert(sr_omap_t *map, void *item);
+
+/**
+ * @brief Inserts all provided items into an empty map at once.
+ *
+ * @note O(n log n).
+ *
+ * @param[in] map Empty ordered map context acquired with ::sr_omap_init.
+ * @param[in] items Array of items in any order.
+ * @param[in] count Number of items.
+ *
+ * @return Error code (SR_ERR_OK on success, SR_ERR_DATA_EXISTS if the items contain
+ * duplicates - the map stays empty in that case, SR_ERR_INVAL_ARG if the map is not empty).
+ */
+int sr_omap_build(sr_omap_t *map, void **items, size_t count);
+
+/**
+ * @brief Deletes the item from the map, if matching item (according to
+ * the compare function) exists in the map. The stored item is released by the cleanup callback.
+ *
+ * @note O(n), O(log n) comparisons.
+ *
+ * @param[in] map Ordered map context acquired with ::sr_omap_init.
+ * @param[in] item Item to be deleted.
+ */
+void sr_omap_delete(sr_omap_t *map, void *item);
+
+/**
+ * @brief Search for an item in the map, matching with provided item according
+ * to the compare function.
+ *
+ * @note O(log n), O(1) with hash index.
+ *
+ * @param[in] map Ordered map context acquired with ::sr_omap_init.
+ * @param[in] item Item to be searched for.
+ *
+ * @return Matching item, NULL if the item has not been found.
+ */
+void *sr_omap_search(const sr_omap_t *map, const void *item);
+
+/**
+ * @brief Returns an item at given index position (in the order defined by the compare function).
+ * Can be used to iterate over all items in the map from any position; the map must not be
+ * modified during the iteration, except for deleting the item at the current index (the next
+ * item moves to that index).
+ *
+ * @note O(1).
+ *
+ * @param[in] map Ordered map context acquired with ::sr_omap_init.
+ * @param[in] index Index of an item.
+ *
+ * @return The item with given index, NULL if the item with given index does not exist.
+ */
+void *sr_omap_get_at(const sr_omap_t *map, size_t index);
+
+/**
+ * @brief Returns the number of items stored in the map.
+ *
+ * @param[in] map Ordered map context acquired with ::sr_omap_init.
+ *
+ * @return Number of items (0 for NULL map).
+ */
+size_t sr_omap_count(const sr_omap_t *map);
+
 /**
  * @brief FIFO circular buffer queue context.
  */
@@ -308,6 +428,154 @@ bool sr_cbuff_dequeue(sr_cbuff_t *buffer, void *item);
  */
 size_t sr_cbuff_items_in_queue(sr_cbuff_t *buffer);
 
+/**
+ * @brief Lock-free FIFO ring queue context.
+ */
+typedef struct sr_ring_s sr_ring_t;
+
+/**
+ * @brief Type of the ring queue, determines which threads can access it concurrently.
+ */
+typedef enum sr_ring_type_e {
+    SR_RING_MPMC,  /**< Multiple producers and multiple consumers. */
+    SR_RING_SPSC,  /**< Single producer and single consumer (they may be different threads). */
+} sr_ring_type_t;
+
+/**
+ * @brief Initializes lock-free FIFO ring queue of elements with given size.
+ *
+ * Enqueue and dequeue do not take any lock while the bounded ring has free space.
+ * If the ring is full, the elements spill into a mutex-protected overflow buffer
+ * until the ring has been drained, so that enqueue never fails because of a full queue
+ * and the FIFO order of elements enqueued by one producer is preserved.
+ *
+ * @param[in] capacity Capacity of the lock-free ring in number of elements (rounded up to a power of 2).
+ * @param[in] elem_size Size of one element (in bytes).
+ * @param[in] type Type of the ring queue.
+ * @param[out] ring Ring queue context.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_ring_init(size_t capacity, size_t elem_size, sr_ring_type_t type, sr_ring_t **ring);
+
+/**
+ * @brief Cleans up the ring queue. Must not be called while any thread accesses the queue.
+ *
+ * @param[in] ring Ring queue context.
+ */
+void sr_ring_cleanup(sr_ring_t *ring);
+
+/**
+ * @brief Enqueues an element into the ring queue. Does not wake up any waiting
+ * consumer, see ::sr_ring_wake.
+ *
+ * @note O(1), lock-free unless the ring is full.
+ *
+ * @param[in] ring Ring queue context.
+ * @param[in] item The element to be enqueued (pointer to memory from where
+ * the data will be copied to the queue).
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_ring_enqueue(sr_ring_t *ring, const void *item);
+
+/**
+ * @brief Dequeues an element from the ring queue.
+ *
+ * @note O(1), lock-free unless some elements spilled into the overflow buffer.
+ *
+ * @param[in] ring Ring queue context.
+ * @param[out] item Pointer to memory where dequeued data will be copied.
+ *
+ * @return TRUE if an element was dequeued, FALSE if the queue is empty.
+ */
+bool sr_ring_dequeue(sr_ring_t *ring, void *item);
+
+/**
+ * @brief Dequeues an element from the ring queue, blocks until an element is available.
+ * The thread sleeps (on a futex on Linux) until it is woken up by ::sr_ring_wake.
+ *
+ * @param[in] ring Ring queue context.
+ * @param[out] item Pointer to memory where dequeued data will be copied.
+ */
+void sr_ring_dequeue_wait(sr_ring_t *ring, void *item);
+
+/**
+ * @brief Wakes up consumers blocked in ::sr_ring_dequeue_wait. Cheap if there are none.
+ *
+ * @param[in] ring Ring queue context.
+ * @param[in] count Maximum number of consumers to be woken up.
+ */
+void sr_ring_wake(sr_ring_t *ring, size_t count);
+
+/**
+ * @brief Returns number of elements currently stored in the queue. The value is
+ * exact only if the queue is not being accessed concurrently.
+ *
+ * @note O(1).
+ *
+ * @param[in] ring Ring queue context.
+ *
+ * @return Number of elements currently stored in the queue.
+ */
+size_t sr_ring_count(sr_ring_t *ring);
+
+/**
+ * @brief Interns a string in the process-wide string table.
+ *
+ * The table stores each distinct string only once and counts the references to it.
+ * Interning a string that is already in the table just increments its reference count,
+ * therefore two interned strings are equal if and only if the pointers are equal.
+ * The table is thread-safe.
+ *
+ * @note O(1) on average.
+ *
+ * @param[in] str String to be interned.
+ * @param[out] interned Interned copy of the string, to be released by ::sr_str_release.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_str_intern(const char *str, const char **interned);
+
+/**
+ * @brief Interns first len characters of a string (see ::sr_str_intern).
+ * Does not allocate any memory if the string is already interned.
+ *
+ * @param[in] str String to be interned (does not need to be NULL-terminated).
+ * @param[in] len Length of the string.
+ * @param[out] interned Interned copy of the string, to be released by ::sr_str_release.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_str_intern_len(const char *str, size_t len, const char **interned);
+
+/**
+ * @brief Takes another reference of an interned string.
+ *
+ * @note O(1), lock-free.
+ *
+ * @param[in] interned Interned string (can be NULL).
+ *
+ * @return The interned string, to be released by ::sr_str_release.
+ */
+const char *sr_str_intern_ref(const char *interned);
+
+/**
+ * @brief Releases a reference of an interned string. The string is removed
+ * from the table when its last reference is released.
+ *
+ * @param[in] interned Interned string (can be NULL).
+ */
+void sr_str_release(const char *interned);
+
+/**
+ * @brief Returns number and total size of the strings in the string table.
+ *
+ * @param[out] count Number of distinct interned strings.
+ * @param[out] bytes Size of the interned strings, including the table overhead (in bytes).
+ */
+void sr_str_intern_stats(size_t *count, size_t *bytes);
+
 /**
  * @brief Locking set context.
  */
@@ -383,6 +651,107 @@ int sr_locking_set_unlock_close_file(sr_locking_set_t *lock_ctx, char *filename)
  */
 int sr_locking_set_unlock_close_fd(sr_locking_set_t *lock_ctx, int fd);
 
+/**
+ * @brief Lock table context.
+ *
+ * Lock table provides named locks owned by an opaque owner (e.g. a session). Within the process,
+ * the locks are granted in FIFO order to the waiting owners. Locks can additionally be shared with
+ * other processes: each lock is always held as an fcntl lock of one byte of a lock file (a read lock
+ * in intention exclusive mode, a write lock in exclusive mode), so that all processes exclude each
+ * other regardless of the mechanisms available to them, and, where robust mutexes are available,
+ * also in a lock region mapped from the same file. The region distinguishes
+ * lock tables within one process (fcntl locks do not) and the locks held by a terminated process
+ * are reclaimed from it. The fcntl locks of a byte are counted within the process, the byte is
+ * locked by its first holder and downgraded or unlocked only when its last holder releases it.
+ *
+ * Locks can be organized into a hierarchy: an owner locking a descendant (e.g. a module) exclusively
+ * first locks its ancestor (e.g. a datastore) in intention exclusive mode. Locking of the ancestor in
+ * exclusive mode then conflicts with the locks of all descendants held by other owners without
+ * visiting them.
+ */
+typedef struct sr_lock_table_s sr_lock_table_t;
+
+/**
+ * @brief Mode of a lock from the lock table.
+ */
+typedef enum sr_lock_mode_e {
+    SR_LOCK_INTENT_EXCL,      /**< Intention exclusive (IX) - some descendants are locked exclusively,
+                                   compatible with other intention exclusive locks. */
+    SR_LOCK_EXCL,             /**< Exclusive (X) - conflicts with any lock held by another owner. */
+} sr_lock_mode_t;
+
+/**
+ * @brief Statistics of a lock from the lock table.
+ */
+typedef struct sr_lock_stats_s {
+    uint64_t acquired;        /**< Number of successful acquisitions. */
+    uint64_t contended;       /**< Number of acquisitions that found the lock held by another owner. */
+    uint64_t timeouts;        /**< Number of acquisitions that failed because the lock was not released in time. */
+    uint64_t wait_time;       /**< Total time spent waiting for the lock (in microseconds). */
+} sr_lock_stats_t;
+
+/**
+ * @brief Allocates & initializes the lock table.
+ *
+ * @param [in] shm_file Path to the lock file backing the inter-process locks, NULL if the locks
+ * should not be shared with other processes. The file is created accessible to all users. If it can
+ * not be opened, locking fails rather than falling back to process-local locks.
+ * @param [out] table Lock table context, it is supposed to be freed by ::sr_lock_table_cleanup.
+ *
+ * @return Error code (SR_ERR_OK on success)
+ */
+int sr_lock_table_init(const char *shm_file, sr_lock_table_t **table);
+
+/**
+ * @brief Releases all locks of the process in the inter-process lock region and frees
+ * all resources allocated in the lock table context and the context itself.
+ *
+ * @param [in] table Lock table context.
+ */
+void sr_lock_table_cleanup(sr_lock_table_t *table);
+
+/**
+ * @brief Acquires the lock of the given name in given mode for the owner. Exclusive locking of a lock
+ * that is already held exclusively by the same owner succeeds without any effect, intention exclusive
+ * locks are counted (each must be released).
+ *
+ * @param [in] table Lock table context.
+ * @param [in] name Name of the lock.
+ * @param [in] owner Owner of the lock.
+ * @param [in] mode Mode of the lock.
+ * @param [in] timeout Maximum time to wait for the lock (in milliseconds), 0 does not wait,
+ * -1 waits infinitely.
+ *
+ * @return Error code (SR_ERR_OK on success), SR_ERR_LOCKED if the lock is held by another owner,
+ * SR_ERR_UNATHORIZED if the lock is to be shared, but the lock file is not accessible.
+ */
+int sr_lock_table_lock(sr_lock_table_t *table, const char *name, const void *owner, sr_lock_mode_t mode, int timeout);
+
+/**
+ * @brief Releases the lock of the given name held by the owner in given mode. If there are owners
+ * waiting for the lock, it is handed over to them in the order of their requests.
+ *
+ * @param [in] table Lock table context.
+ * @param [in] name Name of the lock.
+ * @param [in] owner Owner of the lock.
+ * @param [in] mode Mode of the lock.
+ *
+ * @return Error code (SR_ERR_OK on success),
+ * SR_ERR_INVAL_ARG if the lock is not held by the owner in given mode.
+ */
+int sr_lock_table_unlock(sr_lock_table_t *table, const char *name, const void *owner, sr_lock_mode_t mode);
+
+/**
+ * @brief Returns contention statistics of the lock of the given name.
+ *
+ * @param [in] table Lock table context.
+ * @param [in] name Name of the lock.
+ * @param [out] stats Statistics of the lock.
+ *
+ * @return Error code (SR_ERR_OK on success), SR_ERR_NOT_FOUND if the lock has never been used.
+ */
+int sr_lock_table_get_stats(sr_lock_table_t *table, const char *name, sr_lock_stats_t *stats);
+
 /**@} data_structs */
 
 #endif /* SR_DATA_STRUCTS_H_ */
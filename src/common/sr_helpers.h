@@ -328,14 +328,14 @@
         int ret = 0;                         \
         sr_clock_get_time(CLOCK_REALTIME, &ts);  \
         ts.tv_sec += MUTEX_WAIT_TIME;        \
-        ret = pthread_mutex_timedlock(MUTEX, &ts); \
+        ret = sr_mutex_timedlock(MUTEX, &ts); \
         if (0 != ret) {                            \
             SR_LOG_ERR("Mutex can not be locked %s", sr_strerror_safe(ret));\
             return SR_ERR_TIME_OUT;          \
         }                                    \
     } while(0)
 #else
-    #define MUTEX_LOCK_TIMED_CHECK_RETURN(MUTEX) pthread_mutex_lock(MUTEX)
+    #define MUTEX_LOCK_TIMED_CHECK_RETURN(MUTEX) sr_mutex_lock(MUTEX)
 #endif
 
 #if defined(HAVE_TIMED_LOCK)
@@ -345,7 +345,7 @@
         int ret = 0;                         \
         sr_clock_get_time(CLOCK_REALTIME, &ts);  \
         ts.tv_sec += MUTEX_WAIT_TIME;        \
-        ret = pthread_mutex_timedlock(MUTEX, &ts); \
+        ret = sr_mutex_timedlock(MUTEX, &ts); \
         if (0 != ret) {                            \
             SR_LOG_ERR("Mutex can not be locked %s", sr_strerror_safe(ret));\
             rc = SR_ERR_TIME_OUT;            \
@@ -353,7 +353,7 @@
         }                                    \
     } while(0)
 #else
-    #define MUTEX_LOCK_TIMED_CHECK_GOTO(MUTEX, RC, LABEL) pthread_mutex_lock(MUTEX)
+    #define MUTEX_LOCK_TIMED_CHECK_GOTO(MUTEX, RC, LABEL) sr_mutex_lock(MUTEX)
 #endif
 
 #if defined(HAVE_TIMED_LOCK)
@@ -363,14 +363,14 @@
         int ret = 0;                         \
         sr_clock_get_time(CLOCK_REALTIME, &ts);  \
         ts.tv_sec += MUTEX_WAIT_TIME;        \
-        ret = pthread_rwlock_timedwrlock(RWLOCK, &ts); \
+        ret = sr_rwlock_timedwrlock(RWLOCK, &ts); \
         if (0 != ret) {                            \
             SR_LOG_ERR("rwlock can not be locked %s", sr_strerror_safe(ret));   \
             return SR_ERR_TIME_OUT;          \
         }                                    \
     } while(0)
 #else
-    #define RWLOCK_WRLOCK_TIMED_CHECK_RETURN(RWLOCK) pthread_rwlock_wrlock(RWLOCK)
+    #define RWLOCK_WRLOCK_TIMED_CHECK_RETURN(RWLOCK) sr_rwlock_wrlock(RWLOCK)
 #endif
 
 #if defined(HAVE_TIMED_LOCK)
@@ -380,14 +380,14 @@
         int ret = 0;                         \
         sr_clock_get_time(CLOCK_REALTIME, &ts);  \
         ts.tv_sec += MUTEX_WAIT_TIME;        \
-        ret = pthread_rwlock_timedrdlock(RWLOCK, &ts); \
+        ret = sr_rwlock_timedrdlock(RWLOCK, &ts); \
         if (0 != ret) {                            \
             SR_LOG_ERR("rwlock can not be locked %s", sr_strerror_safe(ret));   \
             return SR_ERR_TIME_OUT;          \
         }                                    \
     } while(0)
 #else
-    #define RWLOCK_RDLOCK_TIMED_CHECK_RETURN(RWLOCK) pthread_rwlock_rdlock(RWLOCK)
+    #define RWLOCK_RDLOCK_TIMED_CHECK_RETURN(RWLOCK) sr_rwlock_rdlock(RWLOCK)
 #endif
 
 #if defined(HAVE_TIMED_LOCK)
@@ -397,7 +397,7 @@
         int ret = 0;                         \
         sr_clock_get_time(CLOCK_REALTIME, &ts);  \
         ts.tv_sec += MUTEX_WAIT_TIME;        \
-        ret = pthread_rwlock_timedwrlock(RWLOCK, &ts); \
+        ret = sr_rwlock_timedwrlock(RWLOCK, &ts); \
         if (0 != ret) {                            \
             SR_LOG_ERR("rwlock can not be locked %s", sr_strerror_safe(ret));   \
             rc = SR_ERR_TIME_OUT;            \
@@ -405,7 +405,7 @@
         }                                    \
     } while(0)
 #else
-    #define RWLOCK_WRLOCK_TIMED_CHECK_GOTO(RWLOCK, RC, LABEL) pthread_rwlock_wrlock(RWLOCK)
+    #define RWLOCK_WRLOCK_TIMED_CHECK_GOTO(RWLOCK, RC, LABEL) sr_rwlock_wrlock(RWLOCK)
 #endif
 
 #if defined(HAVE_TIMED_LOCK)
@@ -415,7 +415,7 @@
         int ret = 0;                         \
         sr_clock_get_time(CLOCK_REALTIME, &ts);  \
         ts.tv_sec += MUTEX_WAIT_TIME;        \
-        ret = pthread_rwlock_timedrdlock(RWLOCK, &ts); \
+        ret = sr_rwlock_timedrdlock(RWLOCK, &ts); \
         if (0 != ret) {                            \
             SR_LOG_ERR("rwlock can not be locked %s", sr_strerror_safe(ret));   \
             rc = SR_ERR_TIME_OUT;            \
@@ -423,7 +423,18 @@
         }                                    \
     } while(0)
 #else
-    #define RWLOCK_RDLOCK_TIMED_CHECK_GOTO(RWLOCK, RC, LABEL) pthread_rwlock_rdlock(RWLOCK)
+    #define RWLOCK_RDLOCK_TIMED_CHECK_GOTO(RWLOCK, RC, LABEL) sr_rwlock_rdlock(RWLOCK)
+#endif
+
+/**
+ * @brief USDT probe in the "sysrepo" provider, compiled in only if sysrepo is built with ENABLE_USDT.
+ * Arguments have to be integers or pointers (up to 12).
+ */
+#ifdef ENABLE_USDT
+    #include <sys/sdt.h>
+    #define SR_PROBE(NAME, ...) STAP_PROBEV(sysrepo, NAME, __VA_ARGS__)
+#else
+    #define SR_PROBE(NAME, ...)
 #endif
 
 #endif /* SR_HELPERS_H_ */
@@ -0,0 +1,415 @@
+/**
+ * @file sr_lockstat.c
+ * @brief Sysrepo lock instrumentation implementation.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "sr_common.h"
+#include "sr_lockstat.h"
+
+#ifdef ENABLE_LOCK_STATS
+
+#define SR_LOCKSTAT_MAX_CLASSES 32  /**< Maximum number of distinct lock names. */
+#define SR_LOCKSTAT_MAX_HELD 16     /**< Maximum number of registered locks held by one thread at once. */
+
+/**
+ * @brief Registered lock.
+ */
+typedef struct sr_lockstat_lock_s {
+    const void *lock;    /**< Address of the mutex / rwlock. */
+    size_t class_idx;    /**< Index of the statistics of the lock. */
+} sr_lockstat_lock_t;
+
+/**
+ * @brief Lock held by the current thread.
+ */
+typedef struct sr_lockstat_held_s {
+    const void *lock;         /**< Address of the mutex / rwlock. */
+    size_t class_idx;         /**< Index of the statistics of the lock. */
+    struct timespec since;    /**< Time of the acquisition. */
+} sr_lockstat_held_t;
+
+static pthread_mutex_t sr_lockstat_mutex = PTHREAD_MUTEX_INITIALIZER;  /**< Protects all statistics and the registry. */
+static sr_btree_t *sr_lockstat_registry = NULL;                        /**< Registered locks (sr_lockstat_lock_t). */
+static sr_lockstat_t sr_lockstat_classes[SR_LOCKSTAT_MAX_CLASSES];     /**< Statistics per lock name. */
+static size_t sr_lockstat_class_cnt = 0;                               /**< Number of the lock names. */
+
+static __thread sr_lockstat_held_t sr_lockstat_held[SR_LOCKSTAT_MAX_HELD];  /**< Registered locks held by the thread. */
+static __thread size_t sr_lockstat_held_cnt = 0;                             /**< Number of the held locks. */
+
+/**
+ * @brief Compares two registered locks by their address.
+ */
+static int
+sr_lockstat_lock_cmp(const void *a, const void *b)
+{
+    const sr_lockstat_lock_t *lock_a = a, *lock_b = b;
+
+    if (lock_a->lock == lock_b->lock) {
+        return 0;
+    }
+    return (uintptr_t)lock_a->lock < (uintptr_t)lock_b->lock ? -1 : 1;
+}
+
+/**
+ * @brief Returns microseconds elapsed since provided time.
+ */
+static uint64_t
+sr_lockstat_elapsed(const struct timespec *since, struct timespec *now)
+{
+    sr_clock_get_time(CLOCK_MONOTONIC, now);
+    if ((now->tv_sec < since->tv_sec) || (now->tv_sec == since->tv_sec && now->tv_nsec < since->tv_nsec)) {
+        return 0;
+    }
+    return (uint64_t)(now->tv_sec - since->tv_sec) * 1000000 + (now->tv_nsec - since->tv_nsec) / 1000;
+}
+
+/**
+ * @brief Returns index of the statistics of a lock, SR_LOCKSTAT_MAX_CLASSES if the lock is not registered.
+ * Expects sr_lockstat_mutex to be held.
+ */
+static size_t
+sr_lockstat_find_class(const void *lock)
+{
+    sr_lockstat_lock_t lookup = { .lock = lock }, *found = NULL;
+
+    if (NULL == sr_lockstat_registry) {
+        return SR_LOCKSTAT_MAX_CLASSES;
+    }
+    found = sr_btree_search(sr_lockstat_registry, &lookup);
+    return NULL != found ? found->class_idx : SR_LOCKSTAT_MAX_CLASSES;
+}
+
+void
+sr_lockstat_register(const void *lock, const char *name)
+{
+    sr_lockstat_lock_t *entry = NULL;
+    size_t idx = 0;
+    int rc = SR_ERR_OK;
+
+    if (NULL == lock || NULL == name) {
+        return;
+    }
+
+    pthread_mutex_lock(&sr_lockstat_mutex);
+
+    if (NULL == sr_lockstat_registry) {
+        rc = sr_btree_init(sr_lockstat_lock_cmp, free, &sr_lockstat_registry);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to initialize lock statistics registry.");
+    }
+
+    for (idx = 0; idx < sr_lockstat_class_cnt; ++idx) {
+        if (0 == strcmp(sr_lockstat_classes[idx].name, name)) {
+            break;
+        }
+    }
+    if (idx == sr_lockstat_class_cnt) {
+        if (SR_LOCKSTAT_MAX_CLASSES == sr_lockstat_class_cnt) {
+            SR_LOG_WRN("Too many named locks, lock '%s' will not be measured.", name);
+            goto cleanup;
+        }
+        memset(&sr_lockstat_classes[idx], 0, sizeof sr_lockstat_classes[idx]);
+        sr_lockstat_classes[idx].name = name;
+        ++sr_lockstat_class_cnt;
+    }
+
+    entry = calloc(1, sizeof *entry);
+    CHECK_NULL_NOMEM_GOTO(entry, rc, cleanup);
+    entry->lock = lock;
+    entry->class_idx = idx;
+
+    sr_btree_delete(sr_lockstat_registry, entry);
+    rc = sr_btree_insert(sr_lockstat_registry, entry);
+    if (SR_ERR_OK != rc) {
+        free(entry);
+    }
+
+cleanup:
+    pthread_mutex_unlock(&sr_lockstat_mutex);
+}
+
+void
+sr_lockstat_unregister(const void *lock)
+{
+    sr_lockstat_lock_t lookup = { .lock = lock };
+
+    pthread_mutex_lock(&sr_lockstat_mutex);
+    if (NULL != sr_lockstat_registry) {
+        sr_btree_delete(sr_lockstat_registry, &lookup);
+    }
+    pthread_mutex_unlock(&sr_lockstat_mutex);
+}
+
+/**
+ * @brief Looks up a lock before it is acquired and records the start of the wait.
+ *
+ * @return Index of the statistics, SR_LOCKSTAT_MAX_CLASSES if the lock is not measured.
+ */
+static size_t
+sr_lockstat_wait_start(const void *lock, struct timespec *start)
+{
+    size_t idx = 0;
+
+    pthread_mutex_lock(&sr_lockstat_mutex);
+    idx = sr_lockstat_find_class(lock);
+    pthread_mutex_unlock(&sr_lockstat_mutex);
+
+    if (SR_LOCKSTAT_MAX_CLASSES != idx) {
+        sr_clock_get_time(CLOCK_MONOTONIC, start);
+    }
+    return idx;
+}
+
+/**
+ * @brief Records an acquisition of a measured lock.
+ *
+ * @param [in] lock Acquired lock.
+ * @param [in] idx Index of the statistics of the lock.
+ * @param [in] start Start of the wait.
+ * @param [in] count_acquisition FALSE if the lock is re-acquired by a condition wait.
+ */
+static void
+sr_lockstat_acquired(const void *lock, size_t idx, const struct timespec *start, bool count_acquisition)
+{
+    struct timespec now = { 0, };
+    uint64_t wait = 0;
+    size_t bucket = 0;
+
+    wait = sr_lockstat_elapsed(start, &now);
+    while (wait >> bucket && bucket < SR_LOCKSTAT_HIST_SIZE - 1) {
+        ++bucket;
+    }
+
+    pthread_mutex_lock(&sr_lockstat_mutex);
+    if (count_acquisition) {
+        sr_lockstat_classes[idx].acquisitions += 1;
+    }
+    sr_lockstat_classes[idx].wait_total += wait;
+    if (wait > sr_lockstat_classes[idx].wait_max) {
+        sr_lockstat_classes[idx].wait_max = wait;
+    }
+    sr_lockstat_classes[idx].wait_hist[bucket] += 1;
+    pthread_mutex_unlock(&sr_lockstat_mutex);
+
+    if (sr_lockstat_held_cnt < SR_LOCKSTAT_MAX_HELD) {
+        sr_lockstat_held[sr_lockstat_held_cnt].lock = lock;
+        sr_lockstat_held[sr_lockstat_held_cnt].class_idx = idx;
+        sr_lockstat_held[sr_lockstat_held_cnt].since = now;
+        ++sr_lockstat_held_cnt;
+    }
+}
+
+/**
+ * @brief Records a release of a lock (no-op if the lock is not measured).
+ */
+static void
+sr_lockstat_released(const void *lock)
+{
+    struct timespec now = { 0, };
+    sr_lockstat_held_t held = { 0, };
+    uint64_t hold = 0;
+    size_t i = sr_lockstat_held_cnt;
+
+    while (i > 0 && sr_lockstat_held[i - 1].lock != lock) {
+        --i;
+    }
+    if (0 == i) {
+        return;
+    }
+    held = sr_lockstat_held[i - 1];
+    memmove(&sr_lockstat_held[i - 1], &sr_lockstat_held[i], (sr_lockstat_held_cnt - i) * sizeof *sr_lockstat_held);
+    --sr_lockstat_held_cnt;
+
+    hold = sr_lockstat_elapsed(&held.since, &now);
+
+    pthread_mutex_lock(&sr_lockstat_mutex);
+    sr_lockstat_classes[held.class_idx].hold_total += hold;
+    if (hold > sr_lockstat_classes[held.class_idx].hold_max) {
+        sr_lockstat_classes[held.class_idx].hold_max = hold;
+    }
+    pthread_mutex_unlock(&sr_lockstat_mutex);
+}
+
+/**
+ * @brief Wraps an acquisition of a lock by the measurement.
+ */
+#define SR_LOCKSTAT_ACQUIRE(LOCK, CALL, COUNT) \
+    do { \
+        struct timespec start = { 0, }; \
+        size_t idx = sr_lockstat_wait_start(LOCK, &start); \
+        int ret = CALL; \
+        if (0 == ret && SR_LOCKSTAT_MAX_CLASSES != idx) { \
+            sr_lockstat_acquired(LOCK, idx, &start, COUNT); \
+        } \
+        return ret; \
+    } while(0)
+
+int
+sr_mutex_lock(pthread_mutex_t *mutex)
+{
+    SR_LOCKSTAT_ACQUIRE(mutex, pthread_mutex_lock(mutex), true);
+}
+
+int
+sr_mutex_timedlock(pthread_mutex_t *mutex, const struct timespec *abstime)
+{
+    SR_LOCKSTAT_ACQUIRE(mutex, pthread_mutex_timedlock(mutex, abstime), true);
+}
+
+int
+sr_mutex_unlock(pthread_mutex_t *mutex)
+{
+    sr_lockstat_released(mutex);
+    return pthread_mutex_unlock(mutex);
+}
+
+int
+sr_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+{
+    /* the mutex is not held while waiting for the condition */
+    sr_lockstat_released(mutex);
+    SR_LOCKSTAT_ACQUIRE(mutex, pthread_cond_wait(cond, mutex), false);
+}
+
+int
+sr_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime)
+{
+    sr_lockstat_released(mutex);
+    {
+        struct timespec start = { 0, };
+        size_t idx = sr_lockstat_wait_start(mutex, &start);
+        int ret = pthread_cond_timedwait(cond, mutex, abstime);
+        /* the mutex is re-acquired also on timeout */
+        if ((0 == ret || ETIMEDOUT == ret) && SR_LOCKSTAT_MAX_CLASSES != idx) {
+            sr_lockstat_acquired(mutex, idx, &start, false);
+        }
+        return ret;
+    }
+}
+
+int
+sr_rwlock_rdlock(pthread_rwlock_t *rwlock)
+{
+    SR_LOCKSTAT_ACQUIRE(rwlock, pthread_rwlock_rdlock(rwlock), true);
+}
+
+int
+sr_rwlock_wrlock(pthread_rwlock_t *rwlock)
+{
+    SR_LOCKSTAT_ACQUIRE(rwlock, pthread_rwlock_wrlock(rwlock), true);
+}
+
+int
+sr_rwlock_timedrdlock(pthread_rwlock_t *rwlock, const struct timespec *abstime)
+{
+    SR_LOCKSTAT_ACQUIRE(rwlock, pthread_rwlock_timedrdlock(rwlock, abstime), true);
+}
+
+int
+sr_rwlock_timedwrlock(pthread_rwlock_t *rwlock, const struct timespec *abstime)
+{
+    SR_LOCKSTAT_ACQUIRE(rwlock, pthread_rwlock_timedwrlock(rwlock, abstime), true);
+}
+
+int
+sr_rwlock_unlock(pthread_rwlock_t *rwlock)
+{
+    sr_lockstat_released(rwlock);
+    return pthread_rwlock_unlock(rwlock);
+}
+
+int
+sr_lockstat_get(sr_lockstat_t **stats_p, size_t *count_p)
+{
+    sr_lockstat_t *stats = NULL;
+    size_t count = 0;
+
+    CHECK_NULL_ARG2(stats_p, count_p);
+
+    pthread_mutex_lock(&sr_lockstat_mutex);
+    count = sr_lockstat_class_cnt;
+    if (count > 0) {
+        stats = calloc(count, sizeof *stats);
+        if (NULL != stats) {
+            memcpy(stats, sr_lockstat_classes, count * sizeof *stats);
+        }
+    }
+    pthread_mutex_unlock(&sr_lockstat_mutex);
+
+    if (count > 0 && NULL == stats) {
+        SR_LOG_ERR_MSG("Unable to allocate memory for lock statistics.");
+        return SR_ERR_NOMEM;
+    }
+
+    *stats_p = stats;
+    *count_p = count;
+    return SR_ERR_OK;
+}
+
+void
+sr_lockstat_dump(void)
+{
+    sr_lockstat_t *stats = NULL;
+    size_t count = 0;
+    char hist[SR_LOCKSTAT_HIST_SIZE * 21] = { 0, };
+    size_t len = 0;
+    int rc = SR_ERR_OK;
+
+    rc = sr_lockstat_get(&stats, &count);
+    if (SR_ERR_OK != rc) {
+        return;
+    }
+
+    SR_LOG_INF("Lock statistics of %zu named locks (times in microseconds):", count);
+    for (size_t i = 0; i < count; ++i) {
+        len = 0;
+        hist[0] = '\0';
+        for (size_t b = 0; b < SR_LOCKSTAT_HIST_SIZE; ++b) {
+            len += snprintf(hist + len, sizeof hist - len, "%s%" PRIu64, 0 == b ? "" : " ", stats[i].wait_hist[b]);
+        }
+        SR_LOG_INF("  %s: acquired %" PRIu64 ", wait total %" PRIu64 " max %" PRIu64 ", hold total %" PRIu64
+                " max %" PRIu64 ", wait histogram (log2 us) [%s]", stats[i].name, stats[i].acquisitions,
+                stats[i].wait_total, stats[i].wait_max, stats[i].hold_total, stats[i].hold_max, hist);
+    }
+    free(stats);
+}
+
+#else
+
+int
+sr_lockstat_get(sr_lockstat_t **stats, size_t *count)
+{
+    CHECK_NULL_ARG2(stats, count);
+
+    *stats = NULL;
+    *count = 0;
+    return SR_ERR_OK;
+}
+
+void
+sr_lockstat_dump(void)
+{
+    SR_LOG_INF_MSG("Lock statistics are not available, sysrepo has been built without ENABLE_LOCK_STATS.");
+}
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * @file sr_lockstat.h
+ * @brief Sysrepo lock instrumentation API.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SR_LOCKSTAT_H_
+#define SR_LOCKSTAT_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+/**
+ * @defgroup lockstat Lock Instrumentation
+ * @ingroup common
+ * @{
+ *
+ * @brief Collects acquisition counts, wait time histograms and hold times of the named
+ * engine locks.
+ *
+ * The engine locks mutexes and rwlocks through the sr_mutex_* / sr_rwlock_* wrappers. Unless
+ * sysrepo is built with ENABLE_LOCK_STATS, the wrappers are plain aliases of the pthread functions.
+ * In instrumented builds, the wrappers measure the locks registered by ::sr_lockstat_register.
+ * The statistics are aggregated by the name of the lock, e.g. all per-module model locks are
+ * accounted together. Other locks pass through the wrappers unmeasured.
+ */
+
+/**
+ * @brief Number of buckets of the wait time histogram. Bucket 0 counts waits shorter than 1 microsecond,
+ * bucket i counts waits in [2^(i-1), 2^i) microseconds, the last bucket counts all longer waits.
+ */
+#define SR_LOCKSTAT_HIST_SIZE 20
+
+/**
+ * @brief Statistics of a named lock.
+ */
+typedef struct sr_lockstat_s {
+    const char *name;                             /**< Name of the lock. */
+    uint64_t acquisitions;                        /**< Number of acquisitions. */
+    uint64_t wait_total;                          /**< Total time spent waiting for the lock (in microseconds). */
+    uint64_t wait_max;                            /**< Maximum time spent waiting for the lock (in microseconds). */
+    uint64_t wait_hist[SR_LOCKSTAT_HIST_SIZE];    /**< Histogram of the wait times. */
+    uint64_t hold_total;                          /**< Total time the lock was held (in microseconds). */
+    uint64_t hold_max;                            /**< Maximum time the lock was held (in microseconds). */
+} sr_lockstat_t;
+
+#ifdef ENABLE_LOCK_STATS
+
+/**
+ * @brief Registers a lock to be measured under provided name.
+ *
+ * @param [in] lock Mutex or rwlock.
+ * @param [in] name Name of the lock, must be a static string.
+ */
+void sr_lockstat_register(const void *lock, const char *name);
+
+/**
+ * @brief Unregisters a lock, must be called before the lock is destroyed.
+ *
+ * @param [in] lock Mutex or rwlock.
+ */
+void sr_lockstat_unregister(const void *lock);
+
+int sr_mutex_lock(pthread_mutex_t *mutex);
+int sr_mutex_timedlock(pthread_mutex_t *mutex, const struct timespec *abstime);
+int sr_mutex_unlock(pthread_mutex_t *mutex);
+int sr_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+int sr_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime);
+int sr_rwlock_rdlock(pthread_rwlock_t *rwlock);
+int sr_rwlock_wrlock(pthread_rwlock_t *rwlock);
+int sr_rwlock_timedrdlock(pthread_rwlock_t *rwlock, const struct timespec *abstime);
+int sr_rwlock_timedwrlock(pthread_rwlock_t *rwlock, const struct timespec *abstime);
+int sr_rwlock_unlock(pthread_rwlock_t *rwlock);
+
+#else
+
+#define sr_lockstat_register(LOCK, NAME)
+#define sr_lockstat_unregister(LOCK)
+
+#define sr_mutex_lock pthread_mutex_lock
+#define sr_mutex_timedlock pthread_mutex_timedlock
+#define sr_mutex_unlock pthread_mutex_unlock
+#define sr_cond_wait pthread_cond_wait
+#define sr_cond_timedwait pthread_cond_timedwait
+#define sr_rwlock_rdlock pthread_rwlock_rdlock
+#define sr_rwlock_wrlock pthread_rwlock_wrlock
+#define sr_rwlock_timedrdlock pthread_rwlock_timedrdlock
+#define sr_rwlock_timedwrlock pthread_rwlock_timedwrlock
+#define sr_rwlock_unlock pthread_rwlock_unlock
+
+#endif
+
+/**
+ * @brief Returns a snapshot of the statistics of all named locks.
+ *
+ * @param [out] stats Array of lock statistics, to be freed by the caller (NULL if there are none).
+ * @param [out] count Number of the named locks (0 unless built with ENABLE_LOCK_STATS).
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_lockstat_get(sr_lockstat_t **stats, size_t *count);
+
+/**
+ * @brief Prints the statistics of all named locks into the log (informational level).
+ */
+void sr_lockstat_dump(void);
+
+/**@} lockstat */
+
+#endif /* SR_LOCKSTAT_H_ */
@@ -28,17 +28,22 @@
 #include <syslog.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <inttypes.h>
 
 #include "sr_common.h"
 #include "sr_logger.h"
 
 #define SR_LOG_MSG_SIZE 2048  /**< Maximum size of one log entry. */
 
+#define SR_LOG_RING_SIZE 128          /**< Number of entries in the ring of one thread used by the asynchronous logging (power of 2). */
+#define SR_LOG_WRITER_INTERVAL 100    /**< Interval (in milliseconds) in which the idle writer thread checks the rings. */
+
 #define SR_DEFAULT_LOG_IDENTIFIER "sysrepo"  /**< Default identifier used in syslog messages. */
 #define SR_DAEMON_LOG_IDENTIFIER "sysrepod"  /**< Sysrepo deamon identifier used in syslog messages. */
 
 volatile uint8_t sr_ll_stderr = SR_LL_NONE;  /**< Global variable used to store log level of stderr messages. */
 volatile uint8_t sr_ll_syslog = SR_LL_NONE;  /**< Global variable used to store log level of syslog messages. */
+volatile uint8_t sr_ll_max = SR_LL_NONE;     /**< Global variable used to store the most verbose level of all outputs. */
 volatile sr_log_cb sr_log_callback = NULL;   /**< Global variable used to store logging callback, if set. */
 
 static pthread_once_t sr_strerror_buf_create_key_once = PTHREAD_ONCE_INIT;  /** Used to control that ::sr_strerror_buff_create_key is called only once per thread. */
@@ -50,6 +55,39 @@ static volatile char *sr_syslog_identifier = NULL;  /**< Global variable used to
 static pthread_once_t sr_log_buff_create_key_once = PTHREAD_ONCE_INIT;  /** Used to control that ::sr_log_buff_create_key is called only once per thread. */
 static pthread_key_t sr_log_buff_key;  /**< Key for thread-specific buffer data. */
 
+/**
+ * @brief Log entry passed to the writer thread.
+ */
+typedef struct sr_log_entry_s {
+    uint8_t level;                     /**< Log level. */
+    char msg[SR_LOG_MSG_SIZE];         /**< Formatted message. */
+} sr_log_entry_t;
+
+/**
+ * @brief Single-producer single-consumer ring of log entries owned by one thread.
+ */
+typedef struct sr_log_ring_s {
+    uint32_t tail;                     /**< Index of the next entry to be filled (written only by the owning thread). */
+    uint32_t dropped;                  /**< Number of entries dropped because the ring was full. */
+    sr_log_entry_t entries[SR_LOG_RING_SIZE];  /**< Entries of the ring. */
+    uint32_t head;                     /**< Index of the next entry to be written out (written only by the writer). */
+    bool orphaned;                     /**< TRUE if the owning thread has exited (set atomically). */
+    struct sr_log_ring_s *next;        /**< Next ring in the list of all rings. */
+} sr_log_ring_t;
+
+static volatile bool sr_log_async = false;        /**< TRUE if messages to stderr / syslog are written by the writer thread. */
+static volatile bool sr_log_writer_idle = false;  /**< TRUE if the writer thread is waiting for new messages. */
+static bool sr_log_writer_running = false;        /**< TRUE if the writer thread has been started (protected by sr_log_rings_lock). */
+static bool sr_log_writer_stop = false;           /**< Set to stop the writer thread (protected by sr_log_rings_lock). */
+static pthread_t sr_log_writer;                   /**< Writer thread. */
+static sr_log_ring_t *sr_log_rings = NULL;        /**< List of the rings of all threads (protected by sr_log_rings_lock). */
+static pthread_mutex_t sr_log_rings_lock = PTHREAD_MUTEX_INITIALIZER;  /**< Lock for the list of rings and the writer state. */
+static pthread_cond_t sr_log_writer_cv = PTHREAD_COND_INITIALIZER;     /**< Condition used to wake up the idle writer thread. */
+static __thread sr_log_ring_t *sr_log_thread_ring = NULL;             /**< Ring of the current thread. */
+
+static pthread_once_t sr_log_ring_create_key_once = PTHREAD_ONCE_INIT;  /** Used to control that ::sr_log_ring_create_key is called only once. */
+static pthread_key_t sr_log_ring_key;  /**< Key used to release the ring of an exiting thread. */
+
 /**
  * @brief Create key for thread-specific buffer data. Should be called only once per thread.
  */
@@ -72,6 +110,253 @@ sr_strerror_buff_create_key(void)
     pthread_setspecific(sr_strerror_buf_key, NULL);
 }
 
+/**
+ * @brief Recomputes the most verbose level accepted by any of the log outputs.
+ */
+static void
+sr_log_update_max_level()
+{
+    uint8_t ll = (sr_ll_stderr > sr_ll_syslog) ? sr_ll_stderr : sr_ll_syslog;
+
+    if (NULL != sr_log_callback) {
+        /* the callback is called for each message with any log level */
+        ll = SR_LL_DBG;
+    }
+    sr_ll_max = ll;
+}
+
+/**
+ * @brief Writes a formatted message into stderr and syslog, according to their log levels.
+ */
+static void
+sr_log_write(sr_log_level_t level, const char *msg)
+{
+    if (sr_ll_stderr >= level) {
+        fprintf(stderr, "[%s] %s\n", SR_LOG__LL_STR(level), msg);
+    }
+    if (sr_ll_syslog >= level) {
+        syslog(SR_LOG__LL_FACILITY(level), "[%s] %s", SR_LOG__LL_STR(level), msg);
+    }
+}
+
+/**
+ * @brief Writes out all entries of a ring. Called by the writer thread, or by a thread
+ * that has unlinked the ring from the list of rings while the writer thread is not running.
+ *
+ * @return Number of written entries.
+ */
+static size_t
+sr_log_ring_drain(sr_log_ring_t *ring)
+{
+    sr_log_entry_t *entry = NULL;
+    uint32_t head = ring->head, tail = 0, dropped = 0;
+    size_t cnt = 0;
+
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        entry = &ring->entries[head & (SR_LOG_RING_SIZE - 1)];
+        sr_log_write(entry->level, entry->msg);
+        ++head;
+        ++cnt;
+        if (head == tail) {
+            /* release the entries and check for new ones */
+            __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+            tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+        char msg[64] = { 0, };
+        snprintf(msg, sizeof(msg), "%" PRIu32 " log messages dropped, the log ring was full.", dropped);
+        sr_log_write(SR_LL_WRN, msg);
+        ++cnt;
+    }
+
+    return cnt;
+}
+
+/**
+ * @brief Writes out the entries of all rings and releases the rings of the exited threads.
+ * Called by the writer thread, or by ::sr_logger_set_async before the writer is marked
+ * as not running. The list is moved out under sr_log_rings_lock and written without
+ * holding it, so that threads registering or releasing their rings are never blocked by I/O.
+ *
+ * @return Number of written entries.
+ */
+static size_t
+sr_log_rings_drain()
+{
+    sr_log_ring_t *rings = NULL, **ring_p = &rings, *ring = NULL;
+    bool orphaned = false;
+    size_t cnt = 0;
+
+    pthread_mutex_lock(&sr_log_rings_lock);
+    rings = sr_log_rings;
+    sr_log_rings = NULL;
+    pthread_mutex_unlock(&sr_log_rings_lock);
+
+    while (NULL != *ring_p) {
+        ring = *ring_p;
+        /* the owning thread does not touch the ring once it is orphaned */
+        orphaned = __atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE);
+        cnt += sr_log_ring_drain(ring);
+        if (orphaned) {
+            *ring_p = ring->next;
+            free(ring);
+        } else {
+            ring_p = &ring->next;
+        }
+    }
+    if (cnt > 0) {
+        fflush(stderr);
+    }
+
+    /* put the rings back, behind the rings registered in the meantime */
+    pthread_mutex_lock(&sr_log_rings_lock);
+    *ring_p = sr_log_rings;
+    sr_log_rings = rings;
+    pthread_mutex_unlock(&sr_log_rings_lock);
+
+    return cnt;
+}
+
+/**
+ * @brief Releases the ring of an exiting thread (destructor of sr_log_ring_key).
+ */
+static void
+sr_log_ring_release(void *ring_ptr)
+{
+    sr_log_ring_t *ring = ring_ptr, **ring_p = NULL;
+    bool running = false;
+
+    pthread_mutex_lock(&sr_log_rings_lock);
+    running = sr_log_writer_running;
+    if (running) {
+        /* the writer thread writes out the remaining entries and releases the ring */
+        __atomic_store_n(&ring->orphaned, true, __ATOMIC_RELEASE);
+    } else {
+        for (ring_p = &sr_log_rings; NULL != *ring_p; ring_p = &(*ring_p)->next) {
+            if (ring == *ring_p) {
+                *ring_p = ring->next;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&sr_log_rings_lock);
+
+    if (!running) {
+        sr_log_ring_drain(ring);
+        free(ring);
+    }
+
+    sr_log_thread_ring = NULL;
+}
+
+/**
+ * @brief Create key used to release the ring of an exiting thread. Should be called only once.
+ */
+static void
+sr_log_ring_create_key(void)
+{
+    while (pthread_key_create(&sr_log_ring_key, sr_log_ring_release) == EAGAIN);
+}
+
+/**
+ * @brief Returns the ring of the calling thread, allocates and registers it on the first use.
+ */
+static sr_log_ring_t *
+sr_log_ring_get()
+{
+    sr_log_ring_t *ring = sr_log_thread_ring;
+
+    if (NULL == ring) {
+        pthread_once(&sr_log_ring_create_key_once, sr_log_ring_create_key);
+        ring = calloc(1, sizeof(*ring));
+        if (NULL == ring) {
+            return NULL;
+        }
+        pthread_mutex_lock(&sr_log_rings_lock);
+        ring->next = sr_log_rings;
+        sr_log_rings = ring;
+        pthread_mutex_unlock(&sr_log_rings_lock);
+
+        pthread_setspecific(sr_log_ring_key, ring);
+        sr_log_thread_ring = ring;
+    }
+
+    return ring;
+}
+
+/**
+ * @brief Passes a formatted message to the writer thread. Never blocks, drops the message
+ * if the ring of the calling thread is full.
+ */
+static void
+sr_log_enqueue(sr_log_level_t level, const char *msg)
+{
+    sr_log_ring_t *ring = NULL;
+    sr_log_entry_t *entry = NULL;
+    uint32_t head = 0, tail = 0;
+
+    ring = sr_log_ring_get();
+    if (NULL == ring) {
+        sr_log_write(level, msg);
+        return;
+    }
+
+    tail = ring->tail;
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (tail - head >= SR_LOG_RING_SIZE) {
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    entry = &ring->entries[tail & (SR_LOG_RING_SIZE - 1)];
+    entry->level = level;
+    strncpy(entry->msg, msg, SR_LOG_MSG_SIZE - 1);
+    entry->msg[SR_LOG_MSG_SIZE - 1] = '\0';
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    /* errors and filling rings wake up the writer immediately, otherwise it polls in intervals */
+    if (sr_log_writer_idle && (SR_LL_ERR == level || (tail + 1 - head) >= SR_LOG_RING_SIZE / 2)) {
+        pthread_cond_signal(&sr_log_writer_cv);
+    }
+}
+
+/**
+ * @brief Body of the writer thread of the asynchronous logging.
+ */
+static void *
+sr_log_writer_thread(void *arg)
+{
+    struct timespec ts = { 0, };
+    bool stop = false;
+
+    do {
+        /* read the flag before draining, so that all entries enqueued before the stop are written */
+        pthread_mutex_lock(&sr_log_rings_lock);
+        stop = sr_log_writer_stop;
+        pthread_mutex_unlock(&sr_log_rings_lock);
+
+        if (0 == sr_log_rings_drain() && !stop) {
+            sr_clock_get_time(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += SR_LOG_WRITER_INTERVAL * 1000000L;
+            ts.tv_sec += ts.tv_nsec / 1000000000L;
+            ts.tv_nsec %= 1000000000L;
+            pthread_mutex_lock(&sr_log_rings_lock);
+            if (!sr_log_writer_stop) {
+                sr_log_writer_idle = true;
+                pthread_cond_timedwait(&sr_log_writer_cv, &sr_log_rings_lock, &ts);
+                sr_log_writer_idle = false;
+            }
+            pthread_mutex_unlock(&sr_log_rings_lock);
+        }
+    } while (!stop);
+
+    return NULL;
+}
+
 void
 sr_logger_init(const char *app_name)
 {
@@ -106,6 +391,13 @@ void
 sr_logger_cleanup()
 {
 #if SR_LOGGING_ENABLED
+    /* stop the writer thread and release the ring of this thread */
+    sr_logger_set_async(false);
+    if (NULL != sr_log_thread_ring) {
+        pthread_setspecific(sr_log_ring_key, NULL);
+        sr_log_ring_release(sr_log_thread_ring);
+    }
+
     /* flush stadard error output */
     fflush(stderr);
 
@@ -142,6 +434,7 @@ sr_log_stderr(sr_log_level_t log_level)
 {
 #if SR_LOGGING_ENABLED
     sr_ll_stderr = log_level;
+    sr_log_update_max_level();
 
     SR_LOG_DBG("Setting log level for stderr logs to %d.", log_level);
 #endif
@@ -152,6 +445,7 @@ sr_log_syslog(sr_log_level_t log_level)
 {
 #if SR_LOGGING_ENABLED
     sr_ll_syslog = log_level;
+    sr_log_update_max_level();
 
     SR_LOG_DBG("Setting log level for syslog logs to %d.", log_level);
 
@@ -169,40 +463,167 @@ sr_log_syslog(sr_log_level_t log_level)
 #endif
 }
 
+int
+sr_logger_set_level(const char *output, sr_log_level_t log_level)
+{
+    CHECK_NULL_ARG(output);
+
+    if ((int) log_level < SR_LL_NONE || log_level > SR_LL_DBG) {
+        return SR_ERR_INVAL_ARG;
+    }
+    if (0 == strcmp("stderr", output)) {
+        sr_log_stderr(log_level);
+    } else if (0 == strcmp("syslog", output)) {
+        sr_log_syslog(log_level);
+    } else {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    return SR_ERR_OK;
+}
+
 void
 sr_log_set_cb(sr_log_cb log_callback)
 {
 #if SR_LOGGING_ENABLED
     sr_log_callback = log_callback;
+    sr_log_update_max_level();
 #endif
 }
 
 void
-sr_log_to_cb(sr_log_level_t level, const char *format, ...)
+sr_logger_set_async(bool async)
+{
+#if SR_LOGGING_ENABLED
+    sr_log_ring_t *orphaned = NULL, **ring_p = NULL, *ring = NULL;
+    bool join = false;
+
+    pthread_mutex_lock(&sr_log_rings_lock);
+    if (async && !sr_log_writer_running) {
+        sr_log_writer_stop = false;
+        if (0 == pthread_create(&sr_log_writer, NULL, sr_log_writer_thread, NULL)) {
+            sr_log_writer_running = true;
+            sr_log_async = true;
+        }
+    } else if (!async && sr_log_writer_running) {
+        sr_log_async = false;
+        sr_log_writer_stop = true;
+        pthread_cond_signal(&sr_log_writer_cv);
+        join = true;
+    }
+    pthread_mutex_unlock(&sr_log_rings_lock);
+
+    if (join) {
+        pthread_join(sr_log_writer, NULL);
+        /* write out the entries enqueued by threads that have not noticed the switch yet */
+        sr_log_rings_drain();
+
+        /* the rings orphaned since the last drain are released here, later ones by their threads */
+        pthread_mutex_lock(&sr_log_rings_lock);
+        sr_log_writer_running = false;
+        ring_p = &sr_log_rings;
+        while (NULL != *ring_p) {
+            ring = *ring_p;
+            if (__atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE)) {
+                *ring_p = ring->next;
+                ring->next = orphaned;
+                orphaned = ring;
+            } else {
+                ring_p = &ring->next;
+            }
+        }
+        pthread_mutex_unlock(&sr_log_rings_lock);
+
+        while (NULL != orphaned) {
+            ring = orphaned;
+            orphaned = ring->next;
+            sr_log_ring_drain(ring);
+            free(ring);
+        }
+        fflush(stderr);
+    }
+#endif
+}
+
+void
+sr_log_msg(sr_log_level_t level, bool write_out, const char *format, ...)
 {
 #if SR_LOGGING_ENABLED
     char *msg_buff = NULL;
     va_list arg_list;
 
+    if (!write_out && NULL == sr_log_callback) {
+        /* suppressed by the rate limit and nobody else is interested */
+        return;
+    }
+
+    /* get thread-local message buffer */
+    pthread_once(&sr_log_buff_create_key_once, sr_log_buff_create_key);
+    msg_buff = pthread_getspecific(sr_log_buff_key);
+    if (NULL == msg_buff) {
+        msg_buff = calloc(SR_LOG_MSG_SIZE, sizeof(*msg_buff));
+        pthread_setspecific(sr_log_buff_key, msg_buff);
+    }
+    if (NULL == msg_buff) {
+        return;
+    }
+
+    /* print the message into buffer only once for all outputs */
+    va_start(arg_list, format);
+    vsnprintf(msg_buff, SR_LOG_MSG_SIZE - 1, format, arg_list);
+    va_end(arg_list);
+    msg_buff[SR_LOG_MSG_SIZE - 1] = '\0';
+
+    if (write_out && (sr_ll_stderr >= level || sr_ll_syslog >= level)) {
+        if (sr_log_async) {
+            sr_log_enqueue(level, msg_buff);
+        } else {
+            sr_log_write(level, msg_buff);
+        }
+    }
     if (NULL != sr_log_callback) {
-        /* get thread-local message buffer */
-        pthread_once(&sr_log_buff_create_key_once, sr_log_buff_create_key);
-        msg_buff = pthread_getspecific(sr_log_buff_key);
-        if (NULL == msg_buff) {
-            msg_buff = calloc(SR_LOG_MSG_SIZE, sizeof(*msg_buff));
-            pthread_setspecific(sr_log_buff_key, msg_buff);
+        sr_log_callback(level, msg_buff);
+    }
+#endif
+}
+
+bool
+sr_log_rate_check(sr_log_site_t *site)
+{
+    struct timespec ts = { 0, };
+    uint64_t state = 0, new_state = 0;
+    uint32_t now = 0, count = 0, suppressed = 0;
+    bool new_window = false;
+
+#ifdef CLOCK_MONOTONIC_COARSE
+    sr_clock_get_time(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    sr_clock_get_time(CLOCK_MONOTONIC, &ts);
+#endif
+    now = (uint32_t) ts.tv_sec;
+
+    /* the window and the count are updated together, a message is never counted into a stale window */
+    state = __atomic_load_n(&site->state, __ATOMIC_RELAXED);
+    do {
+        new_window = now != (uint32_t) (state >> 32);
+        count = new_window ? 1 : (uint32_t) state + 1;
+        if (count > SR_LOG_RATE_LIMIT) {
+            __atomic_add_fetch(&site->suppressed, 1, __ATOMIC_RELAXED);
+            return false;
         }
-        /* print the message into buffer and call callback */
-        if (NULL != msg_buff) {
-            va_start(arg_list, format);
-            vsnprintf(msg_buff, SR_LOG_MSG_SIZE - 1, format, arg_list);
-            va_end(arg_list);
-            msg_buff[SR_LOG_MSG_SIZE - 1] = '\0';
-            /* call the callback */
-            sr_log_callback(level, msg_buff);
+        new_state = ((uint64_t) now << 32) | count;
+    } while (!__atomic_compare_exchange_n(&site->state, &state, new_state, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    if (new_window) {
+        /* report the messages suppressed in the previous windows */
+        suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+        if (suppressed > 0) {
+            sr_log_msg(site->level, true, "%" PRIu32 " messages from %s:%d suppressed by the rate limit.",
+                    suppressed, site->file, site->line);
         }
     }
-#endif
+
+    return true;
 }
 
 const char *
@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <errno.h>
 #include <string.h>
 #include <syslog.h>
@@ -71,6 +72,7 @@
 
 extern volatile uint8_t sr_ll_stderr;       /**< Holds current level of stderr debugs. */
 extern volatile uint8_t sr_ll_syslog;       /**< Holds current level of syslog debugs. */
+extern volatile uint8_t sr_ll_max;          /**< Holds the most verbose level accepted by any of the log outputs. */
 extern volatile sr_log_cb sr_log_callback;  /**< Holds pointer to logging callback, if set. */
 extern __thread char strerror_buf [SR_MAX_STRERROR_LEN]; /**< thread local buffer for strerror_r message */
 
@@ -86,40 +88,45 @@ extern __thread char strerror_buf [SR_MAX_STRERROR_LEN]; /**< thread local buffe
      (SR_LL_WRN == LL) ? LOG_WARNING : \
       LOG_ERR)
 
+/**
+ * @brief Rate limiting state of one logging call site.
+ */
+typedef struct sr_log_site_s {
+    uint8_t level;            /**< Log level of the call site. */
+    const char *file;         /**< Source file of the call site. */
+    int line;                 /**< Source line of the call site. */
+    uint64_t state;           /**< Second (of the monotonic clock) in which the messages are being counted (upper 32 bits)
+                                   and the number of messages logged in it (lower 32 bits). */
+    uint32_t suppressed;      /**< Number of messages suppressed since the last report. */
+} sr_log_site_t;
+
 #ifdef LOG_THREAD_ID
 /* print thread IDs and function names */
-#define SR_LOG__SYSLOG(LL, MSG, ...) \
-        syslog(SR_LOG__LL_FACILITY(LL), "[%s] [%lu] (%s:%d) " MSG, SR_LOG__LL_STR(LL), (unsigned long)pthread_self(), __func__, __LINE__, __VA_ARGS__);
-#define SR_LOG__STDERR(LL, MSG, ...) \
-        fprintf(stderr, "[%s] [%lu] (%s:%d) " MSG "\n", SR_LOG__LL_STR(LL), (unsigned long)pthread_self(), __func__, __LINE__, __VA_ARGS__);
-#define SR_LOG__CALLBACK(LL, MSG, ...) \
-        sr_log_to_cb(LL, "[%lu] (%s:%d) " MSG, (unsigned long)pthread_self(), __func__, __LINE__, __VA_ARGS__);
+#define SR_LOG__MSG(LL, OUT, MSG, ...) \
+        sr_log_msg(LL, OUT, "[%lu] (%s:%d) " MSG, (unsigned long)pthread_self(), __func__, __LINE__, __VA_ARGS__);
 #elif SR_LOG_PRINT_FUNCTION_NAMES
 /* print function names (without thread IDs) */
-#define SR_LOG__SYSLOG(LL, MSG, ...) \
-        syslog(SR_LOG__LL_FACILITY(LL), "[%s] (%s:%d) " MSG, SR_LOG__LL_STR(LL), __func__, __LINE__, __VA_ARGS__);
-#define SR_LOG__STDERR(LL, MSG, ...) \
-        fprintf(stderr, "[%s] (%s:%d) " MSG "\n", SR_LOG__LL_STR(LL), __func__, __LINE__, __VA_ARGS__);
-#define SR_LOG__CALLBACK(LL, MSG, ...) \
-        sr_log_to_cb(LL, "(%s:%d) " MSG, __func__, __LINE__, __VA_ARGS__);
+#define SR_LOG__MSG(LL, OUT, MSG, ...) \
+        sr_log_msg(LL, OUT, "(%s:%d) " MSG, __func__, __LINE__, __VA_ARGS__);
 #else
 /* do not print function names nor thread IDs */
-#define SR_LOG__SYSLOG(LL, MSG, ...) \
-        syslog(SR_LOG__LL_FACILITY(LL), "[%s] " MSG, SR_LOG__LL_STR(LL), __VA_ARGS__);
-#define SR_LOG__STDERR(LL, MSG, ...) \
-        fprintf(stderr, "[%s] " MSG "\n", SR_LOG__LL_STR(LL), __VA_ARGS__);
-#define SR_LOG__CALLBACK(LL, MSG, ...) \
-        sr_log_to_cb(LL, MSG, __VA_ARGS__);
+#define SR_LOG__MSG(LL, OUT, MSG, ...) \
+        sr_log_msg(LL, OUT, MSG, __VA_ARGS__);
 #endif
 
+/*
+ * Levels above SR_LOG_MAX_LEVEL are removed by the compiler, the runtime check is a single
+ * comparison with the most verbose enabled level. Each call site writes at most
+ * SR_LOG_RATE_LIMIT messages per second into stderr and syslog, errors are never suppressed.
+ * The logging callback receives all messages.
+ */
 #define SR_LOG__INTERNAL(LL, MSG, ...) \
     do { \
-        if (sr_ll_stderr >= LL) \
-            SR_LOG__STDERR(LL, MSG, __VA_ARGS__) \
-        if (sr_ll_syslog >= LL) \
-            SR_LOG__SYSLOG(LL, MSG, __VA_ARGS__) \
-        if (NULL != sr_log_callback) \
-            SR_LOG__CALLBACK(LL, MSG, __VA_ARGS__) \
+        if ((LL) <= SR_LOG_MAX_LEVEL && sr_ll_max >= (LL)) { \
+            static sr_log_site_t sr_log_site_ = { LL, __FILE__, __LINE__, 0, 0 }; \
+            SR_LOG__MSG(LL, (SR_LL_ERR == (LL) || 0 == SR_LOG_RATE_LIMIT || sr_log_rate_check(&sr_log_site_)), \
+                    MSG, __VA_ARGS__) \
+        } \
     } while(0)
 
 #if SR_LOGGING_ENABLED
@@ -175,13 +182,53 @@ void sr_logger_init(const char *app_name);
 void sr_logger_cleanup();
 
 /**
- * @brief Logs into callback pre-specified by ::sr_log_set_cb.
+ * @brief Switches between synchronous and asynchronous logging into stderr and syslog.
+ *
+ * In the asynchronous mode, each thread formats its messages into its own lock-free ring
+ * and a background writer thread writes them out, so that the logging thread never blocks
+ * on the output. If a ring is full, the messages are dropped and their number is reported
+ * once the writer catches up. The logging callback is always called synchronously.
+ *
+ * @note Disabling the asynchronous mode writes out all pending messages.
+ *
+ * @param[in] async TRUE to start the writer thread, FALSE to stop it.
+ */
+void sr_logger_set_async(bool async);
+
+/**
+ * @brief Sets the log level of the log output given by its name, used to reconfigure
+ * the logging of a running daemon (see ::sr_log_stderr and ::sr_log_syslog).
+ *
+ * @param[in] output Name of the log output, "stderr" or "syslog".
+ * @param[in] log_level Requested log level.
+ *
+ * @return Error code (SR_ERR_OK on success, SR_ERR_INVAL_ARG for an unknown output or level).
+ */
+int sr_logger_set_level(const char *output, sr_log_level_t log_level);
+
+/**
+ * @brief Formats a log entry and passes it to all enabled outputs.
  * Used internally by logging macros.
  *
  * @param[in] level Log level.
+ * @param[in] write_out FALSE if the entry has been suppressed by the rate limit of its call site,
+ * it is then passed only to the logging callback (not written into stderr nor syslog).
  * @param[in] format Format message.
  */
-void sr_log_to_cb(sr_log_level_t level, const char *format, ...);
+void sr_log_msg(sr_log_level_t level, bool write_out, const char *format, ...);
+
+/**
+ * @brief Counts a message logged from a call site and decides whether it fits into
+ * the rate limit of the call site. The number of suppressed messages is logged
+ * when a new one-second window of the call site starts. The rate limit applies
+ * to stderr and syslog only.
+ * Used internally by logging macros.
+ *
+ * @param[in] site Rate limiting state of the call site.
+ *
+ * @return TRUE if the message should be written out, FALSE if it should be suppressed.
+ */
+bool sr_log_rate_check(sr_log_site_t *site);
 
 /**
  * @brief Prints string representation of errno using strerror_r and returns pointer
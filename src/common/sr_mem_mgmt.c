@@ -31,6 +31,25 @@
 
 #define QUEUE_PREV(head, len) ((head) == 0 ? ((len)-1) : ((head)-1))
 
+#define MEM_REFILL_SIZE (64 * 1024)  /**< Size of free blocks moved at once from the shared cache into a thread cache. */
+
+/**
+ * @brief Next free memory block in a list of cached blocks (stored in the memory of the free block).
+ */
+#define MEM_BLOCK_NEXT(BLOCK) (*(sr_mem_block_t **)(BLOCK)->mem)
+
+/**
+ * @brief Increments a statistics counter of the thread (or of the exited threads if there is no thread pool).
+ */
+#define MEM_STAT_INC(POOL, FIELD) \
+    do { \
+        if (NULL != (POOL)) { \
+            __atomic_store_n(&(POOL)->stats.FIELD, (POOL)->stats.FIELD + 1, __ATOMIC_RELAXED); \
+        } else { \
+            __atomic_add_fetch(&mem_depot.retired.FIELD, 1, __ATOMIC_RELAXED); \
+        } \
+    } while (0)
+
 /**
  * @brief A Pool of free memory contexts.
  */
@@ -45,13 +64,231 @@ typedef struct fctx_pool_s {
     size_t pb_peak_history[MEM_PEAK_USAGE_HISTORY_LENGTH]; /**< Piggy-backed recent history of peak memory
                                                                 usage as observed by potentially different threads. */
     size_t pb_peak_history_head;                           /**< Head of the pb_peak_history queue. */
+
+    sr_mem_block_t *free_blocks[MEM_SLAB_CLASSES];  /**< Cached free memory blocks of each size class. */
+    size_t cached_bytes;                            /**< Size of the cached free memory blocks. */
+    sr_mem_stats_t stats;                           /**< Statistics of this thread (updated only by the owner thread). */
+    struct fctx_pool_s *prev, *next;                /**< Neighbours in the list of all thread pools. */
 } fctx_pool_t;
 
+/**
+ * @brief Cache of free memory blocks shared by all threads.
+ */
+typedef struct mem_depot_s {
+    pthread_mutex_t lock;                           /**< Lock guarding the depot. */
+    sr_mem_block_t *free_blocks[MEM_SLAB_CLASSES];  /**< Free memory blocks of each size class. */
+    size_t cached_bytes;                            /**< Size of the free memory blocks. */
+    fctx_pool_t *pools;                             /**< List of pools of all running threads. */
+    sr_mem_stats_t retired;                         /**< Statistics of the exited threads. */
+    sr_mem_limits_t limits;                         /**< Limits of the caches. */
+} mem_depot_t;
+
 static pthread_key_t fctx_key; /**< Key to the pool of free memory contexts. */
 static pthread_once_t fctx_init_once = PTHREAD_ONCE_INIT; /**< For initialization of the key. */
 
+static mem_depot_t mem_depot = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .limits = { MAX_FREE_MEM_CONTEXTS, MEM_THREAD_CACHE_SIZE, MEM_GLOBAL_CACHE_SIZE },
+};
+
 /* Forward declaration. */
-static void sr_mem_destroy(sr_mem_ctx_t *sr_mem);
+static void sr_mem_destroy(fctx_pool_t *fctx_pool, sr_mem_ctx_t *sr_mem);
+
+/**
+ * @brief Returns size of the memory blocks of a size class. Size classes grow by
+ * factors of 1.5 and 4/3 alternately, starting at MEM_BLOCK_MIN_SIZE.
+ */
+static size_t
+mem_class_size(int cls)
+{
+    if (cls % 2) {
+        return (MEM_BLOCK_MIN_SIZE + (MEM_BLOCK_MIN_SIZE >> 1)) << (cls / 2);
+    }
+    return (size_t)MEM_BLOCK_MIN_SIZE << (cls / 2);
+}
+
+/**
+ * @brief Returns the smallest size class that fits memory block of given size, -1 if
+ * the block is too large to be cached.
+ */
+static int
+mem_size_class(size_t size)
+{
+    for (int cls = 0; cls < MEM_SLAB_CLASSES; ++cls) {
+        if (size <= mem_class_size(cls)) {
+            return cls;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Puts a list of free memory blocks of a size class into the shared cache,
+ * blocks that do not fit into the cache are returned to the system.
+ */
+static void
+mem_depot_put(int cls, sr_mem_block_t *blocks)
+{
+    sr_mem_block_t *block = NULL;
+    size_t class_size = mem_class_size(cls);
+    size_t limit = __atomic_load_n(&mem_depot.limits.global_cache_size, __ATOMIC_RELAXED);
+    uint64_t freed = 0;
+
+    pthread_mutex_lock(&mem_depot.lock);
+    while (NULL != blocks) {
+        block = blocks;
+        blocks = MEM_BLOCK_NEXT(block);
+        if (mem_depot.cached_bytes + class_size <= limit) {
+            MEM_BLOCK_NEXT(block) = mem_depot.free_blocks[cls];
+            mem_depot.free_blocks[cls] = block;
+            mem_depot.cached_bytes += class_size;
+        } else {
+            free(block);
+            ++freed;
+        }
+    }
+    pthread_mutex_unlock(&mem_depot.lock);
+
+    __atomic_add_fetch(&mem_depot.retired.system_frees, freed, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Moves all cached free memory blocks of a size class from a thread cache into the shared cache.
+ */
+static void
+mem_cache_flush(fctx_pool_t *fctx_pool, int cls)
+{
+    size_t count = 0;
+
+    if (NULL == fctx_pool->free_blocks[cls]) {
+        return;
+    }
+
+    for (sr_mem_block_t *block = fctx_pool->free_blocks[cls]; NULL != block; block = MEM_BLOCK_NEXT(block)) {
+        ++count;
+    }
+    mem_depot_put(cls, fctx_pool->free_blocks[cls]);
+    fctx_pool->free_blocks[cls] = NULL;
+    __atomic_store_n(&fctx_pool->cached_bytes, fctx_pool->cached_bytes - count * mem_class_size(cls), __ATOMIC_RELAXED);
+    MEM_STAT_INC(fctx_pool, global_flushes);
+}
+
+/**
+ * @brief Moves free memory blocks of a size class from the shared cache into a thread cache.
+ */
+static void
+mem_cache_refill(fctx_pool_t *fctx_pool, int cls)
+{
+    sr_mem_block_t *block = NULL;
+    size_t class_size = mem_class_size(cls), moved = 0;
+
+    if (NULL == __atomic_load_n(&mem_depot.free_blocks[cls], __ATOMIC_RELAXED)) {
+        /* cheap check without locking, refill is just an optimization */
+        return;
+    }
+
+    pthread_mutex_lock(&mem_depot.lock);
+    while (NULL != (block = mem_depot.free_blocks[cls]) && (0 == moved || moved < MEM_REFILL_SIZE)) {
+        mem_depot.free_blocks[cls] = MEM_BLOCK_NEXT(block);
+        mem_depot.cached_bytes -= class_size;
+        MEM_BLOCK_NEXT(block) = fctx_pool->free_blocks[cls];
+        fctx_pool->free_blocks[cls] = block;
+        moved += class_size;
+    }
+    pthread_mutex_unlock(&mem_depot.lock);
+
+    if (0 < moved) {
+        __atomic_store_n(&fctx_pool->cached_bytes, fctx_pool->cached_bytes + moved, __ATOMIC_RELAXED);
+        MEM_STAT_INC(fctx_pool, global_refills);
+    }
+}
+
+/**
+ * @brief Allocates a memory block of given size, preferably from the cache of the thread.
+ *
+ * @param [in] fctx_pool Pool of the calling thread (can be NULL).
+ * @param [in] size Size of the memory block.
+ */
+static sr_mem_block_t *
+mem_block_alloc(fctx_pool_t *fctx_pool, size_t size)
+{
+    sr_mem_block_t *block = NULL;
+    int cls = mem_size_class(size);
+
+    MEM_STAT_INC(fctx_pool, block_allocs);
+
+    if (0 <= cls && NULL != fctx_pool) {
+        if (NULL == fctx_pool->free_blocks[cls]) {
+            mem_cache_refill(fctx_pool, cls);
+        }
+        block = fctx_pool->free_blocks[cls];
+        if (NULL != block) {
+            fctx_pool->free_blocks[cls] = MEM_BLOCK_NEXT(block);
+            __atomic_store_n(&fctx_pool->cached_bytes, fctx_pool->cached_bytes - mem_class_size(cls), __ATOMIC_RELAXED);
+            MEM_STAT_INC(fctx_pool, block_cache_hits);
+        }
+    }
+
+    if (NULL == block) {
+        block = malloc(sizeof *block + (0 <= cls ? mem_class_size(cls) : size));
+        if (NULL == block) {
+            return NULL;
+        }
+        MEM_STAT_INC(fctx_pool, system_allocs);
+    }
+
+    block->size = 0 <= cls ? mem_class_size(cls) : size;
+    return block;
+}
+
+/**
+ * @brief Releases a memory block into the cache of the thread, the surplus is handed
+ * over to the shared cache.
+ *
+ * @param [in] fctx_pool Pool of the calling thread (can be NULL).
+ * @param [in] block Memory block to release.
+ */
+static void
+mem_block_release(fctx_pool_t *fctx_pool, sr_mem_block_t *block)
+{
+    int cls = mem_size_class(block->size);
+
+    if (0 > cls) {
+        free(block);
+        MEM_STAT_INC(fctx_pool, system_frees);
+        return;
+    }
+
+    if (NULL == fctx_pool) {
+        MEM_BLOCK_NEXT(block) = NULL;
+        mem_depot_put(cls, block);
+        return;
+    }
+
+    MEM_BLOCK_NEXT(block) = fctx_pool->free_blocks[cls];
+    fctx_pool->free_blocks[cls] = block;
+    __atomic_store_n(&fctx_pool->cached_bytes, fctx_pool->cached_bytes + mem_class_size(cls), __ATOMIC_RELAXED);
+
+    if (fctx_pool->cached_bytes > __atomic_load_n(&mem_depot.limits.thread_cache_size, __ATOMIC_RELAXED)) {
+        mem_cache_flush(fctx_pool, cls);
+    }
+}
+
+/**
+ * @brief Adds counters of memory management statistics.
+ */
+static void
+mem_stats_add(sr_mem_stats_t *to, sr_mem_stats_t *from)
+{
+    __atomic_add_fetch(&to->contexts_created, __atomic_load_n(&from->contexts_created, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->contexts_reused, __atomic_load_n(&from->contexts_reused, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->block_allocs, __atomic_load_n(&from->block_allocs, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->block_cache_hits, __atomic_load_n(&from->block_cache_hits, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->system_allocs, __atomic_load_n(&from->system_allocs, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->system_frees, __atomic_load_n(&from->system_frees, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->global_refills, __atomic_load_n(&from->global_refills, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&to->global_flushes, __atomic_load_n(&from->global_flushes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
 
 /**
  * @brief Destroy pool of free contexts.
@@ -66,10 +303,29 @@ destroy_fctx_pool(void *fctx_pool_p)
         node_ll = fctx_pool->fctx_llist->first;
         while (node_ll) {
             sr_mem_ctx_t *sr_mem = (sr_mem_ctx_t *)node_ll->data;
-            sr_mem_destroy(sr_mem);
+            sr_mem_destroy(fctx_pool, sr_mem);
             node_ll = node_ll->next;
         }
         sr_llist_cleanup(fctx_pool->fctx_llist);
+
+        /* hand the cached blocks over to other threads */
+        for (int cls = 0; cls < MEM_SLAB_CLASSES; ++cls) {
+            mem_cache_flush(fctx_pool, cls);
+        }
+
+        /* unregister the pool, keep its statistics */
+        pthread_mutex_lock(&mem_depot.lock);
+        mem_stats_add(&mem_depot.retired, &fctx_pool->stats);
+        if (NULL != fctx_pool->prev) {
+            fctx_pool->prev->next = fctx_pool->next;
+        } else {
+            mem_depot.pools = fctx_pool->next;
+        }
+        if (NULL != fctx_pool->next) {
+            fctx_pool->next->prev = fctx_pool->prev;
+        }
+        pthread_mutex_unlock(&mem_depot.lock);
+
         free(fctx_pool);
     }
 }
@@ -97,6 +353,14 @@ get_fctx_pool()
         if (fctx_pool) {
             if (SR_ERR_OK == sr_llist_init(&fctx_pool->fctx_llist)) {
                 (void)pthread_setspecific(fctx_key, fctx_pool);
+                /* register the pool */
+                pthread_mutex_lock(&mem_depot.lock);
+                fctx_pool->next = mem_depot.pools;
+                if (NULL != mem_depot.pools) {
+                    mem_depot.pools->prev = fctx_pool;
+                }
+                mem_depot.pools = fctx_pool;
+                pthread_mutex_unlock(&mem_depot.lock);
             } else {
                 free(fctx_pool);
                 fctx_pool = NULL;
@@ -149,6 +413,7 @@ sr_mem_new(size_t min_size, sr_mem_ctx_t **sr_mem_p)
                 sr_llist_rm(fctx_pool->fctx_llist, fctx_pool->fctx_llist->last);
             }
             --fctx_pool->count;
+            MEM_STAT_INC(fctx_pool, contexts_reused);
             sr_mem->piggy_back = max_recent_peak;
             *sr_mem_p = sr_mem;
             return SR_ERR_OK;
@@ -157,10 +422,10 @@ sr_mem_new(size_t min_size, sr_mem_ctx_t **sr_mem_p)
 
     sr_mem = calloc(1, sizeof *sr_mem);
     CHECK_NULL_NOMEM_GOTO(sr_mem, rc, cleanup);
+    MEM_STAT_INC(fctx_pool, contexts_created);
 
-    mem_block = malloc(sizeof *mem_block + MAX(min_size, MEM_BLOCK_MIN_SIZE));
+    mem_block = mem_block_alloc(fctx_pool, MAX(min_size, MEM_BLOCK_MIN_SIZE));
     CHECK_NULL_NOMEM_GOTO(mem_block, rc, cleanup);
-    mem_block->size = MAX(min_size, MEM_BLOCK_MIN_SIZE);
 
     rc = sr_llist_init(&sr_mem->mem_blocks);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to initialize linked-list.");
@@ -175,7 +440,9 @@ sr_mem_new(size_t min_size, sr_mem_ctx_t **sr_mem_p)
 
 cleanup:
     if (SR_ERR_OK != rc) {
-        free(mem_block);
+        if (mem_block) {
+            mem_block_release(fctx_pool, mem_block);
+        }
         if (sr_mem) {
             sr_llist_cleanup(sr_mem->mem_blocks);
             free(sr_mem);
@@ -194,6 +461,7 @@ sr_malloc(sr_mem_ctx_t *sr_mem, size_t size)
     int err = SR_ERR_OK;
     sr_llist_node_t *node_ll = NULL, *for_removal = NULL;
     sr_mem_block_t *mem_block = NULL;
+    fctx_pool_t *fctx_pool = NULL;
 
     if (0 == size) {
         return NULL;
@@ -232,9 +500,11 @@ sr_malloc(sr_mem_ctx_t *sr_mem, size_t size)
         if (sr_mem->cursor == sr_mem->mem_blocks->last) {
             /* add new block */
             new_size = MAX(size, mem_block->size + (mem_block->size >> 1) /* 1.5x */);
-            mem_block = (sr_mem_block_t *)malloc(sizeof *mem_block + new_size);
+            if (NULL == fctx_pool) {
+                fctx_pool = get_fctx_pool();
+            }
+            mem_block = mem_block_alloc(fctx_pool, new_size);
             CHECK_NULL_NOMEM_GOTO(mem_block, err, cleanup);
-            mem_block->size = new_size;
             err = sr_llist_add_new(sr_mem->mem_blocks, mem_block);
             CHECK_RC_MSG_GOTO(err, cleanup, "Failed to add memory block into a linked-list.");
             sr_mem->size_total += mem_block->size;
@@ -252,7 +522,10 @@ sr_malloc(sr_mem_ctx_t *sr_mem, size_t size)
         mem_block = (sr_mem_block_t *)sr_mem->cursor->data;
         if (NULL != for_removal) {
             sr_mem->size_total -= ((sr_mem_block_t *)for_removal->data)->size;
-            free(for_removal->data);
+            if (NULL == fctx_pool) {
+                fctx_pool = get_fctx_pool();
+            }
+            mem_block_release(fctx_pool, (sr_mem_block_t *)for_removal->data);
             sr_llist_rm(sr_mem->mem_blocks, for_removal);
         }
     }
@@ -273,8 +546,7 @@ alloc:
 cleanup:
     if (SR_ERR_OK != err) {
         if (mem_block) {
-            free(mem_block->mem);
-            free(mem_block);
+            mem_block_release(fctx_pool, mem_block);
         }
     }
     return mem;
@@ -300,13 +572,13 @@ sr_calloc(sr_mem_ctx_t *sr_mem, size_t nmemb, size_t size)
  * @brief Completely destroys Sysrepo memory context.
  */
 static void
-sr_mem_destroy(sr_mem_ctx_t *sr_mem)
+sr_mem_destroy(fctx_pool_t *fctx_pool, sr_mem_ctx_t *sr_mem)
 {
     if (NULL != sr_mem) {
         sr_llist_node_t *node_ll = sr_mem->mem_blocks->first;
         while (node_ll) {
             sr_mem_block_t *mem_block = (sr_mem_block_t *)node_ll->data;
-            free(mem_block);
+            mem_block_release(fctx_pool, mem_block);
             node_ll = node_ll->next;
         }
         sr_llist_cleanup(sr_mem->mem_blocks);
@@ -340,7 +612,7 @@ sr_mem_free(sr_mem_ctx_t *sr_mem)
         for (size_t i = 0; i < MEM_PEAK_USAGE_HISTORY_LENGTH; ++i) {
             max_recent_peak = MAX(max_recent_peak, MAX(fctx_pool->pb_peak_history[i], fctx_pool->peak_history[i]));
         }
-        if (MAX_FREE_MEM_CONTEXTS > fctx_pool->count) {
+        if (__atomic_load_n(&mem_depot.limits.max_free_contexts, __ATOMIC_RELAXED) > fctx_pool->count) {
             /* remove extra trailing empty memory blocks based on the maximum peak memory usage in the recent history */
             sr_llist_node_t *node_ll = sr_mem->mem_blocks->last;
             while (node_ll->prev) {
@@ -353,7 +625,7 @@ sr_mem_free(sr_mem_ctx_t *sr_mem)
             }
             while (node_ll != sr_mem->mem_blocks->last) {
                 sr_mem_block_t *mem_block = (sr_mem_block_t *)sr_mem->mem_blocks->last->data;
-                free(mem_block);
+                mem_block_release(fctx_pool, mem_block);
                 sr_llist_rm(sr_mem->mem_blocks, sr_mem->mem_blocks->last);
             }
             sr_mem->cursor = sr_mem->mem_blocks->first;
@@ -369,7 +641,7 @@ sr_mem_free(sr_mem_ctx_t *sr_mem)
         }
     }
 
-    sr_mem_destroy(sr_mem);
+    sr_mem_destroy(fctx_pool, sr_mem);
 }
 
 static void
@@ -515,3 +787,46 @@ sr_msg_free(Sr__Msg *msg)
         sr__msg__free_unpacked(msg, NULL);
     }
 }
+
+void
+sr_mem_set_limits(const sr_mem_limits_t *limits)
+{
+    CHECK_NULL_ARG_VOID(limits);
+
+    if (0 != limits->max_free_contexts) {
+        __atomic_store_n(&mem_depot.limits.max_free_contexts, limits->max_free_contexts, __ATOMIC_RELAXED);
+    }
+    if (0 != limits->thread_cache_size) {
+        __atomic_store_n(&mem_depot.limits.thread_cache_size, limits->thread_cache_size, __ATOMIC_RELAXED);
+    }
+    if (0 != limits->global_cache_size) {
+        __atomic_store_n(&mem_depot.limits.global_cache_size, limits->global_cache_size, __ATOMIC_RELAXED);
+    }
+}
+
+void
+sr_mem_get_limits(sr_mem_limits_t *limits)
+{
+    CHECK_NULL_ARG_VOID(limits);
+
+    limits->max_free_contexts = __atomic_load_n(&mem_depot.limits.max_free_contexts, __ATOMIC_RELAXED);
+    limits->thread_cache_size = __atomic_load_n(&mem_depot.limits.thread_cache_size, __ATOMIC_RELAXED);
+    limits->global_cache_size = __atomic_load_n(&mem_depot.limits.global_cache_size, __ATOMIC_RELAXED);
+}
+
+void
+sr_mem_get_stats(sr_mem_stats_t *stats)
+{
+    CHECK_NULL_ARG_VOID(stats);
+
+    memset(stats, 0, sizeof *stats);
+
+    pthread_mutex_lock(&mem_depot.lock);
+    mem_stats_add(stats, &mem_depot.retired);
+    for (fctx_pool_t *fctx_pool = mem_depot.pools; NULL != fctx_pool; fctx_pool = fctx_pool->next) {
+        mem_stats_add(stats, &fctx_pool->stats);
+        stats->thread_cached_bytes += __atomic_load_n(&fctx_pool->cached_bytes, __ATOMIC_RELAXED);
+    }
+    stats->global_cached_bytes = mem_depot.cached_bytes;
+    pthread_mutex_unlock(&mem_depot.lock);
+}
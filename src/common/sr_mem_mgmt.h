@@ -24,6 +24,7 @@
 #define SR_MEM_MGMT_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "sr_data_structs.h"
 #include "sr_protobuf.h"
@@ -33,6 +34,9 @@
 #define MAX_BLOCKS_AVAIL_FOR_ALLOC    3
 #define MAX_FREE_MEM_CONTEXTS         4
 #define MEM_PEAK_USAGE_HISTORY_LENGTH 3
+#define MEM_SLAB_CLASSES             24          /**< Number of size classes of memory blocks (256 B - 768 KiB). */
+#define MEM_THREAD_CACHE_SIZE   (1024 * 1024)    /**< Default limit of free memory blocks cached by a thread (in bytes). */
+#define MEM_GLOBAL_CACHE_SIZE   (16 * 1024 * 1024) /**< Default limit of free memory blocks shared by all threads (in bytes). */
 
 /**
  * @brief Internal structure representing a single memory block.
@@ -72,6 +76,36 @@ typedef struct sr_mem_snapshot_s {
 } sr_mem_snapshot_t;
 
 
+/**
+ * @brief Limits of the memory caches of Sysrepo memory management.
+ *
+ * Memory blocks of the contexts are allocated from per-thread caches of free blocks organized
+ * in size classes. A thread that frees more blocks than it allocates (e.g. a thread releasing
+ * messages created by another thread) hands the surplus over to a cache shared by all threads,
+ * from which the other threads refill their caches.
+ */
+typedef struct sr_mem_limits_s {
+    size_t max_free_contexts;    /**< Maximum number of free memory contexts kept by a thread for reuse. */
+    size_t thread_cache_size;    /**< Maximum size of free memory blocks cached by a thread (in bytes). */
+    size_t global_cache_size;    /**< Maximum size of free memory blocks in the cache shared by all threads (in bytes). */
+} sr_mem_limits_t;
+
+/**
+ * @brief Statistics of Sysrepo memory management, summed over all threads.
+ */
+typedef struct sr_mem_stats_s {
+    uint64_t contexts_created;   /**< Number of memory contexts allocated from the system. */
+    uint64_t contexts_reused;    /**< Number of memory contexts taken from a pool of free contexts. */
+    uint64_t block_allocs;       /**< Number of requests for a memory block. */
+    uint64_t block_cache_hits;   /**< Number of memory blocks taken from the caches of free blocks. */
+    uint64_t system_allocs;      /**< Number of memory blocks allocated from the system (malloc). */
+    uint64_t system_frees;       /**< Number of memory blocks returned to the system (free). */
+    uint64_t global_refills;     /**< Number of batches of blocks moved from the shared cache into a thread cache. */
+    uint64_t global_flushes;     /**< Number of batches of blocks moved from a thread cache into the shared cache. */
+    size_t thread_cached_bytes;  /**< Size of free memory blocks currently cached by threads. */
+    size_t global_cached_bytes;  /**< Size of free memory blocks currently in the shared cache. */
+} sr_mem_stats_t;
+
 /**
  * @brief Create a new Sysrepo memory context.
  *
@@ -156,4 +190,26 @@ int sr_mem_edit_string_va(sr_mem_ctx_t *sr_mem, char **string_p, const char *for
  */
 void sr_msg_free(Sr__Msg *msg);
 
+/**
+ * @brief Set limits of the memory caches. The new limits apply to subsequent
+ * deallocations, the caches are not trimmed immediately.
+ *
+ * @param [in] limits New limits, zero member keeps the current value.
+ */
+void sr_mem_set_limits(const sr_mem_limits_t *limits);
+
+/**
+ * @brief Get current limits of the memory caches.
+ *
+ * @param [out] limits Current limits.
+ */
+void sr_mem_get_limits(sr_mem_limits_t *limits);
+
+/**
+ * @brief Get statistics of Sysrepo memory management.
+ *
+ * @param [out] stats Statistics summed over all threads (including the threads that already exited).
+ */
+void sr_mem_get_stats(sr_mem_stats_t *stats);
+
 #endif /* SR_MEM_MGMT_H_ */
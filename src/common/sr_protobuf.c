@@ -20,6 +20,8 @@
  * limitations under the License.
  */
 
+#include <stddef.h>
+
 #include "sr_protobuf.h"
 #include "values_internal.h"
 
@@ -1041,87 +1043,161 @@ sr_gpb_msg_validate_notif(const Sr__Msg *msg, const Sr__SubscriptionType type)
     return SR_ERR_OK;
 }
 
+/**
+ * @brief Copies data of a value of a scalar type from sr_val_t into GPB message.
+ */
+typedef void (*sr_val_to_gpb_kernel_t)(const sr_data_t *data, Sr__Value *gpb_value);
+
+/**
+ * @brief Copies data of a value of a scalar type from GPB message into sr_val_t.
+ */
+typedef void (*sr_gpb_to_val_kernel_t)(const Sr__Value *gpb_value, sr_data_t *data);
+
+/**
+ * @brief Defines conversion kernels of a scalar type stored in the field of the same name
+ * in sr_data_t and Sr__Value.
+ */
+#define SR_VAL_CONV_KERNELS(FIELD) \
+    static void \
+    sr_val_to_gpb_##FIELD(const sr_data_t *data, Sr__Value *gpb_value) \
+    { \
+        gpb_value->FIELD = data->FIELD; \
+        gpb_value->has_##FIELD = true; \
+    } \
+    static void \
+    sr_gpb_to_val_##FIELD(const Sr__Value *gpb_value, sr_data_t *data) \
+    { \
+        data->FIELD = gpb_value->FIELD; \
+    }
+
+SR_VAL_CONV_KERNELS(bool_val)
+SR_VAL_CONV_KERNELS(decimal64_val)
+SR_VAL_CONV_KERNELS(int8_val)
+SR_VAL_CONV_KERNELS(int16_val)
+SR_VAL_CONV_KERNELS(int32_val)
+SR_VAL_CONV_KERNELS(int64_val)
+SR_VAL_CONV_KERNELS(uint8_val)
+SR_VAL_CONV_KERNELS(uint16_val)
+SR_VAL_CONV_KERNELS(uint32_val)
+SR_VAL_CONV_KERNELS(uint64_val)
+
+/**
+ * @brief Conversion of one value type between sr_val_t and GPB.
+ */
+typedef struct sr_val_conv_s {
+    Sr__Value__Types gpb_type;         /**< Type of the value in GPB, 0 if the type can not be converted. */
+    size_t gpb_str_offset;             /**< Offset of the string data in Sr__Value, 0 if the data are not a string. */
+    sr_val_to_gpb_kernel_t to_gpb;     /**< Copies scalar data into GPB, NULL if there are none. */
+    sr_gpb_to_val_kernel_t from_gpb;   /**< Copies scalar data from GPB, NULL if there are none. */
+} sr_val_conv_t;
+
+#define SR_VAL_CONV_NONE(GPB_TYPE) { GPB_TYPE, 0, NULL, NULL }
+#define SR_VAL_CONV_STRING(GPB_TYPE, FIELD) { GPB_TYPE, offsetof(Sr__Value, FIELD), NULL, NULL }
+#define SR_VAL_CONV_SCALAR(GPB_TYPE, FIELD) { GPB_TYPE, 0, sr_val_to_gpb_##FIELD, sr_gpb_to_val_##FIELD }
+
+/**
+ * @brief Conversions indexed by sr_type_t.
+ */
+static const sr_val_conv_t sr_val_conv[] = {
+    [SR_LIST_T]               = SR_VAL_CONV_NONE(SR__VALUE__TYPES__LIST),
+    [SR_CONTAINER_T]          = SR_VAL_CONV_NONE(SR__VALUE__TYPES__CONTAINER),
+    [SR_CONTAINER_PRESENCE_T] = SR_VAL_CONV_NONE(SR__VALUE__TYPES__CONTAINER_PRESENCE),
+    [SR_LEAF_EMPTY_T]         = SR_VAL_CONV_NONE(SR__VALUE__TYPES__LEAF_EMPTY),
+    [SR_BINARY_T]             = SR_VAL_CONV_STRING(SR__VALUE__TYPES__BINARY, binary_val),
+    [SR_BITS_T]               = SR_VAL_CONV_STRING(SR__VALUE__TYPES__BITS, bits_val),
+    [SR_BOOL_T]               = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__BOOL, bool_val),
+    [SR_DECIMAL64_T]          = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__DECIMAL64, decimal64_val),
+    [SR_ENUM_T]               = SR_VAL_CONV_STRING(SR__VALUE__TYPES__ENUM, enum_val),
+    [SR_IDENTITYREF_T]        = SR_VAL_CONV_STRING(SR__VALUE__TYPES__IDENTITYREF, identityref_val),
+    [SR_INSTANCEID_T]         = SR_VAL_CONV_STRING(SR__VALUE__TYPES__INSTANCEID, instanceid_val),
+    [SR_INT8_T]               = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__INT8, int8_val),
+    [SR_INT16_T]              = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__INT16, int16_val),
+    [SR_INT32_T]              = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__INT32, int32_val),
+    [SR_INT64_T]              = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__INT64, int64_val),
+    [SR_STRING_T]             = SR_VAL_CONV_STRING(SR__VALUE__TYPES__STRING, string_val),
+    [SR_UINT8_T]              = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__UINT8, uint8_val),
+    [SR_UINT16_T]             = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__UINT16, uint16_val),
+    [SR_UINT32_T]             = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__UINT32, uint32_val),
+    [SR_UINT64_T]             = SR_VAL_CONV_SCALAR(SR__VALUE__TYPES__UINT64, uint64_val),
+};
+
+/**
+ * @brief Types of sr_val_t indexed by GPB value type (SR_UNKNOWN_T if the type can not be converted).
+ */
+static const sr_type_t sr_gpb_val_type[] = {
+    [SR__VALUE__TYPES__LIST]               = SR_LIST_T,
+    [SR__VALUE__TYPES__CONTAINER]          = SR_CONTAINER_T,
+    [SR__VALUE__TYPES__CONTAINER_PRESENCE] = SR_CONTAINER_PRESENCE_T,
+    [SR__VALUE__TYPES__LEAF_EMPTY]         = SR_LEAF_EMPTY_T,
+    [SR__VALUE__TYPES__BINARY]             = SR_BINARY_T,
+    [SR__VALUE__TYPES__BITS]               = SR_BITS_T,
+    [SR__VALUE__TYPES__BOOL]               = SR_BOOL_T,
+    [SR__VALUE__TYPES__DECIMAL64]          = SR_DECIMAL64_T,
+    [SR__VALUE__TYPES__ENUM]               = SR_ENUM_T,
+    [SR__VALUE__TYPES__IDENTITYREF]        = SR_IDENTITYREF_T,
+    [SR__VALUE__TYPES__INSTANCEID]         = SR_INSTANCEID_T,
+    [SR__VALUE__TYPES__INT8]               = SR_INT8_T,
+    [SR__VALUE__TYPES__INT16]              = SR_INT16_T,
+    [SR__VALUE__TYPES__INT32]              = SR_INT32_T,
+    [SR__VALUE__TYPES__INT64]              = SR_INT64_T,
+    [SR__VALUE__TYPES__STRING]             = SR_STRING_T,
+    [SR__VALUE__TYPES__UINT8]              = SR_UINT8_T,
+    [SR__VALUE__TYPES__UINT16]             = SR_UINT16_T,
+    [SR__VALUE__TYPES__UINT32]             = SR_UINT32_T,
+    [SR__VALUE__TYPES__UINT64]             = SR_UINT64_T,
+};
+
+/**
+ * @brief Returns conversion of a sr_val_t type, NULL if the type can not be converted into GPB.
+ */
+static const sr_val_conv_t *
+sr_val_conv_get(sr_type_t type)
+{
+    if ((size_t) type >= sizeof(sr_val_conv) / sizeof(*sr_val_conv) || 0 == sr_val_conv[type].gpb_type) {
+        return NULL;
+    }
+    return &sr_val_conv[type];
+}
+
+/**
+ * @brief Returns sr_val_t type of a GPB value type, SR_UNKNOWN_T if the type can not be converted.
+ */
+static sr_type_t
+sr_gpb_val_type_get(Sr__Value__Types gpb_type)
+{
+    if ((size_t) gpb_type >= sizeof(sr_gpb_val_type) / sizeof(*sr_gpb_val_type)) {
+        return SR_UNKNOWN_T;
+    }
+    return sr_gpb_val_type[gpb_type];
+}
+
+/**
+ * @brief Returns pointer to the string data field of a GPB value.
+ */
+#define SR_VAL_CONV_GPB_STR(GPB_VALUE, CONV) ((char **) ((uint8_t *) (GPB_VALUE) + (CONV)->gpb_str_offset))
+
 static int
 sr_set_val_t_type_in_gpb(const sr_val_t *value, Sr__Value *gpb_value){
     CHECK_NULL_ARG2(value, gpb_value);
-    int rc = SR_ERR_OK;
-    switch (value->type) {
-    case SR_LIST_T:
-        gpb_value->type = SR__VALUE__TYPES__LIST;
-        break;
-    case SR_CONTAINER_T:
-        gpb_value->type = SR__VALUE__TYPES__CONTAINER;
-        break;
-    case SR_CONTAINER_PRESENCE_T:
-        gpb_value->type = SR__VALUE__TYPES__CONTAINER_PRESENCE;
-        break;
-    case SR_LEAF_EMPTY_T:
-        gpb_value->type = SR__VALUE__TYPES__LEAF_EMPTY;
-        break;
-    case SR_BINARY_T:
-        gpb_value->type = SR__VALUE__TYPES__BINARY;
-        break;
-    case SR_BITS_T:
-        gpb_value->type = SR__VALUE__TYPES__BITS;
-        break;
-    case SR_BOOL_T:
-        gpb_value->type = SR__VALUE__TYPES__BOOL;
-        break;
-    case SR_DECIMAL64_T:
-        gpb_value->type = SR__VALUE__TYPES__DECIMAL64;
-        break;
-    case SR_ENUM_T:
-        gpb_value->type = SR__VALUE__TYPES__ENUM;
-        break;
-    case SR_IDENTITYREF_T:
-        gpb_value->type = SR__VALUE__TYPES__IDENTITYREF;
-        break;
-    case SR_INSTANCEID_T:
-        gpb_value->type = SR__VALUE__TYPES__INSTANCEID;
-        break;
-    case SR_INT8_T:
-        gpb_value->type = SR__VALUE__TYPES__INT8;
-        break;
-    case SR_INT16_T:
-        gpb_value->type = SR__VALUE__TYPES__INT16;
-        break;
-    case SR_INT32_T:
-        gpb_value->type = SR__VALUE__TYPES__INT32;
-        break;
-    case SR_INT64_T:
-        gpb_value->type = SR__VALUE__TYPES__INT64;
-        break;
-    case SR_STRING_T:
-        gpb_value->type = SR__VALUE__TYPES__STRING;
-        break;
-    case SR_UINT8_T:
-        gpb_value->type = SR__VALUE__TYPES__UINT8;
-        break;
-    case SR_UINT16_T:
-        gpb_value->type = SR__VALUE__TYPES__UINT16;
-        break;
-    case SR_UINT32_T:
-        gpb_value->type = SR__VALUE__TYPES__UINT32;
-        break;
-    case SR_UINT64_T:
-        gpb_value->type = SR__VALUE__TYPES__UINT64;
-        break;
+    const sr_val_conv_t *conv = sr_val_conv_get(value->type);
 
-    default:
+    if (NULL == conv) {
         SR_LOG_ERR("Type can not be mapped to gpb type '%s' type %d", value->xpath, value->type);
         return SR_ERR_INTERNAL;
     }
+    gpb_value->type = conv->gpb_type;
 
-    return rc;
+    return SR_ERR_OK;
 }
 
 /**
- * @brief Copies data from sr_val_t to GPB message. Makes shallow copy if the value
- * is allocated inside Sysrepo memory context, otherwise a deep copy.
+ * @brief Copies data from sr_val_t to GPB message using conversion of the value type.
+ * Makes shallow copy if the value is allocated inside Sysrepo memory context, otherwise a deep copy.
  */
 static int
-sr_set_val_t_value_in_gpb(const sr_val_t *value, Sr__Value *gpb_value){
-    CHECK_NULL_ARG2(value, gpb_value);
+sr_val_t_to_gpb_conv(const sr_val_conv_t *conv, const sr_val_t *value, Sr__Value *gpb_value)
+{
+    char **gpb_str = NULL;
 
     if (NULL != value->xpath) {
         if (value->_sr_mem) {
@@ -1131,108 +1207,38 @@ sr_set_val_t_value_in_gpb(const sr_val_t *value, Sr__Value *gpb_value){
             CHECK_NULL_NOMEM_RETURN(gpb_value->xpath);
         }
     }
-
     gpb_value->dflt = value->dflt;
-    switch (value->type) {
-    case SR_LIST_T:
-    case SR_CONTAINER_T:
-    case SR_CONTAINER_PRESENCE_T:
-    case SR_LEAF_EMPTY_T:
-        return SR_ERR_OK;
-    case SR_BINARY_T:
-        if (value->_sr_mem) {
-            gpb_value->binary_val = value->data.binary_val;
-        } else {
-            gpb_value->binary_val = strdup(value->data.binary_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->binary_val);
-        }
-        return SR_ERR_OK;
-    case SR_BITS_T:
-        if (value->_sr_mem) {
-            gpb_value->bits_val = value->data.bits_val;
-        } else {
-            gpb_value->bits_val = strdup(value->data.bits_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->bits_val);
-        }
-        return SR_ERR_OK;
-    case SR_BOOL_T:
-        gpb_value->bool_val = value->data.bool_val;
-        gpb_value->has_bool_val = true;
-        return SR_ERR_OK;
-    case SR_DECIMAL64_T:
-        gpb_value->decimal64_val = value->data.decimal64_val;
-        gpb_value->has_decimal64_val = true;
-        return SR_ERR_OK;
-    case SR_ENUM_T:
-        if (value->_sr_mem) {
-            gpb_value->enum_val = value->data.enum_val;
-        } else {
-            gpb_value->enum_val = strdup(value->data.enum_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->enum_val);
-        }
-        return SR_ERR_OK;
-    case SR_IDENTITYREF_T:
-        if (value->_sr_mem) {
-            gpb_value->identityref_val = value->data.identityref_val;
-        } else {
-            gpb_value->identityref_val = strdup(value->data.identityref_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->identityref_val);
-        }
-        return SR_ERR_OK;
-    case SR_INSTANCEID_T:
-        if (value->_sr_mem) {
-            gpb_value->instanceid_val = value->data.instanceid_val;
-        } else {
-            gpb_value->instanceid_val = strdup(value->data.instanceid_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->instanceid_val);
-        }
-        return SR_ERR_OK;
-    case SR_INT8_T:
-        gpb_value->int8_val = value->data.int8_val;
-        gpb_value->has_int8_val = true;
-        break;
-    case SR_INT16_T:
-        gpb_value->int16_val = value->data.int16_val;
-        gpb_value->has_int16_val = true;
-        break;
-    case SR_INT32_T:
-        gpb_value->int32_val = value->data.int32_val;
-        gpb_value->has_int32_val = true;
-        break;
-    case SR_INT64_T:
-        gpb_value->int64_val = value->data.int64_val;
-        gpb_value->has_int64_val = true;
-        break;
-    case SR_STRING_T:
-        if (value->_sr_mem) {
-            gpb_value->string_val = value->data.string_val;
+
+    if (0 != conv->gpb_str_offset) {
+        gpb_str = SR_VAL_CONV_GPB_STR(gpb_value, conv);
+        if (value->_sr_mem || NULL == value->data.string_val) {
+            *gpb_str = value->data.string_val;
         } else {
-            gpb_value->string_val = strdup(value->data.string_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->string_val);
+            *gpb_str = strdup(value->data.string_val);
+            CHECK_NULL_NOMEM_RETURN(*gpb_str);
         }
-        return SR_ERR_OK;
-    case SR_UINT8_T:
-        gpb_value->uint8_val = value->data.uint8_val;
-        gpb_value->has_uint8_val = true;
-        break;
-    case SR_UINT16_T:
-        gpb_value->uint16_val = value->data.uint16_val;
-        gpb_value->has_uint16_val = true;
-        break;
-    case SR_UINT32_T:
-        gpb_value->uint32_val = value->data.uint32_val;
-        gpb_value->has_uint32_val = true;
-        break;
-    case SR_UINT64_T:
-        gpb_value->uint64_val = value->data.uint64_val;
-        gpb_value->has_uint64_val = true;
-        break;
-    default:
+    } else if (NULL != conv->to_gpb) {
+        conv->to_gpb(&value->data, gpb_value);
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Copies data from sr_val_t to GPB message. Makes shallow copy if the value
+ * is allocated inside Sysrepo memory context, otherwise a deep copy.
+ */
+static int
+sr_set_val_t_value_in_gpb(const sr_val_t *value, Sr__Value *gpb_value){
+    CHECK_NULL_ARG2(value, gpb_value);
+    const sr_val_conv_t *conv = sr_val_conv_get(value->type);
+
+    if (NULL == conv) {
         SR_LOG_ERR("Conversion of value type not supported '%s'", value->xpath);
         return SR_ERR_INTERNAL;
     }
 
-    return SR_ERR_OK;
+    return sr_val_t_to_gpb_conv(conv, value, gpb_value);
 }
 
 int
@@ -1240,6 +1246,7 @@ sr_dup_val_t_to_gpb(const sr_val_t *value, Sr__Value **gpb_value){
     CHECK_NULL_ARG2(value, gpb_value);
     int rc = SR_ERR_OK;
     Sr__Value *gpb;
+    const sr_val_conv_t *conv = NULL;
     sr_mem_snapshot_t snapshot = { 0, };
 
     if (value->_sr_mem) {
@@ -1251,10 +1258,15 @@ sr_dup_val_t_to_gpb(const sr_val_t *value, Sr__Value **gpb_value){
 
     sr__value__init(gpb);
 
-    rc = sr_set_val_t_type_in_gpb(value, gpb);
-    CHECK_RC_LOG_GOTO(rc, cleanup, "Setting type in gpb failed for xpath '%s'", value->xpath);
+    conv = sr_val_conv_get(value->type);
+    if (NULL == conv) {
+        SR_LOG_ERR("Type can not be mapped to gpb type '%s' type %d", value->xpath, value->type);
+        rc = SR_ERR_INTERNAL;
+        goto cleanup;
+    }
+    gpb->type = conv->gpb_type;
 
-    rc = sr_set_val_t_value_in_gpb(value, gpb);
+    rc = sr_val_t_to_gpb_conv(conv, value, gpb);
     CHECK_RC_LOG_GOTO(rc, cleanup, "Setting value in gpb failed for xpath '%s'", value->xpath);
 
     *gpb_value = gpb;
@@ -1273,83 +1285,27 @@ cleanup:
 static int
 sr_set_gpb_type_in_val_t(const Sr__Value *gpb_value, sr_val_t *value){
     CHECK_NULL_ARG2(value, gpb_value);
-    int rc = SR_ERR_OK;
-    switch (gpb_value->type) {
-    case SR__VALUE__TYPES__LIST:
-        value->type = SR_LIST_T;
-        break;
-    case SR__VALUE__TYPES__CONTAINER:
-        value->type = SR_CONTAINER_T;
-        break;
-    case SR__VALUE__TYPES__CONTAINER_PRESENCE:
-        value->type = SR_CONTAINER_PRESENCE_T;
-        break;
-    case SR__VALUE__TYPES__LEAF_EMPTY:
-        value->type = SR_LEAF_EMPTY_T;
-        break;
-    case SR__VALUE__TYPES__BINARY:
-        value->type = SR_BINARY_T;
-        break;
-    case SR__VALUE__TYPES__BITS:
-        value->type = SR_BITS_T;
-        break;
-    case SR__VALUE__TYPES__BOOL:
-        value->type = SR_BOOL_T;
-        break;
-    case SR__VALUE__TYPES__DECIMAL64:
-        value->type = SR_DECIMAL64_T;
-        break;
-    case SR__VALUE__TYPES__ENUM:
-        value->type = SR_ENUM_T;
-        break;
-    case SR__VALUE__TYPES__IDENTITYREF:
-        value->type = SR_IDENTITYREF_T;
-        break;
-    case SR__VALUE__TYPES__INSTANCEID:
-        value->type = SR_INSTANCEID_T;
-        break;
-    case SR__VALUE__TYPES__INT8:
-        value->type = SR_INT8_T;
-        break;
-    case SR__VALUE__TYPES__INT16:
-        value->type = SR_INT16_T;
-        break;
-    case SR__VALUE__TYPES__INT32:
-        value->type = SR_INT32_T;
-        break;
-    case SR__VALUE__TYPES__INT64:
-        value->type = SR_INT64_T;
-        break;
-    case SR__VALUE__TYPES__STRING:
-        value->type = SR_STRING_T;
-        break;
-    case SR__VALUE__TYPES__UINT8:
-        value->type = SR_UINT8_T;
-        break;
-    case SR__VALUE__TYPES__UINT16:
-        value->type = SR_UINT16_T;
-        break;
-    case SR__VALUE__TYPES__UINT32:
-        value->type = SR_UINT32_T;
-        break;
-    case SR__VALUE__TYPES__UINT64:
-        value->type = SR_UINT64_T;
-        break;
-    default:
+    sr_type_t type = sr_gpb_val_type_get(gpb_value->type);
+
+    if (SR_UNKNOWN_T == type) {
         SR_LOG_ERR_MSG("Type can not be mapped to sr_val_t");
         return SR_ERR_INTERNAL;
     }
+    value->type = type;
 
-    return rc;
+    return SR_ERR_OK;
 }
 
 /**
- * @brief Copies data GPB message to sr_val_t. Makes shallow copy if the value
- * (and GPB message) is allocated inside Sysrepo memory context, otherwise a deep copy.
+ * @brief Copies data GPB message to sr_val_t using conversion of the value type. Makes shallow
+ * copy if the value (and GPB message) is allocated inside Sysrepo memory context, otherwise a deep copy.
  */
 static int
-sr_set_gpb_value_in_val_t(const Sr__Value *gpb_value, sr_val_t *value){
-    CHECK_NULL_ARG3(value, gpb_value, gpb_value->xpath);
+sr_gpb_to_val_t_conv(const sr_val_conv_t *conv, const Sr__Value *gpb_value, sr_val_t *value)
+{
+    char *gpb_str = NULL;
+
+    CHECK_NULL_ARG(gpb_value->xpath);
 
     if (value->_sr_mem) {
         value->xpath = gpb_value->xpath;
@@ -1359,110 +1315,53 @@ sr_set_gpb_value_in_val_t(const Sr__Value *gpb_value, sr_val_t *value){
     }
     value->dflt = gpb_value->dflt;
 
-    switch (gpb_value->type) {
-    case SR__VALUE__TYPES__LIST:
-    case SR__VALUE__TYPES__CONTAINER:
-    case SR__VALUE__TYPES__CONTAINER_PRESENCE:
-    case SR__VALUE__TYPES__LEAF_EMPTY:
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__BINARY:
-        if (value->_sr_mem) {
-            value->data.binary_val = gpb_value->binary_val;
-        } else {
-            value->data.binary_val = strdup(gpb_value->binary_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->binary_val);
-        }
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__BITS:
-        if (value->_sr_mem) {
-            value->data.bits_val = gpb_value->bits_val;
-        } else {
-            value->data.bits_val = strdup(gpb_value->bits_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->bits_val);
-        }
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__BOOL:
-        value->data.bool_val = gpb_value->bool_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__DECIMAL64:
-        value->data.decimal64_val = gpb_value->decimal64_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__ENUM:
-        if (value->_sr_mem) {
-            value->data.enum_val = gpb_value->enum_val;
+    if (0 != conv->gpb_str_offset) {
+        gpb_str = *SR_VAL_CONV_GPB_STR(gpb_value, conv);
+        if (value->_sr_mem || NULL == gpb_str) {
+            value->data.string_val = gpb_str;
         } else {
-            value->data.enum_val = strdup(gpb_value->enum_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->enum_val);
+            value->data.string_val = strdup(gpb_str);
+            CHECK_NULL_NOMEM_RETURN(value->data.string_val);
         }
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__IDENTITYREF:
-        if (value->_sr_mem) {
-            value->data.identityref_val = gpb_value->identityref_val;
-        } else {
-            value->data.identityref_val = strdup(gpb_value->identityref_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->identityref_val);
-        }
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__INSTANCEID:
-        if (value->_sr_mem) {
-            value->data.instanceid_val = gpb_value->instanceid_val;
-        } else {
-            value->data.instanceid_val = strdup(gpb_value->instanceid_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->instanceid_val);
-        }
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__INT8:
-        value->data.int8_val = gpb_value->int8_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__INT16:
-        value->data.int16_val = gpb_value->int16_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__INT32:
-        value->data.int32_val = gpb_value->int32_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__INT64:
-        value->data.int64_val = gpb_value->int64_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__STRING:
-        if (value->_sr_mem) {
-            value->data.string_val = gpb_value->string_val;
-        } else {
-            value->data.string_val = strdup(gpb_value->string_val);
-            CHECK_NULL_NOMEM_RETURN(gpb_value->string_val);
-        }
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__UINT8:
-        value->data.uint8_val = gpb_value->uint8_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__UINT16:
-        value->data.uint16_val = gpb_value->uint16_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__UINT32:
-        value->data.uint32_val = gpb_value->uint32_val;
-        return SR_ERR_OK;
-    case SR__VALUE__TYPES__UINT64:
-        value->data.uint64_val = gpb_value->uint64_val;
-        return SR_ERR_OK;
-    default:
+    } else if (NULL != conv->from_gpb) {
+        conv->from_gpb(gpb_value, &value->data);
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Copies data GPB message to sr_val_t. Makes shallow copy if the value
+ * (and GPB message) is allocated inside Sysrepo memory context, otherwise a deep copy.
+ */
+static int
+sr_set_gpb_value_in_val_t(const Sr__Value *gpb_value, sr_val_t *value){
+    CHECK_NULL_ARG2(value, gpb_value);
+    const sr_val_conv_t *conv = sr_val_conv_get(sr_gpb_val_type_get(gpb_value->type));
+
+    if (NULL == conv) {
         SR_LOG_ERR_MSG("Copy of value failed");
         return SR_ERR_INTERNAL;
     }
-    return SR_ERR_OK;
+
+    return sr_gpb_to_val_t_conv(conv, gpb_value, value);
 }
 
 int
 sr_copy_gpb_to_val_t(const Sr__Value *gpb_value, sr_val_t *value)
 {
     CHECK_NULL_ARG2(gpb_value, value);
+    const sr_val_conv_t *conv = NULL;
     int rc = SR_ERR_INTERNAL;
 
-    rc = sr_set_gpb_type_in_val_t(gpb_value, value);
-    if (SR_ERR_OK != rc) {
+    value->type = sr_gpb_val_type_get(gpb_value->type);
+    conv = sr_val_conv_get(value->type);
+    if (NULL == conv) {
         SR_LOG_ERR_MSG("Setting type in for sr_value_t failed");
         return rc;
     }
 
-    rc = sr_set_gpb_value_in_val_t(gpb_value, value);
+    rc = sr_gpb_to_val_t_conv(conv, gpb_value, value);
     if (SR_ERR_OK != rc) {
         SR_LOG_ERR_MSG("Setting value in for sr_value_t failed");
         return rc;
@@ -1507,7 +1406,8 @@ sr_dup_gpb_to_val_t(sr_mem_ctx_t *sr_mem, const Sr__Value *gpb_value, sr_val_t *
 int
 sr_values_sr_to_gpb(const sr_val_t *sr_values, const size_t sr_value_cnt, Sr__Value ***gpb_values_p, size_t *gpb_value_cnt_p)
 {
-    Sr__Value **gpb_values = NULL;
+    Sr__Value **gpb_values = NULL, *gpb_value_arr = NULL;
+    const sr_val_conv_t *conv = NULL;
     sr_mem_ctx_t *sr_mem = NULL;
     sr_mem_snapshot_t snapshot = { 0, };
     int rc = SR_ERR_OK;
@@ -1522,9 +1422,30 @@ sr_values_sr_to_gpb(const sr_val_t *sr_values, const size_t sr_value_cnt, Sr__Va
         gpb_values = sr_calloc(sr_mem, sr_value_cnt, sizeof(*gpb_values));
         CHECK_NULL_NOMEM_RETURN(gpb_values);
 
-        for (size_t i = 0; i < sr_value_cnt; i++) {
-            rc = sr_dup_val_t_to_gpb(&sr_values[i], &gpb_values[i]);
-            CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to duplicate sr_val_t to GPB.");
+        if (NULL == sr_mem) {
+            /* each value owns its memory, since GPB values are released one by one */
+            for (size_t i = 0; i < sr_value_cnt; i++) {
+                rc = sr_dup_val_t_to_gpb(&sr_values[i], &gpb_values[i]);
+                CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to duplicate sr_val_t to GPB.");
+            }
+        } else {
+            /* the values are released together with the memory context, allocate all of them at once
+             * and convert them in one pass (strings are shared with the values) */
+            gpb_value_arr = sr_calloc(sr_mem, sr_value_cnt, sizeof(*gpb_value_arr));
+            CHECK_NULL_NOMEM_GOTO(gpb_value_arr, rc, cleanup);
+            for (size_t i = 0; i < sr_value_cnt; i++) {
+                conv = sr_val_conv_get(sr_values[i].type);
+                if (NULL == conv) {
+                    SR_LOG_ERR("Type can not be mapped to gpb type '%s' type %d", sr_values[i].xpath, sr_values[i].type);
+                    rc = SR_ERR_INTERNAL;
+                    goto cleanup;
+                }
+                gpb_values[i] = &gpb_value_arr[i];
+                sr__value__init(gpb_values[i]);
+                gpb_values[i]->type = conv->gpb_type;
+                rc = sr_val_t_to_gpb_conv(conv, &sr_values[i], gpb_values[i]);
+                CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to duplicate sr_val_t to GPB.");
+            }
         }
     }
 
@@ -1552,6 +1473,7 @@ sr_values_gpb_to_sr(sr_mem_ctx_t *sr_mem, Sr__Value **gpb_values, size_t gpb_val
         size_t *sr_value_cnt_p)
 {
     sr_val_t *sr_values = NULL;
+    const sr_val_conv_t *conv = NULL;
     sr_mem_snapshot_t snapshot = { 0, };
     int rc = SR_ERR_OK;
 
@@ -1570,7 +1492,18 @@ sr_values_gpb_to_sr(sr_mem_ctx_t *sr_mem, Sr__Value **gpb_values, size_t gpb_val
         }
 
         for (size_t i = 0; i < gpb_value_cnt; i++) {
-            rc = sr_copy_gpb_to_val_t(gpb_values[i], &sr_values[i]);
+            CHECK_NULL_ARG_NORET(rc, gpb_values[i]);
+            if (SR_ERR_OK != rc) {
+                goto cleanup;
+            }
+            sr_values[i].type = sr_gpb_val_type_get(gpb_values[i]->type);
+            conv = sr_val_conv_get(sr_values[i].type);
+            if (NULL == conv) {
+                SR_LOG_ERR_MSG("Type can not be mapped to sr_val_t");
+                rc = SR_ERR_INTERNAL;
+                goto cleanup;
+            }
+            rc = sr_gpb_to_val_t_conv(conv, gpb_values[i], &sr_values[i]);
             CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to duplicate GPB value to sr_val_t.");
         }
     }
@@ -1592,19 +1525,528 @@ cleanup:
     return rc;
 }
 
-int
-sr_dup_tree_to_gpb(const sr_node_t *sr_tree, Sr__Node **gpb_tree)
-{
-    CHECK_NULL_ARG2(sr_tree, gpb_tree);
-    int rc = SR_ERR_OK, i = 0;
-    int children_cnt = 0;
-    sr_node_t *sr_subtree = NULL;
-    Sr__Node *gpb;
-    sr_mem_snapshot_t snapshot = { 0, };
+/**
+ * @brief Column of a value block where the data of a value are stored.
+ */
+typedef enum sr_value_block_column_e {
+    SR_VALUE_BLOCK_NONE,       /**< The value has no data. */
+    SR_VALUE_BLOCK_INT,        /**< Signed integer values. */
+    SR_VALUE_BLOCK_UINT,       /**< Unsigned integer and boolean values. */
+    SR_VALUE_BLOCK_DECIMAL64,  /**< Decimal64 values. */
+    SR_VALUE_BLOCK_STR,        /**< Values of string-like types. */
+} sr_value_block_column_t;
 
-    if (sr_tree->_sr_mem) {
-        sr_mem_snapshot(sr_tree->_sr_mem, &snapshot);
-    }
+/**
+ * @brief Returns the column of a value block where the data of a value of given type are stored.
+ */
+static sr_value_block_column_t
+sr_value_block_column(sr_type_t type)
+{
+    switch (type) {
+    case SR_INT8_T:
+    case SR_INT16_T:
+    case SR_INT32_T:
+    case SR_INT64_T:
+        return SR_VALUE_BLOCK_INT;
+    case SR_BOOL_T:
+    case SR_UINT8_T:
+    case SR_UINT16_T:
+    case SR_UINT32_T:
+    case SR_UINT64_T:
+        return SR_VALUE_BLOCK_UINT;
+    case SR_DECIMAL64_T:
+        return SR_VALUE_BLOCK_DECIMAL64;
+    case SR_BINARY_T:
+    case SR_BITS_T:
+    case SR_ENUM_T:
+    case SR_IDENTITYREF_T:
+    case SR_INSTANCEID_T:
+    case SR_STRING_T:
+        return SR_VALUE_BLOCK_STR;
+    default:
+        return SR_VALUE_BLOCK_NONE;
+    }
+}
+
+/**
+ * @brief Returns pointer to the data of a value of a string-like type.
+ */
+static char **
+sr_value_block_str_data(sr_val_t *value)
+{
+    switch (value->type) {
+    case SR_BINARY_T:
+        return &value->data.binary_val;
+    case SR_BITS_T:
+        return &value->data.bits_val;
+    case SR_ENUM_T:
+        return &value->data.enum_val;
+    case SR_IDENTITYREF_T:
+        return &value->data.identityref_val;
+    case SR_INSTANCEID_T:
+        return &value->data.instanceid_val;
+    default:
+        return &value->data.string_val;
+    }
+}
+
+/**
+ * @brief Returns data of a value of a signed integer type.
+ */
+static int64_t
+sr_value_block_get_int(const sr_val_t *value)
+{
+    switch (value->type) {
+    case SR_INT8_T:
+        return value->data.int8_val;
+    case SR_INT16_T:
+        return value->data.int16_val;
+    case SR_INT32_T:
+        return value->data.int32_val;
+    default:
+        return value->data.int64_val;
+    }
+}
+
+/**
+ * @brief Sets data of a value of a signed integer type.
+ */
+static void
+sr_value_block_set_int(sr_val_t *value, int64_t int_val)
+{
+    switch (value->type) {
+    case SR_INT8_T:
+        value->data.int8_val = (int8_t) int_val;
+        break;
+    case SR_INT16_T:
+        value->data.int16_val = (int16_t) int_val;
+        break;
+    case SR_INT32_T:
+        value->data.int32_val = (int32_t) int_val;
+        break;
+    default:
+        value->data.int64_val = int_val;
+        break;
+    }
+}
+
+/**
+ * @brief Returns data of a value of an unsigned integer or boolean type.
+ */
+static uint64_t
+sr_value_block_get_uint(const sr_val_t *value)
+{
+    switch (value->type) {
+    case SR_BOOL_T:
+        return value->data.bool_val;
+    case SR_UINT8_T:
+        return value->data.uint8_val;
+    case SR_UINT16_T:
+        return value->data.uint16_val;
+    case SR_UINT32_T:
+        return value->data.uint32_val;
+    default:
+        return value->data.uint64_val;
+    }
+}
+
+/**
+ * @brief Sets data of a value of an unsigned integer or boolean type.
+ */
+static void
+sr_value_block_set_uint(sr_val_t *value, uint64_t uint_val)
+{
+    switch (value->type) {
+    case SR_BOOL_T:
+        value->data.bool_val = (0 != uint_val);
+        break;
+    case SR_UINT8_T:
+        value->data.uint8_val = (uint8_t) uint_val;
+        break;
+    case SR_UINT16_T:
+        value->data.uint16_val = (uint16_t) uint_val;
+        break;
+    case SR_UINT32_T:
+        value->data.uint32_val = (uint32_t) uint_val;
+        break;
+    default:
+        value->data.uint64_val = uint_val;
+        break;
+    }
+}
+
+/**
+ * @brief Reads the next NULL-terminated string from a concatenation of strings.
+ */
+static int
+sr_value_block_next_str(const ProtobufCBinaryData *data, size_t *pos, const char **str, size_t *len)
+{
+    const uint8_t *end = NULL;
+
+    if (NULL == data->data || *pos >= data->len) {
+        return SR_ERR_MALFORMED_MSG;
+    }
+    end = memchr(data->data + *pos, '\0', data->len - *pos);
+    if (NULL == end) {
+        return SR_ERR_MALFORMED_MSG;
+    }
+
+    *str = (const char *) data->data + *pos;
+    *len = end - (data->data + *pos);
+    *pos += *len + 1;
+    return SR_ERR_OK;
+}
+
+int
+sr_values_sr_to_gpb_block(const sr_val_t *sr_values, const size_t sr_value_cnt, Sr__ValueBlock **block_p)
+{
+    Sr__ValueBlock *block = NULL;
+    Sr__Value gpb_value = SR__VALUE__INIT;
+    sr_val_t *value = NULL;
+    sr_mem_ctx_t *sr_mem = NULL;
+    sr_mem_snapshot_t snapshot = { 0, };
+    const char *prev_xpath = "", *str = NULL;
+    size_t shared = 0, len = 0, suffixes_len = 0, strs_len = 0;
+    size_t dflt_cnt = 0, int_cnt = 0, uint_cnt = 0, decimal64_cnt = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(sr_values, block_p);
+    if (0 == sr_value_cnt) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    sr_mem = sr_values[0]._sr_mem;
+    if (NULL != sr_mem) {
+        sr_mem_snapshot(sr_mem, &snapshot);
+    }
+
+    block = sr_calloc(sr_mem, 1, sizeof(*block));
+    CHECK_NULL_NOMEM_GOTO(block, rc, cleanup);
+    sr__value_block__init(block);
+
+    block->types = sr_calloc(sr_mem, sr_value_cnt, sizeof(*block->types));
+    CHECK_NULL_NOMEM_GOTO(block->types, rc, cleanup);
+    block->n_types = sr_value_cnt;
+    block->xpath_shared = sr_calloc(sr_mem, sr_value_cnt, sizeof(*block->xpath_shared));
+    CHECK_NULL_NOMEM_GOTO(block->xpath_shared, rc, cleanup);
+    block->n_xpath_shared = sr_value_cnt;
+
+    /* types, shared xpath prefixes and sizes of the other columns */
+    for (size_t i = 0; i < sr_value_cnt; i++) {
+        value = (sr_val_t *) &sr_values[i];
+        CHECK_NULL_ARG_NORET(rc, value->xpath);
+        if (SR_ERR_OK != rc) {
+            goto cleanup;
+        }
+        rc = sr_set_val_t_type_in_gpb(value, &gpb_value);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Setting type in gpb failed for xpath '%s'", value->xpath);
+        block->types[i] = gpb_value.type;
+
+        for (shared = 0; '\0' != prev_xpath[shared] && prev_xpath[shared] == value->xpath[shared]; ++shared);
+        block->xpath_shared[i] = shared;
+        suffixes_len += strlen(value->xpath + shared) + 1;
+        prev_xpath = value->xpath;
+
+        dflt_cnt += value->dflt ? 1 : 0;
+        switch (sr_value_block_column(value->type)) {
+        case SR_VALUE_BLOCK_INT:
+            ++int_cnt;
+            break;
+        case SR_VALUE_BLOCK_UINT:
+            ++uint_cnt;
+            break;
+        case SR_VALUE_BLOCK_DECIMAL64:
+            ++decimal64_cnt;
+            break;
+        case SR_VALUE_BLOCK_STR:
+            str = *sr_value_block_str_data(value);
+            strs_len += (NULL != str ? strlen(str) : 0) + 1;
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* allocate the columns */
+    block->xpath_suffixes.data = sr_malloc(sr_mem, suffixes_len);
+    CHECK_NULL_NOMEM_GOTO(block->xpath_suffixes.data, rc, cleanup);
+    if (0 < dflt_cnt) {
+        block->dflt = sr_calloc(sr_mem, dflt_cnt, sizeof(*block->dflt));
+        CHECK_NULL_NOMEM_GOTO(block->dflt, rc, cleanup);
+    }
+    if (0 < int_cnt) {
+        block->int_vals = sr_calloc(sr_mem, int_cnt, sizeof(*block->int_vals));
+        CHECK_NULL_NOMEM_GOTO(block->int_vals, rc, cleanup);
+    }
+    if (0 < uint_cnt) {
+        block->uint_vals = sr_calloc(sr_mem, uint_cnt, sizeof(*block->uint_vals));
+        CHECK_NULL_NOMEM_GOTO(block->uint_vals, rc, cleanup);
+    }
+    if (0 < decimal64_cnt) {
+        block->decimal64_vals = sr_calloc(sr_mem, decimal64_cnt, sizeof(*block->decimal64_vals));
+        CHECK_NULL_NOMEM_GOTO(block->decimal64_vals, rc, cleanup);
+    }
+    if (0 < strs_len) {
+        block->str_vals.data = sr_malloc(sr_mem, strs_len);
+        CHECK_NULL_NOMEM_GOTO(block->str_vals.data, rc, cleanup);
+        block->has_str_vals = true;
+    }
+
+    /* fill in the columns */
+    for (size_t i = 0; i < sr_value_cnt; i++) {
+        value = (sr_val_t *) &sr_values[i];
+
+        len = strlen(value->xpath + block->xpath_shared[i]) + 1;
+        memcpy(block->xpath_suffixes.data + block->xpath_suffixes.len, value->xpath + block->xpath_shared[i], len);
+        block->xpath_suffixes.len += len;
+
+        if (value->dflt) {
+            block->dflt[block->n_dflt++] = i;
+        }
+        switch (sr_value_block_column(value->type)) {
+        case SR_VALUE_BLOCK_INT:
+            block->int_vals[block->n_int_vals++] = sr_value_block_get_int(value);
+            break;
+        case SR_VALUE_BLOCK_UINT:
+            block->uint_vals[block->n_uint_vals++] = sr_value_block_get_uint(value);
+            break;
+        case SR_VALUE_BLOCK_DECIMAL64:
+            block->decimal64_vals[block->n_decimal64_vals++] = value->data.decimal64_val;
+            break;
+        case SR_VALUE_BLOCK_STR:
+            str = *sr_value_block_str_data(value);
+            len = (NULL != str ? strlen(str) : 0) + 1;
+            memcpy(block->str_vals.data + block->str_vals.len, NULL != str ? str : "", len);
+            block->str_vals.len += len;
+            break;
+        default:
+            break;
+        }
+    }
+
+    *block_p = block;
+    return SR_ERR_OK;
+
+cleanup:
+    if (NULL != sr_mem) {
+        sr_mem_restore(&snapshot);
+    } else if (NULL != block) {
+        sr__value_block__free_unpacked(block, NULL);
+    }
+    return rc;
+}
+
+void
+sr_value_block_reader_init(const Sr__ValueBlock *block, sr_value_block_reader_t *reader)
+{
+    CHECK_NULL_ARG_VOID(reader);
+
+    memset(reader, 0, sizeof(*reader));
+    reader->block = block;
+}
+
+void
+sr_value_block_reader_cleanup(sr_value_block_reader_t *reader)
+{
+    if (NULL != reader) {
+        free(reader->xpath);
+        memset(reader, 0, sizeof(*reader));
+    }
+}
+
+int
+sr_value_block_copy_next(sr_value_block_reader_t *reader, sr_val_t *value)
+{
+    const Sr__ValueBlock *block = NULL;
+    Sr__Value gpb_value = SR__VALUE__INIT;
+    const char *str = NULL;
+    char *tmp = NULL;
+    size_t shared = 0, len = 0, size = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(reader, reader->block, value);
+    block = reader->block;
+
+    if (reader->index >= block->n_types) {
+        return SR_ERR_NOT_FOUND;
+    }
+    if (block->n_xpath_shared != block->n_types) {
+        SR_LOG_ERR_MSG("Malformed value block, number of xpaths does not match the number of values.");
+        return SR_ERR_MALFORMED_MSG;
+    }
+
+    /* restore the xpath from the previous one */
+    shared = block->xpath_shared[reader->index];
+    rc = sr_value_block_next_str(&block->xpath_suffixes, &reader->xpath_pos, &str, &len);
+    if (SR_ERR_OK != rc || shared > reader->xpath_len) {
+        SR_LOG_ERR("Malformed value block, invalid xpath of the value no. %zu.", reader->index);
+        return SR_ERR_MALFORMED_MSG;
+    }
+    if (reader->xpath_size < shared + len + 1) {
+        size = MAX(2 * reader->xpath_size, shared + len + 1);
+        tmp = realloc(reader->xpath, size);
+        CHECK_NULL_NOMEM_RETURN(tmp);
+        reader->xpath = tmp;
+        reader->xpath_size = size;
+    }
+    memcpy(reader->xpath + shared, str, len + 1);
+    reader->xpath_len = shared + len;
+
+    gpb_value.type = block->types[reader->index];
+    rc = sr_set_gpb_type_in_val_t(&gpb_value, value);
+    CHECK_RC_MSG_RETURN(rc, "Setting type in for sr_value_t failed");
+
+    value->xpath = sr_malloc(value->_sr_mem, reader->xpath_len + 1);
+    CHECK_NULL_NOMEM_RETURN(value->xpath);
+    memcpy(value->xpath, reader->xpath, reader->xpath_len + 1);
+
+    value->dflt = false;
+    if (reader->dflt_idx < block->n_dflt && block->dflt[reader->dflt_idx] == reader->index) {
+        value->dflt = true;
+        reader->dflt_idx++;
+    }
+
+    switch (sr_value_block_column(value->type)) {
+    case SR_VALUE_BLOCK_INT:
+        if (reader->int_idx >= block->n_int_vals) {
+            goto malformed;
+        }
+        sr_value_block_set_int(value, block->int_vals[reader->int_idx++]);
+        break;
+    case SR_VALUE_BLOCK_UINT:
+        if (reader->uint_idx >= block->n_uint_vals) {
+            goto malformed;
+        }
+        sr_value_block_set_uint(value, block->uint_vals[reader->uint_idx++]);
+        break;
+    case SR_VALUE_BLOCK_DECIMAL64:
+        if (reader->decimal64_idx >= block->n_decimal64_vals) {
+            goto malformed;
+        }
+        value->data.decimal64_val = block->decimal64_vals[reader->decimal64_idx++];
+        break;
+    case SR_VALUE_BLOCK_STR:
+        if (!block->has_str_vals || SR_ERR_OK != sr_value_block_next_str(&block->str_vals, &reader->str_pos, &str, &len)) {
+            goto malformed;
+        }
+        if (value->_sr_mem) {
+            /* the string stays in the memory context of the block */
+            *sr_value_block_str_data(value) = (char *) str;
+        } else {
+            *sr_value_block_str_data(value) = strdup(str);
+            CHECK_NULL_NOMEM_RETURN(*sr_value_block_str_data(value));
+        }
+        break;
+    default:
+        break;
+    }
+
+    reader->index++;
+    return SR_ERR_OK;
+
+malformed:
+    SR_LOG_ERR("Malformed value block, missing data of the value '%s'.", value->xpath);
+    return SR_ERR_MALFORMED_MSG;
+}
+
+int
+sr_value_block_dup_next(sr_value_block_reader_t *reader, sr_mem_ctx_t *sr_mem, sr_val_t **value)
+{
+    sr_val_t *val = NULL;
+    sr_mem_snapshot_t snapshot = { 0, };
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(reader, reader->block, value);
+
+    if (reader->index >= reader->block->n_types) {
+        return SR_ERR_NOT_FOUND;
+    }
+
+    if (sr_mem) {
+        sr_mem_snapshot(sr_mem, &snapshot);
+    }
+
+    val = sr_calloc(sr_mem, 1, sizeof(*val));
+    CHECK_NULL_NOMEM_RETURN(val);
+    val->_sr_mem = sr_mem;
+
+    rc = sr_value_block_copy_next(reader, val);
+    if (SR_ERR_OK != rc) {
+        if (sr_mem) {
+            sr_mem_restore(&snapshot);
+        } else {
+            sr_free_val(val);
+        }
+        return rc;
+    }
+
+    if (sr_mem) {
+        ++sr_mem->obj_count;
+    }
+    *value = val;
+    return rc;
+}
+
+int
+sr_values_gpb_block_to_sr(sr_mem_ctx_t *sr_mem, const Sr__ValueBlock *block, sr_val_t **sr_values_p,
+        size_t *sr_value_cnt_p)
+{
+    sr_value_block_reader_t reader = { 0, };
+    sr_val_t *sr_values = NULL;
+    sr_mem_snapshot_t snapshot = { 0, };
+    size_t value_cnt = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(block, sr_values_p, sr_value_cnt_p);
+
+    value_cnt = block->n_types;
+    if (0 < value_cnt) {
+        if (sr_mem) {
+            sr_mem_snapshot(sr_mem, &snapshot);
+        }
+        sr_values = sr_calloc(sr_mem, value_cnt, sizeof(*sr_values));
+        CHECK_NULL_NOMEM_RETURN(sr_values);
+
+        sr_value_block_reader_init(block, &reader);
+        for (size_t i = 0; i < value_cnt; i++) {
+            sr_values[i]._sr_mem = sr_mem;
+            rc = sr_value_block_copy_next(&reader, &sr_values[i]);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to decode value from GPB value block.");
+        }
+        sr_value_block_reader_cleanup(&reader);
+    }
+
+    if (sr_mem && sr_values) {
+        ++sr_mem->obj_count;
+    }
+    *sr_values_p = sr_values;
+    *sr_value_cnt_p = value_cnt;
+
+    return SR_ERR_OK;
+
+cleanup:
+    sr_value_block_reader_cleanup(&reader);
+    if (sr_mem) {
+        sr_mem_restore(&snapshot);
+    } else {
+        sr_free_values(sr_values, value_cnt);
+    }
+    return rc;
+}
+
+int
+sr_dup_tree_to_gpb(const sr_node_t *sr_tree, Sr__Node **gpb_tree)
+{
+    CHECK_NULL_ARG2(sr_tree, gpb_tree);
+    int rc = SR_ERR_OK, i = 0;
+    int children_cnt = 0;
+    sr_node_t *sr_subtree = NULL;
+    Sr__Node *gpb;
+    sr_mem_snapshot_t snapshot = { 0, };
+
+    if (sr_tree->_sr_mem) {
+        sr_mem_snapshot(sr_tree->_sr_mem, &snapshot);
+    }
 
     gpb = sr_calloc(sr_tree->_sr_mem, 1, sizeof(*gpb));
     CHECK_NULL_NOMEM_RETURN(gpb);
@@ -1838,6 +2280,169 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Builds a GPB tree from a libyang node and its descendants.
+ */
+static int
+sr_dup_node_to_gpb_internal(sr_mem_ctx_t *sr_mem, const struct lyd_node *parent, const struct lyd_node *node,
+        size_t depth, size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit,
+        Sr__Node **gpb_tree)
+{
+    Sr__Node *gpb = NULL;
+    sr_val_t value = { 0, };
+    const struct lyd_node *child = NULL;
+    size_t idx = 0, children_cnt = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(node, node->schema, gpb_tree);
+
+    gpb = sr_calloc(sr_mem, 1, sizeof(*gpb));
+    CHECK_NULL_NOMEM_RETURN(gpb);
+    sr__node__init(gpb);
+    gpb->value = sr_calloc(sr_mem, 1, sizeof(*gpb->value));
+    CHECK_NULL_NOMEM_GOTO(gpb->value, rc, cleanup);
+    sr__value__init(gpb->value);
+
+    /* type and value, strings are allocated in the memory context of the GPB tree */
+    value._sr_mem = sr_mem;
+    switch (node->schema->nodetype) {
+        case LYS_LEAF:
+        case LYS_LEAFLIST:
+            value.type = sr_libyang_leaf_get_type((const struct lyd_node_leaf_list *)node);
+            rc = sr_libyang_leaf_copy_value((const struct lyd_node_leaf_list *)node, &value);
+            CHECK_RC_LOG_GOTO(rc, cleanup, "Error returned from sr_libyang_leaf_copy_value: %s.", sr_strerror(rc));
+            break;
+        case LYS_CONTAINER:
+            value.type = ((struct lys_node_container *)node->schema)->presence != NULL ?
+                    SR_CONTAINER_PRESENCE_T : SR_CONTAINER_T;
+            break;
+        case LYS_LIST:
+            value.type = SR_LIST_T;
+            break;
+        default:
+            SR_LOG_ERR("Detected unsupported node data type (schema name: %s).", node->schema->name);
+            rc = SR_ERR_UNSUPPORTED;
+            goto cleanup;
+    }
+    value.dflt = node->dflt;
+
+    rc = sr_set_val_t_type_in_gpb(&value, gpb->value);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Setting value type in gpb tree failed for node '%s'", node->schema->name);
+    rc = sr_set_val_t_value_in_gpb(&value, gpb->value);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Setting value in gpb tree failed for node '%s'", node->schema->name);
+    if (NULL == sr_mem) {
+        /* the value has been duplicated */
+        sr_free_val_content(&value);
+        memset(&value, 0, sizeof(value));
+    }
+
+    /* node name */
+    rc = sr_mem_edit_string(sr_mem, &gpb->value->xpath, node->schema->name);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Failed to set name of the gpb node '%s'", node->schema->name);
+
+    /* module_name */
+    if (NULL == parent || lyd_node_module(parent) != lyd_node_module(node)) {
+        rc = sr_mem_edit_string(sr_mem, &gpb->module_name, lyd_node_module(node)->name);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Failed to set module of the gpb node '%s'", node->schema->name);
+    }
+
+    /* children */
+    if ((LYS_CONTAINER | LYS_LIST) & node->schema->nodetype) {
+        for (child = node->child, idx = 0; NULL != child; child = child->next, ++idx) {
+            if (sr_node_chunk_has_child(depth, idx, slice_offset, slice_width, child_limit, depth_limit)) {
+                ++children_cnt;
+            }
+        }
+    }
+    if (0 < children_cnt) {
+        gpb->children = sr_calloc(sr_mem, children_cnt, sizeof(*gpb->children));
+        CHECK_NULL_NOMEM_GOTO(gpb->children, rc, cleanup);
+        for (child = node->child, idx = 0; NULL != child; child = child->next, ++idx) {
+            if (sr_node_chunk_has_child(depth, idx, slice_offset, slice_width, child_limit, depth_limit)) {
+                rc = sr_dup_node_to_gpb_internal(sr_mem, node, child, depth + 1, slice_offset, slice_width,
+                        child_limit, depth_limit, gpb->children + gpb->n_children);
+                if (SR_ERR_OK != rc) {
+                    goto cleanup;
+                }
+                ++gpb->n_children;
+            }
+        }
+    }
+
+    *gpb_tree = gpb;
+    return rc;
+
+cleanup:
+    if (NULL == sr_mem) {
+        sr_free_val_content(&value);
+        sr__node__free_unpacked(gpb, NULL);
+    }
+    return rc;
+}
+
+int
+sr_dup_node_to_gpb(sr_mem_ctx_t *sr_mem, const struct lyd_node *node, size_t slice_offset, size_t slice_width,
+        size_t child_limit, size_t depth_limit, Sr__Node **gpb_tree)
+{
+    sr_mem_snapshot_t snapshot = { 0, };
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(node, gpb_tree);
+
+    if (sr_mem) {
+        sr_mem_snapshot(sr_mem, &snapshot);
+    }
+
+    rc = sr_dup_node_to_gpb_internal(sr_mem, NULL, node, 0, slice_offset, slice_width, child_limit, depth_limit,
+            gpb_tree);
+    if (SR_ERR_OK != rc && sr_mem) {
+        sr_mem_restore(&snapshot);
+    }
+    return rc;
+}
+
+int
+sr_nodes_to_gpb_trees(sr_mem_ctx_t *sr_mem, const struct ly_set *nodes, size_t slice_offset, size_t slice_width,
+        size_t child_limit, size_t depth_limit, Sr__Node ***gpb_trees_p, size_t *gpb_tree_cnt_p)
+{
+    Sr__Node **gpb_trees = NULL;
+    sr_mem_snapshot_t snapshot = { 0, };
+    size_t i = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(nodes, gpb_trees_p, gpb_tree_cnt_p);
+
+    if (0 < nodes->number) {
+        if (sr_mem) {
+            sr_mem_snapshot(sr_mem, &snapshot);
+        }
+        gpb_trees = sr_calloc(sr_mem, nodes->number, sizeof(*gpb_trees));
+        CHECK_NULL_NOMEM_RETURN(gpb_trees);
+
+        for (i = 0; i < nodes->number; ++i) {
+            rc = sr_dup_node_to_gpb_internal(sr_mem, NULL, nodes->set.d[i], 0, slice_offset, slice_width,
+                    child_limit, depth_limit, &gpb_trees[i]);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to build GPB tree from libyang node.");
+        }
+    }
+
+    *gpb_trees_p = gpb_trees;
+    *gpb_tree_cnt_p = nodes->number;
+
+    return SR_ERR_OK;
+
+cleanup:
+    if (sr_mem) {
+        sr_mem_restore(&snapshot);
+    } else {
+        for (size_t j = 0; j < i; ++j) {
+            sr__node__free_unpacked(gpb_trees[j], NULL);
+        }
+        free(gpb_trees);
+    }
+    return rc;
+}
+
 int
 sr_changes_sr_to_gpb(sr_list_t *sr_changes, sr_mem_ctx_t *sr_mem, Sr__Change ***gpb_changes_p, size_t *gpb_count)
 {
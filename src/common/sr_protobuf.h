@@ -178,6 +178,89 @@ int sr_values_sr_to_gpb(const sr_val_t *sr_values, const size_t sr_value_cnt, Sr
 int sr_values_gpb_to_sr(sr_mem_ctx_t *sr_mem, Sr__Value **gpb_values, size_t gpb_value_cnt, sr_val_t **sr_values,
         size_t *sr_value_cnt);
 
+/**
+ * @brief State of sequential decoding of values from a GPB value block.
+ */
+typedef struct sr_value_block_reader_s {
+    const Sr__ValueBlock *block;  /**< Value block being decoded. */
+    size_t index;                 /**< Index of the next value to be decoded. */
+    size_t xpath_pos;             /**< Offset of the next xpath suffix. */
+    size_t str_pos;               /**< Offset of the next string value. */
+    size_t dflt_idx;              /**< Index of the next default value index. */
+    size_t int_idx;               /**< Index of the next signed integer value. */
+    size_t uint_idx;              /**< Index of the next unsigned integer value. */
+    size_t decimal64_idx;         /**< Index of the next decimal64 value. */
+    char *xpath;                  /**< Xpath of the last decoded value. */
+    size_t xpath_len;             /**< Length of the xpath of the last decoded value. */
+    size_t xpath_size;            /**< Allocated size of the xpath buffer. */
+} sr_value_block_reader_t;
+
+/**
+ * @brief Encodes values from sysrepo values array into a GPB value block. Xpaths of the values
+ * are front-coded, which pays off mainly for list instances and siblings returned next to each other.
+ * The block is allocated in the memory context of the values (if any).
+ *
+ * @param[in] sr_values Array of sysrepo values.
+ * @param[in] sr_value_cnt Number of values in the input array (greater than 0).
+ * @param[out] block GPB value block.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_values_sr_to_gpb_block(const sr_val_t *sr_values, const size_t sr_value_cnt, Sr__ValueBlock **block);
+
+/**
+ * @brief Initializes sequential decoding of a GPB value block.
+ *
+ * @param[in] block GPB value block, must not be freed until the decoding is finished.
+ * @param[out] reader Reader to initialize, to be cleaned up by ::sr_value_block_reader_cleanup.
+ */
+void sr_value_block_reader_init(const Sr__ValueBlock *block, sr_value_block_reader_t *reader);
+
+/**
+ * @brief Cleans up the reader of a GPB value block.
+ *
+ * @param[in] reader Reader of a value block.
+ */
+void sr_value_block_reader_cleanup(sr_value_block_reader_t *reader);
+
+/**
+ * @brief Decodes the next value from a GPB value block into a sysrepo value. String values
+ * reference the memory of the block if the value is allocated in a Sysrepo memory context
+ * (which must be the context of the block), otherwise they are duplicated.
+ *
+ * @param[in] reader Reader of a value block.
+ * @param[in] value Value to fill.
+ *
+ * @return Error code (SR_ERR_OK on success, SR_ERR_NOT_FOUND if there are no more values).
+ */
+int sr_value_block_copy_next(sr_value_block_reader_t *reader, sr_val_t *value);
+
+/**
+ * @brief Allocates a sysrepo value and decodes the next value from a GPB value block into it.
+ *
+ * @param[in] reader Reader of a value block.
+ * @param[in] sr_mem Sysrepo memory context of the block to use for memory allocation.
+ *                   If NULL then the standard malloc/calloc are used.
+ * @param[out] value Decoded value.
+ *
+ * @return Error code (SR_ERR_OK on success, SR_ERR_NOT_FOUND if there are no more values).
+ */
+int sr_value_block_dup_next(sr_value_block_reader_t *reader, sr_mem_ctx_t *sr_mem, sr_val_t **value);
+
+/**
+ * @brief Decodes all values from a GPB value block into sysrepo values array.
+ *
+ * @param[in] sr_mem Sysrepo memory context of the block to use for memory allocation.
+ *                   If NULL then the standard malloc/calloc are used.
+ * @param[in] block GPB value block.
+ * @param[out] sr_values Array of sysrepo values.
+ * @param[out] sr_value_cnt Number of values in the output array.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_values_gpb_block_to_sr(sr_mem_ctx_t *sr_mem, const Sr__ValueBlock *block, sr_val_t **sr_values,
+        size_t *sr_value_cnt);
+
 /**
  * @brief Allocates and copies tree data from the sysrepo tree-representation (based on sr_node_t) into
  * the GPB tree-representation (based on Sr__Node).
@@ -234,6 +317,43 @@ int sr_trees_sr_to_gpb(const sr_node_t *sr_trees, const size_t sr_tree_cnt, Sr__
  */
 int sr_trees_gpb_to_sr(sr_mem_ctx_t *sr_mem, Sr__Node **gpb_trees, size_t gpb_tree_cnt, sr_node_t **sr_trees, size_t *sr_tree_cnt);
 
+/**
+ * @brief Builds a GPB tree (based on Sr__Node) directly from a libyang node and its descendants,
+ * without the intermediate sysrepo tree-representation. The chunk limits are applied the same way
+ * as by ::sr_copy_node_to_tree_chunk, use (0, SIZE_MAX, SIZE_MAX, SIZE_MAX) to build the whole subtree.
+ *
+ * @param [in] sr_mem Sysrepo memory context to use for memory allocation.
+ *                    If NULL then the standard malloc/calloc are used.
+ * @param [in] node libyang node.
+ * @param [in] slice_offset Number of child nodes of the chunk root to skip.
+ * @param [in] slice_width Maximum number of child nodes of the chunk root to include.
+ * @param [in] child_limit Limit on the number of copied children imposed on each node starting from the 3rd level.
+ * @param [in] depth_limit Maximum number of tree levels to copy.
+ * @param [out] gpb_tree GPB tree.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_dup_node_to_gpb(sr_mem_ctx_t *sr_mem, const struct lyd_node *node, size_t slice_offset, size_t slice_width,
+        size_t child_limit, size_t depth_limit, Sr__Node **gpb_tree);
+
+/**
+ * @brief Builds an array of GPB trees directly from a set of libyang nodes, see ::sr_dup_node_to_gpb.
+ *
+ * @param [in] sr_mem Sysrepo memory context to use for memory allocation.
+ *                    If NULL then the standard malloc/calloc are used.
+ * @param [in] nodes A set of libyang nodes.
+ * @param [in] slice_offset Number of child nodes of each chunk root to skip.
+ * @param [in] slice_width Maximum number of child nodes of each chunk root to include.
+ * @param [in] child_limit Limit on the number of copied children imposed on each node starting from the 3rd level.
+ * @param [in] depth_limit Maximum number of tree levels to copy.
+ * @param [out] gpb_trees Array of GPB trees.
+ * @param [out] gpb_tree_cnt Number of GPB trees as returned in gpb_trees.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int sr_nodes_to_gpb_trees(sr_mem_ctx_t *sr_mem, const struct ly_set *nodes, size_t slice_offset, size_t slice_width,
+        size_t child_limit, size_t depth_limit, Sr__Node ***gpb_trees, size_t *gpb_tree_cnt);
+
 /**
  * @brief Fills the gpb structures from the set of changes
  * @param [in] sr_changes
@@ -96,6 +96,23 @@ sr_str_begins_with(const char *str, const char *prefix)
     return *prefix == '\0';
 }
 
+uint32_t
+sr_str_hash(const char *str)
+{
+    uint32_t hash = 2166136261u;
+
+    if (NULL == str) {
+        return 0;
+    }
+
+    while (*str) {
+        hash ^= (uint8_t) *str++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
 int
 sr_str_join(const char *str1, const char *str2, char **result)
 {
@@ -159,6 +176,18 @@ sr_copy_first_ns(const char *xpath, char **namespace)
     return SR_ERR_OK;
 }
 
+int
+sr_intern_first_ns(const char *xpath, const char **namespace)
+{
+    CHECK_NULL_ARG2(xpath, namespace);
+
+    char *colon_pos = strchr(xpath, ':');
+    if (xpath[0] != '/' || NULL == colon_pos) {
+        return SR_ERR_INVAL_ARG;
+    }
+    return sr_str_intern_len(xpath + 1, (colon_pos - xpath - 1), namespace);
+}
+
 int
 sr_copy_first_ns_from_expr(const char *expr, char*** namespaces_p, size_t *namespace_cnt_p)
 {
@@ -1388,10 +1417,7 @@ sr_copy_node_to_tree_internal(const struct lyd_node *parent, const struct lyd_no
         child = node->child;
         idx = 0;
         while (child) {
-            if ((0 < depth || slice_offset <= idx) /* slice_offset */ &&
-                (0 < depth || slice_width > idx - slice_offset) /* slice width */ &&
-                (0 == depth || child_limit > idx) /* child_limit */ &&
-                (depth_limit > depth + 1) /* depth limit */) {
+            if (sr_node_chunk_has_child(depth, idx, slice_offset, slice_width, child_limit, depth_limit)) {
                 rc = sr_node_add_child(sr_tree, NULL, NULL, &sr_subtree);
                 if (SR_ERR_OK != rc) {
                     goto cleanup;
@@ -1414,6 +1440,16 @@ cleanup:
     return rc;
 }
 
+bool
+sr_node_chunk_has_child(size_t depth, size_t idx, size_t slice_offset, size_t slice_width, size_t child_limit,
+        size_t depth_limit)
+{
+    return (0 < depth || slice_offset <= idx) /* slice_offset */ &&
+           (0 < depth || slice_width > idx - slice_offset) /* slice width */ &&
+           (0 == depth || child_limit > idx) /* child_limit */ &&
+           (depth_limit > depth + 1) /* depth limit */;
+}
+
 int
 sr_copy_node_to_tree(const struct lyd_node *node, sr_node_t *sr_tree)
 {
@@ -2142,6 +2178,22 @@ sr_clock_get_time(clockid_t clock_id, struct timespec *ts)
 #endif
 }
 
+uint64_t
+sr_clock_elapsed_us(const struct timespec *since)
+{
+    struct timespec now = {0,};
+
+    if (NULL == since) {
+        return 0;
+    }
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec < since->tv_sec || (now.tv_sec == since->tv_sec && now.tv_nsec < since->tv_nsec)) {
+        return 0;
+    }
+    return (uint64_t)(now.tv_sec - since->tv_sec) * 1000000 + (now.tv_nsec - since->tv_nsec) / 1000;
+}
+
 struct lys_node *
 sr_find_schema_node(const struct lys_node *node, const char *expr, int options)
 {
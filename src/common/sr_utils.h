@@ -124,6 +124,13 @@ bool sr_str_ends_with(const char *str, const char *suffix);
  */
 bool sr_str_begins_with(const char *str, const char *prefix);
 
+/**
+ * @brief Computes a hash of the string (FNV-1a), usable for hash indexes of string keys.
+ * @param [in] str
+ * @return Hash of the string (0 for NULL)
+ */
+uint32_t sr_str_hash(const char *str);
+
 /**
  * @brief concatenates two string into newly allocated one.
  * @param [in] str1
@@ -157,6 +164,15 @@ void sr_str_trim(char *str);
  */
 int sr_copy_first_ns(const char *xpath, char **namespace);
 
+/**
+ * @brief Interns the first namespace of the xpath (see ::sr_copy_first_ns). Does not allocate
+ * any memory if the namespace is already interned.
+ * @param [in] xpath
+ * @param [out] namespace Interned namespace, to be released by ::sr_str_release.
+ * @return Error code (SR_ERR_OK on success)
+ */
+int sr_intern_first_ns(const char *xpath, const char **namespace);
+
 /**
  * @brief Returns an allocated C-array of all top-most namespaces found in the given expression.
  *
@@ -400,6 +416,19 @@ int sr_copy_node_to_tree(const struct lyd_node *node, sr_node_t *sr_tree);
 int sr_copy_node_to_tree_chunk(const struct lyd_node *node, size_t slice_offset, size_t slice_width, size_t child_limit,
         size_t depth_limit, sr_node_t *sr_tree);
 
+/**
+ * @brief Tests if a child of a node is included in a subtree chunk (see ::sr_copy_node_to_tree_chunk).
+ *
+ * @param [in] depth Depth of the parent node in the chunk (0 for the chunk root).
+ * @param [in] idx Index of the child among the children of the parent.
+ * @param [in] slice_offset Number of child nodes of the chunk root to skip.
+ * @param [in] slice_width Maximum number of child nodes of the chunk root to include.
+ * @param [in] child_limit Limit on the number of children of each node starting from the 3rd level.
+ * @param [in] depth_limit Maximum number of tree levels of the chunk.
+ */
+bool sr_node_chunk_has_child(size_t depth, size_t idx, size_t slice_offset, size_t slice_width, size_t child_limit,
+        size_t depth_limit);
+
 /**
  * @brief Convert a set of libyang nodes into an array of sysrepo trees. For each node a corresponding
  * sysrepo (sub)tree is constructed. It is assumed that the input nodes are not descendands and predecessors
@@ -547,6 +576,15 @@ void sr_daemonize_signal_success(pid_t parent_pid);
  */
 int sr_clock_get_time(clockid_t clock_id, struct timespec *ts);
 
+/**
+ * @brief Returns time elapsed since the provided time of the monotonic clock.
+ *
+ * @param [in] since Time acquired by ::sr_clock_get_time with CLOCK_MONOTONIC.
+ *
+ * @return Elapsed time in microseconds.
+ */
+uint64_t sr_clock_elapsed_us(const struct timespec *since);
+
 /**
  * @brief Sets correct permissions on provided socket directory according to the
  * data access permission of the YANG module.
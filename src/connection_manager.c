@@ -37,15 +37,16 @@
 #include "sr_common.h"
 #include "cm_session_manager.h"
 #include "request_processor.h"
+#include "rp_stats.h"
 #include "connection_manager.h"
 
 #define CM_IN_BUFF_MIN_SPACE 512  /**< Minimal empty space in the input buffer. */
 #define CM_BUFF_ALLOC_CHUNK 1024  /**< Chunk size for buffer expansions. */
 
-#define CM_INIT_MSG_QUEUE_SIZE 10      /**< Initial size of the message queue. */
-#define CM_INIT_SESS_REQ_QUEUE_SIZE 2  /**< Initial size of the request queue buffer. */
+#define CM_MSG_QUEUE_SIZE 1024         /**< Capacity of the lock-free part of the message queue. */
+#define CM_SESS_REQ_QUEUE_SIZE 4       /**< Capacity of the lock-free part of the session request queue. */
 
-#define CM_MAX_SIGNAL_WATCHERS 2  /**< Maximum number of signals that Connection Manager can watch for. */
+#define CM_MAX_SIGNAL_WATCHERS 4  /**< Maximum number of signals that Connection Manager can watch for. */
 
 #define CM_SUBSCRIBER_DISCONNECT_TIMEOUT 1  /**< Timeout (in seconds) to wait after disconnection of a subscriber
                                                  before removing of the subscription. */
@@ -67,10 +68,13 @@ typedef struct cm_ctx_s {
     /** Socket descriptor used to listen & accept new unix-domain connections. */
     int listen_socket_fd;
 
-    /** Queue of messages to be sent to their recipients. */
-    sr_cbuff_t *msg_queue;
-    /** Message queue mutex. */
-    pthread_mutex_t msg_queue_mutex;
+    /** Queue of messages to be sent to their recipients (lock-free, filled by any thread, drained by the event loop). */
+    sr_ring_t *msg_queue;
+
+    /** Linked-list of connection-related data of all connections (used for reporting of the buffer sizes). */
+    sr_llist_t *connections;
+    /** Mutex guarding the list of connections and the sizes of their buffers. */
+    pthread_mutex_t connections_lock;
 
     /** Queue of requests to be sent to the Request Processor after some timeout. */
     sr_cbuff_t *delayed_requests_queue;
@@ -109,7 +113,7 @@ typedef struct cm_buffer_s {
  */
 typedef struct cm_session_ctx_s {
     uint32_t rp_req_cnt;           /**< Number of session-related outstanding requests in Request Processor. */
-    sr_cbuff_t *rp_request_queue;  /**< Queue of requests waiting for forwarding to Request Processor. */
+    sr_ring_t *rp_request_queue;   /**< Queue of requests waiting for forwarding to Request Processor. */
     uint32_t rp_resp_expected;     /**< Number of expected session-related responses to be forwarded to Request Processor. */
     rp_session_t *rp_session;      /**< Request Processor's session context. */
     bool stop_requested;           /**< Session-stop requested, but there are still some outstanding requests in RP.
@@ -121,6 +125,8 @@ typedef struct cm_session_ctx_s {
  */
 typedef struct cm_connection_ctx_s {
     cm_ctx_t *cm_ctx;      /**< Connection Manager context related to this connection. */
+    int fd;                /**< File descriptor of the connection. */
+    sr_llist_node_t *ll_node;  /**< Node of the connection in the list of connections of the Connection Manager. */
     cm_buffer_t in_buff;   /**< Input buffer. If not empty, there is some received data to be processed. */
     cm_buffer_t out_buff;  /**< Output buffer. If not empty, there is some data to be sent when receiver is ready. */
     ev_io read_watcher;    /**< Watcher for readable events on connection's socket. */
@@ -234,10 +240,10 @@ cm_session_data_cleanup(void *session)
     Sr__Msg *msg = NULL;
     sm_session_t *sm_session = (sm_session_t*)session;
     if ((NULL != sm_session) && (NULL != sm_session->cm_data)) {
-        while (sr_cbuff_dequeue(sm_session->cm_data->rp_request_queue, &msg)) {
+        while (sr_ring_dequeue(sm_session->cm_data->rp_request_queue, &msg)) {
             sr_msg_free(msg);
         }
-        sr_cbuff_cleanup(sm_session->cm_data->rp_request_queue);
+        sr_ring_cleanup(sm_session->cm_data->rp_request_queue);
         free(sm_session->cm_data);
         sm_session->cm_data = NULL;
     }
@@ -250,7 +256,14 @@ static void
 cm_connection_data_cleanup(void *connection)
 {
     sm_connection_t *sm_connection = (sm_connection_t*)connection;
+    cm_ctx_t *cm_ctx = NULL;
     if ((NULL != sm_connection) && (NULL != sm_connection->cm_data)) {
+        cm_ctx = sm_connection->cm_data->cm_ctx;
+        if (NULL != sm_connection->cm_data->ll_node) {
+            pthread_mutex_lock(&cm_ctx->connections_lock);
+            sr_llist_rm(cm_ctx->connections, sm_connection->cm_data->ll_node);
+            pthread_mutex_unlock(&cm_ctx->connections_lock);
+        }
         free(sm_connection->cm_data->in_buff.data);
         free(sm_connection->cm_data->out_buff.data);
         free(sm_connection->cm_data);
@@ -451,6 +464,7 @@ cm_conn_close(cm_ctx_t *cm_ctx, sm_connection_t *conn)
 
     /* cleanup connection, pointers to the connection from outstanding sessions will be set to NULL */
     sm_connection_stop(cm_ctx->sm_ctx, conn);
+    rp_stats_connection(cm_ctx->rp_ctx, false);
 
     return SR_ERR_OK;
 }
@@ -472,7 +486,9 @@ cm_conn_buffer_expand(const sm_connection_t *conn, cm_buffer_t *buff, size_t req
         tmp = realloc(buff->data, buff->size + requested_space);
         if (NULL != tmp) {
             buff->data = tmp;
+            pthread_mutex_lock(&conn->cm_data->cm_ctx->connections_lock);
             buff->size += requested_space;
+            pthread_mutex_unlock(&conn->cm_data->cm_ctx->connections_lock);
             SR_LOG_DBG("%s buffer for fd=%d expanded to %zu bytes.",
                     (&conn->cm_data->in_buff == buff ? "Input" : "Output"), conn->fd, buff->size);
         } else {
@@ -610,7 +626,7 @@ cm_session_start_internal(cm_ctx_t *cm_ctx, sm_connection_t *conn, const char *e
 
     /* initialize session request queue */
     if (SR_ERR_OK == rc) {
-        rc = sr_cbuff_init(CM_INIT_SESS_REQ_QUEUE_SIZE, sizeof(Sr__Msg*), &session->cm_data->rp_request_queue);
+        rc = sr_ring_init(CM_SESS_REQ_QUEUE_SIZE, sizeof(Sr__Msg*), SR_RING_SPSC, &session->cm_data->rp_request_queue);
         if (SR_ERR_OK != rc) {
             SR_LOG_ERR("Cannot initialize session request queue (session id=%"PRIu32").", session->id);
             rc = SR_ERR_NOMEM;
@@ -807,7 +823,7 @@ cm_req_process(cm_ctx_t *cm_ctx, sm_connection_t *conn, sm_session_t *session, S
             if (session->cm_data->rp_req_cnt > 0) {
                 /* there are some outstanding requests in RP, put the message into queue */
                 SR_LOG_DBG("There are %u outstanding requests for this session, request will be processed later.", session->cm_data->rp_req_cnt);
-                rc = sr_cbuff_enqueue(session->cm_data->rp_request_queue, &msg);
+                rc = sr_ring_enqueue(session->cm_data->rp_request_queue, &msg);
                 if (SR_ERR_OK != rc) {
                     goto cleanup;
                 }
@@ -1143,6 +1159,8 @@ cm_conn_write_cb(struct ev_loop *loop, ev_io *w, int revents)
 static int
 cm_conn_watcher_init(cm_ctx_t *cm_ctx, sm_connection_t *conn)
 {
+    int rc = SR_ERR_OK;
+
     CHECK_NULL_ARG2(cm_ctx, conn);
 
     conn->cm_data = calloc(1, sizeof(*(conn->cm_data)));
@@ -1152,6 +1170,20 @@ cm_conn_watcher_init(cm_ctx_t *cm_ctx, sm_connection_t *conn)
     }
 
     conn->cm_data->cm_ctx = cm_ctx;
+    conn->cm_data->fd = conn->fd;
+
+    pthread_mutex_lock(&cm_ctx->connections_lock);
+    rc = sr_llist_add_new(cm_ctx->connections, conn->cm_data);
+    if (SR_ERR_OK == rc) {
+        conn->cm_data->ll_node = cm_ctx->connections->last;
+    }
+    pthread_mutex_unlock(&cm_ctx->connections_lock);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR_MSG("Cannot add the connection into the list of connections.");
+        free(conn->cm_data);
+        conn->cm_data = NULL;
+        return rc;
+    }
 
     ev_io_init(&conn->cm_data->read_watcher, cm_conn_read_cb, conn->fd, EV_READ);
     conn->cm_data->read_watcher.data = (void*)conn;
@@ -1199,12 +1231,14 @@ cm_server_watcher_cb(struct ev_loop *loop, ev_io *w, int revents)
                 close(clnt_fd);
                 continue;
             }
+            rp_stats_connection(cm_ctx->rp_ctx, true);
             /* check uid in case of local (library) mode */
             if (CM_MODE_LOCAL == cm_ctx->mode) {
                 if (connection->uid != geteuid()) {
                     SR_LOG_ERR("Peer's uid=%d does not match with local uid=%d "
                             "(required by local mode).", connection->uid, geteuid());
                     sm_connection_stop(cm_ctx->sm_ctx, connection);
+                    rp_stats_connection(cm_ctx->rp_ctx, false);
                     close(clnt_fd);
                     continue;
                 }
@@ -1261,6 +1295,7 @@ cm_subscr_conn_create(cm_ctx_t *cm_ctx, const char *socket_path, sm_connection_t
         rc = SR_ERR_INTERNAL;
         goto cleanup;
     }
+    rp_stats_connection(cm_ctx->rp_ctx, true);
 
     /* assign socket path as destination address */
     rc = sm_connection_assign_dst(cm_ctx->sm_ctx, connection, socket_path);
@@ -1640,7 +1675,7 @@ cm_out_msg_process(cm_ctx_t *cm_ctx, Sr__Msg *msg)
             sm_session_drop(cm_ctx->sm_ctx, session);
         } else {
             /* if there are some requests waiting for to be processed, process next one */
-            if (sr_cbuff_dequeue(session->cm_data->rp_request_queue, &msg)) {
+            if (sr_ring_dequeue(session->cm_data->rp_request_queue, &msg)) {
                 session->cm_data->rp_req_cnt += 1;
                 rc = rp_msg_process(cm_ctx->rp_ctx, session->cm_data->rp_session, msg);
                 if (SR_ERR_OK != rc) {
@@ -1670,9 +1705,7 @@ cm_msg_enqueue_cb(struct ev_loop *loop, ev_async *w, int revents)
     do {
         Sr__Msg *msg = NULL;
 
-        pthread_mutex_lock(&cm_ctx->msg_queue_mutex);
-        dequeued = sr_cbuff_dequeue(cm_ctx->msg_queue, &msg);
-        pthread_mutex_unlock(&cm_ctx->msg_queue_mutex);
+        dequeued = sr_ring_dequeue(cm_ctx->msg_queue, &msg);
 
         if (dequeued) {
             if (SR__MSG__MSG_TYPE__NOTIFICATION == msg->type) {
@@ -1788,9 +1821,16 @@ cm_init(const cm_connection_mode_t mode, const char *socket_path, cm_ctx_t **cm_
     }
     ctx->mode = mode;
 
+    /* initialize list of connections */
+    pthread_mutex_init(&ctx->connections_lock, NULL);
+    rc = sr_llist_init(&ctx->connections);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR_MSG("Cannot initialize the list of connections.");
+        goto cleanup;
+    }
+
     /* initialize message queue */
-    pthread_mutex_init(&ctx->msg_queue_mutex, NULL);
-    rc = sr_cbuff_init(CM_INIT_MSG_QUEUE_SIZE, sizeof(Sr__Msg*), &ctx->msg_queue);
+    rc = sr_ring_init(CM_MSG_QUEUE_SIZE, sizeof(Sr__Msg*), SR_RING_MPMC, &ctx->msg_queue);
     if (SR_ERR_OK != rc){
         SR_LOG_ERR_MSG("CM message queue initialization failed.");
         goto cleanup;
@@ -1871,11 +1911,10 @@ cm_cleanup(cm_ctx_t *cm_ctx)
         ev_loop_destroy(cm_ctx->event_loop);
         cm_server_cleanup(cm_ctx);
 
-        while (sr_cbuff_dequeue(cm_ctx->msg_queue, &msg)) {
+        while (sr_ring_dequeue(cm_ctx->msg_queue, &msg)) {
             sr_msg_free(msg);
         }
-        sr_cbuff_cleanup(cm_ctx->msg_queue);
-        pthread_mutex_destroy(&cm_ctx->msg_queue_mutex);
+        sr_ring_cleanup(cm_ctx->msg_queue);
 
         tmp = cm_ctx->delayed_requests;
         while (NULL != tmp) {
@@ -1885,6 +1924,10 @@ cm_cleanup(cm_ctx_t *cm_ctx)
             free(req);
         }
 
+        /* connections have been cleaned up by Session Manager */
+        sr_llist_cleanup(cm_ctx->connections);
+        pthread_mutex_destroy(&cm_ctx->connections_lock);
+
         free(cm_ctx);
     }
     SR_LOG_INF_MSG("Connection Manager successfully destroyed.");
@@ -1945,9 +1988,7 @@ cm_msg_send(cm_ctx_t *cm_ctx, Sr__Msg *msg)
         return rc;
     }
 
-    pthread_mutex_lock(&cm_ctx->msg_queue_mutex);
-    rc = sr_cbuff_enqueue(cm_ctx->msg_queue, &msg);
-    pthread_mutex_unlock(&cm_ctx->msg_queue_mutex);
+    rc = sr_ring_enqueue(cm_ctx->msg_queue, &msg);
 
     if (SR_ERR_OK == rc) {
         /* send async event to the event loop */
@@ -1985,3 +2026,43 @@ cm_get_connection_mode(cm_ctx_t *cm_ctx)
     return cm_ctx->mode;
 }
 
+size_t
+cm_get_msg_queue_depth(cm_ctx_t *cm_ctx)
+{
+    return (NULL != cm_ctx) ? sr_ring_count(cm_ctx->msg_queue) : 0;
+}
+
+int
+cm_get_connections_mem(cm_ctx_t *cm_ctx, cm_connection_mem_t **conns_p, size_t *count_p)
+{
+    cm_connection_mem_t *conns = NULL, *tmp = NULL;
+    cm_connection_ctx_t *conn = NULL;
+    sr_llist_node_t *node = NULL;
+    size_t count = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(cm_ctx, conns_p, count_p);
+
+    pthread_mutex_lock(&cm_ctx->connections_lock);
+    for (node = cm_ctx->connections->first; NULL != node; node = node->next) {
+        conn = (cm_connection_ctx_t *) node->data;
+        tmp = realloc(conns, (count + 1) * sizeof *conns);
+        CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
+        conns = tmp;
+        conns[count].fd = conn->fd;
+        conns[count].in_buff_size = conn->in_buff.size;
+        conns[count].out_buff_size = conn->out_buff.size;
+        ++count;
+    }
+
+cleanup:
+    pthread_mutex_unlock(&cm_ctx->connections_lock);
+    if (SR_ERR_OK != rc) {
+        free(conns);
+        return rc;
+    }
+    *conns_p = conns;
+    *count_p = count;
+    return rc;
+}
+
@@ -167,6 +167,39 @@ int cm_watch_signal(cm_ctx_t *cm_ctx, int signum, cm_signal_cb callback);
  */
 cm_connection_mode_t cm_get_connection_mode(cm_ctx_t *cm_ctx);
 
+/**
+ * @brief Get number of messages waiting in the message queue to be sent.
+ *
+ * @note This function is thread safe, can be called from any thread.
+ *
+ * @param[in] cm_ctx Connection Manager context.
+ *
+ * @return Number of messages in the queue.
+ */
+size_t cm_get_msg_queue_depth(cm_ctx_t *cm_ctx);
+
+/**
+ * @brief Sizes of the buffers of a connection.
+ */
+typedef struct cm_connection_mem_s {
+    int fd;                 /**< File descriptor of the connection. */
+    size_t in_buff_size;    /**< Allocated size of the input buffer (in bytes). */
+    size_t out_buff_size;   /**< Allocated size of the output buffer (in bytes). */
+} cm_connection_mem_t;
+
+/**
+ * @brief Get sizes of the buffers of all active connections.
+ *
+ * @note This function is thread safe, can be called from any thread.
+ *
+ * @param[in] cm_ctx Connection Manager context.
+ * @param[out] conns Array of buffer sizes of the connections, to be freed by the caller.
+ * @param[out] count Number of connections in the array.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int cm_get_connections_mem(cm_ctx_t *cm_ctx, cm_connection_mem_t **conns, size_t *count);
+
 /**@} cm */
 
 #endif /* SRC_CONNECTION_MANAGER_H_ */
@@ -41,6 +41,64 @@
 #include "rp_dt_edit.h"
 #include "module_dependencies.h"
 
+/** @brief Number of worker threads processing independent per-module jobs (e.g. validation) of a commit */
+#define DM_WORKER_THREAD_COUNT 4
+
+/** @brief Minimal number of jobs in a batch for which the worker threads are used, smaller batches are processed inline */
+#define DM_WORKER_MIN_BATCH_SIZE 2
+
+/** @brief Maximal number of changed subtrees tracked for a data tree, above the limit the full tree diff is used */
+#define DM_MAX_TRACKED_CHANGES 256
+
+/** @brief Initial number of items allocated for a difflist composed of the diffs of changed subtrees */
+#define DM_DIFFLIST_INITIAL_SIZE 8
+
+/** @brief Name of the file (in the internal data directory) backing the inter-process lock region */
+#define DM_LOCK_TABLE_FILENAME "sysrepo-locks"
+
+/** @brief Base name of the datastore-level lock files (relative to the internal data directory) */
+#define DM_DS_LOCK_FILENAME "/datastore"
+
+/** @brief Environment variable overriding the memory budget of the data trees of one session (in KiB) */
+#define DM_SESSION_MEM_BUDGET_ENV "SR_SESSION_MEM_BUDGET"
+
+/** @brief Environment variable overriding the memory budget of the data trees of all sessions (in KiB) */
+#define DM_GLOBAL_MEM_BUDGET_ENV "SR_GLOBAL_MEM_BUDGET"
+
+/** @brief Number of operations performed on a data tree after which its memory estimate is recomputed */
+#define DM_MEM_RECOUNT_OPERATIONS 16
+
+/**
+ * @brief Callback processing one job of a batch executed by the worker pool.
+ */
+typedef int (*dm_job_cb)(void *arg);
+
+/**
+ * @brief Batch of independent jobs submitted into the worker pool.
+ */
+typedef struct dm_job_batch_s {
+    dm_job_cb job_cb;           /**< callback to be called for each job */
+    void **args;                /**< array of job arguments */
+    int *rcs;                   /**< array of return codes of the jobs */
+    size_t count;               /**< number of jobs in the batch */
+    size_t next;                /**< index of the next job to be picked up */
+    size_t finished;            /**< number of jobs already processed */
+    sr_llist_node_t *ll_node;   /**< node of the batch in the list of pending batches, NULL once all jobs are picked up */
+} dm_job_batch_t;
+
+/**
+ * @brief Pool of worker threads used to fan out independent per-module jobs.
+ */
+typedef struct dm_worker_pool_s {
+    pthread_t threads[DM_WORKER_THREAD_COUNT];  /**< worker threads */
+    size_t thread_cnt;                          /**< number of running worker threads */
+    sr_llist_t *batches;                        /**< batches with jobs that have not been picked up yet */
+    pthread_mutex_t mutex;                      /**< mutex guarding the pool */
+    pthread_cond_t job_cv;                      /**< signals new batch or stop request to the workers */
+    pthread_cond_t done_cv;                     /**< signals finished batch to the submitters */
+    bool stop_requested;                        /**< stop of the worker threads has been requested */
+} dm_worker_pool_t;
+
 /**
  * @brief Data manager context holding loaded schemas, data trees
  * and corresponding locks
@@ -53,13 +111,20 @@ typedef struct dm_ctx_s {
     cm_connection_mode_t conn_mode;  /**< Mode in which Connection Manager operates */
     char *schema_search_dir;      /**< location where schema files are located */
     char *data_search_dir;        /**< location where data files are located */
-    sr_locking_set_t *locking_ctx;/**< lock context for lock/unlock/commit operations */
-    bool *ds_lock;                /**< Flags if the ds lock is hold by a session*/
-    pthread_mutex_t ds_lock_mutex;/**< Data store lock mutex */
-    sr_btree_t *schema_info_tree; /**< Binary tree holding information about schemas */
+    sr_lock_table_t *lock_table;  /**< lock table for lock/unlock/commit operations */
+    char **ds_lock_files;         /**< Names of the datastore-level locks (parents of the module locks) */
+    sr_omap_t *schema_info_tree;  /**< Ordered map holding information about schemas */
     pthread_rwlock_t schema_tree_lock;  /**< rwlock for access schema_info_tree */
     dm_commit_ctxs_t commit_ctxs; /**< Structure holding commit contexts and corresponding lock */
     struct timespec last_commit_time;  /**< Time of the last commit */
+    dm_worker_pool_t *worker_pool;/**< Worker threads used for parallel processing of independent modules */
+    nacm_ctx_t *nacm_ctx;         /**< NACM rules compiled into schema node permissions */
+    size_t session_mem_budget;    /**< memory budget of the data trees of one session (in bytes, 0 = unlimited) */
+    size_t global_mem_budget;     /**< memory budget of the data trees of all sessions (in bytes, 0 = unlimited) */
+    size_t mem_used;              /**< estimated memory used by the data trees of all sessions, updated atomically */
+    uint64_t mem_evictions;       /**< number of evicted session copies, updated atomically */
+    uint64_t mem_reloads;         /**< number of reloaded evicted session copies, updated atomically */
+    size_t ds_lock_count;         /**< number of held datastore locks covering all modules, updated atomically */
 } dm_ctx_t;
 
 /**
@@ -69,7 +134,7 @@ typedef struct dm_session_s {
     dm_ctx_t *dm_ctx;                   /**< dm_ctx where the session belongs to */
     sr_datastore_t datastore;           /**< datastore to which the session is tied */
     const ac_ucred_t *user_credentials; /**< credentials of the user who this session belongs to */
-    sr_btree_t **session_modules;       /**< array of binary trees holding session copies of data models for each datastore */
+    sr_omap_t **session_modules;        /**< array of ordered maps holding session copies of data models for each datastore */
     dm_sess_op_t **operations;          /**< array of list of operations performed in this session */
     size_t *oper_count;                 /**< array of number of performed operation */
     size_t *oper_size;                  /**< array of number of allocated operations */
@@ -77,6 +142,11 @@ typedef struct dm_session_s {
     char *error_xpath;                  /**< xpath of the last error if applicable */
     sr_list_t *locked_files;            /**< set of filename that are locked by this session */
     bool *holds_ds_lock;                /**< flags if the session holds ds lock*/
+    bool ds_lock_per_module[DM_DATASTORE_COUNT];  /**< flags if the ds lock is held as the locks of the individual modules
+                                                       (the user is not allowed to lock some of them) */
+    dm_mem_usage_t mem_usage;           /**< memory used by the data trees of the session as accounted by the last trim, updated atomically */
+    uint64_t access_tick;               /**< counter of data tree accesses, orders the copies for LRU eviction */
+    sr_list_t *evicted_modules[DM_DATASTORE_COUNT];  /**< schema infos of the evicted copies for each datastore */
 } dm_session_t;
 
 /**
@@ -85,8 +155,19 @@ typedef struct dm_session_s {
  */
 typedef struct dm_node_info_s {
     dm_node_state_t state;
+    nacm_node_perms_t nacm;     /**< NACM permissions compiled for the node */
 } dm_node_info_t;
 
+/**
+ * @brief Entry of the subscription index, holds the subscriptions tied to a schema node.
+ */
+typedef struct dm_subscription_index_entry_s {
+    const struct lys_node *schema;      /**< schema node identifying the entry */
+    size_t *subscriptions;              /**< indexes of the subscriptions to the schema node (in dm_model_subscription_t) */
+    size_t subscription_cnt;            /**< number of subscriptions to the schema node */
+    bool subscribed_descendant;         /**< flag whether there is a subscription to a descendant of the schema node */
+} dm_subscription_index_entry_t;
+
 /** @brief Invalid value for the commit context id, used for signaling e.g.: duplicate id */
 #define DM_COMMIT_CTX_ID_INVALID 0
 /** @brief Number of attempts to generate unique id for commit context */
@@ -103,6 +184,36 @@ typedef struct dm_node_info_s {
  */
 #define NANOSEC_THRESHOLD 10000000
 
+/**
+ * @brief Compares two subscription index entries by schema node
+ */
+static int
+dm_subscription_index_entry_cmp(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    dm_subscription_index_entry_t *entry_a = (dm_subscription_index_entry_t *) a;
+    dm_subscription_index_entry_t *entry_b = (dm_subscription_index_entry_t *) b;
+
+    if (entry_a->schema == entry_b->schema) {
+        return 0;
+    } else if ((uintptr_t) entry_a->schema < (uintptr_t) entry_b->schema) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+static void
+dm_subscription_index_entry_free(void *item)
+{
+    dm_subscription_index_entry_t *entry = (dm_subscription_index_entry_t *) item;
+    if (NULL != entry) {
+        free(entry->subscriptions);
+    }
+    free(entry);
+}
+
 /**
  * @brief Compares two data trees by module name
  */
@@ -124,6 +235,16 @@ dm_data_info_cmp(const void *a, const void *b)
     }
 }
 
+/**
+ * @brief Hashes dm_data_info_t by the name of the module.
+ */
+static uint32_t
+dm_data_info_hash(const void *item)
+{
+    assert(item);
+    return sr_str_hash(((dm_data_info_t *) item)->schema->module->name);
+}
+
 /**
  * @brief Compares two schema data info by module name
  */
@@ -145,6 +266,16 @@ dm_schema_info_cmp(const void *a, const void *b)
     }
 }
 
+/**
+ * @brief Hashes dm_schema_info_t by the name of the module.
+ */
+static uint32_t
+dm_schema_info_hash(const void *item)
+{
+    assert(item);
+    return sr_str_hash(((dm_schema_info_t *) item)->module_name);
+}
+
 /**
  * @brief Compares two schema data info by module name
  */
@@ -166,6 +297,16 @@ dm_module_subscription_cmp(const void *a, const void *b)
     }
 }
 
+/**
+ * @brief Hashes dm_model_subscription_t by the name of the module.
+ */
+static uint32_t
+dm_module_subscription_hash(const void *item)
+{
+    assert(item);
+    return sr_str_hash(((dm_model_subscription_t *) item)->schema_info->module_name);
+}
+
 /**
  * @brief Compares two commit context by id
  */
@@ -187,6 +328,198 @@ dm_c_ctx_id_cmp(const void *a, const void *b)
     }
 }
 
+/**
+ * @brief Picks up the next job of the batch. Once all jobs of the batch are picked up,
+ * the batch is removed from the list of pending batches.
+ *
+ * @note Function expects that the pool mutex is locked.
+ */
+static size_t
+dm_worker_pool_take_job(dm_worker_pool_t *pool, dm_job_batch_t *batch)
+{
+    size_t index = batch->next++;
+    if (batch->next == batch->count && NULL != batch->ll_node) {
+        sr_llist_rm(pool->batches, batch->ll_node);
+        batch->ll_node = NULL;
+    }
+    return index;
+}
+
+/**
+ * @brief Executes the job and records its result.
+ *
+ * @note Function expects that the pool mutex is locked, the mutex is released while the job is running.
+ */
+static void
+dm_worker_pool_execute_job(dm_worker_pool_t *pool, dm_job_batch_t *batch, size_t index)
+{
+    int rc = SR_ERR_OK;
+
+    pthread_mutex_unlock(&pool->mutex);
+    rc = batch->job_cb(batch->args[index]);
+    pthread_mutex_lock(&pool->mutex);
+
+    batch->rcs[index] = rc;
+    batch->finished++;
+    if (batch->finished == batch->count) {
+        pthread_cond_broadcast(&pool->done_cv);
+    }
+}
+
+/**
+ * @brief Main loop of a worker thread.
+ */
+static void *
+dm_worker_thread_execute(void *arg)
+{
+    dm_worker_pool_t *pool = (dm_worker_pool_t *) arg;
+    dm_job_batch_t *batch = NULL;
+    size_t index = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->stop_requested) {
+        if (NULL == pool->batches->first) {
+            pthread_cond_wait(&pool->job_cv, &pool->mutex);
+            continue;
+        }
+        batch = (dm_job_batch_t *) pool->batches->first->data;
+        index = dm_worker_pool_take_job(pool, batch);
+        dm_worker_pool_execute_job(pool, batch, index);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Stops the worker threads and frees the pool.
+ */
+static void
+dm_worker_pool_cleanup(dm_worker_pool_t *pool)
+{
+    if (NULL != pool) {
+        pthread_mutex_lock(&pool->mutex);
+        pool->stop_requested = true;
+        pthread_cond_broadcast(&pool->job_cv);
+        pthread_mutex_unlock(&pool->mutex);
+
+        for (size_t i = 0; i < pool->thread_cnt; i++) {
+            pthread_join(pool->threads[i], NULL);
+        }
+        sr_llist_cleanup(pool->batches);
+        pthread_mutex_destroy(&pool->mutex);
+        pthread_cond_destroy(&pool->job_cv);
+        pthread_cond_destroy(&pool->done_cv);
+        free(pool);
+    }
+}
+
+/**
+ * @brief Allocates the pool and starts the worker threads.
+ */
+static int
+dm_worker_pool_init(dm_worker_pool_t **pool_p)
+{
+    CHECK_NULL_ARG(pool_p);
+    int rc = SR_ERR_OK;
+    dm_worker_pool_t *pool = NULL;
+
+    pool = calloc(1, sizeof(*pool));
+    CHECK_NULL_NOMEM_RETURN(pool);
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->job_cv, NULL);
+    pthread_cond_init(&pool->done_cv, NULL);
+
+    rc = sr_llist_init(&pool->batches);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot initialize linked-list for worker pool batches.");
+
+    for (size_t i = 0; i < DM_WORKER_THREAD_COUNT; i++) {
+        if (0 != pthread_create(&pool->threads[i], NULL, dm_worker_thread_execute, pool)) {
+            SR_LOG_ERR("Error by creating a new DM worker thread: %s", sr_strerror_safe(errno));
+            rc = SR_ERR_INTERNAL;
+            goto cleanup;
+        }
+        pool->thread_cnt++;
+    }
+
+cleanup:
+    if (SR_ERR_OK != rc) {
+        dm_worker_pool_cleanup(pool);
+    } else {
+        *pool_p = pool;
+    }
+    return rc;
+}
+
+/**
+ * @brief Executes a batch of independent jobs and waits until all of them are finished.
+ * The calling thread participates on the processing of its batch. Small batches (or all batches
+ * if the pool is not available) are processed sequentially in the calling thread.
+ *
+ * @param [in] pool Worker pool, can be NULL.
+ * @param [in] job_cb Callback to be called for each job.
+ * @param [in] args Array of job arguments.
+ * @param [in] count Number of jobs.
+ * @return Error code (SR_ERR_OK on success), the first non-OK return code of the jobs (in the order of args)
+ */
+static int
+dm_worker_pool_run(dm_worker_pool_t *pool, dm_job_cb job_cb, void **args, size_t count)
+{
+    CHECK_NULL_ARG(job_cb);
+    int rc = SR_ERR_OK;
+    dm_job_batch_t batch = {0};
+
+    if (0 == count) {
+        return SR_ERR_OK;
+    }
+    CHECK_NULL_ARG(args);
+
+    if (NULL == pool || 0 == pool->thread_cnt || count < DM_WORKER_MIN_BATCH_SIZE) {
+        for (size_t i = 0; i < count; i++) {
+            rc = job_cb(args[i]);
+            if (SR_ERR_OK != rc) {
+                return rc;
+            }
+        }
+        return SR_ERR_OK;
+    }
+
+    batch.job_cb = job_cb;
+    batch.args = args;
+    batch.count = count;
+    batch.rcs = calloc(count, sizeof(*batch.rcs));
+    CHECK_NULL_NOMEM_RETURN(batch.rcs);
+
+    pthread_mutex_lock(&pool->mutex);
+    rc = sr_llist_add_new(pool->batches, &batch);
+    if (SR_ERR_OK != rc) {
+        pthread_mutex_unlock(&pool->mutex);
+        free(batch.rcs);
+        SR_LOG_ERR_MSG("Adding of the batch into worker pool failed");
+        return rc;
+    }
+    batch.ll_node = pool->batches->last;
+    pthread_cond_broadcast(&pool->job_cv);
+
+    while (batch.next < batch.count) {
+        dm_worker_pool_execute_job(pool, &batch, dm_worker_pool_take_job(pool, &batch));
+    }
+    while (batch.finished < batch.count) {
+        pthread_cond_wait(&pool->done_cv, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < count; i++) {
+        if (SR_ERR_OK != batch.rcs[i]) {
+            rc = batch.rcs[i];
+            break;
+        }
+    }
+    free(batch.rcs);
+    return rc;
+}
+
 static void
 dm_free_lys_private_data(const struct lys_node *node, void *private)
 {
@@ -201,6 +534,7 @@ dm_free_schema_info(void *schema_info)
     CHECK_NULL_ARG_VOID(schema_info);
     dm_schema_info_t *si = (dm_schema_info_t *) schema_info;
     free(si->module_name);
+    sr_lockstat_unregister(&si->model_lock);
     pthread_rwlock_destroy(&si->model_lock);
     pthread_mutex_destroy(&si->usage_count_mutex);
     if (NULL != si->ly_ctx) {
@@ -209,6 +543,134 @@ dm_free_schema_info(void *schema_info)
     free(si);
 }
 
+void
+dm_untrack_changes(dm_data_info_t *data_info)
+{
+    if (NULL == data_info || NULL == data_info->changed_paths) {
+        return;
+    }
+    for (size_t i = 0; i < data_info->changed_paths->count; i++) {
+        free(data_info->changed_paths->data[i]);
+    }
+    sr_list_cleanup(data_info->changed_paths);
+    data_info->changed_paths = NULL;
+}
+
+/**
+ * @brief Starts tracking of the subtrees modified by edit operations in the data tree.
+ * @param [in] data_info
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_track_changes(dm_data_info_t *data_info)
+{
+    CHECK_NULL_ARG(data_info);
+    if (NULL != data_info->changed_paths) {
+        return SR_ERR_OK;
+    }
+    return sr_list_init(&data_info->changed_paths);
+}
+
+/**
+ * @brief Copies the tracked changes from one data info to another. If the changes are not tracked
+ * in the source, the tracking is stopped in the destination as well.
+ * @param [in] from
+ * @param [in] to
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_copy_changed_paths(const dm_data_info_t *from, dm_data_info_t *to)
+{
+    CHECK_NULL_ARG2(from, to);
+    int rc = SR_ERR_OK;
+    char *path = NULL;
+
+    dm_untrack_changes(to);
+    if (NULL == from->changed_paths) {
+        return SR_ERR_OK;
+    }
+
+    rc = dm_track_changes(to);
+    CHECK_RC_MSG_RETURN(rc, "Tracking of changes failed");
+
+    for (size_t i = 0; i < from->changed_paths->count; i++) {
+        path = strdup((char *) from->changed_paths->data[i]);
+        CHECK_NULL_NOMEM_GOTO(path, rc, cleanup);
+        rc = sr_list_add(to->changed_paths, path);
+        if (SR_ERR_OK != rc) {
+            free(path);
+            goto cleanup;
+        }
+    }
+    return rc;
+
+cleanup:
+    dm_untrack_changes(to);
+    return rc;
+}
+
+/**
+ * @brief Counts the nodes of a data tree (including siblings of the root) and estimates its memory.
+ *
+ * @return Estimated memory used by the data tree (in bytes).
+ */
+static size_t
+dm_data_tree_mem_usage(const struct lyd_node *data_tree, size_t *node_cnt)
+{
+    const struct lyd_node *root = NULL, *next = NULL, *iter = NULL;
+    const struct lyd_node_leaf_list *leaf = NULL;
+    size_t size = 0, count = 0;
+
+    LY_TREE_FOR(data_tree, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            if (NULL != iter->schema && (LYS_LEAF | LYS_LEAFLIST) & iter->schema->nodetype) {
+                leaf = (const struct lyd_node_leaf_list *) iter;
+                size += sizeof *leaf + (NULL != leaf->value_str ? strlen(leaf->value_str) + 1 : 0);
+            } else {
+                size += sizeof *iter;
+            }
+            ++count;
+            LYD_TREE_DFS_END(root, next, iter);
+        }
+    }
+
+    *node_cnt = count;
+    return size;
+}
+
+/**
+ * @brief Atomically adds a data tree into (or removes it from) the memory usage.
+ */
+static void
+dm_mem_usage_update(dm_mem_usage_t *usage, size_t node_cnt, size_t mem_size, bool add)
+{
+    if (add) {
+        __atomic_add_fetch(&usage->tree_cnt, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&usage->node_cnt, node_cnt, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&usage->mem_size, mem_size, __ATOMIC_RELAXED);
+    } else {
+        __atomic_sub_fetch(&usage->tree_cnt, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&usage->node_cnt, node_cnt, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&usage->mem_size, mem_size, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Recomputes the memory estimate of a session copy and moves it to the usage
+ * of its module in the given datastore.
+ */
+static void
+dm_data_info_account(dm_data_info_t *info, sr_datastore_t ds, size_t oper_count)
+{
+    if (0 != info->mem_size) {
+        dm_mem_usage_update(&info->schema->mem_usage[info->mem_ds], info->node_cnt, info->mem_size, false);
+    }
+    info->mem_size = sizeof *info + dm_data_tree_mem_usage(info->node, &info->node_cnt);
+    info->mem_size_ops = oper_count;
+    info->mem_ds = ds;
+    dm_mem_usage_update(&info->schema->mem_usage[ds], info->node_cnt, info->mem_size, true);
+}
+
 /**
  * @brief frees the dm_data_info stored in binary tree
  */
@@ -216,7 +678,13 @@ static void
 dm_data_info_free(void *item)
 {
     dm_data_info_t *info = (dm_data_info_t *) item;
+    if (NULL != info) {
+        dm_untrack_changes(info);
+    }
     if (NULL != info && !info->rdonly_copy) {
+        if (0 != info->mem_size) {
+            dm_mem_usage_update(&info->schema->mem_usage[info->mem_ds], info->node_cnt, info->mem_size, false);
+        }
         lyd_free_withsiblings(info->node);
         /* decrement the number of usage of the module */
         pthread_mutex_lock(&info->schema->usage_count_mutex);
@@ -237,6 +705,7 @@ dm_model_subscription_free(void *sub)
         }
         free(ms->subscriptions);
         free(ms->nodes);
+        sr_omap_cleanup(ms->subscription_index);
         lyd_free_diff(ms->difflist);
         if (NULL != ms->changes) {
             for (int i = 0; i < ms->changes->count; i++) {
@@ -263,6 +732,7 @@ dm_schema_info_init(const char *schema_search_dir, dm_schema_info_t **schema_inf
     CHECK_NULL_NOMEM_GOTO(si->ly_ctx, rc, cleanup);
 
     pthread_rwlock_init(&si->model_lock, NULL);
+    sr_lockstat_register(&si->model_lock, "model_lock");
     pthread_mutex_init(&si->usage_count_mutex, NULL);
 
 cleanup:
@@ -274,6 +744,74 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Returns the info structure of the schema node, allocates it if needed.
+ */
+static dm_node_info_t *
+dm_get_node_info(struct lys_node *node)
+{
+    if (NULL == node->priv) {
+        node->priv = calloc(1, sizeof(dm_node_info_t));
+    }
+    return (dm_node_info_t *) node->priv;
+}
+
+/**
+ * @brief Compiles NACM permissions of all schema nodes of the module. Read permissions
+ * of the ancestors restrict the read permissions of their descendants, read permissions
+ * of the descendants are propagated into the read-subtree permissions of their ancestors.
+ *
+ * @note Function expects that a schema info is locked for writing or not yet shared.
+ *
+ * @param [in] dm_ctx
+ * @param [in] si
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_nacm_compile_schema(dm_ctx_t *dm_ctx, dm_schema_info_t *si)
+{
+    CHECK_NULL_ARG2(dm_ctx, si);
+    struct lys_node *root = NULL, *next = NULL, *iter = NULL, *parent = NULL;
+    dm_node_info_t *n_info = NULL, *p_info = NULL;
+    int rc = SR_ERR_OK;
+
+    if (NULL == dm_ctx->nacm_ctx || NULL == si->module) {
+        return SR_ERR_OK;
+    }
+
+    LY_TREE_FOR(si->module->data, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            n_info = dm_get_node_info(iter);
+            CHECK_NULL_NOMEM_RETURN(n_info);
+            rc = nacm_compile_node(dm_ctx->nacm_ctx, iter, &n_info->nacm);
+            CHECK_RC_LOG_RETURN(rc, "Compilation of NACM rules for node %s failed", iter->name);
+            /* a node can not be read unless its parent can be read (parents are compiled first) */
+            parent = lys_parent(iter);
+            if (NULL != parent && NULL != parent->priv) {
+                p_info = (dm_node_info_t *) parent->priv;
+                n_info->nacm.read &= p_info->nacm.read;
+                n_info->nacm.read_subtree = n_info->nacm.read;
+            }
+            LY_TREE_DFS_END(root, next, iter);
+        }
+    }
+
+    LY_TREE_FOR(si->module->data, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            n_info = (dm_node_info_t *) iter->priv;
+            for (parent = lys_parent(iter); NULL != parent; parent = lys_parent(parent)) {
+                p_info = (dm_node_info_t *) parent->priv;
+                if (NULL != p_info) {
+                    p_info->nacm.read_subtree &= n_info->nacm.read;
+                }
+            }
+            LY_TREE_DFS_END(root, next, iter);
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
 /**
  * @brief Creates the copy of dm_data_info structure and inserts it into binary tree
  * @param [in] tree
@@ -281,7 +819,7 @@ cleanup:
  * @return Error code (SR_ERR_OK on success)
  */
 static int
-dm_insert_data_info_copy(sr_btree_t *tree, const dm_data_info_t *di)
+dm_insert_data_info_copy(sr_omap_t *tree, const dm_data_info_t *di)
 {
     CHECK_NULL_ARG2(tree, di);
     int rc = SR_ERR_OK;
@@ -300,7 +838,7 @@ dm_insert_data_info_copy(sr_btree_t *tree, const dm_data_info_t *di)
     copy->schema = di->schema;
     copy->timestamp = di->timestamp;
 
-    rc = sr_btree_insert(tree, (void *) copy);
+    rc = sr_omap_insert(tree, (void *) copy);
 cleanup:
     if (SR_ERR_OK != rc) {
         dm_data_info_free(copy);
@@ -426,8 +964,8 @@ dm_get_schema_info(dm_ctx_t *dm_ctx, const char *module_name, dm_schema_info_t *
     dm_schema_info_t lookup_item = {0,};
     lookup_item.module_name = (char *) module_name;
     RWLOCK_RDLOCK_TIMED_CHECK_RETURN(&dm_ctx->schema_tree_lock);
-    *schema_info = sr_btree_search(dm_ctx->schema_info_tree, &lookup_item);
-    pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    *schema_info = sr_omap_search(dm_ctx->schema_info_tree, &lookup_item);
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
     if (NULL == *schema_info) {
         SR_LOG_ERR("Schema info not found for model %s", module_name);
         return SR_ERR_NOT_FOUND;
@@ -548,20 +1086,79 @@ cleanup:
 }
 
 /**
- * @brief Loads module and all its dependencies into the libyang context.
- * @param [in] dm_ctx
- * @param [in] module_name
- * @param [in] revision can be NULL
- * @param [out] module_schema
- * @return Error code (SR_ERR_OK on success)
+ * @brief Checks whether the schema node is conditional. The when statement of an augment
+ * applies to all nodes that are added by the augment.
+ * @param [in] node
+ * @return True if there is a when statement affecting the node
  */
-static int
-dm_load_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revision, dm_schema_info_t **schema_info)
+static bool
+dm_lys_node_has_when(const struct lys_node *node)
 {
-    CHECK_NULL_ARG3(dm_ctx, module_name, schema_info); /* revision might be NULL*/
-    int rc = SR_ERR_OK;
-    dm_schema_info_t *si = NULL;
-    md_module_t *module = NULL;
+    if (NULL != node->parent && LYS_AUGMENT == node->parent->nodetype &&
+            NULL != ((struct lys_node_augment *) node->parent)->when) {
+        return true;
+    }
+
+    switch (node->nodetype) {
+    case LYS_CONTAINER:
+        return NULL != ((struct lys_node_container *) node)->when;
+    case LYS_LIST:
+        return NULL != ((struct lys_node_list *) node)->when;
+    case LYS_LEAF:
+        return NULL != ((struct lys_node_leaf *) node)->when;
+    case LYS_LEAFLIST:
+        return NULL != ((struct lys_node_leaflist *) node)->when;
+    case LYS_CHOICE:
+        return NULL != ((struct lys_node_choice *) node)->when;
+    case LYS_CASE:
+        return NULL != ((struct lys_node_case *) node)->when;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        return NULL != ((struct lys_node_anydata *) node)->when;
+    case LYS_USES:
+        return NULL != ((struct lys_node_uses *) node)->when;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Checks whether the module contains a conditional node. Changes in such modules may
+ * affect (add defaults, auto-delete) nodes outside of the modified subtrees.
+ * @param [in] module
+ * @return True if a when statement is found
+ */
+static bool
+dm_module_has_when_conditions(const struct lys_module *module)
+{
+    struct lys_node *root = NULL, *next = NULL, *iter = NULL;
+
+    LY_TREE_FOR(module->data, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            if (dm_lys_node_has_when(iter)) {
+                return true;
+            }
+            LY_TREE_DFS_END(root, next, iter);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Loads module and all its dependencies into the libyang context.
+ * @param [in] dm_ctx
+ * @param [in] module_name
+ * @param [in] revision can be NULL
+ * @param [out] module_schema
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_load_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revision, dm_schema_info_t **schema_info)
+{
+    CHECK_NULL_ARG3(dm_ctx, module_name, schema_info); /* revision might be NULL*/
+    int rc = SR_ERR_OK;
+    dm_schema_info_t *si = NULL;
+    md_module_t *module = NULL;
     md_dep_t *dep = NULL;
     sr_llist_node_t *ll_node = NULL;
 
@@ -627,10 +1224,17 @@ dm_load_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revision,
     /* distinguish between modules that can and cannot be locked */
     si->can_not_be_locked = !module->has_data;
 
+    /* changes in modules with conditional nodes are not limited to the modified subtrees */
+    si->has_when_conditions = dm_module_has_when_conditions(si->module);
+
     /* insert schema info into schema tree */
     RWLOCK_WRLOCK_TIMED_CHECK_GOTO(&dm_ctx->schema_tree_lock, rc, cleanup);
 
-    rc = sr_btree_insert(dm_ctx->schema_info_tree, si);
+    /* compiled under the schema tree lock so that no NACM reload is missed */
+    rc = dm_nacm_compile_schema(dm_ctx, si);
+    CHECK_RC_LOG_GOTO(rc, unlock, "Failed to compile NACM rules for module %s", module_name);
+
+    rc = sr_omap_insert(dm_ctx->schema_info_tree, si);
     if (SR_ERR_OK != rc) {
         if (SR_ERR_DATA_EXISTS != rc) {
             SR_LOG_WRN("Insert into schema binary tree failed. %s", sr_strerror(rc));
@@ -638,7 +1242,7 @@ dm_load_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revision,
         } else {
             /* if someone loaded schema meanwhile */
             dm_schema_info_t *lookup = si;
-            si = sr_btree_search(dm_ctx->schema_info_tree, lookup);
+            si = sr_omap_search(dm_ctx->schema_info_tree, lookup);
             dm_free_schema_info(lookup);
             if (NULL != si) {
                 rc = SR_ERR_OK;
@@ -649,7 +1253,7 @@ dm_load_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revision,
     }
 
 unlock:
-    pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
 cleanup:
     if (SR_ERR_OK == rc) {
         *schema_info = si;
@@ -807,7 +1411,7 @@ dm_free_sess_op(dm_sess_op_t *op)
     if (NULL == op) {
         return;
     }
-    free(op->xpath);
+    sr_str_release(op->xpath);
     if (DM_SET_OP == op->op) {
         sr_free_val(op->detail.set.val);
     } else if (DM_MOVE_OP == op->op) {
@@ -830,31 +1434,141 @@ dm_free_sess_operations(dm_sess_op_t *ops, size_t count)
 }
 
 /**
- * @brief Locks a file based on provided file name.
- * @param [in] lock_ctx
+ * @brief Returns the datastore of a module lock file. Expects that lock file names
+ * are in form [DATA_DIR][MODULE_NAME][DATASTORE].lock
+ * @param [in] lock_file
+ * @param [out] ds
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_get_datastore_by_lock_file(const char *lock_file, sr_datastore_t *ds)
+{
+    CHECK_NULL_ARG2(lock_file, ds);
+
+    if (sr_str_ends_with(lock_file, SR_STARTUP_FILE_EXT SR_LOCK_FILE_EXT)) {
+        *ds = SR_DS_STARTUP;
+    } else if (sr_str_ends_with(lock_file, SR_RUNNING_FILE_EXT SR_LOCK_FILE_EXT)) {
+        *ds = SR_DS_RUNNING;
+    } else if (sr_str_ends_with(lock_file, SR_CANDIDATE_FILE_EXT SR_LOCK_FILE_EXT)) {
+        *ds = SR_DS_CANDIDATE;
+    } else {
+        SR_LOG_ERR("Unable to extract datastore %s", lock_file);
+        return SR_ERR_INTERNAL;
+    }
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Checks that the module lock file can be locked with the process identity, the file
+ * is opened for writing (and created if it does not exist yet). Used if there is no Access Control
+ * module context to check and cache the permissions of the user.
+ * @param [in] filename
+ * @return Error code (SR_ERR_OK on success), SR_ERR_UNATHORIZED if the file can not be locked
+ * because of the permission.
+ */
+static int
+dm_check_lock_file_access(const char *filename)
+{
+    CHECK_NULL_ARG(filename);
+    int fd = -1;
+
+    fd = open(filename, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+    if (-1 == fd) {
+        if (EACCES == errno) {
+            SR_LOG_ERR("Insufficient permissions to lock the file '%s'", filename);
+            return SR_ERR_UNAUTHORIZED;
+        }
+        SR_LOG_ERR("Error by opening the file '%s': %s", filename, sr_strerror_safe(errno));
+        return SR_ERR_INTERNAL;
+    }
+    close(fd);
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Checks that the user of the session is allowed to lock the module in the datastore.
+ * The decision is cached by Access Control module, so the lock file is opened (with the identity
+ * of the user) only if the decision is not known yet.
+ * @param [in] dm_ctx
+ * @param [in] session
+ * @param [in] module_name
+ * @param [in] ds
+ * @param [in] filename
+ * @return Error code (SR_ERR_OK on success), SR_ERR_UNATHORIZED if the module can not be locked
+ * because of the permission.
+ */
+static int
+dm_check_lock_access(dm_ctx_t *dm_ctx, dm_session_t *session, const char *module_name, sr_datastore_t ds,
+        const char *filename)
+{
+    CHECK_NULL_ARG4(dm_ctx, session, module_name, filename);
+
+    if (NULL == dm_ctx->ac_ctx) {
+        return dm_check_lock_file_access(filename);
+    }
+    return ac_check_lock_permissions(dm_ctx->ac_ctx, session->user_credentials, module_name, ds, filename);
+}
+
+/**
+ * @brief Locks a module lock file based on provided file name for the session. The datastore
+ * of the module is locked in intention exclusive mode first, so that a conflict with a datastore
+ * lock is detected without visiting the module locks.
+ * @param [in] dm_ctx
+ * @param [in] session
+ * @param [in] module_name
+ * @param [in] ds
  * @param [in] filename
  * @return Error code (SR_ERR_OK on success), SR_ERR_LOCKED if the file is already locked,
  * SR_ERR_UNATHORIZED if the file can not be locked because of the permission.
  */
 static int
-dm_lock_file(sr_locking_set_t *lock_ctx, char *filename)
+dm_lock_file(dm_ctx_t *dm_ctx, dm_session_t *session, const char *module_name, sr_datastore_t ds, char *filename)
 {
-    CHECK_NULL_ARG2(lock_ctx, filename);
-    return sr_locking_set_lock_file_open(lock_ctx, filename, true, false, NULL);
+    CHECK_NULL_ARG4(dm_ctx, session, module_name, filename);
+    int rc = SR_ERR_OK;
+
+    rc = dm_check_lock_access(dm_ctx, session, module_name, ds, filename);
+    if (SR_ERR_OK != rc) {
+        return rc;
+    }
+
+    rc = sr_lock_table_lock(dm_ctx->lock_table, dm_ctx->ds_lock_files[ds], session, SR_LOCK_INTENT_EXCL, 0);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_INF("Datastore %s is locked by other session", sr_ds_to_str(ds));
+        return rc;
+    }
+
+    rc = sr_lock_table_lock(dm_ctx->lock_table, filename, session, SR_LOCK_EXCL, 0);
+    if (SR_ERR_OK != rc) {
+        sr_lock_table_unlock(dm_ctx->lock_table, dm_ctx->ds_lock_files[ds], session, SR_LOCK_INTENT_EXCL);
+    }
+    return rc;
 }
 
 /**
- * @brief Unlocks the file based on the filename
- * @param [in] lock_ctx
+ * @brief Unlocks the module lock file based on the filename together with the intention
+ * lock of its datastore.
+ * @param [in] dm_ctx
+ * @param [in] session
  * @param [in] filename
  * @return Error code (SR_ERR_OK on success) SR_ERR_INVAL_ARG if the
- * file had not been locked in provided context
+ * file had not been locked by provided session
  */
 static int
-dm_unlock_file(sr_locking_set_t *lock_ctx, char *filename)
+dm_unlock_file(dm_ctx_t *dm_ctx, dm_session_t *session, char *filename)
 {
-    CHECK_NULL_ARG2(lock_ctx, filename);
-    return sr_locking_set_unlock_close_file(lock_ctx, filename);
+    CHECK_NULL_ARG3(dm_ctx, session, filename);
+    int rc = SR_ERR_OK;
+    sr_datastore_t ds = SR_DS_STARTUP;
+
+    rc = dm_get_datastore_by_lock_file(filename, &ds);
+    CHECK_RC_MSG_RETURN(rc, "Datastore of the lock file can not be determined");
+
+    rc = sr_lock_table_unlock(dm_ctx->lock_table, filename, session, SR_LOCK_EXCL);
+    if (SR_ERR_OK == rc) {
+        rc = sr_lock_table_unlock(dm_ctx->lock_table, dm_ctx->ds_lock_files[ds], session, SR_LOCK_INTENT_EXCL);
+    }
+    return rc;
 }
 
 /**
@@ -885,6 +1599,11 @@ dm_lock_module(dm_ctx_t *dm_ctx, dm_session_t *session, const char *modul_name)
         goto cleanup;
     }
 
+    if (session->holds_ds_lock[session->datastore] && !session->ds_lock_per_module[session->datastore]) {
+        SR_LOG_DBG("Module %s is covered by the datastore lock of this session.", modul_name);
+        goto cleanup;
+    }
+
     rc = sr_get_lock_data_file_name(dm_ctx->data_search_dir, modul_name, session->datastore, &lock_file);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Lock file name can not be created");
 
@@ -897,13 +1616,7 @@ dm_lock_module(dm_ctx_t *dm_ctx, dm_session_t *session, const char *modul_name)
         }
     }
 
-    /* switch identity */
-    ac_set_user_identity(dm_ctx->ac_ctx, session->user_credentials);
-
-    rc = dm_lock_file(dm_ctx->locking_ctx, lock_file);
-
-    /* switch identity back */
-    ac_unset_user_identity(dm_ctx->ac_ctx);
+    rc = dm_lock_file(dm_ctx, session, si->module_name, session->datastore, lock_file);
 
     /* log information about locked model */
     if (SR_ERR_OK != rc) {
@@ -918,7 +1631,7 @@ dm_lock_module(dm_ctx_t *dm_ctx, dm_session_t *session, const char *modul_name)
         pthread_mutex_unlock(&si->usage_count_mutex);
     }
 cleanup:
-    pthread_rwlock_unlock(&si->model_lock);
+    sr_rwlock_unlock(&si->model_lock);
     return rc;
 }
 
@@ -948,11 +1661,13 @@ dm_unlock_module(dm_ctx_t *dm_ctx, dm_session_t *session, char *modul_name)
         }
     }
 
-    if (!found) {
+    if (!found && session->holds_ds_lock[session->datastore] && !session->ds_lock_per_module[session->datastore]) {
+        SR_LOG_DBG("Module %s is covered by the datastore lock of this session.", modul_name);
+    } else if (!found) {
         SR_LOG_ERR("File %s has not been locked in this context", lock_file);
         rc = SR_ERR_INVAL_ARG;
     } else {
-        rc = dm_unlock_file(dm_ctx->locking_ctx, lock_file);
+        rc = dm_unlock_file(dm_ctx, session, lock_file);
         free(session->locked_files->data[i]);
         sr_list_rm_at(session->locked_files, i);
         pthread_mutex_lock(&si->usage_count_mutex);
@@ -962,7 +1677,7 @@ dm_unlock_module(dm_ctx_t *dm_ctx, dm_session_t *session, char *modul_name)
     }
 cleanup:
     free(lock_file);
-    pthread_rwlock_unlock(&si->model_lock);
+    sr_rwlock_unlock(&si->model_lock);
     return rc;
 }
 
@@ -971,51 +1686,98 @@ dm_lock_datastore(dm_ctx_t *dm_ctx, dm_session_t *session)
 {
     CHECK_NULL_ARG2(dm_ctx, session);
     int rc = SR_ERR_OK;
-    sr_schema_t *schemas = NULL;
-    size_t schema_count = 0;
+    md_module_t *module = NULL;
+    sr_llist_node_t *ll_node = NULL;
+    char *lock_file = NULL, *module_name = NULL;
+    sr_list_t *lockable = NULL, *locked = NULL;
+    size_t locked_count = 0;
+    bool all_lockable = true;
+    sr_datastore_t ds = session->datastore;
 
-    sr_list_t *locked = NULL;
-    rc = sr_list_init(&locked);
-    CHECK_RC_MSG_RETURN(rc, "List init failed");
+    if (session->holds_ds_lock[ds]) {
+        SR_LOG_ERR_MSG("Datastore lock is already hold by this session");
+        return SR_ERR_LOCKED;
+    }
 
-    rc = dm_list_schemas(dm_ctx, session, &schemas, &schema_count);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "List schemas failed");
+    rc = sr_list_init(&lockable);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "List init failed");
+    rc = sr_list_init(&locked);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "List init failed");
 
-    pthread_mutex_lock(&dm_ctx->ds_lock_mutex);
-    if (dm_ctx->ds_lock[session->datastore]) {
-        SR_LOG_ERR_MSG("Datastore lock is hold by other session");
-        rc = SR_ERR_LOCKED;
-        pthread_mutex_unlock(&dm_ctx->ds_lock_mutex);
-        goto cleanup;
+    /* the permissions are decided by the access control cache, the lock files are opened only
+     * if the decision for the user is not known yet */
+    md_ctx_lock(dm_ctx->md_ctx, false);
+    for (ll_node = dm_ctx->md_ctx->modules->first; NULL != ll_node && SR_ERR_OK == rc; ll_node = ll_node->next) {
+        module = (md_module_t *) ll_node->data;
+        if (module->submodule || !module->has_data) {
+            /* locking of a module without data is no operation */
+            continue;
+        }
+        rc = sr_get_lock_data_file_name(dm_ctx->data_search_dir, module->name, ds, &lock_file);
+        if (SR_ERR_OK == rc) {
+            rc = dm_check_lock_access(dm_ctx, session, module->name, ds, lock_file);
+            free(lock_file);
+            lock_file = NULL;
+        }
+        if (SR_ERR_UNAUTHORIZED == rc) {
+            SR_LOG_INF("Not allowed to lock %s, skipping", module->name);
+            all_lockable = false;
+            rc = SR_ERR_OK;
+        } else if (SR_ERR_OK == rc) {
+            module_name = strdup(module->name);
+            CHECK_NULL_NOMEM_ERROR(module_name, rc);
+            if (SR_ERR_OK == rc) {
+                rc = sr_list_add(lockable, module_name);
+                if (SR_ERR_OK != rc) {
+                    free(module_name);
+                }
+            }
+        }
     }
-    dm_ctx->ds_lock[session->datastore] = true;
-    pthread_mutex_unlock(&dm_ctx->ds_lock_mutex);
-    session->holds_ds_lock[session->datastore] = true;
+    md_ctx_unlock(dm_ctx->md_ctx);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Lock of the modules can not be checked");
 
-    for (size_t i = 0; i < schema_count; i++) {
-        rc = dm_lock_module(dm_ctx, session, (char *) schemas[i].module_name);
-        if (SR_ERR_OK != rc) {
-            if (SR_ERR_UNAUTHORIZED == rc) {
-                SR_LOG_INF("Not allowed to lock %s, skipping", schemas[i].module_name);
-                continue;
-            } else if (SR_ERR_LOCKED == rc) {
-                SR_LOG_ERR("Model %s is already locked by other session", schemas[i].module_name);
+    if (all_lockable) {
+        /* a single exclusive lock conflicts with the module locks of other sessions through their intention locks */
+        rc = sr_lock_table_lock(dm_ctx->lock_table, dm_ctx->ds_lock_files[ds], session, SR_LOCK_EXCL, 0);
+        if (SR_ERR_LOCKED == rc) {
+            SR_LOG_ERR_MSG("Datastore lock is hold by other session");
+        }
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Datastore lock failed");
+
+        /* the features of the modules can not be modified while the datastore is locked */
+        __atomic_add_fetch(&dm_ctx->ds_lock_count, 1, __ATOMIC_RELAXED);
+    } else {
+        /* the modules the user is not allowed to lock have to stay available to other sessions,
+         * the datastore lock consists of the locks of the lockable modules */
+        for (size_t i = 0; i < lockable->count; i++) {
+            module_name = (char *) lockable->data[i];
+            locked_count = session->locked_files->count;
+            rc = dm_lock_module(dm_ctx, session, module_name);
+            if (SR_ERR_LOCKED == rc) {
+                SR_LOG_ERR("Model %s is already locked by other session", module_name);
             }
-            for (size_t l = 0; l < locked->count; l++) {
-                dm_unlock_module(dm_ctx, session, (char *) locked->data[l]);
+            if (SR_ERR_OK != rc) {
+                for (size_t l = 0; l < locked->count; l++) {
+                    dm_unlock_module(dm_ctx, session, (char *) locked->data[l]);
+                }
+                goto cleanup;
+            }
+            if (session->locked_files->count > locked_count) {
+                /* the modules locked by the session before are kept locked if the datastore lock fails */
+                rc = sr_list_add(locked, module_name);
+                CHECK_RC_MSG_GOTO(rc, cleanup, "List add failed");
             }
-            pthread_mutex_lock(&dm_ctx->ds_lock_mutex);
-            dm_ctx->ds_lock[session->datastore] = false;
-            pthread_mutex_unlock(&dm_ctx->ds_lock_mutex);
-            session->holds_ds_lock[session->datastore] = false;
-            goto cleanup;
         }
-        SR_LOG_DBG("Module %s locked", schemas[i].module_name);
-        rc = sr_list_add(locked, (char *) schemas[i].module_name);
-        CHECK_RC_MSG_GOTO(rc, cleanup, "List add failed");
+        session->ds_lock_per_module[ds] = true;
     }
+    session->holds_ds_lock[ds] = true;
+
 cleanup:
-    sr_free_schemas(schemas, schema_count);
+    for (size_t i = 0; NULL != lockable && i < lockable->count; i++) {
+        free(lockable->data[i]);
+    }
+    sr_list_cleanup(lockable);
     sr_list_cleanup(locked);
     return rc;
 }
@@ -1080,22 +1842,22 @@ dm_unlock_datastore(dm_ctx_t *dm_ctx, dm_session_t *session)
             si->usage_count--;
             SR_LOG_DBG("Usage count %s decremented (value=%zu)", si->module_name, si->usage_count);
             pthread_mutex_unlock(&si->usage_count_mutex);
-            pthread_rwlock_unlock(&si->model_lock);
+            sr_rwlock_unlock(&si->model_lock);
         } else {
             SR_LOG_WRN("Get schema info by lock file failed %s", (char *) session->locked_files->data[0]);
         }
 
-        dm_unlock_file(dm_ctx->locking_ctx, (char *) session->locked_files->data[0]);
+        dm_unlock_file(dm_ctx, session, (char *) session->locked_files->data[0]);
         free(session->locked_files->data[0]);
         sr_list_rm_at(session->locked_files, 0);
     }
     for (int i = 0; i < DM_DATASTORE_COUNT; i++) {
-        if (session->holds_ds_lock[i]) {
-            pthread_mutex_lock(&dm_ctx->ds_lock_mutex);
-            dm_ctx->ds_lock[i] = false;
-            session->holds_ds_lock[i] = false;
-            pthread_mutex_unlock(&dm_ctx->ds_lock_mutex);
+        if (session->holds_ds_lock[i] && !session->ds_lock_per_module[i]) {
+            sr_lock_table_unlock(dm_ctx->lock_table, dm_ctx->ds_lock_files[i], session, SR_LOCK_EXCL);
+            __atomic_sub_fetch(&dm_ctx->ds_lock_count, 1, __ATOMIC_RELAXED);
         }
+        session->holds_ds_lock[i] = false;
+        session->ds_lock_per_module[i] = false;
     }
     return SR_ERR_OK;
 }
@@ -1140,8 +1902,8 @@ dm_add_operation(dm_session_t *session, dm_operation_t op, const char *xpath, sr
     int index = session->oper_count[session->datastore];
     session->operations[session->datastore][index].op = op;
     session->operations[session->datastore][index].has_error = false;
-    session->operations[session->datastore][index].xpath = strdup(xpath);
-    CHECK_NULL_NOMEM_GOTO(session->operations[session->datastore][index].xpath, rc, cleanup);
+    rc = sr_str_intern(xpath, &session->operations[session->datastore][index].xpath);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern the xpath of the operation.");
     if (DM_SET_OP == op) {
         session->operations[session->datastore][index].detail.set.val = val;
         session->operations[session->datastore][index].detail.set.options = opts;
@@ -1301,14 +2063,141 @@ int
 dm_set_node_state(struct lys_node *node, dm_node_state_t state)
 {
     CHECK_NULL_ARG(node);
-    if (NULL == node->priv) {
-        node->priv = calloc(1, sizeof(dm_node_info_t));
-        CHECK_NULL_NOMEM_RETURN(node->priv);
-    }
-    ((dm_node_info_t *) node->priv)->state = state;
+    dm_node_info_t *n_info = dm_get_node_info(node);
+    CHECK_NULL_NOMEM_RETURN(n_info);
+    n_info->state = state;
     return SR_ERR_OK;
 }
 
+int
+dm_nacm_get_profile(dm_ctx_t *dm_ctx, const dm_session_t *session, nacm_profile_t *profile)
+{
+    CHECK_NULL_ARG3(dm_ctx, session, profile);
+
+    if (NULL == session->user_credentials) {
+        /* internal session */
+        memset(profile, 0, sizeof(*profile));
+        profile->bypass = true;
+        return SR_ERR_OK;
+    }
+    return nacm_get_profile(dm_ctx->nacm_ctx, session->user_credentials, profile);
+}
+
+bool
+dm_nacm_check_node(const struct lys_node *node, const nacm_profile_t *profile, uint8_t access)
+{
+    if (NULL == profile || NULL == node) {
+        return false;
+    }
+    if (profile->bypass) {
+        return true;
+    }
+    return nacm_check_node(NULL != node->priv ? &((dm_node_info_t *) node->priv)->nacm : NULL, profile, access);
+}
+
+/**
+ * @brief Replaces the NACM rules in use by the rules from the data tree of ietf-netconf-acm
+ * module and recompiles the permissions of all loaded schemas.
+ *
+ * @note Function expects that no schema info is locked by the caller.
+ *
+ * @param [in] dm_ctx
+ * @param [in] data_tree
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_nacm_reload(dm_ctx_t *dm_ctx, const struct lyd_node *data_tree)
+{
+    CHECK_NULL_ARG(dm_ctx);
+    nacm_config_t *config = NULL;
+    dm_schema_info_t *si = NULL;
+    size_t i = 0;
+    int rc = SR_ERR_OK;
+
+    rc = nacm_config_from_tree(data_tree, &config);
+    CHECK_RC_MSG_RETURN(rc, "Failed to read NACM configuration");
+
+    rc = nacm_reload(dm_ctx->nacm_ctx, config);
+    if (SR_ERR_OK != rc) {
+        /* all access except for the recovery sessions is denied, the schemas are recompiled anyway */
+        SR_LOG_WRN_MSG("NACM rules can not be compiled, access is denied to all users");
+        rc = SR_ERR_OK;
+    }
+
+    RWLOCK_RDLOCK_TIMED_CHECK_RETURN(&dm_ctx->schema_tree_lock);
+    while (NULL != (si = sr_omap_get_at(dm_ctx->schema_info_tree, i++))) {
+        RWLOCK_WRLOCK_TIMED_CHECK_GOTO(&si->model_lock, rc, unlock);
+        if (NULL != si->ly_ctx) {
+            rc = dm_nacm_compile_schema(dm_ctx, si);
+        }
+        sr_rwlock_unlock(&si->model_lock);
+        CHECK_RC_LOG_GOTO(rc, unlock, "Failed to compile NACM rules for module %s", si->module_name);
+    }
+
+unlock:
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    return rc;
+}
+
+/**
+ * @brief Loads the NACM rules from the running datastore if ietf-netconf-acm module is installed.
+ *
+ * @param [in] dm_ctx
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_nacm_load(dm_ctx_t *dm_ctx)
+{
+    CHECK_NULL_ARG(dm_ctx);
+    md_module_t *module = NULL;
+    dm_schema_info_t *si = NULL;
+    dm_data_info_t *di = NULL;
+    char *data_filename = NULL;
+    int fd = -1;
+    int rc = SR_ERR_OK;
+
+    md_ctx_lock(dm_ctx->md_ctx, false);
+    rc = md_get_module_info(dm_ctx->md_ctx, NACM_MODULE_NAME, NULL, &module);
+    md_ctx_unlock(dm_ctx->md_ctx);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_DBG_MSG("Module " NACM_MODULE_NAME " is not installed, NACM is disabled");
+        return SR_ERR_OK;
+    }
+
+    rc = dm_get_module_and_lock(dm_ctx, NACM_MODULE_NAME, &si);
+    CHECK_RC_MSG_RETURN(rc, "Failed to load module " NACM_MODULE_NAME);
+
+    rc = sr_get_data_file_name(dm_ctx->data_search_dir, NACM_MODULE_NAME, SR_DS_RUNNING, &data_filename);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Get data_filename failed for " NACM_MODULE_NAME);
+
+    fd = open(data_filename, O_RDONLY);
+    if (-1 != fd) {
+        /* lock, read-only, blocking */
+        sr_lock_fd(fd, false, true);
+    } else if (ENOENT != errno) {
+        SR_LOG_ERR("Failed to open NACM data file %s: %s", data_filename, sr_strerror_safe(errno));
+        rc = SR_ERR_IO;
+        goto cleanup;
+    }
+
+    rc = dm_load_data_tree_file(dm_ctx, fd, data_filename, si, &di);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to load NACM data");
+
+cleanup:
+    if (-1 != fd) {
+        sr_unlock_fd(fd);
+        close(fd);
+    }
+    free(data_filename);
+    sr_rwlock_unlock(&si->model_lock);
+
+    if (SR_ERR_OK == rc) {
+        rc = dm_nacm_reload(dm_ctx, di->node);
+    }
+    dm_data_info_free(di);
+    return rc;
+}
+
 bool
 dm_is_running_ds_session(dm_session_t *session)
 {
@@ -1445,6 +2334,33 @@ unlock:
     return rc;
 }
 
+/**
+ * @brief Reads a memory budget (in KiB) from the environment variable. Falls back to the default
+ * if the variable is not set or does not hold a valid non-negative number.
+ *
+ * @return The budget in bytes.
+ */
+static size_t
+dm_mem_budget_from_env(const char *env_name, size_t default_kib)
+{
+    const char *env_str = getenv(env_name);
+    char *endptr = NULL;
+    unsigned long long value = 0;
+
+    if (NULL == env_str) {
+        return default_kib * 1024;
+    }
+
+    errno = 0;
+    value = strtoull(env_str, &endptr, 10);
+    if (0 != errno || endptr == env_str || '\0' != *endptr || NULL != strchr(env_str, '-') || value > SIZE_MAX / 1024) {
+        SR_LOG_WRN("Invalid value '%s' of %s, using the default budget of %zu KiB.", env_str, env_name, default_kib);
+        return default_kib * 1024;
+    }
+
+    return (size_t) value * 1024;
+}
+
 int
 dm_init(ac_ctx_t *ac_ctx, np_ctx_t *np_ctx, pm_ctx_t *pm_ctx, const cm_connection_mode_t conn_mode,
         const char *schema_search_dir, const char *data_search_dir, dm_ctx_t **dm_ctx)
@@ -1457,7 +2373,7 @@ dm_init(ac_ctx_t *ac_ctx, np_ctx_t *np_ctx, pm_ctx_t *pm_ctx, const cm_connectio
     int rc = SR_ERR_OK;
     pthread_rwlockattr_t attr;
     pthread_rwlockattr_init(&attr);
-    char *internal_schema_search_dir = NULL, *internal_data_search_dir = NULL;
+    char *internal_schema_search_dir = NULL, *internal_data_search_dir = NULL, *lock_table_file = NULL;
     ctx = calloc(1, sizeof(*ctx));
     CHECK_NULL_NOMEM_GOTO(ctx, rc, cleanup);
     ctx->ac_ctx = ac_ctx;
@@ -1465,6 +2381,9 @@ dm_init(ac_ctx_t *ac_ctx, np_ctx_t *np_ctx, pm_ctx_t *pm_ctx, const cm_connectio
     ctx->pm_ctx = pm_ctx;
     ctx->conn_mode = conn_mode;
 
+    ctx->session_mem_budget = dm_mem_budget_from_env(DM_SESSION_MEM_BUDGET_ENV, SR_SESSION_MEM_BUDGET);
+    ctx->global_mem_budget = dm_mem_budget_from_env(DM_GLOBAL_MEM_BUDGET_ENV, SR_GLOBAL_MEM_BUDGET);
+
     ly_set_log_clb(dm_ly_log_cb, 1);
 
     ctx->schema_search_dir = strdup(schema_search_dir);
@@ -1473,11 +2392,8 @@ dm_init(ac_ctx_t *ac_ctx, np_ctx_t *np_ctx, pm_ctx_t *pm_ctx, const cm_connectio
     ctx->data_search_dir = strdup(data_search_dir);
     CHECK_NULL_NOMEM_GOTO(ctx->data_search_dir, rc, cleanup);
 
-    ctx->ds_lock = calloc(DM_DATASTORE_COUNT, sizeof(*ctx->ds_lock));
-    CHECK_NULL_NOMEM_GOTO(ctx->ds_lock, rc, cleanup);
-
-    rc = sr_locking_set_init(&ctx->locking_ctx);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Locking set init failed");
+    ctx->ds_lock_files = calloc(DM_DATASTORE_COUNT, sizeof(*ctx->ds_lock_files));
+    CHECK_NULL_NOMEM_GOTO(ctx->ds_lock_files, rc, cleanup);
 
 #if defined(HAVE_PTHREAD_RWLOCKATTR_SETKIND_NP)
     pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
@@ -1485,15 +2401,17 @@ dm_init(ac_ctx_t *ac_ctx, np_ctx_t *np_ctx, pm_ctx_t *pm_ctx, const cm_connectio
 
     rc = pthread_rwlock_init(&ctx->schema_tree_lock, &attr);
     CHECK_ZERO_MSG_GOTO(rc, rc, SR_ERR_INTERNAL, cleanup, "lyctx mutex initialization failed");
+    sr_lockstat_register(&ctx->schema_tree_lock, "schema_tree_lock");
 
-    rc = sr_btree_init(dm_schema_info_cmp, dm_free_schema_info, &ctx->schema_info_tree);
+    rc = sr_omap_init(dm_schema_info_cmp, dm_schema_info_hash, dm_free_schema_info, &ctx->schema_info_tree);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Schema binary tree allocation failed");
 
-    rc = sr_btree_init(dm_c_ctx_id_cmp, dm_free_commit_context, &ctx->commit_ctxs.tree);
+    rc = sr_omap_init(dm_c_ctx_id_cmp, NULL, dm_free_commit_context, &ctx->commit_ctxs.tree);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Commit context binary tree initialization failed");
 
     rc = pthread_rwlock_init(&ctx->commit_ctxs.lock, &attr);
     CHECK_ZERO_MSG_GOTO(rc, rc, SR_ERR_INTERNAL, cleanup, "c_ctxs_lock init failed");
+    sr_lockstat_register(&ctx->commit_ctxs.lock, "commit_ctxs_lock");
 
     rc = sr_str_join(schema_search_dir, "internal", &internal_schema_search_dir);
     CHECK_ZERO_MSG_GOTO(rc, rc, SR_ERR_INTERNAL, cleanup, "sr_str_join failed");
@@ -1504,11 +2422,32 @@ dm_init(ac_ctx_t *ac_ctx, np_ctx_t *np_ctx, pm_ctx_t *pm_ctx, const cm_connectio
                  internal_data_search_dir, false, &ctx->md_ctx);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to initialize Module Dependencies context.");
 
+    /* module locks are shared with other processes through fcntl locks of the lock table file
+     * and a lock region in shared memory mapped from it */
+    rc = sr_path_join(internal_data_search_dir, DM_LOCK_TABLE_FILENAME, &lock_table_file);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "sr_path_join failed");
+    rc = sr_lock_table_init(lock_table_file, &ctx->lock_table);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Lock table init failed");
+    for (int i = 0; i < DM_DATASTORE_COUNT; i++) {
+        rc = sr_get_lock_data_file_name(internal_data_search_dir, DM_DS_LOCK_FILENAME, i, &ctx->ds_lock_files[i]);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Datastore lock file name can not be created");
+    }
+
+    rc = dm_worker_pool_init(&ctx->worker_pool);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to initialize DM worker pool.");
+
+    rc = nacm_init(&ctx->nacm_ctx);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to initialize NACM context.");
+
+    rc = dm_nacm_load(ctx);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to load NACM rules.");
+
     *dm_ctx = ctx;
 
 cleanup:
     free(internal_schema_search_dir);
     free(internal_data_search_dir);
+    free(lock_table_file);
     pthread_rwlockattr_destroy(&attr);
     if (SR_ERR_OK != rc) {
         dm_cleanup(ctx);
@@ -1521,17 +2460,25 @@ void
 dm_cleanup(dm_ctx_t *dm_ctx)
 {
     if (NULL != dm_ctx) {
-        sr_btree_cleanup(dm_ctx->commit_ctxs.tree);
+        dm_worker_pool_cleanup(dm_ctx->worker_pool);
+        sr_omap_cleanup(dm_ctx->commit_ctxs.tree);
 
         free(dm_ctx->schema_search_dir);
         free(dm_ctx->data_search_dir);
-        free(dm_ctx->ds_lock);
-        sr_btree_cleanup(dm_ctx->schema_info_tree);
+        if (NULL != dm_ctx->ds_lock_files) {
+            for (int i = 0; i < DM_DATASTORE_COUNT; i++) {
+                free(dm_ctx->ds_lock_files[i]);
+            }
+            free(dm_ctx->ds_lock_files);
+        }
+        sr_omap_cleanup(dm_ctx->schema_info_tree);
+        nacm_cleanup(dm_ctx->nacm_ctx);
         md_destroy(dm_ctx->md_ctx);
+        sr_lockstat_unregister(&dm_ctx->schema_tree_lock);
         pthread_rwlock_destroy(&dm_ctx->schema_tree_lock);
-        sr_locking_set_cleanup(dm_ctx->locking_ctx);
-        pthread_mutex_destroy(&dm_ctx->ds_lock_mutex);
+        sr_lock_table_cleanup(dm_ctx->lock_table);
 
+        sr_lockstat_unregister(&dm_ctx->commit_ctxs.lock);
         pthread_rwlock_destroy(&dm_ctx->commit_ctxs.lock);
         free(dm_ctx);
     }
@@ -1554,7 +2501,7 @@ dm_session_start(dm_ctx_t *dm_ctx, const ac_ucred_t *user_credentials, const sr_
     CHECK_NULL_NOMEM_GOTO(session_ctx->session_modules, rc, cleanup);
 
     for (size_t i = 0; i < DM_DATASTORE_COUNT; i++) {
-        rc = sr_btree_init(dm_data_info_cmp, dm_data_info_free, &session_ctx->session_modules[i]);
+        rc = sr_omap_init(dm_data_info_cmp, dm_data_info_hash, dm_data_info_free, &session_ctx->session_modules[i]);
         CHECK_RC_MSG_GOTO(rc, cleanup, "Session module binary tree init failed");
     }
 
@@ -1589,9 +2536,13 @@ dm_session_stop(dm_ctx_t *dm_ctx, dm_session_t *session)
         sr_list_cleanup(session->locked_files);
     }
     for (size_t i = 0; i < DM_DATASTORE_COUNT; i++) {
-        sr_btree_cleanup(session->session_modules[i]);
+        sr_omap_cleanup(session->session_modules[i]);
     }
     free(session->session_modules);
+    __atomic_sub_fetch(&dm_ctx->mem_used, session->mem_usage.mem_size, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < DM_DATASTORE_COUNT; i++) {
+        sr_list_cleanup(session->evicted_modules[i]);
+    }
     dm_clear_session_errors(session);
     for (size_t i = 0; i < DM_DATASTORE_COUNT; i++) {
         dm_free_sess_operations(session->operations[i], session->oper_count[i]);
@@ -1747,15 +2698,17 @@ dm_get_data_info(dm_ctx_t *dm_ctx, dm_session_t *dm_session_ctx, const char *mod
     int rc = SR_ERR_OK;
     dm_data_info_t *exisiting_data_info = NULL;
     dm_schema_info_t *schema_info = NULL;
+    sr_list_t *evicted = NULL;
 
     rc = dm_get_module_and_lock(dm_ctx, module_name, &schema_info);
     CHECK_RC_LOG_RETURN(rc, "Get module '%s' failed", module_name);
 
     dm_data_info_t lookup_data = {0};
     lookup_data.schema = schema_info;
-    exisiting_data_info = sr_btree_search(dm_session_ctx->session_modules[dm_session_ctx->datastore], &lookup_data);
+    exisiting_data_info = sr_omap_search(dm_session_ctx->session_modules[dm_session_ctx->datastore], &lookup_data);
 
     if (NULL != exisiting_data_info) {
+        exisiting_data_info->last_access = ++dm_session_ctx->access_tick;
         *info = exisiting_data_info;
         SR_LOG_DBG("Module %s already loaded", module_name);
         goto cleanup;
@@ -1776,20 +2729,36 @@ dm_get_data_info(dm_ctx_t *dm_ctx, dm_session_t *dm_session_ctx, const char *mod
     else {
         rc = dm_load_data_tree(dm_ctx, dm_session_ctx, schema_info, dm_session_ctx->datastore, &di);
         CHECK_RC_LOG_GOTO(rc, cleanup, "Getting data tree for %s failed.", module_name);
-    }
-
-    rc = sr_btree_insert(dm_session_ctx->session_modules[dm_session_ctx->datastore], (void *) di);
-    if (SR_ERR_OK != rc) {
-        SR_LOG_ERR("Insert into session avl failed module %s", module_name);
+        if (SR_DS_RUNNING == dm_session_ctx->datastore) {
+            /* changes made in running are notified, track them to speed up the diff */
+            rc = dm_track_changes(di);
+            if (SR_ERR_OK != rc) {
+                dm_data_info_free(di);
+                SR_LOG_ERR("Tracking of changes in model %s failed", module_name);
+                goto cleanup;
+            }
+        }
+    }
+
+    rc = sr_omap_insert(dm_session_ctx->session_modules[dm_session_ctx->datastore], (void *) di);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR("Insert into session avl failed module %s", module_name);
         dm_data_info_free(di);
         goto cleanup;
     }
 
+    di->last_access = ++dm_session_ctx->access_tick;
+    evicted = dm_session_ctx->evicted_modules[dm_session_ctx->datastore];
+    if (NULL != evicted && evicted->count > 0 && SR_ERR_OK == sr_list_rm(evicted, schema_info)) {
+        __atomic_add_fetch(&dm_ctx->mem_reloads, 1, __ATOMIC_RELAXED);
+        SR_LOG_DBG("Evicted copy of module %s has been reloaded", module_name);
+    }
+
     SR_LOG_DBG("Module %s has been loaded", module_name);
     *info = di;
 
 cleanup:
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
     return rc;
 }
 
@@ -1808,6 +2777,23 @@ dm_get_datatree(dm_ctx_t *dm_ctx, dm_session_t *dm_session_ctx, const char *modu
     return rc;
 }
 
+int
+dm_get_loaded_datatree(dm_session_t *dm_session_ctx, const char *module_name, struct lyd_node **data_tree)
+{
+    CHECK_NULL_ARG3(dm_session_ctx, module_name, data_tree);
+    dm_data_info_t *info = NULL;
+    size_t i = 0;
+
+    while (NULL != (info = sr_omap_get_at(dm_session_ctx->session_modules[dm_session_ctx->datastore], i++))) {
+        if (0 == strcmp(module_name, info->schema->module_name)) {
+            *data_tree = info->node;
+            return NULL != info->node ? SR_ERR_OK : SR_ERR_NOT_FOUND;
+        }
+    }
+
+    return SR_ERR_NOT_FOUND;
+}
+
 static int
 dm_get_module_internal(dm_ctx_t *dm_ctx, const char *module_name, bool lock, bool write, dm_schema_info_t **schema_info)
 {
@@ -1819,7 +2805,7 @@ dm_get_module_internal(dm_ctx_t *dm_ctx, const char *module_name, bool lock, boo
 
     lookup.module_name = (char *) module_name;
     RWLOCK_RDLOCK_TIMED_CHECK_RETURN(&dm_ctx->schema_tree_lock);
-    sch_info = sr_btree_search(dm_ctx->schema_info_tree, &lookup);
+    sch_info = sr_omap_search(dm_ctx->schema_info_tree, &lookup);
 
     if (NULL != sch_info) {
         /* there is matching item in schema info tree */
@@ -1833,7 +2819,7 @@ dm_get_module_internal(dm_ctx_t *dm_ctx, const char *module_name, bool lock, boo
 
             if (NULL == sch_info->ly_ctx) {
                 SR_LOG_DBG("Module %s has been uninstalled", sch_info->module_name);
-                pthread_rwlock_unlock(&sch_info->model_lock);
+                sr_rwlock_unlock(&sch_info->model_lock);
                 rc = SR_ERR_UNKNOWN_MODEL;
                 goto cleanup;
             }
@@ -1842,7 +2828,7 @@ dm_get_module_internal(dm_ctx_t *dm_ctx, const char *module_name, bool lock, boo
         goto cleanup;
     } else {
         /* try to load schema */
-        pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+        sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
         rc = dm_load_module(dm_ctx, module_name, NULL, &sch_info);
         if (SR_ERR_OK == rc && lock) {
             if (write) {
@@ -1853,7 +2839,7 @@ dm_get_module_internal(dm_ctx_t *dm_ctx, const char *module_name, bool lock, boo
 
             if (NULL == sch_info->ly_ctx) {
                 SR_LOG_DBG("Module %s has been uninstalled", sch_info->module_name);
-                pthread_rwlock_unlock(&sch_info->model_lock);
+                sr_rwlock_unlock(&sch_info->model_lock);
                 rc = SR_ERR_UNKNOWN_MODEL;
             } else {
                 *schema_info = sch_info;
@@ -1865,7 +2851,7 @@ dm_get_module_internal(dm_ctx_t *dm_ctx, const char *module_name, bool lock, boo
     return rc;
 
 cleanup:
-    pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
     return rc;
 }
 
@@ -1889,7 +2875,7 @@ dm_get_module_without_lock(dm_ctx_t *dm_ctx, const char *module_name, dm_schema_
 
     rc = dm_get_module_and_lock(dm_ctx, module_name, schema_info);
     if (SR_ERR_OK == rc) {
-        pthread_rwlock_unlock(&(*schema_info)->model_lock);
+        sr_rwlock_unlock(&(*schema_info)->model_lock);
     }
     return rc;
 }
@@ -2140,70 +3126,137 @@ dm_get_schema(dm_ctx_t *dm_ctx, const char *module_name, const char *module_revi
     CHECK_ZERO_LOG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "Module %s print failed.", si->module_name);
 
 cleanup:
-    pthread_rwlock_unlock(&si->model_lock);
+    sr_rwlock_unlock(&si->model_lock);
     return rc;
 }
 
+/**
+ * @brief Validation job of a single module data tree.
+ */
+typedef struct dm_validation_job_s {
+    dm_data_info_t *info;   /**< data tree to be validated */
+    bool failed;            /**< flag whether the validation failed */
+    char *err_msg;          /**< validation error message */
+    char *err_xpath;        /**< xpath of the node where the validation failed */
+} dm_validation_job_t;
+
+/**
+ * @brief Validates one data tree, the validation error (if any) is stored in the job.
+ * Does not access the session, therefore jobs of the modules without cross-module data
+ * dependency can be executed in parallel.
+ */
+static int
+dm_validate_data_info(void *arg)
+{
+    CHECK_NULL_ARG(arg);
+    dm_validation_job_t *job = (dm_validation_job_t *) arg;
+    dm_data_info_t *info = job->info;
+    const char *err_xpath = NULL;
+
+    if (0 != lyd_validate(&info->node, LYD_OPT_STRICT | LYD_OPT_NOAUTODEL | LYD_OPT_CONFIG, info->schema->ly_ctx)) {
+        SR_LOG_DBG("Validation failed for %s module", info->schema->module->name);
+        job->failed = true;
+        /* libyang error information is thread-specific, copy it */
+        job->err_msg = strdup(ly_errmsg());
+        CHECK_NULL_NOMEM_RETURN(job->err_msg);
+        err_xpath = ly_errpath();
+        if (NULL != err_xpath) {
+            job->err_xpath = strdup(err_xpath);
+            CHECK_NULL_NOMEM_RETURN(job->err_xpath);
+        }
+    } else {
+        SR_LOG_DBG("Validation succeeded for '%s' module", info->schema->module->name);
+    }
+    return SR_ERR_OK;
+}
+
 int
 dm_validate_session_data_trees(dm_ctx_t *dm_ctx, dm_session_t *session, sr_error_info_t **errors, size_t *err_cnt)
 {
     CHECK_NULL_ARG4(dm_ctx, session, errors, err_cnt);
     int rc = SR_ERR_OK;
 
-    size_t cnt = 0;
+    size_t cnt = 0, job_cnt = 0, indep_cnt = 0;
     *err_cnt = 0;
     dm_data_info_t *info = NULL;
-    sr_llist_t *session_modules = NULL;
-    sr_llist_node_t *node = NULL;
+    dm_validation_job_t *jobs = NULL;
+    void **indep_jobs = NULL;
     bool validation_failed = false;
 
-    rc = sr_llist_init(&session_modules);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot initialize temporary linked-list for session modules.");
+    /* count the modified modules first, the list of session modules may change during the validation */
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], cnt++))) {
+        /* loaded data trees are valid, so check only the modified ones */
+        if (info->modified) {
+            job_cnt++;
+        }
+    }
+    if (0 == job_cnt) {
+        return SR_ERR_OK;
+    }
+
+    jobs = calloc(job_cnt, sizeof(*jobs));
+    CHECK_NULL_NOMEM_GOTO(jobs, rc, cleanup);
+    indep_jobs = calloc(job_cnt, sizeof(*indep_jobs));
+    CHECK_NULL_NOMEM_GOTO(indep_jobs, rc, cleanup);
 
-    /* collect the list of modules first, it may change during the validation */
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], cnt))) {
-        sr_llist_add_new(session_modules, info);
-        cnt++;
+    cnt = 0;
+    job_cnt = 0;
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], cnt++))) {
+        if (!info->modified) {
+            continue;
+        }
+        if (NULL == info->schema->module || NULL == info->schema->module->name) {
+            SR_LOG_ERR_MSG("Missing schema information");
+            rc = SR_ERR_INTERNAL;
+            goto cleanup;
+        }
+        jobs[job_cnt].info = info;
+        if (!info->schema->cross_module_data_dependency) {
+            indep_jobs[indep_cnt++] = &jobs[job_cnt];
+        }
+        job_cnt++;
     }
 
-    node = session_modules->first;
-    while (NULL != node) {
-        info = (dm_data_info_t *)node->data;
-        /* loaded data trees are valid, so check only the modified ones */
-        if (info->modified) {
-            if (NULL == info->schema->module || NULL == info->schema->module->name) {
-                SR_LOG_ERR_MSG("Missing schema information");
-                rc = SR_ERR_INTERNAL;
-                goto cleanup;
-            }
-            /* attach data dependant modules */
-            if (info->schema->cross_module_data_dependency) {
-                rc = dm_load_dependant_data(dm_ctx, session, info);
-                CHECK_RC_LOG_GOTO(rc, cleanup, "Loading dependant modules failed for %s", info->schema->module_name);
-            }
-            if (0 != lyd_validate(&info->node, LYD_OPT_STRICT | LYD_OPT_NOAUTODEL | LYD_OPT_CONFIG, info->schema->ly_ctx)) {
-                SR_LOG_DBG("Validation failed for %s module", info->schema->module->name);
-                if (SR_ERR_OK != sr_add_error(errors, err_cnt, ly_errpath(), "%s", ly_errmsg())) {
-                    SR_LOG_WRN_MSG("Failed to record validation error");
-                }
-                validation_failed = true;
-            } else {
-                SR_LOG_DBG("Validation succeeded for '%s' module", info->schema->module->name);
-            }
-            if (info->schema->cross_module_data_dependency) {
-                /* remove data appended from other modules for the purpose of validation */
-                rc = dm_remove_added_data_trees(session, info);
-                CHECK_RC_MSG_GOTO(rc, cleanup, "Removing of added data trees failed");
-            }
+    /* modules without cross-module data dependency are independent, validate them in parallel */
+    rc = dm_worker_pool_run(dm_ctx->worker_pool, dm_validate_data_info, indep_jobs, indep_cnt);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Validation of independent modules failed");
+
+    /* modules with data dependencies attach data from the session, validate them sequentially */
+    for (size_t i = 0; i < job_cnt; i++) {
+        info = jobs[i].info;
+        if (!info->schema->cross_module_data_dependency) {
+            continue;
         }
-        node = node->next;
+        /* attach data dependant modules */
+        rc = dm_load_dependant_data(dm_ctx, session, info);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Loading dependant modules failed for %s", info->schema->module_name);
+
+        rc = dm_validate_data_info(&jobs[i]);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Validation failed for %s", info->schema->module_name);
+
+        /* remove data appended from other modules for the purpose of validation */
+        rc = dm_remove_added_data_trees(session, info);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Removing of added data trees failed");
     }
 
 cleanup:
+    /* errors are reported in the order of the session modules, regardless of the order of validation */
+    for (size_t i = 0; NULL != jobs && i < job_cnt; i++) {
+        if (jobs[i].failed) {
+            if (SR_ERR_OK != sr_add_error(errors, err_cnt, jobs[i].err_xpath, "%s",
+                        NULL != jobs[i].err_msg ? jobs[i].err_msg : "Validation failed")) {
+                SR_LOG_WRN_MSG("Failed to record validation error");
+            }
+            validation_failed = true;
+        }
+        free(jobs[i].err_msg);
+        free(jobs[i].err_xpath);
+    }
     if (validation_failed) {
         rc = SR_ERR_VALIDATION_FAILED;
     }
-    sr_llist_cleanup(session_modules);
+    free(indep_jobs);
+    free(jobs);
     return rc;
 }
 
@@ -2213,11 +3266,12 @@ dm_discard_changes(dm_ctx_t *dm_ctx, dm_session_t *session)
     CHECK_NULL_ARG2(dm_ctx, session);
     int rc = SR_ERR_OK;
 
-    sr_btree_cleanup(session->session_modules[session->datastore]);
+    sr_omap_cleanup(session->session_modules[session->datastore]);
     session->session_modules[session->datastore] = NULL;
 
-    rc = sr_btree_init(dm_data_info_cmp, dm_data_info_free, &session->session_modules[session->datastore]);
-    CHECK_RC_MSG_RETURN(rc, "Binary tree allocation failed");
+    rc = sr_omap_init(dm_data_info_cmp, dm_data_info_hash, dm_data_info_free,
+            &session->session_modules[session->datastore]);
+    CHECK_RC_MSG_RETURN(rc, "Ordered map allocation failed");
     dm_free_sess_operations(session->operations[session->datastore], session->oper_count[session->datastore]);
     session->operations[session->datastore] = NULL;
     session->oper_count[session->datastore] = 0;
@@ -2232,7 +3286,7 @@ dm_remove_modified_flag(dm_session_t* session)
     int rc = SR_ERR_OK;
     dm_data_info_t *info = NULL;
     size_t cnt = 0;
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], cnt))) {
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], cnt))) {
         /* remove modified flag */
         info->modified = false;
         cnt++;
@@ -2310,7 +3364,7 @@ dm_update_session_data_trees(dm_ctx_t *dm_ctx, dm_session_t *session, sr_list_t
     rc = sr_list_init(&up_to_date);
     CHECK_RC_MSG_GOTO(rc, cleanup, "List init failed");
 
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], i++))) {
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i++))) {
         rc = sr_get_data_file_name(dm_ctx->data_search_dir,
                 info->schema->module->name,
                 SR_DS_CANDIDATE == session->datastore ? SR_DS_RUNNING : session->datastore,
@@ -2364,7 +3418,7 @@ dm_update_session_data_trees(dm_ctx_t *dm_ctx, dm_session_t *session, sr_list_t
     }
 
     for (i = 0; i < to_be_refreshed->count; i++) {
-        sr_btree_delete(session->session_modules[session->datastore], to_be_refreshed->data[i]);
+        sr_omap_delete(session->session_modules[session->datastore], to_be_refreshed->data[i]);
     }
 
 cleanup:
@@ -2459,6 +3513,145 @@ not_matched:
     return SR_ERR_OK;
 }
 
+/**
+ * @brief Returns the entry of the subscription index for the schema node, creates it if it does not exist.
+ * @param [in] index
+ * @param [in] schema
+ * @param [out] entry
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_subscription_index_get_entry(sr_omap_t *index, const struct lys_node *schema, dm_subscription_index_entry_t **entry)
+{
+    CHECK_NULL_ARG3(index, schema, entry);
+    dm_subscription_index_entry_t lookup = {0}, *e = NULL;
+    int rc = SR_ERR_OK;
+
+    lookup.schema = schema;
+    e = sr_omap_search(index, &lookup);
+    if (NULL == e) {
+        e = calloc(1, sizeof(*e));
+        CHECK_NULL_NOMEM_RETURN(e);
+        e->schema = schema;
+        rc = sr_omap_insert(index, e);
+        if (SR_ERR_OK != rc) {
+            free(e);
+            SR_LOG_ERR_MSG("Insert into subscription index failed");
+            return rc;
+        }
+    }
+    *entry = e;
+    return rc;
+}
+
+/**
+ * @brief Builds the index mapping the schema nodes to the subscriptions. Each subscribed schema node
+ * holds the list of its subscriptions, its ancestors are marked as having a subscribed descendant.
+ * @param [in] ms
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_build_subscription_index(dm_model_subscription_t *ms)
+{
+    CHECK_NULL_ARG(ms);
+    dm_subscription_index_entry_t *entry = NULL;
+    const struct lys_node *n = NULL;
+    size_t *subs = NULL;
+    int rc = SR_ERR_OK;
+
+    rc = sr_omap_init(dm_subscription_index_entry_cmp, NULL, dm_subscription_index_entry_free, &ms->subscription_index);
+    CHECK_RC_MSG_RETURN(rc, "Subscription index init failed");
+
+    for (size_t s = 0; s < ms->subscription_cnt; s++) {
+        if (NULL == ms->nodes[s]) {
+            /* subscription to the whole module */
+            continue;
+        }
+        rc = dm_subscription_index_get_entry(ms->subscription_index, ms->nodes[s], &entry);
+        CHECK_RC_MSG_RETURN(rc, "Failed to get subscription index entry");
+
+        subs = realloc(entry->subscriptions, (entry->subscription_cnt + 1) * sizeof(*entry->subscriptions));
+        CHECK_NULL_NOMEM_RETURN(subs);
+        entry->subscriptions = subs;
+        entry->subscriptions[entry->subscription_cnt++] = s;
+
+        /* mark the ancestors, stop at the first one already marked */
+        for (n = lys_parent(ms->nodes[s]); NULL != n; n = lys_parent(n)) {
+            rc = dm_subscription_index_get_entry(ms->subscription_index, n, &entry);
+            CHECK_RC_MSG_RETURN(rc, "Failed to get subscription index entry");
+            if (entry->subscribed_descendant) {
+                break;
+            }
+            entry->subscribed_descendant = true;
+        }
+    }
+
+    return rc;
+}
+
+/**
+ * @brief Marks the subscriptions of the index entry as matched.
+ * @param [in] entry
+ * @param [in,out] matched
+ * @param [in,out] unmatched_cnt - number of subscriptions not matched yet
+ */
+static void
+dm_subscription_index_mark(const dm_subscription_index_entry_t *entry, bool *matched, size_t *unmatched_cnt)
+{
+    if (NULL == entry) {
+        return;
+    }
+    for (size_t i = 0; i < entry->subscription_cnt; i++) {
+        if (!matched[entry->subscriptions[i]]) {
+            matched[entry->subscriptions[i]] = true;
+            (*unmatched_cnt)--;
+        }
+    }
+}
+
+/**
+ * @brief Marks the subscriptions that are matched by the changed node using the subscription index.
+ * Equivalent to ::dm_match_subscription called for each subscription of the module.
+ * @param [in] ms
+ * @param [in] node tested node
+ * @param [in,out] matched - array of flags for each subscription of the module
+ * @param [in,out] unmatched_cnt - number of subscriptions not matched yet
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_match_subscriptions_index(const dm_model_subscription_t *ms, const struct lyd_node *node, bool *matched, size_t *unmatched_cnt)
+{
+    CHECK_NULL_ARG5(ms, ms->subscription_index, node, matched, unmatched_cnt);
+    dm_subscription_index_entry_t lookup = {0}, *entry = NULL;
+    const struct lys_node *n = NULL;
+
+    /* subscriptions to the node or any of its ancestors */
+    for (n = node->schema; NULL != n && 0 < *unmatched_cnt; n = lys_parent(n)) {
+        lookup.schema = n;
+        dm_subscription_index_mark(sr_omap_search(ms->subscription_index, &lookup), matched, unmatched_cnt);
+    }
+
+    /* if a container/list has been created/deleted check the subscriptions to its created/deleted children */
+    if (0 < *unmatched_cnt && ((LYS_CONTAINER | LYS_LIST) & node->schema->nodetype)) {
+        lookup.schema = node->schema;
+        entry = sr_omap_search(ms->subscription_index, &lookup);
+        if (NULL == entry || !entry->subscribed_descendant) {
+            return SR_ERR_OK;
+        }
+
+        struct lyd_node *next = NULL, *iter = NULL;
+        LY_TREE_DFS_BEGIN((struct lyd_node *) node, next, iter) {
+            if (iter != node) {
+                lookup.schema = iter->schema;
+                dm_subscription_index_mark(sr_omap_search(ms->subscription_index, &lookup), matched, unmatched_cnt);
+            }
+            LYD_TREE_DFS_END(node, next, iter);
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
 /**
  * @brief Returns the node to be tested whether the changes matches the subscription
  * @param [in] diff
@@ -2598,6 +3791,9 @@ dm_prepare_module_subscriptions(dm_ctx_t *dm_ctx, dm_schema_info_t *schema_info,
         }
     }
 
+    rc = dm_build_subscription_index(ms);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Failed to build subscription index for module %s", schema_info->module_name);
+
     ms->schema_info = schema_info;
 
 cleanup:
@@ -2626,14 +3822,14 @@ dm_free_commit_context(void *commit_ctx)
         c_ctx->existed = NULL;
         c_ctx->modif_count = 0;
 
-        sr_btree_cleanup(c_ctx->subscriptions);
-        sr_btree_cleanup(c_ctx->prev_data_trees);
+        sr_omap_cleanup(c_ctx->subscriptions);
+        sr_omap_cleanup(c_ctx->prev_data_trees);
         if (NULL != c_ctx->session) {
             dm_session_stop(c_ctx->session->dm_ctx, c_ctx->session);
         }
         if (NULL != c_ctx->err_subs_xpaths) {
             for (size_t i = 0; i < c_ctx->err_subs_xpaths->count; i++) {
-                free(c_ctx->err_subs_xpaths->data[i]);
+                sr_str_release(c_ctx->err_subs_xpaths->data[i]);
             }
             sr_list_cleanup(c_ctx->err_subs_xpaths);
         }
@@ -2645,32 +3841,132 @@ dm_free_commit_context(void *commit_ctx)
     }
 }
 
+const char *
+dm_commit_state_to_str(dm_commit_state_t state)
+{
+    switch (state) {
+        case DM_COMMIT_STARTED:
+            return "started";
+        case DM_COMMIT_VALIDATION:
+            return "validation";
+        case DM_COMMIT_LOAD_MODIFIED_MODELS:
+            return "load-modified-models";
+        case DM_COMMIT_REPLAY_OPS:
+            return "replay-operations";
+        case DM_COMMIT_VALIDATE_MERGED:
+            return "validate-merged";
+        case DM_COMMIT_NOTIFY_VERIFY:
+            return "notify-verify";
+        case DM_COMMIT_WAIT_FOR_NOTIFICATIONS:
+            return "wait-for-verifiers";
+        case DM_COMMIT_WRITE:
+            return "write";
+        case DM_COMMIT_NOTIFY_APPLY:
+            return "notify-apply";
+        case DM_COMMIT_NOTIFY_ABORT:
+            return "notify-abort";
+        case DM_COMMIT_FINISHED:
+            return "finished";
+        default:
+            return "unknown";
+    }
+}
+
+void
+dm_commit_trace(const dm_commit_context_t *c_ctx, int result)
+{
+    char modules[PATH_MAX] = { 0, };
+    char stages[PATH_MAX] = { 0, };
+    dm_data_info_t *info = NULL;
+    size_t len = 0, i = 0;
+    int ret = 0;
+
+    if (NULL == c_ctx || NULL == c_ctx->session) {
+        return;
+    }
+
+    /* merged session of the commit holds data trees of the committed modules only */
+    while (NULL != (info = sr_omap_get_at(c_ctx->session->session_modules[c_ctx->session->datastore], i++))) {
+        ret = snprintf(modules + len, PATH_MAX - len, "%s%s", 0 == len ? "" : ",", info->schema->module_name);
+        if (ret < 0 || (size_t) ret >= PATH_MAX - len) {
+            break;
+        }
+        len += ret;
+    }
+
+    len = 0;
+    for (dm_commit_state_t stage = DM_COMMIT_VALIDATION; stage < DM_COMMIT_FINISHED; ++stage) {
+        ret = snprintf(stages + len, PATH_MAX - len, " %s=%"PRIu64, dm_commit_state_to_str(stage), c_ctx->stage_time[stage]);
+        if (ret < 0 || (size_t) ret >= PATH_MAX - len) {
+            break;
+        }
+        len += ret;
+    }
+
+    SR_LOG_INF("Commit trace: id=%"PRIu32" datastore=%s result=%s modules=%s operations=%zu total=%"PRIu64"%s",
+            c_ctx->id, sr_ds_to_str(c_ctx->session->datastore), sr_strerror(result), modules, c_ctx->oper_count,
+            sr_clock_elapsed_us(&c_ctx->started), stages);
+
+    SR_PROBE(commit_done, c_ctx->id, result, c_ctx->oper_count, sr_clock_elapsed_us(&c_ctx->started),
+            c_ctx->stage_time[DM_COMMIT_VALIDATION] + c_ctx->stage_time[DM_COMMIT_VALIDATE_MERGED],
+            c_ctx->stage_time[DM_COMMIT_WAIT_FOR_NOTIFICATIONS], c_ctx->stage_time[DM_COMMIT_WRITE]);
+}
+
+/**
+ * @brief Adds the data trees stored in the map into the memory usage.
+ */
+static void
+dm_data_infos_mem_usage(const sr_omap_t *data_infos, dm_mem_usage_t *usage)
+{
+    dm_data_info_t *info = NULL;
+    size_t i = 0, node_cnt = 0;
+
+    while (NULL != (info = sr_omap_get_at(data_infos, i++))) {
+        if (!info->rdonly_copy) {
+            usage->mem_size += sizeof *info + dm_data_tree_mem_usage(info->node, &node_cnt);
+            usage->node_cnt += node_cnt;
+            usage->tree_cnt += 1;
+        }
+    }
+}
+
 static int
 dm_insert_commit_context(dm_ctx_t *dm_ctx, dm_commit_context_t *c_ctx)
 {
     CHECK_NULL_ARG2(dm_ctx, c_ctx);
+    dm_mem_usage_t usage = { 0, };
     int rc = SR_ERR_OK;
-    pthread_rwlock_wrlock(&dm_ctx->commit_ctxs.lock);
-    rc = sr_btree_insert(dm_ctx->commit_ctxs.tree, c_ctx);
-    pthread_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
+
+    /* merged and previous data trees are retained until all subscribers are notified */
+    if (NULL != c_ctx->session) {
+        dm_data_infos_mem_usage(c_ctx->session->session_modules[c_ctx->session->datastore], &usage);
+    }
+    if (NULL != c_ctx->prev_data_trees) {
+        dm_data_infos_mem_usage(c_ctx->prev_data_trees, &usage);
+    }
+
+    sr_rwlock_wrlock(&dm_ctx->commit_ctxs.lock);
+    c_ctx->mem_usage = usage;
+    rc = sr_omap_insert(dm_ctx->commit_ctxs.tree, c_ctx);
+    sr_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
     return rc;
 }
 
 static int
 dm_remove_commit_context(dm_ctx_t *dm_ctx, uint32_t c_ctx_id)
 {
-    pthread_rwlock_wrlock(&dm_ctx->commit_ctxs.lock);
+    sr_rwlock_wrlock(&dm_ctx->commit_ctxs.lock);
     dm_commit_context_t *c_ctx = NULL;
     dm_commit_context_t lookup = {0};
     lookup.id = c_ctx_id;
-    c_ctx = sr_btree_search(dm_ctx->commit_ctxs.tree, &lookup);
+    c_ctx = sr_omap_search(dm_ctx->commit_ctxs.tree, &lookup);
     if (NULL == c_ctx) {
         SR_LOG_WRN("Commit context with id %d not found", c_ctx_id);
     } else {
-        sr_btree_delete(dm_ctx->commit_ctxs.tree, c_ctx);
+        sr_omap_delete(dm_ctx->commit_ctxs.tree, c_ctx);
         SR_LOG_DBG("Commit context with id %"PRIu32" removed", c_ctx_id);
     }
-    pthread_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
+    sr_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
     return SR_ERR_OK;
 }
 
@@ -2720,22 +4016,22 @@ static int
 dm_create_commit_ctx_id(dm_ctx_t *dm_ctx, dm_commit_context_t *c_ctx) {
     CHECK_NULL_ARG2(dm_ctx, c_ctx);
 
-    pthread_rwlock_rdlock(&dm_ctx->commit_ctxs.lock);
+    sr_rwlock_rdlock(&dm_ctx->commit_ctxs.lock);
     size_t attempts = 0;
     /* generate unique id */
     do {
         c_ctx->id = rand();
-        if (NULL != sr_btree_search(dm_ctx->commit_ctxs.tree, c_ctx)) {
+        if (NULL != sr_omap_search(dm_ctx->commit_ctxs.tree, c_ctx)) {
             c_ctx->id = DM_COMMIT_CTX_ID_INVALID;
         }
         if (++attempts > DM_COMMIT_CTX_ID_MAX_ATTEMPTS) {
             SR_LOG_ERR_MSG("Unable to generate an unique session_id.");
-            pthread_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
+            sr_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
             return SR_ERR_INTERNAL;
         }
     } while (DM_COMMIT_CTX_ID_INVALID == c_ctx->id);
 
-    pthread_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
+    sr_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
     return SR_ERR_OK;
 }
 
@@ -2757,15 +4053,16 @@ dm_commit_prepare_context(dm_ctx_t *dm_ctx, dm_session_t *session, dm_commit_con
 
     pthread_mutex_init(&c_ctx->mutex, NULL);
 
-    rc = sr_btree_init(dm_module_subscription_cmp, dm_model_subscription_free, &c_ctx->subscriptions);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Binary tree allocation failed");
+    rc = sr_omap_init(dm_module_subscription_cmp, dm_module_subscription_hash, dm_model_subscription_free,
+            &c_ctx->subscriptions);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Ordered map allocation failed");
 
-    rc = sr_btree_init(dm_data_info_cmp, dm_data_info_free, &c_ctx->prev_data_trees);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Binary tree allocation failed");
+    rc = sr_omap_init(dm_data_info_cmp, dm_data_info_hash, dm_data_info_free, &c_ctx->prev_data_trees);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Ordered map allocation failed");
 
     c_ctx->modif_count = 0;
     /* count modified files */
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], i))) {
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i))) {
         if (info->modified) {
             c_ctx->modif_count++;
 
@@ -2773,7 +4070,7 @@ dm_commit_prepare_context(dm_ctx_t *dm_ctx, dm_session_t *session, dm_commit_con
                 rc = dm_prepare_module_subscriptions(dm_ctx, info->schema, &ms);
                 CHECK_RC_LOG_GOTO(rc, cleanup, "Prepare module subscription failed %s", info->schema->module->name);
 
-                rc = sr_btree_insert(c_ctx->subscriptions, ms);
+                rc = sr_omap_insert(c_ctx->subscriptions, ms);
                 CHECK_RC_LOG_GOTO(rc, cleanup, "Insert into subscription tree failed module %s", info->schema->module->name);
             }
             ms = NULL;
@@ -2878,7 +4175,7 @@ dm_commit_load_modified_models(dm_ctx_t *dm_ctx, const dm_session_t *session, dm
     c_ctx->modif_count = 0; /* how many file descriptors should be closed on cleanup */
 
     /* lock models that should be committed */
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], i++))) {
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i++))) {
         if (!info->modified) {
             continue;
         }
@@ -2904,7 +4201,7 @@ dm_commit_load_modified_models(dm_ctx_t *dm_ctx, const dm_session_t *session, dm
 
     ac_set_user_identity(dm_ctx->ac_ctx, session->user_credentials);
 
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], i++))) {
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i++))) {
         if (!info->modified) {
             continue;
         }
@@ -2973,13 +4270,31 @@ dm_commit_load_modified_models(dm_ctx_t *dm_ctx, const dm_session_t *session, dm
             SR_LOG_DBG("Usage count %s incremented (value=%zu)", info->schema->module_name, info->schema->usage_count);
             pthread_mutex_unlock(&info->schema->usage_count_mutex);
             di->schema = info->schema;
+            if (copy_uptodate && SR_DS_RUNNING == session->datastore) {
+                /* session copy is based on the current file content, its changes can be reused */
+                rc = dm_copy_changed_paths(info, di);
+                if (SR_ERR_OK != rc) {
+                    SR_LOG_ERR_MSG("Copying of tracked changes failed");
+                    dm_data_info_free(di);
+                    goto cleanup;
+                }
+            }
         } else {
             /* if the file existed pass FILE 'r+', otherwise pass -1 because there is 'w' fd already */
             rc = dm_load_data_tree_file(dm_ctx, c_ctx->existed[count] ? c_ctx->fds[count] : -1, file_name, info->schema, &di);
             CHECK_RC_MSG_GOTO(rc, cleanup, "Loading data file failed");
+            if (SR_DS_RUNNING == session->datastore) {
+                /* track the changes made by replayed operations */
+                rc = dm_track_changes(di);
+                if (SR_ERR_OK != rc) {
+                    SR_LOG_ERR_MSG("Tracking of changes failed");
+                    dm_data_info_free(di);
+                    goto cleanup;
+                }
+            }
         }
 
-        rc = sr_btree_insert(c_ctx->session->session_modules[c_ctx->session->datastore], (void *) di);
+        rc = sr_omap_insert(c_ctx->session->session_modules[c_ctx->session->datastore], (void *) di);
         if (SR_ERR_OK != rc) {
             SR_LOG_ERR("Insert into commit session avl failed module %s", info->schema->module->name);
             dm_data_info_free(di);
@@ -2993,7 +4308,7 @@ dm_commit_load_modified_models(dm_ctx_t *dm_ctx, const dm_session_t *session, dm
                 rc = dm_load_data_tree_file(dm_ctx, c_ctx->existed[count] ? c_ctx->fds[count] : -1, file_name, info->schema, &di);
                 CHECK_RC_MSG_GOTO(rc, cleanup, "Loading data file failed");
 
-                rc = sr_btree_insert(c_ctx->prev_data_trees, (void *) di);
+                rc = sr_omap_insert(c_ctx->prev_data_trees, (void *) di);
                 if (SR_ERR_OK != rc) {
                     SR_LOG_ERR("Insert into prev data trees failed module %s", info->schema->module->name);
                     dm_data_info_free(di);
@@ -3034,11 +4349,11 @@ dm_commit_write_files(dm_session_t *session, dm_commit_context_t *c_ctx)
 
     /* write data trees */
     i = 0;
-    dm_data_info_t *merged_info = NULL;
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], i++))) {
+    dm_data_info_t *merged_info = NULL, *nacm_changed = NULL;
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i++))) {
         if (info->modified) {
             /* get merged info */
-            merged_info = sr_btree_search(c_ctx->session->session_modules[c_ctx->session->datastore], info);
+            merged_info = sr_omap_search(c_ctx->session->session_modules[c_ctx->session->datastore], info);
             if (NULL == merged_info) {
                 SR_LOG_ERR("Merged data info %s not found", info->schema->module->name);
                 rc = SR_ERR_INTERNAL;
@@ -3063,6 +4378,9 @@ dm_commit_write_files(dm_session_t *session, dm_commit_context_t *c_ctx)
                 rc = SR_ERR_INTERNAL;
             } else {
                 SR_LOG_DBG("Data successfully written for module '%s'", info->schema->module->name);
+                if (SR_DS_RUNNING == session->datastore && 0 == strcmp(NACM_MODULE_NAME, info->schema->module->name)) {
+                    nacm_changed = merged_info;
+                }
             }
             count++;
         }
@@ -3070,6 +4388,15 @@ dm_commit_write_files(dm_session_t *session, dm_commit_context_t *c_ctx)
     /* save time of the last commit */
     sr_clock_get_time(CLOCK_REALTIME, &session->dm_ctx->last_commit_time);
 
+    if (NULL != nacm_changed) {
+        /* the new rules apply to the requests following the commit */
+        ret = dm_nacm_reload(session->dm_ctx, nacm_changed->node);
+        if (SR_ERR_OK != ret) {
+            SR_LOG_ERR_MSG("Failed to reload NACM rules");
+            rc = ret;
+        }
+    }
+
     return rc;
 }
 
@@ -3081,6 +4408,8 @@ dm_commit_write_files(dm_session_t *session, dm_commit_context_t *c_ctx)
 static bool
 dm_should_skip_subscription(np_subscription_t *subscription, dm_commit_context_t *c_ctx, sr_notif_event_t ev)
 {
+    const char *subs_xpath = NULL;
+
     if (NULL == subscription || NULL == c_ctx) {
         return false;
     }
@@ -3093,11 +4422,11 @@ dm_should_skip_subscription(np_subscription_t *subscription, dm_commit_context_t
 
     /* if subscription returned an error don't send him abort */
     if (SR_EV_ABORT == ev && c_ctx->err_subs_xpaths != NULL) {
+        subs_xpath = NULL == subscription->xpath ? subscription->module_name : subscription->xpath;
         for (size_t e = 0; e < c_ctx->err_subs_xpaths->count; e++) {
-            if (0 == strcmp((char *) c_ctx->err_subs_xpaths->data[e],
-                    NULL == subscription->xpath ?
-                    subscription->module_name :
-                    subscription->xpath)) {
+            /* both strings are interned, the comparison short-circuits on pointer equality */
+            if (subs_xpath == c_ctx->err_subs_xpaths->data[e] ||
+                    0 == strcmp((char *) c_ctx->err_subs_xpaths->data[e], subs_xpath)) {
                 return true;
             }
         }
@@ -3106,132 +4435,283 @@ dm_should_skip_subscription(np_subscription_t *subscription, dm_commit_context_t
     return false;
 }
 
-int
-dm_commit_notify(dm_ctx_t *dm_ctx, dm_session_t *session, sr_notif_event_t ev, dm_commit_context_t *c_ctx)
+/**
+ * @brief Per-module job of commit notification - diff generation and subscription matching.
+ */
+typedef struct dm_commit_notify_job_s {
+    dm_commit_context_t *c_ctx;     /**< commit context */
+    dm_data_info_t *info;           /**< modified session data tree */
+    dm_model_subscription_t *ms;    /**< subscriptions of the module */
+    sr_notif_event_t ev;            /**< event to be notified */
+    bool *matched;                  /**< flags whether the subscription at the same index should be notified */
+} dm_commit_notify_job_t;
+
+/**
+ * @brief Generates the changes of the module (for SR_EV_VERIFY and SR_EV_ABORT) and decides which subscriptions
+ * should be notified. Jobs of different modules touch disjoint data and can be executed in parallel.
+ */
+static int
+dm_commit_notify_module(void *arg)
 {
-    CHECK_NULL_ARG3(dm_ctx, session, c_ctx);
+    CHECK_NULL_ARG(arg);
+    dm_commit_notify_job_t *job = (dm_commit_notify_job_t *) arg;
+    dm_commit_context_t *c_ctx = job->c_ctx;
+    dm_data_info_t *info = job->info;
+    dm_model_subscription_t *ms = job->ms;
+    dm_data_info_t *commit_info = NULL, *prev_info = NULL, lookup_info = {0};
+    struct lyd_difflist *diff = NULL;
+    size_t d_cnt = 0, unmatched_cnt = 0;
+    bool any_match = false, push_changes = false;
     int rc = SR_ERR_OK;
-    size_t i = 0;
-    dm_data_info_t *info = NULL, *commit_info = NULL, *prev_info = NULL, lookup_info = {0};
-    dm_model_subscription_t *ms = NULL;
-    bool match = false;
-    sr_list_t *notified_notif = NULL;
-    /* notification are sent only when running or candidate is committed*/
-    if (SR_DS_STARTUP == session->datastore) {
-        c_ctx->state = DM_COMMIT_WRITE;
-        return SR_ERR_OK;
-    }
-
-    rc = sr_list_init(&notified_notif);
-    CHECK_RC_MSG_RETURN(rc, "List init failed");
 
-    SR_LOG_DBG("Sending %s notifications about the changes made in running datastore...", sr_notification_event_sr_to_str(ev));
-    while (NULL != (info = sr_btree_get_at(session->session_modules[session->datastore], i++))) {
-        if (!info->modified) {
-            continue;
+    /* changes are generated only for SR_EV_VERIFY and SR_EV_ABORT */
+    if (SR_EV_VERIFY == job->ev || SR_EV_ABORT == job->ev) {
+        lookup_info.schema = info->schema;
+        /* configuration before commit */
+        prev_info = sr_omap_search(c_ctx->prev_data_trees, &lookup_info);
+        if (NULL == prev_info) {
+            SR_LOG_ERR("Current data tree for module %s not found", info->schema->module->name);
+            return SR_ERR_OK;
+        }
+        /* configuration after commit */
+        commit_info = sr_omap_search(c_ctx->session->session_modules[c_ctx->session->datastore], &lookup_info);
+        if (NULL == commit_info) {
+            SR_LOG_ERR("Commit data tree for module %s not found", info->schema->module->name);
+            return SR_ERR_OK;
         }
-        size_t d_cnt = 0;
-        dm_model_subscription_t lookup = {0};
-        struct lyd_difflist *diff = NULL;
-
-        lookup.schema_info = info->schema;
 
-        ms = sr_btree_search(c_ctx->subscriptions, &lookup);
-        if (NULL == ms) {
-            SR_LOG_WRN("No subscription found for %s", info->schema->module->name);
+        /* for SR_EV_ABORT inverse changes are generated */
+        rc = dm_get_data_info_diff(prev_info, commit_info, SR_EV_ABORT == job->ev, &diff);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_ERR("Diff failed for module %s", info->schema->module->name);
+            return SR_ERR_OK;
+        }
+        if (diff->type[d_cnt] == LYD_DIFF_END) {
+            SR_LOG_DBG("No changes in module %s", info->schema->module->name);
             lyd_free_diff(diff);
-            continue;
+            return SR_ERR_OK;
         }
 
-        /* changes are generated only for SR_EV_VERIFY and SR_EV_ABORT */
-        if (SR_EV_VERIFY == ev || SR_EV_ABORT == ev) {
-            lookup_info.schema = info->schema;
-            /* configuration before commit */
-            prev_info = sr_btree_search(c_ctx->prev_data_trees, &lookup_info);
-            if (NULL == prev_info) {
-                SR_LOG_ERR("Current data tree for module %s not found", info->schema->module->name);
-                continue;
-            }
-            /* configuration after commit */
-            commit_info = sr_btree_search(c_ctx->session->session_modules[c_ctx->session->datastore], &lookup_info);
-            if (NULL == commit_info) {
-                SR_LOG_ERR("Commit data tree for module %s not found", info->schema->module->name);
-                continue;
-            }
-
-            /* for SR_EV_ABORT inverse changes are generated */
-            diff = SR_EV_VERIFY == ev ?
-                lyd_diff(prev_info->node, commit_info->node, LYD_DIFFOPT_WITHDEFAULTS) :
-                lyd_diff(commit_info->node, prev_info->node, LYD_DIFFOPT_WITHDEFAULTS) ;
-            if (NULL == diff) {
-                SR_LOG_ERR("Lyd diff failed for module %s", info->schema->module->name);
-                continue;
-            }
-            if (diff->type[d_cnt] == LYD_DIFF_END) {
-                SR_LOG_DBG("No changes in module %s", info->schema->module->name);
-                lyd_free_diff(diff);
-                continue;
+        /* remove changes generated during verify phase */
+        pthread_rwlock_wrlock(&ms->changes_lock);
+        if (NULL != ms->changes) {
+            for (int i = 0; i < ms->changes->count; i++) {
+                sr_free_changes(ms->changes->data[i], 1);
             }
+            sr_list_cleanup(ms->changes);
+        }
+        ms->changes = NULL;
 
-            /* remove changes generated during verify phase */
-            if (NULL != ms->changes) {
-                for (int i = 0; i < ms->changes->count; i++) {
-                    sr_free_changes(ms->changes->data[i], 1);
-                }
-                sr_list_cleanup(ms->changes);
-            }
-            ms->changes = NULL;
+        lyd_free_diff(ms->difflist);
+        ms->changes_generated = false;
+        /* store differences in commit context */
+        ms->difflist = diff;
+        pthread_rwlock_unlock(&ms->changes_lock);
+    }
 
-            lyd_free_diff(ms->difflist);
-            ms->changes_generated = false;
-            /* store differences in commit context */
-            ms->difflist = diff;
+    /* Log changes */
+    if (NULL != diff && (SR_LL_DBG == sr_ll_stderr || SR_LL_DBG == sr_ll_syslog)) {
+        while (LYD_DIFF_END != diff->type[d_cnt]) {
+            char *path = dm_get_notification_changed_xpath(diff, d_cnt);
+            SR_LOG_DBG("%s: %s", dm_get_diff_type_to_string(diff->type[d_cnt]), path);
+            free(path);
+            d_cnt++;
         }
+    }
+
+    if (NULL == ms->difflist) {
+        return SR_ERR_OK;
+    }
 
-        /* Log changes */
-        if (NULL != diff && (SR_LL_DBG == sr_ll_stderr || SR_LL_DBG == sr_ll_syslog)) {
-            while (LYD_DIFF_END != diff->type[d_cnt]) {
-                char *path = dm_get_notification_changed_xpath(diff, d_cnt);
-                SR_LOG_DBG("%s: %s", dm_get_diff_type_to_string(diff->type[d_cnt]), path);
-                free(path);
-                d_cnt++;
+    /* subscriptions to the whole module are matched by any change */
+    unmatched_cnt = ms->subscription_cnt;
+    if (LYD_DIFF_END != ms->difflist->type[0]) {
+        for (size_t s = 0; s < ms->subscription_cnt; s++) {
+            if (NULL == ms->nodes[s]) {
+                job->matched[s] = true;
+                unmatched_cnt--;
             }
         }
+    }
+
+    /* match the changes against the subscription index, one walk per change */
+    for (d_cnt = 0; 0 < unmatched_cnt && LYD_DIFF_END != ms->difflist->type[d_cnt]; d_cnt++) {
+        const struct lyd_node *cmp_node = dm_get_notification_match_node(ms->difflist, d_cnt);
+        rc = dm_match_subscriptions_index(ms, cmp_node, job->matched, &unmatched_cnt);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_WRN_MSG("Subscription match failed");
+        }
+    }
 
-        if (NULL == ms->difflist) {
+    /* loop through subscription test if they should be notified */
+    for (size_t s = 0; s < ms->subscription_cnt; s++) {
+        if (dm_should_skip_subscription(ms->subscriptions[s], c_ctx, job->ev)) {
+            job->matched[s] = false;
             continue;
         }
+        any_match = any_match || job->matched[s];
+    }
 
-        /* loop through subscription test if they should be notified */
+    /* changes are pushed to the subscribers that requested it in any phase */
+    for (size_t s = 0; s < ms->subscription_cnt; s++) {
+        if (job->matched[s] && ms->subscriptions[s]->push_changes) {
+            push_changes = true;
+            break;
+        }
+    }
+
+    /* generate the changes once for all subscribers that are going to ask for them */
+    if (any_match && (SR_EV_VERIFY == job->ev || SR_EV_ABORT == job->ev || push_changes)) {
+        pthread_rwlock_wrlock(&ms->changes_lock);
+        if (!ms->changes_generated) {
+            rc = rp_dt_difflist_to_changes(ms->difflist, &ms->changes);
+            if (SR_ERR_OK == rc) {
+                ms->changes_generated = true;
+            } else {
+                /* changes will be generated on demand */
+                SR_LOG_WRN("Difflist to changes failed for module %s", info->schema->module->name);
+            }
+        }
+        pthread_rwlock_unlock(&ms->changes_lock);
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Selects the changes of the module matching the subscription to be pushed
+ * within the notification. Changes are expected to be generated, the list does not own them.
+ *
+ * @param [in] ms Model subscription
+ * @param [in] s Index of the subscription in model subscription
+ * @param [out] changes List of the matching changes, NULL if the changes are not available
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_select_pushed_changes(dm_model_subscription_t *ms, size_t s, sr_list_t **changes)
+{
+    CHECK_NULL_ARG2(ms, changes);
+    sr_list_t *selected = NULL;
+    int rc = SR_ERR_OK;
+
+    *changes = NULL;
+    if (!ms->changes_generated || NULL == ms->changes) {
+        return SR_ERR_OK;
+    }
+
+    rc = sr_list_init(&selected);
+    CHECK_RC_MSG_RETURN(rc, "List init failed");
+
+    for (size_t c = 0; c < ms->changes->count; c++) {
+        sr_change_t *change = ms->changes->data[c];
+        /* the same matching as applied when the subscriber asks for the changes of the subscribed subtree */
+        const struct lys_node *n = change->sch_node;
+        while (NULL != ms->nodes[s] && NULL != n && ms->nodes[s] != n) {
+            n = lys_parent(n);
+        }
+        if (NULL != ms->nodes[s] && NULL == n) {
+            continue;
+        }
+        rc = sr_list_add(selected, change);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "List add failed");
+    }
+
+    *changes = selected;
+    return SR_ERR_OK;
+
+cleanup:
+    sr_list_cleanup(selected);
+    return rc;
+}
+
+int
+dm_commit_notify(dm_ctx_t *dm_ctx, dm_session_t *session, sr_notif_event_t ev, dm_commit_context_t *c_ctx)
+{
+    CHECK_NULL_ARG3(dm_ctx, session, c_ctx);
+    int rc = SR_ERR_OK;
+    size_t i = 0, modif_cnt = 0, job_cnt = 0;
+    dm_data_info_t *info = NULL;
+    dm_model_subscription_t *ms = NULL;
+    dm_commit_notify_job_t *jobs = NULL;
+    void **job_args = NULL;
+    sr_list_t *notified_notif = NULL;
+    /* notification are sent only when running or candidate is committed*/
+    if (SR_DS_STARTUP == session->datastore) {
+        c_ctx->state = DM_COMMIT_WRITE;
+        return SR_ERR_OK;
+    }
+
+    rc = sr_list_init(&notified_notif);
+    CHECK_RC_MSG_RETURN(rc, "List init failed");
+
+    SR_LOG_DBG("Sending %s notifications about the changes made in running datastore...", sr_notification_event_sr_to_str(ev));
+
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i++))) {
+        if (info->modified) {
+            modif_cnt++;
+        }
+    }
+    i = 0;
+
+    jobs = calloc(modif_cnt > 0 ? modif_cnt : 1, sizeof(*jobs));
+    CHECK_NULL_NOMEM_GOTO(jobs, rc, cleanup);
+    job_args = calloc(modif_cnt > 0 ? modif_cnt : 1, sizeof(*job_args));
+    CHECK_NULL_NOMEM_GOTO(job_args, rc, cleanup);
+
+    while (NULL != (info = sr_omap_get_at(session->session_modules[session->datastore], i++))) {
+        if (!info->modified) {
+            continue;
+        }
+        dm_model_subscription_t lookup = {0};
+        lookup.schema_info = info->schema;
+
+        ms = sr_omap_search(c_ctx->subscriptions, &lookup);
+        if (NULL == ms) {
+            SR_LOG_WRN("No subscription found for %s", info->schema->module->name);
+            continue;
+        }
+        jobs[job_cnt].c_ctx = c_ctx;
+        jobs[job_cnt].info = info;
+        jobs[job_cnt].ms = ms;
+        jobs[job_cnt].ev = ev;
+        jobs[job_cnt].matched = calloc(ms->subscription_cnt > 0 ? ms->subscription_cnt : 1, sizeof(*jobs[job_cnt].matched));
+        CHECK_NULL_NOMEM_GOTO(jobs[job_cnt].matched, rc, cleanup);
+        job_args[job_cnt] = &jobs[job_cnt];
+        job_cnt++;
+    }
+
+    /* diffs of the modules are independent, generate them and match the subscriptions in parallel */
+    rc = dm_worker_pool_run(dm_ctx->worker_pool, dm_commit_notify_module, job_args, job_cnt);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Generating of changes failed");
+
+    /* send the notifications in the order of modules and subscription priorities */
+    for (size_t j = 0; j < job_cnt; j++) {
+        ms = jobs[j].ms;
         for (size_t s = 0; s < ms->subscription_cnt; s++) {
-            if (dm_should_skip_subscription(ms->subscriptions[s], c_ctx, ev)) {
+            if (!jobs[j].matched[s]) {
                 continue;
             }
-
-            for (d_cnt = 0; LYD_DIFF_END != ms->difflist->type[d_cnt]; d_cnt++) {
-                const struct lyd_node *cmp_node = dm_get_notification_match_node(ms->difflist, d_cnt);
-                rc = dm_match_subscription(ms->nodes[s], cmp_node, &match);
-                if (SR_ERR_OK != rc) {
-                    SR_LOG_WRN_MSG("Subscription match failed");
-                    continue;
-                }
-                if (match) {
-                    break;
+            /* something has been changed for this subscription, send notification */
+            sr_list_t *pushed_changes = NULL;
+            if (ms->subscriptions[s]->push_changes) {
+                pthread_rwlock_rdlock(&ms->changes_lock);
+                if (SR_ERR_OK != dm_select_pushed_changes(ms, s, &pushed_changes)) {
+                    SR_LOG_WRN("Unable to select the changes to be pushed for module %s", ms->subscriptions[s]->module_name);
                 }
             }
-
-            if (match) {
-                /* something has been changed for this subscription, send notification */
-                rc = np_subscription_notify(dm_ctx->np_ctx, ms->subscriptions[s], ev, c_ctx->id);
-                if (SR_ERR_OK != rc) {
-                   SR_LOG_WRN("Unable to send notifications about the changes for the subscription in module %s xpath %s.",
-                           ms->subscriptions[s]->module_name,
-                           ms->subscriptions[s]->xpath);
-                }
-                rc = sr_list_add(notified_notif, ms->subscriptions[s]);
-                if (SR_ERR_OK != rc) {
-                   SR_LOG_WRN_MSG("List add failed");
-                }
+            rc = np_subscription_notify(dm_ctx->np_ctx, ms->subscriptions[s], ev, c_ctx->id, pushed_changes);
+            if (ms->subscriptions[s]->push_changes) {
+                pthread_rwlock_unlock(&ms->changes_lock);
+                sr_list_cleanup(pushed_changes);
+            }
+            if (SR_ERR_OK != rc) {
+               SR_LOG_WRN("Unable to send notifications about the changes for the subscription in module %s xpath %s.",
+                       ms->subscriptions[s]->module_name,
+                       ms->subscriptions[s]->xpath);
+            }
+            rc = sr_list_add(notified_notif, ms->subscriptions[s]);
+            if (SR_ERR_OK != rc) {
+               SR_LOG_WRN_MSG("List add failed");
             }
         }
     }
@@ -3266,6 +4746,12 @@ dm_commit_notify(dm_ctx_t *dm_ctx, dm_session_t *session, sr_notif_event_t ev, d
         rc = np_commit_notifications_sent(dm_ctx->np_ctx, c_ctx->id, SR_EV_VERIFY != ev, notified_notif);
     }
 
+cleanup:
+    for (size_t j = 0; NULL != jobs && j < job_cnt; j++) {
+        free(jobs[j].matched);
+    }
+    free(jobs);
+    free(job_args);
     sr_list_cleanup(notified_notif);
     return rc;
 }
@@ -3285,13 +4771,20 @@ dm_feature_enable(dm_ctx_t *dm_ctx, const char *module_name, const char *feature
     rc = dm_get_module_and_lockw(dm_ctx, module_name, &schema_info);
     CHECK_RC_LOG_RETURN(rc, "dm_get_module %s and lock failed", module_name);
 
+    if (!schema_info->can_not_be_locked && 0 != __atomic_load_n(&dm_ctx->ds_lock_count, __ATOMIC_RELAXED)) {
+        /* the module is covered by a datastore lock */
+        SR_LOG_ERR("Feature state can not be modified because the datastore is locked, module %s", module_name);
+        sr_rwlock_unlock(&schema_info->model_lock);
+        return SR_ERR_OPERATION_FAILED;
+    }
+
     rc = dm_feature_enable_internal(dm_ctx, schema_info, module_name, feature_name, enable);
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
     CHECK_RC_LOG_RETURN(rc, "Failed to %s feature '%s' in module '%s'.", enable ? "enable" : "disable", feature_name, module_name);
 
     /* apply the change in all loaded schema infos */
     md_ctx_lock(dm_ctx->md_ctx, true);
-    pthread_rwlock_wrlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_wrlock(&dm_ctx->schema_tree_lock);
     rc = md_get_module_info(dm_ctx->md_ctx, module_name, NULL, &module);
     CHECK_RC_LOG_GOTO(rc, cleanup, "Get module %s info failed", module_name);
 
@@ -3301,13 +4794,13 @@ dm_feature_enable(dm_ctx_t *dm_ctx, const char *module_name, const char *feature
         dep = (md_dep_t *) ll_node->data;
         if (dep->type == MD_DEP_EXTENSION && true == dep->dest->latest_revision) {
             lookup.module_name = (char *) dep->dest->name;
-            si = sr_btree_search(dm_ctx->schema_info_tree, &lookup);
+            si = sr_omap_search(dm_ctx->schema_info_tree, &lookup);
             if (NULL != si && NULL != si->ly_ctx) {
                 rc = dm_lock_schema_info_write(si);
                 CHECK_RC_LOG_GOTO(rc, cleanup, "Failed to lock schema info %s", si->module_name);
 
                 rc = dm_feature_enable_internal(dm_ctx, si, module_name, feature_name, enable);
-                pthread_rwlock_unlock(&si->model_lock);
+                sr_rwlock_unlock(&si->model_lock);
                 CHECK_RC_LOG_GOTO(rc, cleanup, "Failed to load schema %s", module->filepath);
             }
         }
@@ -3315,7 +4808,7 @@ dm_feature_enable(dm_ctx_t *dm_ctx, const char *module_name, const char *feature
     }
 
 cleanup:
-    pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
     md_ctx_unlock(dm_ctx->md_ctx);
 
     return rc;
@@ -3337,7 +4830,7 @@ dm_install_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revisio
 
     /* insert module into the dependency graph */
     md_ctx_lock(dm_ctx->md_ctx, true);
-    pthread_rwlock_wrlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_wrlock(&dm_ctx->schema_tree_lock);
 
     rc = md_insert_module(dm_ctx->md_ctx, file_name, &implicitly_installed);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to insert module into the dependency graph");
@@ -3346,7 +4839,7 @@ dm_install_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revisio
     CHECK_RC_LOG_GOTO(rc, cleanup, "Get module %s info failed", module_name);
 
     lookup.module_name = (char *) module_name;
-    si = sr_btree_search(dm_ctx->schema_info_tree, &lookup);
+    si = sr_omap_search(dm_ctx->schema_info_tree, &lookup);
     if (NULL != si) {
         RWLOCK_WRLOCK_TIMED_CHECK_GOTO(&si->model_lock, rc, cleanup);
         if (NULL != si->ly_ctx) {
@@ -3398,7 +4891,7 @@ dm_install_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revisio
             dep = (md_dep_t *)ll_node->data;
             if (dep->type == MD_DEP_EXTENSION && true == dep->dest->latest_revision) {
                 lookup.module_name = (char *)dep->dest->name;
-                si_ext = sr_btree_search(dm_ctx->schema_info_tree, &lookup);
+                si_ext = sr_omap_search(dm_ctx->schema_info_tree, &lookup);
                 if (NULL != si_ext && NULL != si_ext->ly_ctx) {
                     rc = dm_load_schema_file(dm_ctx, module->filepath, true, &si_ext);
                     CHECK_RC_LOG_GOTO(rc, unlock, "Failed to load schema %s", module->filepath);
@@ -3407,19 +4900,25 @@ dm_install_module(dm_ctx_t *dm_ctx, const char *module_name, const char *revisio
                         rc = dm_apply_persist_data_for_model(dm_ctx, module->name, si_ext);
                         CHECK_RC_LOG_GOTO(rc, unlock, "Failed to apply persist data for %s", module->name);
                     }
+
+                    rc = dm_nacm_compile_schema(dm_ctx, si_ext);
+                    CHECK_RC_LOG_GOTO(rc, unlock, "Failed to compile NACM rules for module %s", si_ext->module_name);
                 }
             }
             ll_node = ll_node->next;
         }
+
+        rc = dm_nacm_compile_schema(dm_ctx, si);
+        CHECK_RC_LOG_GOTO(rc, unlock, "Failed to compile NACM rules for module %s", module_name);
 unlock:
-        pthread_rwlock_unlock(&si->model_lock);
+        sr_rwlock_unlock(&si->model_lock);
     } else {
         /* module is installed for the first time, will be loaded when a request
          * into this module is received */
         SR_LOG_DBG("Module %s will be loaded when a request for it comes", module_name);
     }
 cleanup:
-    pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
     md_ctx_unlock(dm_ctx->md_ctx);
     if (SR_ERR_OK == rc) {
         *implicitly_installed_p = implicitly_installed;
@@ -3447,9 +4946,9 @@ dm_uninstall_module_schema(dm_ctx_t *dm_ctx, const char *module_name, const char
     RWLOCK_RDLOCK_TIMED_CHECK_RETURN(&dm_ctx->schema_tree_lock);
     lookup.module_name = (char *) module_name;
 
-    schema_info = sr_btree_search(dm_ctx->schema_info_tree, &lookup);
+    schema_info = sr_omap_search(dm_ctx->schema_info_tree, &lookup);
     if (NULL != schema_info) {
-        pthread_rwlock_wrlock(&schema_info->model_lock);
+        sr_rwlock_wrlock(&schema_info->model_lock);
         if (NULL != schema_info->ly_ctx){
             pthread_mutex_lock(&schema_info->usage_count_mutex);
             if (0 != schema_info->usage_count) {
@@ -3463,12 +4962,12 @@ dm_uninstall_module_schema(dm_ctx_t *dm_ctx, const char *module_name, const char
             }
             pthread_mutex_unlock(&schema_info->usage_count_mutex);
         }
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
     } else {
         SR_LOG_DBG("Module %s is not loaded, can be uninstalled safely", module_name);
     }
 
-    pthread_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
 
     CHECK_RC_LOG_RETURN(rc, "Uninstallation of module %s was not successful", module_name);
     return rc;
@@ -3537,11 +5036,12 @@ dm_prepare_c_ctx_for_enable_notification(dm_ctx_t *dm_ctx, dm_commit_context_t *
 
     pthread_mutex_init(&c_ctx->mutex, NULL);
 
-    rc = sr_btree_init(dm_module_subscription_cmp, dm_model_subscription_free, &c_ctx->subscriptions);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Binary tree allocation failed");
+    rc = sr_omap_init(dm_module_subscription_cmp, dm_module_subscription_hash, dm_model_subscription_free,
+            &c_ctx->subscriptions);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Ordered map allocation failed");
 
-    rc = sr_btree_init(dm_data_info_cmp, dm_data_info_free, &c_ctx->prev_data_trees);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Binary tree allocation failed");
+    rc = sr_omap_init(dm_data_info_cmp, dm_data_info_hash, dm_data_info_free, &c_ctx->prev_data_trees);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Ordered map allocation failed");
 
     c_ctx->state = DM_COMMIT_FINISHED;
 
@@ -3628,7 +5128,7 @@ dm_create_difflist_for_enabled_notif(dm_ctx_t *dm_ctx, const ac_ucred_t *user_cr
     CHECK_RC_MSG_RETURN(rc, "Data tree copy failed");
 
     /* there is only one data tree in session */
-    dm_data_info_t *copied_di = (dm_data_info_t *) sr_btree_get_at(c_ctx->session->session_modules[SR_DS_RUNNING], 0);
+    dm_data_info_t *copied_di = (dm_data_info_t *) sr_omap_get_at(c_ctx->session->session_modules[SR_DS_RUNNING], 0);
     if (NULL == copied_di) {
         SR_LOG_ERR("Data tree for module %s not found", module_name);
         return SR_ERR_INTERNAL;
@@ -3654,7 +5154,7 @@ dm_create_difflist_for_enabled_notif(dm_ctx_t *dm_ctx, const ac_ucred_t *user_cr
         goto cleanup;
     }
 
-    rc = sr_btree_insert(c_ctx->subscriptions, ms);
+    rc = sr_omap_insert(c_ctx->subscriptions, ms);
     if (SR_ERR_OK != rc) {
         dm_model_subscription_free(ms);
     }
@@ -3697,7 +5197,7 @@ dm_send_enabled_notification(dm_ctx_t *dm_ctx, dm_commit_context_t *c_ctx, const
     rc = sr_list_add(notif_list, (void *) subscription);
     CHECK_RC_MSG_GOTO(rc, cleanup, "List insert failed");
 
-    rc = np_subscription_notify(dm_ctx->np_ctx, (np_subscription_t *) subscription, SR_EV_ENABLED, commit_id);
+    rc = np_subscription_notify(dm_ctx->np_ctx, (np_subscription_t *) subscription, SR_EV_ENABLED, commit_id, NULL);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Sending of SR_EV_ENABLED notification failed");
 
     rc = np_commit_notifications_sent(dm_ctx->np_ctx, commit_id, true, notif_list);
@@ -3924,7 +5424,7 @@ dm_has_enabled_subtree(dm_ctx_t *ctx, const char *module_name, dm_schema_info_t
     if (NULL != schema) {
         *schema = schema_info;
     }
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
     return rc;
 }
 
@@ -3940,7 +5440,7 @@ dm_enable_module_running(dm_ctx_t *ctx, dm_session_t *session, const char *modul
     CHECK_RC_LOG_RETURN(rc, "Lock schema %s for write failed", module_name);
 
     rc = dm_enable_module_running_internal(ctx, session, si, module_name);
-    pthread_rwlock_unlock(&si->model_lock);
+    sr_rwlock_unlock(&si->model_lock);
     CHECK_RC_LOG_RETURN(rc, "Enable module %s running failed", module_name);
 
     rc = dm_copy_module(ctx, session, module_name, SR_DS_STARTUP, SR_DS_RUNNING, subscription);
@@ -3948,6 +5448,49 @@ dm_enable_module_running(dm_ctx_t *ctx, dm_session_t *session, const char *modul
     return rc;
 }
 
+int
+dm_load_internal_module(dm_ctx_t *ctx, const char *module_name)
+{
+    CHECK_NULL_ARG2(ctx, module_name);
+    char *internal_schema_search_dir = NULL, *schema_file = NULL, *file_name = NULL;
+    sr_list_t *implicitly_installed = NULL;
+    md_module_t *module = NULL;
+    dm_schema_info_t *si = NULL;
+    int rc = SR_ERR_OK;
+
+    md_ctx_lock(ctx->md_ctx, false);
+    rc = md_get_module_info(ctx->md_ctx, module_name, NULL, &module);
+    md_ctx_unlock(ctx->md_ctx);
+
+    if (SR_ERR_OK != rc) {
+        /* the dependency graph is never flushed by DM, the module does not appear in the repository */
+        rc = sr_str_join(ctx->schema_search_dir, "internal", &internal_schema_search_dir);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "sr_str_join failed");
+        rc = sr_str_join(module_name, SR_SCHEMA_YANG_FILE_EXT, &schema_file);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "sr_str_join failed");
+        rc = sr_path_join(internal_schema_search_dir, schema_file, &file_name);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "sr_path_join failed");
+
+        rc = dm_install_module(ctx, module_name, NULL, file_name, &implicitly_installed);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Failed to load internal module %s", module_name);
+    }
+
+    /* there are no data to be copied from startup, running is enabled in memory only */
+    rc = dm_get_module_and_lockw(ctx, module_name, &si);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Lock schema %s for write failed", module_name);
+
+    rc = dm_enable_module_running_internal(ctx, NULL, si, module_name);
+    sr_rwlock_unlock(&si->model_lock);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Enable module %s running failed", module_name);
+
+cleanup:
+    md_free_module_key_list(implicitly_installed);
+    free(internal_schema_search_dir);
+    free(schema_file);
+    free(file_name);
+    return rc;
+}
+
 static int
 dm_copy_instances_of_the_sch_node(dm_data_info_t *src_info, dm_data_info_t *dst_info, struct lys_node *node)
 {
@@ -4124,7 +5667,7 @@ dm_enable_module_subtree_running(dm_ctx_t *ctx, dm_session_t *session, const cha
     CHECK_RC_LOG_RETURN(rc, "Lock schema %s for write failed", module_name);
 
     rc = dm_enable_module_subtree_running_internal(ctx, session, si, module_name, xpath);
-    pthread_rwlock_unlock(&si->model_lock);
+    sr_rwlock_unlock(&si->model_lock);
     CHECK_RC_LOG_RETURN(rc, "Enabling of xpath %s failed", xpath);
 
     rc = dm_copy_subtree_startup_running(ctx, session, module_name, si, xpath, subscription);
@@ -4186,7 +5729,7 @@ dm_disable_module_running(dm_ctx_t *ctx, dm_session_t *session, const char *modu
         }
     }
 cleanup:
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
     sr_list_cleanup(stack);
 
     return rc;
@@ -4215,7 +5758,7 @@ dm_copy_module(dm_ctx_t *dm_ctx, dm_session_t *session, const char *module_name,
 
 cleanup:
     if (NULL != schema_info) {
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
     }
     sr_list_cleanup(module_list);
     return rc;
@@ -4600,6 +6143,374 @@ dm_lyd_new_path(dm_data_info_t *data_info, const char *path, const char *value,
     return new;
 }
 
+void
+dm_add_changed_node(dm_data_info_t *data_info, const struct lyd_node *node)
+{
+    char *path = NULL;
+    int rc = SR_ERR_OK;
+
+    if (NULL == data_info || NULL == node || NULL == data_info->changed_paths) {
+        return;
+    }
+
+    if (DM_MAX_TRACKED_CHANGES <= data_info->changed_paths->count) {
+        SR_LOG_DBG("Too many changes in module %s, the whole data tree will be compared", data_info->schema->module_name);
+        dm_untrack_changes(data_info);
+        return;
+    }
+
+    path = lyd_path((struct lyd_node *) node);
+    CHECK_NULL_NOMEM_GOTO(path, rc, cleanup);
+
+    /* consecutive operations often touch the same subtree */
+    if (0 < data_info->changed_paths->count &&
+            0 == strcmp(path, data_info->changed_paths->data[data_info->changed_paths->count - 1])) {
+        free(path);
+        return;
+    }
+
+    rc = sr_list_add(data_info->changed_paths, path);
+    if (SR_ERR_OK != rc) {
+        free(path);
+    }
+
+cleanup:
+    if (SR_ERR_OK != rc) {
+        SR_LOG_WRN("Failed to record the change in module %s, the whole data tree will be compared", data_info->schema->module_name);
+        dm_untrack_changes(data_info);
+    }
+}
+
+/**
+ * @brief Looks up a node matching the given one (same schema node, same keys of a list,
+ * same value of a leaf-list) among the siblings.
+ * @param [in] siblings - any node from the list of siblings to be searched, can be NULL
+ * @param [in] node
+ * @param [out] match - matching node, NULL if there is none
+ * @return Error code (SR_ERR_OK on success), SR_ERR_INVAL_ARG if the node can not be identified unambiguously
+ */
+static int
+dm_find_matching_sibling(struct lyd_node *siblings, const struct lyd_node *node, struct lyd_node **match)
+{
+    CHECK_NULL_ARG2(node, match);
+    struct lyd_node *iter = NULL, *key = NULL, *match_key = NULL;
+    struct lys_node_list *slist = NULL;
+    bool equal = false;
+
+    *match = NULL;
+    if (NULL == siblings) {
+        return SR_ERR_OK;
+    }
+    /* rewind to the first sibling */
+    while (NULL != siblings->prev->next) {
+        siblings = siblings->prev;
+    }
+
+    LY_TREE_FOR(siblings, iter) {
+        if (iter->schema != node->schema) {
+            continue;
+        }
+        switch (node->schema->nodetype) {
+        case LYS_LIST:
+            slist = (struct lys_node_list *) node->schema;
+            if (0 == slist->keys_size) {
+                /* instances of a keyless list can not be matched */
+                return SR_ERR_INVAL_ARG;
+            }
+            /* keys are always the first children of a list instance */
+            equal = true;
+            key = node->child;
+            match_key = iter->child;
+            for (uint8_t k = 0; k < slist->keys_size; k++) {
+                if (NULL == key || NULL == match_key || key->schema != match_key->schema ||
+                        NULL == ((struct lyd_node_leaf_list *) key)->value_str ||
+                        NULL == ((struct lyd_node_leaf_list *) match_key)->value_str ||
+                        0 != strcmp(((struct lyd_node_leaf_list *) key)->value_str, ((struct lyd_node_leaf_list *) match_key)->value_str)) {
+                    equal = false;
+                    break;
+                }
+                key = key->next;
+                match_key = match_key->next;
+            }
+            break;
+        case LYS_LEAFLIST:
+            equal = NULL != ((struct lyd_node_leaf_list *) node)->value_str &&
+                    NULL != ((struct lyd_node_leaf_list *) iter)->value_str &&
+                    0 == strcmp(((struct lyd_node_leaf_list *) node)->value_str, ((struct lyd_node_leaf_list *) iter)->value_str);
+            break;
+        default:
+            equal = true;
+        }
+        if (equal) {
+            *match = iter;
+            return SR_ERR_OK;
+        }
+    }
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Finds the deepest ancestor-or-self of the node that has a matching node in the other data tree.
+ * @param [in] other_tree - data tree to be searched
+ * @param [in] node
+ * @param [out] src - the deepest matched ancestor-or-self of the node, if no ancestor is matched
+ * the top-level ancestor of the node
+ * @param [out] dst - node matching src in the other tree, NULL if the top-level ancestor is not matched
+ * @return Error code (SR_ERR_OK on success), SR_ERR_INVAL_ARG if a node can not be matched unambiguously
+ */
+static int
+dm_match_node_in_tree(struct lyd_node *other_tree, struct lyd_node *node, struct lyd_node **src, struct lyd_node **dst)
+{
+    CHECK_NULL_ARG3(node, src, dst);
+    struct lyd_node *match = NULL;
+    int rc = SR_ERR_OK;
+
+    if (NULL == node->parent) {
+        *src = node;
+        *dst = NULL;
+        return dm_find_matching_sibling(other_tree, node, dst);
+    }
+
+    rc = dm_match_node_in_tree(other_tree, node->parent, src, dst);
+    if (SR_ERR_OK != rc || NULL == *dst || *src != node->parent) {
+        /* an ancestor has not been matched */
+        return rc;
+    }
+
+    rc = dm_find_matching_sibling((*dst)->child, node, &match);
+    if (SR_ERR_OK == rc && NULL != match) {
+        *src = node;
+        *dst = match;
+    }
+    return rc;
+}
+
+/**
+ * @brief Looks up a node identified by the xpath in the data tree.
+ * @param [in] tree
+ * @param [in] xpath
+ * @param [out] node - found node or NULL
+ * @return Error code (SR_ERR_OK on success), SR_ERR_INVAL_ARG if the xpath does not identify a single node
+ */
+static int
+dm_find_changed_node(struct lyd_node *tree, const char *xpath, struct lyd_node **node)
+{
+    CHECK_NULL_ARG2(xpath, node);
+    struct ly_set *res = NULL;
+    int rc = SR_ERR_OK;
+
+    *node = NULL;
+    if (NULL == tree) {
+        return SR_ERR_OK;
+    }
+
+    res = lyd_find_xpath(tree, xpath);
+    if (NULL == res || 1 < res->number) {
+        rc = SR_ERR_INVAL_ARG;
+    } else if (1 == res->number) {
+        *node = res->set.d[0];
+    }
+    ly_set_free(res);
+    return rc;
+}
+
+/**
+ * @brief Appends an item into the list of differences.
+ * @param [in] diff
+ * @param [in] count - number of items in the list
+ * @param [in] size - number of allocated items
+ * @param [in] type
+ * @param [in] first
+ * @param [in] second
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+dm_difflist_append(struct lyd_difflist *diff, size_t *count, size_t *size, LYD_DIFFTYPE type,
+        struct lyd_node *first, struct lyd_node *second)
+{
+    CHECK_NULL_ARG3(diff, count, size);
+    LYD_DIFFTYPE *types = NULL;
+    struct lyd_node **nodes = NULL;
+
+    /* keep space for the terminating item */
+    if (*count + 1 >= *size) {
+        size_t new_size = *size * 2;
+        types = realloc(diff->type, new_size * sizeof(*diff->type));
+        CHECK_NULL_NOMEM_RETURN(types);
+        diff->type = types;
+        nodes = realloc(diff->first, new_size * sizeof(*diff->first));
+        CHECK_NULL_NOMEM_RETURN(nodes);
+        diff->first = nodes;
+        nodes = realloc(diff->second, new_size * sizeof(*diff->second));
+        CHECK_NULL_NOMEM_RETURN(nodes);
+        diff->second = nodes;
+        *size = new_size;
+    }
+
+    diff->type[*count] = type;
+    diff->first[*count] = first;
+    diff->second[*count] = second;
+    (*count)++;
+    diff->type[*count] = LYD_DIFF_END;
+    diff->first[*count] = NULL;
+    diff->second[*count] = NULL;
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Computes the differences only for the subtrees touched by edit operations.
+ * @param [in] prev_info
+ * @param [in] commit_info
+ * @param [in] inverse
+ * @param [out] diff
+ * @return Error code (SR_ERR_OK on success), SR_ERR_INVAL_ARG if the touched subtrees can not be
+ * identified and the whole trees has to be compared
+ */
+static int
+dm_get_tracked_changes_diff(const dm_data_info_t *prev_info, const dm_data_info_t *commit_info, bool inverse, struct lyd_difflist **diff)
+{
+    CHECK_NULL_ARG4(prev_info, commit_info, commit_info->changed_paths, diff);
+    sr_list_t *changed = commit_info->changed_paths;
+    struct lyd_node **prev_nodes = NULL, **commit_nodes = NULL;
+    struct lyd_node *node = NULL, *src = NULL, *dst = NULL, *p = NULL, *c = NULL, *n = NULL;
+    struct lyd_difflist *result = NULL, *subtree_diff = NULL;
+    size_t pair_cnt = 0, count = 0, size = 0;
+    bool covered = false;
+    int rc = SR_ERR_OK;
+
+    prev_nodes = calloc(changed->count, sizeof(*prev_nodes));
+    commit_nodes = calloc(changed->count, sizeof(*commit_nodes));
+    result = calloc(1, sizeof(*result));
+    if (NULL == result || (0 != changed->count && (NULL == prev_nodes || NULL == commit_nodes))) {
+        SR_LOG_ERR_MSG("Memory allocation failed");
+        rc = SR_ERR_NOMEM;
+        goto cleanup;
+    }
+    size = DM_DIFFLIST_INITIAL_SIZE;
+    result->type = calloc(size, sizeof(*result->type));
+    result->first = calloc(size, sizeof(*result->first));
+    result->second = calloc(size, sizeof(*result->second));
+    if (NULL == result->type || NULL == result->first || NULL == result->second) {
+        SR_LOG_ERR_MSG("Memory allocation failed");
+        rc = SR_ERR_NOMEM;
+        goto cleanup;
+    }
+    result->type[0] = LYD_DIFF_END;
+
+    /* find the pairs of corresponding subtrees that may differ */
+    for (size_t i = 0; i < changed->count; i++) {
+        p = c = NULL;
+        rc = dm_find_changed_node(commit_info->node, changed->data[i], &node);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Changed node %s can not be identified", (char *) changed->data[i]);
+        if (NULL != node) {
+            rc = dm_match_node_in_tree(prev_info->node, node, &src, &dst);
+            CHECK_RC_LOG_GOTO(rc, cleanup, "Changed node %s can not be matched", (char *) changed->data[i]);
+            c = src;
+            p = dst;
+        } else {
+            /* the node has been removed by a subsequent operation */
+            rc = dm_find_changed_node(prev_info->node, changed->data[i], &node);
+            CHECK_RC_LOG_GOTO(rc, cleanup, "Changed node %s can not be identified", (char *) changed->data[i]);
+            if (NULL == node) {
+                /* the node has been neither in the previous nor in the commit tree */
+                continue;
+            }
+            rc = dm_match_node_in_tree(commit_info->node, node, &src, &dst);
+            CHECK_RC_LOG_GOTO(rc, cleanup, "Changed node %s can not be matched", (char *) changed->data[i]);
+            p = src;
+            c = dst;
+        }
+
+        /* skip the pair if it is a part of an already selected subtree, remove pairs it covers */
+        covered = false;
+        for (size_t j = 0; j < pair_cnt && !covered; j++) {
+            n = NULL != c ? c : p;
+            while (NULL != n && !covered) {
+                covered = (n == commit_nodes[j] || n == prev_nodes[j]);
+                n = n->parent;
+            }
+        }
+        if (covered) {
+            continue;
+        }
+        for (size_t j = 0; j < pair_cnt; j++) {
+            n = NULL != commit_nodes[j] ? commit_nodes[j] : prev_nodes[j];
+            while (NULL != n && n != c && n != p) {
+                n = n->parent;
+            }
+            if (NULL != n) {
+                prev_nodes[j] = prev_nodes[pair_cnt - 1];
+                commit_nodes[j] = commit_nodes[pair_cnt - 1];
+                pair_cnt--;
+                j--;
+            }
+        }
+        prev_nodes[pair_cnt] = p;
+        commit_nodes[pair_cnt] = c;
+        pair_cnt++;
+    }
+
+    /* compare the selected subtrees */
+    for (size_t i = 0; i < pair_cnt; i++) {
+        struct lyd_node *first = inverse ? commit_nodes[i] : prev_nodes[i];
+        struct lyd_node *second = inverse ? prev_nodes[i] : commit_nodes[i];
+        if (NULL == first) {
+            /* top-level node created */
+            rc = dm_difflist_append(result, &count, &size, LYD_DIFF_CREATED, NULL, second);
+        } else if (NULL == second) {
+            /* top-level node deleted */
+            rc = dm_difflist_append(result, &count, &size, LYD_DIFF_DELETED, first, NULL);
+        } else {
+            subtree_diff = lyd_diff(first, second, LYD_DIFFOPT_WITHDEFAULTS | LYD_DIFFOPT_NOSIBLINGS);
+            CHECK_NULL_NOMEM_GOTO(subtree_diff, rc, cleanup);
+            for (size_t d = 0; SR_ERR_OK == rc && LYD_DIFF_END != subtree_diff->type[d]; d++) {
+                rc = dm_difflist_append(result, &count, &size, subtree_diff->type[d], subtree_diff->first[d], subtree_diff->second[d]);
+            }
+            lyd_free_diff(subtree_diff);
+        }
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to append into difflist");
+    }
+
+    SR_LOG_DBG("Diff of module %s computed from %zu changed subtrees", commit_info->schema->module_name, pair_cnt);
+    *diff = result;
+    result = NULL;
+
+cleanup:
+    free(prev_nodes);
+    free(commit_nodes);
+    if (NULL != result) {
+        lyd_free_diff(result);
+    }
+    return rc;
+}
+
+int
+dm_get_data_info_diff(const dm_data_info_t *prev_info, const dm_data_info_t *commit_info, bool inverse, struct lyd_difflist **diff)
+{
+    CHECK_NULL_ARG4(prev_info, commit_info, commit_info->schema, diff);
+    int rc = SR_ERR_OK;
+
+    /* when conditions and data of other modules can change also the nodes outside of the touched subtrees */
+    if (NULL != commit_info->changed_paths && !commit_info->schema->cross_module_data_dependency &&
+            !commit_info->schema->has_when_conditions) {
+        rc = dm_get_tracked_changes_diff(prev_info, commit_info, inverse, diff);
+        if (SR_ERR_OK == rc) {
+            return rc;
+        }
+        SR_LOG_DBG("Changes of module %s can not be compared per subtree, the whole data tree will be compared",
+                commit_info->schema->module_name);
+    }
+
+    *diff = inverse ?
+            lyd_diff(commit_info->node, prev_info->node, LYD_DIFFOPT_WITHDEFAULTS) :
+            lyd_diff(prev_info->node, commit_info->node, LYD_DIFFOPT_WITHDEFAULTS);
+    if (NULL == *diff) {
+        SR_LOG_ERR("Lyd diff failed for module %s", commit_info->schema->module_name);
+        return SR_ERR_INTERNAL;
+    }
+    return SR_ERR_OK;
+}
+
 int
 dm_copy_modified_session_trees(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_t *to)
 {
@@ -4608,12 +6519,12 @@ dm_copy_modified_session_trees(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_
     size_t i = 0;
     dm_data_info_t *info = NULL;
     dm_data_info_t *new_info = NULL;
-    while (NULL != (info = sr_btree_get_at(from->session_modules[from->datastore], i++))) {
+    while (NULL != (info = sr_omap_get_at(from->session_modules[from->datastore], i++))) {
         if (!info->modified) {
             continue;
         }
         bool existed = true;
-        new_info = sr_btree_search(to->session_modules[to->datastore], info);
+        new_info = sr_omap_search(to->session_modules[to->datastore], info);
         if (NULL == new_info) {
             existed = false;
             new_info = calloc(1, sizeof(*new_info));
@@ -4628,6 +6539,10 @@ dm_copy_modified_session_trees(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_
         if (NULL != info->node) {
             new_info->node = sr_dup_datatree(info->node);
         }
+        if (SR_ERR_OK != dm_copy_changed_paths(info, new_info)) {
+            /* the diff will be computed from the whole trees */
+            dm_untrack_changes(new_info);
+        }
 
         if (!existed) {
             pthread_mutex_lock(&info->schema->usage_count_mutex);
@@ -4635,7 +6550,7 @@ dm_copy_modified_session_trees(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_
             SR_LOG_DBG("Usage count %s deccremented (value=%zu)", info->schema->module_name, info->schema->usage_count);
             pthread_mutex_unlock(&info->schema->usage_count_mutex);
 
-            rc = sr_btree_insert(to->session_modules[to->datastore], new_info);
+            rc = sr_omap_insert(to->session_modules[to->datastore], new_info);
             CHECK_RC_MSG_GOTO(rc, fail, "Adding data tree to session modules failed");
         }
     }
@@ -4663,14 +6578,14 @@ dm_copy_session_tree(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_t *to, con
 
     lookup.schema = schema_info;
 
-    info = sr_btree_search(from->session_modules[from->datastore], &lookup);
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    info = sr_omap_search(from->session_modules[from->datastore], &lookup);
+    sr_rwlock_unlock(&schema_info->model_lock);
     if (NULL == info) {
         SR_LOG_DBG("Module %s not loaded in source session", module_name);
         return rc;
     }
 
-    new_info = sr_btree_search(to->session_modules[to->datastore], &lookup);
+    new_info = sr_omap_search(to->session_modules[to->datastore], &lookup);
     if (NULL == new_info) {
         existed = false;
         new_info = calloc(1, sizeof(*new_info));
@@ -4688,6 +6603,7 @@ dm_copy_session_tree(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_t *to, con
     if (SR_ERR_OK == rc) {
         lyd_free_withsiblings(new_info->node);
         new_info->node = tmp_node;
+        rc = dm_copy_changed_paths(info, new_info);
     }
 
     if (!existed) {
@@ -4696,7 +6612,7 @@ dm_copy_session_tree(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_t *to, con
         SR_LOG_DBG("Usage count %s decremented (value=%zu)", info->schema->module_name, info->schema->usage_count);
         pthread_mutex_unlock(&info->schema->usage_count_mutex);
         if (SR_ERR_OK == rc) {
-            rc = sr_btree_insert(to->session_modules[to->datastore], new_info);
+            rc = sr_omap_insert(to->session_modules[to->datastore], new_info);
         } else {
             dm_data_info_free(new_info);
         }
@@ -4716,13 +6632,13 @@ dm_create_rdonly_ptr_data_tree(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_
 
     lookup.schema = schema_info;
 
-    info = sr_btree_search(from->session_modules[from->datastore], &lookup);
+    info = sr_omap_search(from->session_modules[from->datastore], &lookup);
     if (NULL == info) {
         SR_LOG_DBG("Module %s not loaded in source session", schema_info->module_name);
         return rc;
     }
 
-    new_info = sr_btree_search(to->session_modules[to->datastore], &lookup);
+    new_info = sr_omap_search(to->session_modules[to->datastore], &lookup);
     if (NULL == new_info) {
         existed = false;
         new_info = calloc(1, sizeof(*new_info));
@@ -4737,7 +6653,7 @@ dm_create_rdonly_ptr_data_tree(dm_ctx_t *dm_ctx, dm_session_t *from, dm_session_
     new_info->node = info->node;
 
     if (!existed) {
-        rc = sr_btree_insert(to->session_modules[to->datastore], new_info);
+        rc = sr_omap_insert(to->session_modules[to->datastore], new_info);
         if (SR_ERR_OK != rc) {
             dm_data_info_free(new_info);
         }
@@ -4759,12 +6675,12 @@ dm_copy_if_not_loaded(dm_ctx_t *dm_ctx, dm_session_t *from_session, dm_session_t
 
     lookup.schema = schema_info;
 
-    info = sr_btree_search(session->session_modules[session->datastore], &lookup);
+    info = sr_omap_search(session->session_modules[session->datastore], &lookup);
 
     if (NULL == info) {
         rc = dm_create_rdonly_ptr_data_tree(dm_ctx, from_session, session, schema_info);
     }
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
     return rc;
 }
 
@@ -4780,7 +6696,7 @@ dm_move_session_tree_and_ops_all_ds(dm_ctx_t *dm_ctx, dm_session_t *from, dm_ses
     for (int ds = 0; ds < DM_DATASTORE_COUNT; ds++) {
         dm_session_switch_ds(from, ds);
         dm_session_switch_ds(to, ds);
-        sr_btree_cleanup(to->session_modules[ds]);
+        sr_omap_cleanup(to->session_modules[ds]);
         dm_free_sess_operations(to->operations[ds], to->oper_count[ds]);
 
         to->session_modules[ds] = from->session_modules[ds];
@@ -4817,7 +6733,7 @@ dm_move_session_trees_in_session(dm_ctx_t *dm_ctx, dm_session_t *session, sr_dat
     int prev_ds = session->datastore;
 
     /* cleanup the target*/
-    sr_btree_cleanup(session->session_modules[to]);
+    sr_omap_cleanup(session->session_modules[to]);
     dm_free_sess_operations(session->operations[to], session->oper_count[to]);
 
     /* move */
@@ -4912,8 +6828,8 @@ dm_is_model_modified(dm_ctx_t *dm_ctx, dm_session_t *session, const char *module
 
     lookup.schema = schema_info;
 
-    info = sr_btree_search(session->session_modules[session->datastore], &lookup);
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    info = sr_omap_search(session->session_modules[session->datastore], &lookup);
+    sr_rwlock_unlock(&schema_info->model_lock);
 
     *res = NULL != info ? info->modified : false;
     return rc;
@@ -4925,7 +6841,7 @@ dm_get_commit_context(dm_ctx_t *dm_ctx, uint32_t c_ctx_id, dm_commit_context_t *
     CHECK_NULL_ARG2(dm_ctx, c_ctx);
     dm_commit_context_t lookup = {0};
     lookup.id = c_ctx_id;
-    *c_ctx = sr_btree_search(dm_ctx->commit_ctxs.tree, &lookup);
+    *c_ctx = sr_omap_search(dm_ctx->commit_ctxs.tree, &lookup);
     return SR_ERR_OK;
 }
 
@@ -4953,7 +6869,7 @@ dm_lock_schema_info(dm_schema_info_t *schema_info)
         return SR_ERR_OK;
     } else {
         SR_LOG_ERR("Schema info can not be locked for module %s. Module has been uninstalled.", schema_info->module_name);
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
         return SR_ERR_UNKNOWN_MODEL;
     }
 }
@@ -4967,7 +6883,7 @@ dm_lock_schema_info_write(dm_schema_info_t *schema_info)
         return SR_ERR_OK;
     } else {
         SR_LOG_ERR("Schema info can not be locked for module %s. Module has been uninstalled.", schema_info->module_name);
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
         return SR_ERR_UNKNOWN_MODEL;
     }
 }
@@ -4990,3 +6906,315 @@ dm_get_nodes_by_schema(dm_session_t *session, const char *module_name, const str
 
     return rc;
 }
+
+int
+dm_get_module_usage(dm_ctx_t *dm_ctx, dm_module_usage_t **usage_p, size_t *count_p)
+{
+    CHECK_NULL_ARG3(dm_ctx, usage_p, count_p);
+    dm_schema_info_t *si = NULL;
+    dm_module_usage_t *usage = NULL, *tmp = NULL;
+    size_t count = 0, data_tree_cnt = 0, i = 0;
+    int rc = SR_ERR_OK;
+
+    RWLOCK_RDLOCK_TIMED_CHECK_RETURN(&dm_ctx->schema_tree_lock);
+    while (NULL != (si = sr_omap_get_at(dm_ctx->schema_info_tree, i++))) {
+        pthread_mutex_lock(&si->usage_count_mutex);
+        data_tree_cnt = si->usage_count;
+        pthread_mutex_unlock(&si->usage_count_mutex);
+        if (0 == data_tree_cnt) {
+            continue;
+        }
+        tmp = realloc(usage, (count + 1) * sizeof *usage);
+        CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
+        usage = tmp;
+        usage[count].module_name = strdup(si->module_name);
+        CHECK_NULL_NOMEM_GOTO(usage[count].module_name, rc, cleanup);
+        usage[count].data_tree_cnt = data_tree_cnt;
+        for (size_t ds = 0; ds < DM_DATASTORE_COUNT; ds++) {
+            usage[count].mem_usage[ds].tree_cnt = __atomic_load_n(&si->mem_usage[ds].tree_cnt, __ATOMIC_RELAXED);
+            usage[count].mem_usage[ds].node_cnt = __atomic_load_n(&si->mem_usage[ds].node_cnt, __ATOMIC_RELAXED);
+            usage[count].mem_usage[ds].mem_size = __atomic_load_n(&si->mem_usage[ds].mem_size, __ATOMIC_RELAXED);
+        }
+        ++count;
+    }
+
+cleanup:
+    sr_rwlock_unlock(&dm_ctx->schema_tree_lock);
+    if (SR_ERR_OK != rc) {
+        dm_free_module_usage(usage, count);
+        return rc;
+    }
+    *usage_p = usage;
+    *count_p = count;
+    return rc;
+}
+
+void
+dm_free_module_usage(dm_module_usage_t *usage, size_t count)
+{
+    if (NULL != usage) {
+        for (size_t i = 0; i < count; ++i) {
+            free(usage[i].module_name);
+        }
+        free(usage);
+    }
+}
+
+/**
+ * @brief Appends the statistics of the lock of given name, if it has ever been used.
+ */
+static int
+dm_add_lock_stats(dm_ctx_t *dm_ctx, const char *lock_name, const char *module_name, sr_datastore_t ds,
+        dm_lock_stats_t **stats, size_t *count)
+{
+    dm_lock_stats_t *tmp = NULL;
+    sr_lock_stats_t lock_stats = { 0, };
+    int rc = SR_ERR_OK;
+
+    rc = sr_lock_table_get_stats(dm_ctx->lock_table, lock_name, &lock_stats);
+    if (SR_ERR_NOT_FOUND == rc) {
+        return SR_ERR_OK;
+    }
+    CHECK_RC_LOG_RETURN(rc, "Failed to get statistics of the lock %s", lock_name);
+
+    tmp = realloc(*stats, (*count + 1) * sizeof **stats);
+    CHECK_NULL_NOMEM_RETURN(tmp);
+    *stats = tmp;
+    tmp[*count].module_name = NULL;
+    if (NULL != module_name) {
+        tmp[*count].module_name = strdup(module_name);
+        CHECK_NULL_NOMEM_RETURN(tmp[*count].module_name);
+    }
+    tmp[*count].datastore = ds;
+    tmp[*count].stats = lock_stats;
+    ++(*count);
+
+    return rc;
+}
+
+int
+dm_get_lock_stats(dm_ctx_t *dm_ctx, dm_lock_stats_t **stats_p, size_t *count_p)
+{
+    CHECK_NULL_ARG3(dm_ctx, stats_p, count_p);
+    dm_lock_stats_t *stats = NULL;
+    md_module_t *module = NULL;
+    sr_llist_node_t *ll_node = NULL;
+    char *lock_file = NULL;
+    size_t count = 0;
+    int rc = SR_ERR_OK;
+
+    for (int ds = 0; SR_ERR_OK == rc && ds < DM_DATASTORE_COUNT; ds++) {
+        rc = dm_add_lock_stats(dm_ctx, dm_ctx->ds_lock_files[ds], NULL, ds, &stats, &count);
+    }
+
+    md_ctx_lock(dm_ctx->md_ctx, false);
+    for (ll_node = dm_ctx->md_ctx->modules->first; NULL != ll_node && SR_ERR_OK == rc; ll_node = ll_node->next) {
+        module = (md_module_t *) ll_node->data;
+        if (module->submodule || !module->has_data) {
+            continue;
+        }
+        for (int ds = 0; SR_ERR_OK == rc && ds < DM_DATASTORE_COUNT; ds++) {
+            rc = sr_get_lock_data_file_name(dm_ctx->data_search_dir, module->name, ds, &lock_file);
+            if (SR_ERR_OK == rc) {
+                rc = dm_add_lock_stats(dm_ctx, lock_file, module->name, ds, &stats, &count);
+                free(lock_file);
+                lock_file = NULL;
+            }
+        }
+    }
+    md_ctx_unlock(dm_ctx->md_ctx);
+
+    if (SR_ERR_OK != rc) {
+        dm_free_lock_stats(stats, count);
+        return rc;
+    }
+    *stats_p = stats;
+    *count_p = count;
+    return rc;
+}
+
+void
+dm_free_lock_stats(dm_lock_stats_t *stats, size_t count)
+{
+    if (NULL != stats) {
+        for (size_t i = 0; i < count; ++i) {
+            free(stats[i].module_name);
+        }
+        free(stats);
+    }
+}
+
+/**
+ * @brief Replaces the memory accounted for the session in the global counter.
+ *
+ * @return Memory used by the data trees of all sessions after the update.
+ */
+static size_t
+dm_mem_account(dm_ctx_t *dm_ctx, dm_session_t *session, size_t used)
+{
+    size_t global_used = 0, prev_used = session->mem_usage.mem_size;
+
+    if (used >= prev_used) {
+        global_used = __atomic_add_fetch(&dm_ctx->mem_used, used - prev_used, __ATOMIC_RELAXED);
+    } else {
+        global_used = __atomic_sub_fetch(&dm_ctx->mem_used, prev_used - used, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&session->mem_usage.mem_size, used, __ATOMIC_RELAXED);
+
+    return global_used;
+}
+
+/**
+ * @brief Finds the least recently used copy of the session that can be evicted.
+ */
+static dm_data_info_t *
+dm_session_lru_info(dm_session_t *session, const sr_list_t *keep_modules, size_t *ds_p)
+{
+    dm_data_info_t *info = NULL, *lru = NULL;
+    size_t i = 0, k = 0;
+    bool keep = false;
+
+    for (size_t ds = 0; ds < DM_DATASTORE_COUNT; ds++) {
+        i = 0;
+        while (NULL != (info = sr_omap_get_at(session->session_modules[ds], i++))) {
+            /* modified copies can not be loaded again without losing the changes */
+            if (info->rdonly_copy || info->modified) {
+                continue;
+            }
+            /* keep the copy used by the last request, it would be loaded again right away */
+            if (info->last_access == session->access_tick) {
+                continue;
+            }
+            keep = false;
+            for (k = 0; !keep && NULL != keep_modules && k < keep_modules->count; k++) {
+                keep = 0 == strcmp(keep_modules->data[k], info->schema->module_name);
+            }
+            if (keep) {
+                continue;
+            }
+            if (NULL == lru || info->last_access < lru->last_access) {
+                lru = info;
+                *ds_p = ds;
+            }
+        }
+    }
+
+    return lru;
+}
+
+int
+dm_session_trim(dm_ctx_t *dm_ctx, dm_session_t *session, const sr_list_t *keep_modules, size_t *evicted_cnt)
+{
+    CHECK_NULL_ARG2(dm_ctx, session);
+    dm_data_info_t *info = NULL;
+    dm_schema_info_t *schema = NULL;
+    size_t used = 0, global_used = 0, tree_cnt = 0, node_cnt = 0, evicted = 0, ds = 0, i = 0, ops = 0;
+    bool listed = false;
+    int rc = SR_ERR_OK;
+
+    /* update the estimates of the copies loaded since the last trim or edited a lot since then */
+    for (ds = 0; ds < DM_DATASTORE_COUNT; ds++) {
+        ops = session->oper_count[ds];
+        i = 0;
+        while (NULL != (info = sr_omap_get_at(session->session_modules[ds], i++))) {
+            if (info->rdonly_copy) {
+                continue;
+            }
+            if (0 == info->mem_size || ds != info->mem_ds || ops < info->mem_size_ops ||
+                    ops - info->mem_size_ops >= DM_MEM_RECOUNT_OPERATIONS) {
+                dm_data_info_account(info, ds, ops);
+            }
+            used += info->mem_size;
+            node_cnt += info->node_cnt;
+            ++tree_cnt;
+        }
+    }
+    global_used = dm_mem_account(dm_ctx, session, used);
+
+    /* only copies of this session are evicted, the caller picks the sessions to trim over the global budget */
+    while ((0 != dm_ctx->session_mem_budget && used > dm_ctx->session_mem_budget) ||
+            (0 != dm_ctx->global_mem_budget && global_used > dm_ctx->global_mem_budget)) {
+        info = dm_session_lru_info(session, keep_modules, &ds);
+        if (NULL == info) {
+            break;
+        }
+        schema = info->schema;
+
+        if (NULL == session->evicted_modules[ds]) {
+            rc = sr_list_init(&session->evicted_modules[ds]);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "List init failed");
+        }
+        listed = false;
+        for (i = 0; !listed && i < session->evicted_modules[ds]->count; i++) {
+            listed = schema == session->evicted_modules[ds]->data[i];
+        }
+        if (!listed) {
+            rc = sr_list_add(session->evicted_modules[ds], schema);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "List add failed");
+        }
+
+        SR_LOG_DBG("Evicting copy of module %s from session (%zu bytes, session=%zu, global=%zu)",
+                schema->module_name, info->mem_size, used, global_used);
+        used -= info->mem_size;
+        node_cnt -= info->node_cnt;
+        --tree_cnt;
+        sr_omap_delete(session->session_modules[ds], info);
+        global_used = dm_mem_account(dm_ctx, session, used);
+        evicted++;
+    }
+
+    if (evicted > 0) {
+        __atomic_add_fetch(&dm_ctx->mem_evictions, evicted, __ATOMIC_RELAXED);
+    }
+
+cleanup:
+    __atomic_store_n(&session->mem_usage.tree_cnt, tree_cnt, __ATOMIC_RELAXED);
+    __atomic_store_n(&session->mem_usage.node_cnt, node_cnt, __ATOMIC_RELAXED);
+    if (NULL != evicted_cnt) {
+        *evicted_cnt = evicted;
+    }
+    return rc;
+}
+
+void
+dm_get_mem_stats(dm_ctx_t *dm_ctx, dm_mem_stats_t *stats)
+{
+    CHECK_NULL_ARG_VOID2(dm_ctx, stats);
+
+    stats->session_budget = dm_ctx->session_mem_budget;
+    stats->global_budget = dm_ctx->global_mem_budget;
+    stats->used = __atomic_load_n(&dm_ctx->mem_used, __ATOMIC_RELAXED);
+    stats->evictions = __atomic_load_n(&dm_ctx->mem_evictions, __ATOMIC_RELAXED);
+    stats->reloads = __atomic_load_n(&dm_ctx->mem_reloads, __ATOMIC_RELAXED);
+}
+
+void
+dm_get_session_mem_usage(const dm_session_t *session, dm_mem_usage_t *usage)
+{
+    CHECK_NULL_ARG_VOID2(session, usage);
+
+    usage->tree_cnt = __atomic_load_n(&session->mem_usage.tree_cnt, __ATOMIC_RELAXED);
+    usage->node_cnt = __atomic_load_n(&session->mem_usage.node_cnt, __ATOMIC_RELAXED);
+    usage->mem_size = __atomic_load_n(&session->mem_usage.mem_size, __ATOMIC_RELAXED);
+}
+
+int
+dm_get_commit_ctxs_usage(dm_ctx_t *dm_ctx, size_t *ctx_cnt, dm_mem_usage_t *usage)
+{
+    CHECK_NULL_ARG3(dm_ctx, ctx_cnt, usage);
+    dm_commit_context_t *c_ctx = NULL;
+    size_t i = 0;
+
+    memset(usage, 0, sizeof *usage);
+
+    RWLOCK_RDLOCK_TIMED_CHECK_RETURN(&dm_ctx->commit_ctxs.lock);
+    while (NULL != (c_ctx = sr_omap_get_at(dm_ctx->commit_ctxs.tree, i++))) {
+        usage->tree_cnt += c_ctx->mem_usage.tree_cnt;
+        usage->node_cnt += c_ctx->mem_usage.node_cnt;
+        usage->mem_size += c_ctx->mem_usage.mem_size;
+    }
+    *ctx_cnt = sr_omap_count(dm_ctx->commit_ctxs.tree);
+    sr_rwlock_unlock(&dm_ctx->commit_ctxs.lock);
+
+    return SR_ERR_OK;
+}
@@ -38,6 +38,7 @@
 #include "persistence_manager.h"
 #include "connection_manager.h"
 #include "module_dependencies.h"
+#include "nacm.h"
 
 /**
  * @brief number of supported data stores - length of arrays used in session
@@ -59,6 +60,15 @@ typedef struct dm_session_s dm_session_t;
  */
 typedef struct rp_session_s rp_session_t;
 
+/**
+ * @brief Memory used by a set of data trees.
+ */
+typedef struct dm_mem_usage_s {
+    size_t tree_cnt;    /**< number of the data trees */
+    size_t node_cnt;    /**< number of nodes in the data trees */
+    size_t mem_size;    /**< estimated memory used by the data trees (in bytes) */
+} dm_mem_usage_t;
+
 /**
  * @brief Holds information related to the schema.
  */
@@ -75,6 +85,9 @@ typedef struct dm_schema_info_s {
     const struct lys_module *module;    /**< Pointer to the module, might be NULL if module has been uninstalled*/
     bool cross_module_data_dependency;  /**< Flag whether data from different module is needed for validation */
     bool can_not_be_locked;             /**< If true module contains no data and lock_module for the module is NOP */
+    bool has_when_conditions;           /**< Flag whether the data tree of the module contains a conditional (when) node */
+    dm_mem_usage_t mem_usage[DM_DATASTORE_COUNT]; /**< memory used by the session copies of the module per datastore
+                                         * (as accounted at the end of the requests), updated atomically */
 }dm_schema_info_t;
 
 /**
@@ -86,6 +99,13 @@ typedef struct dm_data_info_s{
     struct lyd_node *node;              /**< data tree */
     struct timespec timestamp;          /**< timestamp of this copy (used only if HAVE_ST_MTIM is defined) */
     bool modified;                      /**< flag denoting whether a change has been made*/
+    sr_list_t *changed_paths;           /**< xpaths of the subtrees touched by edit operations since the tree was loaded,
+                                         * NULL if changes are not tracked for the tree */
+    size_t mem_size;                    /**< estimated memory used by the data tree (in bytes), 0 if not accounted yet */
+    size_t node_cnt;                    /**< number of nodes in the data tree when mem_size was computed */
+    size_t mem_size_ops;                /**< number of session operations when mem_size was computed */
+    sr_datastore_t mem_ds;              /**< datastore in which mem_size is accounted in the schema info */
+    uint64_t last_access;               /**< session access tick of the last use of the copy (used for LRU eviction) */
 }dm_data_info_t;
 
 /**
@@ -128,7 +148,7 @@ typedef enum dm_commit_state_e {
 typedef struct dm_sess_op_s{
     dm_operation_t op;          /**< Operation kind*/
     bool has_error;             /**< Flag if the operation should be performed during commit*/
-    char *xpath;                /**< Xpath */
+    const char *xpath;          /**< Xpath (interned) */
     union {
         struct set{
             sr_val_t *val;              /**< Value to perform operation with, can be NULL*/
@@ -153,8 +173,9 @@ typedef struct dm_model_subscription_s {
     np_subscription_t **subscriptions;  /**< array of struct received from np */
     struct lys_node **nodes;            /**< array of schema nodes corresponding to the subscription */
     size_t subscription_cnt;            /**< number of subscriptions */
+    sr_omap_t *subscription_index;      /**< index mapping schema nodes to the subscriptions interested in their changes */
     struct lyd_difflist *difflist;      /**< diff list */
-    sr_list_t *changes;                 /**< set of changes for the model */
+    sr_list_t *changes;                 /**< set of changes for the model, generated once per commit event and shared by all readers */
     bool changes_generated;             /**< Flag signalizing that changes has been generated */
     pthread_rwlock_t changes_lock;      /**< Lock guarding the changes member of structure */
 }dm_model_subscription_t;
@@ -170,15 +191,20 @@ typedef struct dm_commit_context_s {
     int *fds;                   /**< opened file descriptors */
     bool *existed;              /**< flag wheter the file for the filedesriptor existed (and should be truncated) before commit*/
     size_t modif_count;         /**< number of modified models fds to be closed*/
-    sr_list_t *up_to_date_models; /**< set of module names where the timestamp of the session copy is equal to file system timestamp */
+    sr_list_t *up_to_date_models; /**< set of module names where the timestamp of the session copy is equal to file system timestamp
+                                       (names owned by the schemas, not copied) */
     dm_sess_op_t *operations;   /**< pointer to the list of operations performed in session to be commited */
     size_t oper_count;          /**< number of operation in the operations list */
-    sr_btree_t *subscriptions;  /**< binary trees of subscriptions organised per models */
-    sr_btree_t *prev_data_trees;/**< data trees in the state before commit */
+    sr_omap_t *subscriptions;   /**< ordered map of subscriptions organised per models */
+    sr_omap_t *prev_data_trees; /**< data trees in the state before commit */
     rp_session_t *init_session; /**< session that initialized the commit, used for resuming commit once verifiers reply */
     sr_error_info_t *errors;    /**< errors returned by verifiers */
     size_t err_cnt;             /**< number of errors from verifiers */
-    sr_list_t *err_subs_xpaths; /**< subscriptions that returned an error */
+    sr_list_t *err_subs_xpaths; /**< xpaths of the subscriptions that returned an error (interned) */
+    struct timespec started;    /**< time when the commit started (CLOCK_MONOTONIC) */
+    struct timespec wait_start; /**< time when the commit started to wait for verifiers (CLOCK_MONOTONIC) */
+    uint64_t stage_time[DM_COMMIT_FINISHED]; /**< time spent in each commit stage (in microseconds) */
+    dm_mem_usage_t mem_usage;   /**< memory retained by the data trees of the context (computed when it is saved) */
 } dm_commit_context_t;
 
 /**
@@ -186,7 +212,7 @@ typedef struct dm_commit_context_s {
  * session.
  */
 typedef struct dm_c_ctxs_s {
-    sr_btree_t *tree;      /**< Tree of commit context used for notifications */
+    sr_omap_t *tree;       /**< Map of commit contexts used for notifications */
     pthread_rwlock_t lock; /**< rwlock to access c_ctxs */
 } dm_commit_ctxs_t;
 
@@ -286,6 +312,16 @@ int dm_get_data_info(dm_ctx_t *dm_ctx, dm_session_t *dm_session_ctx, const char
  */
 int dm_get_datatree(dm_ctx_t *dm_ctx, dm_session_t *dm_session_ctx, const char *module_name, struct lyd_node **data_tree);
 
+/**
+ * @brief Returns the data tree for the specified module only if the session has already
+ * loaded its copy in the current datastore. Nothing is loaded from the file system.
+ * @param [in] dm_session_ctx
+ * @param [in] module_name
+ * @param [out] data_tree - @note returned data tree should not be modified
+ * @return Error code (SR_ERR_OK on success), SR_ERR_NOT_FOUND if the data tree is not loaded or empty
+ */
+int dm_get_loaded_datatree(dm_session_t *dm_session_ctx, const char *module_name, struct lyd_node **data_tree);
+
 /**
  * @brief Tests if the schema exists. If yes returns the module (loads from file system if
  * necessary). Having read lock ensures that model will not be uninstalled from sysrepo.
@@ -453,6 +489,22 @@ int dm_commit_notify(dm_ctx_t *dm_ctx, dm_session_t *session, sr_notif_event_t e
  */
 void dm_free_commit_context(void *commit_ctx);
 
+/**
+ * @brief Returns the name of a commit state.
+ * @param [in] state
+ * @return Name of the state
+ */
+const char *dm_commit_state_to_str(dm_commit_state_t state);
+
+/**
+ * @brief Emits the trace record of a finished commit: commit id, committed modules,
+ * number of operations and time spent in each stage including the wait for verifiers.
+ * The record is logged on the informational level and passed to the commit_done USDT probe.
+ * @param [in] c_ctx Commit context.
+ * @param [in] result Result of the commit.
+ */
+void dm_commit_trace(const dm_commit_context_t *c_ctx, int result);
+
 /**
  * @brief Saves commit context to be used for notifications. Releases acquired locks
  * and closes opened files.
@@ -573,6 +625,28 @@ bool dm_is_enabled_check_recursively(struct lys_node *node);
  */
 int dm_set_node_state(struct lys_node *node, dm_node_state_t state);
 
+/**
+ * @brief Returns NACM access profile of the user the session belongs to.
+ *
+ * @param [in] dm_ctx
+ * @param [in] session
+ * @param [out] profile
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_nacm_get_profile(dm_ctx_t *dm_ctx, const dm_session_t *session, nacm_profile_t *profile);
+
+/**
+ * @brief Checks whether the NACM rules allow the access to the instances of the schema node.
+ *
+ * @note Function expects that a schema info is locked for reading.
+ *
+ * @param [in] node
+ * @param [in] profile Access profile returned by ::dm_nacm_get_profile.
+ * @param [in] access NACM_ACCESS_* operations (all of them have to be allowed) or 0 for reading of the whole subtree.
+ * @return True if the access is allowed.
+ */
+bool dm_nacm_check_node(const struct lys_node *node, const nacm_profile_t *profile, uint8_t access);
+
 /**
  * @brief Returns true if argument is not NULL and session is tied to the running data store.
  * @param [in] session
@@ -611,12 +685,16 @@ int dm_lock_module(dm_ctx_t *dm_ctx, dm_session_t *session, const char *module_n
 int dm_unlock_module(dm_ctx_t *dm_ctx, dm_session_t *session, char *modul_name);
 
 /**
- * @brief Acquires locks for all models. If the module can not be locked
- * because of permission it is skipped. In any locking failed no module
- * is locked by dm_lock_data_store.
+ * @brief Acquires the lock of the datastore of the session, which covers all models
+ * the user is allowed to lock, the others are skipped. If the user is allowed to lock all
+ * models, the lock is a single exclusive lock conflicting with the module locks of other sessions
+ * and the features of the models can not be modified until the datastore is unlocked. Otherwise
+ * the lockable models are locked one by one, so that the skipped ones stay available to other
+ * sessions. The permissions are decided by Access Control module cache.
  * @param [in] dm_ctx
  * @param [in] session
- * @return Error code (SR_ERR_OK on success)
+ * @return Error code (SR_ERR_OK on success), SR_ERR_LOCKED if a model or the datastore
+ * is locked by other session.
  */
 int dm_lock_datastore(dm_ctx_t *dm_ctx, dm_session_t *session);
 
@@ -704,6 +782,20 @@ int dm_has_enabled_subtree(dm_ctx_t *ctx, const char *module_name, dm_schema_inf
 int dm_enable_module_running(dm_ctx_t *ctx, dm_session_t *session, const char *module_name,
         const np_subscription_t *subscription);
 
+/**
+ * @brief Loads a module whose schema is shipped among the internal schemas of Sysrepo and enables
+ * it in running datastore. The module is added only into the in-memory dependency graph and enabled
+ * only in memory, nothing is written into the repository. Meant for modules whose state data are
+ * provided by the engine itself.
+ *
+ * @note Function acquires and releases write lock for the schema info.
+ *
+ * @param [in] ctx DM context.
+ * @param [in] module_name Name of the module, its schema is expected in file <module_name>.yang.
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_load_internal_module(dm_ctx_t *ctx, const char *module_name);
+
 /**
  * @brief Enables subtree in running datastore (including copying of the startup data into running).
  * @param [in] ctx DM context.
@@ -868,6 +960,33 @@ int dm_validate_event_notif_tree(dm_ctx_t *dm_ctx, dm_session_t *session, const
  */
 struct lyd_node *dm_lyd_new_path(dm_data_info_t *data_info, const char *path, const char *value, int options);
 
+/**
+ * @brief Records the subtree that has been modified by an edit operation. If the changes are
+ * tracked for the data tree, the diff of the commit is computed only for the touched subtrees.
+ * @param [in] data_info
+ * @param [in] node - node whose subtree has been modified (for deleted nodes its parent)
+ */
+void dm_add_changed_node(dm_data_info_t *data_info, const struct lyd_node *node);
+
+/**
+ * @brief Stops tracking of changes for the data tree, the diff will be computed
+ * by comparison of the whole data trees.
+ * @param [in] data_info
+ */
+void dm_untrack_changes(dm_data_info_t *data_info);
+
+/**
+ * @brief Computes the differences between the data tree before commit and the data tree of the commit.
+ * If the changes made in the commit tree were tracked, only touched subtrees are compared, otherwise
+ * the whole trees are compared.
+ * @param [in] prev_info - data tree before commit
+ * @param [in] commit_info - data tree of the commit
+ * @param [in] inverse - if set to true, the changes that revert the commit are returned
+ * @param [out] diff - list of differences, to be freed by lyd_free_diff
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_get_data_info_diff(const dm_data_info_t *prev_info, const dm_data_info_t *commit_info, bool inverse, struct lyd_difflist **diff);
+
 /**
  * @brief Copies all modified data trees (in current datastore) from one session to another.
  * @note Corresponding operations are not copied so the changes may be overwritten by session refresh.
@@ -1037,5 +1156,123 @@ int dm_lock_schema_info_write(dm_schema_info_t *schema_info);
  */
 int dm_get_nodes_by_schema(dm_session_t *session, const char *module_name, const struct lys_node *node, struct ly_set **res);
 
+/**
+ * @brief Usage of a module by the loaded data trees.
+ */
+typedef struct dm_module_usage_s {
+    char *module_name;      /**< Name of the module. */
+    size_t data_tree_cnt;   /**< Number of data trees of the module loaded in sessions and commit contexts. */
+    dm_mem_usage_t mem_usage[DM_DATASTORE_COUNT];  /**< Memory used by the session copies per datastore. */
+} dm_module_usage_t;
+
+/**
+ * @brief Returns the usage of all modules that have some data trees loaded.
+ *
+ * @param [in] dm_ctx
+ * @param [out] usage Array of module usages, to be freed by ::dm_free_module_usage.
+ * @param [out] count Number of the modules in the array.
+ *
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_get_module_usage(dm_ctx_t *dm_ctx, dm_module_usage_t **usage, size_t *count);
+
+/**
+ * @brief Frees the array returned by ::dm_get_module_usage.
+ *
+ * @param [in] usage
+ * @param [in] count
+ */
+void dm_free_module_usage(dm_module_usage_t *usage, size_t count);
+
+/**
+ * @brief Contention statistics of a datastore or module lock.
+ */
+typedef struct dm_lock_stats_s {
+    char *module_name;          /**< Name of the module, NULL for the lock of the whole datastore. */
+    sr_datastore_t datastore;   /**< Datastore of the lock. */
+    sr_lock_stats_t stats;      /**< Statistics of the lock. */
+} dm_lock_stats_t;
+
+/**
+ * @brief Returns the contention statistics of the datastore and module locks taken in this
+ * engine. Locks that have never been acquired are omitted.
+ *
+ * @param [in] dm_ctx
+ * @param [out] stats Array of lock statistics, to be freed by ::dm_free_lock_stats.
+ * @param [out] count Number of the locks in the array.
+ *
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_get_lock_stats(dm_ctx_t *dm_ctx, dm_lock_stats_t **stats, size_t *count);
+
+/**
+ * @brief Frees the array returned by ::dm_get_lock_stats.
+ *
+ * @param [in] stats
+ * @param [in] count
+ */
+void dm_free_lock_stats(dm_lock_stats_t *stats, size_t count);
+
+/**
+ * @brief Memory used by the session copies of data trees and statistics of their eviction.
+ */
+typedef struct dm_mem_stats_s {
+    size_t session_budget;  /**< Memory budget of the data trees of one session (in bytes, 0 = unlimited). */
+    size_t global_budget;   /**< Memory budget of the data trees of all sessions (in bytes, 0 = unlimited). */
+    size_t used;            /**< Estimated memory used by the data trees of all sessions (in bytes). */
+    uint64_t evictions;     /**< Number of unmodified session copies evicted to fit into the budgets. */
+    uint64_t reloads;       /**< Number of evicted session copies loaded again. */
+} dm_mem_stats_t;
+
+/**
+ * @brief Returns the memory budgets of session data trees and the eviction statistics.
+ *
+ * @param [in] dm_ctx
+ * @param [out] stats
+ */
+void dm_get_mem_stats(dm_ctx_t *dm_ctx, dm_mem_stats_t *stats);
+
+/**
+ * @brief Updates the memory accounting of the session data trees and, if the session
+ * or global budget is exceeded, evicts the least recently used unmodified copies
+ * of the session. Evicted copies are loaded again from the datastore by the next
+ * ::dm_get_data_info call, the session sees the data as if it was refreshed.
+ * Only copies of the given session are evicted. If the global budget is still exceeded
+ * afterwards, the caller is expected to trim other idle sessions.
+ *
+ * @note The caller must guarantee that no data tree of the session is in use
+ * (the function is called between requests of the session).
+ *
+ * @param [in] dm_ctx
+ * @param [in] session
+ * @param [in] keep_modules Names of modules whose copies must not be evicted, e.g. because
+ * they hold state data loaded for the session (may be NULL).
+ * @param [out] evicted_cnt Number of evicted copies (may be NULL).
+ *
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_session_trim(dm_ctx_t *dm_ctx, dm_session_t *session, const sr_list_t *keep_modules, size_t *evicted_cnt);
+
+/**
+ * @brief Returns the memory used by the data trees of the session as accounted
+ * by the last ::dm_session_trim call. Can be called from any thread.
+ *
+ * @param [in] session
+ * @param [out] usage
+ */
+void dm_get_session_mem_usage(const dm_session_t *session, dm_mem_usage_t *usage);
+
+/**
+ * @brief Returns the number of commit contexts retained for the notification
+ * sessions and the memory used by their data trees.
+ *
+ * @param [in] dm_ctx
+ * @param [out] ctx_cnt Number of the retained commit contexts.
+ * @param [out] usage Memory used by the data trees of the contexts.
+ *
+ * @return Error code (SR_ERR_OK on success)
+ */
+int dm_get_commit_ctxs_usage(dm_ctx_t *dm_ctx, size_t *ctx_cnt, dm_mem_usage_t *usage);
+
 /**@} Data manager*/
 #endif /* SRC_DATA_MANAGER_H_ */
@@ -210,6 +210,62 @@ srctl_list_modules()
     return rc;
 }
 
+/**
+ * @brief Performs the --memory operation.
+ */
+static int
+srctl_memory()
+{
+    sr_conn_ctx_t *connection = NULL;
+    sr_session_ctx_t *session = NULL;
+    sr_val_t *values = NULL;
+    size_t value_cnt = 0;
+    char xpath[PATH_MAX] = { 0, };
+    int rc = SR_ERR_OK;
+
+    const char * const sections[][2] = {
+        { "Sessions", "request-processor/session" },
+        { "Modules", "data-manager/module" },
+        { "Connections", "connection-manager/connection" },
+        { "Commit contexts", "commits" },
+        { "Memory caches", "memory-management" },
+    };
+
+    /* the statistics describe the engine of the daemon */
+    rc = srctl_open_session(true, &connection, &session);
+    if (SR_ERR_OK == rc) {
+        rc = sr_session_switch_ds(session, SR_DS_RUNNING);
+    }
+
+    for (size_t i = 0; SR_ERR_OK == rc && i < sizeof sections / sizeof *sections; ++i) {
+        snprintf(xpath, PATH_MAX, "/sysrepo-statistics:sysrepo-statistics/%s//*", sections[i][1]);
+        rc = sr_get_items(session, xpath, &values, &value_cnt);
+        if (SR_ERR_NOT_FOUND == rc) {
+            rc = SR_ERR_OK;
+            value_cnt = 0;
+        }
+        if (SR_ERR_OK == rc) {
+            printf("%s:\n", sections[i][0]);
+            for (size_t j = 0; j < value_cnt; ++j) {
+                if (SR_LIST_T != values[j].type && SR_CONTAINER_T != values[j].type) {
+                    printf("  ");
+                    sr_print_val(&values[j]);
+                }
+            }
+            printf("\n");
+            sr_free_values(values, value_cnt);
+            values = NULL;
+        }
+    }
+
+    if (SR_ERR_OK != rc) {
+        srctl_report_error(session, rc);
+    }
+    sr_disconnect(connection);
+
+    return rc;
+}
+
 /**
  * @brief Extracts the path to the directory with the file out of the file path.
  */
@@ -1215,6 +1271,7 @@ srctl_print_help()
     printf("  -c, --change           Changes specified module in sysrepo (--module must be specified).\n");
     printf("  -e, --feature-enable   Enables a feature within a module in sysrepo (feature name is the argument, --module must be specified).\n");
     printf("  -d, --feature-disable  Disables a feature within a module in sysrepo (feature name is the argument, --module must be specified).\n");
+    printf("  -M, --memory           Prints memory used by sessions, modules, connections and commit contexts of sysrepo daemon.\n");
     printf("\n");
     printf("Available other-options:\n");
     printf("  -L, --level            Set verbosity level of logging ([0 - 4], 0 = all logging turned off).\n");
@@ -1234,6 +1291,8 @@ srctl_print_help()
     printf("     sysrepoctl --change --module=ietf-interfaces --owner=admin:admin --permissions=644\n\n");
     printf("  3) Enable a feature within a YANG module:\n");
     printf("     sysrepoctl --feature-enable=if-mib --module=ietf-interfaces\n\n");
+    printf("  4) Print memory usage of the running sysrepo daemon:\n");
+    printf("     sysrepoctl --memory\n\n");
 }
 
 /**
@@ -1262,6 +1321,7 @@ main(int argc, char* argv[])
        { "change",          no_argument,       NULL, 'c' },
        { "feature-enable",  required_argument, NULL, 'e' },
        { "feature-disable", required_argument, NULL, 'd' },
+       { "memory",          no_argument,       NULL, 'M' },
 
        { "level",           required_argument, NULL, 'L' },
        { "yang",            required_argument, NULL, 'g' },
@@ -1276,7 +1336,7 @@ main(int argc, char* argv[])
        { 0, 0, 0, 0 }
     };
 
-    while ((c = getopt_long(argc, argv, "hvlituce:d:L:g:n:m:r:o:p:s:S0:W;", longopts, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "hvlituce:d:ML:g:n:m:r:o:p:s:S0:W;", longopts, NULL)) != -1) {
         switch (c) {
             case 'h':
                 srctl_print_help();
@@ -1294,6 +1354,7 @@ main(int argc, char* argv[])
             case 't':
             case 'u':
             case 'c':
+            case 'M':
                 operation = c;
                 break;
             case 'e':
@@ -1389,6 +1450,9 @@ main(int argc, char* argv[])
         case 'd':
             rc = srctl_feature_change(module, feature_name, false);
             break;
+        case 'M':
+            rc = srctl_memory();
+            break;
         default:
             srctl_print_help();
     }
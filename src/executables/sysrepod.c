@@ -27,10 +27,18 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <signal.h>
+#include <string.h>
+#include <errno.h>
 
 #include "sr_common.h"
 #include "connection_manager.h"
 
+/** @brief File passing the log level requested by `sysrepod -s` to the running daemon */
+#define SRD_LOG_LEVEL_FILE SR_DAEMON_PID_FILE ".log-level"
+
+/** @brief Maximum length of the log level request, e.g. "syslog:4" */
+#define SRD_LOG_LEVEL_MAX_LEN 32
+
 /**
  * @brief Callback to be called when a signal requesting daemon termination has been received.
  */
@@ -45,6 +53,152 @@ srd_sigterm_cb(cm_ctx_t *cm_ctx, int signum)
     }
 }
 
+/**
+ * @brief Callback to be called when a signal requesting dump of the lock statistics has been received.
+ */
+static void
+srd_sigusr1_cb(cm_ctx_t *cm_ctx, int signum)
+{
+    sr_lockstat_dump();
+}
+
+/**
+ * @brief Parses the log level request in format <output>:<level>.
+ */
+static int
+srd_parse_log_level(const char *request, char *output, size_t output_size, sr_log_level_t *log_level)
+{
+    const char *delim = strchr(request, ':');
+    char *endptr = NULL;
+    long level = 0;
+
+    if (NULL == delim || delim == request || (size_t) (delim - request) >= output_size) {
+        return SR_ERR_INVAL_ARG;
+    }
+    errno = 0;
+    level = strtol(delim + 1, &endptr, 10);
+    if (0 != errno || endptr == delim + 1 || ('\0' != *endptr && '\n' != *endptr) || level < SR_LL_NONE || level > SR_LL_DBG) {
+        return SR_ERR_INVAL_ARG;
+    }
+    if (0 != strncmp("stderr", request, delim - request) && 0 != strncmp("syslog", request, delim - request)) {
+        return SR_ERR_INVAL_ARG;
+    }
+
+    memcpy(output, request, delim - request);
+    output[delim - request] = '\0';
+    *log_level = level;
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Reads and removes the log level request left for the daemon by `sysrepod -s`.
+ * Only requests written by the user running the daemon are accepted.
+ */
+static int
+srd_read_log_level_request(char *output, size_t output_size, sr_log_level_t *log_level)
+{
+    char request[SRD_LOG_LEVEL_MAX_LEN] = { 0, };
+    struct stat st = { 0, };
+    ssize_t len = 0;
+    int fd = -1, rc = SR_ERR_OK;
+
+    fd = open(SRD_LOG_LEVEL_FILE, O_RDONLY | O_NOFOLLOW);
+    if (-1 == fd) {
+        return SR_ERR_NOT_FOUND;
+    }
+    unlink(SRD_LOG_LEVEL_FILE);
+
+    if (-1 == fstat(fd, &st) || st.st_uid != geteuid()) {
+        SR_LOG_WRN("Ignoring log level request %s not owned by the daemon user.", SRD_LOG_LEVEL_FILE);
+        rc = SR_ERR_UNAUTHORIZED;
+    } else {
+        len = read(fd, request, sizeof(request) - 1);
+        rc = len > 0 ? srd_parse_log_level(request, output, output_size, log_level) : SR_ERR_INVAL_ARG;
+        if (SR_ERR_OK != rc) {
+            SR_LOG_WRN("Invalid log level request in %s.", SRD_LOG_LEVEL_FILE);
+        }
+    }
+    close(fd);
+
+    return rc;
+}
+
+/**
+ * @brief Requests change of the log level of the running daemon. The request is left
+ * in a file next to the PID file of the daemon, which is then signaled by SIGUSR2.
+ */
+static int
+srd_request_log_level(const char *request)
+{
+    char output[SRD_LOG_LEVEL_MAX_LEN] = { 0, };
+    sr_log_level_t log_level = SR_LL_NONE;
+    FILE *pid_file = NULL;
+    pid_t pid = 0;
+    int fd = -1;
+
+    if (SR_ERR_OK != srd_parse_log_level(request, output, sizeof(output), &log_level)) {
+        fprintf(stderr, "Invalid log level request '%s', expected <stderr|syslog>:<0-4>.\n", request);
+        return EXIT_FAILURE;
+    }
+
+    pid_file = fopen(SR_DAEMON_PID_FILE, "r");
+    if (NULL == pid_file || 1 != fscanf(pid_file, "%d", &pid) || pid <= 0) {
+        fprintf(stderr, "Unable to read PID of the running daemon from %s.\n", SR_DAEMON_PID_FILE);
+        if (NULL != pid_file) {
+            fclose(pid_file);
+        }
+        return EXIT_FAILURE;
+    }
+    fclose(pid_file);
+
+    unlink(SRD_LOG_LEVEL_FILE);
+    fd = open(SRD_LOG_LEVEL_FILE, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (-1 == fd || (ssize_t) strlen(request) != write(fd, request, strlen(request))) {
+        fprintf(stderr, "Unable to write %s: %s.\n", SRD_LOG_LEVEL_FILE, strerror(errno));
+        if (-1 != fd) {
+            close(fd);
+            unlink(SRD_LOG_LEVEL_FILE);
+        }
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    if (-1 == kill(pid, SIGUSR2)) {
+        fprintf(stderr, "Unable to signal the daemon (PID %d): %s.\n", pid, strerror(errno));
+        unlink(SRD_LOG_LEVEL_FILE);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Callback to be called when a signal requesting change of the log level has been received.
+ * Sets the level requested by `sysrepod -s`, if there is no such request, raises the verbosity
+ * of the enabled log output by one level, debug level wraps around to errors.
+ */
+static void
+srd_sigusr2_cb(cm_ctx_t *cm_ctx, int signum)
+{
+    char output[SRD_LOG_LEVEL_MAX_LEN] = { 0, };
+    sr_log_level_t log_level = SR_LL_NONE;
+
+    if (SR_ERR_OK == srd_read_log_level_request(output, sizeof(output), &log_level)) {
+        sr_logger_set_level(output, log_level);
+        SR_LOG_INF("Log level of %s changed to %d on request.", output, log_level);
+        return;
+    }
+
+    if (SR_LL_NONE != sr_ll_stderr) {
+        log_level = (sr_ll_stderr % SR_LL_DBG) + 1;
+        sr_log_stderr(log_level);
+    } else {
+        log_level = (sr_ll_syslog % SR_LL_DBG) + 1;
+        sr_log_syslog(log_level);
+    }
+    SR_LOG_INF("Log level changed to %d by SIGUSR2 signal.", log_level);
+}
+
 /**
  * @brief Prints daemon version.
  */
@@ -63,7 +217,7 @@ srd_print_help()
     srd_print_version();
 
     printf("Usage:\n");
-    printf("  sysrepod [-h] [-v] [-d] [-l <level>]\n\n");
+    printf("  sysrepod [-h] [-v] [-d] [-l <level>] [-s <output>:<level>]\n\n");
     printf("Options:\n");
     printf("  -h\t\tPrints usage help.\n");
     printf("  -v\t\tPrints version.\n");
@@ -74,6 +228,9 @@ srd_print_help()
     printf("\t\t\t2 = (default) log error and warning messages\n");
     printf("\t\t\t3 = log error, warning and informational messages\n");
     printf("\t\t\t4 = log everything, including development debug messages\n");
+    printf("\t\tThe level can be raised at runtime by SIGUSR2 signal (wraps around from 4 to 1).\n");
+    printf("  -s <output>:<level>\n");
+    printf("\t\tSets the log level of the output (stderr or syslog) of the running daemon and exits.\n");
 }
 
 /**
@@ -90,7 +247,7 @@ main(int argc, char* argv[])
     int log_level = -1;
     int rc = SR_ERR_OK;
 
-    while ((c = getopt (argc, argv, "hvdl:")) != -1) {
+    while ((c = getopt (argc, argv, "hvdl:s:")) != -1) {
         switch (c) {
             case 'v':
                 srd_print_version();
@@ -102,6 +259,8 @@ main(int argc, char* argv[])
             case 'l':
                 log_level = atoi(optarg);
                 break;
+            case 's':
+                return srd_request_log_level(optarg);
             default:
                 srd_print_help();
                 return 0;
@@ -114,17 +273,26 @@ main(int argc, char* argv[])
     /* daemonize the process */
     parent_pid = sr_daemonize(debug_mode, log_level, SR_DAEMON_PID_FILE, &pidfile_fd);
 
+    /* write the logs from a background thread, so that the engine threads never block on the output */
+    sr_logger_set_async(true);
+
     SR_LOG_DBG_MSG("Sysrepo daemon initialization started.");
 
     /* initialize local Connection Manager */
     rc = cm_init(CM_MODE_DAEMON, SR_DAEMON_SOCKET, &sr_cm_ctx);
     CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to initialize Connection Manager: %s.", sr_strerror(rc));
 
-    /* install SIGTERM & SIGINT signal watchers */
+    /* install SIGTERM & SIGINT signal watchers, SIGUSR1 dumps the lock statistics, SIGUSR2 changes the log level */
     rc = cm_watch_signal(sr_cm_ctx, SIGTERM, srd_sigterm_cb);
     if (SR_ERR_OK == rc) {
         rc = cm_watch_signal(sr_cm_ctx, SIGINT, srd_sigterm_cb);
     }
+    if (SR_ERR_OK == rc) {
+        rc = cm_watch_signal(sr_cm_ctx, SIGUSR1, srd_sigusr1_cb);
+    }
+    if (SR_ERR_OK == rc) {
+        rc = cm_watch_signal(sr_cm_ctx, SIGUSR2, srd_sigusr2_cb);
+    }
     CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to initialize signal watcher: %s.", sr_strerror(rc));
 
     /* tell the parent process that we are okay */
@@ -0,0 +1,842 @@
+/**
+ * @file nacm.c
+ * @brief NETCONF Access Control Model (NACM) implementation.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <assert.h>
+
+#include "sr_common.h"
+#include "nacm.h"
+
+/** @brief Maximum depth of a data path the rules can be matched against. */
+#define NACM_MAX_PATH_DEPTH 64
+
+/**
+ * @brief Compiled NACM rule.
+ */
+typedef struct nacm_compiled_rule_s {
+    const nacm_rule_t *rule;    /**< Rule from the configuration. */
+    char **path_segments;       /**< Names of the nodes in the path of the rule (without predicates). */
+    char **path_modules;        /**< Modules (prefixes) of the nodes in the path of the rule, NULL if not specified. */
+    size_t path_depth;          /**< Number of the nodes in the path. */
+    uint64_t profiles;          /**< Profiles the rule applies to. */
+} nacm_compiled_rule_t;
+
+/**
+ * @brief Access profile assigned to a user.
+ */
+typedef struct nacm_user_s {
+    char *name;                 /**< Name of the user. */
+    uint64_t groups;            /**< Groups the user is member of (bit per group). */
+    size_t profile;             /**< Index of the profile of the user. */
+} nacm_user_t;
+
+/**
+ * @brief NACM context.
+ */
+typedef struct nacm_ctx_s {
+    pthread_rwlock_t lock;          /**< Lock protecting the rules in use. */
+    nacm_config_t *config;          /**< Configuration in use. */
+    nacm_compiled_rule_t *rules;    /**< Compiled data-node rules of all rule lists (in order). */
+    size_t rule_cnt;                /**< Number of compiled rules. */
+    sr_omap_t *users;               /**< Profiles of the users (nacm_user_t). */
+    uint64_t all_profiles;          /**< Mask of all profiles in use. */
+    bool deny_all;                  /**< Configuration cannot be compiled, all access is denied. */
+    uint32_t generation;            /**< Generation of the rules in use. */
+} nacm_ctx_t;
+
+/**
+ * @brief Compares two users by name.
+ */
+static int
+nacm_user_cmp(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    nacm_user_t *user_a = (nacm_user_t *) a;
+    nacm_user_t *user_b = (nacm_user_t *) b;
+
+    int res = strcmp(user_a->name, user_b->name);
+    if (0 == res) {
+        return 0;
+    } else if (res < 0) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Computes hash of a user from the name.
+ */
+static uint32_t
+nacm_user_hash(const void *user)
+{
+    assert(user);
+    return sr_str_hash(((nacm_user_t *) user)->name);
+}
+
+/**
+ * @brief Frees a user.
+ */
+static void
+nacm_user_free(void *user_p)
+{
+    nacm_user_t *user = (nacm_user_t *) user_p;
+    if (NULL != user) {
+        free(user->name);
+        free(user);
+    }
+}
+
+/**
+ * @brief Frees the compiled rules and users of the context.
+ */
+static void
+nacm_free_compiled(nacm_ctx_t *nacm_ctx)
+{
+    for (size_t i = 0; i < nacm_ctx->rule_cnt; i++) {
+        for (size_t j = 0; j < nacm_ctx->rules[i].path_depth; j++) {
+            free(nacm_ctx->rules[i].path_segments[j]);
+            free(nacm_ctx->rules[i].path_modules[j]);
+        }
+        free(nacm_ctx->rules[i].path_segments);
+        free(nacm_ctx->rules[i].path_modules);
+    }
+    free(nacm_ctx->rules);
+    nacm_ctx->rules = NULL;
+    nacm_ctx->rule_cnt = 0;
+
+    sr_omap_cleanup(nacm_ctx->users);
+    nacm_ctx->users = NULL;
+    nacm_ctx->all_profiles = 0;
+}
+
+/**
+ * @brief Splits a data path into node names and their modules, omitting the predicates.
+ * A node without a prefix belongs to the module of its parent.
+ */
+static int
+nacm_split_path(const char *path, char ***segments_p, char ***modules_p, size_t *depth_p)
+{
+    char **segments = NULL, **modules = NULL, **tmp = NULL;
+    size_t depth = 0, len = 0;
+    const char *begin = NULL, *prefix = NULL, *colon = NULL;
+    int rc = SR_ERR_OK;
+
+    while ('\0' != *path) {
+        if ('/' == *path) {
+            path++;
+            continue;
+        }
+        begin = prefix = path;
+        colon = NULL;
+        while ('\0' != *path && '/' != *path && '[' != *path) {
+            if (':' == *path) {
+                colon = path;
+            }
+            path++;
+        }
+        if (NULL != colon) {
+            begin = colon + 1;
+        }
+        len = path - begin;
+        /* skip the predicates */
+        while ('[' == *path) {
+            while ('\0' != *path && ']' != *path) {
+                if ('\'' == *path || '"' == *path) {
+                    char quote = *path++;
+                    while ('\0' != *path && quote != *path) {
+                        path++;
+                    }
+                }
+                if ('\0' != *path) {
+                    path++;
+                }
+            }
+            if ('\0' != *path) {
+                path++;
+            }
+        }
+        if (0 == len) {
+            continue;
+        }
+        tmp = realloc(segments, (depth + 1) * sizeof(*segments));
+        CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
+        segments = tmp;
+        tmp = realloc(modules, (depth + 1) * sizeof(*modules));
+        CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
+        modules = tmp;
+        segments[depth] = strndup(begin, len);
+        modules[depth] = NULL;
+        depth++;
+        CHECK_NULL_NOMEM_GOTO(segments[depth - 1], rc, cleanup);
+        if (NULL != colon) {
+            modules[depth - 1] = strndup(prefix, colon - prefix);
+            CHECK_NULL_NOMEM_GOTO(modules[depth - 1], rc, cleanup);
+        } else if (depth > 1 && NULL != modules[depth - 2]) {
+            modules[depth - 1] = strdup(modules[depth - 2]);
+            CHECK_NULL_NOMEM_GOTO(modules[depth - 1], rc, cleanup);
+        }
+    }
+
+    *segments_p = segments;
+    *modules_p = modules;
+    *depth_p = depth;
+    return SR_ERR_OK;
+
+cleanup:
+    for (size_t i = 0; i < depth; i++) {
+        free(segments[i]);
+        free(modules[i]);
+    }
+    free(segments);
+    free(modules);
+    return rc;
+}
+
+/**
+ * @brief Assigns access profiles to the users: users with the same set of groups share the profile.
+ * Profile 0 stands for the users that are not members of any group.
+ */
+static int
+nacm_assign_profiles(nacm_ctx_t *nacm_ctx, uint64_t *profile_groups, size_t *profile_cnt_p)
+{
+    const nacm_config_t *config = nacm_ctx->config;
+    nacm_user_t lookup = { 0, }, *user = NULL;
+    size_t profile_cnt = 1, i = 0;
+    int rc = SR_ERR_OK;
+
+    rc = sr_omap_init(nacm_user_cmp, nacm_user_hash, nacm_user_free, &nacm_ctx->users);
+    CHECK_RC_MSG_RETURN(rc, "Unable to initialize NACM users map.");
+
+    profile_groups[0] = 0;
+
+    /* collect group membership of the users */
+    for (size_t g = 0; g < config->group_cnt; g++) {
+        for (size_t u = 0; u < config->groups[g].user_cnt; u++) {
+            lookup.name = config->groups[g].users[u];
+            user = sr_omap_search(nacm_ctx->users, &lookup);
+            if (NULL == user) {
+                user = calloc(1, sizeof(*user));
+                CHECK_NULL_NOMEM_RETURN(user);
+                user->name = strdup(lookup.name);
+                if (NULL == user->name) {
+                    free(user);
+                    return SR_ERR_NOMEM;
+                }
+                rc = sr_omap_insert(nacm_ctx->users, user);
+                if (SR_ERR_OK != rc) {
+                    nacm_user_free(user);
+                    return rc;
+                }
+            }
+            user->groups |= ((uint64_t) 1) << g;
+        }
+    }
+
+    /* assign the profiles */
+    while (NULL != (user = sr_omap_get_at(nacm_ctx->users, i++))) {
+        for (user->profile = 0; user->profile < profile_cnt; user->profile++) {
+            if (profile_groups[user->profile] == user->groups) {
+                break;
+            }
+        }
+        if (user->profile == profile_cnt) {
+            if (NACM_MAX_PROFILES == profile_cnt) {
+                SR_LOG_ERR("More than %d distinct sets of NACM groups are in use.", NACM_MAX_PROFILES);
+                return SR_ERR_UNSUPPORTED;
+            }
+            profile_groups[profile_cnt++] = user->groups;
+        }
+    }
+
+    *profile_cnt_p = profile_cnt;
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Compiles the data-node rules of the configuration in use.
+ */
+static int
+nacm_compile_rules(nacm_ctx_t *nacm_ctx)
+{
+    const nacm_config_t *config = nacm_ctx->config;
+    const nacm_rule_list_t *rule_list = NULL;
+    nacm_compiled_rule_t *compiled = NULL;
+    uint64_t profile_groups[NACM_MAX_PROFILES] = { 0, };
+    uint64_t list_groups = 0, list_profiles = 0;
+    size_t profile_cnt = 0, rule_cnt = 0;
+    bool all_groups = false;
+    int rc = SR_ERR_OK;
+
+    if (config->group_cnt > NACM_MAX_PROFILES) {
+        SR_LOG_ERR("More than %d NACM groups are configured.", NACM_MAX_PROFILES);
+        return SR_ERR_UNSUPPORTED;
+    }
+
+    rc = nacm_assign_profiles(nacm_ctx, profile_groups, &profile_cnt);
+    CHECK_RC_MSG_RETURN(rc, "Unable to assign NACM access profiles.");
+
+    nacm_ctx->all_profiles = (NACM_MAX_PROFILES == profile_cnt) ? UINT64_MAX : ((((uint64_t) 1) << profile_cnt) - 1);
+
+    for (size_t l = 0; l < config->rule_list_cnt; l++) {
+        rule_cnt += config->rule_lists[l].rule_cnt;
+    }
+    if (0 == rule_cnt) {
+        return SR_ERR_OK;
+    }
+    nacm_ctx->rules = calloc(rule_cnt, sizeof(*nacm_ctx->rules));
+    CHECK_NULL_NOMEM_RETURN(nacm_ctx->rules);
+
+    for (size_t l = 0; l < config->rule_list_cnt; l++) {
+        rule_list = &config->rule_lists[l];
+
+        /* groups the rule list applies to */
+        list_groups = 0;
+        all_groups = false;
+        for (size_t i = 0; i < rule_list->group_cnt; i++) {
+            if (0 == strcmp("*", rule_list->groups[i])) {
+                all_groups = true;
+            }
+            for (size_t g = 0; g < config->group_cnt; g++) {
+                if (0 == strcmp(config->groups[g].name, rule_list->groups[i])) {
+                    list_groups |= ((uint64_t) 1) << g;
+                }
+            }
+        }
+
+        /* profiles with some of the groups */
+        list_profiles = 0;
+        for (size_t p = 0; p < profile_cnt; p++) {
+            if (all_groups || 0 != (profile_groups[p] & list_groups)) {
+                list_profiles |= ((uint64_t) 1) << p;
+            }
+        }
+        if (0 == list_profiles) {
+            continue;
+        }
+
+        for (size_t r = 0; r < rule_list->rule_cnt; r++) {
+            compiled = &nacm_ctx->rules[nacm_ctx->rule_cnt];
+            compiled->rule = &rule_list->rules[r];
+            compiled->profiles = list_profiles;
+            if (NULL != compiled->rule->path) {
+                rc = nacm_split_path(compiled->rule->path, &compiled->path_segments, &compiled->path_modules,
+                        &compiled->path_depth);
+                CHECK_RC_LOG_RETURN(rc, "Unable to parse path of NACM rule '%s'.", compiled->rule->name);
+            }
+            nacm_ctx->rule_cnt++;
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Returns TRUE if the schema node is not instantiated in data trees (its name is not part of data paths).
+ */
+static bool
+nacm_is_schema_only_node(const struct lys_node *node)
+{
+    return 0 != ((LYS_CHOICE | LYS_CASE | LYS_USES | LYS_INPUT | LYS_OUTPUT) & node->nodetype);
+}
+
+/**
+ * @brief Checks whether a compiled rule applies to the schema node with provided data path.
+ * The nodes of the rule path are matched by name and by module (name or prefix of the module).
+ */
+static bool
+nacm_rule_matches(const nacm_compiled_rule_t *rule, const char *module_name, const char **path,
+        const struct lys_module **path_modules, size_t depth)
+{
+    if (0 != strcmp("*", rule->rule->module_name) && 0 != strcmp(module_name, rule->rule->module_name)) {
+        return false;
+    }
+    if (NULL == rule->rule->path) {
+        return true;
+    }
+    /* the rule applies to the node of its path and all its descendants */
+    if (rule->path_depth > depth) {
+        return false;
+    }
+    for (size_t i = 0; i < rule->path_depth; i++) {
+        if (0 != strcmp(rule->path_segments[i], path[i])) {
+            return false;
+        }
+        if (NULL != rule->path_modules[i] && 0 != strcmp(rule->path_modules[i], path_modules[i]->name) &&
+                0 != strcmp(rule->path_modules[i], path_modules[i]->prefix)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int
+nacm_init(nacm_ctx_t **nacm_ctx)
+{
+    nacm_ctx_t *ctx = NULL;
+
+    CHECK_NULL_ARG(nacm_ctx);
+
+    ctx = calloc(1, sizeof(*ctx));
+    CHECK_NULL_NOMEM_RETURN(ctx);
+
+    pthread_rwlock_init(&ctx->lock, NULL);
+
+    *nacm_ctx = ctx;
+    return SR_ERR_OK;
+}
+
+void
+nacm_cleanup(nacm_ctx_t *nacm_ctx)
+{
+    if (NULL != nacm_ctx) {
+        nacm_free_compiled(nacm_ctx);
+        nacm_free_config(nacm_ctx->config);
+        pthread_rwlock_destroy(&nacm_ctx->lock);
+        free(nacm_ctx);
+    }
+}
+
+void
+nacm_free_config(nacm_config_t *config)
+{
+    if (NULL == config) {
+        return;
+    }
+    for (size_t g = 0; g < config->group_cnt; g++) {
+        free(config->groups[g].name);
+        for (size_t u = 0; u < config->groups[g].user_cnt; u++) {
+            free(config->groups[g].users[u]);
+        }
+        free(config->groups[g].users);
+    }
+    free(config->groups);
+    for (size_t l = 0; l < config->rule_list_cnt; l++) {
+        free(config->rule_lists[l].name);
+        for (size_t g = 0; g < config->rule_lists[l].group_cnt; g++) {
+            free(config->rule_lists[l].groups[g]);
+        }
+        free(config->rule_lists[l].groups);
+        for (size_t r = 0; r < config->rule_lists[l].rule_cnt; r++) {
+            free(config->rule_lists[l].rules[r].name);
+            free(config->rule_lists[l].rules[r].module_name);
+            free(config->rule_lists[l].rules[r].path);
+        }
+        free(config->rule_lists[l].rules);
+    }
+    free(config->rule_lists);
+    free(config);
+}
+
+/**
+ * @brief Appends a copy of the string into the array of strings.
+ */
+static int
+nacm_add_string(char ***array, size_t *count, const char *str)
+{
+    char **tmp = NULL;
+
+    tmp = realloc(*array, (*count + 1) * sizeof(**array));
+    CHECK_NULL_NOMEM_RETURN(tmp);
+    *array = tmp;
+    (*array)[*count] = strdup(NULL != str ? str : "");
+    CHECK_NULL_NOMEM_RETURN((*array)[*count]);
+    (*count)++;
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Returns string value of a data leaf.
+ */
+static const char *
+nacm_leaf_value(const struct lyd_node *node)
+{
+    return ((struct lyd_node_leaf_list *) node)->value_str;
+}
+
+/**
+ * @brief Parses access-operations value (either "*" or space separated operation names).
+ */
+static uint8_t
+nacm_parse_access(const char *value)
+{
+    uint8_t access = 0;
+
+    if (NULL == value || NULL != strchr(value, '*')) {
+        return NACM_ACCESS_ALL;
+    }
+    if (NULL != strstr(value, "create")) {
+        access |= NACM_ACCESS_CREATE;
+    }
+    if (NULL != strstr(value, "read")) {
+        access |= NACM_ACCESS_READ;
+    }
+    if (NULL != strstr(value, "update")) {
+        access |= NACM_ACCESS_UPDATE;
+    }
+    if (NULL != strstr(value, "delete")) {
+        access |= NACM_ACCESS_DELETE;
+    }
+    if (NULL != strstr(value, "exec")) {
+        access |= NACM_ACCESS_EXEC;
+    }
+    return access;
+}
+
+/**
+ * @brief Reads a group entry of NACM configuration.
+ */
+static int
+nacm_group_from_tree(const struct lyd_node *group_node, nacm_config_t *config)
+{
+    nacm_group_t *tmp = NULL, *group = NULL;
+    const struct lyd_node *child = NULL;
+    int rc = SR_ERR_OK;
+
+    tmp = realloc(config->groups, (config->group_cnt + 1) * sizeof(*config->groups));
+    CHECK_NULL_NOMEM_RETURN(tmp);
+    config->groups = tmp;
+    group = &config->groups[config->group_cnt++];
+    memset(group, 0, sizeof(*group));
+
+    LY_TREE_FOR(group_node->child, child) {
+        if (0 == strcmp("name", child->schema->name)) {
+            free(group->name);
+            group->name = strdup(nacm_leaf_value(child));
+            CHECK_NULL_NOMEM_RETURN(group->name);
+        } else if (0 == strcmp("user-name", child->schema->name)) {
+            rc = nacm_add_string(&group->users, &group->user_cnt, nacm_leaf_value(child));
+            CHECK_RC_MSG_RETURN(rc, "Unable to add NACM group user.");
+        }
+    }
+    if (NULL == group->name) {
+        group->name = strdup("");
+        CHECK_NULL_NOMEM_RETURN(group->name);
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Reads a rule list entry of NACM configuration. Rules other than data-node rules are omitted.
+ */
+static int
+nacm_rule_list_from_tree(const struct lyd_node *list_node, nacm_config_t *config)
+{
+    nacm_rule_list_t *tmp = NULL, *rule_list = NULL;
+    nacm_rule_t *tmp_rules = NULL, *rule = NULL;
+    const struct lyd_node *child = NULL, *leaf = NULL;
+    bool data_rule = true;
+    int rc = SR_ERR_OK;
+
+    tmp = realloc(config->rule_lists, (config->rule_list_cnt + 1) * sizeof(*config->rule_lists));
+    CHECK_NULL_NOMEM_RETURN(tmp);
+    config->rule_lists = tmp;
+    rule_list = &config->rule_lists[config->rule_list_cnt++];
+    memset(rule_list, 0, sizeof(*rule_list));
+
+    LY_TREE_FOR(list_node->child, child) {
+        if (0 == strcmp("name", child->schema->name)) {
+            free(rule_list->name);
+            rule_list->name = strdup(nacm_leaf_value(child));
+            CHECK_NULL_NOMEM_RETURN(rule_list->name);
+        } else if (0 == strcmp("group", child->schema->name)) {
+            rc = nacm_add_string(&rule_list->groups, &rule_list->group_cnt, nacm_leaf_value(child));
+            CHECK_RC_MSG_RETURN(rc, "Unable to add NACM rule list group.");
+        } else if (0 == strcmp("rule", child->schema->name)) {
+            tmp_rules = realloc(rule_list->rules, (rule_list->rule_cnt + 1) * sizeof(*rule_list->rules));
+            CHECK_NULL_NOMEM_RETURN(tmp_rules);
+            rule_list->rules = tmp_rules;
+            rule = &rule_list->rules[rule_list->rule_cnt++];
+            memset(rule, 0, sizeof(*rule));
+            rule->access = NACM_ACCESS_ALL;
+            rule->action = NACM_ACTION_DENY;
+            data_rule = true;
+
+            LY_TREE_FOR(child->child, leaf) {
+                if (0 == strcmp("name", leaf->schema->name)) {
+                    rule->name = strdup(nacm_leaf_value(leaf));
+                    CHECK_NULL_NOMEM_RETURN(rule->name);
+                } else if (0 == strcmp("module-name", leaf->schema->name)) {
+                    rule->module_name = strdup(nacm_leaf_value(leaf));
+                    CHECK_NULL_NOMEM_RETURN(rule->module_name);
+                } else if (0 == strcmp("path", leaf->schema->name)) {
+                    rule->path = strdup(nacm_leaf_value(leaf));
+                    CHECK_NULL_NOMEM_RETURN(rule->path);
+                } else if (0 == strcmp("rpc-name", leaf->schema->name) ||
+                        0 == strcmp("notification-name", leaf->schema->name)) {
+                    data_rule = false;
+                } else if (0 == strcmp("access-operations", leaf->schema->name)) {
+                    rule->access = nacm_parse_access(nacm_leaf_value(leaf));
+                } else if (0 == strcmp("action", leaf->schema->name)) {
+                    rule->action = (0 == strcmp("permit", nacm_leaf_value(leaf))) ? NACM_ACTION_PERMIT : NACM_ACTION_DENY;
+                }
+            }
+            if (NULL == rule->module_name) {
+                rule->module_name = strdup("*");
+                CHECK_NULL_NOMEM_RETURN(rule->module_name);
+            }
+            if (!data_rule) {
+                /* protocol operation / notification rules do not control data access */
+                rule_list->rule_cnt--;
+                free(rule->name);
+                free(rule->module_name);
+                free(rule->path);
+            }
+        }
+    }
+
+    return SR_ERR_OK;
+}
+
+int
+nacm_config_from_tree(const struct lyd_node *data_tree, nacm_config_t **config_p)
+{
+    nacm_config_t *config = NULL;
+    const struct lyd_node *root = NULL, *child = NULL, *node = NULL;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG(config_p);
+
+    config = calloc(1, sizeof(*config));
+    CHECK_NULL_NOMEM_RETURN(config);
+
+    /* defaults defined by ietf-netconf-acm */
+    config->enabled = true;
+    config->read_default = NACM_ACTION_PERMIT;
+    config->write_default = NACM_ACTION_DENY;
+
+    LY_TREE_FOR(data_tree, root) {
+        if (NULL == root->schema || 0 != strcmp("nacm", root->schema->name)) {
+            continue;
+        }
+        LY_TREE_FOR(root->child, child) {
+            if (0 == strcmp("enable-nacm", child->schema->name)) {
+                config->enabled = (0 == strcmp("true", nacm_leaf_value(child)));
+            } else if (0 == strcmp("read-default", child->schema->name)) {
+                config->read_default = (0 == strcmp("permit", nacm_leaf_value(child))) ? NACM_ACTION_PERMIT : NACM_ACTION_DENY;
+            } else if (0 == strcmp("write-default", child->schema->name)) {
+                config->write_default = (0 == strcmp("permit", nacm_leaf_value(child))) ? NACM_ACTION_PERMIT : NACM_ACTION_DENY;
+            } else if (0 == strcmp("groups", child->schema->name)) {
+                LY_TREE_FOR(child->child, node) {
+                    rc = nacm_group_from_tree(node, config);
+                    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to read NACM group.");
+                }
+            } else if (0 == strcmp("rule-list", child->schema->name)) {
+                rc = nacm_rule_list_from_tree(child, config);
+                CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to read NACM rule list.");
+            }
+        }
+    }
+
+    *config_p = config;
+    return SR_ERR_OK;
+
+cleanup:
+    nacm_free_config(config);
+    return rc;
+}
+
+int
+nacm_reload(nacm_ctx_t *nacm_ctx, nacm_config_t *config)
+{
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(nacm_ctx, config);
+
+    pthread_rwlock_wrlock(&nacm_ctx->lock);
+
+    nacm_free_compiled(nacm_ctx);
+    nacm_free_config(nacm_ctx->config);
+    nacm_ctx->config = config;
+    nacm_ctx->generation++;
+    nacm_ctx->deny_all = false;
+
+    if (config->enabled) {
+        rc = nacm_compile_rules(nacm_ctx);
+        if (SR_ERR_OK != rc) {
+            SR_LOG_ERR_MSG("Unable to compile NACM rules, all access will be denied.");
+            nacm_free_compiled(nacm_ctx);
+            nacm_ctx->deny_all = true;
+        }
+    }
+
+    SR_LOG_INF("NACM rules reloaded: %s, %zu data rules, generation %"PRIu32".",
+            config->enabled ? "enabled" : "disabled", nacm_ctx->rule_cnt, nacm_ctx->generation);
+
+    pthread_rwlock_unlock(&nacm_ctx->lock);
+
+    return rc;
+}
+
+bool
+nacm_is_enabled(nacm_ctx_t *nacm_ctx)
+{
+    bool enabled = false;
+
+    if (NULL != nacm_ctx) {
+        pthread_rwlock_rdlock(&nacm_ctx->lock);
+        enabled = (NULL != nacm_ctx->config && nacm_ctx->config->enabled);
+        pthread_rwlock_unlock(&nacm_ctx->lock);
+    }
+
+    return enabled;
+}
+
+int
+nacm_compile_node(nacm_ctx_t *nacm_ctx, const struct lys_node *node, nacm_node_perms_t *perms)
+{
+    const char *path[NACM_MAX_PATH_DEPTH] = { NULL, };
+    const struct lys_module *path_modules[NACM_MAX_PATH_DEPTH] = { NULL, };
+    const struct lys_node *iter = NULL;
+    const nacm_compiled_rule_t *rule = NULL;
+    /* the operations are decided independently, each by the first matching rule that covers it */
+    const uint8_t ops[] = { NACM_ACCESS_READ, NACM_ACCESS_CREATE, NACM_ACCESS_UPDATE, NACM_ACCESS_DELETE };
+    uint64_t *allowed[] = { &perms->read, &perms->create, &perms->update, &perms->del };
+    uint64_t undecided[sizeof(ops) / sizeof(*ops)] = { 0, }, undecided_any = 0, decided = 0;
+    size_t depth = 0, pos = 0;
+
+    CHECK_NULL_ARG3(nacm_ctx, node, perms);
+
+    memset(perms, 0, sizeof(*perms));
+
+    /* data path of the node */
+    for (iter = node; NULL != iter; iter = lys_parent(iter)) {
+        if (!nacm_is_schema_only_node(iter)) {
+            depth++;
+        }
+    }
+    if (depth > NACM_MAX_PATH_DEPTH) {
+        SR_LOG_WRN("Schema node '%s' is too deep for NACM, access will be denied.", node->name);
+        return SR_ERR_OK;
+    }
+    pos = depth;
+    for (iter = node; NULL != iter; iter = lys_parent(iter)) {
+        if (!nacm_is_schema_only_node(iter)) {
+            path[--pos] = iter->name;
+            path_modules[pos] = lys_node_module(iter);
+        }
+    }
+
+    pthread_rwlock_rdlock(&nacm_ctx->lock);
+
+    perms->generation = nacm_ctx->generation;
+    if (NULL == nacm_ctx->config || nacm_ctx->deny_all) {
+        goto unlock;
+    }
+
+    for (size_t op = 0; op < sizeof(ops) / sizeof(*ops); op++) {
+        undecided[op] = nacm_ctx->all_profiles;
+    }
+    undecided_any = nacm_ctx->all_profiles;
+
+    /* the first matching rule decides */
+    for (size_t i = 0; i < nacm_ctx->rule_cnt && 0 != undecided_any; i++) {
+        rule = &nacm_ctx->rules[i];
+        if (!nacm_rule_matches(rule, lys_node_module(node)->name, path, path_modules, depth)) {
+            continue;
+        }
+        undecided_any = 0;
+        for (size_t op = 0; op < sizeof(ops) / sizeof(*ops); op++) {
+            if (rule->rule->access & ops[op]) {
+                decided = rule->profiles & undecided[op];
+                if (NACM_ACTION_PERMIT == rule->rule->action) {
+                    *allowed[op] |= decided;
+                }
+                undecided[op] &= ~decided;
+            }
+            undecided_any |= undecided[op];
+        }
+    }
+
+    for (size_t op = 0; op < sizeof(ops) / sizeof(*ops); op++) {
+        if (NACM_ACTION_PERMIT == (NACM_ACCESS_READ == ops[op] ? nacm_ctx->config->read_default : nacm_ctx->config->write_default)) {
+            *allowed[op] |= undecided[op];
+        }
+    }
+    perms->read_subtree = perms->read;
+
+unlock:
+    pthread_rwlock_unlock(&nacm_ctx->lock);
+    return SR_ERR_OK;
+}
+
+int
+nacm_get_profile(nacm_ctx_t *nacm_ctx, const ac_ucred_t *user_credentials, nacm_profile_t *profile)
+{
+    nacm_user_t lookup = { 0, }, *user = NULL;
+
+    CHECK_NULL_ARG3(nacm_ctx, user_credentials, profile);
+
+    memset(profile, 0, sizeof(*profile));
+
+    pthread_rwlock_rdlock(&nacm_ctx->lock);
+
+    profile->generation = nacm_ctx->generation;
+
+    if (NULL == nacm_ctx->config || !nacm_ctx->config->enabled ||
+            (0 == user_credentials->r_uid && NULL == user_credentials->e_username)) {
+        /* NACM disabled or recovery session */
+        profile->bypass = true;
+    } else if (!nacm_ctx->deny_all) {
+        lookup.name = (char *) (NULL != user_credentials->e_username ? user_credentials->e_username : user_credentials->r_username);
+        if (NULL != lookup.name) {
+            user = sr_omap_search(nacm_ctx->users, &lookup);
+        }
+        /* users not in any group use profile 0 */
+        profile->mask = ((uint64_t) 1) << (NULL != user ? user->profile : 0);
+    }
+
+    pthread_rwlock_unlock(&nacm_ctx->lock);
+
+    return SR_ERR_OK;
+}
+
+bool
+nacm_check_node(const nacm_node_perms_t *perms, const nacm_profile_t *profile, uint8_t access)
+{
+    if (profile->bypass) {
+        return true;
+    }
+    if (NULL == perms || perms->generation != profile->generation) {
+        /* permissions not compiled from the rules in use */
+        return false;
+    }
+    if (0 == access) {
+        return 0 != (perms->read_subtree & profile->mask);
+    }
+    if ((NACM_ACCESS_READ & access) && 0 == (perms->read & profile->mask)) {
+        return false;
+    }
+    if ((NACM_ACCESS_CREATE & access) && 0 == (perms->create & profile->mask)) {
+        return false;
+    }
+    if ((NACM_ACCESS_UPDATE & access) && 0 == (perms->update & profile->mask)) {
+        return false;
+    }
+    if ((NACM_ACCESS_DELETE & access) && 0 == (perms->del & profile->mask)) {
+        return false;
+    }
+    return true;
+}
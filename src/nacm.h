@@ -0,0 +1,237 @@
+/**
+ * @file nacm.h
+ * @brief NETCONF Access Control Model (NACM) API.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NACM_H_
+#define NACM_H_
+
+/**
+ * @defgroup nacm NETCONF Access Control Model
+ * @{
+ *
+ * @brief Provides node-level authorization of data access according to the rules
+ * of the ietf-netconf-acm module (RFC 6536).
+ *
+ * The rules are not evaluated per request. When the rules change, they are compiled
+ * into per-schema-node permission bitmaps, where each bit stands for one access
+ * profile - a distinct set of NACM groups that some user is a member of. Authorization
+ * of a data node is then a single bitwise test of the bitmap of its schema node.
+ *
+ * Only data-node rules are compiled. Paths of the rules are matched at the schema level by node
+ * names and modules (a prefix of the path may be either the module name or its prefix),
+ * key predicates of the path are ignored (the rule applies to all instances).
+ */
+
+#include <stdint.h>
+#include <libyang/libyang.h>
+
+#include "sr_common.h"
+#include "access_control.h"
+
+/**
+ * @brief Name of the YANG module with NACM configuration.
+ */
+#define NACM_MODULE_NAME "ietf-netconf-acm"
+
+/**
+ * @brief Maximum number of NACM groups / access profiles (bits of a permission bitmap).
+ */
+#define NACM_MAX_PROFILES 64
+
+/**
+ * @brief NACM access operations (bits of access-operations leaf).
+ */
+#define NACM_ACCESS_CREATE  0x01  /**< Create operation. */
+#define NACM_ACCESS_READ    0x02  /**< Read operation. */
+#define NACM_ACCESS_UPDATE  0x04  /**< Update operation. */
+#define NACM_ACCESS_DELETE  0x08  /**< Delete operation. */
+#define NACM_ACCESS_EXEC    0x10  /**< Exec operation. */
+#define NACM_ACCESS_ALL     0x1F  /**< All operations ("*"). */
+#define NACM_ACCESS_WRITE   (NACM_ACCESS_CREATE | NACM_ACCESS_UPDATE | NACM_ACCESS_DELETE)  /**< All write operations. */
+
+/**
+ * @brief Action of a NACM rule.
+ */
+typedef enum nacm_action_e {
+    NACM_ACTION_PERMIT,  /**< Access is permitted. */
+    NACM_ACTION_DENY,    /**< Access is denied. */
+} nacm_action_t;
+
+/**
+ * @brief NACM group.
+ */
+typedef struct nacm_group_s {
+    char *name;          /**< Name of the group. */
+    char **users;        /**< Names of the users in the group. */
+    size_t user_cnt;     /**< Number of the users in the group. */
+} nacm_group_t;
+
+/**
+ * @brief NACM data-node rule.
+ */
+typedef struct nacm_rule_s {
+    char *name;          /**< Name of the rule. */
+    char *module_name;   /**< Name of the module the rule applies to, "*" for all modules. */
+    char *path;          /**< Path of the data node the rule applies to, NULL for all nodes of the module. */
+    uint8_t access;      /**< Access operations the rule applies to (NACM_ACCESS_* bits). */
+    nacm_action_t action;/**< Action of the rule. */
+} nacm_rule_t;
+
+/**
+ * @brief NACM rule list.
+ */
+typedef struct nacm_rule_list_s {
+    char *name;          /**< Name of the rule list. */
+    char **groups;       /**< Names of the groups the rule list applies to, "*" for all groups. */
+    size_t group_cnt;    /**< Number of the groups. */
+    nacm_rule_t *rules;  /**< Rules of the rule list (in order). */
+    size_t rule_cnt;     /**< Number of the rules. */
+} nacm_rule_list_t;
+
+/**
+ * @brief NACM configuration.
+ */
+typedef struct nacm_config_s {
+    bool enabled;                   /**< Enforcement of NACM rules is enabled. */
+    nacm_action_t read_default;     /**< Action applied to read access not matched by any rule. */
+    nacm_action_t write_default;    /**< Action applied to write access not matched by any rule. */
+    nacm_group_t *groups;           /**< NACM groups. */
+    size_t group_cnt;               /**< Number of NACM groups. */
+    nacm_rule_list_t *rule_lists;   /**< NACM rule lists (in order). */
+    size_t rule_list_cnt;           /**< Number of NACM rule lists. */
+} nacm_config_t;
+
+/**
+ * @brief Compiled permissions of a schema node.
+ */
+typedef struct nacm_node_perms_s {
+    uint64_t read;          /**< Profiles allowed to read the node. */
+    uint64_t create;        /**< Profiles allowed to create the node. */
+    uint64_t update;        /**< Profiles allowed to update the node. */
+    uint64_t del;           /**< Profiles allowed to delete the node. */
+    uint64_t read_subtree;  /**< Profiles allowed to read the node and all its descendants. */
+    uint32_t generation;    /**< Generation of the rules the permissions were compiled from. */
+} nacm_node_perms_t;
+
+/**
+ * @brief Access profile of a user.
+ */
+typedef struct nacm_profile_s {
+    bool bypass;            /**< NACM does not apply to the user (NACM disabled or recovery session). */
+    uint64_t mask;          /**< Bit of the user's profile (zero if no access is granted). */
+    uint32_t generation;    /**< Generation of the rules the profile has been assigned by. */
+} nacm_profile_t;
+
+/**
+ * @brief NACM context.
+ */
+typedef struct nacm_ctx_s nacm_ctx_t;
+
+/**
+ * @brief Initializes NACM context. Until the first ::nacm_reload call, NACM is disabled.
+ *
+ * @param[out] nacm_ctx Allocated NACM context.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int nacm_init(nacm_ctx_t **nacm_ctx);
+
+/**
+ * @brief Cleans up NACM context.
+ *
+ * @param[in] nacm_ctx NACM context acquired by ::nacm_init call.
+ */
+void nacm_cleanup(nacm_ctx_t *nacm_ctx);
+
+/**
+ * @brief Reads NACM configuration from a data tree of ietf-netconf-acm module.
+ *
+ * @param[in] data_tree Data tree of ietf-netconf-acm module (NULL means empty configuration).
+ * @param[out] config Allocated NACM configuration (to be freed by ::nacm_free_config).
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int nacm_config_from_tree(const struct lyd_node *data_tree, nacm_config_t **config);
+
+/**
+ * @brief Frees NACM configuration.
+ *
+ * @param[in] config NACM configuration.
+ */
+void nacm_free_config(nacm_config_t *config);
+
+/**
+ * @brief Replaces the rules in use by provided configuration. Permissions of the schema
+ * nodes compiled before this call become outdated and need to be compiled again.
+ *
+ * If the configuration cannot be compiled (e.g. too many distinct access profiles), NACM
+ * denies all access except for the recovery sessions.
+ *
+ * @param[in] nacm_ctx NACM context acquired by ::nacm_init call.
+ * @param[in] config NACM configuration, the context takes its ownership.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int nacm_reload(nacm_ctx_t *nacm_ctx, nacm_config_t *config);
+
+/**
+ * @brief Returns TRUE if NACM rules are enforced.
+ *
+ * @param[in] nacm_ctx NACM context acquired by ::nacm_init call.
+ */
+bool nacm_is_enabled(nacm_ctx_t *nacm_ctx);
+
+/**
+ * @brief Compiles the read, create, update and delete permissions of a schema node from the rules in use.
+ * Read-subtree permissions are set to the read permissions of the node.
+ *
+ * @param[in] nacm_ctx NACM context acquired by ::nacm_init call.
+ * @param[in] node Schema node.
+ * @param[out] perms Compiled permissions.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int nacm_compile_node(nacm_ctx_t *nacm_ctx, const struct lys_node *node, nacm_node_perms_t *perms);
+
+/**
+ * @brief Returns access profile of the user with provided credentials.
+ *
+ * @param[in] nacm_ctx NACM context acquired by ::nacm_init call.
+ * @param[in] user_credentials Credentials of the user.
+ * @param[out] profile Access profile of the user.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int nacm_get_profile(nacm_ctx_t *nacm_ctx, const ac_ucred_t *user_credentials, nacm_profile_t *profile);
+
+/**
+ * @brief Checks whether the profile is allowed to access a node with provided compiled permissions.
+ *
+ * @param[in] perms Compiled permissions of the schema node (NULL if not compiled).
+ * @param[in] profile Access profile of the user.
+ * @param[in] access NACM_ACCESS_* operations (all of them have to be allowed) or 0 for reading
+ * of the whole subtree.
+ *
+ * @return TRUE if the access is allowed.
+ */
+bool nacm_check_node(const nacm_node_perms_t *perms, const nacm_profile_t *profile, uint8_t access);
+
+/**@} nacm */
+
+#endif /* NACM_H_ */
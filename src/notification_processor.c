@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <pthread.h>
+#include <time.h>
 
 #include "sr_common.h"
 #include "rp_internal.h"
@@ -49,10 +50,20 @@ typedef struct np_commit_ctx_s {
     size_t notifications_sent;       /**< Count of sent notifications. */
     size_t notifications_acked;      /**< Count of received acknowledgments. */
     int result;                      /**< Used to store overall result of the commit operation. */
-    sr_list_t *err_subs_xpaths;      /**< Used to store xpaths to subscribers that returned an error. */
+    sr_list_t *err_subs_xpaths;      /**< Used to store xpaths to subscribers that returned an error (interned). */
     sr_list_t *errors;               /**< Used to store errors returned from commit verifiers. */
 } np_commit_ctx_t;
 
+/**
+ * @brief Persistent subscriptions of a module kept in memory.
+ */
+typedef struct np_module_subscriptions_s {
+    char *module_name;                    /**< Name of the module. */
+    np_subscription_t *subscriptions;     /**< Array of the persistent subscriptions of the module. */
+    size_t subscription_cnt;              /**< Number of the subscriptions in the array. */
+    struct timespec persist_mtime;        /**< Modification time of the persist file when the subscriptions were loaded. */
+} np_module_subscriptions_t;
+
 /**
  * @brief Notification Processor context.
  */
@@ -60,9 +71,12 @@ typedef struct np_ctx_s {
     rp_ctx_t *rp_ctx;                     /**< Request Processor context. */
     np_subscription_t **subscriptions;    /**< List of active non-persistent subscriptions. */
     size_t subscription_cnt;              /**< Number of active non-persistent subscriptions. */
-    sr_btree_t *dst_info_btree;           /**< Binary tree used for fast destination info lookup. */
+    sr_omap_t *dst_info_btree;            /**< Ordered map used for fast destination info lookup. */
     sr_llist_t *commits;                  /**< Linked-list of ongoing commits. */
     pthread_rwlock_t lock;                /**< Read-write lock for the context. */
+    sr_omap_t *module_subscriptions;      /**< Registry of persistent subscriptions (np_module_subscriptions_t) per module. */
+    bool shared_persist_data;             /**< TRUE if persist files can be modified by other sysrepo engines (library mode). */
+    pthread_rwlock_t registry_lock;       /**< Read-write lock for the subscription registry. */
 } np_ctx_t;
 
 /**
@@ -92,6 +106,16 @@ np_dst_info_cmp(const void *a, const void *b)
     }
 }
 
+/**
+ * @brief Hashes np_dst_info_t by the destination address.
+ */
+static uint32_t
+np_dst_info_hash(const void *item)
+{
+    assert(item);
+    return sr_str_hash(((np_dst_info_t *) item)->dst_address);
+}
+
 /**
  * @brief Cleans up a notification destination information structure.
  * @note Called automatically when a node from the binary tree is removed
@@ -126,26 +150,26 @@ np_dst_info_insert(np_ctx_t *np_ctx, const char *dst_address, const char *module
 
     CHECK_NULL_ARG3(np_ctx, dst_address, module_name);
 
-    pthread_rwlock_rdlock(&np_ctx->lock);
+    sr_rwlock_rdlock(&np_ctx->lock);
 
     /* find info entry matching with the destination */
     info_lookup.dst_address = dst_address;
-    info = sr_btree_search(np_ctx->dst_info_btree, &info_lookup);
+    info = sr_omap_search(np_ctx->dst_info_btree, &info_lookup);
 
     if (NULL != info) {
         /* info entry found */
         for (size_t i = 0; i < info->subscribed_modules_cnt; i++) {
             if (0 == strcmp(info->subscribed_modules[i], module_name)) {
                 /* module name already exists within the info entry, no update needed */
-                pthread_rwlock_unlock(&np_ctx->lock);
+                sr_rwlock_unlock(&np_ctx->lock);
                 return SR_ERR_OK;
             }
         }
     }
 
     /* info update is required */
-    pthread_rwlock_unlock(&np_ctx->lock);
-    pthread_rwlock_wrlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_wrlock(&np_ctx->lock);
 
     if (NULL == info) {
         /* info entry not found, create new one */
@@ -155,7 +179,7 @@ np_dst_info_insert(np_ctx_t *np_ctx, const char *dst_address, const char *module
         new_info->dst_address = strdup(dst_address);
         CHECK_NULL_NOMEM_GOTO(new_info->dst_address, rc, cleanup);
 
-        rc = sr_btree_insert(np_ctx->dst_info_btree, new_info);
+        rc = sr_omap_insert(np_ctx->dst_info_btree, new_info);
         CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to insert new info entry into btree.");
         inserted = true;
         info = new_info;
@@ -170,20 +194,20 @@ np_dst_info_insert(np_ctx_t *np_ctx, const char *dst_address, const char *module
     CHECK_NULL_NOMEM_GOTO(info->subscribed_modules[info->subscribed_modules_cnt], rc, cleanup);
     info->subscribed_modules_cnt++;
 
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
     return SR_ERR_OK;
 
 cleanup:
     if (NULL != new_info) {
         if (inserted) {
-            sr_btree_delete(np_ctx->dst_info_btree, new_info);
+            sr_omap_delete(np_ctx->dst_info_btree, new_info);
         } else {
             free((char*)new_info->dst_address);
             free((char*)new_info->subscribed_modules);
             free(new_info);
         }
     }
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
     return rc;
 }
 
@@ -200,12 +224,12 @@ np_dst_info_remove(np_ctx_t *np_ctx, const char *dst_address, const char *module
     info_lookup.dst_address = dst_address;
 
     /* find specified module name */
-    info = sr_btree_search(np_ctx->dst_info_btree, &info_lookup);
+    info = sr_omap_search(np_ctx->dst_info_btree, &info_lookup);
     if (NULL != info) {
         if (NULL == module_name || 1 == info->subscribed_modules_cnt) {
             /* if whole destination info entry needs to be removed OR this is the last module,
              * remove whole destination info entry */
-            sr_btree_delete(np_ctx->dst_info_btree, info);
+            sr_omap_delete(np_ctx->dst_info_btree, info);
         } else {
             /* not last module - remove only the matching module name */
             for (size_t i = 0; i < info->subscribed_modules_cnt; i++) {
@@ -270,7 +294,7 @@ np_commit_notif_cnt_increment(np_ctx_t *np_ctx, uint32_t commit_id)
 
     CHECK_NULL_ARG(np_ctx);
 
-    pthread_rwlock_wrlock(&np_ctx->lock);
+    sr_rwlock_wrlock(&np_ctx->lock);
 
     commit = np_commit_ctx_find(np_ctx, commit_id, NULL);
 
@@ -288,7 +312,7 @@ np_commit_notif_cnt_increment(np_ctx_t *np_ctx, uint32_t commit_id)
     commit->notifications_sent++;
 
 unlock:
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     return rc;
 }
@@ -300,6 +324,7 @@ static int
 np_commit_error_add(np_commit_ctx_t *commit_ctx, const char *err_subs_xpath, bool do_not_send_abort, const char *err_msg, const char *err_xpath)
 {
     sr_error_info_t *error = NULL;
+    const char *interned = NULL;
     int rc = SR_ERR_OK;
 
     CHECK_NULL_ARG2(commit_ctx, err_subs_xpath);
@@ -310,7 +335,14 @@ np_commit_error_add(np_commit_ctx_t *commit_ctx, const char *err_subs_xpath, boo
             rc = sr_list_init(&commit_ctx->err_subs_xpaths);
             CHECK_RC_MSG_RETURN(rc, "Unable to init sr_list for errored verifier xpaths.");
         }
-        rc = sr_list_add(commit_ctx->err_subs_xpaths, strdup(err_subs_xpath));
+        /* interned as the xpaths of the subscriptions they are compared with */
+        rc = sr_str_intern(err_subs_xpath, &interned);
+        if (SR_ERR_OK == rc) {
+            rc = sr_list_add(commit_ctx->err_subs_xpaths, (void *) interned);
+            if (SR_ERR_OK != rc) {
+                sr_str_release(interned);
+            }
+        }
     }
     if (SR_ERR_OK == rc && NULL != err_msg) {
         if (NULL == commit_ctx->errors) {
@@ -329,6 +361,335 @@ np_commit_error_add(np_commit_ctx_t *commit_ctx, const char *err_subs_xpath, boo
     return rc;
 }
 
+/**
+ * @brief Compares two module subscription registry entries by module name.
+ */
+static int
+np_module_subscriptions_cmp(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    np_module_subscriptions_t *subs_a = (np_module_subscriptions_t *) a;
+    np_module_subscriptions_t *subs_b = (np_module_subscriptions_t *) b;
+
+    int res = strcmp(subs_a->module_name, subs_b->module_name);
+    if (0 == res) {
+        return 0;
+    } else if (res < 0) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Hashes np_module_subscriptions_t by the name of the module.
+ */
+static uint32_t
+np_module_subscriptions_hash(const void *item)
+{
+    assert(item);
+    return sr_str_hash(((np_module_subscriptions_t *) item)->module_name);
+}
+
+/**
+ * @brief Cleans up a module subscription registry entry.
+ */
+static void
+np_module_subscriptions_cleanup(void *subscriptions_p)
+{
+    np_module_subscriptions_t *subscriptions = NULL;
+
+    if (NULL != subscriptions_p) {
+        subscriptions = (np_module_subscriptions_t *) subscriptions_p;
+        np_free_subscriptions(subscriptions->subscriptions, subscriptions->subscription_cnt);
+        free(subscriptions->module_name);
+        free(subscriptions);
+    }
+}
+
+/**
+ * @brief Duplicates the content of the subscription. The strings of the subscription
+ * are interned, the duplicate shares them with the original.
+ */
+static int
+np_subscription_dup(const np_subscription_t *src, np_subscription_t *dst)
+{
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(src, dst);
+
+    memcpy(dst, src, sizeof(*dst));
+
+    /* the strings are interned, just take another reference */
+    sr_str_intern_ref(dst->dst_address);
+    sr_str_intern_ref(dst->module_name);
+    sr_str_intern_ref(dst->xpath);
+
+    return rc;
+}
+
+/**
+ * @brief Checks whether the subscriptions of a module in the registry are up-to-date.
+ * The registry is authoritative unless the persist files are shared with other sysrepo
+ * engines, in which case the modification time of the persist file is checked.
+ */
+static bool
+np_module_subscriptions_uptodate(np_ctx_t *np_ctx, const np_module_subscriptions_t *subscriptions)
+{
+    if (!np_ctx->shared_persist_data) {
+        return true;
+    }
+#ifdef HAVE_STAT_ST_MTIM
+    struct timespec mtime = { 0, }, now = { 0, };
+
+    if (SR_ERR_OK != pm_get_persist_file_mtime(np_ctx->rp_ctx->pm_ctx, subscriptions->module_name, &mtime)) {
+        return false;
+    }
+    if (mtime.tv_sec != subscriptions->persist_mtime.tv_sec || mtime.tv_nsec != subscriptions->persist_mtime.tv_nsec) {
+        return false;
+    }
+    /* the file may be modified again within the granularity of the timestamp */
+    sr_clock_get_time(CLOCK_REALTIME, &now);
+    return (now.tv_sec != mtime.tv_sec);
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Returns up-to-date registry entry for the module, (re)loads the subscriptions
+ * from the persist file if needed. Registry write lock is expected to be held.
+ */
+static int
+np_module_subscriptions_get(np_ctx_t *np_ctx, const char *module_name, np_module_subscriptions_t **subscriptions_p)
+{
+    np_module_subscriptions_t lookup = { 0, }, *subscriptions = NULL;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(np_ctx, module_name, subscriptions_p);
+
+    lookup.module_name = (char *) module_name;
+    subscriptions = sr_omap_search(np_ctx->module_subscriptions, &lookup);
+    if (NULL != subscriptions && np_module_subscriptions_uptodate(np_ctx, subscriptions)) {
+        *subscriptions_p = subscriptions;
+        return SR_ERR_OK;
+    }
+    if (NULL != subscriptions) {
+        sr_omap_delete(np_ctx->module_subscriptions, subscriptions);
+        subscriptions = NULL;
+    }
+
+    SR_LOG_DBG("Loading persistent subscriptions of module '%s'.", module_name);
+
+    subscriptions = calloc(1, sizeof(*subscriptions));
+    CHECK_NULL_NOMEM_RETURN(subscriptions);
+
+    subscriptions->module_name = strdup(module_name);
+    CHECK_NULL_NOMEM_GOTO(subscriptions->module_name, rc, cleanup);
+
+    /* take the timestamp before loading, so that any later change is detected */
+    rc = pm_get_persist_file_mtime(np_ctx->rp_ctx->pm_ctx, module_name, &subscriptions->persist_mtime);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to get modification time of persist file for '%s'.", module_name);
+
+    rc = pm_get_module_subscriptions(np_ctx->rp_ctx->pm_ctx, module_name, &subscriptions->subscriptions,
+            &subscriptions->subscription_cnt);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to load subscriptions of module '%s'.", module_name);
+
+    rc = sr_omap_insert(np_ctx->module_subscriptions, subscriptions);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to insert module subscriptions into the registry.");
+
+    *subscriptions_p = subscriptions;
+    return SR_ERR_OK;
+
+cleanup:
+    np_module_subscriptions_cleanup(subscriptions);
+    return rc;
+}
+
+/**
+ * @brief Copies the registered persistent subscriptions of specified types, ordered by the types.
+ */
+static int
+np_registry_get_subscriptions(np_ctx_t *np_ctx, const char *module_name, const Sr__SubscriptionType *types,
+        size_t type_cnt, np_subscription_t **subscriptions_p, size_t *subscription_cnt_p)
+{
+    np_module_subscriptions_t lookup = { 0, }, *module_subscriptions = NULL;
+    np_subscription_t *subscriptions = NULL;
+    size_t subscription_cnt = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG5(np_ctx, module_name, types, subscriptions_p, subscription_cnt_p);
+
+    /* fast path - registry entry exists and is up-to-date */
+    sr_rwlock_rdlock(&np_ctx->registry_lock);
+    lookup.module_name = (char *) module_name;
+    module_subscriptions = sr_omap_search(np_ctx->module_subscriptions, &lookup);
+    if (NULL == module_subscriptions || !np_module_subscriptions_uptodate(np_ctx, module_subscriptions)) {
+        /* (re)load the subscriptions from the persist file */
+        sr_rwlock_unlock(&np_ctx->registry_lock);
+        sr_rwlock_wrlock(&np_ctx->registry_lock);
+        rc = np_module_subscriptions_get(np_ctx, module_name, &module_subscriptions);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to get subscriptions of module '%s'.", module_name);
+    }
+
+    if (module_subscriptions->subscription_cnt > 0) {
+        subscriptions = calloc(module_subscriptions->subscription_cnt, sizeof(*subscriptions));
+        CHECK_NULL_NOMEM_GOTO(subscriptions, rc, cleanup);
+    }
+    for (size_t t = 0; t < type_cnt; t++) {
+        for (size_t i = 0; i < module_subscriptions->subscription_cnt; i++) {
+            if (types[t] != module_subscriptions->subscriptions[i].type) {
+                continue;
+            }
+            rc = np_subscription_dup(&module_subscriptions->subscriptions[i], &subscriptions[subscription_cnt]);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to duplicate the subscription.");
+            subscription_cnt++;
+        }
+    }
+
+cleanup:
+    sr_rwlock_unlock(&np_ctx->registry_lock);
+
+    if (SR_ERR_OK != rc) {
+        np_free_subscriptions(subscriptions, subscription_cnt);
+        return rc;
+    }
+    if (0 == subscription_cnt) {
+        free(subscriptions);
+        subscriptions = NULL;
+    }
+
+    *subscriptions_p = subscriptions;
+    *subscription_cnt_p = subscription_cnt;
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Adds a new persistent subscription into the registry (after it has been saved into the persist file).
+ * A subscription already present is replaced, the registry entry of the module may have been loaded
+ * from the persist file after the subscription had been saved.
+ */
+static int
+np_registry_add_subscription(np_ctx_t *np_ctx, const np_subscription_t *subscription, bool exclusive)
+{
+    np_module_subscriptions_t lookup = { 0, }, *module_subscriptions = NULL;
+    np_subscription_t *tmp = NULL;
+    size_t i = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(np_ctx, subscription, subscription->module_name);
+
+    sr_rwlock_wrlock(&np_ctx->registry_lock);
+
+    lookup.module_name = (char *) subscription->module_name;
+    module_subscriptions = sr_omap_search(np_ctx->module_subscriptions, &lookup);
+    if (NULL == module_subscriptions) {
+        /* subscriptions not loaded yet, will be loaded together with the new one */
+        goto cleanup;
+    }
+    if (np_ctx->shared_persist_data) {
+        /* the persist file may contain changes from other engines, reload it on the next access */
+        sr_omap_delete(np_ctx->module_subscriptions, module_subscriptions);
+        goto cleanup;
+    }
+
+    if (exclusive && NULL != subscription->xpath) {
+        /* the same as in persist file - remove the subscriptions of the same type and xpath */
+        while (i < module_subscriptions->subscription_cnt) {
+            tmp = &module_subscriptions->subscriptions[i];
+            /* xpaths of the subscriptions are interned */
+            if (tmp->type == subscription->type && NULL != tmp->xpath && tmp->xpath == subscription->xpath) {
+                np_free_subscription_content(tmp);
+                memmove(tmp, tmp + 1, (module_subscriptions->subscription_cnt - i - 1) * sizeof(*tmp));
+                module_subscriptions->subscription_cnt--;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    /* the entry may have been (re)loaded from the persist file that already contains the subscription,
+     * subscriptions are identified by the type, destination address and id the same as in the persist file */
+    for (i = 0; i < module_subscriptions->subscription_cnt; i++) {
+        tmp = &module_subscriptions->subscriptions[i];
+        /* destination addresses of the subscriptions are interned */
+        if (tmp->type == subscription->type && tmp->dst_id == subscription->dst_id &&
+                tmp->dst_address == subscription->dst_address) {
+            SR_LOG_DBG("Subscription of module '%s' is already in the registry, updating it.", subscription->module_name);
+            np_free_subscription_content(tmp);
+            rc = np_subscription_dup(subscription, tmp);
+            if (SR_ERR_OK != rc) {
+                /* the content has been released, do not free it again with the entry */
+                memmove(tmp, tmp + 1, (module_subscriptions->subscription_cnt - i - 1) * sizeof(*tmp));
+                module_subscriptions->subscription_cnt--;
+            }
+            goto cleanup;
+        }
+    }
+
+    tmp = realloc(module_subscriptions->subscriptions,
+            (module_subscriptions->subscription_cnt + 1) * sizeof(*module_subscriptions->subscriptions));
+    CHECK_NULL_NOMEM_GOTO(tmp, rc, cleanup);
+    module_subscriptions->subscriptions = tmp;
+
+    rc = np_subscription_dup(subscription, &module_subscriptions->subscriptions[module_subscriptions->subscription_cnt]);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to duplicate the subscription.");
+    module_subscriptions->subscription_cnt++;
+
+cleanup:
+    if (SR_ERR_OK != rc && NULL != module_subscriptions) {
+        /* drop the entry, it will be reloaded from the persist file */
+        sr_omap_delete(np_ctx->module_subscriptions, module_subscriptions);
+    }
+    sr_rwlock_unlock(&np_ctx->registry_lock);
+    return rc;
+}
+
+/**
+ * @brief Removes persistent subscriptions of the destination from the registry. If the subscription
+ * is not specified, all subscriptions of the destination in the module are removed.
+ */
+static void
+np_registry_remove_subscriptions(np_ctx_t *np_ctx, const char *module_name, const char *dst_address,
+        const np_subscription_t *subscription)
+{
+    np_module_subscriptions_t lookup = { 0, }, *module_subscriptions = NULL;
+    np_subscription_t *tmp = NULL;
+    size_t i = 0;
+
+    if (NULL == np_ctx || NULL == module_name || NULL == dst_address) {
+        return;
+    }
+
+    sr_rwlock_wrlock(&np_ctx->registry_lock);
+
+    lookup.module_name = (char *) module_name;
+    module_subscriptions = sr_omap_search(np_ctx->module_subscriptions, &lookup);
+    if (NULL == module_subscriptions) {
+        goto unlock;
+    }
+    if (np_ctx->shared_persist_data) {
+        sr_omap_delete(np_ctx->module_subscriptions, module_subscriptions);
+        goto unlock;
+    }
+
+    while (i < module_subscriptions->subscription_cnt) {
+        tmp = &module_subscriptions->subscriptions[i];
+        if (0 == strcmp(tmp->dst_address, dst_address) &&
+                (NULL == subscription || (tmp->type == subscription->type && tmp->dst_id == subscription->dst_id))) {
+            np_free_subscription_content(tmp);
+            memmove(tmp, tmp + 1, (module_subscriptions->subscription_cnt - i - 1) * sizeof(*tmp));
+            module_subscriptions->subscription_cnt--;
+        } else {
+            i++;
+        }
+    }
+
+unlock:
+    sr_rwlock_unlock(&np_ctx->registry_lock);
+}
+
 int
 np_init(rp_ctx_t *rp_ctx, np_ctx_t **np_ctx_p)
 {
@@ -344,7 +705,7 @@ np_init(rp_ctx_t *rp_ctx, np_ctx_t **np_ctx_p)
     ctx->rp_ctx = rp_ctx;
 
     /* init binary tree for fast destination info lookup */
-    rc = sr_btree_init(np_dst_info_cmp, np_dst_info_cleanup, &ctx->dst_info_btree);
+    rc = sr_omap_init(np_dst_info_cmp, np_dst_info_hash, np_dst_info_cleanup, &ctx->dst_info_btree);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate binary tree for destination info lookup.");
 
     /* init linked-list for commit contexts */
@@ -354,6 +715,19 @@ np_init(rp_ctx_t *rp_ctx, np_ctx_t **np_ctx_p)
     /* initialize subscriptions lock */
     ret = pthread_rwlock_init(&ctx->lock, NULL);
     CHECK_ZERO_MSG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "Subscriptions lock initialization failed.");
+    sr_lockstat_register(&ctx->lock, "np_lock");
+
+    /* init the registry of persistent subscriptions */
+    rc = sr_omap_init(np_module_subscriptions_cmp, np_module_subscriptions_hash, np_module_subscriptions_cleanup,
+            &ctx->module_subscriptions);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Cannot allocate binary tree for the subscription registry.");
+
+    ret = pthread_rwlock_init(&ctx->registry_lock, NULL);
+    CHECK_ZERO_MSG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "Subscription registry lock initialization failed.");
+    sr_lockstat_register(&ctx->registry_lock, "np_registry_lock");
+
+    /* only the daemon is the exclusive owner of the persist files */
+    ctx->shared_persist_data = (NULL == rp_ctx->cm_ctx || CM_MODE_DAEMON != cm_get_connection_mode(rp_ctx->cm_ctx));
 
     SR_LOG_DBG_MSG("Notification Processor initialized successfully.");
 
@@ -386,8 +760,12 @@ np_cleanup(np_ctx_t *np_ctx)
         }
         sr_llist_cleanup(np_ctx->commits);
 
-        sr_btree_cleanup(np_ctx->dst_info_btree);
+        sr_omap_cleanup(np_ctx->dst_info_btree);
+        sr_lockstat_unregister(&np_ctx->lock);
         pthread_rwlock_destroy(&np_ctx->lock);
+        sr_omap_cleanup(np_ctx->module_subscriptions);
+        sr_lockstat_unregister(&np_ctx->registry_lock);
+        pthread_rwlock_destroy(&np_ctx->registry_lock);
         free(np_ctx);
     }
 }
@@ -411,21 +789,22 @@ np_notification_subscribe(np_ctx_t *np_ctx, const rp_session_t *rp_session, Sr__
 
     subscription->type = type;
     if (NULL != module_name) {
-        subscription->module_name = strdup(module_name);
-        CHECK_NULL_NOMEM_GOTO(subscription->module_name, rc, cleanup);
+        rc = sr_str_intern(module_name, &subscription->module_name);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern module name.");
     }
     if (NULL != xpath) {
-        subscription->xpath = strdup(xpath);
-        CHECK_NULL_NOMEM_GOTO(subscription->xpath, rc, cleanup);
+        rc = sr_str_intern(xpath, &subscription->xpath);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern xpath.");
     }
 
     subscription->dst_id = dst_id;
-    subscription->dst_address = strdup(dst_address);
-    CHECK_NULL_NOMEM_GOTO(subscription->dst_address, rc, cleanup);
+    rc = sr_str_intern(dst_address, &subscription->dst_address);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern destination address.");
 
     subscription->notif_event = notif_event;
     subscription->priority = priority;
     subscription->enable_running = (opts & NP_SUBSCR_ENABLE_RUNNING);
+    subscription->push_changes = (opts & NP_SUBSCR_PUSH_CHANGES);
     subscription->api_variant = api_variant;
 
     /* save the new subscription */
@@ -457,10 +836,18 @@ np_notification_subscribe(np_ctx_t *np_ctx, const rp_session_t *rp_session, Sr__
                 (opts & NP_SUBSCR_EXCLUSIVE));
         CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to save the subscription into persistent data file.");
 
+        /* update the in-memory registry */
+        rc = np_registry_add_subscription(np_ctx, subscription, (opts & NP_SUBSCR_EXCLUSIVE));
+        if (SR_ERR_OK != rc) {
+            /* the subscription is persisted, the registry will be reloaded */
+            SR_LOG_WRN("Unable to add the subscription into the registry of module '%s'.", module_name);
+            rc = SR_ERR_OK;
+        }
+
         goto cleanup; /* subscription not needed anymore */
     } else {
         /* add the subscription to in-memory subscription list */
-        pthread_rwlock_wrlock(&np_ctx->lock);
+        sr_rwlock_wrlock(&np_ctx->lock);
         subscriptions_tmp = realloc(np_ctx->subscriptions, (np_ctx->subscription_cnt + 1) * sizeof(*subscriptions_tmp));
         CHECK_NULL_NOMEM_ERROR(subscriptions_tmp, rc);
 
@@ -468,9 +855,9 @@ np_notification_subscribe(np_ctx_t *np_ctx, const rp_session_t *rp_session, Sr__
             np_ctx->subscriptions = subscriptions_tmp;
             np_ctx->subscriptions[np_ctx->subscription_cnt] = subscription;
             np_ctx->subscription_cnt += 1;
-            pthread_rwlock_unlock(&np_ctx->lock);
+            sr_rwlock_unlock(&np_ctx->lock);
         } else {
-            pthread_rwlock_unlock(&np_ctx->lock);
+            sr_rwlock_unlock(&np_ctx->lock);
             goto cleanup;
         }
     }
@@ -480,9 +867,9 @@ np_notification_subscribe(np_ctx_t *np_ctx, const rp_session_t *rp_session, Sr__
 cleanup:
     if (NULL != subscription) {
         if (SR_ERR_OK != rc) {
-            pthread_rwlock_wrlock(&np_ctx->lock);
+            sr_rwlock_wrlock(&np_ctx->lock);
             np_dst_info_remove(np_ctx, dst_address, module_name);
-            pthread_rwlock_unlock(&np_ctx->lock);
+            sr_rwlock_unlock(&np_ctx->lock);
         }
         np_free_subscription(subscription);
     }
@@ -515,9 +902,10 @@ np_notification_unsubscribe(np_ctx_t *np_ctx,  const rp_session_t *rp_session, S
         rc = pm_remove_subscription(np_ctx->rp_ctx->pm_ctx, rp_session->user_credentials, module_name,
                 &subscription_lookup, &disable_running);
         if (SR_ERR_OK == rc) {
-            pthread_rwlock_wrlock(&np_ctx->lock);
+            np_registry_remove_subscriptions(np_ctx, module_name, dst_address, &subscription_lookup);
+            sr_rwlock_wrlock(&np_ctx->lock);
             rc = np_dst_info_remove(np_ctx, dst_address, module_name);
-            pthread_rwlock_unlock(&np_ctx->lock);
+            sr_rwlock_unlock(&np_ctx->lock);
             if (disable_running) {
                 SR_LOG_DBG("Disabling running datastore for module '%s'.", module_name);
                 rc = dm_disable_module_running(np_ctx->rp_ctx->dm_ctx, rp_session->dm_session, module_name);
@@ -541,13 +929,13 @@ np_notification_unsubscribe(np_ctx_t *np_ctx,  const rp_session_t *rp_session, S
         }
 
         /* remove the subscription from array */
-        pthread_rwlock_wrlock(&np_ctx->lock);
+        sr_rwlock_wrlock(&np_ctx->lock);
         if (np_ctx->subscription_cnt > (i + 1)) {
             memmove(np_ctx->subscriptions + i, np_ctx->subscriptions + i + 1,
                     (np_ctx->subscription_cnt - i - 1) * sizeof(*np_ctx->subscriptions));
         }
         np_ctx->subscription_cnt -= 1;
-        pthread_rwlock_unlock(&np_ctx->lock);
+        sr_rwlock_unlock(&np_ctx->lock);
 
         /* release the subscription */
         np_free_subscription(subscription);
@@ -565,10 +953,10 @@ np_unsubscribe_destination(np_ctx_t *np_ctx, const char *dst_address)
 
     CHECK_NULL_ARG2(np_ctx, dst_address);
 
-    pthread_rwlock_wrlock(&np_ctx->lock);
+    sr_rwlock_wrlock(&np_ctx->lock);
 
     info_lookup.dst_address = dst_address;
-    info = sr_btree_search(np_ctx->dst_info_btree, &info_lookup);
+    info = sr_omap_search(np_ctx->dst_info_btree, &info_lookup);
     if (NULL != info) {
         for (size_t i = 0; i < info->subscribed_modules_cnt; i++) {
             SR_LOG_DBG("Removing subscriptions for destination '%s' from '%s'.", dst_address,
@@ -577,6 +965,7 @@ np_unsubscribe_destination(np_ctx_t *np_ctx, const char *dst_address)
                     info->subscribed_modules[i], dst_address, &disable_running);
             CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to remove subscriptions for destination '%s' from '%s'.", dst_address,
                     info->subscribed_modules[i]);
+            np_registry_remove_subscriptions(np_ctx, info->subscribed_modules[i], dst_address, NULL);
             if (disable_running) {
                 SR_LOG_DBG("Disabling running datastore fo module '%s'.", info->subscribed_modules[i]);
                 rc = dm_disable_module_running(np_ctx->rp_ctx->dm_ctx, NULL, info->subscribed_modules[i]);
@@ -586,7 +975,7 @@ np_unsubscribe_destination(np_ctx_t *np_ctx, const char *dst_address)
         np_dst_info_remove(np_ctx, dst_address, NULL);
     }
 cleanup:
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     return rc;
 }
@@ -603,7 +992,7 @@ np_module_install_notify(np_ctx_t *np_ctx, const char *module_name, const char *
     SR_LOG_DBG("Sending module-install notifications, module_name='%s', revision='%s', state=%s.",
             module_name, revision, sr_module_state_sr_to_str(state));
 
-    pthread_rwlock_rdlock(&np_ctx->lock);
+    sr_rwlock_rdlock(&np_ctx->lock);
 
     for (size_t i = 0; i < np_ctx->subscription_cnt; i++) {
         if (SR__SUBSCRIPTION_TYPE__MODULE_INSTALL_SUBS == np_ctx->subscriptions[i]->type) {
@@ -632,7 +1021,7 @@ np_module_install_notify(np_ctx_t *np_ctx, const char *module_name, const char *
         }
     }
 
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     return rc;
 }
@@ -648,7 +1037,7 @@ np_feature_enable_notify(np_ctx_t *np_ctx, const char *module_name, const char *
     SR_LOG_DBG("Sending feature-enable notifications, module_name='%s', feature_name='%s', enabled=%d.",
                 module_name, feature_name, enabled);
 
-    pthread_rwlock_rdlock(&np_ctx->lock);
+    sr_rwlock_rdlock(&np_ctx->lock);
 
     for (size_t i = 0; i < np_ctx->subscription_cnt; i++) {
         if (SR__SUBSCRIPTION_TYPE__FEATURE_ENABLE_SUBS == np_ctx->subscriptions[i]->type) {
@@ -677,7 +1066,7 @@ np_feature_enable_notify(np_ctx_t *np_ctx, const char *module_name, const char *
         }
     }
 
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     return rc;
 }
@@ -708,6 +1097,15 @@ np_hello_notify(np_ctx_t *np_ctx, const char *module_name, const char *dst_addre
     return rc;
 }
 
+int
+np_get_subscriptions(np_ctx_t *np_ctx, const char *module_name, Sr__SubscriptionType type,
+        np_subscription_t **subscriptions_p, size_t *subscription_cnt_p)
+{
+    CHECK_NULL_ARG4(np_ctx, module_name, subscriptions_p, subscription_cnt_p);
+
+    return np_registry_get_subscriptions(np_ctx, module_name, &type, 1, subscriptions_p, subscription_cnt_p);
+}
+
 int
 np_get_module_change_subscriptions(np_ctx_t *np_ctx, const char *module_name,
         np_subscription_t ***subscriptions_arr_p, size_t *subscriptions_cnt_p)
@@ -719,12 +1117,12 @@ np_get_module_change_subscriptions(np_ctx_t *np_ctx, const char *module_name,
     CHECK_NULL_ARG4(np_ctx, module_name, subscriptions_arr_p, subscriptions_cnt_p);
 
     /* get subtree-change subscriptions */
-    rc = pm_get_subscriptions(np_ctx->rp_ctx->pm_ctx, module_name, SR__SUBSCRIPTION_TYPE__SUBTREE_CHANGE_SUBS,
+    rc = np_get_subscriptions(np_ctx, module_name, SR__SUBSCRIPTION_TYPE__SUBTREE_CHANGE_SUBS,
             &subscriptions_1, &subscription_cnt_1);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to retrieve subtree-change subscriptions");
 
     /* get module-change subscriptions */
-    rc = pm_get_subscriptions(np_ctx->rp_ctx->pm_ctx, module_name, SR__SUBSCRIPTION_TYPE__MODULE_CHANGE_SUBS,
+    rc = np_get_subscriptions(np_ctx, module_name, SR__SUBSCRIPTION_TYPE__MODULE_CHANGE_SUBS,
             &subscriptions_2, &subscription_cnt_2);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to retrieve module-change subscriptions");
 
@@ -780,7 +1178,7 @@ np_get_data_provider_subscriptions(np_ctx_t *np_ctx, const char *module_name,
     CHECK_NULL_ARG4(np_ctx, module_name, subscriptions_arr_p, subscriptions_cnt_p);
 
     /* get data provides subscriptions */
-    rc = pm_get_subscriptions(np_ctx->rp_ctx->pm_ctx, module_name, SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
+    rc = np_get_subscriptions(np_ctx, module_name, SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
             &subscriptions, &subscription_cnt);
     CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to retrieve subtree-change subscriptions");
 
@@ -814,8 +1212,54 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Attaches the changes matching the subscription to the change notification if their
+ * serialized size does not exceed SR_PUSHED_CHANGES_MAX_SIZE.
+ */
+static int
+np_notification_attach_changes(np_subscription_t *subscription, sr_list_t *changes, Sr__Notification *notification)
+{
+    Sr__ChangeSet *change_set = NULL;
+    size_t packed_size = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(subscription, changes, notification);
+
+    change_set = calloc(1, sizeof(*change_set));
+    CHECK_NULL_NOMEM_RETURN(change_set);
+    sr__change_set__init(change_set);
+
+    if (SR__SUBSCRIPTION_TYPE__SUBTREE_CHANGE_SUBS == subscription->type) {
+        change_set->xpath = strdup(subscription->xpath);
+        CHECK_NULL_NOMEM_GOTO(change_set->xpath, rc, cleanup);
+    } else {
+        size_t len = strlen(subscription->module_name) + 4; /* "/" + ":*" + '\0' */
+        change_set->xpath = calloc(len, sizeof(*change_set->xpath));
+        CHECK_NULL_NOMEM_GOTO(change_set->xpath, rc, cleanup);
+        snprintf(change_set->xpath, len, "/%s:*", subscription->module_name);
+    }
+
+    rc = sr_changes_sr_to_gpb(changes, NULL, &change_set->changes, &change_set->n_changes);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Copying changes to GPB failed.");
+
+    packed_size = sr__change_set__get_packed_size(change_set);
+    if (packed_size > SR_PUSHED_CHANGES_MAX_SIZE) {
+        SR_LOG_DBG("Changes of '%s' too large to be pushed (%zu bytes), the subscriber will request them.",
+                change_set->xpath, packed_size);
+        goto cleanup;
+    }
+
+    notification->changes = change_set;
+    return SR_ERR_OK;
+
+cleanup:
+    sr__change_set__free_unpacked(change_set, NULL);
+    return rc;
+}
+
 int
-np_subscription_notify(np_ctx_t *np_ctx, np_subscription_t *subscription, sr_notif_event_t event, uint32_t commit_id)
+np_subscription_notify(np_ctx_t *np_ctx, np_subscription_t *subscription, sr_notif_event_t event, uint32_t commit_id,
+        sr_list_t *changes)
 {
     Sr__Msg *notif = NULL;
     int rc = SR_ERR_OK;
@@ -841,6 +1285,12 @@ np_subscription_notify(np_ctx_t *np_ctx, np_subscription_t *subscription, sr_not
             CHECK_NULL_NOMEM_ERROR(notif->notification->subtree_change_notif->xpath, rc);
         }
     }
+    if (SR_ERR_OK == rc && subscription->push_changes && NULL != changes) {
+        /* the subscriber can always fall back to requesting the changes, do not fail the notification */
+        if (SR_ERR_OK != np_notification_attach_changes(subscription, changes, notif->notification)) {
+            SR_LOG_WRN("Unable to push the changes to '%s' @ %"PRIu32".", subscription->dst_address, subscription->dst_id);
+        }
+    }
 
     if (SR_ERR_OK == rc) {
         /* save notification destination info */
@@ -850,6 +1300,7 @@ np_subscription_notify(np_ctx_t *np_ctx, np_subscription_t *subscription, sr_not
         /* send the message */
         rc = cm_msg_send(np_ctx->rp_ctx->cm_ctx, notif);
         if (SR_ERR_OK == rc) {
+            rp_stats_notification(np_ctx->rp_ctx, RP_STATS_NOTIF_CHANGE);
             rc = np_commit_notif_cnt_increment(np_ctx, commit_id);
         }
     } else {
@@ -893,6 +1344,9 @@ np_data_provider_request(np_ctx_t *np_ctx, np_subscription_t *subscription, rp_s
     if (SR_ERR_OK == rc) {
         /* send the message */
         rc = cm_msg_send(np_ctx->rp_ctx->cm_ctx, req);
+        if (SR_ERR_OK == rc) {
+            rp_stats_notification(np_ctx->rp_ctx, RP_STATS_NOTIF_DATA_REQUEST);
+        }
     } else {
         sr_msg_free(req);
     }
@@ -929,7 +1383,7 @@ np_commit_notifications_sent(np_ctx_t *np_ctx, uint32_t commit_id, bool commit_f
         }
     }
 
-    pthread_rwlock_wrlock(&np_ctx->lock);
+    sr_rwlock_wrlock(&np_ctx->lock);
 
     commit = np_commit_ctx_find(np_ctx, commit_id, &commit_node);
     if (NULL != commit) {
@@ -959,7 +1413,7 @@ np_commit_notifications_sent(np_ctx_t *np_ctx, uint32_t commit_id, bool commit_f
         }
     }
 
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     return rc;
 }
@@ -975,7 +1429,7 @@ np_commit_notification_ack(np_ctx_t *np_ctx, uint32_t commit_id, char *subs_xpat
 
     CHECK_NULL_ARG(np_ctx);
 
-    pthread_rwlock_wrlock(&np_ctx->lock);
+    sr_rwlock_wrlock(&np_ctx->lock);
 
     commit = np_commit_ctx_find(np_ctx, commit_id, &commit_node);
 
@@ -1000,7 +1454,7 @@ np_commit_notification_ack(np_ctx_t *np_ctx, uint32_t commit_id, char *subs_xpat
         SR_LOG_WRN("No NP commit context for commit ID %"PRIu32".", commit_id);
     }
 
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     if (all_acks_received) {
         /* all notification acks already received - signal DM and possibly release the commit */
@@ -1021,7 +1475,7 @@ np_commit_notifications_complete(np_ctx_t *np_ctx, uint32_t commit_id, bool time
 
     CHECK_NULL_ARG(np_ctx);
 
-    pthread_rwlock_wrlock(&np_ctx->lock);
+    sr_rwlock_wrlock(&np_ctx->lock);
 
     commit = np_commit_ctx_find(np_ctx, commit_id, &commit_node);
     if (NULL != commit) {
@@ -1044,7 +1498,7 @@ np_commit_notifications_complete(np_ctx_t *np_ctx, uint32_t commit_id, bool time
         }
     }
 
-    pthread_rwlock_unlock(&np_ctx->lock);
+    sr_rwlock_unlock(&np_ctx->lock);
 
     if (found) {
         SR_LOG_DBG("Commit id=%"PRIu32" notifications complete.", commit_id);
@@ -1074,9 +1528,9 @@ void
 np_free_subscription_content(np_subscription_t *subscription)
 {
     if (NULL != subscription) {
-        free((void*)subscription->dst_address);
-        free((void*)subscription->module_name);
-        free((void*)subscription->xpath);
+        sr_str_release(subscription->dst_address);
+        sr_str_release(subscription->module_name);
+        sr_str_release(subscription->xpath);
     }
 }
 
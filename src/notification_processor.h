@@ -47,12 +47,13 @@ typedef struct np_ctx_s np_ctx_t;
 typedef struct np_subscription_s {
     Sr__SubscriptionType type;         /**< Type of the subscription that this subscription subscribes to. */
     Sr__NotificationEvent notif_event; /**< Notification event which the notification subscriber is interested in. */
-    const char *dst_address;           /**< Destination address where the notification should be delivered. */
+    const char *dst_address;           /**< Destination address where the notification should be delivered (interned). */
     uint32_t dst_id;                   /**< Destination ID of the subscription (used locally, in the client library). */
-    const char *module_name;           /**< Name of the module where the subscription is active. */
-    const char *xpath;                 /**< XPath to the subtree where the subscription is active (if applicable). */
+    const char *module_name;           /**< Name of the module where the subscription is active (interned). */
+    const char *xpath;                 /**< XPath to the subtree where the subscription is active (if applicable, interned). */
     uint32_t priority;                 /**< Priority of the subscription by delivering notifications (0 is the lowest priority). */
     bool enable_running;               /**< TRUE if the subscription enables specified subtree in the running datastore. */
+    bool push_changes;                 /**< TRUE if the changes should be delivered within the notification. */
     sr_api_variant_t api_variant;      /**< API variant -- values vs. trees (relevant for the callback type only). */
 } np_subscription_t;
 
@@ -81,6 +82,7 @@ typedef enum np_subscr_flag_e {
     NP_SUBSCR_ENABLE_RUNNING = 1,
     NP_SUBSCR_EXCLUSIVE = 2,
     NP_SUBSCR_EV_EVENT = 4,
+    NP_SUBSCR_PUSH_CHANGES = 8,
 } np_subscr_flag_t;
 
 /**
@@ -173,6 +175,22 @@ int np_feature_enable_notify(np_ctx_t *np_ctx, const char *module_name, const ch
  */
 int np_hello_notify(np_ctx_t *np_ctx, const char *module_name, const char *dst_address, uint32_t dst_id);
 
+/**
+ * @brief Gets all persistent subscriptions of given type in specified module. The subscriptions
+ * are served from the in-memory registry, the persist file is read only on the first access
+ * (or after it has been modified by another sysrepo engine in library mode).
+ *
+ * @param[in] np_ctx Notification Processor context acquired by ::np_init call.
+ * @param[in] module_name Name of the module where the subscription is active.
+ * @param[in] type Type of the subscriptions.
+ * @param[out] subscriptions Array of the subscriptions (to be freed by ::np_free_subscriptions).
+ * @param[out] subscription_cnt Count of the subscriptions in the array.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int np_get_subscriptions(np_ctx_t *np_ctx, const char *module_name, Sr__SubscriptionType type,
+        np_subscription_t **subscriptions, size_t *subscription_cnt);
+
 /**
  * @brief Gets all subscriptions that subscibe for changes in specified module
  * or in a subtree within the specified module.
@@ -208,10 +226,13 @@ int np_get_data_provider_subscriptions(np_ctx_t *np_ctx, const char *module_name
  * @param[in] subscription Subscription context acquired by ::np_get_module_change_subscriptions call.
  * @param[in] type of event to be sent to subscription
  * @param[in] commit_id ID of the commit to be used for starting a new notification session from client library.
+ * @param[in] changes Changes matching the subscription to be pushed within the notification. Used only if the subscriber
+ * requested pushing of the changes, NULL if not available.
  *
  * @return Error code (SR_ERR_OK on success).
  */
-int np_subscription_notify(np_ctx_t *np_ctx, np_subscription_t *subscription, sr_notif_event_t event, uint32_t commit_id);
+int np_subscription_notify(np_ctx_t *np_ctx, np_subscription_t *subscription, sr_notif_event_t event, uint32_t commit_id,
+        sr_list_t *changes);
 
 /**
  * @brief Request operational data from a data provider subscription.
@@ -25,6 +25,7 @@
 #include <inttypes.h>
 #include <pthread.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <libyang/libyang.h>
 
 #include "sr_common.h"
@@ -34,6 +35,8 @@
 
 #define PM_SCHEMA_FILE "sysrepo-persistent-data.yang"  /**< Schema of module's persistent data. */
 
+#define PM_FLUSH_DELAY 100  /**< Delay (in milliseconds) used to coalesce modifications before they are written to persist files. */
+
 #define PM_XPATH_MODULE                      "/sysrepo-persistent-data:module[name='%s']"
 
 #define PM_XPATH_FEATURES                     PM_XPATH_MODULE "/enabled-features/feature-name"
@@ -47,6 +50,7 @@
 #define PM_XPATH_SUBSCRIPTION_PRIORITY        PM_XPATH_SUBSCRIPTION      "/priority"
 #define PM_XPATH_SUBSCRIPTION_ENABLE_RUNNING  PM_XPATH_SUBSCRIPTION      "/enable-running"
 #define PM_XPATH_SUBSCRIPTION_API_VARIANT     PM_XPATH_SUBSCRIPTION      "/api-variant"
+#define PM_XPATH_SUBSCRIPTION_PUSH_CHANGES    PM_XPATH_SUBSCRIPTION      "/push-changes"
 
 #define PM_XPATH_SUBSCRIPTIONS_BY_TYPE        PM_XPATH_SUBSCRIPTION_LIST "[type='%s']"
 #define PM_XPATH_SUBSCRIPTIONS_BY_TYPE_XPATH  PM_XPATH_SUBSCRIPTION_LIST "[type='%s'][xpath='%s']"
@@ -54,6 +58,24 @@
 #define PM_XPATH_SUBSCRIPTIONS_BY_DST_ID      PM_XPATH_SUBSCRIPTION_LIST "[destination-address='%s'][destination-id='%"PRIu32"']"
 #define PM_XPATH_SUBSCRIPTIONS_WITH_E_RUNNING PM_XPATH_SUBSCRIPTION_LIST "[enable-running=true()]"
 
+/**
+ * @brief Persistent data of a module cached in write-behind mode.
+ */
+typedef struct pm_module_data_s {
+    char *module_name;                /**< Name of the module. */
+    struct lyd_node *data_tree;       /**< Persist data tree of the module (NULL if empty). */
+    bool dirty;                       /**< TRUE if the data tree contains modifications not written into the persist file. */
+} pm_module_data_t;
+
+/**
+ * @brief Snapshot of cached persistent data of a module taken to be written into its persist file.
+ */
+typedef struct pm_flush_entry_s {
+    char *module_name;                /**< Name of the module. */
+    struct lyd_node *data_tree;       /**< Copy of the persist data tree of the module (NULL if empty). */
+    int rc;                           /**< Result of the write. */
+} pm_flush_entry_t;
+
 /**
  * @brief Persistence Manager context.
  */
@@ -63,6 +85,16 @@ typedef struct pm_ctx_s {
     const struct lys_module *schema;  /**< Schema tree of sysrepo-persistent-data YANG. */
     const char *data_search_dir;      /**< Directory containing the data files. */
     sr_locking_set_t *lock_ctx;        /**< Context for locking persist data files. */
+
+    bool write_behind;                /**< TRUE if the data trees are cached and written asynchronously (daemon mode). */
+    sr_omap_t *module_data;           /**< Cached persistent data of the modules (pm_module_data_t). */
+    size_t dirty_cnt;                 /**< Number of modules with modifications not written into persist files. */
+    pthread_mutex_t data_lock;        /**< Mutex protecting the cached data. */
+    pthread_mutex_t flush_lock;       /**< Mutex serializing the writes of the cached data into persist files. */
+    pthread_cond_t flush_cv;          /**< Condition variable used to wake up the flush thread. */
+    pthread_t flush_thread;           /**< Thread writing the modifications into persist files. */
+    bool flush_thread_running;        /**< TRUE if the flush thread has been started. */
+    bool stop_requested;              /**< Stopping of the flush thread has been requested. */
 } pm_ctx_t;
 
 /**
@@ -107,20 +139,17 @@ pm_cleanup_data_tree(pm_ctx_t *pm_ctx, struct lyd_node *data_tree, int fd)
 }
 
 /**
- * @brief Loads the data tree of persistent data file tied to specified YANG module.
+ * @brief Opens persistent data file tied to specified YANG module as the specified user
+ * (creates it if it does not exist and the write access has been requested).
  */
 static int
-pm_load_data_tree(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *module_name,
-        bool read_only, struct lyd_node **data_tree, int *fd_p)
+pm_open_data_file(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *data_filename, const char *module_name,
+        bool read_only, int *fd_p)
 {
-    char *data_filename = NULL;
     int fd = -1;
     int rc = SR_ERR_OK;
 
-    CHECK_NULL_ARG4(pm_ctx, pm_ctx->rp_ctx, module_name, data_tree);
-
-    rc = sr_get_persist_data_file_name(pm_ctx->data_search_dir, module_name, &data_filename);
-    CHECK_RC_LOG_RETURN(rc, "Unable to compose persist data file name for '%s'.", module_name);
+    CHECK_NULL_ARG5(pm_ctx, pm_ctx->rp_ctx, data_filename, module_name, fd_p);
 
     /* open the file as the proper user */
     if (NULL != user_cred) {
@@ -157,9 +186,31 @@ pm_load_data_tree(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *mod
             SR_LOG_ERR("Unable to open persist data file '%s': %s.", data_filename, sr_strerror_safe(errno));
             rc = SR_ERR_INTERNAL;
         }
-        if (SR_ERR_OK != rc) {
-            goto cleanup;
-        }
+    }
+
+    *fd_p = fd;
+    return rc;
+}
+
+/**
+ * @brief Loads the data tree of persistent data file tied to specified YANG module.
+ */
+static int
+pm_load_data_tree(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *module_name,
+        bool read_only, struct lyd_node **data_tree, int *fd_p)
+{
+    char *data_filename = NULL;
+    int fd = -1;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG4(pm_ctx, pm_ctx->rp_ctx, module_name, data_tree);
+
+    rc = sr_get_persist_data_file_name(pm_ctx->data_search_dir, module_name, &data_filename);
+    CHECK_RC_LOG_RETURN(rc, "Unable to compose persist data file name for '%s'.", module_name);
+
+    rc = pm_open_data_file(pm_ctx, user_cred, data_filename, module_name, read_only, &fd);
+    if (SR_ERR_OK != rc) {
+        goto cleanup;
     }
 
     /* lock & load the data tree */
@@ -269,50 +320,524 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Checks whether there are some subscriptions that enable running datastore
+ * within the data tree.
+ */
+static int
+pm_dt_has_running_enable_susbscriptions(struct lyd_node *data_tree, const char *module_name, bool *result)
+{
+    char xpath[PATH_MAX] = { 0, };
+    struct ly_set *node_set = NULL;
+
+    CHECK_NULL_ARG3(data_tree, module_name, result);
+
+    snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTIONS_WITH_E_RUNNING, module_name);
+    node_set = lyd_find_xpath(data_tree, xpath);
+    if (NULL == node_set || 0 == node_set->number) {
+        *result = false;
+    } else {
+        *result = true;
+    }
+
+    if (NULL != node_set) {
+        ly_set_free(node_set);
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Compares two cached module data entries by module name.
+ */
+static int
+pm_module_data_cmp(const void *a, const void *b)
+{
+    assert(a);
+    assert(b);
+    pm_module_data_t *data_a = (pm_module_data_t *) a;
+    pm_module_data_t *data_b = (pm_module_data_t *) b;
+
+    int res = strcmp(data_a->module_name, data_b->module_name);
+    if (0 == res) {
+        return 0;
+    } else if (res < 0) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Computes hash of a cached module data entry from the module name.
+ */
+static uint32_t
+pm_module_data_hash(const void *module_data)
+{
+    assert(module_data);
+    return sr_str_hash(((pm_module_data_t *) module_data)->module_name);
+}
+
+/**
+ * @brief Cleans up cached module data entry.
+ */
+static void
+pm_module_data_free(void *module_data_p)
+{
+    pm_module_data_t *module_data = NULL;
+
+    if (NULL != module_data_p) {
+        module_data = (pm_module_data_t *) module_data_p;
+        if (NULL != module_data->data_tree) {
+            lyd_free_withsiblings(module_data->data_tree);
+        }
+        free(module_data->module_name);
+        free(module_data);
+    }
+}
+
+/**
+ * @brief Returns cached persistent data of the module, loads them from the persist file
+ * on the first access. PM data lock is expected to be held.
+ */
+static int
+pm_module_data_get(pm_ctx_t *pm_ctx, const char *module_name, pm_module_data_t **module_data_p)
+{
+    pm_module_data_t lookup = { 0, }, *module_data = NULL;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(pm_ctx, module_name, module_data_p);
+
+    lookup.module_name = (char *) module_name;
+    module_data = sr_omap_search(pm_ctx->module_data, &lookup);
+    if (NULL != module_data) {
+        *module_data_p = module_data;
+        return SR_ERR_OK;
+    }
+
+    module_data = calloc(1, sizeof(*module_data));
+    CHECK_NULL_NOMEM_RETURN(module_data);
+
+    module_data->module_name = strdup(module_name);
+    CHECK_NULL_NOMEM_GOTO(module_data->module_name, rc, cleanup);
+
+    rc = pm_load_data_tree(pm_ctx, NULL, module_name, true, &module_data->data_tree, NULL);
+    if (SR_ERR_DATA_MISSING == rc) {
+        /* the file will be created on first flush */
+        rc = SR_ERR_OK;
+    }
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to load persist data tree for module '%s'.", module_name);
+
+    rc = sr_omap_insert(pm_ctx->module_data, module_data);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to insert module data into the cache.");
+
+    *module_data_p = module_data;
+    return SR_ERR_OK;
+
+cleanup:
+    pm_module_data_free(module_data);
+    return rc;
+}
+
+/**
+ * @brief Takes a snapshot of the modifications of the module not written into its persist file yet
+ * and adds it into the list of the entries to be written. PM data lock is expected to be held.
+ */
+static int
+pm_module_data_take(pm_ctx_t *pm_ctx, pm_module_data_t *module_data, sr_list_t *entries)
+{
+    pm_flush_entry_t *entry = NULL;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(pm_ctx, module_data, entries);
+
+    if (!module_data->dirty) {
+        return SR_ERR_OK;
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    CHECK_NULL_NOMEM_RETURN(entry);
+
+    entry->module_name = strdup(module_data->module_name);
+    CHECK_NULL_NOMEM_GOTO(entry->module_name, rc, cleanup);
+
+    if (NULL != module_data->data_tree) {
+        entry->data_tree = sr_dup_datatree(module_data->data_tree);
+        CHECK_NULL_NOMEM_GOTO(entry->data_tree, rc, cleanup);
+    }
+
+    rc = sr_list_add(entries, entry);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to add the module data into the list.");
+
+    module_data->dirty = false;
+    pm_ctx->dirty_cnt--;
+    return SR_ERR_OK;
+
+cleanup:
+    if (NULL != entry->data_tree) {
+        lyd_free_withsiblings(entry->data_tree);
+    }
+    free(entry->module_name);
+    free(entry);
+    return rc;
+}
+
+/**
+ * @brief Writes the snapshot of persistent data of the module into its persist file.
+ * Does not need PM data lock.
+ */
+static int
+pm_flush_entry_write(pm_ctx_t *pm_ctx, pm_flush_entry_t *entry)
+{
+    char *data_filename = NULL;
+    int fd = -1, ret = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG2(pm_ctx, entry);
+
+    rc = sr_get_persist_data_file_name(pm_ctx->data_search_dir, entry->module_name, &data_filename);
+    CHECK_RC_LOG_RETURN(rc, "Unable to compose persist data file name for '%s'.", entry->module_name);
+
+    rc = pm_open_data_file(pm_ctx, NULL, data_filename, entry->module_name, false, &fd);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to open persist data file for '%s'.", entry->module_name);
+
+    rc = sr_locking_set_lock_fd(pm_ctx->lock_ctx, fd, data_filename, true, true);
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to lock persist data file for '%s'.", entry->module_name);
+
+    if (NULL != entry->data_tree) {
+        rc = pm_save_data_tree(entry->data_tree, fd);
+    } else {
+        /* all persistent data of the module has been removed */
+        ret = ftruncate(fd, 0);
+        CHECK_ZERO_LOG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "File truncate failed: %s", sr_strerror_safe(errno));
+        ret = fsync(fd);
+        CHECK_ZERO_LOG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "File synchronization failed: %s", sr_strerror_safe(errno));
+    }
+    CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to save persist data tree for '%s'.", entry->module_name);
+
+cleanup:
+    if (-1 != fd) {
+        sr_locking_set_unlock_close_fd(pm_ctx->lock_ctx, fd);
+    }
+    free(data_filename);
+    return rc;
+}
+
+/**
+ * @brief Writes cached modifications of the module (or of all modules if module_name is NULL) into
+ * the persist files. Only the snapshots of the modified data trees are taken under PM data lock,
+ * the files are written outside of it. The writers are serialized, so that an older snapshot never
+ * overwrites a newer one. A module whose write fails is marked as modified again to be retried.
+ * If requested, the cached data written successfully are released. PM data lock must not be held.
+ */
+static int
+pm_module_data_flush(pm_ctx_t *pm_ctx, const char *module_name, bool release)
+{
+    pm_module_data_t lookup = { 0, }, *module_data = NULL;
+    pm_flush_entry_t *entry = NULL;
+    sr_list_t *entries = NULL;
+    size_t i = 0;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG(pm_ctx);
+
+    rc = sr_list_init(&entries);
+    CHECK_RC_MSG_RETURN(rc, "Unable to initialize the list of module data.");
+
+    pthread_mutex_lock(&pm_ctx->flush_lock);
+
+    /* take the snapshots of the modified data trees */
+    pthread_mutex_lock(&pm_ctx->data_lock);
+    if (NULL != module_name) {
+        lookup.module_name = (char *) module_name;
+        module_data = sr_omap_search(pm_ctx->module_data, &lookup);
+        if (NULL != module_data) {
+            rc = pm_module_data_take(pm_ctx, module_data, entries);
+        }
+    } else {
+        while (SR_ERR_OK == rc && pm_ctx->dirty_cnt > 0 && NULL != (module_data = sr_omap_get_at(pm_ctx->module_data, i++))) {
+            rc = pm_module_data_take(pm_ctx, module_data, entries);
+        }
+    }
+    pthread_mutex_unlock(&pm_ctx->data_lock);
+
+    /* write the snapshots */
+    for (i = 0; i < entries->count; i++) {
+        entry = (pm_flush_entry_t *) entries->data[i];
+        entry->rc = pm_flush_entry_write(pm_ctx, entry);
+        if (SR_ERR_OK != entry->rc) {
+            rc = entry->rc;
+        }
+    }
+
+    pthread_mutex_lock(&pm_ctx->data_lock);
+    for (i = 0; i < entries->count; i++) {
+        entry = (pm_flush_entry_t *) entries->data[i];
+        if (SR_ERR_OK != entry->rc) {
+            lookup.module_name = entry->module_name;
+            module_data = sr_omap_search(pm_ctx->module_data, &lookup);
+            if (NULL != module_data && !module_data->dirty) {
+                module_data->dirty = true;
+                pm_ctx->dirty_cnt++;
+            }
+        }
+    }
+    if (release) {
+        /* data modified in the meantime or not written are kept */
+        if (NULL != module_name) {
+            lookup.module_name = (char *) module_name;
+            module_data = sr_omap_search(pm_ctx->module_data, &lookup);
+            if (NULL != module_data && !module_data->dirty) {
+                sr_omap_delete(pm_ctx->module_data, module_data);
+            }
+        } else {
+            /* deleting an entry moves the next one to the same index */
+            i = 0;
+            while (NULL != (module_data = sr_omap_get_at(pm_ctx->module_data, i))) {
+                if (module_data->dirty) {
+                    i++;
+                } else {
+                    sr_omap_delete(pm_ctx->module_data, module_data);
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&pm_ctx->data_lock);
+
+    pthread_mutex_unlock(&pm_ctx->flush_lock);
+
+    for (i = 0; i < entries->count; i++) {
+        entry = (pm_flush_entry_t *) entries->data[i];
+        if (NULL != entry->data_tree) {
+            lyd_free_withsiblings(entry->data_tree);
+        }
+        free(entry->module_name);
+        free(entry);
+    }
+    sr_list_cleanup(entries);
+
+    return rc;
+}
+
+/**
+ * @brief Thread that writes the cached modifications into the persist files. Modifications
+ * made within PM_FLUSH_DELAY are coalesced into one write per file.
+ */
+static void *
+pm_flush_thread(void *pm_ctx_p)
+{
+    pm_ctx_t *pm_ctx = (pm_ctx_t *) pm_ctx_p;
+    struct timespec deadline = { 0, };
+    int ret = 0;
+
+    pthread_mutex_lock(&pm_ctx->data_lock);
+    while (!pm_ctx->stop_requested) {
+        while (!pm_ctx->stop_requested && 0 == pm_ctx->dirty_cnt) {
+            pthread_cond_wait(&pm_ctx->flush_cv, &pm_ctx->data_lock);
+        }
+        /* wait for other modifications to coalesce them */
+        sr_clock_get_time(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += PM_FLUSH_DELAY * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        ret = 0;
+        while (!pm_ctx->stop_requested && ETIMEDOUT != ret) {
+            ret = pthread_cond_timedwait(&pm_ctx->flush_cv, &pm_ctx->data_lock, &deadline);
+        }
+        /* the files are written without blocking the access to the cached data */
+        pthread_mutex_unlock(&pm_ctx->data_lock);
+        if (SR_ERR_OK != pm_module_data_flush(pm_ctx, NULL, false)) {
+            SR_LOG_ERR_MSG("Unable to write persistent data, will retry.");
+        }
+        pthread_mutex_lock(&pm_ctx->data_lock);
+    }
+    pthread_mutex_unlock(&pm_ctx->data_lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Starts modification of the persistent data of a module. In write-behind mode returns
+ * a copy of the cached data tree with PM data lock held, otherwise loads and locks the persist file.
+ * Has to be followed by ::pm_edit_end call if succeeded.
+ */
+static int
+pm_edit_begin(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *module_name,
+        struct lyd_node **data_tree, int *fd_p, pm_module_data_t **module_data_p)
+{
+    char *data_filename = NULL;
+    pm_module_data_t *module_data = NULL;
+    int fd = -1;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG5(pm_ctx, module_name, data_tree, fd_p, module_data_p);
+
+    *data_tree = NULL;
+    *fd_p = -1;
+    *module_data_p = NULL;
+
+    if (!pm_ctx->write_behind) {
+        return pm_load_data_tree(pm_ctx, user_cred, module_name, false, data_tree, fd_p);
+    }
+
+    if (NULL != user_cred) {
+        /* the user has to be able to modify the persist file */
+        rc = sr_get_persist_data_file_name(pm_ctx->data_search_dir, module_name, &data_filename);
+        CHECK_RC_LOG_RETURN(rc, "Unable to compose persist data file name for '%s'.", module_name);
+        rc = pm_open_data_file(pm_ctx, user_cred, data_filename, module_name, false, &fd);
+        free(data_filename);
+        if (-1 != fd) {
+            close(fd);
+        }
+        CHECK_RC_LOG_RETURN(rc, "Unable to access persist data file for '%s'.", module_name);
+    }
+
+    pthread_mutex_lock(&pm_ctx->data_lock);
+    rc = pm_module_data_get(pm_ctx, module_name, &module_data);
+    if (SR_ERR_OK != rc) {
+        pthread_mutex_unlock(&pm_ctx->data_lock);
+        SR_LOG_ERR("Unable to get persistent data of module '%s'.", module_name);
+        return rc;
+    }
+
+    /* the copy replaces the cached data tree only if the modification succeeds */
+    if (NULL != module_data->data_tree) {
+        *data_tree = sr_dup_datatree(module_data->data_tree);
+        if (NULL == *data_tree) {
+            pthread_mutex_unlock(&pm_ctx->data_lock);
+            SR_LOG_ERR("Unable to duplicate persistent data of module '%s'.", module_name);
+            return SR_ERR_NOMEM;
+        }
+    }
+    *module_data_p = module_data;
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Finishes modification of the persistent data started by ::pm_edit_begin. If requested, the modified
+ * data tree is saved - synchronously, or by the flush thread in write-behind mode. Otherwise the modifications
+ * are discarded.
+ */
+static int
+pm_edit_end(pm_ctx_t *pm_ctx, struct lyd_node *data_tree, int fd, pm_module_data_t *module_data, bool save)
+{
+    int rc = SR_ERR_OK;
+
+    if (NULL == module_data) {
+        if (save) {
+            rc = pm_save_data_tree(data_tree, fd);
+        }
+        pm_cleanup_data_tree(pm_ctx, data_tree, fd);
+        return rc;
+    }
+
+    if (save) {
+        if (NULL != module_data->data_tree) {
+            lyd_free_withsiblings(module_data->data_tree);
+        }
+        module_data->data_tree = data_tree;
+        if (!module_data->dirty) {
+            module_data->dirty = true;
+            pm_ctx->dirty_cnt++;
+            pthread_cond_signal(&pm_ctx->flush_cv);
+        }
+    } else if (NULL != data_tree) {
+        /* the copy may be partially modified, the cached tree is kept intact */
+        lyd_free_withsiblings(data_tree);
+    }
+    pthread_mutex_unlock(&pm_ctx->data_lock);
+
+    return rc;
+}
+
+/**
+ * @brief Starts reading of the persistent data of a module. In write-behind mode returns
+ * the cached data tree with PM data lock held, otherwise loads the data tree from the persist file.
+ * Has to be followed by ::pm_read_end call if succeeded.
+ */
+static int
+pm_read_begin(pm_ctx_t *pm_ctx, const char *module_name, struct lyd_node **data_tree, pm_module_data_t **module_data_p)
+{
+    pm_module_data_t *module_data = NULL;
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG4(pm_ctx, module_name, data_tree, module_data_p);
+
+    *data_tree = NULL;
+    *module_data_p = NULL;
+
+    if (!pm_ctx->write_behind) {
+        return pm_load_data_tree(pm_ctx, NULL, module_name, true, data_tree, NULL);
+    }
+
+    pthread_mutex_lock(&pm_ctx->data_lock);
+    rc = pm_module_data_get(pm_ctx, module_name, &module_data);
+    if (SR_ERR_OK != rc) {
+        pthread_mutex_unlock(&pm_ctx->data_lock);
+        SR_LOG_ERR("Unable to get persistent data of module '%s'.", module_name);
+        return rc;
+    }
+
+    *data_tree = module_data->data_tree;
+    *module_data_p = module_data;
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Finishes reading of the persistent data started by ::pm_read_begin.
+ */
+static void
+pm_read_end(pm_ctx_t *pm_ctx, struct lyd_node *data_tree, pm_module_data_t *module_data)
+{
+    if (NULL != module_data) {
+        pthread_mutex_unlock(&pm_ctx->data_lock);
+    } else if (NULL != data_tree) {
+        lyd_free_withsiblings(data_tree);
+    }
+}
+
 /**
  * @brief Saves/deletes provided data on provided xpath location within the
  * persistent data file of a module.
  */
 static int
 pm_save_persistent_data(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *module_name,
-        const char *xpath, const char *value, bool add, struct lyd_node **data_tree_p, bool *running_affected)
+        const char *xpath, const char *value, bool add, bool *disable_running)
 {
     struct lyd_node *data_tree = NULL;
+    pm_module_data_t *module_data = NULL;
+    bool running_affected = false, has_running_enable_susbscriptions = false;
     int fd = -1;
     int rc = SR_ERR_OK;
 
     CHECK_NULL_ARG3(pm_ctx, module_name, xpath);
 
-    if (NULL != running_affected) {
-        *running_affected = false;
-    }
-
-    if (NULL != data_tree_p && NULL != *data_tree_p) {
-        /* use provided data tree */
-        data_tree = *data_tree_p;
-    } else {
-        /* load the data tree from persist file */
-        rc = pm_load_data_tree(pm_ctx, user_cred, module_name, false, &data_tree, &fd);
-        CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to load persist data tree for module '%s'.", module_name);
+    if (NULL != disable_running) {
+        *disable_running = false;
     }
 
-    rc = pm_modify_persist_data_tree(pm_ctx, &data_tree, xpath, value, add, running_affected);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to modify persist data tree.");
+    rc = pm_edit_begin(pm_ctx, user_cred, module_name, &data_tree, &fd, &module_data);
+    CHECK_RC_LOG_RETURN(rc, "Unable to load persist data tree for module '%s'.", module_name);
 
-    /* save the changes to the persist file */
-    if (-1 != fd) {
-        rc = pm_save_data_tree(data_tree, fd);
-        CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to save persist data tree.");
+    rc = pm_modify_persist_data_tree(pm_ctx, &data_tree, xpath, value, add, &running_affected);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR_MSG("Unable to modify persist data tree.");
+        pm_edit_end(pm_ctx, data_tree, fd, module_data, false);
+        return rc;
     }
 
-    /* if data tree was requested, do not free and return it */
-    if (NULL != data_tree_p) {
-        *data_tree_p = data_tree;
-        data_tree = NULL;
+    if (running_affected && NULL != disable_running && NULL != data_tree) {
+        /* check if some subscriptions that enable running left */
+        rc = pm_dt_has_running_enable_susbscriptions(data_tree, module_name, &has_running_enable_susbscriptions);
+        if (SR_ERR_OK == rc && !has_running_enable_susbscriptions) {
+            *disable_running = true;
+        }
     }
 
-cleanup:
-    pm_cleanup_data_tree(pm_ctx, data_tree, fd);
+    /* save the changes to the persist file */
+    rc = pm_edit_end(pm_ctx, data_tree, fd, module_data, true);
+    CHECK_RC_MSG_RETURN(rc, "Unable to save persist data tree.");
+
     return rc;
 }
 
@@ -327,8 +852,8 @@ pm_subscription_entry_fill(const char *module_name, np_subscription_t *subscript
 
     CHECK_NULL_ARG4(module_name, subscription, node, node->schema);
 
-    subscription->module_name = strdup(module_name);
-    CHECK_NULL_NOMEM_GOTO(subscription->module_name, rc, cleanup);
+    rc = sr_str_intern(module_name, &subscription->module_name);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern module name.");
 
     while (NULL != node) {
         if (NULL != node->schema && NULL != node->schema->name) {
@@ -337,15 +862,15 @@ pm_subscription_entry_fill(const char *module_name, np_subscription_t *subscript
                 subscription->type = sr_subsciption_type_str_to_gpb(node_ll->value.ident->name);
             }
             if (NULL != node_ll->value_str && 0 == strcmp(node->schema->name, "destination-address")) {
-                subscription->dst_address = strdup(node_ll->value_str);
-                CHECK_NULL_NOMEM_GOTO(subscription->dst_address, rc, cleanup);
+                rc = sr_str_intern(node_ll->value_str, &subscription->dst_address);
+                CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern destination address.");
             }
             if (NULL != node_ll->value_str && 0 == strcmp(node->schema->name, "destination-id")) {
                 subscription->dst_id = atoi(node_ll->value_str);
             }
             if (NULL != node_ll->value_str && 0 == strcmp(node->schema->name, "xpath")) {
-                subscription->xpath = strdup(node_ll->value_str);
-                CHECK_NULL_NOMEM_GOTO(subscription->xpath, rc, cleanup);
+                rc = sr_str_intern(node_ll->value_str, &subscription->xpath);
+                CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to intern xpath.");
             }
             if (0 == strcmp(node->schema->name, "event") && NULL != node_ll->value.ident->name) {
                 subscription->notif_event = sr_notification_event_str_to_gpb(node_ll->value.ident->name);
@@ -356,6 +881,9 @@ pm_subscription_entry_fill(const char *module_name, np_subscription_t *subscript
             if (0 == strcmp(node->schema->name, "enable-running")) {
                 subscription->enable_running = true;
             }
+            if (0 == strcmp(node->schema->name, "push-changes")) {
+                subscription->push_changes = true;
+            }
             if (NULL != node_ll->value_str && 0 == strcmp(node->schema->name, "api-variant")) {
                 subscription->api_variant = sr_api_variant_from_str(node_ll->value_str);
             }
@@ -370,38 +898,13 @@ cleanup:
     return rc;
 }
 
-/**
- * @brief Checks whether there are some subscriptions that enable running datastore
- * within the data tree.
- */
-static int
-pm_dt_has_running_enable_susbscriptions(struct lyd_node *data_tree, const char *module_name, bool *result)
-{
-    char xpath[PATH_MAX] = { 0, };
-    struct ly_set *node_set = NULL;
-
-    CHECK_NULL_ARG3(data_tree, module_name, result);
-
-    snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTIONS_WITH_E_RUNNING, module_name);
-    node_set = lyd_find_xpath(data_tree, xpath);
-    if (NULL == node_set || 0 == node_set->number) {
-        *result = false;
-    } else {
-        *result = true;
-    }
-
-    if (NULL != node_set) {
-        ly_set_free(node_set);
-    }
-
-    return SR_ERR_OK;
-}
-
 int
-pm_init(rp_ctx_t *rp_ctx, const char *schema_search_dir, const char *data_search_dir, pm_ctx_t **pm_ctx)
+pm_init(rp_ctx_t *rp_ctx, cm_connection_mode_t conn_mode, const char *schema_search_dir, const char *data_search_dir,
+        pm_ctx_t **pm_ctx)
 {
     pm_ctx_t *ctx = NULL;
     char *schema_filename = NULL;
+    int ret = 0;
     int rc = SR_ERR_OK;
 
     CHECK_NULL_ARG4(rp_ctx, schema_search_dir, data_search_dir, pm_ctx);
@@ -441,6 +944,22 @@ pm_init(rp_ctx_t *rp_ctx, const char *schema_search_dir, const char *data_search
         goto cleanup;
     }
 
+    /* persist files are shared with other engines in library mode, write them synchronously */
+    ctx->write_behind = (CM_MODE_DAEMON == conn_mode);
+    if (ctx->write_behind) {
+        rc = sr_omap_init(pm_module_data_cmp, pm_module_data_hash, pm_module_data_free, &ctx->module_data);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to initialize persistent data cache.");
+
+        pthread_mutex_init(&ctx->data_lock, NULL);
+        pthread_mutex_init(&ctx->flush_lock, NULL);
+        pthread_cond_init(&ctx->flush_cv, NULL);
+
+        ret = pthread_create(&ctx->flush_thread, NULL, pm_flush_thread, ctx);
+        CHECK_ZERO_LOG_GOTO(ret, rc, SR_ERR_INIT_FAILED, cleanup, "Unable to start the flush thread: %s",
+                sr_strerror_safe(ret));
+        ctx->flush_thread_running = true;
+    }
+
     *pm_ctx = ctx;
     return SR_ERR_OK;
 
@@ -453,6 +972,21 @@ void
 pm_cleanup(pm_ctx_t *pm_ctx)
 {
     if (NULL != pm_ctx) {
+        if (pm_ctx->write_behind && NULL != pm_ctx->module_data) {
+            if (pm_ctx->flush_thread_running) {
+                pthread_mutex_lock(&pm_ctx->data_lock);
+                pm_ctx->stop_requested = true;
+                pthread_cond_signal(&pm_ctx->flush_cv);
+                pthread_mutex_unlock(&pm_ctx->data_lock);
+                pthread_join(pm_ctx->flush_thread, NULL);
+            }
+            /* write all pending modifications */
+            pm_flush(pm_ctx, NULL, true);
+            sr_omap_cleanup(pm_ctx->module_data);
+            pthread_mutex_destroy(&pm_ctx->data_lock);
+            pthread_mutex_destroy(&pm_ctx->flush_lock);
+            pthread_cond_destroy(&pm_ctx->flush_cv);
+        }
         if (NULL != pm_ctx->ly_ctx) {
             ly_ctx_destroy(pm_ctx->ly_ctx, NULL);
         }
@@ -462,6 +996,26 @@ pm_cleanup(pm_ctx_t *pm_ctx)
     }
 }
 
+int
+pm_flush(pm_ctx_t *pm_ctx, const char *module_name, bool release)
+{
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG(pm_ctx);
+
+    if (!pm_ctx->write_behind) {
+        return SR_ERR_OK;
+    }
+
+    rc = pm_module_data_flush(pm_ctx, module_name, release);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR("Unable to write persistent data of %s%s.", module_name ? "module " : "all modules",
+                module_name ? module_name : "");
+    }
+
+    return rc;
+}
+
 int
 pm_save_feature_state(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *module_name,
         const char *feature_name, bool enable)
@@ -475,7 +1029,7 @@ pm_save_feature_state(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char
         /* enable the feature */
         snprintf(xpath, PATH_MAX, PM_XPATH_FEATURES, module_name);
 
-        rc = pm_save_persistent_data(pm_ctx, user_cred, module_name, xpath, feature_name, true, NULL, NULL);
+        rc = pm_save_persistent_data(pm_ctx, user_cred, module_name, xpath, feature_name, true, NULL);
 
         if (SR_ERR_OK == rc) {
             SR_LOG_DBG("Feature '%s' successfully enabled in '%s' persist data tree.", feature_name, module_name);
@@ -484,7 +1038,7 @@ pm_save_feature_state(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char
         /* disable the feature */
         snprintf(xpath, PATH_MAX, PM_XPATH_FEATURES_BY_NAME, module_name, feature_name);
 
-        rc = pm_save_persistent_data(pm_ctx, user_cred, module_name, xpath, NULL, false, NULL, NULL);
+        rc = pm_save_persistent_data(pm_ctx, user_cred, module_name, xpath, NULL, false, NULL);
 
         if (SR_ERR_OK == rc) {
             SR_LOG_DBG("Feature '%s' successfully disabled in '%s' persist file.", feature_name, module_name);
@@ -500,6 +1054,7 @@ pm_get_module_info(pm_ctx_t *pm_ctx, const char *module_name, sr_mem_ctx_t *sr_m
 {
     char xpath[PATH_MAX] = { 0, };
     struct lyd_node *data_tree = NULL;
+    pm_module_data_t *module_data = NULL;
     struct ly_set *node_set = NULL;
     char **subtrees_enabled = NULL, **features = NULL, **tmp = NULL;
     const char *feature_name = NULL;
@@ -522,7 +1077,7 @@ pm_get_module_info(pm_ctx_t *pm_ctx, const char *module_name, sr_mem_ctx_t *sr_m
     }
 
     /* load the data tree from persist file */
-    rc = pm_load_data_tree(pm_ctx, NULL, module_name, true, &data_tree, NULL);
+    rc = pm_read_begin(pm_ctx, module_name, &data_tree, &module_data);
     if (SR_ERR_DATA_MISSING != rc) {
         /* ignore data missing error */
         CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to load persist data tree for module '%s'.", module_name);
@@ -596,9 +1151,7 @@ cleanup:
     if (NULL != node_set) {
         ly_set_free(node_set);
     }
-    if (NULL != data_tree) {
-        lyd_free_withsiblings(data_tree);
-    }
+    pm_read_end(pm_ctx, data_tree, module_data);
 
     if (SR_ERR_OK != rc) {
         for (size_t i = 0; i < subtrees_enabled_cnt; i++) {
@@ -624,10 +1177,11 @@ pm_add_subscription(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *m
     char xpath[PATH_MAX] = { 0, }, buff[15] = { 0, };
     const char *value = NULL;
     struct lyd_node *data_tree = NULL;
+    pm_module_data_t *module_data = NULL;
     int fd = -1;
     int rc = SR_ERR_OK;
 
-    rc = pm_load_data_tree(pm_ctx, user_cred, module_name, false, &data_tree, &fd);
+    rc = pm_edit_begin(pm_ctx, user_cred, module_name, &data_tree, &fd, &module_data);
     CHECK_RC_LOG_RETURN(rc, "Unable to load persist data tree for module '%s'.", module_name);
 
     if (exclusive) {
@@ -656,6 +1210,12 @@ pm_add_subscription(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *m
         rc = pm_modify_persist_data_tree(pm_ctx, &data_tree, xpath, value, true, NULL);
         CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to add new leaf into the data tree.");
     }
+    if (subscription->push_changes) {
+        snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTION_PUSH_CHANGES, module_name,
+                sr_subscription_type_gpb_to_str(subscription->type), subscription->dst_address, subscription->dst_id);
+        rc = pm_modify_persist_data_tree(pm_ctx, &data_tree, xpath, value, true, NULL);
+        CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to add new leaf into the data tree.");
+    }
     if (NULL != subscription->xpath) {
         snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTION_XPATH, module_name,
                 sr_subscription_type_gpb_to_str(subscription->type), subscription->dst_address, subscription->dst_id);
@@ -690,14 +1250,15 @@ pm_add_subscription(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char *m
         CHECK_RC_MSG_GOTO(rc, cleanup, "Unable to add new leaf into the data tree.");
     }
 
-    rc = pm_save_data_tree(data_tree, fd);
+    rc = pm_edit_end(pm_ctx, data_tree, fd, module_data, true);
 
     if (SR_ERR_OK == rc) {
         SR_LOG_DBG("Subscription entry successfully added into '%s' persist data tree.", module_name);
     }
+    return rc;
 
 cleanup:
-    pm_cleanup_data_tree(pm_ctx, data_tree, fd);
+    pm_edit_end(pm_ctx, data_tree, fd, module_data, false);
     return rc;
 }
 
@@ -706,8 +1267,6 @@ pm_remove_subscription(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char
         const np_subscription_t *subscription, bool *disable_running)
 {
     char xpath[PATH_MAX] = { 0, };
-    struct lyd_node *data_tree = NULL;
-    bool running_affected = false, has_running_enable_susbscriptions = false;
     int rc = SR_ERR_OK;
 
     CHECK_NULL_ARG5(pm_ctx, user_cred, module_name, subscription, disable_running);
@@ -717,17 +1276,7 @@ pm_remove_subscription(pm_ctx_t *pm_ctx, const ac_ucred_t *user_cred, const char
     snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTION, module_name,
             sr_subscription_type_gpb_to_str(subscription->type), subscription->dst_address, subscription->dst_id);
 
-    rc = pm_save_persistent_data(pm_ctx, user_cred, module_name, xpath, NULL, false, &data_tree, &running_affected);
-    if (NULL != data_tree) {
-        if (running_affected) {
-            /* check if some subscriptions that enable running left */
-            rc = pm_dt_has_running_enable_susbscriptions(data_tree, module_name, &has_running_enable_susbscriptions);
-            if (SR_ERR_OK == rc && !has_running_enable_susbscriptions) {
-                *disable_running = true;
-            }
-        }
-        lyd_free_withsiblings(data_tree);
-    }
+    rc = pm_save_persistent_data(pm_ctx, user_cred, module_name, xpath, NULL, false, disable_running);
 
     if (SR_ERR_OK == rc) {
         SR_LOG_DBG("Subscription entry successfully removed from '%s' persist file.", module_name);
@@ -741,8 +1290,6 @@ pm_remove_subscriptions_for_destination(pm_ctx_t *pm_ctx, const char *module_nam
         bool *disable_running)
 {
     char xpath[PATH_MAX] = { 0, };
-    struct lyd_node *data_tree = NULL;
-    bool running_affected = false, has_running_enable_susbscriptions = false;
     int rc = SR_ERR_OK;
 
     CHECK_NULL_ARG4(pm_ctx, module_name, dst_address, disable_running);
@@ -752,18 +1299,7 @@ pm_remove_subscriptions_for_destination(pm_ctx_t *pm_ctx, const char *module_nam
     snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTIONS_BY_DST_ADDR, module_name, dst_address);
 
     /* remove the subscriptions */
-    rc = pm_save_persistent_data(pm_ctx, NULL, module_name, xpath, NULL, false, &data_tree, &running_affected);
-    if (NULL != data_tree) {
-        /* check if some subscriptions that enable running left */
-        if (running_affected) {
-            /* check if some subscriptions that enable running left */
-            rc = pm_dt_has_running_enable_susbscriptions(data_tree, module_name, &has_running_enable_susbscriptions);
-            if (SR_ERR_OK == rc && !has_running_enable_susbscriptions) {
-                *disable_running = true;
-            }
-        }
-        lyd_free_withsiblings(data_tree);
-    }
+    rc = pm_save_persistent_data(pm_ctx, NULL, module_name, xpath, NULL, false, disable_running);
 
     if (SR_ERR_OK == rc) {
         SR_LOG_DBG("Subscription entries for destination '%s' successfully removed from '%s' persist file.",
@@ -773,21 +1309,24 @@ pm_remove_subscriptions_for_destination(pm_ctx_t *pm_ctx, const char *module_nam
     return rc;
 }
 
-int
-pm_get_subscriptions(pm_ctx_t *pm_ctx, const char *module_name, Sr__SubscriptionType type,
+/**
+ * @brief Loads the subscriptions matching given xpath from module's persistent data file.
+ */
+static int
+pm_load_subscriptions(pm_ctx_t *pm_ctx, const char *module_name, const char *xpath,
         np_subscription_t **subscriptions_p, size_t *subscription_cnt_p)
 {
-    char xpath[PATH_MAX] = { 0, };
     struct lyd_node *data_tree = NULL;
+    pm_module_data_t *module_data = NULL;
     struct ly_set *node_set = NULL;
     np_subscription_t *subscriptions = NULL;
     size_t subscription_cnt = 0;
     int rc = SR_ERR_OK;
 
-    CHECK_NULL_ARG4(pm_ctx, module_name, subscriptions_p, subscription_cnt_p);
+    CHECK_NULL_ARG5(pm_ctx, module_name, xpath, subscriptions_p, subscription_cnt_p);
 
     /* load the data tree from persist file */
-    rc = pm_load_data_tree(pm_ctx, NULL, module_name, true, &data_tree, NULL);
+    rc = pm_read_begin(pm_ctx, module_name, &data_tree, &module_data);
     if (SR_ERR_DATA_MISSING != rc) {
         CHECK_RC_LOG_GOTO(rc, cleanup, "Unable to load persist data tree for module '%s' %s.", module_name, sr_strerror(rc));
     }
@@ -800,7 +1339,6 @@ pm_get_subscriptions(pm_ctx_t *pm_ctx, const char *module_name, Sr__Subscription
         goto cleanup;
     }
 
-    snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTIONS_BY_TYPE, module_name, sr_subscription_type_gpb_to_str(type));
     node_set = lyd_find_xpath(data_tree, xpath);
 
     if (NULL != node_set && node_set->number > 0) {
@@ -823,9 +1361,7 @@ cleanup:
     if (NULL != node_set) {
         ly_set_free(node_set);
     }
-    if (NULL != data_tree) {
-        lyd_free_withsiblings(data_tree);
-    }
+    pm_read_end(pm_ctx, data_tree, module_data);
 
     if (SR_ERR_OK != rc) {
         np_free_subscriptions(subscriptions, subscription_cnt);
@@ -833,3 +1369,58 @@ cleanup:
 
     return rc;
 }
+
+int
+pm_get_subscriptions(pm_ctx_t *pm_ctx, const char *module_name, Sr__SubscriptionType type,
+        np_subscription_t **subscriptions_p, size_t *subscription_cnt_p)
+{
+    char xpath[PATH_MAX] = { 0, };
+
+    CHECK_NULL_ARG4(pm_ctx, module_name, subscriptions_p, subscription_cnt_p);
+
+    snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTIONS_BY_TYPE, module_name, sr_subscription_type_gpb_to_str(type));
+
+    return pm_load_subscriptions(pm_ctx, module_name, xpath, subscriptions_p, subscription_cnt_p);
+}
+
+int
+pm_get_module_subscriptions(pm_ctx_t *pm_ctx, const char *module_name,
+        np_subscription_t **subscriptions_p, size_t *subscription_cnt_p)
+{
+    char xpath[PATH_MAX] = { 0, };
+
+    CHECK_NULL_ARG4(pm_ctx, module_name, subscriptions_p, subscription_cnt_p);
+
+    snprintf(xpath, PATH_MAX, PM_XPATH_SUBSCRIPTION_LIST, module_name);
+
+    return pm_load_subscriptions(pm_ctx, module_name, xpath, subscriptions_p, subscription_cnt_p);
+}
+
+int
+pm_get_persist_file_mtime(pm_ctx_t *pm_ctx, const char *module_name, struct timespec *mtime)
+{
+    int rc = SR_ERR_OK;
+
+    CHECK_NULL_ARG3(pm_ctx, module_name, mtime);
+
+    mtime->tv_sec = 0;
+    mtime->tv_nsec = 0;
+
+#ifdef HAVE_STAT_ST_MTIM
+    char *data_filename = NULL;
+    struct stat st = { 0, };
+
+    rc = sr_get_persist_data_file_name(pm_ctx->data_search_dir, module_name, &data_filename);
+    CHECK_RC_LOG_RETURN(rc, "Unable to compose persist data file name for '%s'.", module_name);
+
+    if (0 == stat(data_filename, &st)) {
+        *mtime = st.st_mtim;
+    } else if (ENOENT != errno) {
+        SR_LOG_ERR("Unable to stat persist data file '%s': %s.", data_filename, sr_strerror_safe(errno));
+        rc = SR_ERR_INTERNAL;
+    }
+    free(data_filename);
+#endif
+
+    return rc;
+}
@@ -24,6 +24,7 @@
 
 #include "access_control.h"
 #include "notification_processor.h"
+#include "connection_manager.h"
 #include "sr_common.h"
 
 /**
@@ -43,14 +44,20 @@ typedef struct pm_ctx_s pm_ctx_t;
 /**
  * @brief Initializes a Persistence Manager instance.
  *
+ * In daemon mode, persistent data are cached in memory and written into the persist
+ * files asynchronously (write-behind), see ::pm_flush. In library mode the persist files
+ * are shared with other sysrepo engines, therefore they are written synchronously.
+ *
  * @param[in] rp_ctx Request Processor context.
+ * @param[in] conn_mode Mode in which Connection Manager operates.
  * @param[in] schema_search_dir Directory containing PM's YANG module schema.
  * @param[in] data_search_dir Directory containing the data files.
  * @param[out] pm_ctx Allocated Persistence Manager context that can be used in subsequent PM API calls.
  *
  * @return Error code (SR_ERR_OK on success).
  */
-int pm_init(rp_ctx_t *rp_ctx, const char *schema_search_dir, const char *data_search_dir, pm_ctx_t **pm_ctx);
+int pm_init(rp_ctx_t *rp_ctx, cm_connection_mode_t conn_mode, const char *schema_search_dir, const char *data_search_dir,
+        pm_ctx_t **pm_ctx);
 
 /**
  * @brief Cleans up the Persistence Manager instance.
@@ -59,6 +66,18 @@ int pm_init(rp_ctx_t *rp_ctx, const char *schema_search_dir, const char *data_se
  */
 void pm_cleanup(pm_ctx_t *pm_ctx);
 
+/**
+ * @brief Writes pending modifications of the persistent data into the persist files
+ * (no-op unless PM operates in write-behind mode).
+ *
+ * @param[in] pm_ctx Persistence Manager context acquired by ::pm_init call.
+ * @param[in] module_name Name of the module to be flushed. NULL flushes all modules.
+ * @param[in] release Drop the cached data of the module(s) after they have been written.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int pm_flush(pm_ctx_t *pm_ctx, const char *module_name, bool release);
+
 /**
  * @brief Enables/disables the feature in module's persistent storage.
  *
@@ -150,6 +169,32 @@ int pm_remove_subscriptions_for_destination(pm_ctx_t *pm_ctx, const char *module
 int pm_get_subscriptions(pm_ctx_t *pm_ctx, const char *module_name, Sr__SubscriptionType notif_type,
         np_subscription_t **subscriptions, size_t *subscription_cnt);
 
+/**
+ * @brief Returns the array of all active subscriptions (of any type) in module's persistent storage.
+ *
+ * @param[in] pm_ctx Persistence Manager context acquired by ::pm_init call.
+ * @param[in] module_name Name of the module.
+ * @param[out] subscriptions Array of the active subscriptions.
+ * @param[out] subscription_cnt Number of subscriptions in returned array.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int pm_get_module_subscriptions(pm_ctx_t *pm_ctx, const char *module_name,
+        np_subscription_t **subscriptions, size_t *subscription_cnt);
+
+/**
+ * @brief Returns the time of the last modification of module's persistent data file,
+ * which can be used to detect the changes made by other sysrepo engines.
+ *
+ * @param[in] pm_ctx Persistence Manager context acquired by ::pm_init call.
+ * @param[in] module_name Name of the module.
+ * @param[out] mtime Time of the last modification, zero if the file does not exist
+ * or the modification time is not available on this platform.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int pm_get_persist_file_mtime(pm_ctx_t *pm_ctx, const char *module_name, struct timespec *mtime);
+
 /**@} pm */
 
 #endif /* PERSISTENCE_MANAGER_H_ */
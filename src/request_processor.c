@@ -20,6 +20,7 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 #include <inttypes.h>
@@ -35,9 +36,11 @@
 #include "rp_dt_edit.h"
 #include "rp_dt_xpath.h"
 
-#define RP_INIT_REQ_QUEUE_SIZE   10  /**< Initial size of the request queue. */
+#define RP_REQ_QUEUE_SIZE      1024  /**< Capacity of the lock-free part of the request queue. */
 #define RP_OPER_DATA_REQ_TIMEOUT 2   /**< Timeout (in seconds) for processing of a request that includes operational data. */
 
+#define RP_SLOW_REQUEST_THRESHOLD_ENV "SR_SLOW_REQUEST_THRESHOLD"  /**< Environment variable overriding the threshold of the slow request log. */
+
 /*
  * Attributes that can significantly affect performance of the threadpool.
  */
@@ -167,6 +170,16 @@ rp_set_oper_request_timeout(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *re
     return rc;
 }
 
+/**
+ * @brief Sends a response to a request of the session and records its memory usage.
+ */
+static int
+rp_resp_send(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr__Msg *resp)
+{
+    rp_stats_response(rp_ctx, session, resp);
+    return cm_msg_send(rp_ctx->cm_ctx, resp);
+}
+
 /**
  * @brief Processes a list_schemas request.
  */
@@ -206,7 +219,7 @@ rp_list_schemas_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session,
     resp->response->result = rc;
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -244,7 +257,7 @@ rp_get_schema_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, S
             &resp->response->get_schema_resp->schema_content);
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -296,11 +309,25 @@ rp_module_install_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *sessio
                         &implicitly_removed);
     }
 
+    /* data files of the modules have been created / removed */
+    if (SR_ERR_OK == oper_rc) {
+        ac_invalidate_cache(rp_ctx->ac_ctx);
+    }
+
+    /* write pending persistent data of uninstalled modules before their files may be removed */
+    if (SR_ERR_OK == oper_rc && !msg->request->module_install_req->installed) {
+        pm_flush(rp_ctx->pm_ctx, msg->request->module_install_req->module_name, true);
+        for (size_t i = 0; NULL != implicitly_removed && i < implicitly_removed->count; ++i) {
+            module_key = (md_module_key_t *)implicitly_removed->data[i];
+            pm_flush(rp_ctx->pm_ctx, module_key->name, true);
+        }
+    }
+
     /* set response code */
     resp->response->result = oper_rc;
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     /* notify subscribers */
     if (SR_ERR_OK == oper_rc) {
@@ -369,7 +396,7 @@ rp_feature_enable_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *sessio
     resp->response->result = oper_rc;
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     /* notify subscribers */
     if (SR_ERR_OK == oper_rc) {
@@ -467,7 +494,7 @@ cleanup:
     }
 
     sr_free_val(value);
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -555,7 +582,12 @@ rp_get_items_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg,
     pthread_mutex_unlock(&session->cur_req_mutex);
 
     /* copy values to gpb */
-    rc = sr_values_sr_to_gpb(values, count, &resp->response->get_items_resp->values, &resp->response->get_items_resp->n_values);
+    if (msg->request->get_items_req->has_compact && msg->request->get_items_req->compact && 0 < count) {
+        /* encode the values into a contiguous block with front-coded xpaths */
+        rc = sr_values_sr_to_gpb_block(values, count, &resp->response->get_items_resp->value_block);
+    } else {
+        rc = sr_values_sr_to_gpb(values, count, &resp->response->get_items_resp->values, &resp->response->get_items_resp->n_values);
+    }
     CHECK_RC_MSG_GOTO(rc, cleanup, "Copying values to GPB failed.");
 
 cleanup:
@@ -570,7 +602,7 @@ cleanup:
     }
 
     sr_free_values(values, count);
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -599,7 +631,6 @@ rp_get_subtree_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg
         return rc;
     }
 
-    sr_node_t *tree = NULL;
     char *xpath = msg->request->get_subtree_req->xpath;
 
     if (session->options & SR__SESSION_FLAGS__SESS_NOTIFICATION) {
@@ -623,8 +654,9 @@ rp_get_subtree_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg
     /* store current request to session */
     session->req = msg;
 
-    /* get subtree from data manager */
-    rc = rp_dt_get_subtree_wrapper(rp_ctx, session, sr_mem, xpath, &tree);
+    /* get subtree from data manager, built directly as gpb */
+    rc = rp_dt_get_subtree_gpb_wrapper(rp_ctx, session, sr_mem, xpath, 0, SIZE_MAX, SIZE_MAX, SIZE_MAX,
+            &resp->response->get_subtree_resp->tree, NULL);
     if (SR_ERR_OK != rc && SR_ERR_NOT_FOUND != rc) {
         SR_LOG_ERR("Get subtree failed for '%s', session id=%"PRIu32".", xpath, session->id);
     }
@@ -635,7 +667,6 @@ rp_get_subtree_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg
         *skip_msg_cleanup = true;
         /* setup timeout */
         rc = rp_set_oper_request_timeout(rp_ctx, session, msg, RP_OPER_DATA_REQ_TIMEOUT);
-        sr_free_tree(tree);
         sr_msg_free(resp);
         pthread_mutex_unlock(&session->cur_req_mutex);
         return rc;
@@ -643,14 +674,6 @@ rp_get_subtree_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg
 
     pthread_mutex_unlock(&session->cur_req_mutex);
 
-    /* copy value to gpb */
-    if (SR_ERR_OK == rc) {
-        rc = sr_dup_tree_to_gpb(tree, &resp->response->get_subtree_resp->tree);
-        if (SR_ERR_OK != rc) {
-            SR_LOG_ERR("Copying sr_node_t to gpb failed for xpath '%s'", xpath);
-        }
-    }
-
 cleanup:
     session->req = NULL;
     /* set response code */
@@ -661,8 +684,7 @@ cleanup:
         SR_LOG_ERR_MSG("Copying errors to gpb failed");
     }
 
-    sr_free_tree(tree);
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -673,7 +695,7 @@ cleanup:
 static int
 rp_get_subtrees_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg, bool *skip_msg_cleanup)
 {
-    sr_node_t *trees = NULL;
+    Sr__Node **trees = NULL;
     size_t count = 0;
     char *xpath = NULL;
     int rc = SR_ERR_OK;
@@ -716,7 +738,8 @@ rp_get_subtrees_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *ms
     session->req = msg;
 
     xpath = msg->request->get_subtrees_req->xpath;
-    rc = rp_dt_get_subtrees_wrapper(rp_ctx, session, sr_mem, xpath, &trees, &count);
+    rc = rp_dt_get_subtrees_gpb_wrapper(rp_ctx, session, sr_mem, xpath, 0, SIZE_MAX, SIZE_MAX, SIZE_MAX,
+            &trees, &count, NULL);
 
     if (SR_ERR_OK != rc) {
         if (SR_ERR_NOT_FOUND != rc) {
@@ -732,7 +755,6 @@ rp_get_subtrees_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *ms
         *skip_msg_cleanup = true;
         /* setup timeout */
         rc = rp_set_oper_request_timeout(rp_ctx, session, msg, RP_OPER_DATA_REQ_TIMEOUT);
-        sr_free_trees(trees, count);
         sr_msg_free(resp);
         pthread_mutex_unlock(&session->cur_req_mutex);
         return rc;
@@ -741,9 +763,9 @@ rp_get_subtrees_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *ms
     SR_LOG_DBG("%zu subtrees found for '%s', session id=%"PRIu32".", count, xpath, session->id);
     pthread_mutex_unlock(&session->cur_req_mutex);
 
-    /* copy subtrees to gpb */
-    rc = sr_trees_sr_to_gpb(trees, count, &resp->response->get_subtrees_resp->trees, &resp->response->get_subtrees_resp->n_trees);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "Copying values to GPB failed.");
+    /* subtrees have been built directly as gpb */
+    resp->response->get_subtrees_resp->trees = trees;
+    resp->response->get_subtrees_resp->n_trees = count;
 
 cleanup:
     session->req = NULL;
@@ -756,8 +778,7 @@ cleanup:
         SR_LOG_ERR_MSG("Copying errors to gpb failed");
     }
 
-    sr_free_trees(trees, count);
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -786,7 +807,7 @@ rp_get_subtree_chunk_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Ms
         return rc;
     }
 
-    sr_node_t *chunks = NULL;
+    Sr__Node **chunks = NULL;
     size_t chunk_cnt = 0;
     char **chunk_ids = NULL;
     char *xpath = msg->request->get_subtree_chunk_req->xpath;
@@ -817,26 +838,30 @@ rp_get_subtree_chunk_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Ms
     /* store current request to session */
     session->req = msg;
 
-    /* get subtree chunk(s) from data manager */
+    /* get subtree chunk(s) from data manager, built directly as gpb */
     if (single) {
         chunk_ids = sr_calloc(sr_mem, 1, sizeof(char *));
-        if (NULL == chunk_ids) {
+        chunks = sr_calloc(sr_mem, 1, sizeof(*chunks));
+        if (NULL == chunk_ids || NULL == chunks) {
             SR_LOG_ERR("Unable to allocate memory in %s", __func__);
             rc = SR_ERR_NOMEM;
         } else {
-            rc = rp_dt_get_subtree_wrapper_with_opts(rp_ctx, session, sr_mem, xpath, slice_offset, slice_width, child_limit,
-                    depth_limit, &chunks, &chunk_ids[0]);
+            rc = rp_dt_get_subtree_gpb_wrapper(rp_ctx, session, sr_mem, xpath, slice_offset, slice_width, child_limit,
+                    depth_limit, &chunks[0], &chunk_ids[0]);
             if (SR_ERR_OK == rc) {
                 chunk_cnt = 1;
-            } else {
-                if (NULL == sr_mem) {
-                    free(chunk_ids);
-                }
-                chunk_ids = NULL;
             }
         }
+        if (SR_ERR_OK != rc) {
+            if (NULL == sr_mem) {
+                free(chunk_ids);
+                free(chunks);
+            }
+            chunk_ids = NULL;
+            chunks = NULL;
+        }
     } else {
-        rc = rp_dt_get_subtrees_wrapper_with_opts(rp_ctx, session, sr_mem, xpath, slice_offset, slice_width, child_limit,
+        rc = rp_dt_get_subtrees_gpb_wrapper(rp_ctx, session, sr_mem, xpath, slice_offset, slice_width, child_limit,
                 depth_limit, &chunks, &chunk_cnt, &chunk_ids);
     }
     if (SR_ERR_OK != rc && SR_ERR_NOT_FOUND != rc) {
@@ -849,11 +874,12 @@ rp_get_subtree_chunk_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Ms
         *skip_msg_cleanup = true;
         /* setup timeout */
         rc = rp_set_oper_request_timeout(rp_ctx, session, msg, RP_OPER_DATA_REQ_TIMEOUT);
-        sr_free_trees(chunks, chunk_cnt);
-        if (NULL == sr_mem && chunk_ids) {
+        if (NULL == sr_mem) {
             for (size_t i = 0; i < chunk_cnt; ++i) {
+                sr__node__free_unpacked(chunks[i], NULL);
                 free(chunk_ids[i]);
             }
+            free(chunks);
             free(chunk_ids);
         }
         sr_msg_free(resp);
@@ -863,14 +889,9 @@ rp_get_subtree_chunk_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Ms
 
     pthread_mutex_unlock(&session->cur_req_mutex);
 
-    /* copy chunk(s) to gpb */
-    if (SR_ERR_OK == rc) {
-        rc = sr_trees_sr_to_gpb(chunks, chunk_cnt, &resp->response->get_subtree_chunk_resp->chunk,
-                &resp->response->get_subtree_chunk_resp->n_chunk);
-        if (SR_ERR_OK != rc) {
-            SR_LOG_ERR("Copying subtree chunk(s) to gpb failed for xpath '%s'", xpath);
-        }
-    }
+    /* chunk(s) have been built directly as gpb */
+    resp->response->get_subtree_chunk_resp->chunk = chunks;
+    resp->response->get_subtree_chunk_resp->n_chunk = chunk_cnt;
     resp->response->get_subtree_chunk_resp->n_xpath = chunk_cnt;
     resp->response->get_subtree_chunk_resp->xpath = chunk_ids;
 
@@ -884,8 +905,7 @@ cleanup:
         SR_LOG_ERR_MSG("Copying errors to gpb failed");
     }
 
-    sr_free_trees(chunks, chunk_cnt);
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -948,7 +968,7 @@ rp_set_item_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -995,7 +1015,7 @@ rp_delete_item_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1041,7 +1061,7 @@ rp_move_item_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1089,7 +1109,7 @@ rp_validate_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1165,7 +1185,7 @@ cleanup:
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
     return rc;
 }
 
@@ -1204,7 +1224,7 @@ rp_discard_changes_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *sessi
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1246,7 +1266,7 @@ rp_copy_config_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1291,7 +1311,7 @@ rp_session_refresh_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1328,7 +1348,7 @@ rp_switch_datastore_req_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1368,7 +1388,7 @@ rp_session_set_opts(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1408,7 +1428,7 @@ rp_lock_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr__Msg
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1454,7 +1474,7 @@ rp_unlock_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr__M
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1497,6 +1517,9 @@ rp_subscribe_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr
     if (subscribe_req->has_enable_event && subscribe_req->enable_event) {
         options |= NP_SUBSCR_EV_EVENT;
     }
+    if (subscribe_req->has_push_changes && subscribe_req->push_changes) {
+        options |= NP_SUBSCR_PUSH_CHANGES;
+    }
 
     /* subscribe to the notification */
     rc = np_notification_subscribe(rp_ctx->np_ctx, session, subscribe_req->type,
@@ -1516,7 +1539,7 @@ rp_subscribe_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     if (SR_ERR_OK == rc) {
         /* send initial HELLO notification to test the subscription */
@@ -1565,7 +1588,7 @@ rp_unsubscribe_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session,
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -1611,7 +1634,7 @@ rp_check_enabled_running_req_process(const rp_ctx_t *rp_ctx, const rp_session_t
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
     return rc;
 }
 
@@ -1695,7 +1718,7 @@ cleanup:
     }
 
     /* send the response */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     sr_list_cleanup(changes);
     return rc;
@@ -1725,7 +1748,7 @@ rp_match_subscription_rpc(const rp_ctx_t *rp_ctx, np_subscription_t *subscriptio
 
 cleanup:
     if (NULL != schema_info) {
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
     }
     return rc;
 }
@@ -1816,7 +1839,7 @@ rp_rpc_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr__Msg
     /* fill-in subscription details into the request */
     bool subscription_match = false;
     /* get RPC/Action subscription */
-    rc = pm_get_subscriptions(rp_ctx->pm_ctx, module_name,
+    rc = np_get_subscriptions(rp_ctx->np_ctx, module_name,
             action ? SR__SUBSCRIPTION_TYPE__ACTION_SUBS : SR__SUBSCRIPTION_TYPE__RPC_SUBS,
             &subscriptions, &subscription_cnt);
     CHECK_RC_LOG_GOTO(rc, finalize, "Failed to get subscriptions for %s request (%s).", op_name,
@@ -1896,6 +1919,9 @@ finalize:
         sr_msg_free(msg);
         /* forward the request to the subscriber */
         rc = cm_msg_send(rp_ctx->cm_ctx, req);
+        if (SR_ERR_OK == rc) {
+            rp_stats_notification(rp_ctx, RP_STATS_NOTIF_RPC);
+        }
     } else {
         /* release the request */
         if (NULL != req) {
@@ -1922,7 +1948,7 @@ finalize:
             /* release the message since it won't be released in dispatch */
             sr_msg_free(msg);
             /* send the response */
-            rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+            rc = rp_resp_send(rp_ctx, session, resp);
         }
     }
 
@@ -1987,7 +2013,7 @@ rp_data_provide_resp_validate (rp_ctx_t *rp_ctx, rp_session_t *session, const ch
     }
 
 unlock:
-    pthread_rwlock_unlock(&si->model_lock);
+    sr_rwlock_unlock(&si->model_lock);
     return rc;
 }
 
@@ -2245,7 +2271,7 @@ rp_rpc_resp_process(const rp_ctx_t *rp_ctx, const rp_session_t *session, Sr__Msg
     }
 
     /* forward RPC/Action response to the originator */
-    rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+    rc = rp_resp_send(rp_ctx, session, resp);
 
     return rc;
 }
@@ -2364,7 +2390,7 @@ rp_event_notif_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session,
     CHECK_RC_LOG_GOTO(rc, finalize, "Access control check failed for module name '%s'", module_name);
 
     /* get event-notification subscriptions */
-    rc = pm_get_subscriptions(rp_ctx->pm_ctx, module_name, SR__SUBSCRIPTION_TYPE__EVENT_NOTIF_SUBS,
+    rc = np_get_subscriptions(rp_ctx->np_ctx, module_name, SR__SUBSCRIPTION_TYPE__EVENT_NOTIF_SUBS,
             &subscriptions, &subscription_cnt);
     CHECK_RC_LOG_GOTO(rc, finalize, "Failed to get subscriptions for event notification request (%s).",
                       msg->request->event_notif_req->xpath);
@@ -2408,6 +2434,9 @@ rp_event_notif_req_process(const rp_ctx_t *rp_ctx, const rp_session_t *session,
             rc = cm_msg_send(rp_ctx->cm_ctx, req);
             req = NULL;
             sub_match = true;
+            if (SR_ERR_OK == rc) {
+                rp_stats_notification(rp_ctx, RP_STATS_NOTIF_EVENT);
+            }
         }
     }
 
@@ -2438,7 +2467,7 @@ finalize:
     sr_msg_free(msg);
     if (SR_ERR_OK == rc_tmp) {
         resp->response->result = rc;
-        rc = cm_msg_send(rp_ctx->cm_ctx, resp);
+        rc = rp_resp_send(rp_ctx, session, resp);
     }
 
     return rc;
@@ -2510,11 +2539,11 @@ rp_req_dispatch(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg, bool *ski
         case SR__OPERATION__DELETE_ITEM:
         case SR__OPERATION__MOVE_ITEM:
         case SR__OPERATION__SESSION_REFRESH:
-            pthread_rwlock_rdlock(&rp_ctx->commit_lock);
+            sr_rwlock_rdlock(&rp_ctx->commit_lock);
             locked = true;
             break;
         case SR__OPERATION__COMMIT:
-            pthread_rwlock_wrlock(&rp_ctx->commit_lock);
+            sr_rwlock_wrlock(&rp_ctx->commit_lock);
             locked = true;
             break;
         default:
@@ -2615,7 +2644,7 @@ rp_req_dispatch(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg, bool *ski
 
     /* release lock */
     if (locked) {
-        pthread_rwlock_unlock(&rp_ctx->commit_lock);
+        sr_rwlock_unlock(&rp_ctx->commit_lock);
     }
 
     return rc;
@@ -2681,6 +2710,338 @@ rp_internal_req_dispatch(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
     return rc;
 }
 
+/**
+ * @brief Returns the xpath that the request is addressed to (NULL if there is none).
+ */
+static const char *
+rp_req_xpath(const Sr__Request *req)
+{
+    switch (req->operation) {
+        case SR__OPERATION__GET_ITEM:
+            return NULL != req->get_item_req ? req->get_item_req->xpath : NULL;
+        case SR__OPERATION__GET_ITEMS:
+            return NULL != req->get_items_req ? req->get_items_req->xpath : NULL;
+        case SR__OPERATION__GET_SUBTREE:
+            return NULL != req->get_subtree_req ? req->get_subtree_req->xpath : NULL;
+        case SR__OPERATION__GET_SUBTREES:
+            return NULL != req->get_subtrees_req ? req->get_subtrees_req->xpath : NULL;
+        case SR__OPERATION__GET_SUBTREE_CHUNK:
+            return NULL != req->get_subtree_chunk_req ? req->get_subtree_chunk_req->xpath : NULL;
+        case SR__OPERATION__SET_ITEM:
+            return NULL != req->set_item_req ? req->set_item_req->xpath : NULL;
+        case SR__OPERATION__DELETE_ITEM:
+            return NULL != req->delete_item_req ? req->delete_item_req->xpath : NULL;
+        case SR__OPERATION__MOVE_ITEM:
+            return NULL != req->move_item_req ? req->move_item_req->xpath : NULL;
+        case SR__OPERATION__GET_CHANGES:
+            return NULL != req->get_changes_req ? req->get_changes_req->xpath : NULL;
+        case SR__OPERATION__RPC:
+        case SR__OPERATION__ACTION:
+            return NULL != req->rpc_req ? req->rpc_req->xpath : NULL;
+        case SR__OPERATION__EVENT_NOTIF:
+            return NULL != req->event_notif_req ? req->event_notif_req->xpath : NULL;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Returns TRUE if the request is processed over the data tree of the module it is addressed to.
+ */
+static bool
+rp_req_uses_data_tree(Sr__Operation operation)
+{
+    switch (operation) {
+        case SR__OPERATION__GET_ITEM:
+        case SR__OPERATION__GET_ITEMS:
+        case SR__OPERATION__GET_SUBTREE:
+        case SR__OPERATION__GET_SUBTREES:
+        case SR__OPERATION__GET_SUBTREE_CHUNK:
+        case SR__OPERATION__SET_ITEM:
+        case SR__OPERATION__DELETE_ITEM:
+        case SR__OPERATION__MOVE_ITEM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Returns TRUE if the request message is released by its processing function
+ * (the request is forwarded to subscribers and its processing is finished).
+ */
+static bool
+rp_req_consumes_msg(Sr__Operation operation)
+{
+    return SR__OPERATION__RPC == operation || SR__OPERATION__ACTION == operation ||
+            SR__OPERATION__EVENT_NOTIF == operation;
+}
+
+/**
+ * @brief Marks the start of request processing in the session. If the request resumes
+ * after waiting for data providers or verifiers, accounts the waiting time.
+ */
+static void
+rp_req_timing_start(rp_session_t *session)
+{
+    struct timespec now = { 0, };
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&session->cur_req_mutex);
+    if (RP_REQ_WAITING_FOR_DATA == session->state || RP_REQ_DATA_LOADED == session->state ||
+            RP_REQ_RESUMED == session->state) {
+        session->req_wait_time += sr_clock_elapsed_us(&session->req_wait_start);
+    } else {
+        session->req_start = now;
+        session->req_wait_time = 0;
+    }
+    pthread_mutex_unlock(&session->cur_req_mutex);
+}
+
+/**
+ * @brief Counts the nodes of a data tree (including siblings of the root).
+ */
+static size_t
+rp_data_tree_node_count(struct lyd_node *data_tree)
+{
+    struct lyd_node *root = NULL, *next = NULL, *iter = NULL;
+    size_t count = 0;
+
+    LY_TREE_FOR(data_tree, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            ++count;
+            LYD_TREE_DFS_END(root, next, iter);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Logs a request whose processing took longer than the configured threshold.
+ */
+static void
+rp_log_slow_request(rp_session_t *session, Sr__Operation operation, const char *xpath,
+        uint64_t total_time, uint64_t wait_time, int result)
+{
+    const char *user = NULL;
+    char *module_name = NULL;
+    struct lyd_node *data_tree = NULL;
+    char tree_size[21] = "n/a";
+    bool oper_data = false;
+
+    if (NULL != session->user_credentials) {
+        user = NULL != session->user_credentials->e_username ? session->user_credentials->e_username :
+                session->user_credentials->r_username;
+    }
+    if (NULL != xpath) {
+        sr_copy_first_ns(xpath, &module_name);
+    }
+    /* report only the tree already loaded by the request, do not load anything when logging */
+    if (NULL != module_name && rp_req_uses_data_tree(operation) &&
+            SR_ERR_OK == dm_get_loaded_datatree(session->dm_session, module_name, &data_tree)) {
+        snprintf(tree_size, sizeof tree_size, "%zu", rp_data_tree_node_count(data_tree));
+    }
+    oper_data = session->loaded_state_data[session->datastore]->count > 0;
+
+    SR_LOG_WRN("Slow request: session=%"PRIu32" user=%s operation=%s xpath=%s module=%s data-tree-nodes=%s "
+            "oper-data=%s wait=%"PRIu64" total=%"PRIu64" result=%s", session->id, NULL != user ? user : "?",
+            sr_gpb_operation_name(operation), NULL != xpath ? xpath : "-", NULL != module_name ? module_name : "-",
+            tree_size, oper_data ? "yes" : "no", wait_time, total_time, sr_strerror(result));
+
+    free(module_name);
+}
+
+/**
+ * @brief Finishes accounting of a request: updates the statistics and logs the request
+ * if it was slow. Processing time does not include waiting for data providers and verifiers.
+ */
+static void
+rp_req_timing_finish(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Operation operation, const char *xpath, int result)
+{
+    uint64_t total_time = 0, wait_time = 0;
+
+    pthread_mutex_lock(&session->cur_req_mutex);
+    total_time = sr_clock_elapsed_us(&session->req_start);
+    wait_time = session->req_wait_time;
+    pthread_mutex_unlock(&session->cur_req_mutex);
+
+    rp_stats_request(rp_ctx, operation, total_time > wait_time ? total_time - wait_time : 0, SR_ERR_OK != result);
+
+    if (0 != rp_ctx->slow_request_threshold && total_time >= (uint64_t) rp_ctx->slow_request_threshold * 1000) {
+        rp_log_slow_request(session, operation, xpath, total_time, wait_time, result);
+    }
+}
+
+/**
+ * @brief Evicts unmodified data trees of the session above the memory budget if the session
+ * is not processing any request. Trees holding state data loaded for the session are kept.
+ *
+ * @param [in] rp_ctx
+ * @param [in] session
+ * @param [in] own_msgs Number of messages of the session being processed by the caller.
+ * @param [in] wait Wait for the session, otherwise a busy session is skipped.
+ */
+static void
+rp_session_trim_idle(rp_ctx_t *rp_ctx, rp_session_t *session, uint32_t own_msgs, bool wait)
+{
+    sr_list_t *keep_modules = NULL;
+    const char *module_name = NULL;
+    size_t evicted = 0;
+    bool idle = false;
+    int rc = SR_ERR_OK;
+
+    if (wait) {
+        pthread_mutex_lock(&session->msg_count_mutex);
+    } else if (0 != pthread_mutex_trylock(&session->msg_count_mutex)) {
+        return;
+    }
+    /* new messages of the session are not enqueued until the trim is finished */
+    if (session->stop_requested || session->msg_count > own_msgs) {
+        goto unlock;
+    }
+
+    pthread_mutex_lock(&session->cur_req_mutex);
+    idle = RP_REQ_NEW == session->state || RP_REQ_FINISHED == session->state;
+    for (size_t ds = 0; idle && SR_ERR_OK == rc && ds < DM_DATASTORE_COUNT; ds++) {
+        /* state data are kept in the tree until the next request of the session */
+        for (size_t i = 0; SR_ERR_OK == rc && i < session->loaded_state_data[ds]->count; i++) {
+            if (NULL == keep_modules) {
+                rc = sr_list_init(&keep_modules);
+            }
+            if (SR_ERR_OK == rc) {
+                rc = sr_intern_first_ns(session->loaded_state_data[ds]->data[i], &module_name);
+            }
+            if (SR_ERR_OK == rc) {
+                rc = sr_list_add(keep_modules, (void *) module_name);
+                if (SR_ERR_OK != rc) {
+                    sr_str_release(module_name);
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&session->cur_req_mutex);
+
+    if (idle && SR_ERR_OK == rc) {
+        rc = dm_session_trim(rp_ctx->dm_ctx, session->dm_session, keep_modules, &evicted);
+    }
+    if (SR_ERR_OK != rc) {
+        SR_LOG_WRN("Trimming of data trees failed for session id=%"PRIu32": %s.", session->id, sr_strerror(rc));
+    }
+    if (evicted > 0) {
+        /* nodes cached by get_items_iter may belong to an evicted tree */
+        ly_set_free(session->get_items_ctx.nodes);
+        session->get_items_ctx.nodes = NULL;
+        free(session->get_items_ctx.xpath);
+        session->get_items_ctx.xpath = NULL;
+        session->get_items_ctx.offset = 0;
+    }
+
+    if (NULL != keep_modules) {
+        for (size_t i = 0; i < keep_modules->count; i++) {
+            sr_str_release(keep_modules->data[i]);
+        }
+        sr_list_cleanup(keep_modules);
+    }
+
+unlock:
+    pthread_mutex_unlock(&session->msg_count_mutex);
+}
+
+/**
+ * @brief Compares sessions by the time of completion of their last request (oldest first).
+ */
+static int
+rp_session_idle_cmp(const void *a, const void *b)
+{
+    const rp_session_t *sess_a = *(rp_session_t * const *) a, *sess_b = *(rp_session_t * const *) b;
+
+    if (sess_a->req_end.tv_sec != sess_b->req_end.tv_sec) {
+        return sess_a->req_end.tv_sec < sess_b->req_end.tv_sec ? -1 : 1;
+    }
+    if (sess_a->req_end.tv_nsec != sess_b->req_end.tv_nsec) {
+        return sess_a->req_end.tv_nsec < sess_b->req_end.tv_nsec ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns true if the data trees of all sessions exceed the global memory budget.
+ */
+static bool
+rp_mem_over_budget(rp_ctx_t *rp_ctx)
+{
+    dm_mem_stats_t mem_stats = { 0 };
+
+    dm_get_mem_stats(rp_ctx->dm_ctx, &mem_stats);
+    return 0 != mem_stats.global_budget && mem_stats.used > mem_stats.global_budget;
+}
+
+/**
+ * @brief Trims data trees of the sessions other than the current one, the longest idle first,
+ * until the global memory budget is met. Sessions processing a request are skipped.
+ */
+static void
+rp_sessions_trim(rp_ctx_t *rp_ctx, rp_session_t *current)
+{
+    sr_llist_node_t *node = NULL;
+    rp_session_t **victims = NULL, *session = NULL;
+    dm_mem_usage_t usage = { 0 };
+    size_t victim_cnt = 0, i = 0;
+
+    pthread_mutex_lock(&rp_ctx->session_list->mutex);
+
+    for (node = rp_ctx->session_list->sessions->first; NULL != node; node = node->next) {
+        victim_cnt++;
+    }
+    victims = calloc(victim_cnt, sizeof *victims);
+    if (NULL == victims) {
+        SR_LOG_WRN_MSG("Unable to allocate the list of sessions to trim.");
+        goto unlock;
+    }
+
+    victim_cnt = 0;
+    for (node = rp_ctx->session_list->sessions->first; NULL != node; node = node->next) {
+        session = node->data;
+        dm_get_session_mem_usage(session->dm_session, &usage);
+        if (current != session && usage.mem_size > 0) {
+            victims[victim_cnt++] = session;
+        }
+    }
+    qsort(victims, victim_cnt, sizeof *victims, rp_session_idle_cmp);
+
+    for (i = 0; i < victim_cnt && rp_mem_over_budget(rp_ctx); i++) {
+        rp_session_trim_idle(rp_ctx, victims[i], 0, false);
+    }
+
+unlock:
+    pthread_mutex_unlock(&rp_ctx->session_list->mutex);
+    free(victims);
+}
+
+/**
+ * @brief Evicts unmodified data trees above the memory budget. Called when a request
+ * of the session has been completed, the trees are not in use by the session then.
+ * If the global budget is still exceeded, trees of other idle sessions are evicted.
+ */
+static void
+rp_session_trim(rp_ctx_t *rp_ctx, rp_session_t *session)
+{
+    struct timespec now = { 0 };
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock(&rp_ctx->session_list->mutex);
+    session->req_end = now;
+    pthread_mutex_unlock(&rp_ctx->session_list->mutex);
+
+    rp_session_trim_idle(rp_ctx, session, 1, true);
+
+    if (rp_mem_over_budget(rp_ctx)) {
+        rp_sessions_trim(rp_ctx, session);
+    }
+}
+
 /**
  * @brief Dispatches the received message.
  */
@@ -2689,6 +3050,9 @@ rp_msg_dispatch(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
 {
     int rc = SR_ERR_OK;
     bool skip_msg_cleanup = false;
+    Sr__Operation operation = 0;
+    char *xpath_copy = NULL;
+    const char *xpath = NULL;
 
     CHECK_NULL_ARG2(rp_ctx, msg);
 
@@ -2720,7 +3084,20 @@ rp_msg_dispatch(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
 
     switch (msg->type) {
         case SR__MSG__MSG_TYPE__REQUEST:
+            operation = msg->request->operation;
+            xpath = rp_req_xpath(msg->request);
+            if (rp_req_consumes_msg(operation) && 0 != rp_ctx->slow_request_threshold && NULL != xpath) {
+                /* the message is released during processing */
+                xpath = xpath_copy = strdup(xpath);
+            }
+            rp_req_timing_start(session);
             rc = rp_req_dispatch(rp_ctx, session, msg, &skip_msg_cleanup);
+            if (!skip_msg_cleanup || rp_req_consumes_msg(operation)) {
+                /* requests waiting for data providers or verifiers are accounted when resumed */
+                rp_req_timing_finish(rp_ctx, session, operation, xpath, rc);
+                rp_session_trim(rp_ctx, session);
+            }
+            free(xpath_copy);
             break;
         case SR__MSG__MSG_TYPE__RESPONSE:
             rc = rp_resp_dispatch(rp_ctx, session, msg, &skip_msg_cleanup);
@@ -2767,7 +3144,7 @@ rp_session_cleanup(const rp_ctx_t *rp_ctx, rp_session_t *session)
     pthread_mutex_destroy(&session->msg_count_mutex);
     pthread_mutex_destroy(&session->cur_req_mutex);
     free(session->change_ctx.xpath);
-    free(session->module_name);
+    sr_str_release(session->module_name);
     if (NULL != session->req) {
         sr_msg_free(session->req);
     }
@@ -2801,86 +3178,120 @@ rp_worker_thread_execute(void *rp_ctx_p)
 
     SR_LOG_DBG("Starting worker thread id=%lu.", (unsigned long)pthread_self());
 
-    pthread_mutex_lock(&rp_ctx->request_queue_mutex);
-    rp_ctx->active_threads++;
-    pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
+    __atomic_add_fetch(&rp_ctx->active_threads, 1, __ATOMIC_SEQ_CST);
 
     do {
-        /* process requests while there are some */
-        dequeued_prev = false;
-        do {
-            /* dequeue a request */
-            pthread_mutex_lock(&rp_ctx->request_queue_mutex);
-            dequeued = sr_cbuff_dequeue(rp_ctx->request_queue, &req);
-            pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
-
-            if (dequeued) {
-                /* process the request */
-                if (NULL == req.msg) {
-                    SR_LOG_DBG("Thread id=%lu received an empty request, exiting.", (unsigned long)pthread_self());
-                    exit = true;
-                } else {
-                    rp_msg_dispatch(rp_ctx, req.session, req.msg);
-                    if (NULL != req.session) {
-                        /* update message count and release session if needed */
-                        pthread_mutex_lock(&req.session->msg_count_mutex);
-                        req.session->msg_count -= 1;
-                        if (0 == req.session->msg_count && req.session->stop_requested) {
-                            pthread_mutex_unlock(&req.session->msg_count_mutex);
-                            rp_session_cleanup(rp_ctx, req.session);
-                        } else {
-                            pthread_mutex_unlock(&req.session->msg_count_mutex);
-                        }
-                    }
-                }
-                dequeued_prev = true;
-            } else {
-                /* no items in queue - spin for a while */
-                if (dequeued_prev) {
-                    /* only if the thread has actually processed something since the last wakeup */
-                    size_t count = 0;
-                    while ((0 == sr_cbuff_items_in_queue(rp_ctx->request_queue)) && (count < rp_ctx->thread_spin_limit)) {
-                        count++;
-                    }
-                }
-                pthread_mutex_lock(&rp_ctx->request_queue_mutex);
-                if (0 != sr_cbuff_items_in_queue(rp_ctx->request_queue)) {
-                    /* some items are in queue - process them */
-                    pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
-                    dequeued = true;
-                    continue;
-                } else {
-                    /* no items in queue - go to sleep */
-                    rp_ctx->active_threads--;
-                    pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
-                }
+        /* dequeue a request */
+        dequeued = sr_ring_dequeue(rp_ctx->request_queue, &req);
+
+        if (!dequeued && dequeued_prev) {
+            /* no items in queue - spin for a while, only if the thread has actually
+             * processed something since the last wakeup */
+            size_t count = 0, spin_limit = __atomic_load_n(&rp_ctx->thread_spin_limit, __ATOMIC_RELAXED);
+            while ((0 == sr_ring_count(rp_ctx->request_queue)) && (count < spin_limit)) {
+                count++;
             }
-        } while (dequeued && !exit);
+            dequeued = sr_ring_dequeue(rp_ctx->request_queue, &req);
+        }
 
-        if (!exit) {
-            /* wait until new request comes */
+        if (!dequeued) {
+            /* no items in queue - go to sleep until new request comes */
             SR_LOG_DBG("Thread id=%lu will wait.",  (unsigned long)pthread_self());
+            __atomic_sub_fetch(&rp_ctx->active_threads, 1, __ATOMIC_SEQ_CST);
+            sr_ring_dequeue_wait(rp_ctx->request_queue, &req);
+            __atomic_add_fetch(&rp_ctx->active_threads, 1, __ATOMIC_SEQ_CST);
+            SR_LOG_DBG("Thread id=%lu signaled.",  (unsigned long)pthread_self());
+        }
+        dequeued_prev = true;
 
-            /* wait for a signal */
-            pthread_mutex_lock(&rp_ctx->request_queue_mutex);
-            if (rp_ctx->stop_requested) {
-                /* stop has been requested, do not wait anymore */
-                pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
-                break;
+        /* process the request */
+        if (NULL == req.msg) {
+            SR_LOG_DBG("Thread id=%lu received an empty request, exiting.", (unsigned long)pthread_self());
+            exit = true;
+        } else {
+            rp_msg_dispatch(rp_ctx, req.session, req.msg);
+            if (NULL != req.session) {
+                /* update message count and release session if needed */
+                pthread_mutex_lock(&req.session->msg_count_mutex);
+                req.session->msg_count -= 1;
+                if (0 == req.session->msg_count && req.session->stop_requested) {
+                    pthread_mutex_unlock(&req.session->msg_count_mutex);
+                    rp_session_cleanup(rp_ctx, req.session);
+                } else {
+                    pthread_mutex_unlock(&req.session->msg_count_mutex);
+                }
             }
-            pthread_cond_wait(&rp_ctx->request_queue_cv, &rp_ctx->request_queue_mutex);
-            rp_ctx->active_threads++;
-
-            SR_LOG_DBG("Thread id=%lu signaled.",  (unsigned long)pthread_self());
-            pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
         }
     } while (!exit);
 
+    __atomic_sub_fetch(&rp_ctx->active_threads, 1, __ATOMIC_SEQ_CST);
+
     SR_LOG_DBG("Worker thread id=%lu is exiting.",  (unsigned long)pthread_self());
 
     return NULL;
 }
 
+/**
+ * @brief Releases the list of sessions, the sessions themselves are not released.
+ */
+static void
+rp_session_list_cleanup(rp_session_list_t *session_list)
+{
+    if (NULL != session_list) {
+        if (NULL != session_list->sessions) {
+            sr_llist_cleanup(session_list->sessions);
+            pthread_mutex_destroy(&session_list->mutex);
+        }
+        free(session_list);
+    }
+}
+
+/**
+ * @brief Adds the session to the list of active sessions or removes it from the list.
+ */
+static void
+rp_session_list_update(const rp_ctx_t *rp_ctx, rp_session_t *session, bool add)
+{
+    pthread_mutex_lock(&rp_ctx->session_list->mutex);
+    if (add) {
+        if (SR_ERR_OK == sr_llist_add_new(rp_ctx->session_list->sessions, session)) {
+            session->ll_node = rp_ctx->session_list->sessions->last;
+        } else {
+            SR_LOG_WRN("Unable to add session id=%"PRIu32" to the list of sessions.", session->id);
+        }
+    } else if (NULL != session->ll_node) {
+        sr_llist_rm(rp_ctx->session_list->sessions, session->ll_node);
+        session->ll_node = NULL;
+    }
+    pthread_mutex_unlock(&rp_ctx->session_list->mutex);
+}
+
+/**
+ * @brief Reads the threshold of the slow request log (in milliseconds) from the environment variable.
+ * Falls back to the default if the variable is not set or does not hold a valid non-negative number.
+ */
+static uint32_t
+rp_slow_request_threshold_from_env()
+{
+    const char *env_str = getenv(RP_SLOW_REQUEST_THRESHOLD_ENV);
+    char *endptr = NULL;
+    unsigned long value = 0;
+
+    if (NULL == env_str) {
+        return SR_SLOW_REQUEST_THRESHOLD;
+    }
+
+    errno = 0;
+    value = strtoul(env_str, &endptr, 10);
+    if (0 != errno || endptr == env_str || '\0' != *endptr || NULL != strchr(env_str, '-') || value > UINT32_MAX) {
+        SR_LOG_WRN("Invalid value '%s' of %s, using the default threshold of %u ms.", env_str,
+                RP_SLOW_REQUEST_THRESHOLD_ENV, (unsigned) SR_SLOW_REQUEST_THRESHOLD);
+        return SR_SLOW_REQUEST_THRESHOLD;
+    }
+
+    return (uint32_t) value;
+}
+
 int
 rp_init(cm_ctx_t *cm_ctx, rp_ctx_t **rp_ctx_p)
 {
@@ -2900,6 +3311,23 @@ rp_init(cm_ctx_t *cm_ctx, rp_ctx_t **rp_ctx_p)
     }
     ctx->cm_ctx = cm_ctx;
 
+    /* initialize engine statistics */
+    rc = rp_stats_init(&ctx->stats);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR_MSG("Engine statistics initialization failed.");
+        goto cleanup;
+    }
+
+    /* initialize the list of sessions */
+    ctx->session_list = calloc(1, sizeof *ctx->session_list);
+    CHECK_NULL_NOMEM_GOTO(ctx->session_list, rc, cleanup);
+    rc = sr_llist_init(&ctx->session_list->sessions);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Session list initialization failed.");
+    pthread_mutex_init(&ctx->session_list->mutex, NULL);
+
+    /* get threshold of the slow request log from environment variable, or use default one */
+    ctx->slow_request_threshold = rp_slow_request_threshold_from_env();
+
     /* initialize access control module */
     rc = ac_init(SR_DATA_SEARCH_DIR, &ctx->ac_ctx);
     if (SR_ERR_OK != rc) {
@@ -2908,7 +3336,7 @@ rp_init(cm_ctx_t *cm_ctx, rp_ctx_t **rp_ctx_p)
     }
 
     /* initialize request queue */
-    rc = sr_cbuff_init(RP_INIT_REQ_QUEUE_SIZE, sizeof(rp_request_t), &ctx->request_queue);
+    rc = sr_ring_init(RP_REQ_QUEUE_SIZE, sizeof(rp_request_t), SR_RING_MPMC, &ctx->request_queue);
     if (SR_ERR_OK != rc) {
         SR_LOG_ERR_MSG("RP request queue initialization failed.");
         goto cleanup;
@@ -2922,6 +3350,7 @@ rp_init(cm_ctx_t *cm_ctx, rp_ctx_t **rp_ctx_p)
     ret = pthread_rwlock_init(&ctx->commit_lock, &attr);
     pthread_rwlockattr_destroy(&attr);
     CHECK_ZERO_MSG_GOTO(ret, rc, SR_ERR_INIT_FAILED, cleanup, "Commit rwlock initialization failed.");
+    sr_lockstat_register(&ctx->commit_lock, "commit_lock");
 
     /* initialize Notification Processor */
     rc = np_init(ctx, &ctx->np_ctx);
@@ -2931,7 +3360,8 @@ rp_init(cm_ctx_t *cm_ctx, rp_ctx_t **rp_ctx_p)
     }
 
     /* initialize Persistence Manager */
-    rc = pm_init(ctx, SR_INTERNAL_SCHEMA_SEARCH_DIR, SR_DATA_SEARCH_DIR, &ctx->pm_ctx);
+    rc = pm_init(ctx, cm_ctx ? cm_get_connection_mode(cm_ctx) : CM_MODE_LOCAL, SR_INTERNAL_SCHEMA_SEARCH_DIR,
+            SR_DATA_SEARCH_DIR, &ctx->pm_ctx);
     if (SR_ERR_OK != rc) {
         SR_LOG_ERR_MSG("Persistence Manager initialization failed.");
         goto cleanup;
@@ -2945,9 +3375,14 @@ rp_init(cm_ctx_t *cm_ctx, rp_ctx_t **rp_ctx_p)
         goto cleanup;
     }
 
+    /* make the engine statistics readable, they are not essential for the engine */
+    if (SR_ERR_OK != rp_stats_enable(ctx)) {
+        SR_LOG_WRN("Engine statistics are not available, module %s could not be enabled.", RP_STATS_MODULE_NAME);
+    }
+
     /* run worker threads */
-    pthread_mutex_init(&ctx->request_queue_mutex, NULL);
-    pthread_cond_init(&ctx->request_queue_cv, NULL);
+    pthread_mutex_init(&ctx->thread_wakeup_mutex, NULL);
+    sr_lockstat_register(&ctx->thread_wakeup_mutex, "thread_wakeup_mutex");
 
     for (i = 0; i < RP_THREAD_COUNT; i++) {
         rc = pthread_create(&ctx->thread_pool[i], NULL, rp_worker_thread_execute, ctx);
@@ -2969,7 +3404,9 @@ cleanup:
     np_cleanup(ctx->np_ctx);
     pm_cleanup(ctx->pm_ctx);
     ac_cleanup(ctx->ac_ctx);
-    sr_cbuff_cleanup(ctx->request_queue);
+    sr_ring_cleanup(ctx->request_queue);
+    rp_stats_cleanup(ctx->stats);
+    rp_session_list_cleanup(ctx->session_list);
     free(ctx);
     return rc;
 }
@@ -2983,34 +3420,33 @@ rp_cleanup(rp_ctx_t *rp_ctx)
     SR_LOG_DBG_MSG("Request Processor cleanup started, requesting cancel of each worker thread.");
 
     if (NULL != rp_ctx) {
-        /* enqueue RP_THREAD_COUNT "empty" messages and send signal to all threads */
-        pthread_mutex_lock(&rp_ctx->request_queue_mutex);
-        rp_ctx->stop_requested = true;
-        /* enqueue empty requests to request thread exits */
+        /* enqueue RP_THREAD_COUNT "empty" messages to request thread exits and wake up all threads */
         for (i = 0; i < RP_THREAD_COUNT; i++) {
-            sr_cbuff_enqueue(rp_ctx->request_queue, &req);
+            sr_ring_enqueue(rp_ctx->request_queue, &req);
         }
-        pthread_cond_broadcast(&rp_ctx->request_queue_cv);
-        pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
+        sr_ring_wake(rp_ctx->request_queue, RP_THREAD_COUNT);
 
         /* wait for threads to exit */
         for (i = 0; i < RP_THREAD_COUNT; i++) {
             pthread_join(rp_ctx->thread_pool[i], NULL);
         }
-        pthread_mutex_destroy(&rp_ctx->request_queue_mutex);
-        pthread_cond_destroy(&rp_ctx->request_queue_cv);
+        sr_lockstat_unregister(&rp_ctx->thread_wakeup_mutex);
+        pthread_mutex_destroy(&rp_ctx->thread_wakeup_mutex);
 
-        while (sr_cbuff_dequeue(rp_ctx->request_queue, &req)) {
+        while (sr_ring_dequeue(rp_ctx->request_queue, &req)) {
             if (NULL != req.msg) {
                 sr_msg_free(req.msg);
             }
         }
+        sr_lockstat_unregister(&rp_ctx->commit_lock);
         pthread_rwlock_destroy(&rp_ctx->commit_lock);
         dm_cleanup(rp_ctx->dm_ctx);
         np_cleanup(rp_ctx->np_ctx);
         pm_cleanup(rp_ctx->pm_ctx);
         ac_cleanup(rp_ctx->ac_ctx);
-        sr_cbuff_cleanup(rp_ctx->request_queue);
+        sr_ring_cleanup(rp_ctx->request_queue);
+        rp_stats_cleanup(rp_ctx->stats);
+        rp_session_list_cleanup(rp_ctx->session_list);
         free(rp_ctx);
     }
 
@@ -3057,6 +3493,8 @@ rp_session_start(const rp_ctx_t *rp_ctx, const uint32_t session_id, const ac_ucr
     CHECK_RC_LOG_GOTO(rc, cleanup, "Init of dm_session failed for session id=%"PRIu32".", session_id);
 
     *session_p = session;
+    rp_stats_session(rp_ctx, session, true);
+    rp_session_list_update(rp_ctx, session, true);
 
     return rc;
 
@@ -3071,6 +3509,8 @@ rp_session_stop(const rp_ctx_t *rp_ctx, rp_session_t *session)
     CHECK_NULL_ARG2(rp_ctx, session);
 
     SR_LOG_DBG("RP session stop, session id=%"PRIu32".", session->id);
+    rp_stats_session(rp_ctx, session, false);
+    rp_session_list_update(rp_ctx, session, false);
 
     /* sanity check - normally there should not be any unprocessed messages
      * within the session when calling rp_session_stop */
@@ -3096,6 +3536,7 @@ rp_msg_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
 {
     rp_request_t req = { 0 };
     struct timespec now = { 0 };
+    size_t active_threads = 0, queue_depth = 0;
     int rc = SR_ERR_OK;
 
     CHECK_NULL_ARG_NORET2(rc, rp_ctx, msg);
@@ -3116,44 +3557,48 @@ rp_msg_process(rp_ctx_t *rp_ctx, rp_session_t *session, Sr__Msg *msg)
     req.session = session;
     req.msg = msg;
 
-    pthread_mutex_lock(&rp_ctx->request_queue_mutex);
-
     /* enqueue the request into buffer */
-    rc = sr_cbuff_enqueue(rp_ctx->request_queue, &req);
+    rc = sr_ring_enqueue(rp_ctx->request_queue, &req);
+
+    /* order the enqueue before reading the number of active threads, a worker that is
+     * going to sleep re-checks the queue after it has decreased the number */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    active_threads = __atomic_load_n(&rp_ctx->active_threads, __ATOMIC_SEQ_CST);
+    queue_depth = sr_ring_count(rp_ctx->request_queue);
 
-    if (0 == rp_ctx->active_threads) {
+    if (0 == active_threads) {
         /* there is no active (non-sleeping) thread - if this is happening too
          * frequently, instruct the threads to spin before going to sleep */
+        sr_mutex_lock(&rp_ctx->thread_wakeup_mutex);
+        size_t spin_limit = __atomic_load_n(&rp_ctx->thread_spin_limit, __ATOMIC_RELAXED);
         sr_clock_get_time(CLOCK_MONOTONIC, &now);
         uint64_t diff = (1000000000L * (now.tv_sec - rp_ctx->last_thread_wakeup.tv_sec)) + now.tv_nsec - rp_ctx->last_thread_wakeup.tv_nsec;
         if (diff < RP_THREAD_SPIN_TIMEOUT) {
             /* a thread has been woken up in less than RP_THREAD_SPIN_TIMEOUT, increase the spin */
-            if (0 == rp_ctx->thread_spin_limit) {
+            if (0 == spin_limit) {
                 /* no spin set yet, set to initial value */
-                rp_ctx->thread_spin_limit = RP_THREAD_SPIN_MIN;
-            } else if(rp_ctx->thread_spin_limit < RP_THREAD_SPIN_MAX) {
+                spin_limit = RP_THREAD_SPIN_MIN;
+            } else if(spin_limit < RP_THREAD_SPIN_MAX) {
                 /* double the spin limit */
-                rp_ctx->thread_spin_limit *= 2;
+                spin_limit *= 2;
             }
         } else {
             /* reset spin to 0 if wakaups are not too frequent */
-            rp_ctx->thread_spin_limit = 0;
+            spin_limit = 0;
         }
+        __atomic_store_n(&rp_ctx->thread_spin_limit, spin_limit, __ATOMIC_RELAXED);
         rp_ctx->last_thread_wakeup = now;
+        sr_mutex_unlock(&rp_ctx->thread_wakeup_mutex);
     }
 
-    SR_LOG_DBG("Threads: active=%zu/%d, %zu requests in queue", rp_ctx->active_threads, RP_THREAD_COUNT,
-            sr_cbuff_items_in_queue(rp_ctx->request_queue));
+    SR_LOG_DBG("Threads: active=%zu/%d, %zu requests in queue", active_threads, RP_THREAD_COUNT, queue_depth);
 
-    /* send signal if there is no active thread ready to process the request */
-    if (0 == rp_ctx->active_threads ||
-            (((sr_cbuff_items_in_queue(rp_ctx->request_queue) / rp_ctx->active_threads) > RP_REQ_PER_THREADS) &&
-             rp_ctx->active_threads < RP_THREAD_COUNT)) {
-        pthread_cond_signal(&rp_ctx->request_queue_cv);
+    /* wake up a thread if there is no active thread ready to process the request */
+    if (0 == active_threads ||
+            (((queue_depth / active_threads) > RP_REQ_PER_THREADS) && active_threads < RP_THREAD_COUNT)) {
+        sr_ring_wake(rp_ctx->request_queue, 1);
     }
 
-    pthread_mutex_unlock(&rp_ctx->request_queue_mutex);
-
     if (SR_ERR_OK != rc) {
         /* release the message by error */
         SR_LOG_ERR_MSG("Unable to process the message, skipping.");
@@ -3195,6 +3640,8 @@ rp_all_notifications_received(rp_ctx_t *rp_ctx, uint32_t commit_id, int result,
         SR_LOG_INF("Resuming commit with id %"PRIu32" continue with %s", commit_id, SR_ERR_OK == result ? "write" : "abort");
         c_ctx->state = SR_ERR_OK == result ? DM_COMMIT_WRITE : DM_COMMIT_NOTIFY_ABORT;
         c_ctx->err_subs_xpaths = err_subs_xpaths;
+        c_ctx->stage_time[DM_COMMIT_WAIT_FOR_NOTIFICATIONS] = sr_clock_elapsed_us(&c_ctx->wait_start);
+        rp_stats_commit_stage(rp_ctx, DM_COMMIT_WAIT_FOR_NOTIFICATIONS, c_ctx->stage_time[DM_COMMIT_WAIT_FOR_NOTIFICATIONS]);
 
         MUTEX_LOCK_TIMED_CHECK_GOTO(&c_ctx->init_session->cur_req_mutex, rc, cleanup);
         c_ctx->init_session->state = RP_REQ_RESUMED;
@@ -3245,7 +3692,7 @@ cleanup:
     /* cleanup error lists */
     if (NULL != err_subs_xpaths) {
         for (size_t i = 0; i < err_subs_xpaths->count; i++) {
-            free(err_subs_xpaths->data[i]);
+            sr_str_release(err_subs_xpaths->data[i]);
         }
         sr_list_cleanup(err_subs_xpaths);
     }
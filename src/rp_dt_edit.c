@@ -217,6 +217,16 @@ rp_dt_delete_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, co
         goto cleanup;
     }
 
+    /* all deleted nodes must be deletable according to NACM rules */
+    for (size_t i = 0; i < nodes->number; i++) {
+        rc = rp_dt_nacm_check_node(dm_ctx, session, NACM_ACCESS_DELETE, true, nodes->set.d[i]);
+        if (SR_ERR_UNAUTHORIZED == rc) {
+            SR_LOG_ERR("Deletion of the node denied by NACM %s", xpath);
+            rc = dm_report_error(session, "Access denied", xpath, SR_ERR_UNAUTHORIZED);
+        }
+        CHECK_RC_LOG_GOTO(rc, cleanup, "NACM check failed %s", xpath);
+    }
+
     /* list key can be deleted only when the whole list is deleted */
     for (size_t i = 0; i < nodes->number; i++) {
         bool can_be_deleted = false;
@@ -250,6 +260,7 @@ rp_dt_delete_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, co
         if (NULL != nodes->set.d[i]->parent) {
             ly_set_add(parents, nodes->set.d[i]->parent, 0);
         }
+        dm_add_changed_node(info, NULL != nodes->set.d[i]->parent ? nodes->set.d[i]->parent : nodes->set.d[i]);
 
         ret = sr_lyd_unlink(info, nodes->set.d[i]);
         CHECK_ZERO_LOG_GOTO(ret, rc, SR_ERR_INTERNAL, cleanup, "Unlinking of the node %s failed", xpath);
@@ -316,6 +327,8 @@ rp_dt_set_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, const
     dm_data_info_t *info = NULL;
     dm_schema_info_t *schema_info = NULL;
     struct lyd_node *node = NULL;
+    struct lyd_node *existing = NULL;
+    nacm_profile_t nacm_profile = {0};
 
     /* validate xpath */
     rc = rp_dt_validate_node_xpath_lock(dm_ctx, session, xpath, &schema_info, &sch_node);
@@ -326,14 +339,14 @@ rp_dt_set_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, const
     module = schema_info->module;
     if (NULL == sch_node) {
         SR_LOG_ERR("Node can not be created or update %s", xpath);
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
         return SR_ERR_INVAL_ARG;
     }
 
     /* get data tree to be update */
     rc = dm_get_data_info(dm_ctx, session, module->name, &info);
     if (SR_ERR_OK != rc) {
-        pthread_rwlock_unlock(&schema_info->model_lock);
+        sr_rwlock_unlock(&schema_info->model_lock);
     }
 
     CHECK_RC_LOG_RETURN(rc, "Getting data tree failed for xpath '%s'", xpath);
@@ -342,12 +355,15 @@ rp_dt_set_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, const
     if (dm_is_running_ds_session(session)) {
         if (!dm_is_enabled_check_recursively(sch_node)) {
             SR_LOG_ERR("The node is not enabled in running datastore %s", xpath);
-            pthread_rwlock_unlock(&schema_info->model_lock);
+            sr_rwlock_unlock(&schema_info->model_lock);
             return SR_ERR_INVAL_ARG;
         }
     }
 
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
+
+    rc = dm_nacm_get_profile(dm_ctx, session, &nacm_profile);
+    CHECK_RC_MSG_RETURN(rc, "NACM profile can not be acquired");
 
     /* non-presence container can not be created */
     if (LYS_CONTAINER == sch_node->nodetype && NULL == ((struct lys_node_container *) sch_node)->presence) {
@@ -416,6 +432,22 @@ rp_dt_set_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, const
     }
 
 
+    /* an existing node is updated, check it according to NACM rules (a new leaf-list value is always created) */
+    if (!nacm_profile.bypass && !(LYS_LEAFLIST == sch_node->nodetype && NULL != value)) {
+        rc = rp_dt_find_node(dm_ctx, info->node, xpath, dm_is_running_ds_session(session), &existing);
+        if (SR_ERR_OK == rc) {
+            rc = rp_dt_nacm_check_node(dm_ctx, session, NACM_ACCESS_UPDATE, false, existing);
+            if (SR_ERR_UNAUTHORIZED == rc) {
+                SR_LOG_ERR("Update of the node denied by NACM %s", xpath);
+                rc = dm_report_error(session, "Access denied", xpath, SR_ERR_UNAUTHORIZED);
+            }
+            CHECK_RC_LOG_GOTO(rc, cleanup, "NACM check failed %s", xpath);
+        } else if (SR_ERR_NOT_FOUND == rc) {
+            rc = SR_ERR_OK;
+        }
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Find node failed %s", xpath);
+    }
+
     /* create or update */
     ly_errno = 0;
     node = dm_lyd_new_path(info, xpath, new_value, flags);
@@ -430,6 +462,19 @@ rp_dt_set_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, const
         }
     }
 
+    /* all created nodes, including the ancestors created implicitly, must be creatable according to NACM rules */
+    if (SR_ERR_OK == rc && !nacm_profile.bypass && NULL != node && NULL == existing) {
+        rc = rp_dt_nacm_check_node(dm_ctx, session, NACM_ACCESS_CREATE, true, node);
+        if (SR_ERR_UNAUTHORIZED == rc) {
+            SR_LOG_ERR("Creation of the node denied by NACM %s", xpath);
+            sr_lyd_unlink(info, node);
+            lyd_free(node);
+            node = NULL;
+            rc = dm_report_error(session, "Access denied", xpath, SR_ERR_UNAUTHORIZED);
+        }
+        CHECK_RC_LOG_GOTO(rc, cleanup, "NACM check failed %s", xpath);
+    }
+
     /* remove default tag if the default value has been explicitly set or overwritten */
     if (SR_ERR_OK == rc && sch_node->nodetype == LYS_LEAF && ((struct lys_node_leaf *) sch_node)->dflt != NULL) {
         if (NULL == node) {
@@ -439,6 +484,10 @@ rp_dt_set_item(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, const
         node->dflt = 0;
     }
 
+    if (SR_ERR_OK == rc) {
+        dm_add_changed_node(info, node);
+    }
+
 cleanup:
     free(new_value);
     if (NULL != info) {
@@ -456,16 +505,24 @@ rp_dt_move_list(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, sr_m
     struct lyd_node *sibling = NULL;
     dm_schema_info_t *schema_info = NULL;
     dm_data_info_t *info = NULL;
+    nacm_profile_t nacm_profile = {0};
 
     rc = rp_dt_validate_node_xpath_lock(dm_ctx, session, xpath, &schema_info, NULL);
     CHECK_RC_LOG_RETURN(rc, "Requested node is not valid %s", xpath);
 
     rc = dm_get_data_info(dm_ctx, session, schema_info->module_name, &info);
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    sr_rwlock_unlock(&schema_info->model_lock);
     CHECK_RC_LOG_RETURN(rc, "Getting data tree failed for xpath '%s'", xpath);
 
+    rc = dm_nacm_get_profile(dm_ctx, session, &nacm_profile);
+    CHECK_RC_MSG_RETURN(rc, "NACM profile can not be acquired");
 
     rc = rp_dt_find_node(dm_ctx, info->node, xpath, dm_is_running_ds_session(session), &node);
+    if (SR_ERR_OK == rc && !nacm_profile.bypass) {
+        /* a node that can not be read is reported the same way as a missing one */
+        rc = rp_dt_nacm_check_node(dm_ctx, session, NACM_ACCESS_READ, false, node);
+        rc = (SR_ERR_UNAUTHORIZED == rc) ? SR_ERR_NOT_FOUND : rc;
+    }
     if (SR_ERR_NOT_FOUND == rc) {
         SR_LOG_ERR("List not found %s", xpath);
         return SR_ERR_INVAL_ARG;
@@ -474,6 +531,16 @@ rp_dt_move_list(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, sr_m
         return rc;
     }
 
+    /* moving changes the order of the list entries, the moved node is updated according to NACM rules */
+    if (!nacm_profile.bypass) {
+        rc = rp_dt_nacm_check_node(dm_ctx, session, NACM_ACCESS_UPDATE, false, node);
+        if (SR_ERR_UNAUTHORIZED == rc) {
+            SR_LOG_ERR("Move of the node denied by NACM %s", xpath);
+            return dm_report_error(session, "Access denied", xpath, SR_ERR_UNAUTHORIZED);
+        }
+        CHECK_RC_LOG_RETURN(rc, "NACM check failed %s", xpath);
+    }
+
     if (!((LYS_LIST | LYS_LEAFLIST) & node->schema->nodetype) || (!(LYS_USERORDERED & node->schema->flags))) {
         SR_LOG_ERR("Xpath %s does not identify the user ordered list or leaf-list", xpath);
         return SR_ERR_INVAL_ARG;
@@ -481,6 +548,10 @@ rp_dt_move_list(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, sr_m
 
     if ((SR_MOVE_AFTER == position || SR_MOVE_BEFORE == position) && NULL != relative_item) {
         rc = rp_dt_find_node(dm_ctx, info->node, relative_item, dm_is_running_ds_session(session), &sibling);
+        if (SR_ERR_OK == rc && !nacm_profile.bypass) {
+            rc = rp_dt_nacm_check_node(dm_ctx, session, NACM_ACCESS_READ, false, sibling);
+            rc = (SR_ERR_UNAUTHORIZED == rc) ? SR_ERR_NOT_FOUND : rc;
+        }
         if (SR_ERR_NOT_FOUND == rc) {
             rc = dm_report_error(session, "Relative item for move operation not found", relative_item, SR_ERR_INVAL_ARG);
             goto cleanup;
@@ -508,6 +579,13 @@ rp_dt_move_list(dm_ctx_t *dm_ctx, dm_session_t *session, const char *xpath, sr_m
         return SR_ERR_INVAL_ARG;
     }
 
+    if (NULL != node->parent) {
+        dm_add_changed_node(info, node->parent);
+    } else {
+        /* order of top-level nodes can not be compared per subtree */
+        dm_untrack_changes(info);
+    }
+
     if (SR_MOVE_FIRST == position) {
         rc = sr_lyd_insert_before(info, sibling, node);
     } else if (SR_MOVE_LAST == position) {
@@ -681,8 +759,15 @@ rp_dt_commit(rp_ctx_t *rp_ctx, rp_session_t *session, dm_commit_context_t *c_ctx
 
     dm_commit_context_t *commit_ctx = c_ctx;
     dm_commit_state_t state = NULL != commit_ctx ? commit_ctx->state : DM_COMMIT_STARTED;
+    dm_commit_state_t stage = DM_COMMIT_STARTED;
+    struct timespec commit_start = { 0, }, stage_start = { 0, };
+    uint64_t stage_time = 0, validation_time = 0;
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &commit_start);
 
     while (state != DM_COMMIT_FINISHED) {
+        stage = state;
+        sr_clock_get_time(CLOCK_MONOTONIC, &stage_start);
         switch (state) {
         case DM_COMMIT_STARTED:
             SR_LOG_DBG_MSG("Commit (1/9): process started");
@@ -706,6 +791,8 @@ rp_dt_commit(rp_ctx_t *rp_ctx, rp_session_t *session, dm_commit_context_t *c_ctx
                 return SR_ERR_OK;
             }
             pthread_mutex_lock(&commit_ctx->mutex);
+            commit_ctx->started = commit_start;
+            commit_ctx->stage_time[DM_COMMIT_VALIDATION] = validation_time;
             /* open all files */
             rc = dm_commit_load_modified_models(rp_ctx->dm_ctx, session->dm_session, commit_ctx,
                     errors, err_cnt);
@@ -739,6 +826,8 @@ rp_dt_commit(rp_ctx_t *rp_ctx, rp_session_t *session, dm_commit_context_t *c_ctx
             break;
         case DM_COMMIT_WAIT_FOR_NOTIFICATIONS:
             SR_LOG_DBG("Commit %"PRIu32" processing paused waiting for replies from verifiers", commit_ctx->id);
+            sr_clock_get_time(CLOCK_MONOTONIC, &commit_ctx->wait_start);
+            session->req_wait_start = commit_ctx->wait_start;
             session->state = RP_REQ_WAITING_FOR_VERIFIERS;
             pthread_mutex_unlock(&commit_ctx->mutex);
             return rc;
@@ -756,6 +845,10 @@ rp_dt_commit(rp_ctx_t *rp_ctx, rp_session_t *session, dm_commit_context_t *c_ctx
             break;
         case DM_COMMIT_NOTIFY_ABORT:
             rc = dm_commit_notify(rp_ctx->dm_ctx, session->dm_session, SR_EV_ABORT, commit_ctx);
+            stage_time = sr_clock_elapsed_us(&stage_start);
+            commit_ctx->stage_time[DM_COMMIT_NOTIFY_ABORT] += stage_time;
+            rp_stats_commit_stage(rp_ctx, DM_COMMIT_NOTIFY_ABORT, stage_time);
+            dm_commit_trace(commit_ctx, SR_ERR_OPERATION_FAILED);
             session->state = RP_REQ_FINISHED;
             *errors = c_ctx->errors;
             *err_cnt = c_ctx->err_cnt;
@@ -767,8 +860,17 @@ rp_dt_commit(rp_ctx_t *rp_ctx, rp_session_t *session, dm_commit_context_t *c_ctx
         default:
             break;
         }
+        stage_time = sr_clock_elapsed_us(&stage_start);
+        if (NULL != commit_ctx) {
+            commit_ctx->stage_time[stage] += stage_time;
+        } else {
+            validation_time += stage_time;
+        }
+        rp_stats_commit_stage(rp_ctx, stage, stage_time);
+        SR_PROBE(commit_stage, NULL != commit_ctx ? commit_ctx->id : 0, stage, stage_time);
     }
 cleanup:
+    dm_commit_trace(commit_ctx, rc);
     pthread_mutex_unlock(&commit_ctx->mutex);
     /* In case of running datastore, commit context will be freed when
      * all notifications session are closed.
@@ -29,6 +29,7 @@
 #include "rp_dt_get.h"
 #include "rp_dt_xpath.h"
 #include "rp_dt_edit.h"
+#include "rp_stats.h"
 
 void
 rp_dt_free_state_data_ctx_content (rp_state_data_ctx_t *state_data)
@@ -169,21 +170,15 @@ rp_dt_get_values_from_nodes(sr_mem_ctx_t *sr_mem, struct ly_set *nodes, sr_val_t
     return rc;
 }
 
-int
-rp_dt_get_value(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath, bool check_enabled, sr_val_t **value)
+/**
+ * @brief Copies the value of the data node into newly allocated sr_val_t.
+ */
+static int
+rp_dt_copy_value(sr_mem_ctx_t *sr_mem, struct lyd_node *node, const char *xpath, sr_val_t **value)
 {
-    CHECK_NULL_ARG4(dm_ctx, data_tree, xpath, value);
+    CHECK_NULL_ARG3(node, xpath, value);
     int rc = SR_ERR_OK;
     sr_val_t *val = NULL;
-    struct lyd_node *node = NULL;
-
-    rc = rp_dt_find_node(dm_ctx, data_tree, xpath, check_enabled, &node);
-    if (SR_ERR_OK != rc) {
-        if (SR_ERR_NOT_FOUND != rc) {
-            SR_LOG_ERR("Find node failed (%d) xpath %s", rc, xpath);
-        }
-        return rc;
-    }
 
     val = sr_calloc(sr_mem, 1, sizeof(*val));
     CHECK_NULL_NOMEM_RETURN(val);
@@ -204,6 +199,24 @@ rp_dt_get_value(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t
     return rc;
 }
 
+int
+rp_dt_get_value(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath, bool check_enabled, sr_val_t **value)
+{
+    CHECK_NULL_ARG4(dm_ctx, data_tree, xpath, value);
+    int rc = SR_ERR_OK;
+    struct lyd_node *node = NULL;
+
+    rc = rp_dt_find_node(dm_ctx, data_tree, xpath, check_enabled, &node);
+    if (SR_ERR_OK != rc) {
+        if (SR_ERR_NOT_FOUND != rc) {
+            SR_LOG_ERR("Find node failed (%d) xpath %s", rc, xpath);
+        }
+        return rc;
+    }
+
+    return rp_dt_copy_value(sr_mem, node, xpath, value);
+}
+
 int
 rp_dt_get_values(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath, bool check_enable,
         sr_val_t **values, size_t *count)
@@ -230,21 +243,15 @@ rp_dt_get_values(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_
     return SR_ERR_OK;
 }
 
-int
-rp_dt_get_subtree(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath, bool check_enabled, sr_node_t **subtree)
+/**
+ * @brief Copies the subtree of the data node into newly allocated sr_node_t.
+ */
+static int
+rp_dt_copy_subtree(sr_mem_ctx_t *sr_mem, struct lyd_node *node, const char *xpath, sr_node_t **subtree)
 {
-    CHECK_NULL_ARG4(dm_ctx, data_tree, xpath, subtree);
+    CHECK_NULL_ARG3(node, xpath, subtree);
     int rc = SR_ERR_OK;
     sr_node_t *tree = NULL;
-    struct lyd_node *node = NULL;
-
-    rc = rp_dt_find_node(dm_ctx, data_tree, xpath, check_enabled, &node);
-    if (SR_ERR_OK != rc) {
-        if (SR_ERR_NOT_FOUND != rc) {
-            SR_LOG_ERR("Find node failed (%d) xpath %s", rc, xpath);
-        }
-        return rc;
-    }
 
     tree = sr_calloc(sr_mem, 1, sizeof(*tree));
     CHECK_NULL_NOMEM_RETURN(tree);
@@ -266,14 +273,10 @@ rp_dt_get_subtree(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx
 }
 
 int
-rp_dt_get_subtree_chunk(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath,
-        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, bool check_enabled,
-        sr_node_t **chunk, char **chunk_id)
+rp_dt_get_subtree(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath, bool check_enabled, sr_node_t **subtree)
 {
-    CHECK_NULL_ARG5(dm_ctx, data_tree, xpath, chunk, chunk_id);
+    CHECK_NULL_ARG4(dm_ctx, data_tree, xpath, subtree);
     int rc = SR_ERR_OK;
-    sr_node_t *tree = NULL;
-    char *id = NULL, *id_cpy = NULL;
     struct lyd_node *node = NULL;
 
     rc = rp_dt_find_node(dm_ctx, data_tree, xpath, check_enabled, &node);
@@ -284,6 +287,77 @@ rp_dt_get_subtree_chunk(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_m
         return rc;
     }
 
+    return rp_dt_copy_subtree(sr_mem, node, xpath, subtree);
+}
+
+/**
+ * @brief Returns ID of a subtree chunk rooted at the given node (its data path).
+ */
+static int
+rp_dt_get_chunk_id(sr_mem_ctx_t *sr_mem, const struct lyd_node *node, const char *xpath, char **chunk_id)
+{
+    CHECK_NULL_ARG3(node, xpath, chunk_id);
+    int rc = SR_ERR_OK;
+    char *id = NULL;
+
+    id = lyd_path((struct lyd_node *)node);
+    if (NULL == id) {
+        SR_LOG_ERR("Failed to get ID of a subtree chunk with xpath %s", xpath);
+        return SR_ERR_INTERNAL;
+    }
+    rc = sr_mem_edit_string(sr_mem, chunk_id, id);
+    free(id);
+    if (SR_ERR_OK != rc) {
+        SR_LOG_ERR("Failed to copy ID of a subtree chunk with xpath %s", xpath);
+    }
+    return rc;
+}
+
+/**
+ * @brief Builds a GPB chunk of the subtree of the data node directly from the libyang node.
+ * The chunk ID is returned only if subtree_id is not NULL.
+ */
+static int
+rp_dt_copy_subtree_gpb(sr_mem_ctx_t *sr_mem, struct lyd_node *node, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit,
+        Sr__Node **subtree, char **subtree_id)
+{
+    CHECK_NULL_ARG3(node, xpath, subtree);
+    int rc = SR_ERR_OK;
+    Sr__Node *tree = NULL;
+    char *id = NULL;
+
+    rc = sr_dup_node_to_gpb(sr_mem, node, slice_offset, slice_width, child_limit, depth_limit, &tree);
+    CHECK_RC_LOG_RETURN(rc, "Building GPB tree failed for xpath %s", xpath);
+
+    if (NULL != subtree_id) {
+        rc = rp_dt_get_chunk_id(sr_mem, node, xpath, &id);
+        if (SR_ERR_OK != rc) {
+            if (NULL == sr_mem) {
+                sr__node__free_unpacked(tree, NULL);
+            }
+            return rc;
+        }
+        *subtree_id = id;
+    }
+
+    *subtree = tree;
+    return rc;
+}
+
+/**
+ * @brief Copies a chunk of the subtree of the data node into newly allocated sr_node_t.
+ */
+static int
+rp_dt_copy_subtree_chunk(sr_mem_ctx_t *sr_mem, struct lyd_node *node, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit,
+        sr_node_t **chunk, char **chunk_id)
+{
+    CHECK_NULL_ARG4(node, xpath, chunk, chunk_id);
+    int rc = SR_ERR_OK;
+    sr_node_t *tree = NULL;
+    char *id = NULL;
+
     tree = sr_calloc(sr_mem, 1, sizeof(*tree));
     CHECK_NULL_NOMEM_RETURN(tree);
 
@@ -299,26 +373,38 @@ rp_dt_get_subtree_chunk(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_m
         return rc;
     }
 
-    id = lyd_path(node);
-    if (NULL == id) {
-        SR_LOG_ERR("Failed to get ID of a subtree chunk with xpath %s", xpath);
-        sr_free_tree(tree);
-        return SR_ERR_INTERNAL;
-    }
-    rc = sr_mem_edit_string(sr_mem, &id_cpy, id);
-    free(id);
+    rc = rp_dt_get_chunk_id(sr_mem, node, xpath, &id);
     if (SR_ERR_OK != rc) {
-        SR_LOG_ERR("Failed to copy ID of a subtree chunk with xpath %s", xpath);
         sr_free_tree(tree);
         return rc;
     }
 
     *chunk = tree;
-    *chunk_id = id_cpy;
+    *chunk_id = id;
 
     return rc;
 }
 
+int
+rp_dt_get_subtree_chunk(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, bool check_enabled,
+        sr_node_t **chunk, char **chunk_id)
+{
+    CHECK_NULL_ARG5(dm_ctx, data_tree, xpath, chunk, chunk_id);
+    int rc = SR_ERR_OK;
+    struct lyd_node *node = NULL;
+
+    rc = rp_dt_find_node(dm_ctx, data_tree, xpath, check_enabled, &node);
+    if (SR_ERR_OK != rc) {
+        if (SR_ERR_NOT_FOUND != rc) {
+            SR_LOG_ERR("Find node failed (%d) xpath %s", rc, xpath);
+        }
+        return rc;
+    }
+
+    return rp_dt_copy_subtree_chunk(sr_mem, node, xpath, slice_offset, slice_width, child_limit, depth_limit, chunk, chunk_id);
+}
+
 int
 rp_dt_get_subtrees(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath, bool check_enable,
         sr_node_t **subtrees, size_t *count)
@@ -345,13 +431,16 @@ rp_dt_get_subtrees(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ct
     return rc;
 }
 
-int
-rp_dt_get_subtrees_chunks(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath,
-        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, bool check_enable,
+/**
+ * @brief Copies chunks of the subtrees of the data nodes into newly allocated array of sr_node_t.
+ */
+static int
+rp_dt_copy_subtrees_chunks(sr_mem_ctx_t *sr_mem, struct ly_set *nodes, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit,
         sr_node_t **chunks_p, size_t *count_p, char ***chunk_ids_p)
 {
-    CHECK_NULL_ARG3(dm_ctx, data_tree, xpath);
-    CHECK_NULL_ARG3(chunks_p, count_p, chunk_ids_p);
+    CHECK_NULL_ARG3(nodes, xpath, chunks_p);
+    CHECK_NULL_ARG2(count_p, chunk_ids_p);
 
     int rc = SR_ERR_OK;
     sr_node_t *chunks = NULL;
@@ -359,15 +448,6 @@ rp_dt_get_subtrees_chunks(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr
     char **chunk_ids = NULL;
     char *chunk_id = NULL;
 
-    struct ly_set *nodes = NULL;
-    rc = rp_dt_find_nodes(dm_ctx, data_tree, xpath, check_enable, &nodes);
-    if (SR_ERR_OK != rc) {
-        if (SR_ERR_NOT_FOUND != rc) {
-            SR_LOG_ERR("Get nodes for xpath %s failed (%d)", xpath, rc);
-        }
-        return rc;
-    }
-
     rc = sr_nodes_to_tree_chunks(nodes, slice_offset, slice_width, child_limit, depth_limit, sr_mem, &chunks, &count);
     if (SR_ERR_OK != rc) {
         SR_LOG_ERR("Conversion of nodes to trees failed for xpath '%s'", xpath);
@@ -396,7 +476,6 @@ rp_dt_get_subtrees_chunks(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr
     *chunk_ids_p = chunk_ids;
 
 cleanup:
-    ly_set_free(nodes);
     if (SR_ERR_OK != rc) {
         if (NULL == sr_mem && NULL != chunk_ids) {
             for (size_t i = 0; i < count; ++i) {
@@ -409,6 +488,82 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Builds GPB chunks of the subtrees of the data nodes directly from the libyang nodes.
+ * The chunk IDs are returned only if subtree_ids_p is not NULL.
+ */
+static int
+rp_dt_copy_subtrees_gpb(sr_mem_ctx_t *sr_mem, struct ly_set *nodes, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit,
+        Sr__Node ***subtrees_p, size_t *count_p, char ***subtree_ids_p)
+{
+    CHECK_NULL_ARG4(nodes, xpath, subtrees_p, count_p);
+
+    int rc = SR_ERR_OK;
+    Sr__Node **subtrees = NULL;
+    size_t count = 0;
+    char **subtree_ids = NULL;
+
+    rc = sr_nodes_to_gpb_trees(sr_mem, nodes, slice_offset, slice_width, child_limit, depth_limit, &subtrees, &count);
+    CHECK_RC_LOG_RETURN(rc, "Building GPB trees failed for xpath '%s'", xpath);
+
+    if (NULL != subtree_ids_p && 0 < count) {
+        subtree_ids = sr_calloc(sr_mem, count, sizeof(*subtree_ids));
+        CHECK_NULL_NOMEM_GOTO(subtree_ids, rc, cleanup);
+        for (size_t i = 0; i < count; ++i) {
+            rc = rp_dt_get_chunk_id(sr_mem, nodes->set.d[i], xpath, &subtree_ids[i]);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get IDs of subtree chunks");
+        }
+    }
+
+    *subtrees_p = subtrees;
+    *count_p = count;
+    if (NULL != subtree_ids_p) {
+        *subtree_ids_p = subtree_ids;
+    }
+    return rc;
+
+cleanup:
+    if (NULL == sr_mem) {
+        if (NULL != subtree_ids) {
+            for (size_t i = 0; i < count; ++i) {
+                free(subtree_ids[i]);
+            }
+            free(subtree_ids);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            sr__node__free_unpacked(subtrees[i], NULL);
+        }
+        free(subtrees);
+    }
+    return rc;
+}
+
+int
+rp_dt_get_subtrees_chunks(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, sr_mem_ctx_t *sr_mem, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, bool check_enable,
+        sr_node_t **chunks_p, size_t *count_p, char ***chunk_ids_p)
+{
+    CHECK_NULL_ARG3(dm_ctx, data_tree, xpath);
+    CHECK_NULL_ARG3(chunks_p, count_p, chunk_ids_p);
+
+    int rc = SR_ERR_OK;
+
+    struct ly_set *nodes = NULL;
+    rc = rp_dt_find_nodes(dm_ctx, data_tree, xpath, check_enable, &nodes);
+    if (SR_ERR_OK != rc) {
+        if (SR_ERR_NOT_FOUND != rc) {
+            SR_LOG_ERR("Get nodes for xpath %s failed (%d)", xpath, rc);
+        }
+        return rc;
+    }
+
+    rc = rp_dt_copy_subtrees_chunks(sr_mem, nodes, xpath, slice_offset, slice_width, child_limit, depth_limit,
+            chunks_p, count_p, chunk_ids_p);
+    ly_set_free(nodes);
+    return rc;
+}
+
 bool
 rp_dt_is_under_subtree(struct lys_node *subtree, size_t depth_limit, struct lys_node *node)
 {
@@ -783,17 +938,20 @@ rp_dt_prepare_data(rp_ctx_t *rp_ctx, rp_session_t *rp_session, const char *xpath
 
         /* in case of get_items_with_opts module name is not freed to save some
          * copying in case of cache hit */
-        free(rp_session->module_name);
+        sr_str_release(rp_session->module_name);
         rp_session->module_name = NULL;
 
         rc = rp_dt_remove_loaded_state_data(rp_ctx, rp_session);
         CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to remove state data from data tree");
 
-        rc = sr_copy_first_ns(xpath, &rp_session->module_name);
-        CHECK_RC_LOG_GOTO(rc, cleanup, "Copying module name failed for xpath '%s'", xpath);
+        rc = sr_intern_first_ns(xpath, &rp_session->module_name);
+        CHECK_RC_LOG_GOTO(rc, cleanup, "Interning module name failed for xpath '%s'", xpath);
 
-        rc = ac_check_node_permissions(rp_session->ac_session, xpath, AC_OPER_READ);
-        CHECK_RC_LOG_GOTO(rc, cleanup, "Access control check failed for xpath '%s'", xpath);
+        /* engine statistics are readable by everybody, the internal module has no data file to be checked */
+        if (0 != strcmp(RP_STATS_MODULE_NAME, rp_session->module_name)) {
+            rc = ac_check_node_permissions(rp_session->ac_session, xpath, AC_OPER_READ);
+            CHECK_RC_LOG_GOTO(rc, cleanup, "Access control check failed for xpath '%s'", xpath);
+        }
 
         rc = dm_get_data_info(rp_ctx->dm_ctx, rp_session->dm_session, rp_session->module_name, &data_info);
 
@@ -802,6 +960,17 @@ rp_dt_prepare_data(rp_ctx_t *rp_ctx, rp_session_t *rp_session, const char *xpath
         CHECK_RC_LOG_GOTO(rc, cleanup, "Getting data tree failed (%d) for xpath '%s'", rc, xpath);
         *data_tree = data_info->node;
 
+        /* engine statistics are provided by the engine itself */
+        if (0 == strcmp(RP_STATS_MODULE_NAME, rp_session->module_name) &&
+            (SR_DS_RUNNING == rp_session->datastore || SR_DS_CANDIDATE == rp_session->datastore) &&
+            (!(SR_SESS_CONFIG_ONLY & rp_session->options))) {
+            rc = rp_stats_load_data(rp_ctx, rp_session);
+            CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to load engine statistics");
+            rc = dm_get_datatree(rp_ctx->dm_ctx, rp_session->dm_session, rp_session->module_name, data_tree);
+            rc = SR_ERR_NOT_FOUND == rc ? SR_ERR_OK : rc;
+            goto cleanup;
+        }
+
         /* if the request requires operational data pause the processing and wait for data to be provided */
         if ((SR_DS_RUNNING == rp_session->datastore || SR_DS_CANDIDATE == rp_session->datastore) &&
             (!(SR_SESS_CONFIG_ONLY & rp_session->options)) &&
@@ -848,6 +1017,7 @@ rp_dt_prepare_data(rp_ctx_t *rp_ctx, rp_session_t *rp_session, const char *xpath
 
             if (rp_session->dp_req_waiting > 0) {
                 rp_session->state = RP_REQ_WAITING_FOR_DATA;
+                sr_clock_get_time(CLOCK_MONOTONIC, &rp_session->req_wait_start);
             }
 
         }
@@ -871,6 +1041,64 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Looks up the node matching xpath and checks whether the session user is allowed to read it by NACM rules.
+ * @param [in] rp_ctx
+ * @param [in] rp_session
+ * @param [in] data_tree
+ * @param [in] xpath
+ * @param [in] whole_subtree if set, the read access to all descendants of the node is required
+ * @param [out] node
+ * @return Error code (SR_ERR_OK on success), SR_ERR_UNAUTHORIZED if the access is denied
+ */
+static int
+rp_dt_find_readable_node(rp_ctx_t *rp_ctx, rp_session_t *rp_session, struct lyd_node *data_tree, const char *xpath,
+        bool whole_subtree, struct lyd_node **node)
+{
+    int rc = SR_ERR_OK;
+
+    rc = rp_dt_find_node(rp_ctx->dm_ctx, data_tree, xpath, dm_is_running_ds_session(rp_session->dm_session), node);
+    if (SR_ERR_OK != rc) {
+        if (SR_ERR_NOT_FOUND != rc) {
+            SR_LOG_ERR("Find node failed (%d) xpath %s", rc, xpath);
+        }
+        return rc;
+    }
+
+    return rp_dt_nacm_check_node(rp_ctx->dm_ctx, rp_session->dm_session, whole_subtree ? 0 : NACM_ACCESS_READ, false, *node);
+}
+
+/**
+ * @brief Looks up the nodes matching xpath and omits those the session user is not allowed to read by NACM rules.
+ * @param [in] rp_ctx
+ * @param [in] rp_session
+ * @param [in] data_tree
+ * @param [in] xpath
+ * @param [in] whole_subtree if set, only the nodes whose whole subtree can be read are returned
+ * @param [out] nodes
+ * @return Error code (SR_ERR_OK on success), SR_ERR_NOT_FOUND if no readable node matches
+ */
+static int
+rp_dt_find_readable_nodes(rp_ctx_t *rp_ctx, rp_session_t *rp_session, struct lyd_node *data_tree, const char *xpath,
+        bool whole_subtree, struct ly_set **nodes)
+{
+    int rc = SR_ERR_OK;
+
+    rc = rp_dt_find_nodes(rp_ctx->dm_ctx, data_tree, xpath, dm_is_running_ds_session(rp_session->dm_session), nodes);
+    if (SR_ERR_OK == rc) {
+        rc = rp_dt_nacm_filter_nodes(rp_ctx->dm_ctx, rp_session->dm_session, whole_subtree ? 0 : NACM_ACCESS_READ, *nodes);
+        if (SR_ERR_OK != rc) {
+            ly_set_free(*nodes);
+            *nodes = NULL;
+        }
+    }
+    if (SR_ERR_OK != rc && SR_ERR_NOT_FOUND != rc) {
+        SR_LOG_ERR("Get nodes for xpath %s failed (%d)", xpath, rc);
+    }
+
+    return rc;
+}
+
 int
 rp_dt_get_value_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath, sr_val_t **value)
 {
@@ -880,6 +1108,7 @@ rp_dt_get_value_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t
 
     int rc = SR_ERR_OK;
     struct lyd_node *data_tree = NULL;
+    struct lyd_node *node = NULL;
 
     rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_VALUES, 0, &data_tree);
     CHECK_RC_LOG_GOTO(rc, cleanup, "rp_dt_prepare_data failed %s", sr_strerror(rc));
@@ -893,7 +1122,10 @@ rp_dt_get_value_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t
         goto cleanup;
     }
 
-    rc = rp_dt_get_value(rp_ctx->dm_ctx, data_tree, sr_mem, xpath, dm_is_running_ds_session(rp_session->dm_session), value);
+    rc = rp_dt_find_readable_node(rp_ctx, rp_session, data_tree, xpath, false, &node);
+    if (SR_ERR_OK == rc) {
+        rc = rp_dt_copy_value(sr_mem, node, xpath, value);
+    }
 cleanup:
     if (SR_ERR_NOT_FOUND == rc || (SR_ERR_OK == rc && NULL == data_tree)) {
         rc = rp_dt_validate_node_xpath(rp_ctx->dm_ctx, rp_session->dm_session, xpath, NULL, NULL);
@@ -909,7 +1141,7 @@ cleanup:
     }
 
     rp_session->state = RP_REQ_FINISHED;
-    free(rp_session->module_name);
+    sr_str_release(rp_session->module_name);
     rp_session->module_name = NULL;
     return rc;
 }
@@ -923,6 +1155,7 @@ rp_dt_get_values_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_
 
     int rc = SR_ERR_OK;
     struct lyd_node *data_tree = NULL;
+    struct ly_set *nodes = NULL;
 
     rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_VALUES, 0, &data_tree);
     CHECK_RC_MSG_GOTO(rc, cleanup, "rp_dt_prepare_data failed");
@@ -936,7 +1169,11 @@ rp_dt_get_values_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_
         goto cleanup;
     }
 
-    rc = rp_dt_get_values(rp_ctx->dm_ctx, data_tree, sr_mem, xpath, dm_is_running_ds_session(rp_session->dm_session), values, count);
+    rc = rp_dt_find_readable_nodes(rp_ctx, rp_session, data_tree, xpath, false, &nodes);
+    if (SR_ERR_OK == rc) {
+        rc = rp_dt_get_values_from_nodes(sr_mem, nodes, values, count);
+        ly_set_free(nodes);
+    }
     if (SR_ERR_OK != rc && SR_ERR_NOT_FOUND != rc) {
         SR_LOG_ERR("Get values failed for xpath '%s'", xpath);
     }
@@ -952,7 +1189,7 @@ cleanup:
         rc = SR_ERR_NOT_FOUND;
     }
     rp_session->state = RP_REQ_FINISHED;
-    free(rp_session->module_name);
+    sr_str_release(rp_session->module_name);
     rp_session->module_name = NULL;
     return rc;
 }
@@ -1016,17 +1253,24 @@ cleanup:
 
 }
 
-int
-rp_dt_get_subtree_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath, sr_node_t **subtree)
+/**
+ * @brief Returns the subtree (chunk) whose root node is referenced by the specified xpath either
+ * as sysrepo tree (subtree) or as GPB tree (gpb_subtree). Chunk ID is returned only if requested.
+ */
+static int
+rp_dt_get_subtree_internal(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+    size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtree,
+    Sr__Node **gpb_subtree, char **subtree_id)
 {
     CHECK_NULL_ARG4(rp_ctx, rp_ctx->dm_ctx, rp_session, rp_session->dm_session);
-    CHECK_NULL_ARG2(xpath, subtree);
+    CHECK_NULL_ARG(xpath);
     SR_LOG_INF("Get subtree request %s datastore, xpath: %s", sr_ds_to_str(rp_session->datastore), xpath);
 
     int rc = SR_ERR_OK;
     struct lyd_node *data_tree = NULL;
+    struct lyd_node *node = NULL;
 
-    rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_TREES, SIZE_MAX, &data_tree);
+    rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_TREES, depth_limit, &data_tree);
     CHECK_RC_LOG_GOTO(rc, cleanup, "rp_dt_prepare_data failed %s", sr_strerror(rc));
 
     if (RP_REQ_WAITING_FOR_DATA == rp_session->state) {
@@ -1038,7 +1282,18 @@ rp_dt_get_subtree_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx
         goto cleanup;
     }
 
-    rc = rp_dt_get_subtree(rp_ctx->dm_ctx, data_tree, sr_mem, xpath, dm_is_running_ds_session(rp_session->dm_session), subtree);
+    rc = rp_dt_find_readable_node(rp_ctx, rp_session, data_tree, xpath, true, &node);
+    if (SR_ERR_OK == rc) {
+        if (NULL != gpb_subtree) {
+            rc = rp_dt_copy_subtree_gpb(sr_mem, node, xpath, slice_offset, slice_width, child_limit, depth_limit,
+                    gpb_subtree, subtree_id);
+        } else if (NULL != subtree_id) {
+            rc = rp_dt_copy_subtree_chunk(sr_mem, node, xpath, slice_offset, slice_width, child_limit, depth_limit,
+                    subtree, subtree_id);
+        } else {
+            rc = rp_dt_copy_subtree(sr_mem, node, xpath, subtree);
+        }
+    }
 cleanup:
     if (SR_ERR_NOT_FOUND == rc || (SR_ERR_OK == rc && NULL == data_tree)) {
         rc = rp_dt_validate_node_xpath(rp_ctx->dm_ctx, rp_session->dm_session, xpath, NULL, NULL);
@@ -1054,67 +1309,58 @@ cleanup:
     }
 
     rp_session->state = RP_REQ_FINISHED;
-    free(rp_session->module_name);
+    sr_str_release(rp_session->module_name);
     rp_session->module_name = NULL;
     return rc;
 }
 
+int
+rp_dt_get_subtree_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath, sr_node_t **subtree)
+{
+    CHECK_NULL_ARG2(xpath, subtree);
+
+    return rp_dt_get_subtree_internal(rp_ctx, rp_session, sr_mem, xpath, 0, SIZE_MAX, SIZE_MAX, SIZE_MAX,
+            subtree, NULL, NULL);
+}
+
 int
 rp_dt_get_subtree_wrapper_with_opts(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
     size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtree, char **subtree_id)
 {
-    CHECK_NULL_ARG4(rp_ctx, rp_ctx->dm_ctx, rp_session, rp_session->dm_session);
     CHECK_NULL_ARG3(xpath, subtree, subtree_id);
-    SR_LOG_INF("Get subtree request %s datastore, xpath: %s", sr_ds_to_str(rp_session->datastore), xpath);
-
-    int rc = SR_ERR_OK;
-    struct lyd_node *data_tree = NULL;
-
-    rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_TREES, depth_limit, &data_tree);
-    CHECK_RC_LOG_GOTO(rc, cleanup, "rp_dt_prepare_data failed %s", sr_strerror(rc));
 
-    if (RP_REQ_WAITING_FOR_DATA == rp_session->state) {
-        SR_LOG_DBG("Session id = %u is waiting for the data", rp_session->id);
-        return rc;
-    }
-
-    if (NULL == data_tree) {
-        goto cleanup;
-    }
+    return rp_dt_get_subtree_internal(rp_ctx, rp_session, sr_mem, xpath, slice_offset, slice_width, child_limit,
+            depth_limit, subtree, NULL, subtree_id);
+}
 
-    rc = rp_dt_get_subtree_chunk(rp_ctx->dm_ctx, data_tree, sr_mem, xpath, slice_offset, slice_width, child_limit,
-            depth_limit, dm_is_running_ds_session(rp_session->dm_session), subtree, subtree_id);
-cleanup:
-    if (SR_ERR_NOT_FOUND == rc || (SR_ERR_OK == rc && NULL == data_tree)) {
-        rc = rp_dt_validate_node_xpath(rp_ctx->dm_ctx, rp_session->dm_session, xpath, NULL, NULL);
-        if (SR_ERR_OK != rc) {
-            /* Print warning only, because we are not able to validate all xpath */
-            SR_LOG_WRN("Validation of xpath %s was not successful", xpath);
-        }
-        rc = SR_ERR_NOT_FOUND;
-    } else if (SR_ERR_UNAUTHORIZED == rc) {
-        rc = SR_ERR_NOT_FOUND;
-    } else if (SR_ERR_OK != rc) {
-        SR_LOG_ERR("Get subtree failed for xpath '%s'", xpath);
-    }
+int
+rp_dt_get_subtree_gpb_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+    size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, Sr__Node **subtree, char **subtree_id)
+{
+    CHECK_NULL_ARG2(xpath, subtree);
 
-    rp_session->state = RP_REQ_FINISHED;
-    free(rp_session->module_name);
-    rp_session->module_name = NULL;
-    return rc;
+    return rp_dt_get_subtree_internal(rp_ctx, rp_session, sr_mem, xpath, slice_offset, slice_width, child_limit,
+            depth_limit, NULL, subtree, subtree_id);
 }
 
-int
-rp_dt_get_subtrees_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath, sr_node_t **subtrees, size_t *count)
+/**
+ * @brief Retrieves all subtrees (chunks) with root nodes matching the specified xpath either as sysrepo
+ * trees (subtrees) or as GPB trees (gpb_subtrees). Chunk IDs are returned only if requested.
+ */
+static int
+rp_dt_get_subtrees_internal(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+    size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtrees,
+    Sr__Node ***gpb_subtrees, size_t *count, char ***subtree_ids)
 {
     CHECK_NULL_ARG4(rp_ctx, rp_ctx->dm_ctx, rp_session, rp_session->dm_session);
-    CHECK_NULL_ARG3(xpath, subtrees, count);
+    CHECK_NULL_ARG2(xpath, count);
     SR_LOG_INF("Get subtrees request %s datastore, xpath: %s", sr_ds_to_str(rp_session->datastore), xpath);
 
     int rc = SR_ERR_OK;
     struct lyd_node *data_tree = NULL;
+    struct ly_set *nodes = NULL;
 
-    rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_TREES, SIZE_MAX, &data_tree);
+    rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_TREES, depth_limit, &data_tree);
     CHECK_RC_MSG_GOTO(rc, cleanup, "rp_dt_prepare_data failed");
 
     if (RP_REQ_WAITING_FOR_DATA == rp_session->state) {
@@ -1126,7 +1372,19 @@ rp_dt_get_subtrees_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ct
         goto cleanup;
     }
 
-    rc = rp_dt_get_subtrees(rp_ctx->dm_ctx, data_tree, sr_mem, xpath, dm_is_running_ds_session(rp_session->dm_session), subtrees, count);
+    rc = rp_dt_find_readable_nodes(rp_ctx, rp_session, data_tree, xpath, true, &nodes);
+    if (SR_ERR_OK == rc) {
+        if (NULL != gpb_subtrees) {
+            rc = rp_dt_copy_subtrees_gpb(sr_mem, nodes, xpath, slice_offset, slice_width, child_limit, depth_limit,
+                    gpb_subtrees, count, subtree_ids);
+        } else if (NULL != subtree_ids) {
+            rc = rp_dt_copy_subtrees_chunks(sr_mem, nodes, xpath, slice_offset, slice_width, child_limit, depth_limit,
+                    subtrees, count, subtree_ids);
+        } else {
+            rc = sr_nodes_to_trees(nodes, sr_mem, subtrees, count);
+        }
+        ly_set_free(nodes);
+    }
     if (SR_ERR_OK != rc && SR_ERR_NOT_FOUND != rc) {
         SR_LOG_ERR("Get subtrees failed for xpath '%s'", xpath);
     }
@@ -1142,55 +1400,40 @@ cleanup:
         rc = SR_ERR_NOT_FOUND;
     }
     rp_session->state = RP_REQ_FINISHED;
-    free(rp_session->module_name);
+    sr_str_release(rp_session->module_name);
     rp_session->module_name = NULL;
     return rc;
 }
 
 int
-rp_dt_get_subtrees_wrapper_with_opts(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
-    size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtrees, size_t *count,
-    char ***subtree_ids)
+rp_dt_get_subtrees_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath, sr_node_t **subtrees, size_t *count)
 {
-    CHECK_NULL_ARG4(rp_ctx, rp_ctx->dm_ctx, rp_session, rp_session->dm_session);
     CHECK_NULL_ARG3(xpath, subtrees, count);
-    SR_LOG_INF("Get subtrees request %s datastore, xpath: %s", sr_ds_to_str(rp_session->datastore), xpath);
-
-    int rc = SR_ERR_OK;
-    struct lyd_node *data_tree = NULL;
 
-    rc = rp_dt_prepare_data(rp_ctx, rp_session, xpath, SR_API_TREES, depth_limit, &data_tree);
-    CHECK_RC_MSG_GOTO(rc, cleanup, "rp_dt_prepare_data failed");
+    return rp_dt_get_subtrees_internal(rp_ctx, rp_session, sr_mem, xpath, 0, SIZE_MAX, SIZE_MAX, SIZE_MAX,
+            subtrees, NULL, count, NULL);
+}
 
-    if (RP_REQ_WAITING_FOR_DATA == rp_session->state) {
-        SR_LOG_DBG("Session id = %u is waiting for the data", rp_session->id);
-        return rc;
-    }
+int
+rp_dt_get_subtrees_wrapper_with_opts(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+    size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtrees, size_t *count,
+    char ***subtree_ids)
+{
+    CHECK_NULL_ARG4(xpath, subtrees, count, subtree_ids);
 
-    if (NULL == data_tree) {
-        goto cleanup;
-    }
+    return rp_dt_get_subtrees_internal(rp_ctx, rp_session, sr_mem, xpath, slice_offset, slice_width, child_limit,
+            depth_limit, subtrees, NULL, count, subtree_ids);
+}
 
-    rc = rp_dt_get_subtrees_chunks(rp_ctx->dm_ctx, data_tree, sr_mem, xpath, slice_offset, slice_width, child_limit,
-            depth_limit, dm_is_running_ds_session(rp_session->dm_session), subtrees, count, subtree_ids);
-    if (SR_ERR_OK != rc && SR_ERR_NOT_FOUND != rc) {
-        SR_LOG_ERR("Get subtrees failed for xpath '%s'", xpath);
-    }
+int
+rp_dt_get_subtrees_gpb_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+    size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, Sr__Node ***subtrees, size_t *count,
+    char ***subtree_ids)
+{
+    CHECK_NULL_ARG3(xpath, subtrees, count);
 
-cleanup:
-    if (SR_ERR_NOT_FOUND == rc || (SR_ERR_OK == rc && (0 == count || NULL == data_tree))) {
-        if (SR_ERR_OK != rp_dt_validate_node_xpath(rp_ctx->dm_ctx, rp_session->dm_session, xpath, NULL, NULL)) {
-            /* Print warning only, because we are not able to validate all xpath */
-            SR_LOG_WRN("Validation of xpath %s was not successful", xpath);
-        }
-        rc = SR_ERR_NOT_FOUND;
-    } else if (SR_ERR_UNAUTHORIZED == rc) {
-        rc = SR_ERR_NOT_FOUND;
-    }
-    rp_session->state = RP_REQ_FINISHED;
-    free(rp_session->module_name);
-    rp_session->module_name = NULL;
-    return rc;
+    return rp_dt_get_subtrees_internal(rp_ctx, rp_session, sr_mem, xpath, slice_offset, slice_width, child_limit,
+            depth_limit, NULL, subtrees, count, subtree_ids);
 }
 
 /**
@@ -1560,8 +1803,8 @@ rp_dt_get_changes(rp_ctx_t *rp_ctx, rp_session_t *rp_session, dm_commit_context_
 
     lookup.schema_info = schema_info;
 
-    ms = sr_btree_search(c_ctx->subscriptions, &lookup);
-    pthread_rwlock_unlock(&schema_info->model_lock);
+    ms = sr_omap_search(c_ctx->subscriptions, &lookup);
+    sr_rwlock_unlock(&schema_info->model_lock);
     if (NULL == ms) {
         SR_LOG_ERR("Module subscription not found for module %s", lookup.schema_info->module_name);
         rc = SR_ERR_INTERNAL;
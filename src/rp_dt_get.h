@@ -202,6 +202,24 @@ int rp_dt_get_subtree_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem
 int rp_dt_get_subtree_wrapper_with_opts(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
         size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtree, char **subtree_id);
 
+/**
+ * @brief Returns the subtree (chunk) whose root node is referenced by the specified xpath as GPB tree.
+ * The tree is built directly from the data tree, without intermediate sysrepo tree.
+ * @param [in] rp_ctx
+ * @param [in] rp_session
+ * @param [in] sr_mem
+ * @param [in] xpath
+ * @param [in] slice_offset
+ * @param [in] slice_width
+ * @param [in] child_limit
+ * @param [in] depth_limit
+ * @param [out] subtree
+ * @param [out] subtree_id ID of the chunk, can be NULL if not needed.
+ * @return Error code (SR_ERR_OK on success), SR_ERR_NOT_FOUND, SR_ERR_UNKNOWN_MODEL, SR_ERR_BAD_ELEMENT
+ */
+int rp_dt_get_subtree_gpb_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, Sr__Node **subtree, char **subtree_id);
+
 /**
  * @brief Retrieves all subtrees with root nodes matching the specified xpath.
  * @param [in] rp_ctx
@@ -234,6 +252,26 @@ int rp_dt_get_subtrees_wrapper_with_opts(rp_ctx_t *rp_ctx, rp_session_t *rp_sess
         size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, sr_node_t **subtrees, size_t *count,
         char ***subtree_ids);
 
+/**
+ * @brief Retrieves all subtrees (chunks) with root nodes matching the specified xpath as GPB trees.
+ * The trees are built directly from the data tree, without intermediate sysrepo trees.
+ * @param [in] rp_ctx
+ * @param [in] rp_session
+ * @param [in] sr_mem
+ * @param [in] xpath
+ * @param [in] slice_offset
+ * @param [in] slice_width
+ * @param [in] child_limit
+ * @param [in] depth_limit
+ * @param [out] subtrees
+ * @param [out] count
+ * @param [out] subtree_ids IDs of the chunks, can be NULL if not needed.
+ * @return Error code (SR_ERR_OK on success), SR_ERR_NOT_FOUND, SR_ERR_UNKNOWN_MODEL, SR_ERR_BAD_ELEMENT
+ */
+int rp_dt_get_subtrees_gpb_wrapper(rp_ctx_t *rp_ctx, rp_session_t *rp_session, sr_mem_ctx_t *sr_mem, const char *xpath,
+        size_t slice_offset, size_t slice_width, size_t child_limit, size_t depth_limit, Sr__Node ***subtrees, size_t *count,
+        char ***subtree_ids);
+
 /**
  * @brief Transforms difflist to the set of changes
  * @param [in] difflist
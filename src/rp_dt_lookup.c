@@ -65,7 +65,7 @@ rp_dt_find_nodes(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, const char
                 res->number--;
             }
         }
-        pthread_rwlock_unlock(&si->model_lock);
+        sr_rwlock_unlock(&si->model_lock);
     }
 
     if (0 == res->number) {
@@ -77,6 +77,96 @@ rp_dt_find_nodes(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, const char
 
 }
 
+/**
+ * @brief Returns NACM profile of the session user and locks the schema info of the data tree
+ * the node belongs to. If NACM does not apply to the user, schema info is not locked.
+ */
+static int
+rp_dt_nacm_lock(const dm_ctx_t *dm_ctx, dm_session_t *dm_session, const struct lyd_node *node,
+        nacm_profile_t *profile, dm_schema_info_t **schema_info)
+{
+    CHECK_NULL_ARG5(dm_ctx, dm_session, node, profile, schema_info);
+    int rc = SR_ERR_OK;
+
+    *schema_info = NULL;
+    rc = dm_nacm_get_profile((dm_ctx_t *) dm_ctx, dm_session, profile);
+    CHECK_RC_MSG_RETURN(rc, "Failed to get NACM profile");
+    if (profile->bypass) {
+        return SR_ERR_OK;
+    }
+
+    /* top-level nodes always belong to the module of the data tree */
+    while (NULL != node->parent) {
+        node = node->parent;
+    }
+    rc = dm_get_module_and_lock((dm_ctx_t *) dm_ctx, lys_node_module(node->schema)->name, schema_info);
+    CHECK_RC_LOG_RETURN(rc, "Get schema info failed for %s", lys_node_module(node->schema)->name);
+
+    return SR_ERR_OK;
+}
+
+int
+rp_dt_nacm_filter_nodes(const dm_ctx_t *dm_ctx, dm_session_t *dm_session, uint8_t access, struct ly_set *nodes)
+{
+    CHECK_NULL_ARG3(dm_ctx, dm_session, nodes);
+    int rc = SR_ERR_OK;
+    nacm_profile_t profile = {0};
+    dm_schema_info_t *si = NULL;
+
+    if (0 == nodes->number) {
+        return SR_ERR_NOT_FOUND;
+    }
+
+    rc = rp_dt_nacm_lock(dm_ctx, dm_session, nodes->set.d[0], &profile, &si);
+    CHECK_RC_MSG_RETURN(rc, "NACM check can not be done");
+    if (profile.bypass) {
+        return SR_ERR_OK;
+    }
+
+    for (int i = nodes->number - 1; i >= 0; i--) {
+        if (!dm_nacm_check_node(nodes->set.d[i]->schema, &profile, access)) {
+            memmove(&nodes->set.d[i],
+                    &nodes->set.d[i + 1],
+                    (nodes->number - i - 1) * sizeof (*nodes->set.d));
+            nodes->number--;
+        }
+    }
+    sr_rwlock_unlock(&si->model_lock);
+
+    return 0 == nodes->number ? SR_ERR_NOT_FOUND : SR_ERR_OK;
+}
+
+int
+rp_dt_nacm_check_node(const dm_ctx_t *dm_ctx, dm_session_t *dm_session, uint8_t access, bool with_descendants, struct lyd_node *node)
+{
+    CHECK_NULL_ARG3(dm_ctx, dm_session, node);
+    int rc = SR_ERR_OK;
+    nacm_profile_t profile = {0};
+    dm_schema_info_t *si = NULL;
+    struct lyd_node *next = NULL, *iter = NULL;
+
+    rc = rp_dt_nacm_lock(dm_ctx, dm_session, node, &profile, &si);
+    CHECK_RC_MSG_RETURN(rc, "NACM check can not be done");
+    if (profile.bypass) {
+        return SR_ERR_OK;
+    }
+
+    if (with_descendants) {
+        LY_TREE_DFS_BEGIN(node, next, iter) {
+            if (!dm_nacm_check_node(iter->schema, &profile, access)) {
+                rc = SR_ERR_UNAUTHORIZED;
+                break;
+            }
+            LYD_TREE_DFS_END(node, next, iter);
+        }
+    } else if (!dm_nacm_check_node(node->schema, &profile, access)) {
+        rc = SR_ERR_UNAUTHORIZED;
+    }
+    sr_rwlock_unlock(&si->model_lock);
+
+    return rc;
+}
+
 int
 rp_dt_find_node(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, const char *xpath, bool check_enable, struct lyd_node **node)
 {
@@ -116,6 +206,9 @@ rp_dt_find_nodes_with_opts(const dm_ctx_t *dm_ctx, dm_session_t *dm_session, rp_
         ly_set_free(get_items_ctx->nodes);
         get_items_ctx->nodes = NULL;
         rc = rp_dt_find_nodes(dm_ctx, data_tree, xpath, dm_is_running_ds_session(dm_session), &get_items_ctx->nodes);
+        if (SR_ERR_OK == rc) {
+            rc = rp_dt_nacm_filter_nodes(dm_ctx, dm_session, NACM_ACCESS_READ, get_items_ctx->nodes);
+        }
 
         if (SR_ERR_OK != rc) {
             if (SR_ERR_NOT_FOUND != rc) {
@@ -73,6 +73,28 @@ int rp_dt_find_node(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, const ch
  */
 int rp_dt_find_nodes(const dm_ctx_t *dm_ctx, struct lyd_node *data_tree, const char *xpath, bool check_enable, struct ly_set **nodes);
 
+/**
+ * @brief Removes the nodes the user of the session is not allowed to access by NACM rules
+ * from the set. All nodes are expected to be from the same data tree.
+ * @param [in] dm_ctx
+ * @param [in] dm_session
+ * @param [in] access NACM_ACCESS_READ keeps readable nodes, 0 keeps only the nodes whose whole subtree is readable
+ * @param [in,out] nodes
+ * @return Error code (SR_ERR_OK on success), SR_ERR_NOT_FOUND if no node is left
+ */
+int rp_dt_nacm_filter_nodes(const dm_ctx_t *dm_ctx, dm_session_t *dm_session, uint8_t access, struct ly_set *nodes);
+
+/**
+ * @brief Checks whether NACM rules allow the user of the session to access the node.
+ * @param [in] dm_ctx
+ * @param [in] dm_session
+ * @param [in] access NACM_ACCESS_* operations (all of them have to be allowed) or 0 for reading of the whole subtree
+ * @param [in] with_descendants if set, the access to all descendants of the node is checked as well
+ * @param [in] node
+ * @return Error code (SR_ERR_OK on success), SR_ERR_UNAUTHORIZED if the access is denied
+ */
+int rp_dt_nacm_check_node(const dm_ctx_t *dm_ctx, dm_session_t *dm_session, uint8_t access, bool with_descendants, struct lyd_node *node);
+
 /**
  * @brief Find matching changes
  * @param [in] dm_ctx
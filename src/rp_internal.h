@@ -27,9 +27,18 @@
 #include "data_manager.h"
 #include "notification_processor.h"
 #include "persistence_manager.h"
+#include "rp_stats.h"
 
 #define RP_THREAD_COUNT 4  /**< Number of threads that RP uses for processing. */
 
+/**
+ * @brief List of the active sessions of Request Processor.
+ */
+typedef struct rp_session_list_s {
+    sr_llist_t *sessions;                    /**< Active sessions (rp_session_t). */
+    pthread_mutex_t mutex;                   /**< Mutex guarding the list, sessions in the list are not released while held. */
+} rp_session_list_t;
+
 /**
  * @brief Structure that holds the context of an instance of Request Processor.
  */
@@ -41,16 +50,18 @@ typedef struct rp_ctx_s {
     pm_ctx_t *pm_ctx;                        /**< Persistence Manager context. */
 
     pthread_t thread_pool[RP_THREAD_COUNT];  /**< Thread pool. */
-    size_t active_threads;                   /**< Number of active (non-sleeping) threads. */
+    size_t active_threads;                   /**< Number of active (non-sleeping) threads (accessed atomically). */
     struct timespec last_thread_wakeup;      /**< Timestamp of the last thread wake-up event. */
-    size_t thread_spin_limit;                /**< Current limit of thread spinning before going to sleep. */
-    bool stop_requested;                     /**< Stopping of all threads has been requested. */
+    size_t thread_spin_limit;                /**< Current limit of thread spinning before going to sleep (accessed atomically). */
 
-    sr_cbuff_t *request_queue;               /**< Input request queue. */
-    pthread_mutex_t request_queue_mutex;     /**< Request queue mutex. */
-    pthread_cond_t request_queue_cv;         /**< Request queue condition variable. */
+    sr_ring_t *request_queue;                /**< Input request queue (lock-free, workers sleep in it when empty). */
+    pthread_mutex_t thread_wakeup_mutex;     /**< Mutex guarding the thread wake-up heuristic (spin limit, last wake-up). */
 
     pthread_rwlock_t commit_lock;            /**< Lock to synchronize commit in this instance */
+
+    rp_stats_t *stats;                       /**< Engine statistics. */
+    rp_session_list_t *session_list;         /**< Active sessions, idle ones are trimmed over the global memory budget. */
+    uint32_t slow_request_threshold;         /**< Processing time (in milliseconds) after which a request is logged as slow, 0 = disabled. */
 } rp_ctx_t;
 
 /**
@@ -115,10 +126,16 @@ typedef struct rp_session_s {
     rp_request_state_t state;            /**< the state of the request processing used if the operational data are requested */
     size_t dp_req_waiting;               /**< number of waiting request to operational data providers */
     Sr__Msg *req;                        /**< request that is waiting for operational data */
-    char *module_name;                   /**< data tree name used in the current request */
+    const char *module_name;             /**< data tree name used in the current request (interned) */
     pthread_mutex_t cur_req_mutex;       /**< mutex guarding information about currently processed request */
     sr_list_t **loaded_state_data;       /**< List of xpath for loaded state data in datastore */
     rp_state_data_ctx_t state_data_ctx;  /**< Context used during state data loading */
+    struct timespec req_start;           /**< Time when processing of the current request started (CLOCK_MONOTONIC) */
+    struct timespec req_wait_start;      /**< Time when the current request was paused to wait for data providers or verifiers */
+    uint64_t req_wait_time;              /**< Time the current request spent waiting for data providers or verifiers (in microseconds) */
+    struct rp_stats_session_s *stats;    /**< Statistics of the session (NULL if not registered) */
+    sr_llist_node_t *ll_node;            /**< Node of the session in the list of active sessions (NULL if not listed) */
+    struct timespec req_end;             /**< Time when the last request of the session was completed (CLOCK_MONOTONIC, guarded by the session list mutex) */
 } rp_session_t;
 
 #endif /* RP_INTERNAL_H_ */
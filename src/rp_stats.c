@@ -0,0 +1,646 @@
+/**
+ * @file rp_stats.c
+ * @brief Runtime statistics of Sysrepo Engine provided as operational data.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "sr_common.h"
+#include "rp_internal.h"
+#include "rp_stats.h"
+
+#define RP_STATS_MAX_OPERATION 128  /**< Size of the per-operation table (indexed by Sr__Operation values). */
+
+#define RP_STATS_XPATH "/" RP_STATS_MODULE_NAME ":sysrepo-statistics"  /**< XPath of the statistics container. */
+
+/**
+ * @brief Number of occurrences and duration of an activity.
+ */
+typedef struct rp_stats_latency_s {
+    uint64_t count;    /**< Number of occurrences. */
+    uint64_t total;    /**< Total duration (in microseconds). */
+    uint64_t max;      /**< Maximum duration (in microseconds). */
+} rp_stats_latency_t;
+
+/**
+ * @brief Statistics of one operation.
+ */
+typedef struct rp_stats_operation_s {
+    rp_stats_latency_t latency;                 /**< Processing time. */
+    uint64_t errors;                            /**< Number of failed requests. */
+    uint64_t hist[RP_STATS_LATENCY_BUCKETS];    /**< Histogram of processing times. */
+} rp_stats_operation_t;
+
+/**
+ * @brief Statistics of one session.
+ */
+struct rp_stats_session_s {
+    const rp_session_t *session;   /**< Request Processor session. */
+    sr_llist_node_t *ll_node;      /**< Node of the session in the list of sessions. */
+    size_t resp_mem_last;          /**< Size of the memory context of the last response (in bytes). */
+    size_t resp_mem_peak;          /**< Maximum size of the memory context of a response (in bytes). */
+};
+
+/**
+ * @brief Memory usage of one session, as reported in the statistics.
+ */
+typedef struct rp_stats_session_mem_s {
+    uint32_t id;                   /**< Session ID. */
+    dm_mem_usage_t data_trees;     /**< Data trees loaded in the session. */
+    size_t resp_mem_last;          /**< Size of the memory context of the last response (in bytes). */
+    size_t resp_mem_peak;          /**< Maximum size of the memory context of a response (in bytes). */
+} rp_stats_session_mem_t;
+
+/**
+ * @brief Engine statistics context.
+ */
+struct rp_stats_s {
+    pthread_mutex_t mutex;                                     /**< Mutex guarding all the counters. */
+    rp_stats_operation_t operations[RP_STATS_MAX_OPERATION];  /**< Statistics of the requests per operation. */
+    rp_stats_latency_t commit_stages[DM_COMMIT_FINISHED];     /**< Durations of the commit stages. */
+    uint64_t notifications[RP_STATS_NOTIF_COUNT];             /**< Messages sent to the subscribers per kind. */
+    uint32_t sessions;                                         /**< Number of active sessions. */
+    uint32_t connections;                                      /**< Number of active connections. */
+    sr_llist_t *session_list;                                  /**< Statistics of the active sessions (rp_stats_session_t). */
+};
+
+/**
+ * @brief Names of the notification leaves per kind.
+ */
+static const char * const rp_stats_notif_names[RP_STATS_NOTIF_COUNT] = {
+    [RP_STATS_NOTIF_CHANGE] = "change-notifications",
+    [RP_STATS_NOTIF_EVENT] = "event-notifications",
+    [RP_STATS_NOTIF_DATA_REQUEST] = "data-provider-requests",
+    [RP_STATS_NOTIF_RPC] = "rpc-requests",
+};
+
+int
+rp_stats_init(rp_stats_t **stats_p)
+{
+    CHECK_NULL_ARG(stats_p);
+    rp_stats_t *stats = NULL;
+
+    stats = calloc(1, sizeof *stats);
+    CHECK_NULL_NOMEM_RETURN(stats);
+
+    if (SR_ERR_OK != sr_llist_init(&stats->session_list)) {
+        free(stats);
+        return SR_ERR_NOMEM;
+    }
+
+    pthread_mutex_init(&stats->mutex, NULL);
+
+    *stats_p = stats;
+    return SR_ERR_OK;
+}
+
+void
+rp_stats_cleanup(rp_stats_t *stats)
+{
+    sr_llist_node_t *node = NULL;
+
+    if (NULL != stats) {
+        for (node = stats->session_list->first; NULL != node; node = node->next) {
+            free(node->data);
+        }
+        sr_llist_cleanup(stats->session_list);
+        pthread_mutex_destroy(&stats->mutex);
+        free(stats);
+    }
+}
+
+/**
+ * @brief Adds an occurrence of an activity into its statistics.
+ */
+static void
+rp_stats_latency_add(rp_stats_latency_t *latency, uint64_t time)
+{
+    latency->count += 1;
+    latency->total += time;
+    if (time > latency->max) {
+        latency->max = time;
+    }
+}
+
+void
+rp_stats_request(const rp_ctx_t *rp_ctx, Sr__Operation operation, uint64_t time, bool failed)
+{
+    rp_stats_operation_t *op_stats = NULL;
+    size_t bucket = 0;
+
+    if (NULL == rp_ctx || NULL == rp_ctx->stats || (int) operation < 0 || operation >= RP_STATS_MAX_OPERATION) {
+        return;
+    }
+
+    while ((time >> bucket) && bucket < RP_STATS_LATENCY_BUCKETS - 1) {
+        ++bucket;
+    }
+
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    op_stats = &rp_ctx->stats->operations[operation];
+    rp_stats_latency_add(&op_stats->latency, time);
+    op_stats->hist[bucket] += 1;
+    if (failed) {
+        op_stats->errors += 1;
+    }
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+}
+
+void
+rp_stats_commit_stage(const rp_ctx_t *rp_ctx, dm_commit_state_t stage, uint64_t time)
+{
+    if (NULL == rp_ctx || NULL == rp_ctx->stats || DM_COMMIT_STARTED == stage || stage >= DM_COMMIT_FINISHED) {
+        return;
+    }
+
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    rp_stats_latency_add(&rp_ctx->stats->commit_stages[stage], time);
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+}
+
+void
+rp_stats_notification(const rp_ctx_t *rp_ctx, rp_stats_notif_t kind)
+{
+    if (NULL == rp_ctx || NULL == rp_ctx->stats || kind >= RP_STATS_NOTIF_COUNT) {
+        return;
+    }
+
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    rp_ctx->stats->notifications[kind] += 1;
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+}
+
+void
+rp_stats_session(const rp_ctx_t *rp_ctx, rp_session_t *session, bool started)
+{
+    rp_stats_session_t *sess_stats = NULL;
+
+    if (NULL == rp_ctx || NULL == rp_ctx->stats || NULL == session) {
+        return;
+    }
+
+    if (started) {
+        sess_stats = calloc(1, sizeof *sess_stats);
+        if (NULL == sess_stats) {
+            SR_LOG_WRN("Unable to allocate statistics of session %"PRIu32".", session->id);
+        } else {
+            sess_stats->session = session;
+        }
+    }
+
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    if (started) {
+        rp_ctx->stats->sessions += 1;
+        if (NULL != sess_stats) {
+            if (SR_ERR_OK == sr_llist_add_new(rp_ctx->stats->session_list, sess_stats)) {
+                sess_stats->ll_node = rp_ctx->stats->session_list->last;
+                session->stats = sess_stats;
+            } else {
+                free(sess_stats);
+            }
+        }
+    } else {
+        if (rp_ctx->stats->sessions > 0) {
+            rp_ctx->stats->sessions -= 1;
+        }
+        if (NULL != session->stats) {
+            sr_llist_rm(rp_ctx->stats->session_list, session->stats->ll_node);
+            free(session->stats);
+            session->stats = NULL;
+        }
+    }
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+}
+
+void
+rp_stats_response(const rp_ctx_t *rp_ctx, const rp_session_t *session, const Sr__Msg *resp)
+{
+    sr_mem_ctx_t *sr_mem = NULL;
+
+    if (NULL == rp_ctx || NULL == rp_ctx->stats || NULL == session || NULL == session->stats || NULL == resp) {
+        return;
+    }
+
+    sr_mem = (sr_mem_ctx_t *) resp->_sysrepo_mem_ctx;
+    if (NULL == sr_mem) {
+        return;
+    }
+
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    session->stats->resp_mem_last = sr_mem->size_total;
+    if (sr_mem->size_total > session->stats->resp_mem_peak) {
+        session->stats->resp_mem_peak = sr_mem->size_total;
+    }
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+}
+
+void
+rp_stats_connection(const rp_ctx_t *rp_ctx, bool opened)
+{
+    if (NULL == rp_ctx || NULL == rp_ctx->stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    if (opened) {
+        rp_ctx->stats->connections += 1;
+    } else if (rp_ctx->stats->connections > 0) {
+        rp_ctx->stats->connections -= 1;
+    }
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+}
+
+/**
+ * @brief Creates a leaf in the data tree of the statistics module.
+ *
+ * @param [in] info Data tree of the statistics module.
+ * @param [in] value Value of the leaf.
+ * @param [in] format Format of the XPath of the leaf relative to the statistics container.
+ *
+ * @return Error code (SR_ERR_OK on success)
+ */
+static int
+rp_stats_set_leaf(dm_data_info_t *info, uint64_t value, const char *format, ...)
+{
+    char xpath[PATH_MAX] = { 0, };
+    char value_str[21] = { 0, };
+    struct lyd_node *node = NULL;
+    va_list va;
+    size_t len = 0;
+
+    len = snprintf(xpath, PATH_MAX, "%s", RP_STATS_XPATH);
+    va_start(va, format);
+    vsnprintf(xpath + len, PATH_MAX - len, format, va);
+    va_end(va);
+
+    snprintf(value_str, sizeof value_str, "%" PRIu64, value);
+
+    ly_errno = 0;
+    node = dm_lyd_new_path(info, xpath, value_str, LYD_PATH_OPT_UPDATE);
+    if (NULL == node && LY_SUCCESS != ly_errno) {
+        SR_LOG_ERR("Failed to create statistics node %s: %s", xpath, ly_errmsg());
+        return SR_ERR_INTERNAL;
+    }
+
+    return SR_ERR_OK;
+}
+
+/**
+ * @brief Creates leaves of a latency-stats grouping.
+ */
+static int
+rp_stats_set_latency(dm_data_info_t *info, const rp_stats_latency_t *latency, const char *list_xpath)
+{
+    int rc = SR_ERR_OK;
+
+    rc = rp_stats_set_leaf(info, latency->count, "%s/count", list_xpath);
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, latency->total, "%s/total-time", list_xpath);
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, latency->max, "%s/max-time", list_xpath);
+    }
+
+    return rc;
+}
+
+/**
+ * @brief Creates the statistics of the datastore and module locks.
+ */
+static int
+rp_stats_set_session_locks(dm_data_info_t *info, const dm_lock_stats_t *locks, size_t lock_cnt)
+{
+    char list_xpath[PATH_MAX] = { 0, };
+    int rc = SR_ERR_OK;
+
+    for (size_t i = 0; SR_ERR_OK == rc && i < lock_cnt; ++i) {
+        if (NULL == locks[i].module_name) {
+            snprintf(list_xpath, PATH_MAX, "/locks/datastore-lock[datastore='%s']", sr_ds_to_str(locks[i].datastore));
+        } else {
+            snprintf(list_xpath, PATH_MAX, "/locks/module-lock[name='%s'][datastore='%s']",
+                    locks[i].module_name, sr_ds_to_str(locks[i].datastore));
+        }
+        rc = rp_stats_set_leaf(info, locks[i].stats.acquired, "%s/acquisitions", list_xpath);
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].stats.contended, "%s/contended", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].stats.timeouts, "%s/timeouts", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].stats.wait_time, "%s/wait-time", list_xpath);
+        }
+    }
+
+    return rc;
+}
+
+#ifdef ENABLE_LOCK_STATS
+/**
+ * @brief Creates the statistics of the named engine locks.
+ */
+static int
+rp_stats_set_locks(dm_data_info_t *info)
+{
+    sr_lockstat_t *locks = NULL;
+    size_t lock_cnt = 0;
+    char list_xpath[PATH_MAX] = { 0, };
+    int rc = SR_ERR_OK;
+
+    rc = sr_lockstat_get(&locks, &lock_cnt);
+    CHECK_RC_MSG_RETURN(rc, "Failed to get lock statistics");
+
+    for (size_t i = 0; SR_ERR_OK == rc && i < lock_cnt; ++i) {
+        snprintf(list_xpath, PATH_MAX, "/locks/lock[name='%s']", locks[i].name);
+        rc = rp_stats_set_leaf(info, locks[i].acquisitions, "%s/acquisitions", list_xpath);
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].wait_total, "%s/wait-total-time", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].wait_max, "%s/wait-max-time", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].hold_total, "%s/hold-total-time", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, locks[i].hold_max, "%s/hold-max-time", list_xpath);
+        }
+        for (size_t b = 0; SR_ERR_OK == rc && b < SR_LOCKSTAT_HIST_SIZE; ++b) {
+            if (0 != locks[i].wait_hist[b]) {
+                rc = rp_stats_set_leaf(info, locks[i].wait_hist[b], "%s/wait-bucket[upper-bound='%" PRIu64 "']/count",
+                        list_xpath, SR_LOCKSTAT_HIST_SIZE - 1 == b ? UINT64_MAX : ((uint64_t)1 << b));
+            }
+        }
+    }
+
+    free(locks);
+    return rc;
+}
+#endif
+
+int
+rp_stats_enable(rp_ctx_t *rp_ctx)
+{
+    CHECK_NULL_ARG2(rp_ctx, rp_ctx->dm_ctx);
+    int rc = SR_ERR_OK;
+
+    /* nobody subscribes for the module, enable it in running to make its state data visible */
+    rc = dm_load_internal_module(rp_ctx->dm_ctx, RP_STATS_MODULE_NAME);
+    CHECK_RC_MSG_RETURN(rc, "Failed to enable statistics module in running datastore");
+
+    return rc;
+}
+
+int
+rp_stats_load_data(rp_ctx_t *rp_ctx, rp_session_t *session)
+{
+    CHECK_NULL_ARG3(rp_ctx, rp_ctx->stats, session);
+    rp_stats_t *snapshot = NULL;
+    dm_data_info_t *info = NULL;
+    dm_module_usage_t *usage = NULL;
+    dm_mem_stats_t mem_stats = { 0, };
+    dm_mem_usage_t commit_usage = { 0, };
+    sr_mem_stats_t sr_mem_stats = { 0, };
+    rp_stats_session_mem_t *sessions = NULL;
+    const rp_stats_session_t *sess_stats = NULL;
+    cm_connection_mem_t *conns = NULL;
+    dm_lock_stats_t *locks = NULL;
+    sr_llist_node_t *node = NULL;
+    size_t usage_cnt = 0, lock_cnt = 0, queue_depth = 0, active_threads = 0;
+    size_t session_cnt = 0, conn_cnt = 0, commit_cnt = 0, interned_cnt = 0, interned_bytes = 0;
+    uint64_t ac_hits = 0, ac_probes = 0;
+    char list_xpath[PATH_MAX] = { 0, };
+    char *loaded_xpath = NULL;
+    int rc = SR_ERR_OK;
+
+    /* take a snapshot of the counters */
+    snapshot = calloc(1, sizeof *snapshot);
+    CHECK_NULL_NOMEM_RETURN(snapshot);
+    pthread_mutex_lock(&rp_ctx->stats->mutex);
+    memcpy(snapshot, rp_ctx->stats, sizeof *snapshot);
+    sessions = calloc(rp_ctx->stats->sessions + 1, sizeof *sessions);
+    for (node = rp_ctx->stats->session_list->first; NULL != sessions && NULL != node && session_cnt <= rp_ctx->stats->sessions;
+            node = node->next) {
+        sess_stats = (const rp_stats_session_t *) node->data;
+        sessions[session_cnt].id = sess_stats->session->id;
+        dm_get_session_mem_usage(sess_stats->session->dm_session, &sessions[session_cnt].data_trees);
+        sessions[session_cnt].resp_mem_last = sess_stats->resp_mem_last;
+        sessions[session_cnt].resp_mem_peak = sess_stats->resp_mem_peak;
+        ++session_cnt;
+    }
+    pthread_mutex_unlock(&rp_ctx->stats->mutex);
+    CHECK_NULL_NOMEM_GOTO(sessions, rc, cleanup);
+
+    queue_depth = sr_ring_count(rp_ctx->request_queue);
+    active_threads = __atomic_load_n(&rp_ctx->active_threads, __ATOMIC_RELAXED);
+
+    rc = dm_get_module_usage(rp_ctx->dm_ctx, &usage, &usage_cnt);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get usage of the modules");
+
+    rc = dm_get_commit_ctxs_usage(rp_ctx->dm_ctx, &commit_cnt, &commit_usage);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get usage of the commit contexts");
+
+    rc = cm_get_connections_mem(rp_ctx->cm_ctx, &conns, &conn_cnt);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get buffer sizes of the connections");
+
+    rc = dm_get_lock_stats(rp_ctx->dm_ctx, &locks, &lock_cnt);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get statistics of the locks");
+
+    rc = ac_get_cache_stats(rp_ctx->ac_ctx, &ac_hits, &ac_probes);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get statistics of the access control cache");
+
+    sr_mem_get_stats(&sr_mem_stats);
+    sr_str_intern_stats(&interned_cnt, &interned_bytes);
+
+    rc = dm_get_data_info(rp_ctx->dm_ctx, session->dm_session, RP_STATS_MODULE_NAME, &info);
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to get data tree of statistics module");
+
+    /* requests */
+    for (size_t op = 0; SR_ERR_OK == rc && op < RP_STATS_MAX_OPERATION; ++op) {
+        const rp_stats_operation_t *op_stats = &snapshot->operations[op];
+        if (0 == op_stats->latency.count) {
+            continue;
+        }
+        snprintf(list_xpath, PATH_MAX, "/requests/operation[name='%s']", sr_gpb_operation_name(op));
+        rc = rp_stats_set_latency(info, &op_stats->latency, list_xpath);
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, op_stats->errors, "%s/errors", list_xpath);
+        }
+        for (size_t b = 0; SR_ERR_OK == rc && b < RP_STATS_LATENCY_BUCKETS; ++b) {
+            if (0 != op_stats->hist[b]) {
+                rc = rp_stats_set_leaf(info, op_stats->hist[b], "%s/latency-bucket[upper-bound='%" PRIu64 "']/count",
+                        list_xpath, RP_STATS_LATENCY_BUCKETS - 1 == b ? UINT64_MAX : ((uint64_t)1 << b));
+            }
+        }
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill request statistics");
+
+    /* request processor and connection manager */
+    rc = rp_stats_set_leaf(info, queue_depth, "/request-processor/request-queue-depth");
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, active_threads, "/request-processor/active-threads");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, snapshot->sessions, "/request-processor/sessions");
+    }
+    for (size_t i = 0; SR_ERR_OK == rc && i < session_cnt; ++i) {
+        snprintf(list_xpath, PATH_MAX, "/request-processor/session[id='%"PRIu32"']", sessions[i].id);
+        rc = rp_stats_set_leaf(info, sessions[i].data_trees.tree_cnt, "%s/data-trees", list_xpath);
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, sessions[i].data_trees.node_cnt, "%s/data-tree-nodes", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, sessions[i].data_trees.mem_size, "%s/data-tree-bytes", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, sessions[i].resp_mem_last, "%s/last-response-memory", list_xpath);
+        }
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, sessions[i].resp_mem_peak, "%s/peak-response-memory", list_xpath);
+        }
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, snapshot->connections, "/connection-manager/connections");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, cm_get_msg_queue_depth(rp_ctx->cm_ctx), "/connection-manager/message-queue-depth");
+    }
+    for (size_t i = 0; SR_ERR_OK == rc && i < conn_cnt; ++i) {
+        snprintf(list_xpath, PATH_MAX, "/connection-manager/connection[fd='%d']", conns[i].fd);
+        rc = rp_stats_set_leaf(info, conns[i].in_buff_size, "%s/input-buffer-size", list_xpath);
+        if (SR_ERR_OK == rc) {
+            rc = rp_stats_set_leaf(info, conns[i].out_buff_size, "%s/output-buffer-size", list_xpath);
+        }
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill processor statistics");
+
+    /* data manager */
+    dm_get_mem_stats(rp_ctx->dm_ctx, &mem_stats);
+    rc = rp_stats_set_leaf(info, mem_stats.session_budget, "/data-manager/session-memory-budget");
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, mem_stats.global_budget, "/data-manager/global-memory-budget");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, mem_stats.used, "/data-manager/data-tree-memory");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, mem_stats.evictions, "/data-manager/evicted-data-trees");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, mem_stats.reloads, "/data-manager/reloaded-data-trees");
+    }
+    for (size_t i = 0; SR_ERR_OK == rc && i < usage_cnt; ++i) {
+        snprintf(list_xpath, PATH_MAX, "/data-manager/module[name='%s']", usage[i].module_name);
+        rc = rp_stats_set_leaf(info, usage[i].data_tree_cnt, "%s/loaded-data-trees", list_xpath);
+        for (size_t ds = 0; SR_ERR_OK == rc && ds < DM_DATASTORE_COUNT; ++ds) {
+            const dm_mem_usage_t *ds_usage = &usage[i].mem_usage[ds];
+            if (0 == ds_usage->tree_cnt) {
+                continue;
+            }
+            rc = rp_stats_set_leaf(info, ds_usage->tree_cnt, "%s/datastore[name='%s']/data-trees",
+                    list_xpath, sr_ds_to_str(ds));
+            if (SR_ERR_OK == rc) {
+                rc = rp_stats_set_leaf(info, ds_usage->node_cnt, "%s/datastore[name='%s']/data-tree-nodes",
+                        list_xpath, sr_ds_to_str(ds));
+            }
+            if (SR_ERR_OK == rc) {
+                rc = rp_stats_set_leaf(info, ds_usage->mem_size, "%s/datastore[name='%s']/data-tree-bytes",
+                        list_xpath, sr_ds_to_str(ds));
+            }
+        }
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill data manager statistics");
+
+    /* commits */
+    for (dm_commit_state_t stage = DM_COMMIT_VALIDATION; SR_ERR_OK == rc && stage < DM_COMMIT_FINISHED; ++stage) {
+        if (0 != snapshot->commit_stages[stage].count) {
+            snprintf(list_xpath, PATH_MAX, "/commits/stage[name='%s']", dm_commit_state_to_str(stage));
+            rc = rp_stats_set_latency(info, &snapshot->commit_stages[stage], list_xpath);
+        }
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, commit_cnt, "/commits/retained-contexts");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, commit_usage.tree_cnt, "/commits/retained-data-trees");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, commit_usage.node_cnt, "/commits/retained-data-tree-nodes");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, commit_usage.mem_size, "/commits/retained-data-tree-bytes");
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill commit statistics");
+
+    /* memory management */
+    rc = rp_stats_set_leaf(info, sr_mem_stats.thread_cached_bytes, "/memory-management/thread-cached-bytes");
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, sr_mem_stats.global_cached_bytes, "/memory-management/global-cached-bytes");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, interned_cnt, "/memory-management/interned-strings");
+    }
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, interned_bytes, "/memory-management/interned-string-bytes");
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill memory management statistics");
+
+    /* access control */
+    rc = rp_stats_set_leaf(info, ac_hits, "/access-control/decision-cache-hits");
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_leaf(info, ac_probes, "/access-control/decision-cache-probes");
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill access control statistics");
+
+    /* notifications */
+    for (size_t kind = 0; SR_ERR_OK == rc && kind < RP_STATS_NOTIF_COUNT; ++kind) {
+        rc = rp_stats_set_leaf(info, snapshot->notifications[kind], "/notifications/%s", rp_stats_notif_names[kind]);
+    }
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill notification statistics");
+
+    /* locks */
+    rc = rp_stats_set_session_locks(info, locks, lock_cnt);
+#ifdef ENABLE_LOCK_STATS
+    if (SR_ERR_OK == rc) {
+        rc = rp_stats_set_locks(info);
+    }
+#endif
+    CHECK_RC_MSG_GOTO(rc, cleanup, "Failed to fill lock statistics");
+
+cleanup:
+    if (NULL != info && NULL != info->node) {
+        /* remove the statistics from the data tree with the next request */
+        loaded_xpath = strdup(RP_STATS_XPATH);
+        if (NULL == loaded_xpath) {
+            rc = SR_ERR_NOMEM;
+        } else if (SR_ERR_OK != sr_list_add(session->loaded_state_data[session->datastore], loaded_xpath)) {
+            free(loaded_xpath);
+            rc = SR_ERR_NOMEM;
+        }
+    }
+    dm_free_module_usage(usage, usage_cnt);
+    dm_free_lock_stats(locks, lock_cnt);
+    free(conns);
+    free(sessions);
+    free(snapshot);
+    return rc;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file rp_stats.h
+ * @brief Runtime statistics of Sysrepo Engine provided as operational data.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RP_STATS_H_
+#define RP_STATS_H_
+
+#include "sr_common.h"
+#include "request_processor.h"
+#include "data_manager.h"
+
+/**
+ * @defgroup rp_stats Engine Statistics
+ * @ingroup rp
+ * @{
+ *
+ * @brief Counters of the engine activity. The statistics are exposed as state data of the
+ * ::RP_STATS_MODULE_NAME module, which are provided by the engine itself whenever they are requested.
+ */
+
+/**
+ * @brief Name of the YANG module with engine statistics.
+ */
+#define RP_STATS_MODULE_NAME "sysrepo-statistics"
+
+/**
+ * @brief Number of buckets of the request latency histogram. Bucket i counts requests processed
+ * in [2^(i-1), 2^i) microseconds, the last bucket counts all slower requests.
+ */
+#define RP_STATS_LATENCY_BUCKETS 24
+
+/**
+ * @brief Kinds of messages sent to subscribers.
+ */
+typedef enum rp_stats_notif_e {
+    RP_STATS_NOTIF_CHANGE,        /**< Module / subtree change notification. */
+    RP_STATS_NOTIF_EVENT,         /**< Event notification. */
+    RP_STATS_NOTIF_DATA_REQUEST,  /**< Request for operational data. */
+    RP_STATS_NOTIF_RPC,           /**< RPC or action request. */
+    RP_STATS_NOTIF_COUNT,         /**< Number of the kinds (not a valid kind). */
+} rp_stats_notif_t;
+
+/**
+ * @brief Engine statistics context (opaque).
+ */
+typedef struct rp_stats_s rp_stats_t;
+
+/**
+ * @brief Statistics of one session (opaque).
+ */
+typedef struct rp_stats_session_s rp_stats_session_t;
+
+/**
+ * @brief Allocates and initializes engine statistics.
+ *
+ * @param [out] stats Allocated statistics context.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int rp_stats_init(rp_stats_t **stats);
+
+/**
+ * @brief Frees engine statistics.
+ *
+ * @param [in] stats Statistics context.
+ */
+void rp_stats_cleanup(rp_stats_t *stats);
+
+/**
+ * @brief Records processing of a request.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] operation Requested operation.
+ * @param [in] time Processing time (in microseconds).
+ * @param [in] failed TRUE if the request has failed.
+ */
+void rp_stats_request(const rp_ctx_t *rp_ctx, Sr__Operation operation, uint64_t time, bool failed);
+
+/**
+ * @brief Records a finished stage of a commit.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] stage Commit stage.
+ * @param [in] time Duration of the stage (in microseconds).
+ */
+void rp_stats_commit_stage(const rp_ctx_t *rp_ctx, dm_commit_state_t stage, uint64_t time);
+
+/**
+ * @brief Records a message sent to a subscriber.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] kind Kind of the message.
+ */
+void rp_stats_notification(const rp_ctx_t *rp_ctx, rp_stats_notif_t kind);
+
+/**
+ * @brief Updates the number of active sessions and registers / unregisters the session
+ * in the statistics of the sessions.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] session Request Processor session.
+ * @param [in] started TRUE if the session has been started, FALSE if it is being stopped.
+ */
+void rp_stats_session(const rp_ctx_t *rp_ctx, rp_session_t *session, bool started);
+
+/**
+ * @brief Records the size of the Sysrepo memory context of a response sent to a session.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] session Request Processor session.
+ * @param [in] resp Response to be sent.
+ */
+void rp_stats_response(const rp_ctx_t *rp_ctx, const rp_session_t *session, const Sr__Msg *resp);
+
+/**
+ * @brief Updates the number of active connections.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] opened TRUE if a connection has been opened, FALSE if closed.
+ */
+void rp_stats_connection(const rp_ctx_t *rp_ctx, bool opened);
+
+/**
+ * @brief Loads ::RP_STATS_MODULE_NAME module from the internal schemas and enables it in the running
+ * datastore, so that the statistics can be read from it without any subscription. Nothing is written
+ * into the repository. Called once when Request Processor is initialized.
+ *
+ * @param [in] rp_ctx Request Processor context.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int rp_stats_enable(rp_ctx_t *rp_ctx);
+
+/**
+ * @brief Fills the current statistics into the session's data tree of ::RP_STATS_MODULE_NAME module.
+ * The data are removed from the data tree together with the state data received from
+ * data providers (see ::rp_dt_remove_loaded_state_data).
+ *
+ * @param [in] rp_ctx Request Processor context.
+ * @param [in] session Request Processor session.
+ *
+ * @return Error code (SR_ERR_OK on success).
+ */
+int rp_stats_load_data(rp_ctx_t *rp_ctx, rp_session_t *session);
+
+/**@} rp_stats */
+
+#endif /* RP_STATS_H_ */
@@ -26,6 +26,7 @@
 #include <setjmp.h>
 #include <cmocka.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 
 #include "sr_common.h"
 #include "access_control.h"
@@ -359,6 +360,132 @@ ac_test_negative(void **state)
     ac_cleanup(ctx);
 }
 
+/**
+ * @brief Test the decision cache shared by the sessions. Can be executed from both privileged an unprivileged processes.
+ */
+static void
+ac_test_decision_cache(void **state)
+{
+    ac_ctx_t *ctx = NULL;
+    ac_session_t *session1 = NULL, *session2 = NULL, *session3 = NULL;
+    uint64_t hits = 0, probes = 0;
+#ifdef HAVE_INOTIFY
+    struct stat st = { 0 };
+#endif
+    int rc = SR_ERR_OK;
+
+    /* set real user to current user */
+    ac_ucred_t credentials = { 0 };
+    credentials.r_username = getenv("USER");
+    credentials.r_uid = getuid();
+    credentials.r_gid = getgid();
+
+    /* init */
+    rc = ac_init(TEST_DATA_SEARCH_DIR, &ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_session_init(ctx, &credentials, &session1);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_session_init(ctx, &credentials, &session2);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* first session probes the data file */
+    rc = ac_check_node_permissions(session1, XP_TEST_MODULE_STRING, AC_OPER_READ_WRITE);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_get_cache_stats(ctx, &hits, &probes);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(hits, 0);
+    assert_int_equal(probes, 1);
+
+    /* second session with the same credentials reuses the decision */
+    rc = ac_check_node_permissions(session2, XP_TEST_MODULE_STRING, AC_OPER_READ_WRITE);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_get_cache_stats(ctx, &hits, &probes);
+    assert_int_equal(rc, SR_ERR_OK);
+#ifdef HAVE_INOTIFY
+    assert_int_equal(hits, 1);
+    assert_int_equal(probes, 1);
+
+    /* permission change of the data file drops the cache */
+    rc = stat(TEST_MODULE_DATA_FILE_NAME, &st);
+    assert_int_equal(rc, 0);
+    rc = chmod(TEST_MODULE_DATA_FILE_NAME, S_IRUSR | S_IWUSR);
+    assert_int_equal(rc, 0);
+#endif
+
+    rc = ac_session_init(ctx, &credentials, &session3);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_check_node_permissions(session3, XP_TEST_MODULE_STRING, AC_OPER_READ_WRITE);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_get_cache_stats(ctx, &hits, &probes);
+    assert_int_equal(rc, SR_ERR_OK);
+#ifdef HAVE_INOTIFY
+    assert_int_equal(hits, 1);
+    assert_int_equal(probes, 2);
+
+    /* restore the original permissions of the data file */
+    rc = chmod(TEST_MODULE_DATA_FILE_NAME, st.st_mode & 07777);
+    assert_int_equal(rc, 0);
+#endif
+
+    /* cleanup */
+    ac_session_cleanup(session1);
+    ac_session_cleanup(session2);
+    ac_session_cleanup(session3);
+    ac_cleanup(ctx);
+}
+
+/**
+ * @brief Test the cached decision about locking of a module. Can be executed from both privileged an unprivileged processes.
+ */
+static void
+ac_test_lock_permissions(void **state)
+{
+    ac_ctx_t *ctx = NULL;
+    char *lock_file = NULL;
+    uint64_t hits = 0, probes = 0;
+    int rc = SR_ERR_OK, fd = -1;
+
+    /* set real user to current user */
+    ac_ucred_t credentials = { 0 };
+    credentials.r_username = getenv("USER");
+    credentials.r_uid = getuid();
+    credentials.r_gid = getgid();
+
+    rc = sr_get_lock_data_file_name(TEST_DATA_SEARCH_DIR, "test-module", SR_DS_RUNNING, &lock_file);
+    assert_int_equal(rc, SR_ERR_OK);
+    fd = open(lock_file, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    assert_int_not_equal(fd, -1);
+    close(fd);
+
+    rc = ac_init(TEST_DATA_SEARCH_DIR, &ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* the first lock opens the lock file */
+    rc = ac_check_lock_permissions(ctx, &credentials, "test-module", SR_DS_RUNNING, lock_file);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_get_cache_stats(ctx, &hits, &probes);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(hits, 0);
+    assert_int_equal(probes, 1);
+
+    /* the next one is decided from the cache */
+    rc = ac_check_lock_permissions(ctx, &credentials, "test-module", SR_DS_RUNNING, lock_file);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = ac_get_cache_stats(ctx, &hits, &probes);
+    assert_int_equal(rc, SR_ERR_OK);
+#ifdef HAVE_INOTIFY
+    assert_int_equal(hits, 1);
+    assert_int_equal(probes, 1);
+#endif
+
+    /* unknown datastore is rejected */
+    rc = ac_check_lock_permissions(ctx, &credentials, "test-module", SR_DS_CANDIDATE + 1, lock_file);
+    assert_int_equal(rc, SR_ERR_INVAL_ARG);
+
+    ac_cleanup(ctx);
+    free(lock_file);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
@@ -366,6 +493,8 @@ main() {
             cmocka_unit_test_setup_teardown(ac_test_priviledged, ac_test_setup, ac_test_teardown),
             cmocka_unit_test_setup_teardown(ac_test_identity_switch, ac_test_setup, ac_test_teardown),
             cmocka_unit_test_setup_teardown(ac_test_negative, ac_test_setup, ac_test_teardown),
+            cmocka_unit_test_setup_teardown(ac_test_decision_cache, ac_test_setup, ac_test_teardown),
+            cmocka_unit_test_setup_teardown(ac_test_lock_permissions, ac_test_setup, ac_test_teardown),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
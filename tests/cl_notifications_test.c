@@ -239,6 +239,94 @@ cl_get_changes_create_test(void **state)
     assert_int_equal(rc, SR_ERR_OK);
 }
 
+/*
+ * Returns the number of GET_CHANGES requests processed by the engine so far.
+ */
+static uint64_t
+get_changes_request_cnt(sr_session_ctx_t *session)
+{
+    sr_val_t *value = NULL;
+    uint64_t cnt = 0;
+    int rc = SR_ERR_OK;
+
+    rc = sr_get_item(session, "/sysrepo-statistics:sysrepo-statistics/requests/operation[name='get-changes']/count", &value);
+    if (SR_ERR_NOT_FOUND == rc) {
+        /* no such request processed yet */
+        return 0;
+    }
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(SR_UINT64_T, value->type);
+    cnt = value->data.uint64_val;
+    sr_free_val(value);
+
+    return cnt;
+}
+
+static void
+cl_get_pushed_changes_test(void **state)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    sr_session_ctx_t *session = NULL;
+    sr_subscription_ctx_t *subscription = NULL;
+    changes_t changes = {.mutex = PTHREAD_MUTEX_INITIALIZER, .cv = PTHREAD_COND_INITIALIZER, 0};
+    struct timespec ts;
+    sr_val_t value = {0};
+    const char *xpath = "/test-module:main/ui8";
+    uint64_t get_changes_cnt = 0;
+    int rc = SR_ERR_OK;
+
+    /* start session */
+    rc = sr_session_start(conn, SR_DS_RUNNING, SR_SESS_DEFAULT, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* the changes are delivered within the notification */
+    rc = sr_module_change_subscribe(session, "test-module", list_changes_cb, &changes,
+            0, SR_SUBSCR_PUSH_CHANGES, &subscription);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    get_changes_cnt = get_changes_request_cnt(session);
+
+    value.type = SR_UINT8_T;
+    value.data.uint8_val = 19;
+    rc = sr_set_item(session, xpath, &value, SR_EDIT_DEFAULT);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    pthread_mutex_lock(&changes.mutex);
+    rc = sr_commit(session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    sr_clock_get_time(CLOCK_REALTIME, &ts);
+    ts.tv_sec += COND_WAIT_SEC;
+    pthread_cond_timedwait(&changes.cv, &changes.mutex, &ts);
+
+    assert_int_equal(changes.cnt, 1);
+    assert_int_equal(changes.oper[0], SR_OP_MODIFIED);
+    assert_non_null(changes.new_values[0]);
+    assert_non_null(changes.old_values[0]);
+    assert_string_equal(xpath, changes.new_values[0]->xpath);
+    assert_int_equal(19, changes.new_values[0]->data.uint8_val);
+
+    /* the callback has been served without asking the engine for the changes */
+    assert_int_equal(get_changes_cnt, get_changes_request_cnt(session));
+
+    for (size_t i = 0; i < changes.cnt; i++) {
+        sr_free_val(changes.new_values[i]);
+        sr_free_val(changes.old_values[i]);
+    }
+
+    pthread_mutex_unlock(&changes.mutex);
+
+    pthread_mutex_destroy(&changes.mutex);
+    pthread_cond_destroy(&changes.cv);
+
+    rc = sr_unsubscribe(NULL, subscription);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    rc = sr_session_stop(session);
+    assert_int_equal(rc, SR_ERR_OK);
+}
+
 static void
 cl_get_changes_modified_test(void **state)
 {
@@ -2395,6 +2483,7 @@ main()
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(cl_get_changes_create_test, sysrepo_setup, sysrepo_teardown),
+        cmocka_unit_test_setup_teardown(cl_get_pushed_changes_test, sysrepo_setup, sysrepo_teardown),
         cmocka_unit_test_setup_teardown(cl_get_changes_modified_test, sysrepo_setup, sysrepo_teardown),
         cmocka_unit_test_setup_teardown(cl_get_changes_deleted_test, sysrepo_setup, sysrepo_teardown),
         cmocka_unit_test_setup_teardown(cl_get_changes_moved_test, sysrepo_setup, sysrepo_teardown),
@@ -2172,6 +2172,78 @@ cl_failed_to_atomize_data(void **state)
     sr_list_cleanup(xpath_retrieved);
 }
 
+static void
+cl_engine_statistics(void **state)
+{
+    sr_conn_ctx_t *conn = *state;
+    assert_non_null(conn);
+    sr_session_ctx_t *session = NULL;
+    sr_val_t *value = NULL, *values = NULL;
+    size_t value_cnt = 0;
+    int rc = SR_ERR_OK;
+
+    /* start session */
+    rc = sr_session_start(conn, SR_DS_RUNNING, SR_SESS_DEFAULT, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* generate some requests */
+    rc = sr_get_item(session, "/example-module:container/list[key1='key1'][key2='key2']/leaf", &value);
+    assert_true(SR_ERR_OK == rc || SR_ERR_NOT_FOUND == rc);
+    sr_free_val(value);
+    value = NULL;
+    rc = sr_lock_module(session, "example-module");
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_unlock_module(session, "example-module");
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* statistics are provided without any data provider subscribed */
+    rc = sr_get_items(session, "/sysrepo-statistics:sysrepo-statistics//*", &values, &value_cnt);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/requests/operation[name='%s']/count", "get-item");
+    assert_non_null(value);
+    assert_int_equal(SR_UINT64_T, value->type);
+    assert_true(value->data.uint64_val >= 1);
+
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/request-processor/sessions");
+    assert_non_null(value);
+    assert_true(value->data.uint32_val >= 1);
+
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/notifications/data-provider-requests");
+    assert_non_null(value);
+
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/access-control/decision-cache-probes");
+    assert_non_null(value);
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/access-control/decision-cache-hits");
+    assert_non_null(value);
+
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/locks/module-lock[name='%s'][datastore='%s']/acquisitions",
+            "example-module", "running");
+    assert_non_null(value);
+    assert_true(value->data.uint64_val >= 1);
+
+#ifdef ENABLE_LOCK_STATS
+    value = sr_val_get_by_xpath(values, value_cnt, "/sysrepo-statistics:sysrepo-statistics/locks/lock[name='%s']/acquisitions", "model_lock");
+    assert_non_null(value);
+    assert_true(value->data.uint64_val >= 1);
+#endif
+    sr_free_values(values, value_cnt);
+
+    /* repeated request replaces the previous statistics */
+    rc = sr_get_item(session, "/sysrepo-statistics:sysrepo-statistics/requests/operation[name='get-items']/count", &value);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_true(value->data.uint64_val >= 1);
+    sr_free_val(value);
+
+    /* no statistics in startup */
+    rc = sr_session_switch_ds(session, SR_DS_STARTUP);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_get_items(session, "/sysrepo-statistics:sysrepo-statistics//*", &values, &value_cnt);
+    assert_int_equal(rc, SR_ERR_NOT_FOUND);
+
+    sr_session_stop(session);
+}
+
 int
 main()
 {
@@ -2193,6 +2265,7 @@ main()
         cmocka_unit_test_setup_teardown(cl_nested_data_subscription2_tree, sysrepo_setup, sysrepo_teardown),
         cmocka_unit_test_setup_teardown(cl_all_state_data, sysrepo_setup, sysrepo_teardown),
         cmocka_unit_test_setup_teardown(cl_failed_to_atomize_data, sysrepo_setup, sysrepo_teardown),
+        cmocka_unit_test_setup_teardown(cl_engine_statistics, sysrepo_setup, sysrepo_teardown),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #include <pthread.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 #include "sr_common.h"
 #include "request_processor.h"
@@ -201,6 +202,110 @@ sr_list_test(void **state)
     sr_list_cleanup(list);
 }
 
+static int
+sr_omap_test_cmp(const void *a, const void *b)
+{
+    return strcmp((const char *) a, (const char *) b);
+}
+
+static uint32_t
+sr_omap_test_hash(const void *item)
+{
+    return sr_str_hash((const char *) item);
+}
+
+/*
+ * Tests sysrepo ordered map DS.
+ */
+static void
+sr_omap_test(void **state)
+{
+    sr_omap_t *map = NULL;
+    char *items[100] = { NULL, };
+    char key[10] = { 0, };
+    char *item = NULL;
+    int rc = SR_ERR_OK;
+
+    for (int hashed = 0; hashed < 2; hashed++) {
+        rc = sr_omap_init(sr_omap_test_cmp, hashed ? sr_omap_test_hash : NULL, free, &map);
+        assert_int_equal(rc, SR_ERR_OK);
+
+        /* insert in reverse order */
+        for (int i = 99; i >= 0; i--) {
+            snprintf(key, sizeof(key), "key%02d", i);
+            item = strdup(key);
+            rc = sr_omap_insert(map, item);
+            assert_int_equal(rc, SR_ERR_OK);
+        }
+        assert_int_equal(sr_omap_count(map), 100);
+
+        /* duplicate */
+        rc = sr_omap_insert(map, "key42");
+        assert_int_equal(rc, SR_ERR_DATA_EXISTS);
+
+        /* ordered iteration and lookup */
+        for (size_t i = 0; i < 100; i++) {
+            snprintf(key, sizeof(key), "key%02zu", i);
+            assert_string_equal(key, sr_omap_get_at(map, i));
+            item = sr_omap_search(map, key);
+            assert_non_null(item);
+            assert_string_equal(key, item);
+        }
+        assert_null(sr_omap_get_at(map, 100));
+        assert_null(sr_omap_search(map, "missing"));
+
+        /* delete every odd item */
+        for (int i = 1; i < 100; i += 2) {
+            snprintf(key, sizeof(key), "key%02d", i);
+            sr_omap_delete(map, key);
+        }
+        sr_omap_delete(map, "missing");
+        assert_int_equal(sr_omap_count(map), 50);
+        for (int i = 0; i < 100; i++) {
+            snprintf(key, sizeof(key), "key%02d", i);
+            item = sr_omap_search(map, key);
+            if (i % 2) {
+                assert_null(item);
+            } else {
+                assert_non_null(item);
+                assert_string_equal(key, sr_omap_get_at(map, i / 2));
+            }
+        }
+
+        /* build is allowed only on an empty map */
+        rc = sr_omap_build(map, (void **) items, 0);
+        assert_int_equal(rc, SR_ERR_INVAL_ARG);
+        sr_omap_cleanup(map);
+
+        rc = sr_omap_init(sr_omap_test_cmp, hashed ? sr_omap_test_hash : NULL, free, &map);
+        assert_int_equal(rc, SR_ERR_OK);
+        for (int i = 0; i < 100; i++) {
+            snprintf(key, sizeof(key), "key%02d", (i * 37) % 100);
+            items[i] = strdup(key);
+        }
+        rc = sr_omap_build(map, (void **) items, 100);
+        assert_int_equal(rc, SR_ERR_OK);
+        assert_int_equal(sr_omap_count(map), 100);
+        for (size_t i = 0; i < 100; i++) {
+            snprintf(key, sizeof(key), "key%02zu", i);
+            assert_string_equal(key, sr_omap_get_at(map, i));
+            assert_non_null(sr_omap_search(map, key));
+        }
+        sr_omap_cleanup(map);
+
+        /* build with duplicates */
+        rc = sr_omap_init(sr_omap_test_cmp, hashed ? sr_omap_test_hash : NULL, NULL, &map);
+        assert_int_equal(rc, SR_ERR_OK);
+        items[0] = "dup";
+        items[1] = "key";
+        items[2] = "dup";
+        rc = sr_omap_build(map, (void **) items, 3);
+        assert_int_equal(rc, SR_ERR_DATA_EXISTS);
+        assert_int_equal(sr_omap_count(map), 0);
+        sr_omap_cleanup(map);
+    }
+}
+
 /*
  * Tests circular buffer - stores integers in it.
  */
@@ -341,6 +446,244 @@ circular_buffer_test3(void **state)
     sr_cbuff_cleanup(buffer);
 }
 
+#define RING_TEST_PRODUCERS 4
+#define RING_TEST_ITEMS 10000
+
+typedef struct ring_test_item_s {
+    size_t producer;
+    size_t seq;
+} ring_test_item_t;
+
+static sr_ring_t *ring_test_ring = NULL;
+static size_t ring_test_consumed = 0;
+
+static void *
+ring_test_producer(void *arg)
+{
+    ring_test_item_t item = { (size_t) arg, 0 };
+
+    for (item.seq = 1; item.seq <= RING_TEST_ITEMS; item.seq++) {
+        assert_int_equal(SR_ERR_OK, sr_ring_enqueue(ring_test_ring, &item));
+        sr_ring_wake(ring_test_ring, 1);
+    }
+    return NULL;
+}
+
+static void *
+ring_test_consumer(void *arg)
+{
+    ring_test_item_t item = { 0, };
+    size_t last[RING_TEST_PRODUCERS] = { 0, };
+
+    for (;;) {
+        sr_ring_dequeue_wait(ring_test_ring, &item);
+        if (0 == item.seq) {
+            break;
+        }
+        /* elements of one producer must come in order */
+        assert_true(item.seq > last[item.producer]);
+        last[item.producer] = item.seq;
+        __atomic_add_fetch(&ring_test_consumed, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/*
+ * Tests lock-free ring queue.
+ */
+static void
+ring_queue_test(void **state)
+{
+    sr_ring_t *ring = NULL;
+    pthread_t producers[RING_TEST_PRODUCERS], consumers[RING_TEST_PRODUCERS];
+    ring_test_item_t item = { 0, };
+    int rc = SR_ERR_OK, i = 0, tmp = 0;
+
+    /* single-threaded, overflow of the ring */
+    rc = sr_ring_init(4, sizeof(int), SR_RING_SPSC, &ring);
+    assert_int_equal(rc, SR_ERR_OK);
+    for (i = 1; i <= 50; i++) {
+        rc = sr_ring_enqueue(ring, &i);
+        assert_int_equal(rc, SR_ERR_OK);
+        if (10 == i) {
+            assert_true(sr_ring_dequeue(ring, &tmp));
+            assert_int_equal(tmp, 1);
+        }
+    }
+    assert_int_equal(sr_ring_count(ring), 49);
+    for (i = 2; i <= 50; i++) {
+        assert_true(sr_ring_dequeue(ring, &tmp));
+        assert_int_equal(tmp, i);
+    }
+    assert_false(sr_ring_dequeue(ring, &tmp));
+    assert_int_equal(sr_ring_count(ring), 0);
+    sr_ring_cleanup(ring);
+
+    /* multiple producers and consumers */
+    rc = sr_ring_init(16, sizeof(ring_test_item_t), SR_RING_MPMC, &ring_test_ring);
+    assert_int_equal(rc, SR_ERR_OK);
+    ring_test_consumed = 0;
+    for (i = 0; i < RING_TEST_PRODUCERS; i++) {
+        pthread_create(&consumers[i], NULL, ring_test_consumer, NULL);
+    }
+    for (i = 0; i < RING_TEST_PRODUCERS; i++) {
+        pthread_create(&producers[i], NULL, ring_test_producer, (void *) (size_t) i);
+    }
+    for (i = 0; i < RING_TEST_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    /* stop the consumers */
+    item.seq = 0;
+    for (i = 0; i < RING_TEST_PRODUCERS; i++) {
+        sr_ring_enqueue(ring_test_ring, &item);
+    }
+    sr_ring_wake(ring_test_ring, RING_TEST_PRODUCERS);
+    for (i = 0; i < RING_TEST_PRODUCERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+    assert_int_equal(ring_test_consumed, RING_TEST_PRODUCERS * RING_TEST_ITEMS);
+    assert_int_equal(sr_ring_count(ring_test_ring), 0);
+    sr_ring_cleanup(ring_test_ring);
+    ring_test_ring = NULL;
+}
+
+/*
+ * Tests string interning.
+ */
+static void
+sr_str_intern_test(void **state)
+{
+    const char *str1 = NULL, *str2 = NULL, *str3 = NULL, *ns = NULL;
+    char buf[64] = { 0, };
+    size_t count = 0, init_count = 0, bytes = 0;
+    int rc = SR_ERR_OK;
+
+    sr_str_intern_stats(&init_count, NULL);
+
+    /* equal strings are interned once */
+    rc = sr_str_intern("example-module", &str1);
+    assert_int_equal(rc, SR_ERR_OK);
+    strcpy(buf, "example-module");
+    rc = sr_str_intern(buf, &str2);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_ptr_equal(str1, str2);
+    assert_ptr_not_equal(str1, buf);
+    assert_string_equal(str1, "example-module");
+    rc = sr_str_intern("test-module", &str3);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_ptr_not_equal(str1, str3);
+    sr_str_intern_stats(&count, &bytes);
+    assert_int_equal(count, init_count + 2);
+    assert_true(bytes > 0);
+
+    /* prefix of a string and the first namespace of an xpath */
+    rc = sr_str_intern_len("example-module:container", strlen("example-module"), &str2);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_ptr_equal(str1, str2);
+    rc = sr_intern_first_ns("/example-module:container/list[key='k']", &ns);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_ptr_equal(str1, ns);
+    rc = sr_intern_first_ns("example-module:container", &ns);
+    assert_int_equal(rc, SR_ERR_INVAL_ARG);
+
+    /* the string stays in the table until the last reference is released */
+    assert_ptr_equal(str1, sr_str_intern_ref(str1));
+    sr_str_release(str1);
+    sr_str_release(str1);
+    sr_str_release(str1);
+    sr_str_intern_stats(&count, NULL);
+    assert_int_equal(count, init_count + 2);
+    assert_string_equal(str1, "example-module");
+    sr_str_release(str1);
+    sr_str_release(str3);
+    sr_str_release(NULL);
+    sr_str_intern_stats(&count, NULL);
+    assert_int_equal(count, init_count);
+
+    /* many strings, the table grows */
+    const char *strings[1000] = { NULL, };
+    for (size_t i = 0; i < 1000; i++) {
+        snprintf(buf, sizeof(buf), "/module-%zu:container", i);
+        rc = sr_str_intern(buf, &strings[i]);
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        snprintf(buf, sizeof(buf), "/module-%zu:container", i);
+        rc = sr_str_intern(buf, &str1);
+        assert_int_equal(rc, SR_ERR_OK);
+        assert_ptr_equal(str1, strings[i]);
+        sr_str_release(str1);
+        sr_str_release(strings[i]);
+    }
+    sr_str_intern_stats(&count, NULL);
+    assert_int_equal(count, init_count);
+}
+
+#define INTERN_TEST_SESSIONS 100
+#define INTERN_TEST_REQUESTS 10
+
+/*
+ * Compares the allocations made when the module name of each request of many sessions
+ * is copied (sr_copy_first_ns) and interned (sr_intern_first_ns).
+ */
+static void
+sr_str_intern_alloc_test(void **state)
+{
+    const char *xpaths[] = {
+            "/example-module:container/list[key1='key1'][key2='key2']/leaf",
+            "/test-module:main/i8",
+            "/ietf-interfaces:interfaces/interface[name='eth0']/enabled",
+    };
+    size_t xpath_cnt = sizeof(xpaths) / sizeof(*xpaths);
+    char *copied[INTERN_TEST_SESSIONS] = { NULL, };
+    const char *interned[INTERN_TEST_SESSIONS] = { NULL, };
+    size_t copy_allocs = 0, copy_bytes = 0, intern_allocs = 0;
+    size_t init_count = 0, init_bytes = 0, prev_count = 0, count = 0, bytes = 0;
+    int rc = SR_ERR_OK;
+
+    sr_str_intern_stats(&init_count, &init_bytes);
+
+    for (size_t r = 0; r < INTERN_TEST_REQUESTS; r++) {
+        for (size_t s = 0; s < INTERN_TEST_SESSIONS; s++) {
+            /* each request replaces the module name of the previous request of the session */
+            free(copied[s]);
+            rc = sr_copy_first_ns(xpaths[(r + s) % xpath_cnt], &copied[s]);
+            assert_int_equal(rc, SR_ERR_OK);
+            ++copy_allocs;
+
+            /* each new entry of the table is one allocation */
+            sr_str_intern_stats(&prev_count, NULL);
+            sr_str_release(interned[s]);
+            rc = sr_intern_first_ns(xpaths[(r + s) % xpath_cnt], &interned[s]);
+            assert_int_equal(rc, SR_ERR_OK);
+            sr_str_intern_stats(&count, NULL);
+            if (count > prev_count) {
+                intern_allocs += count - prev_count;
+            }
+            assert_string_equal(copied[s], interned[s]);
+        }
+    }
+
+    /* memory retained by the module names of the sessions */
+    for (size_t s = 0; s < INTERN_TEST_SESSIONS; s++) {
+        copy_bytes += strlen(copied[s]) + 1;
+    }
+    sr_str_intern_stats(&count, &bytes);
+    assert_true(count - init_count <= xpath_cnt);
+    assert_true(bytes - init_bytes < copy_bytes / 2);
+
+    /* one allocation per module name instead of one per request */
+    assert_int_equal(INTERN_TEST_SESSIONS * INTERN_TEST_REQUESTS, copy_allocs);
+    assert_true(intern_allocs <= xpath_cnt);
+
+    for (size_t s = 0; s < INTERN_TEST_SESSIONS; s++) {
+        free(copied[s]);
+        sr_str_release(interned[s]);
+    }
+    sr_str_intern_stats(&count, NULL);
+    assert_int_equal(init_count, count);
+}
+
 /*
  * Callback to be called for each entry to be logged in logger_callback_test.
  */
@@ -362,6 +705,137 @@ logger_callback_test(void **state)
 }
 
 
+#define LOGGER_TEST_THREADS 4
+#define LOGGER_TEST_MESSAGES 50
+
+static void *
+logger_async_thread(void *arg)
+{
+    for (size_t i = 0; i < LOGGER_TEST_MESSAGES; ++i) {
+        SR_LOG_INF("Async logger test: thread %zu message %zu", (size_t) arg, i);
+    }
+    return NULL;
+}
+
+/*
+ * Tests logging into stderr from a background writer thread.
+ */
+static void
+logger_async_test(void **state)
+{
+    pthread_t threads[LOGGER_TEST_THREADS];
+    char line[256] = { 0, };
+    size_t cnt[LOGGER_TEST_THREADS] = { 0, }, thread = 0, msg = 0;
+    FILE *log_file = NULL;
+    int stderr_fd = -1;
+
+    if (SR_LOG_MAX_LEVEL < SR_LL_INF ||
+            (0 != SR_LOG_RATE_LIMIT && SR_LOG_RATE_LIMIT < LOGGER_TEST_THREADS * LOGGER_TEST_MESSAGES)) {
+        /* the messages would not be logged in this build */
+        return;
+    }
+
+    /* redirect stderr into a temporary file */
+    log_file = tmpfile();
+    assert_non_null(log_file);
+    fflush(stderr);
+    stderr_fd = dup(STDERR_FILENO);
+    assert_true(stderr_fd >= 0);
+    assert_true(dup2(fileno(log_file), STDERR_FILENO) >= 0);
+
+    sr_logger_set_async(true);
+    for (size_t i = 0; i < LOGGER_TEST_THREADS; ++i) {
+        pthread_create(&threads[i], NULL, logger_async_thread, (void *) i);
+    }
+    for (size_t i = 0; i < LOGGER_TEST_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    /* writes out all pending messages */
+    sr_logger_set_async(false);
+
+    fflush(stderr);
+    assert_true(dup2(stderr_fd, STDERR_FILENO) >= 0);
+    close(stderr_fd);
+
+    /* each message is written exactly once, messages of one thread in order */
+    rewind(log_file);
+    while (NULL != fgets(line, sizeof(line), log_file)) {
+        char *msg_str = strstr(line, "Async logger test: ");
+        if (NULL != msg_str) {
+            assert_int_equal(2, sscanf(msg_str, "Async logger test: thread %zu message %zu", &thread, &msg));
+            assert_true(thread < LOGGER_TEST_THREADS);
+            assert_int_equal(cnt[thread], msg);
+            ++cnt[thread];
+        }
+    }
+    for (size_t i = 0; i < LOGGER_TEST_THREADS; ++i) {
+        assert_int_equal(LOGGER_TEST_MESSAGES, cnt[i]);
+    }
+    fclose(log_file);
+}
+
+static size_t logger_rate_cnt = 0;
+
+/*
+ * Callback counting the log entries in logger_rate_limit_test.
+ */
+static void
+logger_rate_callback(sr_log_level_t level, const char *message)
+{
+    if (NULL != strstr(message, "Rate limit test")) {
+        ++logger_rate_cnt;
+    }
+}
+
+/*
+ * Tests rate limiting of the messages logged from one call site.
+ */
+static void
+logger_rate_limit_test(void **state)
+{
+    sr_log_level_t ll_stderr = sr_ll_stderr;
+
+    sr_log_stderr(SR_LL_NONE);
+    sr_log_set_cb(logger_rate_callback);
+
+    logger_rate_cnt = 0;
+    for (size_t i = 0; i < 3 * SR_LOG_RATE_LIMIT; ++i) {
+        SR_LOG_DBG("Rate limit test %zu", i);
+    }
+    /* the loop may span at most two one-second windows */
+    if (0 < SR_LOG_RATE_LIMIT) {
+        assert_true(logger_rate_cnt <= 2 * SR_LOG_RATE_LIMIT);
+    }
+
+    /* errors are never suppressed */
+    logger_rate_cnt = 0;
+    for (size_t i = 0; i < 3 * SR_LOG_RATE_LIMIT; ++i) {
+        SR_LOG_ERR("Rate limit test %zu", i);
+    }
+    assert_int_equal(3 * SR_LOG_RATE_LIMIT, logger_rate_cnt);
+
+    sr_log_set_cb(NULL);
+    sr_log_stderr(ll_stderr);
+}
+
+/*
+ * Tests setting of the log level of an output given by its name.
+ */
+static void
+logger_set_level_test(void **state)
+{
+    sr_log_level_t ll_stderr = sr_ll_stderr;
+
+    assert_int_equal(SR_ERR_INVAL_ARG, sr_logger_set_level("file", SR_LL_ERR));
+    assert_int_equal(SR_ERR_INVAL_ARG, sr_logger_set_level("stderr", SR_LL_DBG + 1));
+    assert_int_equal(ll_stderr, sr_ll_stderr);
+
+    assert_int_equal(SR_ERR_OK, sr_logger_set_level("stderr", SR_LL_WRN));
+    assert_int_equal(SR_LL_WRN, sr_ll_stderr);
+
+    sr_log_stderr(ll_stderr);
+}
+
 #define TESTING_FILE "/tmp/testing_file"
 #define TEST_THREAD_COUNT 5
 
@@ -485,6 +959,275 @@ sr_locking_set_test(void **state)
     sr_locking_set_cleanup(lset);
 }
 
+#define TESTING_LOCK_TABLE_FILE "/tmp/testing_lock_table"
+
+static void *
+lock_table_in_thread(void *ctx)
+{
+   sr_lock_table_t *table = ctx;
+   int rc = SR_ERR_OK;
+   int owner = 0;
+
+   /* wait rand */
+   usleep(100 * (rand()%6));
+
+   /* lock blocking */
+   rc = sr_lock_table_lock(table, TESTING_FILE, &owner, SR_LOCK_EXCL, -1);
+   assert_int_equal(rc, SR_ERR_OK);
+
+   /* wait rand */
+   usleep(100 * (rand()%10));
+
+   /* unlock */
+   rc = sr_lock_table_unlock(table, TESTING_FILE, &owner, SR_LOCK_EXCL);
+   assert_int_equal(rc, SR_ERR_OK);
+
+   return NULL;
+}
+
+static void
+sr_lock_table_test(void **state)
+{
+    sr_lock_table_t *table = NULL, *table2 = NULL;
+    sr_lock_stats_t stats = {0,};
+    int rc = SR_ERR_OK, status = 0;
+    int owner1 = 0, owner2 = 0;
+    pthread_t threads[TEST_THREAD_COUNT] = {0};
+    pid_t pid = 0;
+    mode_t mask = 0;
+    struct stat st = {0,};
+
+    /* in-process lock table */
+    rc = sr_lock_table_init(NULL, &table);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = sr_lock_table_get_stats(table, TESTING_FILE, &stats);
+    assert_int_equal(SR_ERR_NOT_FOUND, rc);
+
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* locking by the same owner has no effect */
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* another owner can not lock nor unlock */
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_LOCKED, rc);
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 10);
+    assert_int_equal(SR_ERR_LOCKED, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner2, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_INVAL_ARG, rc);
+
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_INVAL_ARG, rc);
+
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner2, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = sr_lock_table_get_stats(table, TESTING_FILE, &stats);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(2, stats.acquired);
+    assert_int_equal(2, stats.contended);
+    assert_int_equal(2, stats.timeouts);
+    assert_true(stats.wait_time >= 5000);
+
+    /* blocking locks are handed over between the threads */
+    for (int i = 0; i < TEST_THREAD_COUNT; i++) {
+        pthread_create(&threads[i], NULL, lock_table_in_thread, table);
+    }
+    for (int i = 0; i < TEST_THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    rc = sr_lock_table_get_stats(table, TESTING_FILE, &stats);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(2 + TEST_THREAD_COUNT, stats.acquired);
+
+    /* intention locks are compatible with each other, not with an exclusive lock of another owner */
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_INTENT_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner2, SR_LOCK_INTENT_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_LOCKED, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner2, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_INVAL_ARG, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner2, SR_LOCK_INTENT_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* own intention lock does not conflict */
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner2, SR_LOCK_INTENT_EXCL, 0);
+    assert_int_equal(SR_ERR_LOCKED, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_INTENT_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_INTENT_EXCL);
+    assert_int_equal(SR_ERR_INVAL_ARG, rc);
+
+    sr_lock_table_cleanup(table);
+
+    /* lock table shared with other processes, the lock file is accessible regardless of the umask */
+    unlink(TESTING_LOCK_TABLE_FILE);
+    mask = umask(S_IWGRP | S_IWOTH);
+    rc = sr_lock_table_init(TESTING_LOCK_TABLE_FILE, &table);
+    umask(mask);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(0, stat(TESTING_LOCK_TABLE_FILE, &st));
+    assert_int_equal(S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH, st.st_mode & 0777);
+
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    pid = fork();
+    if (0 == pid) {
+        /* the lock is held by the parent process */
+        sr_lock_table_t *child_table = NULL;
+        rc = sr_lock_table_init(TESTING_LOCK_TABLE_FILE, &child_table);
+        if (SR_ERR_OK == rc) {
+            rc = sr_lock_table_lock(child_table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 0);
+            sr_lock_table_cleanup(child_table);
+        }
+        _exit(rc);
+    }
+    assert_true(pid > 0);
+    waitpid(pid, &status, 0);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(SR_ERR_LOCKED, WEXITSTATUS(status));
+
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    pid = fork();
+    if (0 == pid) {
+        /* the lock has been released */
+        sr_lock_table_t *child_table = NULL;
+        rc = sr_lock_table_init(TESTING_LOCK_TABLE_FILE, &child_table);
+        if (SR_ERR_OK == rc) {
+            rc = sr_lock_table_lock(child_table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 0);
+            sr_lock_table_cleanup(child_table);
+        }
+        _exit(rc);
+    }
+    assert_true(pid > 0);
+    waitpid(pid, &status, 0);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(SR_ERR_OK, WEXITSTATUS(status));
+
+    pid = fork();
+    if (0 == pid) {
+        /* the lock is held by a process that terminates without releasing it */
+        sr_lock_table_t *child_table = NULL;
+        rc = sr_lock_table_init(TESTING_LOCK_TABLE_FILE, &child_table);
+        if (SR_ERR_OK == rc) {
+            rc = sr_lock_table_lock(child_table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 0);
+        }
+        _exit(rc);
+    }
+    assert_true(pid > 0);
+    waitpid(pid, &status, 0);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(SR_ERR_OK, WEXITSTATUS(status));
+
+    /* locks of the terminated process are released */
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* the lock file is shared by the tables of the process, a release by one of them keeps the locks of the other */
+    rc = sr_lock_table_init(TESTING_LOCK_TABLE_FILE, &table2);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_lock(table, TESTING_FILE, &owner1, SR_LOCK_INTENT_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_lock(table2, TESTING_FILE, &owner2, SR_LOCK_INTENT_EXCL, 0);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = sr_lock_table_unlock(table2, TESTING_FILE, &owner2, SR_LOCK_INTENT_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+    sr_lock_table_cleanup(table2);
+
+    pid = fork();
+    if (0 == pid) {
+        /* the intention lock is still held by the parent process */
+        sr_lock_table_t *child_table = NULL;
+        rc = sr_lock_table_init(TESTING_LOCK_TABLE_FILE, &child_table);
+        if (SR_ERR_OK == rc) {
+            rc = sr_lock_table_lock(child_table, TESTING_FILE, &owner2, SR_LOCK_EXCL, 0);
+            sr_lock_table_cleanup(child_table);
+        }
+        _exit(rc);
+    }
+    assert_true(pid > 0);
+    waitpid(pid, &status, 0);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(SR_ERR_LOCKED, WEXITSTATUS(status));
+
+    rc = sr_lock_table_unlock(table, TESTING_FILE, &owner1, SR_LOCK_INTENT_EXCL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    sr_lock_table_cleanup(table);
+    unlink(TESTING_LOCK_TABLE_FILE);
+}
+
+static void
+sr_lockstat_test(void **state)
+{
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+    sr_lockstat_t *stats = NULL;
+    size_t count = 0;
+    int rc = SR_ERR_OK;
+
+    sr_lockstat_register(&mutex, "test_mutex");
+    sr_lockstat_register(&rwlock, "test_rwlock");
+
+    for (int i = 0; i < 10; ++i) {
+        assert_int_equal(0, sr_mutex_lock(&mutex));
+        assert_int_equal(0, sr_mutex_unlock(&mutex));
+    }
+    assert_int_equal(0, sr_rwlock_rdlock(&rwlock));
+    assert_int_equal(0, sr_rwlock_rdlock(&rwlock));
+    assert_int_equal(0, sr_rwlock_unlock(&rwlock));
+    assert_int_equal(0, sr_rwlock_unlock(&rwlock));
+    assert_int_equal(0, sr_rwlock_wrlock(&rwlock));
+    usleep(1000);
+    assert_int_equal(0, sr_rwlock_unlock(&rwlock));
+
+    rc = sr_lockstat_get(&stats, &count);
+    assert_int_equal(SR_ERR_OK, rc);
+#ifdef ENABLE_LOCK_STATS
+    bool mutex_found = false, rwlock_found = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (0 == strcmp("test_mutex", stats[i].name)) {
+            assert_int_equal(10, stats[i].acquisitions);
+            mutex_found = true;
+        } else if (0 == strcmp("test_rwlock", stats[i].name)) {
+            assert_int_equal(3, stats[i].acquisitions);
+            assert_true(stats[i].hold_max >= 1000);
+            rwlock_found = true;
+        }
+    }
+    assert_true(mutex_found && rwlock_found);
+#else
+    assert_int_equal(0, count);
+    assert_null(stats);
+#endif
+    sr_lockstat_dump();
+    free(stats);
+
+    sr_lockstat_unregister(&mutex);
+    sr_lockstat_unregister(&rwlock);
+    pthread_mutex_destroy(&mutex);
+    pthread_rwlock_destroy(&rwlock);
+}
+
 /**
  * @brief Check size of a linked-list.
  */
@@ -1160,16 +1903,113 @@ sr_error_info_test(void **state)
     sr_free_errors(errors, error_cnt);
 }
 
+/*
+ * @brief Tests encoding of values into a value block and decoding them back.
+ */
+static void
+sr_value_block_test(void **state)
+{
+    int rc = SR_ERR_OK;
+    sr_val_t values[6] = {{ 0, }}, *decoded = NULL, *value = NULL, *dup_values[6] = { NULL, };
+    size_t decoded_cnt = 0;
+    Sr__ValueBlock *block = NULL;
+    sr_value_block_reader_t reader = { 0, };
+    sr_mem_ctx_t *sr_mem = NULL;
+
+    values[0].xpath = "/example-module:container/list[key1='a'][key2='b']";
+    values[0].type = SR_LIST_T;
+    values[1].xpath = "/example-module:container/list[key1='a'][key2='b']/key1";
+    values[1].type = SR_STRING_T;
+    values[1].data.string_val = "a";
+    values[2].xpath = "/example-module:container/list[key1='a'][key2='b']/leaf";
+    values[2].type = SR_INT16_T;
+    values[2].data.int16_val = -1234;
+    values[2].dflt = true;
+    values[3].xpath = "/example-module:container/list[key1='c'][key2='d']/enabled";
+    values[3].type = SR_BOOL_T;
+    values[3].data.bool_val = true;
+    values[4].xpath = "/example-module:container/list[key1='c'][key2='d']/numbers";
+    values[4].type = SR_UINT64_T;
+    values[4].data.uint64_val = UINT64_MAX;
+    values[5].xpath = "/test-module:main/dec64";
+    values[5].type = SR_DECIMAL64_T;
+    values[5].data.decimal64_val = 3.14;
+
+    rc = sr_values_sr_to_gpb_block(values, 6, &block);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_non_null(block);
+    assert_int_equal(6, block->n_types);
+    assert_int_equal(0, block->xpath_shared[0]);
+    assert_int_equal(strlen(values[0].xpath), block->xpath_shared[1]);
+    assert_int_equal(strlen("/example-module:container/list[key1='"), block->xpath_shared[3]);
+    assert_int_equal(1, block->n_dflt);
+    assert_int_equal(1, block->n_int_vals);
+    assert_int_equal(2, block->n_uint_vals);
+    assert_int_equal(1, block->n_decimal64_vals);
+
+    /* decode all values at once */
+    rc = sr_values_gpb_block_to_sr(NULL, block, &decoded, &decoded_cnt);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(6, decoded_cnt);
+    for (size_t i = 0; i < decoded_cnt; i++) {
+        assert_string_equal(values[i].xpath, decoded[i].xpath);
+        assert_int_equal(values[i].type, decoded[i].type);
+        assert_int_equal(values[i].dflt, decoded[i].dflt);
+    }
+    assert_string_equal("a", decoded[1].data.string_val);
+    assert_int_equal(-1234, decoded[2].data.int16_val);
+    assert_true(decoded[3].data.bool_val);
+    assert_true(UINT64_MAX == decoded[4].data.uint64_val);
+    assert_true(3.14 == decoded[5].data.decimal64_val);
+    sr_free_values(decoded, decoded_cnt);
+
+    /* decode the values one by one within a memory context */
+    rc = sr_mem_new(0, &sr_mem);
+    assert_int_equal(SR_ERR_OK, rc);
+    sr_value_block_reader_init(block, &reader);
+    for (size_t i = 0; i < 6; i++) {
+        rc = sr_value_block_dup_next(&reader, sr_mem, &dup_values[i]);
+        assert_int_equal(SR_ERR_OK, rc);
+        assert_string_equal(values[i].xpath, dup_values[i]->xpath);
+        assert_int_equal(values[i].type, dup_values[i]->type);
+    }
+    assert_string_equal("a", dup_values[1]->data.string_val);
+    rc = sr_value_block_dup_next(&reader, sr_mem, &value);
+    assert_int_equal(SR_ERR_NOT_FOUND, rc);
+    sr_value_block_reader_cleanup(&reader);
+    for (size_t i = 0; i < 6; i++) {
+        /* the memory context is released together with the last value */
+        sr_free_val(dup_values[i]);
+    }
+
+    /* truncated block */
+    block->xpath_suffixes.len -= 1;
+    rc = sr_values_gpb_block_to_sr(NULL, block, &decoded, &decoded_cnt);
+    assert_int_equal(SR_ERR_MALFORMED_MSG, rc);
+    block->xpath_suffixes.len += 1;
+
+    sr__value_block__free_unpacked(block, NULL);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(sr_llist_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_list_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(sr_omap_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(circular_buffer_test1, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(circular_buffer_test2, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(circular_buffer_test3, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(ring_queue_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(sr_str_intern_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(sr_str_intern_alloc_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(logger_callback_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(logger_async_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(logger_rate_limit_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(logger_set_level_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_locking_set_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(sr_lock_table_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(sr_lockstat_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_node_t_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_node_t_with_augments_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_node_t_rpc_input_test, logging_setup, logging_cleanup),
@@ -1177,6 +2017,7 @@ main() {
             cmocka_unit_test_setup_teardown(sr_free_schema_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_copy_first_ns_from_expr_test, logging_setup, logging_cleanup),
             cmocka_unit_test_setup_teardown(sr_error_info_test, logging_setup, logging_cleanup),
+            cmocka_unit_test_setup_teardown(sr_value_block_test, logging_setup, logging_cleanup),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
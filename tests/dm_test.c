@@ -25,12 +25,19 @@
 #include <cmocka.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "data_manager.h"
 #include "test_data.h"
 #include "sr_common.h"
 #include "test_module_helper.h"
 #include "rp_dt_lookup.h"
 #include "rp_dt_xpath.h"
+#include "rp_dt_edit.h"
+#include "rp_dt_context_helper.h"
+#include "rp_internal.h"
 
 int setup(void **state)
 {
@@ -289,6 +296,61 @@ dm_validate_data_trees_test(void **state)
     dm_cleanup(ctx);
 }
 
+void
+dm_validate_data_trees_parallel_test(void **state)
+{
+    int rc;
+    dm_ctx_t *ctx = NULL;
+    dm_session_t *ses_ctx = NULL;
+    struct lyd_node *node = NULL;
+    dm_data_info_t *info = NULL;
+    sr_error_info_t *errors = NULL;
+    size_t err_cnt = 0;
+
+    rc = dm_init(NULL, NULL, NULL, CM_MODE_LOCAL, TEST_SCHEMA_SEARCH_DIR, TEST_DATA_SEARCH_DIR, &ctx);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = dm_session_start(ctx, NULL, SR_DS_STARTUP, &ses_ctx);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* make invalid changes in two independent modules, loaded in reverse alphabetical order */
+    rc = dm_get_data_info(ctx, ses_ctx, "test-module", &info);
+    assert_int_equal(SR_ERR_OK, rc);
+    info->modified = true;
+    node = dm_lyd_new_leaf(info, info->node, info->schema->module, "i8", "42");
+    assert_non_null(node);
+
+    rc = dm_get_data_info(ctx, ses_ctx, "example-module", &info);
+    assert_int_equal(SR_ERR_OK, rc);
+    info->modified = true;
+    node = dm_lyd_new_leaf(info, NULL, info->schema->module, "number", "1");
+    assert_non_null(node);
+    node = dm_lyd_new_leaf(info, NULL, info->schema->module, "number", "1");
+    assert_non_null(node);
+
+    /* valid module modified as well */
+    rc = dm_get_data_info(ctx, ses_ctx, "small-module", &info);
+    assert_int_equal(SR_ERR_OK, rc);
+    info->modified = true;
+
+    /* errors are reported in the order of modules regardless of the parallel validation */
+    for (int i = 0; i < 10; i++) {
+        rc = dm_validate_session_data_trees(ctx, ses_ctx, &errors, &err_cnt);
+        assert_int_equal(SR_ERR_VALIDATION_FAILED, rc);
+        assert_int_equal(2, err_cnt);
+        assert_non_null(errors[0].xpath);
+        assert_non_null(strstr(errors[0].xpath, "example-module"));
+        assert_non_null(errors[1].xpath);
+        assert_non_null(strstr(errors[1].xpath, "test-module"));
+        sr_free_errors(errors, err_cnt);
+        errors = NULL;
+        err_cnt = 0;
+    }
+
+    dm_session_stop(ctx, ses_ctx);
+    dm_cleanup(ctx);
+}
+
 void
 dm_discard_changes_test(void **state)
 {
@@ -389,6 +451,8 @@ dm_locking_test(void **state)
    int rc;
    dm_ctx_t *ctx = NULL;
    dm_session_t *sessionA = NULL, *sessionB = NULL;
+   char *lock_file = NULL;
+   struct stat st = {0};
 
    rc = dm_init(NULL, NULL, NULL, CM_MODE_LOCAL, TEST_SCHEMA_SEARCH_DIR, TEST_DATA_SEARCH_DIR, &ctx);
    assert_int_equal(SR_ERR_OK, rc);
@@ -407,7 +471,77 @@ dm_locking_test(void **state)
 
    rc = dm_lock_module(ctx, sessionB, "example-module");
    assert_int_equal(SR_ERR_OK, rc);
+
+   /* datastore lock conflicts with a module lock of another session */
+   dm_session_start(ctx, NULL, SR_DS_STARTUP, &sessionA);
+   rc = dm_lock_datastore(ctx, sessionA);
+   assert_int_equal(SR_ERR_LOCKED, rc);
+
+   /* but not with a module lock of the same session */
+   rc = dm_lock_datastore(ctx, sessionB);
+   assert_int_equal(SR_ERR_OK, rc);
+
+   rc = dm_unlock_datastore(ctx, sessionB);
+   assert_int_equal(SR_ERR_OK, rc);
+
+   rc = dm_lock_datastore(ctx, sessionA);
+   assert_int_equal(SR_ERR_OK, rc);
+
+   /* module lock conflicts with a datastore lock of another session */
+   rc = dm_lock_module(ctx, sessionB, "example-module");
+   assert_int_equal(SR_ERR_LOCKED, rc);
+
+   /* module of a locked datastore is locked by the same session */
+   rc = dm_lock_module(ctx, sessionA, "example-module");
+   assert_int_equal(SR_ERR_OK, rc);
+
+   /* modules covered by the datastore lock are in use */
+   rc = dm_feature_enable(ctx, "ietf-interfaces", "pre-provisioning", true);
+   assert_int_equal(SR_ERR_OPERATION_FAILED, rc);
+
+   dm_session_stop(ctx, sessionA);
+
+   rc = dm_feature_enable(ctx, "ietf-interfaces", "pre-provisioning", true);
+   assert_int_equal(SR_ERR_OK, rc);
+   rc = dm_feature_enable(ctx, "ietf-interfaces", "pre-provisioning", false);
+   assert_int_equal(SR_ERR_OK, rc);
+
+   rc = dm_lock_module(ctx, sessionB, "example-module");
+   assert_int_equal(SR_ERR_OK, rc);
+
    dm_session_stop(ctx, sessionB);
+
+   if (0 != geteuid()) {
+       /* datastore lock skips the modules the user is not allowed to lock, they stay available */
+       rc = sr_get_lock_data_file_name(TEST_DATA_SEARCH_DIR, "example-module", SR_DS_STARTUP, &lock_file);
+       assert_int_equal(SR_ERR_OK, rc);
+       assert_int_equal(0, stat(lock_file, &st));
+       assert_int_equal(0, chmod(lock_file, S_IRUSR));
+
+       dm_session_start(ctx, NULL, SR_DS_STARTUP, &sessionA);
+       dm_session_start(ctx, NULL, SR_DS_STARTUP, &sessionB);
+
+       rc = dm_lock_datastore(ctx, sessionA);
+       assert_int_equal(SR_ERR_OK, rc);
+
+       rc = dm_lock_module(ctx, sessionA, "example-module");
+       assert_int_equal(SR_ERR_UNAUTHORIZED, rc);
+       rc = dm_lock_module(ctx, sessionB, "example-module");
+       assert_int_equal(SR_ERR_UNAUTHORIZED, rc);
+       rc = dm_lock_module(ctx, sessionB, "test-module");
+       assert_int_equal(SR_ERR_LOCKED, rc);
+
+       rc = dm_unlock_datastore(ctx, sessionA);
+       assert_int_equal(SR_ERR_OK, rc);
+       rc = dm_lock_module(ctx, sessionB, "test-module");
+       assert_int_equal(SR_ERR_OK, rc);
+
+       assert_int_equal(0, chmod(lock_file, st.st_mode & 07777));
+       free(lock_file);
+       dm_session_stop(ctx, sessionA);
+       dm_session_stop(ctx, sessionB);
+   }
+
    dm_cleanup(ctx);
 }
 
@@ -896,6 +1030,252 @@ dm_action_test(void **state)
     dm_cleanup(ctx);
 }
 
+static char *commit_trace = NULL;
+static size_t commit_trace_cnt = 0;
+
+/*
+ * Callback keeping the commit trace record in dm_commit_trace_test.
+ */
+static void
+dm_commit_trace_log_cb(sr_log_level_t level, const char *message)
+{
+    if (SR_LL_INF == level && NULL != strstr(message, "Commit trace:")) {
+        ++commit_trace_cnt;
+        if (NULL == commit_trace) {
+            commit_trace = strdup(message);
+        }
+    }
+}
+
+/*
+ * Returns the time of a commit stage from the trace record.
+ */
+static uint64_t
+dm_commit_trace_time(const char *trace, const char *name)
+{
+    char field[64] = { 0, };
+    const char *pos = NULL;
+    uint64_t time = 0;
+
+    snprintf(field, sizeof field, " %s=", name);
+    pos = strstr(trace, field);
+    assert_non_null(pos);
+    assert_int_equal(1, sscanf(pos + strlen(field), "%"SCNu64, &time));
+
+    return time;
+}
+
+void
+dm_commit_trace_test(void **state)
+{
+    dm_commit_context_t c_ctx = { 0, };
+    rp_ctx_t *rp_ctx = NULL;
+    rp_session_t *session = NULL;
+    sr_error_info_t *errors = NULL;
+    size_t err_cnt = 0;
+    sr_val_t *value = NULL;
+    char expected[256] = { 0, };
+    uint64_t stages_time = 0;
+    int rc = SR_ERR_OK;
+
+    /* every stage has a name used in the trace and statistics */
+    for (dm_commit_state_t stage = DM_COMMIT_STARTED; stage <= DM_COMMIT_FINISHED; ++stage) {
+        assert_string_not_equal("unknown", dm_commit_state_to_str(stage));
+    }
+    assert_string_equal("wait-for-verifiers", dm_commit_state_to_str(DM_COMMIT_WAIT_FOR_NOTIFICATIONS));
+    assert_string_equal("write", dm_commit_state_to_str(DM_COMMIT_WRITE));
+
+    /* incomplete contexts are ignored */
+    commit_trace_cnt = 0;
+    sr_log_set_cb(dm_commit_trace_log_cb);
+    dm_commit_trace(NULL, SR_ERR_OK);
+    dm_commit_trace(&c_ctx, SR_ERR_OK);
+    assert_int_equal(0, commit_trace_cnt);
+
+    /* a real commit emits one trace record with the time of its stages */
+    createDataTreeTestModule();
+    test_rp_ctx_create(&rp_ctx);
+    test_rp_sesssion_create(rp_ctx, SR_DS_STARTUP, &session);
+
+    value = calloc(1, sizeof *value);
+    assert_non_null(value);
+    value->type = SR_INT64_T;
+    value->data.int64_val = XP_TEST_MODULE_INT64_VALUE_T + 1;
+    rc = rp_dt_set_item_wrapper(rp_ctx, session, XP_TEST_MODULE_INT64, value, SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = rp_dt_commit(rp_ctx, session, NULL, &errors, &err_cnt);
+    assert_int_equal(SR_ERR_OK, rc);
+    sr_free_errors(errors, err_cnt);
+
+    assert_int_equal(1, commit_trace_cnt);
+    assert_non_null(commit_trace);
+    snprintf(expected, sizeof expected, "datastore=%s result=%s modules=", sr_ds_to_str(SR_DS_STARTUP), sr_strerror(SR_ERR_OK));
+    assert_non_null(strstr(commit_trace, expected));
+    assert_non_null(strstr(commit_trace, "test-module"));
+    assert_non_null(strstr(commit_trace, " operations=1 "));
+
+    for (dm_commit_state_t stage = DM_COMMIT_VALIDATION; stage < DM_COMMIT_FINISHED; ++stage) {
+        stages_time += dm_commit_trace_time(commit_trace, dm_commit_state_to_str(stage));
+    }
+    assert_true(dm_commit_trace_time(commit_trace, "write") > 0);
+    assert_true(stages_time > 0);
+    assert_true(stages_time <= dm_commit_trace_time(commit_trace, "total"));
+
+    sr_log_set_cb(NULL);
+    free(commit_trace);
+    commit_trace = NULL;
+    test_rp_session_cleanup(rp_ctx, session);
+    test_rp_ctx_cleanup(rp_ctx);
+    createDataTreeTestModule();
+}
+
+void
+dm_session_trim_test(void **state)
+{
+    int rc = SR_ERR_OK;
+    dm_ctx_t *ctx = NULL;
+    dm_session_t *session = NULL;
+    dm_data_info_t *info = NULL;
+    dm_mem_stats_t stats = { 0, };
+    struct lyd_node *data_tree = NULL;
+    sr_list_t *keep_modules = NULL;
+    size_t evicted = 0;
+
+    /* invalid budgets fall back to the defaults */
+    setenv("SR_SESSION_MEM_BUDGET", "12abc", 1);
+    setenv("SR_GLOBAL_MEM_BUDGET", "-1", 1);
+    rc = dm_init(NULL, NULL, NULL, CM_MODE_LOCAL, TEST_SCHEMA_SEARCH_DIR, TEST_DATA_SEARCH_DIR, &ctx);
+    assert_int_equal(SR_ERR_OK, rc);
+    dm_get_mem_stats(ctx, &stats);
+    assert_int_equal((size_t) SR_SESSION_MEM_BUDGET * 1024, stats.session_budget);
+    assert_int_equal((size_t) SR_GLOBAL_MEM_BUDGET * 1024, stats.global_budget);
+    dm_cleanup(ctx);
+
+    /* budget of 1 KiB is exceeded by any two data trees */
+    setenv("SR_SESSION_MEM_BUDGET", "1", 1);
+    setenv("SR_GLOBAL_MEM_BUDGET", "0", 1);
+    rc = dm_init(NULL, NULL, NULL, CM_MODE_LOCAL, TEST_SCHEMA_SEARCH_DIR, TEST_DATA_SEARCH_DIR, &ctx);
+    assert_int_equal(SR_ERR_OK, rc);
+    unsetenv("SR_SESSION_MEM_BUDGET");
+    unsetenv("SR_GLOBAL_MEM_BUDGET");
+
+    dm_get_mem_stats(ctx, &stats);
+    assert_int_equal(1024, stats.session_budget);
+    assert_int_equal(0, stats.global_budget);
+
+    rc = dm_session_start(ctx, NULL, SR_DS_STARTUP, &session);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* the least recently used tree is evicted, the last used one is kept */
+    assert_int_equal(SR_ERR_OK, dm_get_datatree(ctx, session, "example-module", &data_tree));
+    assert_int_equal(SR_ERR_OK, dm_get_datatree(ctx, session, "test-module", &data_tree));
+    rc = dm_session_trim(ctx, session, NULL, &evicted);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(1, evicted);
+
+    dm_get_mem_stats(ctx, &stats);
+    assert_int_equal(1, stats.evictions);
+    assert_int_equal(0, stats.reloads);
+    assert_true(stats.used > 0);
+
+    /* evicted tree is loaded again transparently */
+    assert_int_equal(SR_ERR_OK, dm_get_datatree(ctx, session, "example-module", &data_tree));
+    assert_non_null(data_tree);
+    dm_get_mem_stats(ctx, &stats);
+    assert_int_equal(1, stats.reloads);
+
+    /* kept module is not evicted */
+    assert_int_equal(SR_ERR_OK, sr_list_init(&keep_modules));
+    assert_int_equal(SR_ERR_OK, sr_list_add(keep_modules, "test-module"));
+    rc = dm_session_trim(ctx, session, keep_modules, &evicted);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(0, evicted);
+    sr_list_cleanup(keep_modules);
+
+    /* modified trees are not evicted */
+    rc = dm_get_data_info(ctx, session, "test-module", &info);
+    assert_int_equal(SR_ERR_OK, rc);
+    info->modified = true;
+    assert_int_equal(SR_ERR_OK, dm_get_datatree(ctx, session, "example-module", &data_tree));
+    rc = dm_session_trim(ctx, session, NULL, &evicted);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(0, evicted);
+    info->modified = false;
+
+    rc = dm_session_trim(ctx, session, NULL, &evicted);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(1, evicted);
+
+    dm_session_stop(ctx, session);
+
+    /* memory of a stopped session is released from the accounting */
+    dm_get_mem_stats(ctx, &stats);
+    assert_int_equal(0, stats.used);
+    assert_int_equal(2, stats.evictions);
+
+    dm_cleanup(ctx);
+}
+
+void
+dm_mem_usage_test(void **state)
+{
+    int rc = SR_ERR_OK;
+    dm_ctx_t *ctx = NULL;
+    dm_session_t *session = NULL;
+    dm_mem_usage_t usage = { 0, };
+    dm_module_usage_t *modules = NULL;
+    struct lyd_node *data_tree = NULL;
+    size_t module_cnt = 0, ctx_cnt = 0;
+    bool found = false;
+
+    rc = dm_init(NULL, NULL, NULL, CM_MODE_LOCAL, TEST_SCHEMA_SEARCH_DIR, TEST_DATA_SEARCH_DIR, &ctx);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = dm_session_start(ctx, NULL, SR_DS_STARTUP, &session);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* nothing is accounted before the end of the first request */
+    dm_get_session_mem_usage(session, &usage);
+    assert_int_equal(0, usage.tree_cnt);
+    assert_int_equal(0, usage.mem_size);
+
+    assert_int_equal(SR_ERR_OK, dm_get_datatree(ctx, session, "example-module", &data_tree));
+    assert_int_equal(SR_ERR_OK, dm_get_datatree(ctx, session, "test-module", &data_tree));
+    rc = dm_session_trim(ctx, session, NULL, NULL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    dm_get_session_mem_usage(session, &usage);
+    assert_int_equal(2, usage.tree_cnt);
+    assert_true(usage.node_cnt > 0);
+    assert_true(usage.mem_size > 0);
+
+    /* usage of the session copies is reported per module and datastore */
+    rc = dm_get_module_usage(ctx, &modules, &module_cnt);
+    assert_int_equal(SR_ERR_OK, rc);
+    for (size_t i = 0; i < module_cnt; i++) {
+        if (0 == strcmp("test-module", modules[i].module_name)) {
+            found = true;
+            assert_int_equal(1, modules[i].mem_usage[SR_DS_STARTUP].tree_cnt);
+            assert_true(modules[i].mem_usage[SR_DS_STARTUP].node_cnt > 0);
+            assert_true(modules[i].mem_usage[SR_DS_STARTUP].mem_size > 0);
+            assert_int_equal(0, modules[i].mem_usage[SR_DS_RUNNING].tree_cnt);
+        }
+    }
+    assert_true(found);
+    dm_free_module_usage(modules, module_cnt);
+
+    /* no commit context is retained */
+    rc = dm_get_commit_ctxs_usage(ctx, &ctx_cnt, &usage);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(0, ctx_cnt);
+    assert_int_equal(0, usage.tree_cnt);
+    assert_int_equal(0, usage.mem_size);
+
+    dm_session_stop(ctx, session);
+    dm_cleanup(ctx);
+}
+
 int main(){
     sr_log_stderr(SR_LL_DBG);
 
@@ -904,6 +1284,7 @@ int main(){
             cmocka_unit_test(dm_get_data_tree),
             cmocka_unit_test(dm_list_schema_test),
             cmocka_unit_test(dm_validate_data_trees_test),
+            cmocka_unit_test(dm_validate_data_trees_parallel_test),
             cmocka_unit_test(dm_discard_changes_test),
             cmocka_unit_test(dm_get_schema_test),
             cmocka_unit_test(dm_get_schema_negative_test),
@@ -914,6 +1295,9 @@ int main(){
             cmocka_unit_test(dm_state_data_test),
             cmocka_unit_test(dm_event_notif_test),
             cmocka_unit_test(dm_action_test),
+            cmocka_unit_test(dm_commit_trace_test),
+            cmocka_unit_test(dm_session_trim_test),
+            cmocka_unit_test(dm_mem_usage_test),
     };
     return cmocka_run_group_tests(tests, setup, NULL);
 }
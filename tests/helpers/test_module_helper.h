@@ -29,6 +29,7 @@
 #define EXAMPLE_MODULE_DATA_FILE_NAME TEST_DATA_SEARCH_DIR "example-module" SR_STARTUP_FILE_EXT
 #define REFERENCED_MODULE_DATA_FILE_NAME TEST_DATA_SEARCH_DIR "referenced-data" SR_STARTUP_FILE_EXT
 #define STATE_MODULE_DATA_FILE_NAME TEST_DATA_SEARCH_DIR "state-module" SR_STARTUP_FILE_EXT
+#define IETF_INTERFACES_DATA_FILE_NAME TEST_DATA_SEARCH_DIR "ietf-interfaces" SR_STARTUP_FILE_EXT
 
 /**
  * Creates test-module data tree and writes it into a file.
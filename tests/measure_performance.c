@@ -28,6 +28,8 @@
 #include <stdbool.h>
 #include <libyang/libyang.h>
 #include "sysrepo.h"
+#include "sr_common.h"
+#include "nacm.h"
 #include "test_module_helper.h"
 
 /* Constants defining how many times the operation is performed to compute an average ops/sec */
@@ -162,6 +164,16 @@ libyang_setup(void **state)
     *state = (void *) ctx;
 }
 
+void
+libyang_ietf_interfaces_setup(void **state)
+{
+    struct ly_ctx *ctx = ly_ctx_new(TEST_SCHEMA_SEARCH_DIR);
+    assert_non_null(ly_ctx_load_module(ctx, "ietf-interfaces", NULL));
+    assert_non_null(ly_ctx_load_module(ctx, "ietf-ip", NULL));
+    assert_non_null(ly_ctx_load_module(ctx, "iana-if-type", "2014-05-08"));
+    *state = (void *) ctx;
+}
+
 void
 libyang_teardown(void **state)
 {
@@ -668,6 +680,297 @@ perf_libyang_get_all_list(void **state, int op_num, int *items)
 
 }
 
+static size_t
+get_gpb_nodes_cnt(Sr__Node **trees, size_t tree_cnt)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < tree_cnt; ++i) {
+        count += 1 + get_gpb_nodes_cnt(trees[i]->children, trees[i]->n_children);
+    }
+
+    return count;
+}
+
+static void
+perf_libyang_ietf_interfaces_gpb_via_trees(void **state, int op_num, int *items)
+{
+    struct ly_ctx *ctx = *state;
+    assert_non_null(ctx);
+    sr_mem_ctx_t *sr_mem = NULL;
+    sr_node_t *trees = NULL;
+    Sr__Node **gpb_trees = NULL;
+    size_t count = 0, gpb_count = 0;
+    int rc = 0;
+
+    struct lyd_node *root = lyd_parse_path(ctx, IETF_INTERFACES_DATA_FILE_NAME, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_non_null(root);
+    struct ly_set *set = lyd_find_xpath(root, "/ietf-interfaces:interfaces");
+    assert_non_null(set);
+
+    /* convert the data tree into sysrepo trees and these into GPB trees */
+    for (size_t i = 0; i<op_num; i++){
+        rc = sr_mem_new(0, &sr_mem);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_nodes_to_trees(set, sr_mem, &trees, &count);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_trees_sr_to_gpb(trees, count, &gpb_trees, &gpb_count);
+        assert_int_equal(rc, SR_ERR_OK);
+        if (0 == i) {
+            *items = get_gpb_nodes_cnt(gpb_trees, gpb_count);
+        }
+        sr_free_trees(trees, count);
+    }
+
+    ly_set_free(set);
+    lyd_free_withsiblings(root);
+}
+
+static void
+perf_libyang_ietf_interfaces_gpb_direct(void **state, int op_num, int *items)
+{
+    struct ly_ctx *ctx = *state;
+    assert_non_null(ctx);
+    sr_mem_ctx_t *sr_mem = NULL;
+    Sr__Node **gpb_trees = NULL;
+    size_t gpb_count = 0;
+    int rc = 0;
+
+    struct lyd_node *root = lyd_parse_path(ctx, IETF_INTERFACES_DATA_FILE_NAME, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_non_null(root);
+    struct ly_set *set = lyd_find_xpath(root, "/ietf-interfaces:interfaces");
+    assert_non_null(set);
+
+    /* build GPB trees directly from the data tree */
+    for (size_t i = 0; i<op_num; i++){
+        rc = sr_mem_new(0, &sr_mem);
+        assert_int_equal(rc, SR_ERR_OK);
+        rc = sr_nodes_to_gpb_trees(sr_mem, set, 0, SIZE_MAX, SIZE_MAX, SIZE_MAX, &gpb_trees, &gpb_count);
+        assert_int_equal(rc, SR_ERR_OK);
+        if (0 == i) {
+            *items = get_gpb_nodes_cnt(gpb_trees, gpb_count);
+        }
+        sr_mem_free(sr_mem);
+    }
+
+    ly_set_free(set);
+    lyd_free_withsiblings(root);
+}
+
+/**@brief number of values converted by one operation of the value conversion tests */
+#define PERF_VALUE_CNT 100
+
+/**@brief state of the value conversion tests */
+typedef struct perf_values_s {
+    sr_val_t *values;         /**< values of various types */
+    Sr__Value **gpb_values;   /**< the same values in GPB */
+} perf_values_t;
+
+void
+values_setup(void **state)
+{
+    perf_values_t *pv = calloc(1, sizeof(*pv));
+    size_t gpb_count = 0;
+    int rc = 0;
+    assert_non_null(pv);
+
+    rc = sr_new_values(PERF_VALUE_CNT, &pv->values);
+    assert_int_equal(rc, SR_ERR_OK);
+    for (size_t i = 0; i < PERF_VALUE_CNT; i++) {
+        sr_val_t *value = &pv->values[i];
+        rc = sr_val_build_xpath(value, "/example-module:container/list[key1='key%zu'][key2='key%zu']/leaf%zu", i / 5, i / 5, i % 5);
+        assert_int_equal(rc, SR_ERR_OK);
+        switch (i % 5) {
+            case 0:
+                rc = sr_val_build_str_data(value, SR_STRING_T, "Leaf value %zu", i);
+                break;
+            case 1:
+                rc = sr_val_set_str_data(value, SR_ENUM_T, "enabled");
+                break;
+            case 2:
+                value->type = SR_INT32_T;
+                value->data.int32_val = -(int32_t) i;
+                break;
+            case 3:
+                value->type = SR_UINT8_T;
+                value->data.uint8_val = i;
+                break;
+            default:
+                value->type = SR_BOOL_T;
+                value->data.bool_val = i & 1;
+        }
+        assert_int_equal(rc, SR_ERR_OK);
+    }
+    rc = sr_values_sr_to_gpb(pv->values, PERF_VALUE_CNT, &pv->gpb_values, &gpb_count);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    *state = pv;
+}
+
+void
+values_teardown(void **state)
+{
+    perf_values_t *pv = *state;
+
+    if (NULL == pv->values[0]._sr_mem) {
+        for (size_t i = 0; i < PERF_VALUE_CNT; i++) {
+            sr__value__free_unpacked(pv->gpb_values[i], NULL);
+        }
+        free(pv->gpb_values);
+    }
+    sr_free_values(pv->values, PERF_VALUE_CNT);
+    free(pv);
+}
+
+static void
+perf_values_sr_to_gpb(void **state, int op_num, int *items)
+{
+    perf_values_t *pv = *state;
+    sr_mem_ctx_t *sr_mem = pv->values[0]._sr_mem;
+    sr_mem_snapshot_t snapshot = { 0, };
+    Sr__Value **gpb_values = NULL;
+    size_t gpb_count = 0;
+    int rc = 0;
+
+    for (size_t i = 0; i < op_num; i++) {
+        if (NULL != sr_mem) {
+            sr_mem_snapshot(sr_mem, &snapshot);
+        }
+        rc = sr_values_sr_to_gpb(pv->values, PERF_VALUE_CNT, &gpb_values, &gpb_count);
+        assert_int_equal(rc, SR_ERR_OK);
+        if (NULL != sr_mem) {
+            sr_mem_restore(&snapshot);
+        } else {
+            for (size_t j = 0; j < gpb_count; j++) {
+                sr__value__free_unpacked(gpb_values[j], NULL);
+            }
+            free(gpb_values);
+        }
+    }
+    *items = PERF_VALUE_CNT;
+}
+
+static void
+perf_values_gpb_to_sr(void **state, int op_num, int *items)
+{
+    perf_values_t *pv = *state;
+    sr_mem_ctx_t *sr_mem = pv->values[0]._sr_mem;
+    sr_mem_snapshot_t snapshot = { 0, };
+    sr_val_t *values = NULL;
+    size_t count = 0;
+    int rc = 0;
+
+    for (size_t i = 0; i < op_num; i++) {
+        if (NULL != sr_mem) {
+            sr_mem_snapshot(sr_mem, &snapshot);
+        }
+        rc = sr_values_gpb_to_sr(sr_mem, pv->gpb_values, PERF_VALUE_CNT, &values, &count);
+        assert_int_equal(rc, SR_ERR_OK);
+        if (NULL != sr_mem) {
+            sr_mem_restore(&snapshot);
+        } else {
+            sr_free_values(values, count);
+        }
+    }
+    *items = PERF_VALUE_CNT;
+}
+
+/**@brief state of the NACM check test */
+typedef struct perf_nacm_s {
+    struct ly_ctx *ly_ctx;      /**< context with test-module loaded */
+    nacm_ctx_t *nacm_ctx;       /**< NACM context with the rules */
+    nacm_profile_t profile;     /**< profile of the user the nodes are checked for */
+    nacm_node_perms_t *perms;   /**< compiled permissions of all schema nodes of test-module */
+    size_t node_cnt;            /**< number of the schema nodes */
+} perf_nacm_t;
+
+void
+nacm_setup(void **state)
+{
+    perf_nacm_t *pn = calloc(1, sizeof(*pn));
+    const struct lys_module *module = NULL;
+    const struct lys_node *root = NULL, *next = NULL, *iter = NULL;
+    struct lyd_node *data = NULL;
+    nacm_config_t *config = NULL;
+    ac_ucred_t credentials = { 0 };
+    size_t i = 0;
+    int rc = SR_ERR_OK;
+    assert_non_null(pn);
+
+    pn->ly_ctx = ly_ctx_new(TEST_SCHEMA_SEARCH_DIR);
+    assert_non_null(pn->ly_ctx);
+    module = ly_ctx_load_module(pn->ly_ctx, "test-module", NULL);
+    assert_non_null(module);
+    assert_non_null(ly_ctx_load_module(pn->ly_ctx, NACM_MODULE_NAME, NULL));
+
+    /* the user is denied reading of one leaf */
+    data = lyd_new_path(NULL, pn->ly_ctx, "/ietf-netconf-acm:nacm/groups/group[name='perf']/user-name", "perf", 0, 0);
+    assert_non_null(data);
+    assert_non_null(lyd_new_path(data, pn->ly_ctx, "/ietf-netconf-acm:nacm/rule-list[name='perf']/group", "perf", 0, 0));
+    assert_non_null(lyd_new_path(data, pn->ly_ctx, "/ietf-netconf-acm:nacm/rule-list[name='perf']/rule[name='string']/path",
+            "/test-module:main/string", 0, 0));
+    assert_non_null(lyd_new_path(data, pn->ly_ctx, "/ietf-netconf-acm:nacm/rule-list[name='perf']/rule[name='string']/access-operations",
+            "read", 0, 0));
+    assert_non_null(lyd_new_path(data, pn->ly_ctx, "/ietf-netconf-acm:nacm/rule-list[name='perf']/rule[name='string']/action",
+            "deny", 0, 0));
+    rc = nacm_config_from_tree(data, &config);
+    assert_int_equal(rc, SR_ERR_OK);
+    lyd_free_withsiblings(data);
+
+    rc = nacm_init(&pn->nacm_ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = nacm_reload(pn->nacm_ctx, config);
+    assert_int_equal(rc, SR_ERR_OK);
+    credentials.r_username = "perf";
+    credentials.r_uid = 1000;
+    rc = nacm_get_profile(pn->nacm_ctx, &credentials, &pn->profile);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    LY_TREE_FOR(module->data, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            pn->node_cnt++;
+            LY_TREE_DFS_END(root, next, iter);
+        }
+    }
+    pn->perms = calloc(pn->node_cnt, sizeof(*pn->perms));
+    assert_non_null(pn->perms);
+    LY_TREE_FOR(module->data, root) {
+        LY_TREE_DFS_BEGIN(root, next, iter) {
+            rc = nacm_compile_node(pn->nacm_ctx, iter, &pn->perms[i++]);
+            assert_int_equal(rc, SR_ERR_OK);
+            LY_TREE_DFS_END(root, next, iter);
+        }
+    }
+
+    *state = pn;
+}
+
+void
+nacm_teardown(void **state)
+{
+    perf_nacm_t *pn = *state;
+
+    free(pn->perms);
+    nacm_cleanup(pn->nacm_ctx);
+    ly_ctx_destroy(pn->ly_ctx, NULL);
+    free(pn);
+}
+
+static void
+perf_nacm_check_test(void **state, int op_num, int *items)
+{
+    perf_nacm_t *pn = *state;
+    size_t allowed = 0;
+
+    for (size_t i = 0; i < op_num; i++) {
+        for (size_t j = 0; j < pn->node_cnt; j++) {
+            allowed += nacm_check_node(&pn->perms[j], &pn->profile, NACM_ACCESS_READ);
+        }
+    }
+    assert_true(allowed < op_num * pn->node_cnt);
+    *items = pn->node_cnt;
+}
+
 void test_perf(test_t *ts, int test_count, const char *title,  int selection)
 {
     print_measure_header(title);
@@ -698,6 +1001,11 @@ main (int argc, char **argv)
         {perf_commit_test, "Commit one leaf change", OP_COUNT_COMMIT, sysrepo_setup, sysrepo_teardown},
         {perf_libyang_get_node, "Libyang get one node", OP_COUNT, libyang_setup, libyang_teardown},
         {perf_libyang_get_all_list, "Libyang get all list", OP_COUNT, libyang_setup, libyang_teardown},
+        {perf_libyang_ietf_interfaces_gpb_via_trees, "Libyang ietf-if to GPB via trees", OP_COUNT, libyang_ietf_interfaces_setup, libyang_teardown},
+        {perf_libyang_ietf_interfaces_gpb_direct, "Libyang ietf-if to GPB direct", OP_COUNT, libyang_ietf_interfaces_setup, libyang_teardown},
+        {perf_values_sr_to_gpb, "Values sr_val_t to GPB", OP_COUNT, values_setup, values_teardown},
+        {perf_values_gpb_to_sr, "Values GPB to sr_val_t", OP_COUNT, values_setup, values_teardown},
+        {perf_nacm_check_test, "NACM read check all nodes", OP_COUNT, nacm_setup, nacm_teardown},
     };
 
     size_t test_count = sizeof(tests)/sizeof(*tests);
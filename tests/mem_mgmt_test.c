@@ -27,6 +27,7 @@
 #include <setjmp.h>
 #include <cmocka.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <sys/stat.h>
 
 #include "sr_common.h"
@@ -146,10 +147,10 @@ sr_mem_new_test (void **state)
     assert_int_equal(0, sr_mem2->peak);
     assert_int_equal(0, sr_mem2->used_total);
     assert_int_equal(0, sr_mem2->obj_count);
-    assert_int_equal(MEM_BLOCK_MIN_SIZE * 10, sr_mem2->size_total);
+    assert_int_equal(MEM_BLOCK_MIN_SIZE * 12, sr_mem2->size_total); /* rounded up to the size class */
     mem_block = get_mem_block(sr_mem2, -1);
     assert_non_null(mem_block->mem);
-    assert_int_equal(MEM_BLOCK_MIN_SIZE * 10, mem_block->size);
+    assert_int_equal(MEM_BLOCK_MIN_SIZE * 12, mem_block->size);
 
     sr_mem_free(sr_mem2);
     sr_mem_free(sr_mem);
@@ -723,6 +724,88 @@ sr_mem_edit_string_va_test(void **state)
 #undef LONGER_STRING_VALUE
 }
 
+/**
+ * @brief Allocates and frees a memory context in a separate thread, the cached memory blocks
+ * of the thread are handed over to the shared cache when the thread exits.
+ */
+static void *
+sr_mem_slab_thread(void *arg)
+{
+    sr_mem_ctx_t *sr_mem = NULL;
+    size_t size = *(size_t *)arg;
+
+    assert_int_equal(SR_ERR_OK, sr_mem_new(size, &sr_mem));
+    assert_non_null(sr_malloc(sr_mem, size));
+    sr_mem_free(sr_mem);
+
+    return NULL;
+}
+
+/**
+ * @brief Frees a memory context in a separate thread.
+ */
+static void *
+sr_mem_free_thread(void *sr_mem)
+{
+    sr_mem_free((sr_mem_ctx_t *)sr_mem);
+    return NULL;
+}
+
+static void
+sr_mem_slab_test(void **state)
+{
+    sr_mem_limits_t limits = { 0, }, orig_limits = { 0, };
+    sr_mem_stats_t stats1 = { 0, }, stats2 = { 0, };
+    sr_mem_ctx_t *sr_mem = NULL;
+    pthread_t thread;
+    size_t size = MEM_BLOCK_MIN_SIZE * 40;
+
+    /* limits */
+    sr_mem_get_limits(&orig_limits);
+    assert_int_equal(MAX_FREE_MEM_CONTEXTS, orig_limits.max_free_contexts);
+    assert_int_equal(MEM_THREAD_CACHE_SIZE, orig_limits.thread_cache_size);
+    assert_int_equal(MEM_GLOBAL_CACHE_SIZE, orig_limits.global_cache_size);
+    limits.thread_cache_size = 2 * MEM_THREAD_CACHE_SIZE;
+    sr_mem_set_limits(&limits);
+    sr_mem_get_limits(&limits);
+    assert_int_equal(MAX_FREE_MEM_CONTEXTS, limits.max_free_contexts); /* zero member kept */
+    assert_int_equal(2 * MEM_THREAD_CACHE_SIZE, limits.thread_cache_size);
+    assert_int_equal(MEM_GLOBAL_CACHE_SIZE, limits.global_cache_size);
+    sr_mem_set_limits(&orig_limits);
+
+    /* blocks released by an exited thread */
+    sr_mem_get_stats(&stats1);
+    assert_int_equal(0, pthread_create(&thread, NULL, sr_mem_slab_thread, &size));
+    assert_int_equal(0, pthread_join(thread, NULL));
+    sr_mem_get_stats(&stats2);
+    assert_true(stats2.contexts_created > stats1.contexts_created);
+    assert_true(stats2.system_allocs > stats1.system_allocs);
+    assert_true(stats2.global_flushes > stats1.global_flushes);
+    assert_true(stats2.global_cached_bytes >= size);
+
+    /* are reused by another thread */
+    stats1 = stats2;
+    assert_int_equal(0, pthread_create(&thread, NULL, sr_mem_slab_thread, &size));
+    assert_int_equal(0, pthread_join(thread, NULL));
+    sr_mem_get_stats(&stats2);
+    assert_true(stats2.global_refills > stats1.global_refills);
+    assert_true(stats2.block_cache_hits > stats1.block_cache_hits);
+
+    /* memory context freed by a different thread than the one that allocated it */
+    assert_int_equal(SR_ERR_OK, sr_mem_new(size, &sr_mem));
+    assert_non_null(sr_malloc(sr_mem, size));
+    assert_non_null(sr_malloc(sr_mem, MEM_BLOCK_MIN_SIZE));
+    check_num_of_mem_blocks(sr_mem, 1); /* the rest of the size class is usable */
+    sr_mem_get_stats(&stats1);
+    assert_int_equal(0, pthread_create(&thread, NULL, sr_mem_free_thread, sr_mem));
+    assert_int_equal(0, pthread_join(thread, NULL));
+    sr_mem_get_stats(&stats2);
+    /* the block ended up in the shared cache once the freeing thread exited */
+    assert_true(stats2.global_flushes > stats1.global_flushes);
+    assert_true(stats2.global_cached_bytes >= stats1.global_cached_bytes + size);
+    assert_int_equal(stats1.system_frees, stats2.system_frees);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
@@ -732,6 +815,7 @@ main() {
         cmocka_unit_test(sr_mem_snapshot_test),
         cmocka_unit_test(sr_mem_edit_string_test),
         cmocka_unit_test(sr_mem_edit_string_va_test),
+        cmocka_unit_test(sr_mem_slab_test),
 
     };
 
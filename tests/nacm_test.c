@@ -0,0 +1,543 @@
+/**
+ * @file nacm_test.c
+ * @brief NETCONF Access Control Model unit tests.
+ *
+ * @copyright
+ * Copyright 2016 Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "sr_common.h"
+#include "nacm.h"
+#include "rp_internal.h"
+#include "rp_dt_get.h"
+#include "rp_dt_edit.h"
+#include "test_data.h"
+#include "test_module_helper.h"
+#include "rp_dt_context_helper.h"
+
+#define NACM_TEST_USER "nacm-test-user"
+
+#define NACM_TEST_RULE(NAME, LEAF) "/ietf-netconf-acm:nacm/rule-list[name='guest']/rule[name='" NAME "']/" LEAF
+
+/**
+ * @brief Test setup routine.
+ */
+static int
+nacm_test_setup(void **state)
+{
+    struct ly_ctx *ly_ctx = NULL;
+
+    sr_logger_init("nacm_test");
+    sr_log_stderr(SR_LL_DBG);
+
+    ly_ctx = ly_ctx_new(TEST_SCHEMA_SEARCH_DIR);
+    assert_non_null(ly_ctx);
+    assert_non_null(ly_ctx_load_module(ly_ctx, "test-module", NULL));
+
+    *state = ly_ctx;
+    return 0;
+}
+
+/**
+ * @brief Test teardown routine.
+ */
+static int
+nacm_test_teardown(void **state)
+{
+    ly_ctx_destroy((struct ly_ctx *) *state, NULL);
+    sr_logger_cleanup();
+    return 0;
+}
+
+/**
+ * @brief Returns the schema node of test-module with provided schema path.
+ */
+static const struct lys_node *
+nacm_test_get_node(struct ly_ctx *ly_ctx, const char *path)
+{
+    const struct lys_module *module = NULL;
+    const struct lys_node *node = NULL;
+    struct ly_set *set = NULL;
+
+    module = ly_ctx_get_module(ly_ctx, "test-module", NULL);
+    assert_non_null(module);
+    set = lys_find_xpath(module->data, path, 0);
+    assert_non_null(set);
+    assert_int_equal(1, set->number);
+    node = set->set.s[0];
+    ly_set_free(set);
+
+    return node;
+}
+
+/**
+ * @brief Creates NACM configuration:
+ *  - group "admin": alice, group "guest": bob, carol, group "audit": carol
+ *  - rule list "guest" (guest): deny read of /main/string, permit write of /location,
+ *    deny all of /transfer/interval (leaf in a choice), permit create of /main/i8,
+ *    deny read of /main/ui8 in example-module, deny read of /main/i16 (path with module prefix)
+ *  - rule list "audit" (audit): permit read of /main/string
+ *  - rule list "admin" (admin): permit all
+ *  - write-default deny, read-default permit
+ */
+static nacm_config_t *
+nacm_test_config()
+{
+    nacm_config_t *config = calloc(1, sizeof(*config));
+    assert_non_null(config);
+
+    config->enabled = true;
+    config->read_default = NACM_ACTION_PERMIT;
+    config->write_default = NACM_ACTION_DENY;
+
+    config->group_cnt = 3;
+    config->groups = calloc(config->group_cnt, sizeof(*config->groups));
+    assert_non_null(config->groups);
+    config->groups[0].name = strdup("admin");
+    config->groups[0].user_cnt = 1;
+    config->groups[0].users = calloc(1, sizeof(char *));
+    config->groups[0].users[0] = strdup("alice");
+    config->groups[1].name = strdup("guest");
+    config->groups[1].user_cnt = 2;
+    config->groups[1].users = calloc(2, sizeof(char *));
+    config->groups[1].users[0] = strdup("bob");
+    config->groups[1].users[1] = strdup("carol");
+    config->groups[2].name = strdup("audit");
+    config->groups[2].user_cnt = 1;
+    config->groups[2].users = calloc(1, sizeof(char *));
+    config->groups[2].users[0] = strdup("carol");
+
+    config->rule_list_cnt = 3;
+    config->rule_lists = calloc(config->rule_list_cnt, sizeof(*config->rule_lists));
+    assert_non_null(config->rule_lists);
+
+    nacm_rule_list_t *list = &config->rule_lists[0];
+    list->name = strdup("guest");
+    list->group_cnt = 1;
+    list->groups = calloc(1, sizeof(char *));
+    list->groups[0] = strdup("guest");
+    list->rule_cnt = 6;
+    list->rules = calloc(list->rule_cnt, sizeof(*list->rules));
+    list->rules[0].name = strdup("deny-string");
+    list->rules[0].module_name = strdup("test-module");
+    list->rules[0].path = strdup("/test-module:main/test-module:string");
+    list->rules[0].access = NACM_ACCESS_READ;
+    list->rules[0].action = NACM_ACTION_DENY;
+    list->rules[1].name = strdup("permit-location");
+    list->rules[1].module_name = strdup("*");
+    list->rules[1].path = strdup("/location");
+    list->rules[1].access = NACM_ACCESS_WRITE;
+    list->rules[1].action = NACM_ACTION_PERMIT;
+    list->rules[2].name = strdup("deny-interval");
+    list->rules[2].module_name = strdup("test-module");
+    list->rules[2].path = strdup("/test-module:transfer/interval");
+    list->rules[2].access = NACM_ACCESS_ALL;
+    list->rules[2].action = NACM_ACTION_DENY;
+    list->rules[3].name = strdup("permit-i8-create");
+    list->rules[3].module_name = strdup("test-module");
+    list->rules[3].path = strdup("/test-module:main/i8");
+    list->rules[3].access = NACM_ACCESS_CREATE;
+    list->rules[3].action = NACM_ACTION_PERMIT;
+    list->rules[4].name = strdup("deny-foreign-ui8");
+    list->rules[4].module_name = strdup("*");
+    list->rules[4].path = strdup("/example-module:main/ui8");
+    list->rules[4].access = NACM_ACCESS_READ;
+    list->rules[4].action = NACM_ACTION_DENY;
+    list->rules[5].name = strdup("deny-i16");
+    list->rules[5].module_name = strdup("test-module");
+    list->rules[5].path = strdup("/tm:main/i16");
+    list->rules[5].access = NACM_ACCESS_READ;
+    list->rules[5].action = NACM_ACTION_DENY;
+
+    list = &config->rule_lists[1];
+    list->name = strdup("audit");
+    list->group_cnt = 1;
+    list->groups = calloc(1, sizeof(char *));
+    list->groups[0] = strdup("audit");
+    list->rule_cnt = 1;
+    list->rules = calloc(list->rule_cnt, sizeof(*list->rules));
+    list->rules[0].name = strdup("permit-string");
+    list->rules[0].module_name = strdup("test-module");
+    list->rules[0].path = strdup("/test-module:main/string");
+    list->rules[0].access = NACM_ACCESS_READ;
+    list->rules[0].action = NACM_ACTION_PERMIT;
+
+    list = &config->rule_lists[2];
+    list->name = strdup("admin");
+    list->group_cnt = 1;
+    list->groups = calloc(1, sizeof(char *));
+    list->groups[0] = strdup("admin");
+    list->rule_cnt = 1;
+    list->rules = calloc(list->rule_cnt, sizeof(*list->rules));
+    list->rules[0].name = strdup("permit-all");
+    list->rules[0].module_name = strdup("*");
+    list->rules[0].access = NACM_ACCESS_ALL;
+    list->rules[0].action = NACM_ACTION_PERMIT;
+
+    return config;
+}
+
+static void
+nacm_test_get_profile(nacm_ctx_t *ctx, const char *user, nacm_profile_t *profile)
+{
+    ac_ucred_t credentials = { 0 };
+    credentials.r_username = user;
+    credentials.r_uid = 1000;
+    assert_int_equal(SR_ERR_OK, nacm_get_profile(ctx, &credentials, profile));
+}
+
+/*
+ * Rules are compiled into per-node bitmaps and evaluated per profile.
+ */
+static void
+nacm_test_rules(void **state)
+{
+    struct ly_ctx *ly_ctx = *state;
+    nacm_ctx_t *ctx = NULL;
+    nacm_profile_t alice = { 0 }, bob = { 0 }, carol = { 0 }, dave = { 0 }, root = { 0 };
+    nacm_node_perms_t string = { 0 }, location = { 0 }, location_name = { 0 }, interval = { 0 }, i8 = { 0 };
+    nacm_node_perms_t ui8 = { 0 }, i16 = { 0 };
+    ac_ucred_t root_credentials = { 0 };
+
+    assert_int_equal(SR_ERR_OK, nacm_init(&ctx));
+    assert_false(nacm_is_enabled(ctx));
+    assert_int_equal(SR_ERR_OK, nacm_reload(ctx, nacm_test_config()));
+    assert_true(nacm_is_enabled(ctx));
+
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/string"), &string));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/i8"), &i8));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/ui8"), &ui8));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/i16"), &i16));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:location"), &location));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:location/name"), &location_name));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:transfer/interval"), &interval));
+
+    nacm_test_get_profile(ctx, "alice", &alice);
+    nacm_test_get_profile(ctx, "bob", &bob);
+    nacm_test_get_profile(ctx, "carol", &carol);
+    nacm_test_get_profile(ctx, "dave", &dave);
+    assert_int_equal(SR_ERR_OK, nacm_get_profile(ctx, &root_credentials, &root));
+
+    /* admin can do anything */
+    assert_true(nacm_check_node(&string, &alice, NACM_ACCESS_READ));
+    assert_true(nacm_check_node(&i8, &alice, NACM_ACCESS_WRITE));
+    assert_true(nacm_check_node(&interval, &alice, NACM_ACCESS_WRITE));
+
+    /* guest */
+    assert_false(nacm_check_node(&string, &bob, NACM_ACCESS_READ));
+    assert_true(nacm_check_node(&i8, &bob, NACM_ACCESS_READ));
+    assert_false(nacm_check_node(&i8, &bob, NACM_ACCESS_WRITE));
+    assert_true(nacm_check_node(&location, &bob, NACM_ACCESS_WRITE));
+    assert_true(nacm_check_node(&location_name, &bob, NACM_ACCESS_WRITE));
+    assert_false(nacm_check_node(&interval, &bob, NACM_ACCESS_READ));
+    assert_false(nacm_check_node(&interval, &bob, NACM_ACCESS_WRITE));
+
+    /* write operations are decided separately */
+    assert_true(nacm_check_node(&i8, &bob, NACM_ACCESS_CREATE));
+    assert_false(nacm_check_node(&i8, &bob, NACM_ACCESS_UPDATE));
+    assert_false(nacm_check_node(&i8, &bob, NACM_ACCESS_DELETE));
+    assert_true(nacm_check_node(&location, &bob, NACM_ACCESS_CREATE));
+    assert_true(nacm_check_node(&location, &bob, NACM_ACCESS_UPDATE));
+    assert_true(nacm_check_node(&location, &bob, NACM_ACCESS_DELETE));
+
+    /* rule paths are matched by module as well, either by its name or by its prefix */
+    assert_true(nacm_check_node(&ui8, &bob, NACM_ACCESS_READ));
+    assert_false(nacm_check_node(&i16, &bob, NACM_ACCESS_READ));
+
+    /* guest and audit - the guest rule list comes first */
+    assert_false(nacm_check_node(&string, &carol, NACM_ACCESS_READ));
+    assert_true(nacm_check_node(&location, &carol, NACM_ACCESS_WRITE));
+
+    /* user in no group gets the defaults */
+    assert_true(nacm_check_node(&string, &dave, NACM_ACCESS_READ));
+    assert_false(nacm_check_node(&location, &dave, NACM_ACCESS_WRITE));
+
+    /* recovery session */
+    assert_true(root.bypass);
+    assert_true(nacm_check_node(NULL, &root, NACM_ACCESS_WRITE));
+
+    /* permissions compiled from outdated rules deny the access */
+    assert_int_equal(SR_ERR_OK, nacm_reload(ctx, nacm_test_config()));
+    nacm_test_get_profile(ctx, "alice", &alice);
+    assert_false(nacm_check_node(&string, &alice, NACM_ACCESS_READ));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/string"), &string));
+    assert_true(nacm_check_node(&string, &alice, NACM_ACCESS_READ));
+
+    nacm_cleanup(ctx);
+}
+
+/*
+ * Disabled NACM does not restrict the access.
+ */
+static void
+nacm_test_disabled(void **state)
+{
+    struct ly_ctx *ly_ctx = *state;
+    nacm_ctx_t *ctx = NULL;
+    nacm_config_t *config = NULL;
+    nacm_profile_t bob = { 0 };
+    nacm_node_perms_t string = { 0 };
+
+    assert_int_equal(SR_ERR_OK, nacm_init(&ctx));
+
+    config = nacm_test_config();
+    config->enabled = false;
+    assert_int_equal(SR_ERR_OK, nacm_reload(ctx, config));
+    assert_false(nacm_is_enabled(ctx));
+
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/string"), &string));
+    nacm_test_get_profile(ctx, "bob", &bob);
+    assert_true(bob.bypass);
+    assert_true(nacm_check_node(&string, &bob, NACM_ACCESS_READ));
+
+    /* empty configuration - NACM enabled, read permitted, write denied */
+    assert_int_equal(SR_ERR_OK, nacm_config_from_tree(NULL, &config));
+    assert_int_equal(SR_ERR_OK, nacm_reload(ctx, config));
+    assert_true(nacm_is_enabled(ctx));
+    assert_int_equal(SR_ERR_OK, nacm_compile_node(ctx, nacm_test_get_node(ly_ctx, "/test-module:main/string"), &string));
+    nacm_test_get_profile(ctx, "bob", &bob);
+    assert_true(nacm_check_node(&string, &bob, NACM_ACCESS_READ));
+    assert_false(nacm_check_node(&string, &bob, NACM_ACCESS_WRITE));
+
+    nacm_cleanup(ctx);
+}
+
+/**
+ * @brief Saves NACM configuration into the running data file of ietf-netconf-acm:
+ *  - group "guest": NACM_TEST_USER
+ *  - rule list "guest" (guest): deny read of /main/string, deny update and delete of /main/i8,
+ *    deny read of /university/students/student, deny update of /user
+ *  - write-default permit, read-default permit
+ * Only disabled NACM is saved if enabled is FALSE.
+ */
+static void
+nacm_test_save_config(bool enabled)
+{
+    struct ly_ctx *ly_ctx = NULL;
+    struct lyd_node *root = NULL;
+    const char *config[][2] = {
+        { "/ietf-netconf-acm:nacm/write-default", "permit" },
+        { "/ietf-netconf-acm:nacm/groups/group[name='guest']/user-name", NACM_TEST_USER },
+        { "/ietf-netconf-acm:nacm/rule-list[name='guest']/group", "guest" },
+        { NACM_TEST_RULE("hide-string", "module-name"), "test-module" },
+        { NACM_TEST_RULE("hide-string", "path"), "/test-module:main/string" },
+        { NACM_TEST_RULE("hide-string", "access-operations"), "read" },
+        { NACM_TEST_RULE("hide-string", "action"), "deny" },
+        { NACM_TEST_RULE("protect-i8", "module-name"), "test-module" },
+        { NACM_TEST_RULE("protect-i8", "path"), "/test-module:main/i8" },
+        { NACM_TEST_RULE("protect-i8", "access-operations"), "update delete" },
+        { NACM_TEST_RULE("protect-i8", "action"), "deny" },
+        { NACM_TEST_RULE("hide-students", "module-name"), "test-module" },
+        { NACM_TEST_RULE("hide-students", "path"), "/test-module:university/students/student" },
+        { NACM_TEST_RULE("hide-students", "access-operations"), "read" },
+        { NACM_TEST_RULE("hide-students", "action"), "deny" },
+        { NACM_TEST_RULE("protect-users", "module-name"), "test-module" },
+        { NACM_TEST_RULE("protect-users", "path"), "/test-module:user" },
+        { NACM_TEST_RULE("protect-users", "access-operations"), "update" },
+        { NACM_TEST_RULE("protect-users", "action"), "deny" },
+    };
+
+    ly_ctx = ly_ctx_new(TEST_SCHEMA_SEARCH_DIR);
+    assert_non_null(ly_ctx);
+    assert_non_null(ly_ctx_load_module(ly_ctx, NACM_MODULE_NAME, NULL));
+
+    root = lyd_new_path(NULL, ly_ctx, "/ietf-netconf-acm:nacm/enable-nacm", enabled ? "true" : "false", 0, 0);
+    assert_non_null(root);
+    for (size_t i = 0; enabled && i < sizeof(config) / sizeof(*config); i++) {
+        assert_non_null(lyd_new_path(root, ly_ctx, config[i][0], (void *) config[i][1], 0, 0));
+    }
+
+    assert_int_equal(0, lyd_validate(&root, LYD_OPT_STRICT | LYD_OPT_CONFIG, NULL));
+    assert_int_equal(SR_ERR_OK, sr_save_data_tree_file(TEST_DATA_SEARCH_DIR NACM_MODULE_NAME SR_RUNNING_FILE_EXT, root));
+
+    lyd_free_withsiblings(root);
+    ly_ctx_destroy(ly_ctx, NULL);
+}
+
+/**
+ * @brief Setup of the tests with request processor: NACM rules are loaded by Data Manager
+ * from the running datastore.
+ */
+static int
+nacm_test_rp_setup(void **state)
+{
+    rp_ctx_t *ctx = NULL;
+
+    sr_logger_init("nacm_test");
+    sr_log_stderr(SR_LL_DBG);
+
+    createDataTreeTestModule();
+    nacm_test_save_config(true);
+    test_rp_ctx_create(&ctx);
+
+    *state = ctx;
+    return 0;
+}
+
+/**
+ * @brief Teardown of the tests with request processor, NACM is disabled again.
+ */
+static int
+nacm_test_rp_teardown(void **state)
+{
+    test_rp_ctx_cleanup(*state);
+    nacm_test_save_config(false);
+    sr_logger_cleanup();
+    return 0;
+}
+
+/**
+ * @brief Starts a startup datastore session of NACM_TEST_USER.
+ */
+static void
+nacm_test_session_create(rp_ctx_t *ctx, rp_session_t **session)
+{
+    ac_ucred_t *credentials = NULL;
+
+    test_rp_sesssion_create(ctx, SR_DS_STARTUP, session);
+
+    credentials = (ac_ucred_t *) (*session)->user_credentials;
+    if (0 == credentials->r_uid) {
+        /* root would be a recovery session, keep the root identity under the NACM user name */
+        credentials->e_username = NACM_TEST_USER;
+        credentials->e_uid = 0;
+        credentials->e_gid = 0;
+    } else {
+        credentials->r_username = NACM_TEST_USER;
+    }
+}
+
+/*
+ * Nodes that can not be read are not returned, as if they did not exist.
+ */
+static void
+nacm_test_rp_read(void **state)
+{
+    rp_ctx_t *ctx = *state;
+    rp_session_t *session = NULL;
+    sr_val_t *value = NULL, *values = NULL;
+    size_t count = 0;
+    int rc = SR_ERR_OK;
+
+    nacm_test_session_create(ctx, &session);
+
+    rc = rp_dt_get_value_wrapper(ctx, session, NULL, XP_TEST_MODULE_STRING, &value);
+    assert_int_equal(SR_ERR_NOT_FOUND, rc);
+
+    rc = rp_dt_get_value_wrapper(ctx, session, NULL, XP_TEST_MODULE_INT8, &value);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(XP_TEST_MODULE_INT8_VALUE_T, value->data.int8_val);
+    sr_free_val(value);
+
+    rc = rp_dt_get_values_wrapper(ctx, session, NULL, "/test-module:main/*", &values, &count);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_true(count > 0);
+    for (size_t i = 0; i < count; i++) {
+        assert_string_not_equal(XP_TEST_MODULE_STRING, values[i].xpath);
+    }
+    sr_free_values(values, count);
+
+    rc = rp_dt_get_values_wrapper(ctx, session, NULL, "/test-module:university/students/student", &values, &count);
+    assert_int_equal(SR_ERR_NOT_FOUND, rc);
+
+    test_rp_session_cleanup(ctx, session);
+}
+
+/*
+ * Updates and deletions are checked against the rules of the node.
+ */
+static void
+nacm_test_rp_write(void **state)
+{
+    rp_ctx_t *ctx = *state;
+    rp_session_t *session = NULL;
+    sr_val_t *value = NULL;
+    int rc = SR_ERR_OK;
+
+    nacm_test_session_create(ctx, &session);
+
+    rc = rp_dt_get_value_wrapper(ctx, session, NULL, XP_TEST_MODULE_INT8, &value);
+    assert_int_equal(SR_ERR_OK, rc);
+    value->data.int8_val = 42;
+    rc = rp_dt_set_item_wrapper(ctx, session, XP_TEST_MODULE_INT8, value, SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_UNAUTHORIZED, rc);
+
+    rc = rp_dt_delete_item_wrapper(ctx, session, XP_TEST_MODULE_INT8, SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_UNAUTHORIZED, rc);
+
+    /* nodes not covered by the rules are written according to write-default */
+    rc = rp_dt_get_value_wrapper(ctx, session, NULL, XP_TEST_MODULE_UINT8, &value);
+    assert_int_equal(SR_ERR_OK, rc);
+    value->data.uint8_val = 42;
+    rc = rp_dt_set_item_wrapper(ctx, session, XP_TEST_MODULE_UINT8, value, SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = rp_dt_delete_item_wrapper(ctx, session, XP_TEST_MODULE_INT16, SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    test_rp_session_cleanup(ctx, session);
+}
+
+/*
+ * Moving a list entry updates it, entries that can not be read are reported as missing.
+ */
+static void
+nacm_test_rp_move(void **state)
+{
+    rp_ctx_t *ctx = *state;
+    rp_session_t *session = NULL;
+    int rc = SR_ERR_OK;
+
+    nacm_test_session_create(ctx, &session);
+
+    /* creation of the users is permitted, update is not */
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/test-module:user[name='nameA']", SR_EDIT_DEFAULT, NULL);
+    assert_int_equal(SR_ERR_OK, rc);
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/test-module:user[name='nameB']", SR_EDIT_DEFAULT, NULL);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = rp_dt_move_list_wrapper(ctx, session, "/test-module:user[name='nameA']", SR_MOVE_LAST, NULL);
+    assert_int_equal(SR_ERR_UNAUTHORIZED, rc);
+    rc = rp_dt_move_list_wrapper(ctx, session, "/test-module:user[name='nameA']", SR_MOVE_AFTER,
+            "/test-module:user[name='nameB']");
+    assert_int_equal(SR_ERR_UNAUTHORIZED, rc);
+
+    /* a hidden entry can not be told apart from a missing one */
+    rc = rp_dt_move_list_wrapper(ctx, session, "/test-module:university/students/student[name='nameA']", SR_MOVE_LAST, NULL);
+    assert_int_equal(SR_ERR_INVAL_ARG, rc);
+    rc = rp_dt_move_list_wrapper(ctx, session, "/test-module:university/students/student[name='nameX']", SR_MOVE_LAST, NULL);
+    assert_int_equal(SR_ERR_INVAL_ARG, rc);
+
+    test_rp_session_cleanup(ctx, session);
+}
+
+int
+main() {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test_setup_teardown(nacm_test_rules, nacm_test_setup, nacm_test_teardown),
+            cmocka_unit_test_setup_teardown(nacm_test_disabled, nacm_test_setup, nacm_test_teardown),
+            cmocka_unit_test_setup_teardown(nacm_test_rp_read, nacm_test_rp_setup, nacm_test_rp_teardown),
+            cmocka_unit_test_setup_teardown(nacm_test_rp_write, nacm_test_rp_setup, nacm_test_rp_teardown),
+            cmocka_unit_test_setup_teardown(nacm_test_rp_move, nacm_test_rp_setup, nacm_test_rp_teardown),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
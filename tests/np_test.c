@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <setjmp.h>
 #include <cmocka.h>
@@ -305,7 +306,7 @@ np_module_subscriptions_test(void **state)
         assert_true((SR__NOTIFICATION_EVENT__VERIFY_EV == subscriptions_arr[i]->notif_event) ||
                 (SR__NOTIFICATION_EVENT__APPLY_EV == subscriptions_arr[i]->notif_event));
         /* notify and add into list */
-        rc = np_subscription_notify(np_ctx, subscriptions_arr[i], SR_EV_APPLY, 0);
+        rc = np_subscription_notify(np_ctx, subscriptions_arr[i], SR_EV_APPLY, 0, NULL);
         assert_int_equal(rc, SR_ERR_OK);
         sr_list_add(subscriptions_list, subscriptions_arr[i]);
     }
@@ -402,6 +403,72 @@ np_dp_subscriptions_test(void **state)
     assert_int_equal(rc, SR_ERR_OK);
 }
 
+static void
+np_subscription_registry_test(void **state)
+{
+    int rc = SR_ERR_OK;
+    test_ctx_t *test_ctx = *state;
+    assert_non_null(test_ctx);
+    np_ctx_t *np_ctx = test_ctx->rp_ctx->np_ctx;
+    assert_non_null(np_ctx);
+
+    np_subscription_t *subscriptions = NULL;
+    size_t subscription_cnt = 0, initial_cnt = 0;
+
+    /* delete old subscriptions, if any */
+    np_unsubscribe_destination(np_ctx, "addr6");
+
+    rc = np_get_subscriptions(np_ctx, "example-module", SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
+            &subscriptions, &initial_cnt);
+    assert_int_equal(rc, SR_ERR_OK);
+    np_free_subscriptions(subscriptions, initial_cnt);
+
+    /* subscribe */
+    rc = np_notification_subscribe(np_ctx, test_ctx->rp_session_ctx, SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
+            "addr6", 1213, "example-module", "/example-module:container", SR__NOTIFICATION_EVENT__VERIFY_EV, 0,
+            SR_API_VALUES, NP_SUBSCR_DEFAULT);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    /* the new subscription is visible, repeated lookups return the same content */
+    for (size_t i = 0; i < 2; i++) {
+        rc = np_get_subscriptions(np_ctx, "example-module", SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
+                &subscriptions, &subscription_cnt);
+        assert_int_equal(rc, SR_ERR_OK);
+        assert_int_equal(subscription_cnt, initial_cnt + 1);
+        bool found = false;
+        for (size_t j = 0; j < subscription_cnt; j++) {
+            assert_int_equal(SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS, subscriptions[j].type);
+            if (0 == strcmp("addr6", subscriptions[j].dst_address)) {
+                assert_int_equal(1213, subscriptions[j].dst_id);
+                assert_string_equal("/example-module:container", subscriptions[j].xpath);
+                found = true;
+            }
+        }
+        assert_true(found);
+        np_free_subscriptions(subscriptions, subscription_cnt);
+    }
+
+    /* no other types are returned */
+    rc = np_get_subscriptions(np_ctx, "example-module", SR__SUBSCRIPTION_TYPE__RPC_SUBS,
+            &subscriptions, &subscription_cnt);
+    assert_int_equal(rc, SR_ERR_OK);
+    for (size_t j = 0; j < subscription_cnt; j++) {
+        assert_string_not_equal("addr6", subscriptions[j].dst_address);
+    }
+    np_free_subscriptions(subscriptions, subscription_cnt);
+
+    /* unsubscribe */
+    rc = np_notification_unsubscribe(np_ctx, test_ctx->rp_session_ctx, SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
+            "addr6", 1213, "example-module");
+    assert_int_equal(rc, SR_ERR_OK);
+
+    rc = np_get_subscriptions(np_ctx, "example-module", SR__SUBSCRIPTION_TYPE__DP_GET_ITEMS_SUBS,
+            &subscriptions, &subscription_cnt);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(subscription_cnt, initial_cnt);
+    np_free_subscriptions(subscriptions, subscription_cnt);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
@@ -411,6 +478,7 @@ main() {
             cmocka_unit_test_setup_teardown(np_hello_notify_test, test_setup, test_teardown),
             cmocka_unit_test_setup_teardown(np_module_subscriptions_test, test_setup, test_teardown),
             cmocka_unit_test_setup_teardown(np_dp_subscriptions_test, test_setup, test_teardown),
+            cmocka_unit_test_setup_teardown(np_subscription_registry_test, test_setup, test_teardown),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -21,6 +21,9 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <cmocka.h>
 
@@ -121,11 +124,188 @@ perf_get_subtree_test(void **state) {
     assert_int_equal(rc, SR_ERR_OK);
 }
 
+#define PERF_MAP_ITEMS 64       /**< Number of items in the maps, roughly the number of modules in a repository. */
+#define PERF_MAP_LOOKUPS 1000000 /**< Number of lookups performed in each map. */
+
+static int
+perf_map_cmp(const void *a, const void *b)
+{
+    return strcmp((const char *) a, (const char *) b);
+}
+
+static uint32_t
+perf_map_hash(const void *item)
+{
+    return sr_str_hash((const char *) item);
+}
+
+/*
+ * Compares lookups and ordered iteration of sr_btree_t and sr_omap_t keyed by module names.
+ */
+static void
+perf_ordered_map_test(void **state) {
+    sr_btree_t *tree = NULL;
+    sr_omap_t *map = NULL, *hmap = NULL;
+    char *keys[PERF_MAP_ITEMS] = { NULL, };
+    struct timespec start = { 0, };
+    uint64_t found = 0;
+    int rc = SR_ERR_OK;
+
+    rc = sr_btree_init(perf_map_cmp, NULL, &tree);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_omap_init(perf_map_cmp, NULL, NULL, &map);
+    assert_int_equal(rc, SR_ERR_OK);
+    rc = sr_omap_init(perf_map_cmp, perf_map_hash, NULL, &hmap);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    for (size_t i = 0; i < PERF_MAP_ITEMS; i++) {
+        keys[i] = calloc(32, sizeof(char));
+        assert_non_null(keys[i]);
+        snprintf(keys[i], 32, "ietf-example-module-%zu", (i * 7919) % PERF_MAP_ITEMS);
+        assert_int_equal(SR_ERR_OK, sr_btree_insert(tree, keys[i]));
+        assert_int_equal(SR_ERR_OK, sr_omap_insert(map, keys[i]));
+        assert_int_equal(SR_ERR_OK, sr_omap_insert(hmap, keys[i]));
+    }
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < PERF_MAP_LOOKUPS; i++) {
+        found += (NULL != sr_btree_search(tree, keys[i % PERF_MAP_ITEMS]));
+    }
+    printf("sr_btree_t lookup: %" PRIu64 " us\n", sr_clock_elapsed_us(&start));
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < PERF_MAP_LOOKUPS; i++) {
+        found += (NULL != sr_omap_search(map, keys[i % PERF_MAP_ITEMS]));
+    }
+    printf("sr_omap_t lookup: %" PRIu64 " us\n", sr_clock_elapsed_us(&start));
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < PERF_MAP_LOOKUPS; i++) {
+        found += (NULL != sr_omap_search(hmap, keys[i % PERF_MAP_ITEMS]));
+    }
+    printf("sr_omap_t hashed lookup: %" PRIu64 " us\n", sr_clock_elapsed_us(&start));
+    assert_int_equal(found, 3 * PERF_MAP_LOOKUPS);
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < PERF_MAP_LOOKUPS / PERF_MAP_ITEMS; i++) {
+        for (size_t j = 0; NULL != sr_btree_get_at(tree, j); j++);
+    }
+    printf("sr_btree_t iteration: %" PRIu64 " us\n", sr_clock_elapsed_us(&start));
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < PERF_MAP_LOOKUPS / PERF_MAP_ITEMS; i++) {
+        for (size_t j = 0; NULL != sr_omap_get_at(map, j); j++);
+    }
+    printf("sr_omap_t iteration: %" PRIu64 " us\n", sr_clock_elapsed_us(&start));
+
+    sr_btree_cleanup(tree);
+    sr_omap_cleanup(map);
+    sr_omap_cleanup(hmap);
+    for (size_t i = 0; i < PERF_MAP_ITEMS; i++) {
+        free(keys[i]);
+    }
+}
+
+#define PERF_QUEUE_THREADS 4      /**< Number of producer and of consumer threads. */
+#define PERF_QUEUE_ITEMS 250000   /**< Number of elements enqueued by each producer. */
+
+typedef struct perf_queue_s {
+    sr_cbuff_t *cbuff;            /**< Mutex-guarded queue (if used). */
+    pthread_mutex_t mutex;
+    sr_ring_t *ring;              /**< Lock-free queue (if used). */
+    size_t consumed;
+} perf_queue_t;
+
+static void *
+perf_queue_producer(void *arg)
+{
+    perf_queue_t *queue = (perf_queue_t *) arg;
+
+    for (size_t i = 1; i <= PERF_QUEUE_ITEMS; i++) {
+        if (NULL != queue->ring) {
+            sr_ring_enqueue(queue->ring, &i);
+        } else {
+            pthread_mutex_lock(&queue->mutex);
+            sr_cbuff_enqueue(queue->cbuff, &i);
+            pthread_mutex_unlock(&queue->mutex);
+        }
+    }
+    return NULL;
+}
+
+static void *
+perf_queue_consumer(void *arg)
+{
+    perf_queue_t *queue = (perf_queue_t *) arg;
+    bool dequeued = false;
+    size_t item = 0;
+
+    while (__atomic_load_n(&queue->consumed, __ATOMIC_RELAXED) < PERF_QUEUE_THREADS * PERF_QUEUE_ITEMS) {
+        if (NULL != queue->ring) {
+            dequeued = sr_ring_dequeue(queue->ring, &item);
+        } else {
+            pthread_mutex_lock(&queue->mutex);
+            dequeued = sr_cbuff_dequeue(queue->cbuff, &item);
+            pthread_mutex_unlock(&queue->mutex);
+        }
+        if (dequeued) {
+            __atomic_add_fetch(&queue->consumed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+static uint64_t
+perf_queue_run(perf_queue_t *queue)
+{
+    pthread_t producers[PERF_QUEUE_THREADS], consumers[PERF_QUEUE_THREADS];
+    struct timespec start = { 0, };
+
+    sr_clock_get_time(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < PERF_QUEUE_THREADS; i++) {
+        pthread_create(&consumers[i], NULL, perf_queue_consumer, queue);
+        pthread_create(&producers[i], NULL, perf_queue_producer, queue);
+    }
+    for (size_t i = 0; i < PERF_QUEUE_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+    assert_int_equal(queue->consumed, PERF_QUEUE_THREADS * PERF_QUEUE_ITEMS);
+
+    return sr_clock_elapsed_us(&start);
+}
+
+/*
+ * Compares the mutex-guarded sr_cbuff_t with the lock-free sr_ring_t under contention.
+ */
+static void
+perf_queue_contention_test(void **state) {
+    perf_queue_t queue = { 0, };
+    int rc = SR_ERR_OK;
+
+    rc = sr_cbuff_init(10, sizeof(size_t), &queue.cbuff);
+    assert_int_equal(rc, SR_ERR_OK);
+    pthread_mutex_init(&queue.mutex, NULL);
+    printf("sr_cbuff_t + mutex, %d producers / %d consumers: %" PRIu64 " us\n", PERF_QUEUE_THREADS,
+            PERF_QUEUE_THREADS, perf_queue_run(&queue));
+    pthread_mutex_destroy(&queue.mutex);
+    sr_cbuff_cleanup(queue.cbuff);
+
+    memset(&queue, 0, sizeof(queue));
+    rc = sr_ring_init(1024, sizeof(size_t), SR_RING_MPMC, &queue.ring);
+    assert_int_equal(rc, SR_ERR_OK);
+    printf("sr_ring_t, %d producers / %d consumers: %" PRIu64 " us\n", PERF_QUEUE_THREADS,
+            PERF_QUEUE_THREADS, perf_queue_run(&queue));
+    sr_ring_cleanup(queue.ring);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(perf_get_item_test, sysrepo_setup, sysrepo_teardown),
             cmocka_unit_test_setup_teardown(perf_get_subtree_test, sysrepo_setup, sysrepo_teardown),
+            cmocka_unit_test(perf_ordered_map_test),
+            cmocka_unit_test(perf_queue_contention_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
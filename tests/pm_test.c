@@ -253,11 +253,86 @@ pm_subscription_test(void **state)
     assert_int_equal(subtrees_cnt, 0);
 }
 
+static void
+pm_write_behind_test(void **state)
+{
+    test_ctx_t *test_ctx = *state;
+    pm_ctx_t *pm_ctx = NULL, *file_pm_ctx = test_ctx->rp_ctx->pm_ctx;
+    np_subscription_t *subscriptions = NULL;
+    size_t subscription_cnt = 0;
+    bool disable_running = false, found = false;
+    int rc = SR_ERR_OK;
+
+    np_subscription_t subscription = { 0, };
+    subscription.dst_address = "/tmp/test-subscription-address3.sock";
+    subscription.dst_id = 987654321;
+    subscription.type = SR__SUBSCRIPTION_TYPE__FEATURE_ENABLE_SUBS;
+
+    rc = pm_init(test_ctx->rp_ctx, CM_MODE_DAEMON, TEST_INTERNAL_SCHEMA_SEARCH_DIR, TEST_DATA_SEARCH_DIR, &pm_ctx);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* delete old subscriptions, if any */
+    pm_remove_subscriptions_for_destination(pm_ctx, "example-module", subscription.dst_address, &disable_running);
+
+    rc = pm_add_subscription(pm_ctx, &test_ctx->user_cred, "example-module", &subscription, false);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    /* the subscription is visible immediately from the cache */
+    rc = pm_get_subscriptions(pm_ctx, "example-module", SR__SUBSCRIPTION_TYPE__FEATURE_ENABLE_SUBS,
+            &subscriptions, &subscription_cnt);
+    assert_int_equal(SR_ERR_OK, rc);
+    for (size_t i = 0; i < subscription_cnt; i++) {
+        if (987654321 == subscriptions[i].dst_id) {
+            found = true;
+        }
+    }
+    np_free_subscriptions(subscriptions, subscription_cnt);
+    assert_true(found);
+
+    /* failed modification is discarded, the pending one is kept */
+    rc = pm_add_subscription(pm_ctx, &test_ctx->user_cred, "example-module", &subscription, false);
+    assert_int_equal(SR_ERR_DATA_EXISTS, rc);
+
+    /* after the flush, the subscription is stored in the persist file */
+    rc = pm_flush(pm_ctx, "example-module", false);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    found = false;
+    rc = pm_get_subscriptions(file_pm_ctx, "example-module", SR__SUBSCRIPTION_TYPE__FEATURE_ENABLE_SUBS,
+            &subscriptions, &subscription_cnt);
+    assert_int_equal(SR_ERR_OK, rc);
+    for (size_t i = 0; i < subscription_cnt; i++) {
+        if (987654321 == subscriptions[i].dst_id) {
+            found = true;
+        }
+    }
+    np_free_subscriptions(subscriptions, subscription_cnt);
+    assert_true(found);
+
+    /* removal is written at cleanup */
+    rc = pm_remove_subscription(pm_ctx, &test_ctx->user_cred, "example-module", &subscription, &disable_running);
+    assert_int_equal(SR_ERR_OK, rc);
+    pm_cleanup(pm_ctx);
+
+    found = false;
+    rc = pm_get_subscriptions(file_pm_ctx, "example-module", SR__SUBSCRIPTION_TYPE__FEATURE_ENABLE_SUBS,
+            &subscriptions, &subscription_cnt);
+    assert_int_equal(SR_ERR_OK, rc);
+    for (size_t i = 0; i < subscription_cnt; i++) {
+        if (987654321 == subscriptions[i].dst_id) {
+            found = true;
+        }
+    }
+    np_free_subscriptions(subscriptions, subscription_cnt);
+    assert_false(found);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(pm_feature_test, test_setup, test_teardown),
             cmocka_unit_test_setup_teardown(pm_subscription_test, test_setup, test_teardown),
+            cmocka_unit_test_setup_teardown(pm_write_behind_test, test_setup, test_teardown),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
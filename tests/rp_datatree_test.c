@@ -681,6 +681,95 @@ void ietf_interfaces_tree_with_opts_test(void **state)
     dm_session_stop(ctx, ses_ctx);
 }
 
+static void
+assert_gpb_trees_equal(Sr__Node **trees1, size_t count1, Sr__Node **trees2, size_t count2)
+{
+    uint8_t *buf1 = NULL, *buf2 = NULL;
+    size_t size = 0;
+
+    assert_int_equal(count1, count2);
+    for (size_t i = 0; i < count1; ++i) {
+        size = sr__node__get_packed_size(trees1[i]);
+        assert_int_equal(size, sr__node__get_packed_size(trees2[i]));
+        buf1 = calloc(size, 1);
+        buf2 = calloc(size, 1);
+        assert_non_null(buf1);
+        assert_non_null(buf2);
+        sr__node__pack(trees1[i], buf1);
+        sr__node__pack(trees2[i], buf2);
+        assert_memory_equal(buf1, buf2, size);
+        free(buf1);
+        free(buf2);
+    }
+}
+
+static void
+free_gpb_trees(Sr__Node **trees, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        sr__node__free_unpacked(trees[i], NULL);
+    }
+    free(trees);
+}
+
+void ietf_interfaces_gpb_tree_test(void **state)
+{
+    int rc = 0;
+    rp_ctx_t *rp_ctx = *state;
+    dm_ctx_t *ctx = rp_ctx->dm_ctx;
+    dm_session_t *ses_ctx = NULL;
+    struct lyd_node *root = NULL;
+    struct ly_set *nodes = NULL;
+    sr_mem_ctx_t *sr_mem = NULL;
+    sr_node_t *trees = NULL;
+    Sr__Node **expected = NULL, **gpb_trees = NULL;
+    size_t count = 0, expected_cnt = 0, gpb_cnt = 0;
+    /* slice_offset, slice_width, child_limit, depth_limit */
+    const size_t limits[][4] = {
+        { 0, SIZE_MAX, SIZE_MAX, SIZE_MAX },
+        { 1, 2, 1, 3 },
+        { 0, 1, 2, SIZE_MAX },
+        { 0, SIZE_MAX, SIZE_MAX, 1 },
+    };
+
+    createDataTreeIETFinterfacesModule();
+    dm_session_start(ctx, NULL, SR_DS_STARTUP, &ses_ctx);
+    rc = dm_get_datatree(ctx, ses_ctx, "ietf-interfaces", &root);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    nodes = lyd_find_xpath(root, "/ietf-interfaces:interfaces/*");
+    assert_non_null(nodes);
+    assert_int_equal(3, nodes->number);
+
+    for (size_t i = 0; i < sizeof(limits) / sizeof(*limits); ++i) {
+        /* GPB trees converted from sysrepo trees */
+        rc = sr_nodes_to_tree_chunks(nodes, limits[i][0], limits[i][1], limits[i][2], limits[i][3], NULL, &trees, &count);
+        assert_int_equal(SR_ERR_OK, rc);
+        rc = sr_trees_sr_to_gpb(trees, count, &expected, &expected_cnt);
+        assert_int_equal(SR_ERR_OK, rc);
+        sr_free_trees(trees, count);
+
+        /* GPB trees built directly from the data tree */
+        rc = sr_nodes_to_gpb_trees(NULL, nodes, limits[i][0], limits[i][1], limits[i][2], limits[i][3], &gpb_trees, &gpb_cnt);
+        assert_int_equal(SR_ERR_OK, rc);
+        assert_gpb_trees_equal(expected, expected_cnt, gpb_trees, gpb_cnt);
+        free_gpb_trees(gpb_trees, gpb_cnt);
+
+        /* ... within a memory context */
+        rc = sr_mem_new(0, &sr_mem);
+        assert_int_equal(SR_ERR_OK, rc);
+        rc = sr_nodes_to_gpb_trees(sr_mem, nodes, limits[i][0], limits[i][1], limits[i][2], limits[i][3], &gpb_trees, &gpb_cnt);
+        assert_int_equal(SR_ERR_OK, rc);
+        assert_gpb_trees_equal(expected, expected_cnt, gpb_trees, gpb_cnt);
+        sr_mem_free(sr_mem);
+
+        free_gpb_trees(expected, expected_cnt);
+    }
+
+    ly_set_free(nodes);
+    dm_session_stop(ctx, ses_ctx);
+}
+
 void get_values_test_module_test(void **state){
     int rc = 0;
     rp_ctx_t *rp_ctx = *state;
@@ -1876,6 +1965,7 @@ int main(){
             cmocka_unit_test(ietf_interfaces_test),
             cmocka_unit_test(ietf_interfaces_tree_test),
             cmocka_unit_test(ietf_interfaces_tree_with_opts_test),
+            cmocka_unit_test(ietf_interfaces_gpb_tree_test),
             cmocka_unit_test(get_values_test_module_test),
             cmocka_unit_test(get_tree_test_module_test),
             cmocka_unit_test(get_nodes_test),
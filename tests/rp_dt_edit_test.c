@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <string.h>
 #include "data_manager.h"
 #include "test_data.h"
 #include "sr_common.h"
@@ -42,7 +43,7 @@ typedef struct dm_session_s {
     dm_ctx_t *dm_ctx;                   /**< dm_ctx where the session belongs to */
     sr_datastore_t datastore;           /**< datastore to which the session is tied */
     const ac_ucred_t *user_credentials; /**< credentials of the user who this session belongs to */
-    sr_btree_t **session_modules;       /**< array of binary trees holding session copies of data models for each datastore */
+    sr_omap_t **session_modules;        /**< array of ordered maps holding session copies of data models for each datastore */
     dm_sess_op_t **operations;          /**< array of list of operations performed in this session */
     size_t *oper_count;                 /**< array of number of performed operation */
     size_t *oper_size;                  /**< array of number of allocated operations */
@@ -2419,6 +2420,149 @@ validaton_of_multiple_models(void **state)
 }
 
 
+static char *
+diff_item_path(struct lyd_difflist *diff, size_t index)
+{
+    return lyd_path(LYD_DIFF_CREATED == diff->type[index] ? diff->second[index] : diff->first[index]);
+}
+
+static void
+check_diff_equal(struct lyd_difflist *expected, struct lyd_difflist *diff)
+{
+    size_t exp_cnt = 0, cnt = 0;
+
+    assert_non_null(expected);
+    assert_non_null(diff);
+    while (LYD_DIFF_END != expected->type[exp_cnt]) {
+        exp_cnt++;
+    }
+    while (LYD_DIFF_END != diff->type[cnt]) {
+        cnt++;
+    }
+    assert_int_equal(exp_cnt, cnt);
+
+    /* the order of items may differ */
+    for (size_t i = 0; i < cnt; i++) {
+        bool found = false;
+        char *path = diff_item_path(diff, i);
+        assert_non_null(path);
+        for (size_t j = 0; j < exp_cnt && !found; j++) {
+            char *exp_path = diff_item_path(expected, j);
+            assert_non_null(exp_path);
+            found = expected->type[j] == diff->type[i] && 0 == strcmp(exp_path, path);
+            free(exp_path);
+        }
+        assert_true(found);
+        free(path);
+    }
+}
+
+static void
+tracked_changes_diff_test(void **state)
+{
+    int rc = 0;
+    rp_ctx_t *ctx = *state;
+    rp_session_t *session = NULL;
+    dm_data_info_t *info = NULL;
+    dm_data_info_t prev = {0};
+    struct lyd_difflist *expected = NULL, *diff = NULL;
+    sr_val_t v = {0};
+
+    test_rp_sesssion_create(ctx, SR_DS_RUNNING, &session);
+
+    rc = dm_get_data_info(ctx->dm_ctx, session->dm_session, "example-module", &info);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_non_null(info->changed_paths);
+    assert_false(info->schema->has_when_conditions);
+
+    prev.schema = info->schema;
+    prev.node = sr_dup_datatree(info->node);
+    assert_non_null(prev.node);
+
+    /* no change */
+    rc = dm_get_data_info_diff(&prev, info, false, &diff);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_int_equal(LYD_DIFF_END, diff->type[0]);
+    lyd_free_diff(diff);
+
+    /* change, create and delete within existing subtrees and top-level */
+    v.type = SR_STRING_T;
+    v.data.string_val = "changed";
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/example-module:container/list[key1='key1'][key2='key2']/leaf", SR_EDIT_DEFAULT, &v);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    v.data.string_val = "new";
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/example-module:container/list[key1='a'][key2='b']/leaf", SR_EDIT_DEFAULT, &v);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    v.type = SR_UINT16_T;
+    v.data.uint16_val = 42;
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/example-module:number", SR_EDIT_DEFAULT, &v);
+    assert_int_equal(SR_ERR_OK, rc);
+    v.data.uint16_val = 43;
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/example-module:number", SR_EDIT_DEFAULT, &v);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = rp_dt_delete_item(ctx->dm_ctx, session->dm_session, "/example-module:number[.='42']", SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    rc = rp_dt_delete_item(ctx->dm_ctx, session->dm_session, "/example-module:container/list[key1='key1'][key2='key2']", SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_non_null(info->changed_paths);
+
+    expected = lyd_diff(prev.node, info->node, LYD_DIFFOPT_WITHDEFAULTS);
+    rc = dm_get_data_info_diff(&prev, info, false, &diff);
+    assert_int_equal(SR_ERR_OK, rc);
+    check_diff_equal(expected, diff);
+    lyd_free_diff(expected);
+    lyd_free_diff(diff);
+
+    /* inverse changes */
+    expected = lyd_diff(info->node, prev.node, LYD_DIFFOPT_WITHDEFAULTS);
+    rc = dm_get_data_info_diff(&prev, info, true, &diff);
+    assert_int_equal(SR_ERR_OK, rc);
+    check_diff_equal(expected, diff);
+    lyd_free_diff(expected);
+    lyd_free_diff(diff);
+
+    /* removal of the whole container */
+    rc = rp_dt_delete_item(ctx->dm_ctx, session->dm_session, "/example-module:container", SR_EDIT_DEFAULT);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    expected = lyd_diff(prev.node, info->node, LYD_DIFFOPT_WITHDEFAULTS);
+    rc = dm_get_data_info_diff(&prev, info, false, &diff);
+    assert_int_equal(SR_ERR_OK, rc);
+    check_diff_equal(expected, diff);
+    lyd_free_diff(expected);
+    lyd_free_diff(diff);
+
+    lyd_free_withsiblings(prev.node);
+
+    /* module with conditional nodes, the whole trees are compared */
+    rc = dm_get_data_info(ctx->dm_ctx, session->dm_session, "test-module", &info);
+    assert_int_equal(SR_ERR_OK, rc);
+    assert_true(info->schema->has_when_conditions);
+
+    prev.schema = info->schema;
+    prev.node = sr_dup_datatree(info->node);
+    assert_non_null(prev.node);
+
+    v.type = SR_STRING_T;
+    v.data.string_val = "str";
+    rc = rp_dt_set_item(ctx->dm_ctx, session->dm_session, "/test-module:main/string", SR_EDIT_DEFAULT, &v);
+    assert_int_equal(SR_ERR_OK, rc);
+
+    expected = lyd_diff(prev.node, info->node, LYD_DIFFOPT_WITHDEFAULTS);
+    rc = dm_get_data_info_diff(&prev, info, false, &diff);
+    assert_int_equal(SR_ERR_OK, rc);
+    check_diff_equal(expected, diff);
+    lyd_free_diff(expected);
+    lyd_free_diff(diff);
+
+    lyd_free_withsiblings(prev.node);
+    test_rp_session_cleanup(ctx, session);
+}
+
 int main(){
 
     sr_log_stderr(SR_LL_DBG);
@@ -2457,6 +2601,7 @@ int main(){
             cmocka_unit_test(candidate_commit_lock_test),
             cmocka_unit_test_setup(edit_union_type, createData),
             cmocka_unit_test_setup(validaton_of_multiple_models, createData),
+            cmocka_unit_test_setup(tracked_changes_diff_test, createData),
     };
     return cmocka_run_group_tests(tests, setup, teardown);
 }
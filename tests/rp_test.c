@@ -29,6 +29,10 @@
 #include "sr_common.h"
 #include "access_control.h"
 #include "request_processor.h"
+#include "rp_internal.h"
+#include "test_module_helper.h"
+
+static int slow_request_cnt = 0;
 
 static int
 rp_setup(void **state)
@@ -141,11 +145,141 @@ rp_msg_neg_test(void **state)
     assert_int_equal(rc, SR_ERR_OK);
 }
 
+/**
+ * Test configuration of the slow request log threshold.
+ */
+static void
+rp_slow_request_threshold_test(void **state)
+{
+    rp_ctx_t *rp_ctx = NULL;
+    int rc = 0;
+
+    sr_logger_init("rp_test");
+
+    /* default threshold */
+    unsetenv("SR_SLOW_REQUEST_THRESHOLD");
+    rc = rp_init(NULL, &rp_ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(SR_SLOW_REQUEST_THRESHOLD, rp_ctx->slow_request_threshold);
+    rp_cleanup(rp_ctx);
+
+    /* threshold overridden by the environment */
+    setenv("SR_SLOW_REQUEST_THRESHOLD", "25", 1);
+    rc = rp_init(NULL, &rp_ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(25, rp_ctx->slow_request_threshold);
+    rp_cleanup(rp_ctx);
+
+    /* slow request log disabled */
+    setenv("SR_SLOW_REQUEST_THRESHOLD", "0", 1);
+    rc = rp_init(NULL, &rp_ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(0, rp_ctx->slow_request_threshold);
+    rp_cleanup(rp_ctx);
+
+    /* invalid values fall back to the default */
+    setenv("SR_SLOW_REQUEST_THRESHOLD", "12abc", 1);
+    rc = rp_init(NULL, &rp_ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(SR_SLOW_REQUEST_THRESHOLD, rp_ctx->slow_request_threshold);
+    rp_cleanup(rp_ctx);
+
+    setenv("SR_SLOW_REQUEST_THRESHOLD", "-1", 1);
+    rc = rp_init(NULL, &rp_ctx);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(SR_SLOW_REQUEST_THRESHOLD, rp_ctx->slow_request_threshold);
+    rp_cleanup(rp_ctx);
+
+    unsetenv("SR_SLOW_REQUEST_THRESHOLD");
+    sr_logger_cleanup();
+}
+
+/*
+ * Callback counting the slow request log entries in rp_slow_request_log_test.
+ */
+static void
+rp_slow_request_log_cb(sr_log_level_t level, const char *message)
+{
+    if (SR_LL_WRN == level && NULL != strstr(message, "Slow request") && NULL != strstr(message, "operation=get-item") &&
+            NULL != strstr(message, "module=test-module")) {
+        __atomic_add_fetch(&slow_request_cnt, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Test that a request taking longer than the threshold is logged.
+ */
+static void
+rp_slow_request_log_test(void **state)
+{
+    int rc = 0;
+    rp_session_t *session = NULL;
+    dm_schema_info_t *schema_info = NULL;
+    Sr__Msg *msg = NULL;
+
+    rp_ctx_t *rp_ctx = *state;
+    assert_non_null(rp_ctx);
+
+    ac_ucred_t credentials = { 0 };
+    credentials.e_uid = getuid();
+    credentials.e_gid = getgid();
+
+    rp_ctx->slow_request_threshold = 10;
+    slow_request_cnt = 0;
+    sr_log_set_cb(rp_slow_request_log_cb);
+
+    rc = rp_session_start(rp_ctx, 123456, &credentials, SR_DS_STARTUP, SR_SESS_DEFAULT, 0, &session);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_non_null(session);
+
+    /* keep the request waiting for the module for longer than the threshold */
+    rc = dm_get_module_and_lockw(rp_ctx->dm_ctx, "test-module", &schema_info);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    rc = sr_gpb_req_alloc(NULL, SR__OPERATION__GET_ITEM, session->id, &msg);
+    assert_int_equal(rc, SR_ERR_OK);
+    msg->request->get_item_req->xpath = strdup(XP_TEST_MODULE_STRING);
+    assert_non_null(msg->request->get_item_req->xpath);
+    rc = rp_msg_process(rp_ctx, session, msg);
+    assert_int_equal(rc, SR_ERR_OK);
+
+    usleep(5 * rp_ctx->slow_request_threshold * 1000);
+    sr_rwlock_unlock(&schema_info->model_lock);
+
+    for (size_t i = 0; i < 100 && 0 == __atomic_load_n(&slow_request_cnt, __ATOMIC_SEQ_CST); ++i) {
+        usleep(10000);
+    }
+    assert_int_equal(1, __atomic_load_n(&slow_request_cnt, __ATOMIC_SEQ_CST));
+
+    /* fast requests are not logged */
+    rp_ctx->slow_request_threshold = 60 * 1000;
+    rc = sr_gpb_req_alloc(NULL, SR__OPERATION__GET_ITEM, session->id, &msg);
+    assert_int_equal(rc, SR_ERR_OK);
+    msg->request->get_item_req->xpath = strdup(XP_TEST_MODULE_STRING);
+    assert_non_null(msg->request->get_item_req->xpath);
+    rc = rp_msg_process(rp_ctx, session, msg);
+    assert_int_equal(rc, SR_ERR_OK);
+    for (size_t i = 0, cnt = 1; i < 100 && 0 != cnt; ++i) {
+        usleep(10000);
+        pthread_mutex_lock(&session->msg_count_mutex);
+        cnt = session->msg_count;
+        pthread_mutex_unlock(&session->msg_count_mutex);
+    }
+
+    rc = rp_session_stop(rp_ctx, session);
+    assert_int_equal(rc, SR_ERR_OK);
+    assert_int_equal(1, __atomic_load_n(&slow_request_cnt, __ATOMIC_SEQ_CST));
+
+    sr_log_set_cb(NULL);
+}
+
 int
 main() {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(rp_session_test, rp_setup, rp_teardown),
             cmocka_unit_test_setup_teardown(rp_msg_neg_test, rp_setup, rp_teardown),
+            cmocka_unit_test(rp_slow_request_threshold_test),
+            cmocka_unit_test_setup_teardown(rp_slow_request_log_test, rp_setup, rp_teardown),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);